@@ -29,9 +29,20 @@
 #include "GFXAPI.h"
 #include "Core/State/ComputeState.h"
 #include "Core/Program/ProgramVars.h"
+#include "Utils/NumericRange.h"
+#include "Utils/Math/Common.h"
+
+#include <algorithm>
+#include <execution>
 
 namespace Falcor
 {
+namespace
+{
+/// Number of consecutive thread groups executed per task on the CPU device.
+constexpr uint32_t kHostGroupsPerTask = 16;
+} // namespace
+
 ComputeContext::ComputeContext(Device* pDevice, gfx::ICommandQueue* pQueue) : CopyContext(pDevice, pQueue)
 {
     bindDescriptorHeaps(); // TODO: Should this be done here?
@@ -43,6 +54,12 @@ void ComputeContext::dispatch(ComputeState* pState, ProgramVars* pVars, const ui
 {
     pVars->prepareDescriptorSets(this);
 
+    if (mpDevice->getType() == Device::Type::CPU)
+    {
+        dispatchHost(pState, pVars, dispatchSize);
+        return;
+    }
+
     auto computeEncoder = mpLowLevelData->getComputeCommandEncoder();
     FALCOR_GFX_CALL(computeEncoder->bindPipelineWithRootObject(pState->getCSO(pVars)->getGfxPipelineState(), pVars->getShaderObject()));
     FALCOR_GFX_CALL(computeEncoder->dispatchCompute((int)dispatchSize.x, (int)dispatchSize.y, (int)dispatchSize.z));
@@ -52,6 +69,15 @@ void ComputeContext::dispatch(ComputeState* pState, ProgramVars* pVars, const ui
 void ComputeContext::dispatchIndirect(ComputeState* pState, ProgramVars* pVars, const Buffer* pArgBuffer, uint64_t argBufferOffset)
 {
     pVars->prepareDescriptorSets(this);
+
+    if (mpDevice->getType() == Device::Type::CPU)
+    {
+        uint3 dispatchSize;
+        pArgBuffer->getBlob(&dispatchSize, argBufferOffset, sizeof(dispatchSize));
+        dispatchHost(pState, pVars, dispatchSize);
+        return;
+    }
+
     resourceBarrier(pArgBuffer, Resource::State::IndirectArg);
 
     auto computeEncoder = mpLowLevelData->getComputeCommandEncoder();
@@ -60,6 +86,52 @@ void ComputeContext::dispatchIndirect(ComputeState* pState, ProgramVars* pVars,
     mCommandsPending = true;
 }
 
+void ComputeContext::dispatchHost(ComputeState* pState, ProgramVars* pVars, const uint3& dispatchSize)
+{
+    ProgramKernels::HostComputeFunc func = pState->getCSO(pVars)->getDesc().pProgramKernels->getHostComputeFunc();
+    FALCOR_CHECK(func, "Program has no host-callable compute kernel.");
+
+    if (dispatchSize.x == 0 || dispatchSize.y == 0 || dispatchSize.z == 0)
+        return;
+
+    // Commands on the CPU device are executed at submission. Submit pending commands so that they complete before the kernel runs.
+    submit();
+
+    gfx::IShaderObject* pRootObject = pVars->getShaderObject();
+    void* pGlobalParams = const_cast<void*>(pRootObject->getRawData());
+    void* pEntryPointParams = nullptr;
+    Slang::ComPtr<gfx::IShaderObject> pEntryPointObject;
+    if (pRootObject->getEntryPointCount() > 0)
+    {
+        FALCOR_GFX_CALL(pRootObject->getEntryPoint(0, pEntryPointObject.writeRef()));
+        pEntryPointParams = const_cast<void*>(pEntryPointObject->getRawData());
+    }
+
+    // Split each row of thread groups into tasks and execute them in parallel.
+    // As on the GPU, thread groups are assumed to be independent of each other.
+    const uint32_t tasksPerRow = div_round_up(dispatchSize.x, kHostGroupsPerTask);
+    const uint32_t taskCount = tasksPerRow * dispatchSize.y * dispatchSize.z;
+    NumericRange<uint32_t> range(0, taskCount);
+    std::for_each(
+        std::execution::par,
+        range.begin(),
+        range.end(),
+        [&](uint32_t taskIndex)
+        {
+            const uint32_t row = taskIndex / tasksPerRow;
+            const uint32_t x = (taskIndex % tasksPerRow) * kHostGroupsPerTask;
+            ProgramKernels::HostComputeVaryingInput input;
+            input.startGroupID[0] = x;
+            input.startGroupID[1] = row % dispatchSize.y;
+            input.startGroupID[2] = row / dispatchSize.y;
+            input.endGroupID[0] = std::min(x + kHostGroupsPerTask, dispatchSize.x);
+            input.endGroupID[1] = input.startGroupID[1] + 1;
+            input.endGroupID[2] = input.startGroupID[2] + 1;
+            func(&input, pEntryPointParams, pGlobalParams);
+        }
+    );
+}
+
 void ComputeContext::clearUAV(const UnorderedAccessView* pUav, const float4& value)
 {
     resourceBarrier(pUav->getResource(), Resource::State::UnorderedAccess);
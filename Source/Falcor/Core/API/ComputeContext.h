@@ -92,6 +92,12 @@ public:
 protected:
     ComputeContext(gfx::ICommandQueue* pQueue);
 
+    /**
+     * Execute a dispatch on the CPU device.
+     * The thread groups are distributed across the worker threads.
+     */
+    void dispatchHost(ComputeState* pState, ProgramVars* pVars, const uint3& dispatchSize);
+
     const ProgramVars* mpLastBoundComputeVars = nullptr;
 };
 
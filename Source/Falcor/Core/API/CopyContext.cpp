@@ -93,7 +93,10 @@ uint64_t CopyContext::signal(Fence* pFence, uint64_t value)
 {
     FALCOR_CHECK(pFence, "'fence' must not be null");
     uint64_t signalValue = pFence->updateSignaledValue(value);
-    mpLowLevelData->getGfxCommandQueue()->executeCommandBuffers(0, nullptr, pFence->getGfxFence(), signalValue);
+    if (pFence->getGfxFence())
+        mpLowLevelData->getGfxCommandQueue()->executeCommandBuffers(0, nullptr, pFence->getGfxFence(), signalValue);
+    else
+        pFence->signal(signalValue); // Host fence, all submitted commands have been executed.
     return signalValue;
 }
 
@@ -101,6 +104,9 @@ void CopyContext::wait(Fence* pFence, uint64_t value)
 {
     FALCOR_CHECK(pFence, "'fence' must not be null");
     uint64_t waitValue = value == Fence::kAuto ? pFence->getSignaledValue() : value;
+    // Host fences (CPU device) are signaled in submission order, there is nothing to wait for on the device.
+    if (!pFence->getGfxFence())
+        return;
     gfx::IFence* fences[] = {pFence->getGfxFence()};
     uint64_t waitValues[] = {waitValue};
     FALCOR_GFX_CALL(mpLowLevelData->getGfxCommandQueue()->waitForFenceValuesOnDevice(1, fences, waitValues));
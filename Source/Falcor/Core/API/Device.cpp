@@ -327,6 +327,8 @@ inline gfx::DeviceType getGfxDeviceType(Device::Type deviceType)
         return gfx::DeviceType::DirectX12;
     case Device::Type::Vulkan:
         return gfx::DeviceType::Vulkan;
+    case Device::Type::CPU:
+        return gfx::DeviceType::CPU;
     default:
         FALCOR_THROW("Unknown device type");
     }
@@ -501,22 +503,23 @@ Device::Device(const Desc& desc) : mDesc(desc)
     if (mDesc.enableDebugLayer)
         gfx::gfxEnableDebugLayer();
 
-    // Get list of available GPUs.
+    // Get list of available GPUs. The CPU device has no adapters to choose from.
     const auto gpus = getGPUs(mDesc.type);
 
-    if (gpus.size() == 0)
+    if (mDesc.type != Type::CPU)
     {
-        FALCOR_THROW("Did not find any GPUs for device type '{}'.", enumToString<decltype(mDesc.type)>(mDesc.type));
-    }
+        if (gpus.size() == 0)
+        {
+            FALCOR_THROW("Did not find any GPUs for device type '{}'.", enumToString<decltype(mDesc.type)>(mDesc.type));
+        }
 
-    if (mDesc.gpu >= gpus.size())
-    {
-        logWarning("GPU index {} is out of range, using first GPU instead.", mDesc.gpu);
-        mDesc.gpu = 0;
-    }
+        if (mDesc.gpu >= gpus.size())
+        {
+            logWarning("GPU index {} is out of range, using first GPU instead.", mDesc.gpu);
+            mDesc.gpu = 0;
+        }
 
-    // Try to create device on specific GPU.
-    {
+        // Try to create device on specific GPU.
         gfxDesc.adapterLUID = reinterpret_cast<const gfx::AdapterLUID*>(&gpus[mDesc.gpu].luid);
         if (SLANG_FAILED(gfxCreateDevice(&gfxDesc, mGfxDevice.writeRef())))
             logWarning("Failed to create device on GPU {} ({}).", mDesc.gpu, gpus[mDesc.gpu].name);
@@ -577,9 +580,21 @@ Device::Device(const Desc& desc) : mDesc(desc)
         mSupportedFeatures |= SupportedFeatures::ShaderExecutionReorderingAPI;
     }
 
-    mSupportedShaderModel = querySupportedShaderModel(mGfxDevice);
+    if (getType() != Type::CPU)
+    {
+        mSupportedFeatures |= SupportedFeatures::Rasterization;
+        mSupportedShaderModel = querySupportedShaderModel(mGfxDevice);
+    }
+    else
+    {
+        // The host-callable target does not report shader model features.
+        // The shader model only selects the Slang profile and the __SM_X_Y__ defines.
+        mSupportedShaderModel = kDefaultShaderModel;
+    }
     mDefaultShaderModel = std::min(kDefaultShaderModel, mSupportedShaderModel);
-    mGpuTimestampFrequency = 1000.0 / (double)mGfxDevice->getDeviceInfo().timestampFrequency;
+    // Devices without GPU timestamps (CPU device) report a frequency of zero, timings are reported as zero on those.
+    const uint64_t timestampFrequency = mGfxDevice->getDeviceInfo().timestampFrequency;
+    mGpuTimestampFrequency = timestampFrequency > 0 ? 1000.0 / (double)timestampFrequency : 0.0;
 
 #if FALCOR_HAS_D3D12
     // Configure D3D12 validation layer.
@@ -678,7 +693,8 @@ Device::Device(const Desc& desc) : mDesc(desc)
     this->decRef(false);
 
     logInfo(
-        "Created GPU device '{}' using '{}' API (SM{}.{}).",
+        "Created {} device '{}' using '{}' API (SM{}.{}).",
+        getType() == Type::CPU ? "CPU" : "GPU",
         mInfo.adapterName,
         mInfo.apiName,
         getShaderModelMajorVersion(mSupportedShaderModel),
@@ -1129,6 +1145,8 @@ std::vector<AdapterInfo> Device::getGPUs(Type deviceType)
 {
     if (deviceType == Type::Default)
         deviceType = getDefaultDeviceType();
+    if (deviceType == Type::CPU)
+        return {};
     auto adapters = gfx::gfxGetAdapters(getGfxDeviceType(deviceType));
     std::vector<AdapterInfo> result;
     for (gfx::GfxIndex i = 0; i < adapters.getCount(); ++i)
@@ -1308,6 +1326,7 @@ FALCOR_SCRIPT_BINDING(Device)
     deviceType.value("Default", Device::Type::Default);
     deviceType.value("D3D12", Device::Type::D3D12);
     deviceType.value("Vulkan", Device::Type::Vulkan);
+    deviceType.value("CPU", Device::Type::CPU);
 
     pybind11::class_<Device::Info> info(device, "Info");
     info.def_readonly("adapter_name", &Device::Info::adapterName);
@@ -117,6 +117,9 @@ public:
         Default, ///< Default device type, favors D3D12 over Vulkan.
         D3D12,
         Vulkan,
+        /// Headless CPU device. Compute shaders are compiled to host-callable C++ and dispatched across the worker threads.
+        /// Rasterization and ray tracing are not supported. Never selected as the default device type.
+        CPU,
     };
     FALCOR_ENUM_INFO(
         Type,
@@ -124,13 +127,14 @@ public:
             {Type::Default, "Default"},
             {Type::D3D12, "D3D12"},
             {Type::Vulkan, "Vulkan"},
+            {Type::CPU, "CPU"},
         }
     );
 
     /// Device descriptor.
     struct Desc
     {
-        /// The device type (D3D12/Vulkan).
+        /// The device type (D3D12/Vulkan/CPU).
         Type type = Type::Default;
 
         /// GPU index (indexing into GPU list returned by getGPUList()).
@@ -148,6 +152,10 @@ public:
         /// The full path to the root directory for the shader cache. An empty string will disable the cache.
         std::string shaderCachePath = (getRuntimeDirectory() / ".shadercache").string();
 
+        /// The full path to the root directory for the program cache, which stores the results of the Slang front-end
+        /// (see ProgramCache). An empty string will disable the cache.
+        std::string programCachePath = (getRuntimeDirectory() / ".programcache").string();
+
 #if FALCOR_HAS_D3D12
         /// GUID list for experimental features
         std::vector<GUID> experimentalFeatures;
@@ -186,6 +194,7 @@ public:
         WaveOperations = 0x200,
         ShaderExecutionReorderingAPI = 0x400,           ///< On D3D12 and Vulkan, this means SER API is available (in the future this will be part of the shader model).
         RaytracingReordering = 0x800,                   ///< On D3D12, this means SER is supported on the hardware.
+        Rasterization = 0x1000,                         ///< Rasterization pipelines are supported. This is the case for all devices except the CPU device.
 
         // clang-format on
     };
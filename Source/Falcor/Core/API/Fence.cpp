@@ -39,6 +39,14 @@ Fence::Fence(ref<Device> pDevice, FenceDesc desc) : mpDevice(pDevice), mDesc(des
     gfx::IFence::Desc gfxDesc = {};
     mSignaledValue = mDesc.initialValue;
     gfxDesc.isShared = mDesc.shared;
+
+    // The CPU device executes commands at submission, so its fences only need to track the value on the host.
+    if (mpDevice->getType() == Device::Type::CPU)
+    {
+        FALCOR_CHECK(!mDesc.shared, "Shared fences are not supported on the CPU device.");
+        mHostValue = mDesc.initialValue;
+        return;
+    }
     FALCOR_GFX_CALL(mpDevice->getGfxDevice()->createFence(gfxDesc, mGfxFence.writeRef()));
 }
 
@@ -47,7 +55,10 @@ Fence::~Fence() = default;
 uint64_t Fence::signal(uint64_t value)
 {
     uint64_t signalValue = updateSignaledValue(value);
-    FALCOR_GFX_CALL(mGfxFence->setCurrentValue(signalValue));
+    if (mGfxFence)
+        FALCOR_GFX_CALL(mGfxFence->setCurrentValue(signalValue));
+    else
+        mHostValue = signalValue;
     return signalValue;
 }
 
@@ -57,6 +68,7 @@ void Fence::wait(uint64_t value, uint64_t timeoutNs)
     uint64_t currentValue = getCurrentValue();
     if (currentValue >= waitValue)
         return;
+    FALCOR_CHECK(mGfxFence, "Waiting for fence value {} that is never signaled (current value {}).", waitValue, currentValue);
     gfx::IFence* fences[] = {mGfxFence};
     uint64_t waitValues[] = {waitValue};
     FALCOR_GFX_CALL(mpDevice->getGfxDevice()->waitForFences(1, fences, waitValues, true, timeoutNs));
@@ -64,6 +76,8 @@ void Fence::wait(uint64_t value, uint64_t timeoutNs)
 
 uint64_t Fence::getCurrentValue()
 {
+    if (!mGfxFence)
+        return mHostValue;
     uint64_t value;
     FALCOR_GFX_CALL(mGfxFence->getCurrentValue(&value));
     return value;
@@ -77,6 +91,8 @@ uint64_t Fence::updateSignaledValue(uint64_t value)
 
 SharedResourceApiHandle Fence::getSharedApiHandle() const
 {
+    if (!mGfxFence)
+        return {};
     gfx::InteropHandle sharedHandle;
     FALCOR_GFX_CALL(mGfxFence->getSharedHandle(&sharedHandle));
     return (SharedResourceApiHandle)sharedHandle.handleValue;
@@ -84,6 +100,8 @@ SharedResourceApiHandle Fence::getSharedApiHandle() const
 
 NativeHandle Fence::getNativeHandle() const
 {
+    if (!mGfxFence)
+        return {};
     gfx::InteropHandle gfxNativeHandle = {};
     FALCOR_GFX_CALL(mGfxFence->getNativeHandle(&gfxNativeHandle));
 #if FALCOR_HAS_D3D12
@@ -110,7 +110,8 @@ public:
     uint64_t updateSignaledValue(uint64_t value = kAuto);
 
     /**
-     * Get the internal API handle
+     * Get the internal API handle.
+     * Returns nullptr for fences on the CPU device, which are only tracked on the host.
      */
     gfx::IFence* getGfxFence() const { return mGfxFence; }
 
@@ -135,5 +136,6 @@ private:
     FenceDesc mDesc;
     Slang::ComPtr<gfx::IFence> mGfxFence;
     uint64_t mSignaledValue{0};
+    uint64_t mHostValue{0}; ///< Current value of fences without an API fence (CPU device).
 };
 } // namespace Falcor
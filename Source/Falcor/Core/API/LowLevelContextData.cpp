@@ -112,7 +112,11 @@ void LowLevelContextData::openCommandBuffer()
 void LowLevelContextData::submitCommandBuffer()
 {
     closeCommandBuffer();
-    mpGfxCommandQueue->executeCommandBuffers(1, mGfxCommandBuffer.readRef(), mpFence->getGfxFence(), mpFence->updateSignaledValue());
+    uint64_t signalValue = mpFence->updateSignaledValue();
+    mpGfxCommandQueue->executeCommandBuffers(1, mGfxCommandBuffer.readRef(), mpFence->getGfxFence(), signalValue);
+    // Host fences (CPU device) are signaled directly, the commands have been executed at this point.
+    if (!mpFence->getGfxFence())
+        mpFence->signal(signalValue);
     openCommandBuffer();
 }
 
@@ -531,6 +531,8 @@ void RenderContext::drawIndexedIndirect(
 
 void RenderContext::raytrace(Program* pProgram, RtProgramVars* pVars, uint32_t width, uint32_t height, uint32_t depth)
 {
+    FALCOR_CHECK(mpDevice->isFeatureSupported(Device::SupportedFeatures::Raytracing), "Raytracing is not supported by the device.");
+
     auto pRtso = pProgram->getRtso(pVars);
 
     pVars->prepareShaderTable(this, pRtso.get());
@@ -613,6 +615,8 @@ void RenderContext::buildAccelerationStructure(
     RtAccelerationStructurePostBuildInfoDesc* pPostBuildInfoDescs
 )
 {
+    FALCOR_CHECK(mpDevice->isFeatureSupported(Device::SupportedFeatures::Raytracing), "Raytracing is not supported by the device.");
+
     GFXAccelerationStructureBuildInputsTranslator translator = {};
 
     gfx::IAccelerationStructure::BuildDesc buildDesc = {};
@@ -648,6 +652,8 @@ void RenderContext::copyAccelerationStructure(
 
 gfx::IRenderCommandEncoder* RenderContext::drawCallCommon(GraphicsState* pState, ProgramVars* pVars)
 {
+    FALCOR_CHECK(mpDevice->isFeatureSupported(Device::SupportedFeatures::Rasterization), "Rasterization is not supported by the device.");
+
     // Insert barriers for bound resources.
     pVars->prepareDescriptorSets(this);
 
@@ -69,6 +69,13 @@ gfx::IResource::Type getGfxResourceType(Texture::Type type)
     }
 }
 
+/// Returns true if the format is a one or two channel float color format that Bitmap::saveImage() can expand to RGBA.
+bool isExpandableToRGBA32Float(ResourceFormat format)
+{
+    return format == ResourceFormat::R16Float || format == ResourceFormat::RG16Float || format == ResourceFormat::R32Float ||
+           format == ResourceFormat::RG32Float;
+}
+
 } // namespace
 
 Texture::Texture(
@@ -600,15 +607,38 @@ void Texture::captureToFile(
     if (mType != Type::Texture2D)
         FALCOR_THROW("Texture::captureToFile only supported for 2D textures.");
 
+    ResourceFormat resourceFormat;
+    std::vector<uint8_t> textureData = readImageData(mipLevel, arraySlice, format, resourceFormat);
+    uint32_t width = getWidth(mipLevel);
+    uint32_t height = getHeight(mipLevel);
+
+    auto func = [=]() { Bitmap::saveImage(path, width, height, format, exportFlags, resourceFormat, true, (void*)textureData.data()); };
+
+    if (async)
+        Threading::dispatchTask(func);
+    else
+        func();
+}
+
+std::vector<uint8_t> Texture::readImageData(
+    uint32_t mipLevel,
+    uint32_t arraySlice,
+    Bitmap::FileFormat format,
+    ResourceFormat& resourceFormat
+)
+{
+    FALCOR_CHECK(mType == Type::Texture2D, "Texture::readImageData only supported for 2D textures.");
+
     RenderContext* pContext = mpDevice->getRenderContext();
 
     // Handle the special case where we have an HDR texture with less then 3 channels.
+    // Common color formats are expanded to RGBA when saving as PFM/EXR, other formats are blitted to an RGBA texture.
     FormatType type = getFormatType(mFormat);
     uint32_t channels = getFormatChannelCount(mFormat);
-    std::vector<uint8_t> textureData;
-    ResourceFormat resourceFormat = mFormat;
+    bool isHdrFile = format == Bitmap::FileFormat::PfmFile || format == Bitmap::FileFormat::ExrFile;
+    resourceFormat = mFormat;
 
-    if (type == FormatType::Float && channels < 3)
+    if (type == FormatType::Float && channels < 3 && !(isHdrFile && isExpandableToRGBA32Float(mFormat)))
     {
         ref<Texture> pOther = mpDevice->createTexture2D(
             getWidth(mipLevel),
@@ -620,24 +650,12 @@ void Texture::captureToFile(
             ResourceBindFlags::RenderTarget | ResourceBindFlags::ShaderResource
         );
         pContext->blit(getSRV(mipLevel, 1, arraySlice, 1), pOther->getRTV(0, 0, 1));
-        textureData = pContext->readTextureSubresource(pOther.get(), 0);
         resourceFormat = ResourceFormat::RGBA32Float;
+        return pContext->readTextureSubresource(pOther.get(), 0);
     }
-    else
-    {
-        uint32_t subresource = getSubresourceIndex(arraySlice, mipLevel);
-        textureData = pContext->readTextureSubresource(this, subresource);
-    }
-
-    uint32_t width = getWidth(mipLevel);
-    uint32_t height = getHeight(mipLevel);
-
-    auto func = [=]() { Bitmap::saveImage(path, width, height, format, exportFlags, resourceFormat, true, (void*)textureData.data()); };
 
-    if (async)
-        Threading::dispatchTask(func);
-    else
-        func();
+    uint32_t subresource = getSubresourceIndex(arraySlice, mipLevel);
+    return pContext->readTextureSubresource(this, subresource);
 }
 
 void Texture::uploadInitData(RenderContext* pRenderContext, const void* pData, bool autoGenMips)
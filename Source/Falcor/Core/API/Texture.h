@@ -292,6 +292,18 @@ public:
         bool async = true
     );
 
+    /**
+     * Read back a 2D texture subresource for saving to an image file with Bitmap::saveImage().
+     * HDR textures with less than 3 channels are converted to a format supported by the file format.
+     * This call blocks until the data is available.
+     * @param[in] mipLevel Requested mip level.
+     * @param[in] arraySlice Requested array slice.
+     * @param[in] format Destination file format.
+     * @param[out] resourceFormat Resource format of the returned data.
+     * @return Image data with tightly packed rows.
+     */
+    std::vector<uint8_t> readImageData(uint32_t mipLevel, uint32_t arraySlice, Bitmap::FileFormat format, ResourceFormat& resourceFormat);
+
     /**
      * Generates mipmaps for a specified texture object.
      * @param[in] pContext Used render context.
@@ -310,6 +322,11 @@ public:
      */
     const std::filesystem::path& getSourcePath() const { return mSourcePath; }
 
+    /**
+     * In case the texture was loaded from a file, use this to set the import flags used.
+     */
+    void setImportFlags(Bitmap::ImportFlags importFlags) { mImportFlags = importFlags; }
+
     /**
      * In case the texture was loaded from a file, get the import flags used.
      */
@@ -27,22 +27,26 @@
  **************************************************************************/
 #include "Plugin.h"
 #include "Utils/Logger.h"
+#include "Utils/Threading.h"
 #include "Utils/Timing/CpuTimer.h"
 
 #include <nlohmann/json.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <fstream>
+#include <thread>
+#include <tuple>
 
 namespace Falcor
 {
 
-PluginManager& PluginManager::instance()
+namespace
 {
-    static PluginManager sInstance;
-    return sInstance;
-}
+const char kManifestFilename[] = "plugins.manifest.json";
+const uint32_t kManifestVersion = 1;
 
-bool PluginManager::loadPluginByName(std::string_view name)
+std::filesystem::path getPluginPath(std::string_view name)
 {
     auto path = getRuntimeDirectory() / "plugins" / std::string(name);
 #if FALCOR_WINDOWS
@@ -50,18 +54,50 @@ bool PluginManager::loadPluginByName(std::string_view name)
 #elif FALCOR_LINUX
     path.replace_extension(".so");
 #endif
-    return loadPlugin(path);
+    return path;
+}
+} // namespace
+
+PluginManager& PluginManager::instance()
+{
+    static PluginManager sInstance;
+    return sInstance;
+}
+
+bool PluginManager::loadPluginByName(std::string_view name)
+{
+    return loadPlugin(getPluginPath(name));
 }
 
 bool PluginManager::loadPlugin(const std::filesystem::path& path)
 {
-    // Early exit if plugin is already loaded.
+    // Early exit if plugin is already loaded. If another thread is currently loading the same
+    // library (e.g. during lazy loading or preloading), wait for it to finish first.
     {
-        std::lock_guard<std::mutex> lock(mLibrariesMutex);
+        std::unique_lock<std::mutex> lock(mLibrariesMutex);
+        mLibrariesCondition.wait(lock, [&]() { return mLoadingLibraries.count(path) == 0; });
         if (mLibraries.find(path) != mLibraries.end())
             return false;
+        mLoadingLibraries.insert(path);
     }
 
+    try
+    {
+        auto [library, registerPluginProc] = openPluginLibrary(path);
+        registerPluginLibrary(path, library, registerPluginProc);
+    }
+    catch (...)
+    {
+        finishLoading(path);
+        throw;
+    }
+
+    finishLoading(path);
+    return true;
+}
+
+std::pair<SharedLibraryHandle, PluginManager::RegisterPluginProc> PluginManager::openPluginLibrary(const std::filesystem::path& path)
+{
     if (!std::filesystem::exists(path))
         FALCOR_THROW("Failed to load plugin library from {}. File not found.", path);
 
@@ -69,12 +105,22 @@ bool PluginManager::loadPlugin(const std::filesystem::path& path)
     if (library == nullptr)
         FALCOR_THROW("Failed to load plugin library from {}. Cannot load shared library.", path);
 
-    using RegisterPluginProc = void (*)(PluginRegistry&);
-
     auto registerPluginProc = (RegisterPluginProc)getProcAddress(library, "registerPlugin");
     if (registerPluginProc == nullptr)
+    {
+        releaseSharedLibrary(library);
         FALCOR_THROW("Failed to load plugin library from {}. Symbol 'registerPlugin' not found.", path);
+    }
+
+    return {library, registerPluginProc};
+}
 
+void PluginManager::registerPluginLibrary(
+    const std::filesystem::path& path,
+    SharedLibraryHandle library,
+    RegisterPluginProc registerPluginProc
+)
+{
     // Register plugin library.
     {
         std::lock_guard<std::mutex> lock(mLibrariesMutex);
@@ -86,8 +132,15 @@ bool PluginManager::loadPlugin(const std::filesystem::path& path)
         PluginRegistry registry(*this, library);
         registerPluginProc(registry);
     }
+}
 
-    return true;
+void PluginManager::finishLoading(const std::filesystem::path& path)
+{
+    {
+        std::lock_guard<std::mutex> lock(mLibrariesMutex);
+        mLoadingLibraries.erase(path);
+    }
+    mLibrariesCondition.notify_all();
 }
 
 bool PluginManager::releasePlugin(const std::filesystem::path& path)
@@ -122,11 +175,19 @@ bool PluginManager::releasePlugin(const std::filesystem::path& path)
     return true;
 }
 
-void PluginManager::loadAllPlugins()
+void PluginManager::loadAllPlugins(bool lazy)
 {
     CpuTimer timer;
     timer.update();
 
+    if (lazy && loadManifest(getRuntimeDirectory() / "plugins" / kManifestFilename))
+    {
+        timer.update();
+        std::lock_guard<std::mutex> lock(mManifestMutex);
+        logInfo("Loaded plugin manifest with {} plugin class(es) in {:.3}s", mManifestClasses.size(), timer.delta());
+        return;
+    }
+
     std::ifstream ifs(getRuntimeDirectory() / "plugins" / "plugins.json");
     auto json = nlohmann::json::parse(ifs);
     size_t loadedCount = 0;
@@ -156,4 +217,226 @@ void PluginManager::releaseAllPlugins()
     }
 }
 
+size_t PluginManager::preloadPlugins(size_t threadCount)
+{
+    CpuTimer timer;
+    timer.update();
+
+    std::vector<std::filesystem::path> libraries;
+    {
+        std::lock_guard<std::mutex> lock(mManifestMutex);
+        for (const auto& [type, manifestClass] : mManifestClasses)
+            libraries.push_back(manifestClass.library);
+    }
+    std::sort(libraries.begin(), libraries.end());
+    libraries.erase(std::unique(libraries.begin(), libraries.end()), libraries.end());
+
+    // Claim the libraries that are neither loaded nor being loaded by another call.
+    {
+        std::lock_guard<std::mutex> lock(mLibrariesMutex);
+        auto isTaken = [&](const std::filesystem::path& path)
+        { return mLibraries.find(path) != mLibraries.end() || mLoadingLibraries.count(path) != 0; };
+        libraries.erase(std::remove_if(libraries.begin(), libraries.end(), isTaken), libraries.end());
+        mLoadingLibraries.insert(libraries.begin(), libraries.end());
+    }
+
+    if (threadCount == 0)
+        threadCount = Threading::getLogicalThreadCount();
+    threadCount = std::max<size_t>(1, std::min(threadCount, libraries.size()));
+
+    // Open the shared libraries in parallel. This only maps the libraries and runs their static initializers.
+    struct OpenedLibrary
+    {
+        SharedLibraryHandle library = nullptr;
+        RegisterPluginProc registerPluginProc = nullptr;
+        std::string error;
+    };
+    std::vector<OpenedLibrary> opened(libraries.size());
+
+    std::atomic<size_t> nextIndex{0};
+    auto worker = [&]()
+    {
+        for (size_t i = nextIndex++; i < libraries.size(); i = nextIndex++)
+        {
+            try
+            {
+                std::tie(opened[i].library, opened[i].registerPluginProc) = openPluginLibrary(libraries[i]);
+            }
+            catch (const std::exception& e)
+            {
+                opened[i].error = e.what();
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < threadCount; ++i)
+        threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads)
+        thread.join();
+
+    // Register the plugin classes on the calling thread, as plugins may register script bindings.
+    size_t loadedCount = 0;
+    for (size_t i = 0; i < libraries.size(); ++i)
+    {
+        if (opened[i].error.empty())
+        {
+            try
+            {
+                registerPluginLibrary(libraries[i], opened[i].library, opened[i].registerPluginProc);
+                loadedCount++;
+            }
+            catch (const std::exception& e)
+            {
+                opened[i].error = e.what();
+            }
+        }
+        if (!opened[i].error.empty())
+            logWarning("Failed to preload plugin library {}: {}", libraries[i], opened[i].error);
+        finishLoading(libraries[i]);
+    }
+
+    timer.update();
+    if (loadedCount > 0)
+        logInfo("Preloaded {} plugin(s) in {:.3}s", loadedCount, timer.delta());
+
+    return loadedCount;
+}
+
+bool PluginManager::loadManifest(const std::filesystem::path& path)
+{
+    if (!std::filesystem::exists(path))
+        return false;
+
+    nlohmann::ordered_json json;
+    try
+    {
+        std::ifstream ifs(path);
+        json = nlohmann::ordered_json::parse(ifs);
+    }
+    catch (const std::exception& e)
+    {
+        logWarning("Failed to parse plugin manifest {}: {}", path, e.what());
+        return false;
+    }
+
+    if (json.value("version", 0u) != kManifestVersion)
+    {
+        logWarning("Ignoring plugin manifest {} with unsupported version.", path);
+        return false;
+    }
+
+    std::map<std::string, ManifestClass> classes;
+    for (const auto& jlibrary : json.at("libraries"))
+    {
+        auto library = getPluginPath(jlibrary.at("name").get<std::string>());
+        if (!std::filesystem::exists(library))
+        {
+            logWarning("Plugin library {} listed in plugin manifest {} does not exist.", library, path);
+            continue;
+        }
+        for (const auto& jclass : jlibrary.at("classes"))
+        {
+            ManifestClass manifestClass{jclass.at("base").get<std::string>(), library, std::nullopt};
+            if (auto it = jclass.find("info"); it != jclass.end())
+                manifestClass.info = Properties(*it);
+            classes.emplace(jclass.at("type").get<std::string>(), std::move(manifestClass));
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mManifestMutex);
+    for (auto& [type, manifestClass] : classes)
+        mManifestClasses.insert_or_assign(type, std::move(manifestClass));
+
+    return true;
+}
+
+void PluginManager::writeManifest(const std::filesystem::path& path) const
+{
+    std::map<SharedLibraryHandle, std::string> libraryNames;
+    {
+        std::lock_guard<std::mutex> lock(mLibrariesMutex);
+        for (const auto& [libraryPath, library] : mLibraries)
+            libraryNames[library] = libraryPath.stem().string();
+    }
+
+    std::map<std::string, nlohmann::ordered_json> libraryClasses;
+    {
+        std::lock_guard<std::mutex> lock(mClassDescsMutex);
+        for (const auto& [type, desc] : mClassDescs)
+        {
+            auto it = libraryNames.find(desc->library);
+            if (it == libraryNames.end())
+                continue;
+
+            nlohmann::ordered_json jclass{{"base", desc->getBaseType()}, {"type", desc->type}};
+            if (auto info = desc->getInfoProperties())
+                jclass["info"] = info->toJson();
+            libraryClasses[it->second].push_back(std::move(jclass));
+        }
+    }
+
+    nlohmann::ordered_json json{{"version", kManifestVersion}, {"libraries", nlohmann::ordered_json::array()}};
+    for (auto& [name, classes] : libraryClasses)
+        json["libraries"].push_back({{"name", name}, {"classes", std::move(classes)}});
+
+    std::ofstream ofs(path);
+    if (!ofs)
+        FALCOR_THROW("Failed to write plugin manifest to {}.", path);
+    ofs << json.dump(4) << std::endl;
+}
+
+void PluginManager::loadClassLibrary(std::string_view baseType, std::string_view type) const
+{
+    std::filesystem::path library;
+    {
+        std::lock_guard<std::mutex> lock(mManifestMutex);
+        auto it = mManifestClasses.find(std::string(type));
+        if (it == mManifestClasses.end() || it->second.baseType != baseType)
+            return;
+        library = it->second.library;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mClassDescsMutex);
+        if (mClassDescs.find(std::string(type)) != mClassDescs.end())
+            return;
+    }
+
+    // Lazy loading only adds classes that were already advertised by the manifest.
+    const_cast<PluginManager*>(this)->loadPlugin(library);
+}
+
+void PluginManager::loadBaseClassLibraries(std::string_view baseType) const
+{
+    std::set<std::filesystem::path> libraries;
+    {
+        std::lock_guard<std::mutex> lock(mManifestMutex);
+        for (const auto& [type, manifestClass] : mManifestClasses)
+            if (manifestClass.baseType == baseType)
+                libraries.insert(manifestClass.library);
+    }
+
+    for (const auto& library : libraries)
+        const_cast<PluginManager*>(this)->loadPlugin(library);
+}
+
+bool PluginManager::hasManifestClass(std::string_view baseType, std::string_view type) const
+{
+    std::lock_guard<std::mutex> lock(mManifestMutex);
+    auto it = mManifestClasses.find(std::string(type));
+    return it != mManifestClasses.end() && it->second.baseType == baseType;
+}
+
+std::vector<std::pair<std::string, Properties>> PluginManager::getManifestInfos(std::string_view baseType) const
+{
+    std::lock_guard<std::mutex> lock(mManifestMutex);
+    std::vector<std::pair<std::string, Properties>> result;
+    for (const auto& [type, manifestClass] : mManifestClasses)
+        if (manifestClass.baseType == baseType && manifestClass.info)
+            result.emplace_back(type, *manifestClass.info);
+    return result;
+}
+
 } // namespace Falcor
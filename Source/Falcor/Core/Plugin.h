@@ -30,18 +30,25 @@
 #include "Core/Macros.h"
 #include "Core/Error.h"
 #include "Core/Platform/OS.h"
+#include "Utils/Properties.h"
 
+#include <condition_variable>
 #include <filesystem>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <set>
 #include <string>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace Falcor
 {
 
+class PluginRegistry;
+
 /**
  * @brief Plugin manager for loading plugin libraries and creating plugin instances.
  *
@@ -102,7 +109,20 @@ namespace Falcor
  * PluginBase* p = PluginManager::instance().createClass<PluginBase>("PluginA");
  * @endcode
  *
- * The `getInfos` function returns a list of plugin infos for all loaded plugin types of a given plugin base class.
+ * The `getInfos` function returns a list of plugin infos for all available plugin types of a given plugin base class.
+ *
+ * Plugin libraries can also be loaded lazily. The build generates a _plugin manifest_ (`plugins/plugins.manifest.json`)
+ * listing every plugin class together with the library it lives in. When lazy loading is requested and the manifest
+ * is available, `loadAllPlugins` only reads the manifest and a plugin library is loaded on first use, i.e. when one
+ * of its classes is created. Plugin infos that are serializable (have a `serialize` method) are stored in the manifest,
+ * so `getInfos` can return them without loading any library. For other plugin base classes, `getInfos` loads all
+ * libraries providing classes of that base class. Note that script bindings registered by a plugin library are only
+ * available once the library is loaded, which is why lazy loading is opt-in.
+ *
+ * Plugin libraries register their classes and script bindings in `registerPlugin`, which must run on the main thread.
+ * All functions that may load a plugin library (including `createClass` and `getInfos` with lazy loading) therefore
+ * need to be called from the main thread. The exception is `preloadPlugins`, which opens the libraries on worker
+ * threads but calls `registerPlugin` on the calling thread.
  */
 class FALCOR_API PluginManager
 {
@@ -122,6 +142,8 @@ public:
     template<typename BaseT, typename... Args>
     std::invoke_result_t<typename BaseT::PluginCreate, Args...> createClass(std::string_view type, Args... args) const
     {
+        loadClassLibrary(BaseT::getPluginBaseType(), type);
+
         std::lock_guard<std::mutex> lock(mClassDescsMutex);
         const ClassDesc<BaseT>* classDesc = findClassDesc<BaseT>(type);
         return classDesc ? classDesc->create(args...) : std::invoke_result_t<typename BaseT::PluginCreate, Args...>{nullptr};
@@ -129,6 +151,7 @@ public:
 
     /**
      * @brief Check if a given type of a plugin is available.
+     * A plugin type is available if it is registered or listed in the plugin manifest.
      *
      * @tparam BaseT The plugin base class.
      * @param type The plugin type name.
@@ -137,28 +160,46 @@ public:
     template<typename BaseT>
     bool hasClass(std::string_view type) const
     {
-        std::lock_guard<std::mutex> lock(mClassDescsMutex);
-        const ClassDesc<BaseT>* classDesc = findClassDesc<BaseT>(type);
-        return classDesc != nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mClassDescsMutex);
+            if (findClassDesc<BaseT>(type) != nullptr)
+                return true;
+        }
+        return hasManifestClass(BaseT::getPluginBaseType(), type);
     }
 
     /**
-     * @brief Get infos for all registered plugin types for a given plugin base class.
+     * @brief Get infos for all available plugin types for a given plugin base class.
+     * Infos of classes that are not loaded yet are read from the plugin manifest if the info type is serializable,
+     * otherwise the libraries providing classes of the base class are loaded first.
      *
      * @tparam BaseT The plugin base class.
-     * @return A list of infos.
+     * @return A list of infos, sorted by plugin type name.
      */
     template<typename BaseT>
     std::vector<std::pair<std::string, typename BaseT::PluginInfo>> getInfos() const
     {
-        std::lock_guard<std::mutex> lock(mClassDescsMutex);
-        std::vector<std::pair<std::string, typename BaseT::PluginInfo>> result;
-
-        for (const auto& [name, desc] : mClassDescs)
-            if (auto matchDesc = dynamic_cast<const ClassDesc<BaseT>*>(desc.get()))
-                result.push_back(std::make_pair(matchDesc->type, matchDesc->info));
-
-        return result;
+        using InfoT = typename BaseT::PluginInfo;
+
+        if constexpr (!detail::has_serialize_v<InfoT>)
+            loadBaseClassLibraries(BaseT::getPluginBaseType());
+
+        std::map<std::string, InfoT> infos;
+        {
+            std::lock_guard<std::mutex> lock(mClassDescsMutex);
+            for (const auto& [name, desc] : mClassDescs)
+                if (auto matchDesc = dynamic_cast<const ClassDesc<BaseT>*>(desc.get()))
+                    infos.emplace(matchDesc->type, matchDesc->info);
+        }
+
+        if constexpr (detail::has_serialize_v<InfoT>)
+        {
+            for (const auto& [type, props] : getManifestInfos(BaseT::getPluginBaseType()))
+                if (infos.find(type) == infos.end())
+                    infos.emplace(type, deserializeFromProperties<InfoT>(props));
+        }
+
+        return std::vector<std::pair<std::string, InfoT>>(infos.begin(), infos.end());
     }
 
     /**
@@ -185,8 +226,36 @@ public:
 
     /**
      * Load all plugin libraries.
+     * By default all plugin libraries listed in `plugins/plugins.json` are loaded. If `lazy` is set and the plugin
+     * manifest is available, only the manifest is read and plugin libraries are loaded on first use.
+     * Script bindings of lazily loaded libraries are not available before the library is loaded.
+     * @param lazy Load plugin libraries on first use if the plugin manifest is available.
+     */
+    void loadAllPlugins(bool lazy = false);
+
+    /**
+     * Load all plugin libraries listed in the plugin manifest that are not loaded yet.
+     * The shared libraries are opened in parallel on worker threads, while their `registerPlugin` functions are
+     * called sequentially on the calling thread, which must be the main thread.
+     * @param threadCount Number of loader threads (0 to use the hardware concurrency).
+     * @return Number of newly loaded plugin libraries.
      */
-    void loadAllPlugins();
+    size_t preloadPlugins(size_t threadCount = 0);
+
+    /**
+     * Load a plugin manifest, adding its classes to the set of lazily loadable plugin classes.
+     * Entries referring to missing plugin libraries are skipped.
+     * @param path File path of the manifest.
+     * @return True if the manifest was loaded.
+     */
+    bool loadManifest(const std::filesystem::path& path);
+
+    /**
+     * Write a plugin manifest describing all currently registered plugin classes.
+     * This is run at build time after loading all plugin libraries.
+     * @param path File path of the manifest.
+     */
+    void writeManifest(const std::filesystem::path& path) const;
 
     /**
      * Release all loaded plugin libraries.
@@ -199,6 +268,9 @@ private:
         ClassDescBase(SharedLibraryHandle library, std::string_view type) : library(library), type(type) {}
         virtual ~ClassDescBase() {}
 
+        virtual const std::string& getBaseType() const = 0;
+        virtual std::optional<Properties> getInfoProperties() const = 0;
+
         SharedLibraryHandle library;
         std::string type;
     };
@@ -212,8 +284,41 @@ private:
         ClassDesc(SharedLibraryHandle library, std::string_view type, typename BaseT::PluginInfo info, typename BaseT::PluginCreate create)
             : ClassDescBase(library, type), info(info), create(create)
         {}
+
+        const std::string& getBaseType() const override { return BaseT::getPluginBaseType(); }
+
+        std::optional<Properties> getInfoProperties() const override
+        {
+            if constexpr (detail::has_serialize_v<typename BaseT::PluginInfo>)
+                return serializeToProperties(info);
+            else
+                return std::nullopt;
+        }
+    };
+
+    /// Plugin class listed in the plugin manifest.
+    struct ManifestClass
+    {
+        std::string baseType;
+        std::filesystem::path library;
+        std::optional<Properties> info;
     };
 
+    using RegisterPluginProc = void (*)(PluginRegistry&);
+
+    /// Open a plugin library and look up its `registerPlugin` function. This is safe to call on any thread.
+    static std::pair<SharedLibraryHandle, RegisterPluginProc> openPluginLibrary(const std::filesystem::path& path);
+    /// Register an opened plugin library and its classes. This must be called on the main thread.
+    void registerPluginLibrary(const std::filesystem::path& path, SharedLibraryHandle library, RegisterPluginProc registerPluginProc);
+    /// Mark a plugin library as no longer being loaded and wake up threads waiting for it.
+    void finishLoading(const std::filesystem::path& path);
+    /// Load the library providing a plugin class listed in the manifest, unless the class is already registered.
+    void loadClassLibrary(std::string_view baseType, std::string_view type) const;
+    /// Load all libraries providing plugin classes of the given base class that are listed in the manifest.
+    void loadBaseClassLibraries(std::string_view baseType) const;
+    bool hasManifestClass(std::string_view baseType, std::string_view type) const;
+    std::vector<std::pair<std::string, Properties>> getManifestInfos(std::string_view baseType) const;
+
     template<typename BaseT>
     void registerClass(
         SharedLibraryHandle library,
@@ -244,10 +349,14 @@ private:
     }
 
     std::map<std::filesystem::path, SharedLibraryHandle> mLibraries;
+    std::set<std::filesystem::path> mLoadingLibraries; ///< Libraries currently being loaded.
     std::map<std::string, std::shared_ptr<ClassDescBase>> mClassDescs;
+    std::map<std::string, ManifestClass> mManifestClasses;
 
     mutable std::mutex mLibrariesMutex;
     mutable std::mutex mClassDescsMutex;
+    mutable std::mutex mManifestMutex;
+    std::condition_variable mLibrariesCondition;
 
     friend class PluginRegistry;
 };
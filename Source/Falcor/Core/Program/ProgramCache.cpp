@@ -0,0 +1,309 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "ProgramCache.h"
+#include "Core/Error.h"
+#include "Utils/Logger.h"
+
+#include <fmt/format.h>
+
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <thread>
+#include <type_traits>
+
+namespace Falcor
+{
+namespace
+{
+/// Magic number and version of the entry file format. Increment the version when the format changes.
+const uint32_t kEntryMagic = 0x45435046; // 'FPCE'
+const uint32_t kEntryVersion = 1;
+
+const char kEntryExtension[] = ".slang-cache";
+
+class EntryWriter
+{
+public:
+    template<typename T>
+    void write(const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        writeBytes(&value, sizeof(T));
+    }
+
+    void writeString(const std::string& str)
+    {
+        write(uint64_t(str.size()));
+        writeBytes(str.data(), str.size());
+    }
+
+    void writeBytes(const void* data, size_t size)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        mData.insert(mData.end(), bytes, bytes + size);
+    }
+
+    const std::vector<uint8_t>& getData() const { return mData; }
+
+private:
+    std::vector<uint8_t> mData;
+};
+
+class EntryReader
+{
+public:
+    EntryReader(const std::vector<uint8_t>& data) : mData(data) {}
+
+    template<typename T>
+    T read()
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value;
+        readBytes(&value, sizeof(T));
+        return value;
+    }
+
+    std::string readString()
+    {
+        std::string str(readSize(), '\0');
+        readBytes(str.data(), str.size());
+        return str;
+    }
+
+    std::vector<uint8_t> readByteArray()
+    {
+        std::vector<uint8_t> bytes(readSize());
+        readBytes(bytes.data(), bytes.size());
+        return bytes;
+    }
+
+    void readBytes(void* data, size_t size)
+    {
+        if (size > mData.size() - mOffset)
+            FALCOR_THROW("Unexpected end of data");
+        std::memcpy(data, mData.data() + mOffset, size);
+        mOffset += size;
+    }
+
+    bool isAtEnd() const { return mOffset == mData.size(); }
+
+private:
+    size_t readSize()
+    {
+        uint64_t size = read<uint64_t>();
+        if (size > mData.size() - mOffset)
+            FALCOR_THROW("Invalid size");
+        return size_t(size);
+    }
+
+    const std::vector<uint8_t>& mData;
+    size_t mOffset = 0;
+};
+
+std::optional<std::vector<uint8_t>> readBinaryFile(const std::filesystem::path& path)
+{
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream)
+        return {};
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+    if (stream.bad())
+        return {};
+    return data;
+}
+} // namespace
+
+ProgramCache::ProgramCache(std::filesystem::path directory) : mDirectory(std::move(directory))
+{
+    // Remove temporary files of writes that were interrupted.
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(mDirectory, ec))
+    {
+        if (entry.is_regular_file(ec) && entry.path().extension() == ".tmp")
+            std::filesystem::remove(entry.path(), ec);
+    }
+}
+
+std::optional<ProgramCache::Entry> ProgramCache::load(const Key& key)
+{
+    std::filesystem::path entryPath = getEntryPath(key);
+    auto data = readBinaryFile(entryPath);
+    if (!data)
+        return {};
+
+    Entry entry;
+    try
+    {
+        EntryReader reader(*data);
+        if (reader.read<uint32_t>() != kEntryMagic || reader.read<uint32_t>() != kEntryVersion)
+            FALCOR_THROW("Unsupported format");
+
+        entry.compileTime = reader.read<double>();
+
+        // Check that all source files are unchanged.
+        uint64_t dependencyCount = reader.read<uint64_t>();
+        for (uint64_t i = 0; i < dependencyCount; ++i)
+        {
+            std::filesystem::path path = std::filesystem::u8path(reader.readString());
+            SHA1::MD hash = reader.read<SHA1::MD>();
+            auto currentHash = getFileHash(path);
+            if (!currentHash || *currentHash != hash)
+            {
+                logDebug("Program cache entry '{}' is stale, '{}' has changed.", entryPath, path);
+                return {};
+            }
+            entry.dependencies.push_back(std::move(path));
+        }
+
+        uint64_t moduleCount = reader.read<uint64_t>();
+        for (uint64_t i = 0; i < moduleCount; ++i)
+        {
+            Module module;
+            module.name = reader.readString();
+            module.path = reader.readString();
+            module.ir = reader.readByteArray();
+            entry.modules.push_back(std::move(module));
+        }
+
+        uint64_t shaderModuleCount = reader.read<uint64_t>();
+        for (uint64_t i = 0; i < shaderModuleCount; ++i)
+        {
+            uint32_t index = reader.read<uint32_t>();
+            if (index >= entry.modules.size())
+                FALCOR_THROW("Invalid module index");
+            entry.shaderModuleIndices.push_back(index);
+        }
+
+        if (!reader.isAtEnd())
+            FALCOR_THROW("Unexpected trailing data");
+    }
+    catch (const std::exception& e)
+    {
+        logWarning("Invalid program cache entry '{}': {}. Ignoring the entry.", entryPath, e.what());
+        return {};
+    }
+
+    return entry;
+}
+
+void ProgramCache::store(const Key& key, const Entry& entry)
+{
+    EntryWriter writer;
+    writer.write(kEntryMagic);
+    writer.write(kEntryVersion);
+    writer.write(entry.compileTime);
+
+    writer.write(uint64_t(entry.dependencies.size()));
+    for (const auto& path : entry.dependencies)
+    {
+        auto hash = getFileHash(path);
+        if (!hash)
+        {
+            logWarning("Failed to store program cache entry, can't read source file '{}'.", path);
+            return;
+        }
+        writer.writeString(path.u8string());
+        writer.write(*hash);
+    }
+
+    writer.write(uint64_t(entry.modules.size()));
+    for (const auto& module : entry.modules)
+    {
+        writer.writeString(module.name);
+        writer.writeString(module.path);
+        writer.write(uint64_t(module.ir.size()));
+        writer.writeBytes(module.ir.data(), module.ir.size());
+    }
+
+    writer.write(uint64_t(entry.shaderModuleIndices.size()));
+    for (uint32_t index : entry.shaderModuleIndices)
+        writer.write(index);
+
+    // Write to a temporary file first, so that concurrent readers never see partially written entries.
+    std::filesystem::path entryPath = getEntryPath(key);
+    std::filesystem::path tmpPath = entryPath;
+    tmpPath += fmt::format(".{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    try
+    {
+        std::filesystem::create_directories(mDirectory);
+        {
+            std::ofstream stream(tmpPath, std::ios::binary | std::ios::trunc);
+            stream.write(reinterpret_cast<const char*>(writer.getData().data()), writer.getData().size());
+            if (!stream)
+                FALCOR_THROW("Failed to write '{}'", tmpPath);
+        }
+        std::filesystem::rename(tmpPath, entryPath);
+    }
+    catch (const std::exception& e)
+    {
+        std::error_code ec;
+        std::filesystem::remove(tmpPath, ec);
+        logWarning("Failed to store program cache entry '{}': {}", entryPath, e.what());
+    }
+}
+
+void ProgramCache::clear()
+{
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(mDirectory, ec))
+    {
+        if (entry.is_regular_file(ec) && entry.path().extension() == kEntryExtension)
+            std::filesystem::remove(entry.path(), ec);
+    }
+}
+
+std::optional<SHA1::MD> ProgramCache::getFileHash(const std::filesystem::path& path)
+{
+    std::error_code ec;
+    auto time = std::filesystem::last_write_time(path, ec);
+    if (ec)
+        return {};
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mFileHashes.find(path);
+        if (it != mFileHashes.end() && it->second.time == time)
+            return it->second.hash;
+    }
+
+    auto data = readBinaryFile(path);
+    if (!data)
+        return {};
+    SHA1::MD hash = SHA1::compute(data->data(), data->size());
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mFileHashes[path] = {time, hash};
+    return hash;
+}
+
+std::filesystem::path ProgramCache::getEntryPath(const Key& key) const
+{
+    return mDirectory / (SHA1::toString(key) + kEntryExtension);
+}
+} // namespace Falcor
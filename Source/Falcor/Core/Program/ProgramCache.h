@@ -0,0 +1,122 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Utils/CryptoUtils.h"
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * Persistent on-disk cache of Slang front-end results.
+ *
+ * Creating a program version runs the Slang front-end (parsing, semantic checking and linking)
+ * for all modules of the program. The program cache stores the serialized Slang IR of these modules,
+ * including all transitively imported modules, so that later runs can load the IR instead.
+ *
+ * Entries are keyed by a hash of all compilation inputs (see ProgramManager), and record the content
+ * hashes of all source files they were compiled from. An entry is only returned if all its source
+ * files are unchanged, so modified shaders are always recompiled. File hashes are computed once per
+ * file and modification time, so validating many entries depending on the same files is cheap.
+ *
+ * All operations are thread-safe.
+ */
+class FALCOR_API ProgramCache
+{
+public:
+    using Key = SHA1::MD;
+
+    /// Serialized Slang module.
+    struct Module
+    {
+        std::string name;        ///< Module name.
+        std::string path;        ///< Module file path, or empty if the module was not loaded from a file.
+        std::vector<uint8_t> ir; ///< Serialized Slang IR.
+    };
+
+    struct Entry
+    {
+        /// Modules in load order, i.e., each module comes after the modules it imports.
+        std::vector<Module> modules;
+        /// Index into 'modules' for each shader module of the program.
+        std::vector<uint32_t> shaderModuleIndices;
+        /// Source files the modules were compiled from.
+        std::vector<std::filesystem::path> dependencies;
+        /// Time in seconds it took to compile the modules from source.
+        double compileTime = 0.0;
+    };
+
+    /**
+     * Constructor. Removes temporary files left over from interrupted writes.
+     * @param[in] directory Cache directory. Created on the first write if it does not exist.
+     */
+    ProgramCache(std::filesystem::path directory);
+
+    const std::filesystem::path& getDirectory() const { return mDirectory; }
+
+    /**
+     * Load a cache entry.
+     * @param[in] key Entry key.
+     * @return The entry, or an empty optional if there is no entry, it is unreadable, or any of its source files changed.
+     */
+    std::optional<Entry> load(const Key& key);
+
+    /**
+     * Store a cache entry, replacing any existing entry with the same key.
+     * The content hashes of the dependencies are computed from the files on disk.
+     * Failure to write the entry is logged but not an error.
+     * @param[in] key Entry key.
+     * @param[in] entry The entry.
+     */
+    void store(const Key& key, const Entry& entry);
+
+    /**
+     * Remove all cache entries.
+     */
+    void clear();
+
+private:
+    struct FileHash
+    {
+        std::filesystem::file_time_type time;
+        SHA1::MD hash;
+    };
+
+    std::optional<SHA1::MD> getFileHash(const std::filesystem::path& path);
+    std::filesystem::path getEntryPath(const Key& key) const;
+
+    std::filesystem::path mDirectory;
+    std::mutex mMutex;
+    std::map<std::filesystem::path, FileHash> mFileHashes; ///< Content hashes of source files, valid as long as the modification time matches.
+};
+} // namespace Falcor
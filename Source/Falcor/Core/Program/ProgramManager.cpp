@@ -28,11 +28,18 @@
 #include "ProgramManager.h"
 #include "Core/API/Device.h"
 #include "Core/Platform/OS.h"
+#include "Utils/CryptoUtils.h"
 #include "Utils/Logger.h"
 #include "Utils/Timing/CpuTimer.h"
+#include "Utils/Timing/Profiler.h"
 
 #include <slang.h>
 
+#include <algorithm>
+#include <atomic>
+#include <execution>
+#include <map>
+
 namespace Falcor
 {
 
@@ -100,6 +107,59 @@ inline bool doSlangReflection(
     return true;
 }
 
+namespace
+{
+/// Slang blob holding a byte array. Used to pass serialized modules to Slang.
+class ByteArrayBlob : public ISlangBlob
+{
+public:
+    ByteArrayBlob(std::vector<uint8_t> data) : mData(std::move(data)) {}
+    virtual ~ByteArrayBlob() = default;
+
+    virtual SLANG_NO_THROW SlangResult SLANG_MCALL queryInterface(SlangUUID const& uuid, void** outObject) override
+    {
+        if (uuid == ISlangUnknown::getTypeGuid() || uuid == ISlangBlob::getTypeGuid())
+        {
+            addRef();
+            *outObject = static_cast<ISlangBlob*>(this);
+            return SLANG_OK;
+        }
+        *outObject = nullptr;
+        return SLANG_E_NO_INTERFACE;
+    }
+    virtual SLANG_NO_THROW uint32_t SLANG_MCALL addRef() override { return ++mRefCount; }
+    virtual SLANG_NO_THROW uint32_t SLANG_MCALL release() override
+    {
+        uint32_t refCount = --mRefCount;
+        if (refCount == 0)
+            delete this;
+        return refCount;
+    }
+    virtual SLANG_NO_THROW void const* SLANG_MCALL getBufferPointer() override { return mData.data(); }
+    virtual SLANG_NO_THROW size_t SLANG_MCALL getBufferSize() override { return mData.size(); }
+
+private:
+    std::vector<uint8_t> mData;
+    std::atomic<uint32_t> mRefCount{0};
+};
+} // namespace
+
+/// Rename an entry point in the generated code if the exported name differs from the source name.
+/// This makes it possible to generate different specializations of the same source entry point,
+/// for example by setting different type conformances.
+inline Slang::ComPtr<slang::IComponentType> getExportedEntryPoint(
+    Slang::ComPtr<slang::IComponentType> pSlangEntryPoint,
+    const ProgramDesc::EntryPoint& entryPoint
+)
+{
+    if (entryPoint.exportName == entryPoint.name)
+        return pSlangEntryPoint;
+
+    Slang::ComPtr<slang::IComponentType> pRenamedEntryPoint;
+    pSlangEntryPoint->renameEntryPoint(entryPoint.exportName.c_str(), pRenamedEntryPoint.writeRef());
+    return pRenamedEntryPoint;
+}
+
 ProgramManager::ProgramManager(Device* pDevice) : mpDevice(pDevice)
 {
     // Set global shader defines
@@ -114,14 +174,74 @@ ProgramManager::ProgramManager(Device* pDevice) : mpDevice(pDevice)
 
     addGlobalDefines(globalDefines);
 
+    const std::string& programCachePath = mpDevice->getDesc().programCachePath;
+    if (!programCachePath.empty())
+        mpProgramCache = std::make_unique<ProgramCache>(programCachePath);
+}
+
+ProgramManager::~ProgramManager()
+{
+    const auto& s = mCompilationStats;
+    if (s.programCacheHitCount + s.programCacheMissCount > 0)
+    {
+        logInfo(
+            "Program cache: {} hits, {} misses, saved {:.2f} s of shader front-end compilation.",
+            s.programCacheHitCount,
+            s.programCacheMissCount,
+            s.programCacheTimeSaved
+        );
+    }
 }
 
 ref<const ProgramVersion> ProgramManager::createProgramVersion(const Program& program, std::string& log) const
+{
+    return createProgramVersion(program, program.getDefineList(), mpDevice->getSlangGlobalSession(), log);
+}
+
+ref<const ProgramVersion> ProgramManager::createProgramVersion(
+    const Program& program,
+    const DefineList& defineList,
+    slang::IGlobalSession* pSlangGlobalSession,
+    std::string& log
+) const
 {
     CpuTimer timer;
     timer.update();
 
-    auto pSlangRequest = createSlangCompileRequest(program);
+    // Try to load the program version from the program cache, which skips the Slang front-end.
+    ProgramCache::Key cacheKey;
+    if (mpProgramCache)
+    {
+        cacheKey = computeProgramCacheKey(program, defineList);
+        if (auto entry = mpProgramCache->load(cacheKey))
+        {
+            std::string cacheLog;
+            if (auto pVersion = loadProgramVersionFromCache(program, defineList, pSlangGlobalSession, *entry, cacheLog))
+            {
+                timer.update();
+                double time = timer.delta();
+                double timeSaved = std::max(entry->compileTime - time, 0.0);
+                {
+                    std::lock_guard<std::mutex> lock(mCompilationStatsMutex);
+                    mCompilationStats.programVersionCount++;
+                    mCompilationStats.programVersionTotalTime += time;
+                    mCompilationStats.programVersionMaxTime = std::max(mCompilationStats.programVersionMaxTime, time);
+                    mCompilationStats.programCacheHitCount++;
+                    mCompilationStats.programCacheTimeSaved += timeSaved;
+                }
+                logDebug("Loaded program version from cache in {:.3f} s (saved {:.3f} s): {}", time, timeSaved, program.getProgramDescString());
+                return pVersion;
+            }
+            logDebug("Failed to load program version from cache, compiling from source: {}\n{}", program.getProgramDescString(), cacheLog);
+        }
+        {
+            std::lock_guard<std::mutex> lock(mCompilationStatsMutex);
+            mCompilationStats.programCacheMissCount++;
+        }
+        logDebug("Program cache miss: {}", program.getProgramDescString());
+    }
+
+    auto pSlangRequest = createSlangCompileRequest(program, defineList, pSlangGlobalSession);
     if (pSlangRequest == nullptr)
         return nullptr;
 
@@ -146,30 +266,21 @@ ref<const ProgramVersion> ProgramManager::createProgramVersion(const Program& pr
         {
             Slang::ComPtr<slang::IComponentType> pSlangEntryPoint;
             spCompileRequest_getEntryPoint(pSlangRequest, entryPoint.globalIndex, pSlangEntryPoint.writeRef());
-
-            // Rename entry point in the generated code if the exported name differs from the source name.
-            // This makes it possible to generate different specializations of the same source entry point,
-            // for example by setting different type conformances.
-            if (entryPoint.exportName != entryPoint.name)
-            {
-                Slang::ComPtr<slang::IComponentType> pRenamedEntryPoint;
-                pSlangEntryPoint->renameEntryPoint(entryPoint.exportName.c_str(), pRenamedEntryPoint.writeRef());
-                pSlangEntryPoints.push_back(pRenamedEntryPoint);
-            }
-            else
-            {
-                pSlangEntryPoints.push_back(pSlangEntryPoint);
-            }
+            pSlangEntryPoints.push_back(getExportedEntryPoint(pSlangEntryPoint, entryPoint));
         }
     }
 
     // Extract list of files referenced, for dependency-tracking purposes.
+    std::vector<std::filesystem::path> dependencies;
     int depFileCount = spGetDependencyFileCount(pSlangRequest);
     for (int ii = 0; ii < depFileCount; ++ii)
     {
         std::string depFilePath = spGetDependencyFilePath(pSlangRequest, ii);
         if (std::filesystem::exists(depFilePath))
+        {
             program.mFileTimeMap[depFilePath] = getFileModifiedTime(depFilePath);
+            dependencies.push_back(depFilePath);
+        }
     }
 
     // Note: the `ProgramReflection` needs to be able to refer back to the
@@ -205,18 +316,138 @@ ref<const ProgramVersion> ProgramManager::createProgramVersion(const Program& pr
     }
 
     auto descStr = program.getProgramDescString();
-    pVersion->init(program.getDefineList(), pReflector, descStr, pSlangEntryPoints);
+    pVersion->init(defineList, pReflector, descStr, pSlangEntryPoints);
 
     timer.update();
     double time = timer.delta();
-    mCompilationStats.programVersionCount++;
-    mCompilationStats.programVersionTotalTime += time;
-    mCompilationStats.programVersionMaxTime = std::max(mCompilationStats.programVersionMaxTime, time);
+    {
+        std::lock_guard<std::mutex> lock(mCompilationStatsMutex);
+        mCompilationStats.programVersionCount++;
+        mCompilationStats.programVersionTotalTime += time;
+        mCompilationStats.programVersionMaxTime = std::max(mCompilationStats.programVersionMaxTime, time);
+    }
     logDebug("Created program version in {:.3f} s: {}", timer.delta(), descStr);
 
+    if (mpProgramCache)
+        storeProgramVersionInCache(cacheKey, pSlangRequest, program, std::move(dependencies), time);
+
     return pVersion;
 }
 
+void ProgramManager::prewarmPrograms(const std::vector<ProgramVersionRequest>& requests)
+{
+    CpuTimer timer;
+    timer.update();
+
+    // Group the requested versions by program. The versions of a program are compiled one after another
+    // on the same worker, since compiling a version updates the file tracking state of the program.
+    struct Job
+    {
+        const Program* pProgram;
+        std::vector<DefineList> defineLists;
+        std::vector<ref<const ProgramVersion>> versions;
+    };
+    std::vector<Job> jobs;
+    std::map<const Program*, size_t> jobIndices;
+    for (const auto& request : requests)
+    {
+        FALCOR_CHECK(request.pProgram, "'pProgram' must not be null.");
+        const Program& program = *request.pProgram;
+
+        DefineList defineList = program.getDefineList();
+        defineList.add(request.defines);
+        if (program.mProgramVersions.count(Program::ProgramVersionKey{defineList, program.mTypeConformanceList}) > 0)
+            continue;
+
+        auto [it, inserted] = jobIndices.try_emplace(&program, jobs.size());
+        if (inserted)
+            jobs.push_back({&program});
+        auto& defineLists = jobs[it->second].defineLists;
+        if (std::find(defineLists.begin(), defineLists.end(), defineList) == defineLists.end())
+            defineLists.push_back(std::move(defineList));
+    }
+    if (jobs.empty())
+        return;
+
+    RenderContext* pRenderContext = mpDevice->getRenderContext();
+
+    // Compile the program versions concurrently. A Slang global session is not thread-safe,
+    // so each worker compiles with a global session of its own.
+    {
+        FALCOR_PROFILE(pRenderContext, "createProgramVersions");
+
+        const std::string hlslPrelude = getHlslLanguagePrelude();
+        std::for_each(
+            std::execution::par,
+            jobs.begin(),
+            jobs.end(),
+            [&](Job& job)
+            {
+                Slang::ComPtr<slang::IGlobalSession> pSlangGlobalSession = acquireWorkerSlangGlobalSession(hlslPrelude);
+                if (!pSlangGlobalSession)
+                {
+                    job.versions.resize(job.defineLists.size());
+                    return;
+                }
+                for (const auto& defineList : job.defineLists)
+                {
+                    ref<const ProgramVersion> pVersion;
+                    std::string log;
+                    try
+                    {
+                        pVersion = createProgramVersion(*job.pProgram, defineList, pSlangGlobalSession, log);
+                    }
+                    catch (const std::exception& e)
+                    {
+                        log += e.what();
+                    }
+                    if (!pVersion)
+                        logWarning("Failed to prewarm program:\n{}\n\n{}", job.pProgram->getProgramDescString(), log);
+                    job.versions.push_back(pVersion);
+                }
+                releaseWorkerSlangGlobalSession(std::move(pSlangGlobalSession));
+            }
+        );
+    }
+
+    // Hand the versions over to their programs and create the kernels. Kernel creation goes through
+    // the GFX device, which is not thread-safe, so it runs on the calling thread after all workers finished.
+    size_t versionCount = 0;
+    {
+        FALCOR_PROFILE(pRenderContext, "createProgramKernels");
+
+        for (const auto& job : jobs)
+        {
+            for (size_t i = 0; i < job.versions.size(); ++i)
+            {
+                const auto& pVersion = job.versions[i];
+                if (!pVersion)
+                    continue;
+                job.pProgram->mProgramVersions[Program::ProgramVersionKey{job.defineLists[i], job.pProgram->mTypeConformanceList}] =
+                    pVersion;
+                try
+                {
+                    pVersion->getKernels(mpDevice, nullptr);
+                }
+                catch (const std::exception& e)
+                {
+                    logWarning("Failed to prewarm program kernels:\n{}\n\n{}", job.pProgram->getProgramDescString(), e.what());
+                }
+                versionCount++;
+            }
+        }
+    }
+
+    timer.update();
+    double time = timer.delta();
+    {
+        std::lock_guard<std::mutex> lock(mCompilationStatsMutex);
+        mCompilationStats.programPrewarmCount += versionCount;
+        mCompilationStats.programPrewarmTime += time;
+    }
+    logInfo("Prewarmed {} program versions of {} programs in {:.2f} s.", versionCount, jobs.size(), time);
+}
+
 ref<const ProgramKernels> ProgramManager::createProgramKernels(
     const Program& program,
     const ProgramVersion& programVersion,
@@ -500,9 +731,12 @@ ref<const ProgramKernels> ProgramManager::createProgramKernels(
 
     timer.update();
     double time = timer.delta();
-    mCompilationStats.programKernelsCount++;
-    mCompilationStats.programKernelsTotalTime += time;
-    mCompilationStats.programKernelsMaxTime = std::max(mCompilationStats.programKernelsMaxTime, time);
+    {
+        std::lock_guard<std::mutex> lock(mCompilationStatsMutex);
+        mCompilationStats.programKernelsCount++;
+        mCompilationStats.programKernelsTotalTime += time;
+        mCompilationStats.programKernelsMaxTime = std::max(mCompilationStats.programKernelsMaxTime, time);
+    }
     logDebug("Created program kernels in {:.3f} s: {}", time, descStr);
 
     return pProgramKernels;
@@ -560,6 +794,39 @@ void ProgramManager::setHlslLanguagePrelude(const std::string& prelude)
     mpDevice->getSlangGlobalSession()->setLanguagePrelude(SLANG_SOURCE_LANGUAGE_HLSL, prelude.c_str());
 }
 
+Slang::ComPtr<slang::IGlobalSession> ProgramManager::acquireWorkerSlangGlobalSession(const std::string& hlslPrelude) const
+{
+    Slang::ComPtr<slang::IGlobalSession> pSlangGlobalSession;
+    {
+        std::lock_guard<std::mutex> lock(mWorkerSlangGlobalSessionsMutex);
+        if (!mWorkerSlangGlobalSessions.empty())
+        {
+            pSlangGlobalSession = std::move(mWorkerSlangGlobalSessions.back());
+            mWorkerSlangGlobalSessions.pop_back();
+        }
+    }
+
+    if (!pSlangGlobalSession)
+    {
+        if (SLANG_FAILED(slang::createGlobalSession(pSlangGlobalSession.writeRef())))
+        {
+            logWarning("Failed to create Slang global session for compiling programs.");
+            return nullptr;
+        }
+    }
+
+    // Match the configuration of the device's global session.
+    pSlangGlobalSession->setLanguagePrelude(SLANG_SOURCE_LANGUAGE_HLSL, hlslPrelude.c_str());
+
+    return pSlangGlobalSession;
+}
+
+void ProgramManager::releaseWorkerSlangGlobalSession(Slang::ComPtr<slang::IGlobalSession> pSlangGlobalSession) const
+{
+    std::lock_guard<std::mutex> lock(mWorkerSlangGlobalSessionsMutex);
+    mWorkerSlangGlobalSessions.push_back(std::move(pSlangGlobalSession));
+}
+
 void ProgramManager::registerProgramForReload(Program* program)
 {
     mLoadedPrograms.push_back(program);
@@ -619,9 +886,12 @@ ProgramManager::ForcedCompilerFlags ProgramManager::getForcedCompilerFlags()
     return mForcedCompilerFlags;
 }
 
-SlangCompileRequest* ProgramManager::createSlangCompileRequest(const Program& program) const
+Slang::ComPtr<slang::ISession> ProgramManager::createSlangSession(
+    const Program& program,
+    const DefineList& defineList,
+    slang::IGlobalSession* pSlangGlobalSession
+) const
 {
-    slang::IGlobalSession* pSlangGlobalSession = mpDevice->getSlangGlobalSession();
     FALCOR_ASSERT(pSlangGlobalSession);
 
     slang::SessionDesc sessionDesc;
@@ -698,6 +968,10 @@ SlangCompileRequest* ProgramManager::createSlangCompileRequest(const Program& pr
         targetDesc.format = SLANG_SPIRV;
         targetMacroName = "FALCOR_VULKAN";
         break;
+    case Device::Type::CPU:
+        targetDesc.format = SLANG_SHADER_HOST_CALLABLE;
+        targetMacroName = "FALCOR_CPU";
+        break;
     default:
         FALCOR_UNREACHABLE();
     }
@@ -711,7 +985,7 @@ SlangCompileRequest* ProgramManager::createSlangCompileRequest(const Program& pr
     // Add global followed by program specific defines.
     for (const auto& shaderDefine : mGlobalDefineList)
         addSlangDefine(shaderDefine.first.c_str(), shaderDefine.second.c_str());
-    for (const auto& shaderDefine : program.getDefineList())
+    for (const auto& shaderDefine : defineList)
         addSlangDefine(shaderDefine.first.c_str(), shaderDefine.second.c_str());
 
     // Add a `#define`s based on the target and shader model.
@@ -764,6 +1038,17 @@ SlangCompileRequest* ProgramManager::createSlangCompileRequest(const Program& pr
     pSlangGlobalSession->createSession(sessionDesc, pSlangSession.writeRef());
     FALCOR_ASSERT(pSlangSession);
 
+    return pSlangSession;
+}
+
+SlangCompileRequest* ProgramManager::createSlangCompileRequest(
+    const Program& program,
+    const DefineList& defineList,
+    slang::IGlobalSession* pSlangGlobalSession
+) const
+{
+    Slang::ComPtr<slang::ISession> pSlangSession = createSlangSession(program, defineList, pSlangGlobalSession);
+
     program.mFileTimeMap.clear(); // TODO @skallweit
 
     SlangCompileRequest* pSlangRequest = nullptr;
@@ -861,4 +1146,239 @@ SlangCompileRequest* ProgramManager::createSlangCompileRequest(const Program& pr
     return pSlangRequest;
 }
 
+ProgramCache::Key ProgramManager::computeProgramCacheKey(const Program& program, const DefineList& defineList) const
+{
+    // The key covers all inputs of the Slang front-end. The content of source files is not part of the key,
+    // but stored in the entries and validated on load, since the transitively imported files are only
+    // known after compilation.
+    SHA1 sha1;
+    auto updateString = [&sha1](std::string_view str)
+    {
+        sha1.update(uint64_t(str.size()));
+        sha1.update(str);
+    };
+    auto updateDefines = [&](const DefineList& defines)
+    {
+        sha1.update(uint64_t(defines.size()));
+        for (const auto& define : defines)
+        {
+            updateString(define.first);
+            updateString(define.second);
+        }
+    };
+    auto updateTypeConformances = [&](const TypeConformanceList& typeConformances)
+    {
+        sha1.update(uint64_t(typeConformances.size()));
+        for (const auto& [typeConformance, id] : typeConformances)
+        {
+            updateString(typeConformance.typeName);
+            updateString(typeConformance.interfaceName);
+            sha1.update(id);
+        }
+    };
+
+    // Compiler and target.
+    updateString(mpDevice->getSlangGlobalSession()->getBuildTagString());
+    sha1.update(uint32_t(mpDevice->getType()));
+    sha1.update(uint32_t(program.mDesc.shaderModel));
+    for (const auto& path : getShaderDirectoriesList())
+        updateString(path.string());
+
+    // Compiler options.
+    SlangCompilerFlags compilerFlags = program.mDesc.compilerFlags;
+    compilerFlags &= ~mForcedCompilerFlags.disabled;
+    compilerFlags |= mForcedCompilerFlags.enabled;
+    sha1.update(uint32_t(compilerFlags));
+    sha1.update(getEnvironmentVariable("FALCOR_USE_SLANG_SPIRV_BACKEND") == "1" || program.mDesc.useSPIRVBackend);
+    sha1.update(mGenerateDebugInfo);
+    sha1.update(uint64_t(mGlobalCompilerArguments.size()));
+    for (const auto& arg : mGlobalCompilerArguments)
+        updateString(arg);
+    sha1.update(uint64_t(program.mDesc.compilerArguments.size()));
+    for (const auto& arg : program.mDesc.compilerArguments)
+        updateString(arg);
+    updateDefines(mGlobalDefineList);
+    updateDefines(defineList);
+    updateTypeConformances(program.mTypeConformanceList);
+
+    // Sources and entry points.
+    sha1.update(uint64_t(program.mDesc.shaderModules.size()));
+    for (const auto& module : program.mDesc.shaderModules)
+    {
+        updateString(module.name);
+        sha1.update(uint64_t(module.sources.size()));
+        for (const auto& source : module.sources)
+        {
+            sha1.update(uint32_t(source.type));
+            updateString(source.path.string());
+            updateString(source.string);
+        }
+    }
+    sha1.update(uint64_t(program.mDesc.entryPointGroups.size()));
+    for (const auto& entryPointGroup : program.mDesc.entryPointGroups)
+    {
+        sha1.update(entryPointGroup.shaderModuleIndex);
+        updateTypeConformances(entryPointGroup.typeConformances);
+        sha1.update(uint64_t(entryPointGroup.entryPoints.size()));
+        for (const auto& entryPoint : entryPointGroup.entryPoints)
+        {
+            sha1.update(uint32_t(entryPoint.type));
+            updateString(entryPoint.name);
+            updateString(entryPoint.exportName);
+        }
+    }
+
+    return sha1.finalize();
+}
+
+ref<const ProgramVersion> ProgramManager::loadProgramVersionFromCache(
+    const Program& program,
+    const DefineList& defineList,
+    slang::IGlobalSession* pSlangGlobalSession,
+    ProgramCache::Entry& entry,
+    std::string& log
+) const
+{
+    if (entry.shaderModuleIndices.size() != program.mDesc.shaderModules.size())
+        return nullptr;
+
+    Slang::ComPtr<slang::ISession> pSlangSession = createSlangSession(program, defineList, pSlangGlobalSession);
+
+    // Load the modules in order, so that imported modules are already loaded into the session
+    // when loading the modules importing them.
+    std::vector<slang::IModule*> pSlangModules;
+    for (auto& module : entry.modules)
+    {
+        Slang::ComPtr<ISlangBlob> pIRBlob(new ByteArrayBlob(std::move(module.ir)));
+        Slang::ComPtr<slang::IBlob> pSlangDiagnostics;
+        slang::IModule* pSlangModule =
+            pSlangSession->loadModuleFromIRBlob(module.name.c_str(), module.path.c_str(), pIRBlob, pSlangDiagnostics.writeRef());
+        if (pSlangDiagnostics && pSlangDiagnostics->getBufferSize() > 0)
+            log += (char const*)pSlangDiagnostics->getBufferPointer();
+        if (!pSlangModule)
+        {
+            log += fmt::format("Failed to load module '{}'.\n", module.name);
+            return nullptr;
+        }
+        pSlangModules.push_back(pSlangModule);
+    }
+
+    // The global scope is the composition of the shader modules of the program.
+    std::vector<slang::IComponentType*> pShaderModules;
+    for (uint32_t index : entry.shaderModuleIndices)
+        pShaderModules.push_back(pSlangModules[index]);
+
+    Slang::ComPtr<slang::IComponentType> pSlangGlobalScope;
+    {
+        Slang::ComPtr<slang::IBlob> pSlangDiagnostics;
+        auto res = pSlangSession->createCompositeComponentType(
+            pShaderModules.data(), (SlangInt)pShaderModules.size(), pSlangGlobalScope.writeRef(), pSlangDiagnostics.writeRef()
+        );
+        if (SLANG_FAILED(res))
+        {
+            log += "Slang call createCompositeComponentType() failed.\n";
+            return nullptr;
+        }
+    }
+
+    // Prepare entry points.
+    std::vector<Slang::ComPtr<slang::IComponentType>> pSlangEntryPoints;
+    for (const auto& entryPointGroup : program.mDesc.entryPointGroups)
+    {
+        if (entryPointGroup.shaderModuleIndex >= entry.shaderModuleIndices.size())
+            return nullptr;
+        slang::IModule* pSlangModule = pSlangModules[entry.shaderModuleIndices[entryPointGroup.shaderModuleIndex]];
+
+        for (const auto& entryPoint : entryPointGroup.entryPoints)
+        {
+            Slang::ComPtr<slang::IEntryPoint> pSlangEntryPoint;
+            Slang::ComPtr<slang::IBlob> pSlangDiagnostics;
+            auto res = pSlangModule->findAndCheckEntryPoint(
+                entryPoint.name.c_str(), getSlangStage(entryPoint.type), pSlangEntryPoint.writeRef(), pSlangDiagnostics.writeRef()
+            );
+            if (SLANG_FAILED(res))
+            {
+                log += fmt::format("Entry point '{}' not found.\n", entryPoint.name);
+                return nullptr;
+            }
+            pSlangEntryPoints.push_back(getExportedEntryPoint(Slang::ComPtr<slang::IComponentType>(pSlangEntryPoint.get()), entryPoint));
+        }
+    }
+
+    // Track the source files of the cached modules for reloading.
+    program.mFileTimeMap.clear();
+    for (const auto& path : entry.dependencies)
+        program.mFileTimeMap[path.string()] = getFileModifiedTime(path);
+
+    // TODO @skallweit remove const cast
+    ref<ProgramVersion> pVersion = ProgramVersion::createEmpty(const_cast<Program*>(&program), pSlangGlobalScope);
+
+    ref<const ProgramReflection> pReflector;
+    if (!doSlangReflection(*pVersion, pSlangGlobalScope, pSlangEntryPoints, pReflector, log))
+        return nullptr;
+
+    pVersion->init(defineList, pReflector, program.getProgramDescString(), pSlangEntryPoints);
+
+    return pVersion;
+}
+
+void ProgramManager::storeProgramVersionInCache(
+    const ProgramCache::Key& key,
+    SlangCompileRequest* pSlangRequest,
+    const Program& program,
+    std::vector<std::filesystem::path> dependencies,
+    double compileTime
+) const
+{
+    FALCOR_ASSERT(mpProgramCache);
+
+    // Get the modules of the translation units.
+    std::vector<slang::IModule*> pShaderModules;
+    for (size_t moduleIndex = 0; moduleIndex < program.mDesc.shaderModules.size(); ++moduleIndex)
+    {
+        slang::IModule* pSlangModule = nullptr;
+        if (SLANG_FAILED(spCompileRequest_getModule(pSlangRequest, (SlangInt)moduleIndex, &pSlangModule)) || !pSlangModule)
+            return;
+        pShaderModules.push_back(pSlangModule);
+    }
+    if (pShaderModules.empty())
+        return;
+
+    // Gather all modules loaded into the session by imports. The session lists them in the order they finished
+    // loading, so each module comes after the modules it imports. The translation units come last.
+    slang::ISession* pSlangSession = pShaderModules[0]->getSession();
+    std::vector<slang::IModule*> pSlangModules;
+    for (SlangInt i = 0; i < pSlangSession->getLoadedModuleCount(); ++i)
+        pSlangModules.push_back(pSlangSession->getLoadedModule(i));
+
+    ProgramCache::Entry entry;
+    for (slang::IModule* pSlangModule : pShaderModules)
+    {
+        auto it = std::find(pSlangModules.begin(), pSlangModules.end(), pSlangModule);
+        if (it == pSlangModules.end())
+            it = pSlangModules.insert(pSlangModules.end(), pSlangModule);
+        entry.shaderModuleIndices.push_back(uint32_t(it - pSlangModules.begin()));
+    }
+
+    for (slang::IModule* pSlangModule : pSlangModules)
+    {
+        Slang::ComPtr<ISlangBlob> pIRBlob;
+        if (SLANG_FAILED(pSlangModule->serialize(pIRBlob.writeRef())))
+        {
+            logWarning("Failed to serialize Slang module '{}' for the program cache.", pSlangModule->getName());
+            return;
+        }
+        ProgramCache::Module module;
+        module.name = pSlangModule->getName();
+        module.path = pSlangModule->getFilePath() ? pSlangModule->getFilePath() : "";
+        const uint8_t* pData = static_cast<const uint8_t*>(pIRBlob->getBufferPointer());
+        module.ir.assign(pData, pData + pIRBlob->getBufferSize());
+        entry.modules.push_back(std::move(module));
+    }
+
+    entry.dependencies = std::move(dependencies);
+    entry.compileTime = compileTime;
+    mpProgramCache->store(key, entry);
+}
+
 } // namespace Falcor
@@ -27,18 +27,29 @@
  **************************************************************************/
 #pragma once
 #include "Program.h"
+#include "ProgramCache.h"
 #include "Core/Macros.h"
 #include "Core/API/fwd.h"
 
 #include <memory>
+#include <mutex>
+#include <vector>
 
 namespace Falcor
 {
 
+/// Program version to compile ahead of its first use, see ProgramManager::prewarmPrograms().
+struct ProgramVersionRequest
+{
+    ref<Program> pProgram; ///< Program to compile.
+    DefineList defines;    ///< Defines added to the current defines of the program.
+};
+
 class FALCOR_API ProgramManager
 {
 public:
     ProgramManager(Device* pDevice);
+    ~ProgramManager();
 
     /**
      * Defines flags that should be forcefully disabled or enabled on all shaders.
@@ -58,6 +69,11 @@ public:
         double programKernelsMaxTime = 0.0;
         double programVersionTotalTime = 0.0;
         double programKernelsTotalTime = 0.0;
+        size_t programCacheHitCount = 0;   ///< Number of program versions loaded from the program cache.
+        size_t programCacheMissCount = 0;  ///< Number of program versions compiled from source with the program cache enabled.
+        double programCacheTimeSaved = 0.0; ///< Front-end compile time saved by program cache hits in seconds.
+        size_t programPrewarmCount = 0;     ///< Number of program versions compiled by prewarmPrograms().
+        double programPrewarmTime = 0.0;    ///< Wall-clock time spent in prewarmPrograms() in seconds.
     };
 
     ProgramDesc applyForcedCompilerFlags(ProgramDesc desc) const;
@@ -66,6 +82,17 @@ public:
 
     ref<const ProgramVersion> createProgramVersion(const Program& program, std::string& log) const;
 
+    /**
+     * Compile program versions ahead of their first use.
+     * The front-end compilation of the requested versions runs concurrently on worker threads, each using its own
+     * Slang global session. The kernels of the compiled versions are created afterwards on the calling thread.
+     * The call returns once all versions are ready, and the versions are picked up by Program::getActiveVersion()
+     * when the program defines match. Versions that already exist are skipped. Failures are logged and reported
+     * again when the version is first used.
+     * @param[in] requests Program versions to compile.
+     */
+    void prewarmPrograms(const std::vector<ProgramVersionRequest>& requests);
+
     ref<const ProgramKernels> createProgramKernels(
         const Program& program,
         const ProgramVersion& programVersion,
@@ -142,21 +169,72 @@ public:
     ForcedCompilerFlags getForcedCompilerFlags();
 
     const CompilationStats& getCompilationStats() { return mCompilationStats; }
-    void resetCompilationStats() { mCompilationStats = {}; }
+    void resetCompilationStats()
+    {
+        std::lock_guard<std::mutex> lock(mCompilationStatsMutex);
+        mCompilationStats = {};
+    }
+
+    /**
+     * Get the persistent cache of Slang front-end results.
+     * @return The program cache, or nullptr if disabled (see Device::Desc::programCachePath).
+     */
+    ProgramCache* getProgramCache() const { return mpProgramCache.get(); }
 
 private:
-    SlangCompileRequest* createSlangCompileRequest(const Program& program) const;
+    ref<const ProgramVersion> createProgramVersion(
+        const Program& program,
+        const DefineList& defineList,
+        slang::IGlobalSession* pSlangGlobalSession,
+        std::string& log
+    ) const;
+
+    Slang::ComPtr<slang::ISession> createSlangSession(
+        const Program& program,
+        const DefineList& defineList,
+        slang::IGlobalSession* pSlangGlobalSession
+    ) const;
+    SlangCompileRequest* createSlangCompileRequest(
+        const Program& program,
+        const DefineList& defineList,
+        slang::IGlobalSession* pSlangGlobalSession
+    ) const;
+
+    Slang::ComPtr<slang::IGlobalSession> acquireWorkerSlangGlobalSession(const std::string& hlslPrelude) const;
+    void releaseWorkerSlangGlobalSession(Slang::ComPtr<slang::IGlobalSession> pSlangGlobalSession) const;
+
+    ProgramCache::Key computeProgramCacheKey(const Program& program, const DefineList& defineList) const;
+    ref<const ProgramVersion> loadProgramVersionFromCache(
+        const Program& program,
+        const DefineList& defineList,
+        slang::IGlobalSession* pSlangGlobalSession,
+        ProgramCache::Entry& entry,
+        std::string& log
+    ) const;
+    void storeProgramVersionInCache(
+        const ProgramCache::Key& key,
+        SlangCompileRequest* pSlangRequest,
+        const Program& program,
+        std::vector<std::filesystem::path> dependencies,
+        double compileTime
+    ) const;
 
     Device* mpDevice;
 
     std::vector<Program*> mLoadedPrograms;
     mutable CompilationStats mCompilationStats;
+    mutable std::mutex mCompilationStatsMutex;
+    std::unique_ptr<ProgramCache> mpProgramCache;
 
     DefineList mGlobalDefineList;
     std::vector<std::string> mGlobalCompilerArguments;
     bool mGenerateDebugInfo = false;
     ForcedCompilerFlags mForcedCompilerFlags;
 
+    /// Slang global sessions used by prewarmPrograms(). A global session must not be used by multiple threads at once.
+    mutable std::vector<Slang::ComPtr<slang::IGlobalSession>> mWorkerSlangGlobalSessions;
+    mutable std::mutex mWorkerSlangGlobalSessionsMutex;
+
     mutable uint32_t mHitGroupID = 0;
 };
 
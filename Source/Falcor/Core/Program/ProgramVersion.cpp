@@ -150,9 +150,52 @@ ref<ProgramKernels> ProgramKernels::create(
         log = (const char*)diagnostics->getBufferPointer();
     }
 
+    // On the CPU device, compute kernels are dispatched across the worker threads by ComputeContext rather than by GFX.
+    // Compile the entry point to a host-callable function for that purpose.
+    if (pProgram && pDevice->getType() == Device::Type::CPU && pTypeConformanceSpecializedEntryPoints.size() == 1 &&
+        pTypeConformanceSpecializedEntryPoints[0]->getLayout()->getEntryPointByIndex(0)->getStage() == SLANG_STAGE_COMPUTE)
+    {
+        if (!pProgram->createHostComputeFunc(pSpecializedSlangGlobalScope, pTypeConformanceSpecializedEntryPoints[0], log))
+            pProgram = nullptr;
+    }
+
     return pProgram;
 }
 
+bool ProgramKernels::createHostComputeFunc(slang::IComponentType* pSlangGlobalScope, slang::IComponentType* pSlangEntryPoint, std::string& log)
+{
+    slang::IComponentType* components[] = {pSlangGlobalScope, pSlangEntryPoint};
+    Slang::ComPtr<slang::IComponentType> pComposite;
+    Slang::ComPtr<slang::IComponentType> pLinked;
+    Slang::ComPtr<ISlangBlob> diagnostics;
+
+    auto appendDiagnostics = [&]()
+    {
+        if (diagnostics)
+            log += (const char*)diagnostics->getBufferPointer();
+    };
+
+    if (SLANG_FAILED(pSlangGlobalScope->getSession()->createCompositeComponentType(
+            components, 2, pComposite.writeRef(), diagnostics.writeRef()
+        )) ||
+        SLANG_FAILED(pComposite->link(pLinked.writeRef(), diagnostics.writeRef())) ||
+        SLANG_FAILED(pLinked->getEntryPointHostCallable(0, 0, mpHostLibrary.writeRef(), diagnostics.writeRef())))
+    {
+        appendDiagnostics();
+        return false;
+    }
+    appendDiagnostics();
+
+    const char* entryPointName = pLinked->getLayout()->getEntryPointByIndex(0)->getNameOverride();
+    mHostComputeFunc = reinterpret_cast<HostComputeFunc>(mpHostLibrary->findFuncByName(entryPointName));
+    if (!mHostComputeFunc)
+    {
+        log += fmt::format("Host-callable function '{}' not found.\n", entryPointName);
+        return false;
+    }
+    return true;
+}
+
 const EntryPointKernel* ProgramKernels::getKernel(ShaderType type) const
 {
     for (auto& pEntryPointGroup : mUniqueEntryPointGroups)
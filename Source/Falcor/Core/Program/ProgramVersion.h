@@ -174,6 +174,16 @@ class FALCOR_API ProgramKernels : public Object
 public:
     typedef std::vector<ref<const EntryPointGroupKernels>> UniqueEntryPointGroups;
 
+    /// Range of thread groups executed by a host compute function. Matches ComputeVaryingInput in Slang's C++ prelude.
+    struct HostComputeVaryingInput
+    {
+        uint32_t startGroupID[3];
+        uint32_t endGroupID[3];
+    };
+
+    /// Host-callable compute kernel. Executes all thread groups in the given range.
+    using HostComputeFunc = void (*)(HostComputeVaryingInput* pVaryingInput, void* pEntryPointParams, void* pGlobalParams);
+
     /**
      * Create a new program object for graphics.
      * @param[in] The program reflection object
@@ -222,6 +232,12 @@ public:
 
     gfx::IShaderProgram* getGfxProgram() const { return mGfxProgram; }
 
+    /**
+     * Get the host-callable compute kernel.
+     * This is only available for compute programs on the CPU device, where Falcor dispatches the thread groups itself.
+     */
+    HostComputeFunc getHostComputeFunc() const { return mHostComputeFunc; }
+
 protected:
     ProgramKernels(
         const ProgramVersion* pVersion,
@@ -230,7 +246,11 @@ protected:
         const std::string& name = ""
     );
 
+    bool createHostComputeFunc(slang::IComponentType* pSlangGlobalScope, slang::IComponentType* pSlangEntryPoint, std::string& log);
+
     Slang::ComPtr<gfx::IShaderProgram> mGfxProgram;
+    Slang::ComPtr<ISlangSharedLibrary> mpHostLibrary;
+    HostComputeFunc mHostComputeFunc = nullptr;
     const std::string mName;
 
     UniqueEntryPointGroups mUniqueEntryPointGroups;
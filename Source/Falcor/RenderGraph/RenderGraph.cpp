@@ -430,6 +430,12 @@ bool RenderGraph::compile(RenderContext* pRenderContext, std::string& log)
     try
     {
         mpExe = RenderGraphCompiler::compile(*this, pRenderContext, mCompilerDeps);
+
+        // Compile the programs of the passes up front, so they don't compile one by one during the first execution.
+        RenderGraphExe::Context c{
+            pRenderContext, mPassesDictionary, mCompilerDeps.defaultResourceProps.dims, mCompilerDeps.defaultResourceProps.format};
+        mpExe->prewarmPrograms(c);
+
         mRecompile = false;
         return true;
     }
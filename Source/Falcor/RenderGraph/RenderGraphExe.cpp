@@ -26,6 +26,7 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "RenderGraphExe.h"
+#include "Core/API/Device.h"
 #include "Utils/Timing/Profiler.h"
 
 namespace Falcor
@@ -43,6 +44,21 @@ void RenderGraphExe::execute(const Context& ctx)
     }
 }
 
+void RenderGraphExe::prewarmPrograms(const Context& ctx)
+{
+    FALCOR_PROFILE(ctx.pRenderContext, "RenderGraphExe::prewarmPrograms()");
+
+    std::vector<ProgramVersionRequest> requests;
+    for (const auto& pass : mExecutionList)
+    {
+        RenderData renderData(pass.name, *mpResourceCache, ctx.passesDictionary, ctx.defaultTexDims, ctx.defaultTexFormat);
+        pass.pPass->collectProgramVersions(renderData, requests);
+    }
+
+    if (!requests.empty())
+        ctx.pRenderContext->getDevice()->getProgramManager()->prewarmPrograms(requests);
+}
+
 void RenderGraphExe::renderUI(RenderContext* pRenderContext, Gui::Widgets& widget)
 {
     for (const auto& p : mExecutionList)
@@ -59,6 +59,11 @@ public:
      */
     void execute(const Context& ctx);
 
+    /**
+     * Compile the program versions declared by the passes, see RenderPass::collectProgramVersions().
+     */
+    void prewarmPrograms(const Context& ctx);
+
     /**
      * Render the UI
      */
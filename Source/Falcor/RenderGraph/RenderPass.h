@@ -33,6 +33,7 @@
 #include "Core/HotReloadFlags.h"
 #include "Core/API/Resource.h"
 #include "Core/API/Texture.h"
+#include "Core/Program/ProgramManager.h"
 #include "Scene/Scene.h"
 #include "Utils/Properties.h"
 #include "Utils/Dictionary.h"
@@ -124,6 +125,12 @@ public:
     struct PluginInfo
     {
         std::string desc; ///< Brief textual description of what the render pass does.
+
+        template<typename Archive>
+        void serialize(Archive& ar)
+        {
+            ar("desc", desc);
+        }
     };
 
     FALCOR_PLUGIN_BASE_CLASS(RenderPass);
@@ -173,6 +180,16 @@ public:
      */
     virtual void compile(RenderContext* pRenderContext, const CompileData& compileData) {}
 
+    /**
+     * Called after render graph compilation, before the next execution of the pass.
+     * Declare the program versions the pass will use for the current scene and settings, so they are compiled
+     * concurrently with the programs of the other passes instead of serially on first use.
+     * The defines of a request must match the program defines at execution, otherwise the version is not used.
+     * @param[in] renderData Render data with the resources the pass is executed with.
+     * @param[in,out] requests List to append the program version requests to.
+     */
+    virtual void collectProgramVersions(const RenderData& renderData, std::vector<ProgramVersionRequest>& requests) {}
+
     /**
      * Executes the pass.
      */
@@ -58,5 +58,12 @@ static const char kRenderPassPRNGDimension[] = "_prngDimension";
  */
 static const char kRenderPassGBufferAdjustShadingNormals[] = "_gbufferAdjustShadingNormals";
 
+/**
+ * Per-pixel sample count (ref<Texture> in R8Uint format) computed by an adaptive sampling pass for the next frame.
+ * The sample count depends on the output of the pass consuming it, so it is passed via the dictionary instead of a graph edge.
+ * The consumer resets the field to nullptr when reading it, so a stale sample count is never used.
+ */
+static const char kRenderPassAdaptiveSampleCount[] = "_adaptiveSampleCount";
+
 FALCOR_ENUM_CLASS_OPERATORS(RenderPassRefreshFlags);
 } // namespace Falcor
@@ -48,7 +48,17 @@ void EmissiveLightSampler::setLightCollection(ref<ILightCollection> pLightCollec
     mpLightCollection = std::move(pLightCollection);
 
     if (mpLightCollection)
-        mUpdateFlagsConnection = mpLightCollection->getUpdateFlagsSignal().connect([&](ILightCollection::UpdateFlags flags) { mLightCollectionUpdateFlags |= flags; });
+        mUpdateFlagsConnection = mpLightCollection->getUpdateFlagsSignal().connect(
+            [&](ILightCollection::UpdateFlags flags)
+            {
+                mLightCollectionUpdateFlags |= flags;
+                if (is_set(flags, ILightCollection::UpdateFlags::MatrixChanged))
+                {
+                    const auto& updatedLights = mpLightCollection->getUpdatedLights();
+                    mUpdatedLights.insert(updatedLights.begin(), updatedLights.end());
+                }
+            }
+        );
 }
 
 DefineList EmissiveLightSampler::getDefines() const
@@ -30,6 +30,7 @@
 #include "Core/Macros.h"
 #include "Core/Program/DefineList.h"
 #include "Scene/Lights/LightCollection.h"
+#include <set>
 
 namespace Falcor
 {
@@ -82,5 +83,6 @@ namespace Falcor
         ref<ILightCollection> mpLightCollection;
         sigs::Connection mUpdateFlagsConnection;
         ILightCollection::UpdateFlags mLightCollectionUpdateFlags = ILightCollection::UpdateFlags::None;
+        std::set<uint32_t> mUpdatedLights;          ///< Mesh lights whose transform changed since the derived class last cleared the set.
     };
 }
@@ -48,6 +48,7 @@ namespace Falcor
         {
             mNeedsRebuild = true;
             mLightCollectionUpdateFlags = ILightCollection::UpdateFlags::None;
+            mUpdatedLights.clear();
         }
 
         // Rebuild if necessary
@@ -29,10 +29,34 @@
 #include "Core/Error.h"
 #include "Core/API/RenderContext.h"
 #include "Utils/Timing/Profiler.h"
+#include "Utils/Math/MathConstants.slangh"
+#include <algorithm>
+#include <cmath>
 
 namespace
 {
+    using namespace Falcor;
+
     const char kShaderFile[] = "Rendering/Lights/LightBVHRefit.cs.slang";
+
+    // Fraction of nodes above which a partial refit falls back to refitting all nodes.
+    // Past this point, uploading the list of nodes to refit costs more than it saves.
+    const float kMaxPartialRefitFraction = 0.5f;
+
+    // Maximum number of degraded nodes reported by a single refit.
+    const uint32_t kMaxDegradedNodes = 1024;
+
+    /** Returns the reference values used for detecting degraded nodes: AABB surface area and normal bounding cone angle.
+        An invalid cone is treated as covering the whole sphere.
+    */
+    float2 computeNodeReference(const PackedNode& node)
+    {
+        const SharedNodeAttributes attribs = node.getNodeAttributes();
+        const float3 size = 2.f * attribs.extent;
+        const float area = 2.f * (size.x * size.y + size.y * size.z + size.z * size.x);
+        const float coneAngle = attribs.cosConeAngle == kInvalidCosConeAngle ? (float)M_PI : std::acos(std::clamp(attribs.cosConeAngle, -1.f, 1.f));
+        return float2(area, coneAngle);
+    }
 }
 
 namespace Falcor
@@ -45,50 +69,185 @@ namespace Falcor
         mInternalUpdater = ComputePass::create(mpDevice, kShaderFile, "updateInternalNodes");
     }
 
-    // TODO: Only update the ones that moved.
     void LightBVH::refit(RenderContext* pRenderContext)
     {
         FALCOR_PROFILE(pRenderContext, "LightBVH::refit()");
 
+        FALCOR_ASSERT(mIsValid);
+        refitNodes(pRenderContext, mpNodeIndicesBuffer, mPerDepthRefitEntryInfo, nullptr);
+    }
+
+    void LightBVH::refit(RenderContext* pRenderContext, const std::vector<uint32_t>& updatedTriangles, const DegradationThresholds* pThresholds)
+    {
+        FALCOR_PROFILE(pRenderContext, "LightBVH::refit()");
+
         FALCOR_ASSERT(mIsValid);
 
-        // Update all leaf nodes.
+        // Mark the leaf nodes referencing the moved triangles as well as all their ancestors.
+        // The marked nodes are gathered per depth, in the same layout as 'mNodeIndices'.
+        const uint32_t totalNodeCount = mBVHStats.internalNodeCount + mBVHStats.leafNodeCount;
+        const uint32_t maxPartialNodeCount = (uint32_t)(kMaxPartialRefitFraction * totalNodeCount);
+
+        std::vector<uint32_t> leafNodes;
+        std::vector<std::vector<uint32_t>> internalNodesPerDepth(mBVHStats.treeHeight);
+        uint32_t markedNodeCount = 0;
+
+        for (uint32_t triangleIndex : updatedTriangles)
+        {
+            FALCOR_ASSERT(triangleIndex < mTriangleLeafIndices.size());
+            const uint32_t leafIndex = mTriangleLeafIndices[triangleIndex];
+            if (leafIndex == kInvalidIndex || mNodeRefitMarks[leafIndex]) continue;
+
+            mNodeRefitMarks[leafIndex] = 1;
+            leafNodes.push_back(leafIndex);
+            ++markedNodeCount;
+
+            for (uint32_t nodeIndex = mParentIndices[leafIndex]; nodeIndex != kInvalidIndex && !mNodeRefitMarks[nodeIndex]; nodeIndex = mParentIndices[nodeIndex])
+            {
+                mNodeRefitMarks[nodeIndex] = 1;
+                internalNodesPerDepth[mNodeDepths[nodeIndex]].push_back(nodeIndex);
+                ++markedNodeCount;
+            }
+
+            if (markedNodeCount > maxPartialNodeCount) break;
+        }
+
+        // Clear the marks for the next call.
+        for (uint32_t nodeIndex : leafNodes) mNodeRefitMarks[nodeIndex] = 0;
+        for (const auto& nodes : internalNodesPerDepth)
+        {
+            for (uint32_t nodeIndex : nodes) mNodeRefitMarks[nodeIndex] = 0;
+        }
+
+        if (markedNodeCount > maxPartialNodeCount)
+        {
+            refitNodes(pRenderContext, mpNodeIndicesBuffer, mPerDepthRefitEntryInfo, pThresholds);
+            return;
+        }
+        if (markedNodeCount == 0) return;
+
+        std::vector<uint32_t> nodeIndices;
+        std::vector<RefitEntryInfo> perDepthEntryInfo(mBVHStats.treeHeight + 1);
+        nodeIndices.reserve(markedNodeCount);
+        for (uint32_t depth = 0; depth <= mBVHStats.treeHeight; ++depth)
+        {
+            const auto& nodes = depth < mBVHStats.treeHeight ? internalNodesPerDepth[depth] : leafNodes;
+            perDepthEntryInfo[depth].offset = (uint32_t)nodeIndices.size();
+            perDepthEntryInfo[depth].count = (uint32_t)nodes.size();
+            nodeIndices.insert(nodeIndices.end(), nodes.begin(), nodes.end());
+        }
+        FALCOR_ASSERT(nodeIndices.size() == markedNodeCount);
+
+        if (!mpRefitNodeIndicesBuffer || mpRefitNodeIndicesBuffer->getElementCount() < nodeIndices.size())
+        {
+            mpRefitNodeIndicesBuffer = mpDevice->createStructuredBuffer(sizeof(uint32_t), maxPartialNodeCount + 1, ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, nullptr, false);
+            mpRefitNodeIndicesBuffer->setName("LightBVH::mpRefitNodeIndicesBuffer");
+        }
+        mpRefitNodeIndicesBuffer->setBlob(nodeIndices.data(), 0, nodeIndices.size() * sizeof(uint32_t));
+
+        refitNodes(pRenderContext, mpRefitNodeIndicesBuffer, perDepthEntryInfo, pThresholds);
+    }
+
+    void LightBVH::refitNodes(RenderContext* pRenderContext, const ref<Buffer>& pNodeIndices, const std::vector<RefitEntryInfo>& perDepthEntryInfo, const DegradationThresholds* pThresholds)
+    {
+        // Only look for degraded nodes if the previous results have been consumed.
+        const bool detectDegradation = pThresholds && !mDegradedNodesPending;
+        if (detectDegradation)
+        {
+            pRenderContext->clearUAV(mpDegradedNodesBuffer->getUAV().get(), uint4(0));
+        }
+
+        auto bindRefitData = [&](const ShaderVar& var)
         {
-            auto var = mLeafUpdater->getRootVar()["CB"];
             mpLightCollection->bindShaderData(var["gLights"]);
             bindShaderData(var["gLightBVH"]);
-            var["gNodeIndices"] = mpNodeIndicesBuffer;
+            var["gNodeIndices"] = pNodeIndices;
+            var["gNodeReferences"] = mpNodeReferencesBuffer;
+            var["gDegradedNodes"] = mpDegradedNodesBuffer;
+            var["gDetectDegradation"] = detectDegradation;
+            var["gMaxDegradedNodes"] = kMaxDegradedNodes;
+            var["gMaxBoundsGrowth"] = pThresholds ? pThresholds->maxBoundsGrowth : 0.f;
+            var["gMaxConeGrowth"] = pThresholds ? pThresholds->maxConeGrowth : 0.f;
+        };
 
-            const uint32_t nodeCount = mPerDepthRefitEntryInfo.back().count;
-            FALCOR_ASSERT(nodeCount > 0);
-            var["gFirstNodeOffset"] = mPerDepthRefitEntryInfo.back().offset;
+        // Update the leaf nodes.
+        // There are no leaves to refit when all the moved triangles were culled from the BVH.
+        if (const uint32_t nodeCount = perDepthEntryInfo.back().count; nodeCount > 0)
+        {
+            auto var = mLeafUpdater->getRootVar()["CB"];
+            bindRefitData(var);
+
+            var["gFirstNodeOffset"] = perDepthEntryInfo.back().offset;
             var["gNodeCount"] = nodeCount;
 
             mLeafUpdater->execute(pRenderContext, nodeCount, 1, 1);
+            mRefitStats.leafNodeCount += nodeCount;
         }
 
-        // Update all internal nodes.
+        // Update the internal nodes.
         {
             auto var = mInternalUpdater->getRootVar()["CB"];
-            mpLightCollection->bindShaderData(var["gLights"]);
-            bindShaderData(var["gLightBVH"]);
-            var["gNodeIndices"] = mpNodeIndicesBuffer;
+            bindRefitData(var);
 
             // Note that mBVHStats.treeHeight may be 0, in which case there is a single leaf and no internal nodes.
+            // When refitting a subset of the nodes, the deepest levels may have no nodes to refit.
             for (int depth = (int)mBVHStats.treeHeight - 1; depth >= 0; --depth)
             {
-                const uint32_t nodeCount = mPerDepthRefitEntryInfo[depth].count;
-                FALCOR_ASSERT(nodeCount > 0);
-                var["gFirstNodeOffset"] = mPerDepthRefitEntryInfo[depth].offset;
+                const uint32_t nodeCount = perDepthEntryInfo[depth].count;
+                if (nodeCount == 0) continue;
+                var["gFirstNodeOffset"] = perDepthEntryInfo[depth].offset;
                 var["gNodeCount"] = nodeCount;
 
                 mInternalUpdater->execute(pRenderContext, nodeCount, 1, 1);
+                mRefitStats.internalNodeCount += nodeCount;
             }
         }
 
+        // Read back the degraded nodes asynchronously. They are retrieved with pollDegradedNodes() once the GPU is done.
+        if (detectDegradation)
+        {
+            pRenderContext->copyBufferRegion(mpDegradedNodesReadback.get(), 0, mpDegradedNodesBuffer.get(), 0, mpDegradedNodesBuffer->getSize());
+            pRenderContext->submit(false);
+            mDegradedNodesFenceValue = pRenderContext->signal(mpDegradedNodesFence.get());
+            mDegradedNodesPending = true;
+        }
+
         mIsCpuDataValid = false;
     }
 
+    std::vector<uint32_t> LightBVH::pollDegradedNodes()
+    {
+        std::vector<uint32_t> degradedNodes;
+        if (!mDegradedNodesPending || mpDegradedNodesFence->getCurrentValue() < mDegradedNodesFenceValue) return degradedNodes;
+        mDegradedNodesPending = false;
+
+        const uint32_t* pData = static_cast<const uint32_t*>(mpDegradedNodesReadback->map());
+        const uint32_t reportedCount = pData[0];
+        degradedNodes.assign(pData + 1, pData + 1 + std::min(reportedCount, kMaxDegradedNodes));
+        mpDegradedNodesReadback->unmap();
+        mRefitStats.degradedNodeCount += reportedCount;
+
+        // Rebuilding a subtree also rebuilds all degraded nodes below it, so only keep the topmost ones.
+        std::sort(degradedNodes.begin(), degradedNodes.end());
+        degradedNodes.erase(std::unique(degradedNodes.begin(), degradedNodes.end()), degradedNodes.end());
+
+        std::vector<uint32_t> topmostNodes;
+        for (uint32_t nodeIndex : degradedNodes)
+        {
+            bool hasDegradedAncestor = false;
+            for (uint32_t ancestorIndex = mParentIndices[nodeIndex]; ancestorIndex != kInvalidIndex; ancestorIndex = mParentIndices[ancestorIndex])
+            {
+                if (std::binary_search(degradedNodes.begin(), degradedNodes.end(), ancestorIndex))
+                {
+                    hasDegradedAncestor = true;
+                    break;
+                }
+            }
+            if (!hasDegradedAncestor) topmostNodes.push_back(nodeIndex);
+        }
+        return topmostNodes;
+    }
+
     void LightBVH::renderUI(Gui::Widgets& widget)
     {
         // Render the BVH stats.
@@ -106,6 +265,17 @@ namespace Falcor
             "  Triangle count:      " + std::to_string(stats.triangleCount) + "\n";
         widget.text(statsStr);
 
+        if (auto refitGroup = widget.group("Refit counters (per frame)"))
+        {
+            const std::string refitStr =
+                "  Leaf nodes refit:     " + std::to_string(mRefitStats.leafNodeCount) + "\n" +
+                "  Internal nodes refit: " + std::to_string(mRefitStats.internalNodeCount) + "\n" +
+                "  Degraded nodes:       " + std::to_string(mRefitStats.degradedNodeCount) + "\n" +
+                "  Rebuilt subtrees:     " + std::to_string(mRefitStats.rebuiltSubtreeCount) + "\n" +
+                "  Rebuilt nodes:        " + std::to_string(mRefitStats.rebuiltNodeCount);
+            refitGroup.text(refitStr);
+        }
+
         if (auto nodeGroup = widget.group("Node count per level"))
         {
             std::string countStr;
@@ -133,8 +303,16 @@ namespace Falcor
     {
         // Reset all CPU data.
         mNodes.clear();
+        mTriangleIndices.clear();
+        mTriangleBitmasks.clear();
         mNodeIndices.clear();
         mPerDepthRefitEntryInfo.clear();
+        mParentIndices.clear();
+        mNodeDepths.clear();
+        mTriangleLeafIndices.clear();
+        mNodeReferences.clear();
+        mNodeRefitMarks.clear();
+        mDegradedNodesPending = false;
         mMaxTriangleCountPerLeaf = 0;
         mBVHStats = BVHStats();
         mIsValid = false;
@@ -170,6 +348,7 @@ namespace Falcor
         // This function is called after BVH build has finished.
         computeStats();
         updateNodeIndices();
+        updateNodeReferences();
     }
 
     void LightBVH::computeStats()
@@ -255,9 +434,33 @@ namespace Falcor
         mNodeIndices.clear();
         mNodeIndices.resize(mBVHStats.internalNodeCount + mBVHStats.leafNodeCount, 0);
 
+        // At the same time, record the parent and depth of each node and the leaf node referencing each triangle.
+        // This is used for refitting only the nodes affected by moved triangles.
+        mParentIndices.assign(mNodes.size(), kInvalidIndex);
+        mNodeDepths.assign(mNodes.size(), 0);
+        mTriangleLeafIndices.assign(mTriangleBitmasks.size(), kInvalidIndex);
+        mNodeRefitMarks.assign(mNodes.size(), 0);
+
         traverseBVH(
-            [&](const NodeLocation& location) { mNodeIndices[perDepthOffset[location.depth]++] = location.nodeIndex; return true; },
-            [&](const NodeLocation& location) { mNodeIndices[perDepthOffset.back()++] = location.nodeIndex; return true; }
+            [&](const NodeLocation& location)
+            {
+                mNodeIndices[perDepthOffset[location.depth]++] = location.nodeIndex;
+                mNodeDepths[location.nodeIndex] = (uint8_t)location.depth;
+                mParentIndices[location.nodeIndex + 1] = location.nodeIndex;
+                mParentIndices[mNodes[location.nodeIndex].getInternalNode().rightChildIdx] = location.nodeIndex;
+                return true;
+            },
+            [&](const NodeLocation& location)
+            {
+                mNodeIndices[perDepthOffset.back()++] = location.nodeIndex;
+                mNodeDepths[location.nodeIndex] = (uint8_t)location.depth;
+                const auto node = mNodes[location.nodeIndex].getLeafNode();
+                for (uint32_t i = 0; i < node.triangleCount; ++i)
+                {
+                    mTriangleLeafIndices[mTriangleIndices[node.triangleOffset + i]] = location.nodeIndex;
+                }
+                return true;
+            }
         );
 
         if (!mpNodeIndicesBuffer || mpNodeIndicesBuffer->getElementCount() < mNodeIndices.size())
@@ -269,8 +472,105 @@ namespace Falcor
         mpNodeIndicesBuffer->setBlob(mNodeIndices.data(), 0, mNodeIndices.size() * sizeof(uint32_t));
     }
 
-    void LightBVH::uploadCPUBuffers(const std::vector<uint32_t>& triangleIndices, const std::vector<uint64_t>& triangleBitmasks)
+    void LightBVH::updateNodeReferences()
     {
+        // The reference values are computed when the BVH is built. They are kept when subtrees are rebuilt,
+        // in which case replaceSubtree() takes care of computing them for the new nodes.
+        if (mNodeReferences.size() != mNodes.size())
+        {
+            mNodeReferences.resize(mNodes.size());
+            for (size_t i = 0; i < mNodes.size(); ++i) mNodeReferences[i] = computeNodeReference(mNodes[i]);
+        }
+
+        if (!mpNodeReferencesBuffer || mpNodeReferencesBuffer->getElementCount() < mNodeReferences.size())
+        {
+            mpNodeReferencesBuffer = mpDevice->createStructuredBuffer(sizeof(float2), (uint32_t)mNodeReferences.size(), ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, nullptr, false);
+            mpNodeReferencesBuffer->setName("LightBVH::mpNodeReferencesBuffer");
+        }
+        mpNodeReferencesBuffer->setBlob(mNodeReferences.data(), 0, mNodeReferences.size() * sizeof(float2));
+
+        if (!mpDegradedNodesBuffer)
+        {
+            mpDegradedNodesBuffer = mpDevice->createStructuredBuffer(sizeof(uint32_t), kMaxDegradedNodes + 1, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess, MemoryType::DeviceLocal, nullptr, false);
+            mpDegradedNodesBuffer->setName("LightBVH::mpDegradedNodesBuffer");
+            mpDegradedNodesReadback = mpDevice->createBuffer(mpDegradedNodesBuffer->getSize(), ResourceBindFlags::None, MemoryType::ReadBack);
+            mpDegradedNodesReadback->setName("LightBVH::mpDegradedNodesReadback");
+            mpDegradedNodesFence = mpDevice->createFence();
+        }
+    }
+
+    int64_t LightBVH::replaceSubtree(uint32_t nodeIndex, const std::vector<PackedNode>& nodes, const std::vector<uint32_t>& triangleIndices)
+    {
+        FALCOR_ASSERT(nodeIndex < mNodes.size() && !nodes.empty());
+        FALCOR_ASSERT(mNodeReferences.size() == mNodes.size());
+
+        // The nodes of a subtree are stored contiguously, starting at the subtree root. The last one is reached by
+        // following the right children. The same holds for the triangle indices, starting at the leftmost leaf.
+        uint32_t firstLeafIndex = nodeIndex;
+        while (!mNodes[firstLeafIndex].isLeaf()) ++firstLeafIndex;
+        uint32_t lastLeafIndex = nodeIndex;
+        while (!mNodes[lastLeafIndex].isLeaf()) lastLeafIndex = mNodes[lastLeafIndex].getInternalNode().rightChildIdx;
+
+        const uint32_t endIndex = lastLeafIndex + 1;
+        const auto firstLeaf = mNodes[firstLeafIndex].getLeafNode();
+        const auto lastLeaf = mNodes[lastLeafIndex].getLeafNode();
+        const uint32_t triangleOffset = firstLeaf.triangleOffset;
+        FALCOR_ASSERT(lastLeaf.triangleOffset + lastLeaf.triangleCount - triangleOffset == triangleIndices.size());
+
+        const int64_t delta = (int64_t)nodes.size() - (int64_t)(endIndex - nodeIndex);
+        auto patchChildIndex = [&](PackedNode& node)
+        {
+            if (node.isLeaf()) return;
+            auto internalNode = node.getInternalNode();
+            if (internalNode.rightChildIdx >= endIndex)
+            {
+                internalNode.rightChildIdx = (uint32_t)(internalNode.rightChildIdx + delta);
+                node.setInternalNode(internalNode);
+            }
+        };
+
+        // Patch the nodes outside the subtree that reference nodes stored after it.
+        for (uint32_t i = 0; i < nodeIndex; ++i) patchChildIndex(mNodes[i]);
+        for (uint32_t i = endIndex; i < mNodes.size(); ++i) patchChildIndex(mNodes[i]);
+
+        // Relocate the new nodes.
+        std::vector<PackedNode> newNodes = nodes;
+        std::vector<float2> newReferences(nodes.size());
+        for (size_t i = 0; i < newNodes.size(); ++i)
+        {
+            PackedNode& node = newNodes[i];
+            if (node.isLeaf())
+            {
+                auto leafNode = node.getLeafNode();
+                leafNode.triangleOffset += triangleOffset;
+                node.setLeafNode(leafNode);
+            }
+            else
+            {
+                auto internalNode = node.getInternalNode();
+                internalNode.rightChildIdx += nodeIndex;
+                node.setInternalNode(internalNode);
+            }
+            newReferences[i] = computeNodeReference(node);
+        }
+
+        mNodes.erase(mNodes.begin() + nodeIndex, mNodes.begin() + endIndex);
+        mNodes.insert(mNodes.begin() + nodeIndex, newNodes.begin(), newNodes.end());
+        mNodeReferences.erase(mNodeReferences.begin() + nodeIndex, mNodeReferences.begin() + endIndex);
+        mNodeReferences.insert(mNodeReferences.begin() + nodeIndex, newReferences.begin(), newReferences.end());
+        std::copy(triangleIndices.begin(), triangleIndices.end(), mTriangleIndices.begin() + triangleOffset);
+
+        // Pending degraded nodes refer to the old node indices.
+        mDegradedNodesPending = false;
+
+        return delta;
+    }
+
+    void LightBVH::uploadCPUBuffers()
+    {
+        const auto& triangleIndices = mTriangleIndices;
+        const auto& triangleBitmasks = mTriangleBitmasks;
+
         // Reallocate buffers if size requirements have changed.
         auto var = mLeafUpdater->getRootVar()["CB"]["gLightBVH"];
         if (!mpBVHNodesBuffer || mpBVHNodesBuffer->getElementCount() < mNodes.size())
@@ -29,6 +29,7 @@
 #include "LightBVHTypes.slang"
 #include "Core/Macros.h"
 #include "Core/API/Buffer.h"
+#include "Core/API/Fence.h"
 #include "Scene/Lights/LightCollection.h"
 #include "Utils/Math/AABB.h"
 #include "Utils/Math/Vector.h"
@@ -57,6 +58,8 @@ namespace Falcor
     class FALCOR_API LightBVH
     {
     public:
+        static constexpr uint32_t kInvalidIndex = 0xffffffff;
+
         struct NodeLocation
         {
             uint32_t nodeIndex;
@@ -88,6 +91,31 @@ namespace Falcor
         */
         void refit(RenderContext* pRenderContext);
 
+        /** Thresholds for detecting nodes whose quality has degraded while refitting.
+        */
+        struct DegradationThresholds
+        {
+            float maxBoundsGrowth = 2.f;    ///< Maximum ratio of the node's AABB surface area to its surface area when the node was built.
+            float maxConeGrowth = 0.5f;     ///< Maximum increase in radians of the node's normal bounding cone angle since the node was built.
+        };
+
+        /** Refit the BVH nodes affected by a set of moved triangles, without changing the hierarchy.
+            Only the leaf nodes referencing the triangles and their ancestors are refit.
+            If a large part of the tree is affected, all nodes are refit instead.
+            The BVH needs to have been built before trying to refit it.
+            \param[in] pRenderContext The render context.
+            \param[in] updatedTriangles Global indices of the triangles that have moved.
+            \param[in] pThresholds If non-null, refit nodes exceeding these thresholds are reported by pollDegradedNodes().
+        */
+        void refit(RenderContext* pRenderContext, const std::vector<uint32_t>& updatedTriangles, const DegradationThresholds* pThresholds = nullptr);
+
+        /** Returns the degraded nodes reported by an earlier refit, once they have been read back from the GPU.
+            Only the topmost nodes are returned, i.e., no returned node is a descendant of another.
+            This call does not block; it returns an empty list while the readback is in flight.
+            \return Node indices sorted in increasing order.
+        */
+        std::vector<uint32_t> pollDegradedNodes();
+
         /** Perform a depth-first traversal of the BVH and run a function on each node.
             \param[in] evalInternal Function called on each internal node.
             \param[in] evalLeaf Function called on each leaf node.
@@ -108,10 +136,29 @@ namespace Falcor
             uint32_t triangleCount = 0;                      ///< Number of triangles inside the BVH.
         };
 
+        /** Per-frame counters for refitting and incremental rebuilds.
+        */
+        struct RefitStats
+        {
+            uint32_t leafNodeCount = 0;                      ///< Number of leaf nodes refit.
+            uint32_t internalNodeCount = 0;                  ///< Number of internal nodes refit.
+            uint32_t degradedNodeCount = 0;                  ///< Number of degraded nodes reported by the GPU.
+            uint32_t rebuiltSubtreeCount = 0;                ///< Number of subtrees rebuilt on the CPU.
+            uint32_t rebuiltNodeCount = 0;                   ///< Number of nodes in the rebuilt subtrees.
+        };
+
         /** Returns stats.
         */
         const BVHStats& getStats() const { return mBVHStats; }
 
+        /** Returns the refit counters accumulated since the last call to resetRefitStats().
+        */
+        const RefitStats& getRefitStats() const { return mRefitStats; }
+
+        /** Resets the refit counters. This is called once per frame by the light sampler.
+        */
+        void resetRefitStats() { mRefitStats = RefitStats(); }
+
         /** Is the BVH valid.
             \return true if the BVH is ready for use.
         */
@@ -130,9 +177,21 @@ namespace Falcor
         void finalize();
         void computeStats();
         void updateNodeIndices();
+        void updateNodeReferences();
         void renderStats(Gui::Widgets& widget, const BVHStats& stats) const;
 
-        void uploadCPUBuffers(const std::vector<uint32_t>& triangleIndices, const std::vector<uint64_t>& triangleBitmasks);
+        /** Replace a subtree by a newly built one over the same triangles.
+            The nodes after the subtree are moved and all child indices are patched accordingly.
+            The caller is responsible for updating the triangle bitmasks, the ancestors' attributes,
+            and for calling finalize() and uploadCPUBuffers() once all subtrees have been replaced.
+            \param[in] nodeIndex Index of the root node of the subtree to replace.
+            \param[in] nodes Nodes of the new subtree. Child indices and triangle offsets are relative to the subtree.
+            \param[in] triangleIndices Triangle indices of the new subtree sorted by leaf node.
+            \return Difference between the new and old node count.
+        */
+        int64_t replaceSubtree(uint32_t nodeIndex, const std::vector<PackedNode>& nodes, const std::vector<uint32_t>& triangleIndices);
+
+        void uploadCPUBuffers();
         void syncDataToCPU() const;
 
         /** Invalidate the BVH.
@@ -145,6 +204,8 @@ namespace Falcor
             uint32_t count = 0;     ///< The number of nodes at each level.
         };
 
+        void refitNodes(RenderContext* pRenderContext, const ref<Buffer>& pNodeIndices, const std::vector<RefitEntryInfo>& perDepthEntryInfo, const DegradationThresholds* pThresholds);
+
         // Internal state
         ref<Device>                           mpDevice;
         ref<const ILightCollection>           mpLightCollection;
@@ -154,10 +215,18 @@ namespace Falcor
 
         // CPU resources
         mutable std::vector<PackedNode>       mNodes;                   ///< CPU-side copy of packed BVH nodes.
+        std::vector<uint32_t>                 mTriangleIndices;         ///< CPU-side copy of the triangle indices sorted by leaf node.
+        std::vector<uint64_t>                 mTriangleBitmasks;        ///< CPU-side copy of the per triangle traversal bitmasks. Indexed by global triangle index.
         std::vector<uint32_t>                 mNodeIndices;             ///< Array of all node indices sorted by tree depth.
         std::vector<RefitEntryInfo>           mPerDepthRefitEntryInfo;  ///< Array containing for each level the number of internal nodes as well as the corresponding offset into 'mpNodeIndicesBuffer'; the very last entry contains the same data, but for all leaf nodes instead.
+        std::vector<uint32_t>                 mParentIndices;           ///< Index of the parent of each node, or kInvalidIndex for the root node.
+        std::vector<uint8_t>                  mNodeDepths;              ///< Depth of each node in the tree.
+        std::vector<uint32_t>                 mTriangleLeafIndices;     ///< Index of the leaf node referencing each triangle, or kInvalidIndex for culled triangles. Indexed by global triangle index.
+        std::vector<float2>                   mNodeReferences;          ///< Per-node AABB surface area and normal bounding cone angle when the node was built. Used for detecting degraded nodes.
+        std::vector<uint8_t>                  mNodeRefitMarks;          ///< Scratch space for marking the nodes to refit.
         uint32_t                              mMaxTriangleCountPerLeaf = 0; ///< After the BVH is built, this contains the maximum light count per leaf node.
         BVHStats                              mBVHStats;
+        RefitStats                            mRefitStats;
         bool                                  mIsValid = false;         ///< True when the BVH has been built.
         mutable bool                          mIsCpuDataValid = false;  ///< Indicates whether the CPU-side data matches the GPU buffers.
 
@@ -166,6 +235,13 @@ namespace Falcor
         ref<Buffer>                           mpTriangleIndicesBuffer;  ///< Triangle indices sorted by leaf node. Each leaf node refers to a contiguous array of triangle indices.
         ref<Buffer>                           mpTriangleBitmasksBuffer; ///< Array containing the per triangle bit pattern retracing the tree traversal to reach the triangle: 0=left child, 1=right child.
         ref<Buffer>                           mpNodeIndicesBuffer;      ///< Buffer holding all node indices sorted by tree depth. This is used for BVH refit.
+        ref<Buffer>                           mpRefitNodeIndicesBuffer; ///< Buffer holding the indices of the nodes to refit sorted by tree depth. This is used for partial BVH refit.
+        ref<Buffer>                           mpNodeReferencesBuffer;   ///< Buffer holding the per-node reference values from 'mNodeReferences'.
+        ref<Buffer>                           mpDegradedNodesBuffer;    ///< Buffer holding the number of degraded nodes found while refitting, followed by their indices.
+        ref<Buffer>                           mpDegradedNodesReadback;  ///< Readback buffer for 'mpDegradedNodesBuffer'.
+        ref<Fence>                            mpDegradedNodesFence;     ///< Fence for waiting on the degraded nodes readback.
+        uint64_t                              mDegradedNodesFenceValue = 0; ///< Fence value signaled after the degraded nodes were copied to the readback buffer.
+        bool                                  mDegradedNodesPending = false; ///< True while a degraded nodes readback is in flight.
 
         friend LightBVHBuilder;
     };
@@ -246,18 +246,7 @@ namespace Falcor
         {
             if (!mOptions.usePreintegration || triangles[i].flux > 0.f)
             {
-                LightBVHBuilder::TriangleSortData tri;
-                for (uint32_t j = 0; j < 3; j++)
-                {
-                    tri.bounds |= triangles[i].vtx[j].pos;
-                }
-                tri.center = triangles[i].getCenter();
-                tri.coneDirection = triangles[i].normal;
-                tri.cosConeAngle = 1.f; // Single flat emitter => normal bounding cone angle is zero.
-                tri.flux = triangles[i].flux;
-                tri.triangleIndex = static_cast<uint32_t>(i);
-
-                data.trianglesData.push_back(tri);
+                data.trianglesData.push_back(createTriangleSortData(triangles[i], static_cast<uint32_t>(i)));
             }
         }
 
@@ -302,12 +291,103 @@ namespace Falcor
         // The BVH is ready, mark it as valid and upload the data.
         bvh.mIsValid = true;
         bvh.mMaxTriangleCountPerLeaf = mOptions.maxTriangleCountPerLeaf;
-        bvh.uploadCPUBuffers(data.triangleIndices, data.triangleBitmasks);
+        bvh.mTriangleIndices = std::move(data.triangleIndices);
+        bvh.mTriangleBitmasks = std::move(data.triangleBitmasks);
+        bvh.uploadCPUBuffers();
 
         // Computate metadata.
         bvh.finalize();
     }
 
+    void LightBVHBuilder::rebuildSubtrees(RenderContext* pRenderContext, LightBVH& bvh, const std::vector<uint32_t>& nodeIndices)
+    {
+        FALCOR_PROFILE(pRenderContext, "LightBVHBuilder::rebuildSubtrees()");
+
+        FALCOR_ASSERT(bvh.isValid());
+        if (nodeIndices.empty()) return;
+
+        // Rebuilding from the root is the same as a full build.
+        if (std::find(nodeIndices.begin(), nodeIndices.end(), 0) != nodeIndices.end())
+        {
+            build(pRenderContext, bvh);
+            ++bvh.mRefitStats.rebuiltSubtreeCount;
+            bvh.mRefitStats.rebuiltNodeCount += (uint32_t)bvh.mNodes.size();
+            return;
+        }
+
+        // The subtrees are built from the current triangle positions and spliced into the current nodes.
+        // Note that this stalls the GPU, but this only happens when the tree has degraded.
+        const auto& triangles = bvh.mpLightCollection->getMeshLightTriangles(pRenderContext);
+        bvh.syncDataToCPU();
+
+        // Process the subtrees from last to first. Replacing a subtree only moves the nodes stored after it,
+        // so the indices of the subtrees that remain to be processed stay valid.
+        std::vector<uint32_t> rootIndices = nodeIndices;
+        std::sort(rootIndices.begin(), rootIndices.end(), std::greater<uint32_t>());
+
+        SplitHeuristicFunction splitFunc = getSplitFunction(mOptions.splitHeuristicSelection);
+        for (size_t i = 0; i < rootIndices.size(); ++i)
+        {
+            const uint32_t nodeIndex = rootIndices[i];
+            FALCOR_ASSERT(nodeIndex < bvh.mNodes.size());
+
+            // Gather the triangles of the subtree. They are stored contiguously, starting at the leftmost leaf.
+            uint32_t firstLeafIndex = nodeIndex;
+            while (!bvh.mNodes[firstLeafIndex].isLeaf()) ++firstLeafIndex;
+            uint32_t lastLeafIndex = nodeIndex;
+            while (!bvh.mNodes[lastLeafIndex].isLeaf()) lastLeafIndex = bvh.mNodes[lastLeafIndex].getInternalNode().rightChildIdx;
+
+            const uint32_t triangleBegin = bvh.mNodes[firstLeafIndex].getLeafNode().triangleOffset;
+            const auto lastLeaf = bvh.mNodes[lastLeafIndex].getLeafNode();
+            const uint32_t triangleEnd = lastLeaf.triangleOffset + lastLeaf.triangleCount;
+
+            std::vector<PackedNode> nodes;
+            BuildingData data(nodes);
+            data.trianglesData.reserve(triangleEnd - triangleBegin);
+            for (uint32_t j = triangleBegin; j < triangleEnd; ++j)
+            {
+                const uint32_t triangleIndex = bvh.mTriangleIndices[j];
+                data.trianglesData.push_back(createTriangleSortData(triangles[triangleIndex], triangleIndex));
+            }
+            data.nodes.reserve(2 * data.trianglesData.size());
+            data.triangleIndices.reserve(data.trianglesData.size());
+
+            // The traversal bitmask of the subtree root is the common prefix of the bitmasks of its triangles.
+            const uint32_t depth = bvh.mNodeDepths[nodeIndex];
+            const uint64_t prefixMask = depth < 64 ? (1ull << depth) - 1 : ~0ull;
+            const uint64_t bitmask = bvh.mTriangleBitmasks[bvh.mTriangleIndices[triangleBegin]] & prefixMask;
+
+            // Build the subtree, writing the bitmasks of its triangles directly into the BVH's array.
+            data.triangleBitmasks.swap(bvh.mTriangleBitmasks);
+            buildInternal(mOptions, splitFunc, bitmask, depth, Range(0, static_cast<uint32_t>(data.trianglesData.size())), data);
+            data.triangleBitmasks.swap(bvh.mTriangleBitmasks);
+
+            float cosConeAngle;
+            computeLightingConesInternal(0, data, cosConeAngle);
+
+            const int64_t delta = bvh.replaceSubtree(nodeIndex, data.nodes, data.triangleIndices);
+
+            // Subtrees processed earlier are stored after this one and have moved.
+            for (size_t k = 0; k < i; ++k) rootIndices[k] = (uint32_t)(rootIndices[k] + delta);
+
+            ++bvh.mRefitStats.rebuiltSubtreeCount;
+            bvh.mRefitStats.rebuiltNodeCount += (uint32_t)data.nodes.size();
+        }
+
+        // Update the parent and depth information, then the ancestors of the new subtrees bottom-up.
+        bvh.finalize();
+
+        for (uint32_t rootIndex : rootIndices)
+        {
+            for (uint32_t nodeIndex = bvh.mParentIndices[rootIndex]; nodeIndex != LightBVH::kInvalidIndex; nodeIndex = bvh.mParentIndices[nodeIndex])
+            {
+                updateInternalNode(bvh.mNodes, nodeIndex);
+            }
+        }
+
+        bvh.uploadCPUBuffers();
+    }
+
     bool LightBVHBuilder::renderUI(Gui::Widgets& widget)
     {
         // Render the build options.
@@ -319,6 +399,16 @@ namespace Falcor
         bool optionsChanged = false;
 
         optionsChanged |= widget.checkbox("Allow refitting", options.allowRefitting);
+        if (options.allowRefitting)
+        {
+            optionsChanged |= widget.checkbox("Allow subtree rebuild", options.allowSubtreeRebuild);
+            widget.tooltip("Rebuild the subtrees whose bounds or lighting cones have grown too much since they were built.", true);
+            if (options.allowSubtreeRebuild)
+            {
+                optionsChanged |= widget.var("Max bounds growth", options.maxBoundsGrowth, 1.f, std::numeric_limits<float>::max(), 0.1f);
+                optionsChanged |= widget.var("Max cone growth (rad)", options.maxConeGrowth, 0.f, float(M_PI), 0.01f);
+            }
+        }
         optionsChanged |= widget.var("Max triangle count per leaf", options.maxTriangleCountPerLeaf, 1u, kMaxLeafTriangleCount);
         optionsChanged |= widget.dropdown("Split heuristic", options.splitHeuristicSelection);
 
@@ -437,6 +527,38 @@ namespace Falcor
         }
     }
 
+    LightBVHBuilder::TriangleSortData LightBVHBuilder::createTriangleSortData(const ILightCollection::MeshLightTriangle& triangle, uint32_t triangleIndex)
+    {
+        TriangleSortData tri;
+        for (uint32_t j = 0; j < 3; j++)
+        {
+            tri.bounds |= triangle.vtx[j].pos;
+        }
+        tri.center = triangle.getCenter();
+        tri.coneDirection = triangle.normal;
+        tri.cosConeAngle = 1.f; // Single flat emitter => normal bounding cone angle is zero.
+        tri.flux = triangle.flux;
+        tri.triangleIndex = triangleIndex;
+        return tri;
+    }
+
+    void LightBVHBuilder::updateInternalNode(std::vector<PackedNode>& nodes, uint32_t nodeIndex)
+    {
+        auto node = nodes[nodeIndex].getInternalNode();
+        auto leftAttribs = nodes[nodeIndex + 1].getNodeAttributes();
+        auto rightAttribs = nodes[node.rightChildIdx].getNodeAttributes();
+
+        float3 leftMin, leftMax, rightMin, rightMax;
+        leftAttribs.getAABB(leftMin, leftMax);
+        rightAttribs.getAABB(rightMin, rightMax);
+        node.attribs.setAABB(min(leftMin, rightMin), max(leftMax, rightMax));
+        node.attribs.flux = leftAttribs.flux + rightAttribs.flux;
+        node.attribs.coneDirection = coneUnionOld(leftAttribs.coneDirection, leftAttribs.cosConeAngle,
+            rightAttribs.coneDirection, rightAttribs.cosConeAngle, node.attribs.cosConeAngle);
+
+        nodes[nodeIndex].setInternalNode(node);
+    }
+
     float3 LightBVHBuilder::computeLightingConesInternal(const uint32_t nodeIndex, BuildingData& data, float& cosConeAngle)
     {
         if (!data.nodes[nodeIndex].isLeaf())
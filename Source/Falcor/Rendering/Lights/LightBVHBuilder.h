@@ -78,6 +78,9 @@ namespace Falcor
             bool           allowRefitting = true;                                ///< Rather than always rebuilding the BVH from scratch, keep the hierarchy but update the bounds and lighting cones.
             bool           usePreintegration = true;                             ///< Use pre-integration for culling out emissive triangles and use their flux when computing the splits. Only valid when using the BinnedSAOH split heuristic.
             bool           useLightingCones = true;                              ///< Use lighting cones when computing the splits. Only valid when using the BinnedSAOH split heuristic.
+            bool           allowSubtreeRebuild = true;                           ///< When refitting, rebuild the subtrees whose bounds or lighting cones have degraded beyond the thresholds below. Only valid when 'allowRefitting' is enabled.
+            float          maxBoundsGrowth = 2.f;                                ///< Maximum ratio of a node's AABB surface area after refitting to its surface area when built.
+            float          maxConeGrowth = 0.5f;                                 ///< Maximum increase in radians of a node's lighting cone angle after refitting.
 
             template<typename Archive>
             void serialize(Archive& ar)
@@ -93,6 +96,9 @@ namespace Falcor
                 ar("allowRefitting", allowRefitting);
                 ar("usePreintegration", usePreintegration);
                 ar("useLightingCones", useLightingCones);
+                ar("allowSubtreeRebuild", allowSubtreeRebuild);
+                ar("maxBoundsGrowth", maxBoundsGrowth);
+                ar("maxConeGrowth", maxConeGrowth);
             }
         };
 
@@ -106,6 +112,19 @@ namespace Falcor
         */
         void build(RenderContext* pRenderContext, LightBVH& bvh);
 
+        /** Rebuild subtrees of the BVH in place, keeping the rest of the hierarchy.
+            This is used for incrementally fixing subtrees whose quality has degraded after refitting.
+            The ancestors of the rebuilt subtrees are updated to match. If the root node is included, the whole BVH is rebuilt.
+            \param[in] pRenderContext The render context.
+            \param[in,out] bvh The light BVH to update. It must have been built with the current options.
+            \param[in] nodeIndices Indices of the subtree root nodes. No node may be a descendant of another.
+        */
+        void rebuildSubtrees(RenderContext* pRenderContext, LightBVH& bvh, const std::vector<uint32_t>& nodeIndices);
+
+        /** Returns the thresholds for detecting degraded nodes while refitting.
+        */
+        LightBVH::DegradationThresholds getDegradationThresholds() const { return { mOptions.maxBoundsGrowth, mOptions.maxConeGrowth }; }
+
         bool renderUI(Gui::Widgets& widget);
 
         const Options& getOptions() const { return mOptions; }
@@ -176,6 +195,18 @@ namespace Falcor
         */
         uint32_t buildInternal(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data);
 
+        /** Creates the data used for sorting a triangle during the build.
+            \param[in] triangle The emissive triangle.
+            \param[in] triangleIndex Index of the triangle in the global triangle list.
+        */
+        static TriangleSortData createTriangleSortData(const ILightCollection::MeshLightTriangle& triangle, uint32_t triangleIndex);
+
+        /** Recomputes the bounds, flux and lighting cone of an internal node from its children.
+            \param[in,out] nodes The BVH nodes.
+            \param[in] nodeIndex Index of the internal node.
+        */
+        static void updateInternalNode(std::vector<PackedNode>& nodes, uint32_t nodeIndex);
+
         /** Recursive computation of lighting cones for all internal nodes.
             \param[in] nodeIndex Index of the current node.
             \param[in,out] data Updated node data.
@@ -47,6 +47,8 @@ namespace Falcor
             mpBVH = std::make_unique<LightBVH>(mpDevice, mpLightCollection);
         }
 
+        mpBVH->resetRefitStats();
+
         // Check if light collection has changed.
         if (mLightCollectionUpdateFlags == ILightCollection::UpdateFlags::LayoutChanged)
         {
@@ -66,11 +68,39 @@ namespace Falcor
             mNeedsRebuild = false;
             samplerChanged = true;
         }
-        else if (needsRefit)
+        else if (mpBVH->isValid() && mOptions.buildOptions.allowRefitting)
         {
-            mpBVH->refit(pRenderContext);
-            samplerChanged = true;
+            const bool allowSubtreeRebuild = mOptions.buildOptions.allowSubtreeRebuild;
+            const LightBVH::DegradationThresholds thresholds = mpBVHBuilder->getDegradationThresholds();
+
+            // Rebuild the subtrees reported as degraded by an earlier refit.
+            // The report is read back asynchronously, so it lags a few frames behind.
+            if (allowSubtreeRebuild)
+            {
+                std::vector<uint32_t> degradedNodes = mpBVH->pollDegradedNodes();
+                if (!degradedNodes.empty())
+                {
+                    mpBVHBuilder->rebuildSubtrees(pRenderContext, *mpBVH, degradedNodes);
+                    samplerChanged = true;
+                }
+            }
+
+            // Refit only the nodes affected by the lights that have moved.
+            if (needsRefit)
+            {
+                const auto& meshLights = mpLightCollection->getMeshLights();
+                std::vector<uint32_t> updatedTriangles;
+                for (uint32_t lightIdx : mUpdatedLights)
+                {
+                    const MeshLightData& meshLight = meshLights[lightIdx];
+                    for (uint32_t i = 0; i < meshLight.triangleCount; ++i) updatedTriangles.push_back(meshLight.triangleOffset + i);
+                }
+
+                mpBVH->refit(pRenderContext, updatedTriangles, allowSubtreeRebuild ? &thresholds : nullptr);
+                samplerChanged = true;
+            }
         }
+        mUpdatedLights.clear();
 
         return samplerChanged;
     }
@@ -0,0 +1,144 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "BlasGrouping.h"
+#include "Core/Error.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Group state during packing.
+        */
+        struct GroupState
+        {
+            BlasGrouping::Group group;
+            uint64_t sharedScratchByteSize = 0;     ///< Size of the scratch region shared by the BLASes that are not updated.
+            uint64_t dedicatedScratchByteSize = 0;  ///< Total size of the dedicated scratch regions.
+
+            void add(uint32_t blasIndex, const BlasGrouping::BlasInfo& blas, uint64_t finalByteSize)
+            {
+                group.blasIndices.push_back(blasIndex);
+                if (blas.isUpdated) dedicatedScratchByteSize += blas.scratchByteSize;
+                else sharedScratchByteSize = std::max(sharedScratchByteSize, blas.scratchByteSize);
+                group.resultByteSize += blas.resultByteSize;
+                group.scratchByteSize = std::max(sharedScratchByteSize, dedicatedScratchByteSize);
+                group.finalByteSize += finalByteSize;
+            }
+
+            /// Returns the size of the group if the BLAS was added to it.
+            uint64_t getByteSizeWith(const BlasGrouping::BlasInfo& blas, uint64_t finalByteSize) const
+            {
+                uint64_t scratchByteSize = blas.isUpdated
+                    ? std::max(sharedScratchByteSize, dedicatedScratchByteSize + blas.scratchByteSize)
+                    : std::max(group.scratchByteSize, blas.scratchByteSize);
+                return group.resultByteSize + blas.resultByteSize + scratchByteSize + group.finalByteSize + finalByteSize;
+            }
+        };
+    }
+
+    BlasGrouping::Result BlasGrouping::compute(fstd::span<const BlasInfo> blases, const Options& options)
+    {
+        FALCOR_CHECK(options.compactionRatio >= 0.f && options.compactionRatio <= 1.f, "Compaction ratio must be in [0, 1].");
+
+        const uint32_t blasCount = (uint32_t)blases.size();
+
+        // Estimate the final size of each BLAS. Non-compacted BLASes are cloned to the final buffer as-is.
+        std::vector<uint64_t> finalByteSizes(blasCount);
+        for (uint32_t i = 0; i < blasCount; i++)
+        {
+            const auto& blas = blases[i];
+            finalByteSizes[i] = blas.useCompaction ? (uint64_t)std::ceil((double)blas.resultByteSize * options.compactionRatio) : blas.resultByteSize;
+        }
+
+        // Determine the order in which BLASes are placed.
+        std::vector<uint32_t> order(blasCount);
+        std::iota(order.begin(), order.end(), 0);
+        if (options.policy == Policy::FirstFitDecreasing)
+        {
+            auto getByteSize = [&](uint32_t i) { return blases[i].resultByteSize + blases[i].scratchByteSize + finalByteSizes[i]; };
+            std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return getByteSize(a) > getByteSize(b); });
+        }
+
+        // Place the BLASes. The sequential policy only considers the last group, first-fit considers all groups.
+        std::vector<GroupState> groups;
+        for (uint32_t blasIndex : order)
+        {
+            const auto& blas = blases[blasIndex];
+            const uint64_t finalByteSize = finalByteSizes[blasIndex];
+
+            size_t firstCandidate = options.policy == Policy::Sequential && !groups.empty() ? groups.size() - 1 : 0;
+            size_t groupIndex = firstCandidate;
+            for (; groupIndex < groups.size(); groupIndex++)
+            {
+                if (groups[groupIndex].getByteSizeWith(blas, finalByteSize) <= options.maxGroupByteSize) break;
+            }
+            if (groupIndex == groups.size()) groups.push_back({});
+            groups[groupIndex].add(blasIndex, blas, finalByteSize);
+        }
+
+        // Lay out the BLASes in the result and scratch buffers.
+        // BLASes are kept in increasing order within a group, so that the build order is independent of the policy.
+        Result result;
+        result.groupIndices.resize(blasCount);
+        result.resultByteOffsets.resize(blasCount);
+        result.scratchByteOffsets.resize(blasCount);
+        result.groups.reserve(groups.size());
+
+        for (auto& state : groups)
+        {
+            auto& group = state.group;
+            std::sort(group.blasIndices.begin(), group.blasIndices.end());
+
+            uint64_t resultByteOffset = 0;
+            uint64_t scratchByteOffset = 0;
+            for (uint32_t blasIndex : group.blasIndices)
+            {
+                const auto& blas = blases[blasIndex];
+                result.groupIndices[blasIndex] = (uint32_t)result.groups.size();
+                result.resultByteOffsets[blasIndex] = resultByteOffset;
+                resultByteOffset += blas.resultByteSize;
+
+                // BLASes that are not updated alias the dedicated scratch regions, their builds are serialized.
+                result.scratchByteOffsets[blasIndex] = blas.isUpdated ? scratchByteOffset : 0;
+                if (blas.isUpdated) scratchByteOffset += blas.scratchByteSize;
+            }
+            FALCOR_ASSERT(resultByteOffset == group.resultByteSize);
+            FALCOR_ASSERT(scratchByteOffset <= group.scratchByteSize);
+
+            result.resultBufferByteSize = std::max(result.resultBufferByteSize, group.resultByteSize);
+            result.scratchBufferByteSize = std::max(result.scratchBufferByteSize, group.scratchByteSize);
+            result.finalByteSize += group.finalByteSize;
+            result.groups.push_back(std::move(group));
+        }
+
+        return result;
+    }
+}
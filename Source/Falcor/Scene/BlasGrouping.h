@@ -0,0 +1,105 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <fstd/span.h>
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+    /** Organizes BLASes into groups that are built together, in order to bound the GPU memory used during BLAS builds.
+
+        All groups share one intermediate result buffer and one scratch buffer, sized for the largest group.
+        The BLASes of a group are compacted into a final buffer that is allocated while the intermediate buffers
+        are still alive, so the expected compacted size of a group counts towards its memory budget.
+        The compacted size is estimated from the compaction ratio observed in previous builds.
+
+        BLASes that are never updated after their initial build share a single scratch region in their group,
+        as the initial builds are serialized. BLASes that are updated get dedicated scratch regions, since the
+        updates within a group are issued without barriers in between.
+    */
+    class FALCOR_API BlasGrouping
+    {
+    public:
+        enum class Policy : uint32_t
+        {
+            Sequential,             ///< Fill groups greedily in BLAS order, starting a new group when the budget is exceeded.
+            FirstFitDecreasing,     ///< Place BLASes in order of decreasing size into the first group with enough room.
+        };
+
+        struct Options
+        {
+            Policy policy = Policy::FirstFitDecreasing;
+            uint64_t maxGroupByteSize = 1ull << 29;     ///< Target memory per group. BLASes exceeding it are placed in a group of their own.
+            float compactionRatio = 1.f;                ///< Expected ratio of compacted to uncompacted size of compacted BLASes.
+        };
+
+        /** Memory requirements of one BLAS.
+        */
+        struct BlasInfo
+        {
+            uint64_t resultByteSize = 0;                ///< Maximum result data size, including padding.
+            uint64_t scratchByteSize = 0;               ///< Maximum scratch data size, including padding.
+            bool useCompaction = false;                 ///< Whether the BLAS is compacted after build.
+            bool isUpdated = false;                     ///< Whether the BLAS is updated after the initial build, which requires a dedicated scratch region.
+        };
+
+        struct Group
+        {
+            std::vector<uint32_t> blasIndices;          ///< Indices of the BLASes in the group in increasing order.
+            uint64_t resultByteSize = 0;                ///< Result data size of the group.
+            uint64_t scratchByteSize = 0;               ///< Scratch data size of the group.
+            uint64_t finalByteSize = 0;                 ///< Estimated size of the BLASes in the group post-compaction.
+
+            uint64_t getByteSize() const { return resultByteSize + scratchByteSize + finalByteSize; }
+        };
+
+        struct Result
+        {
+            std::vector<Group> groups;                  ///< BLAS groups in build order.
+            std::vector<uint32_t> groupIndices;         ///< Group index per BLAS.
+            std::vector<uint64_t> resultByteOffsets;    ///< Offset into the result buffer per BLAS.
+            std::vector<uint64_t> scratchByteOffsets;   ///< Offset into the scratch buffer per BLAS.
+
+            uint64_t resultBufferByteSize = 0;          ///< Required size of the shared result buffer.
+            uint64_t scratchBufferByteSize = 0;         ///< Required size of the shared scratch buffer.
+            uint64_t finalByteSize = 0;                 ///< Estimated total size of the BLASes post-compaction.
+
+            /// Estimated peak memory usage during the build, reached while compacting the last group.
+            uint64_t getPeakByteSize() const { return resultBufferByteSize + scratchBufferByteSize + finalByteSize; }
+        };
+
+        /** Compute the BLAS groups.
+            \param[in] blases Memory requirements of the BLASes.
+            \param[in] options Grouping options.
+            \return The BLAS groups and the buffer layout.
+        */
+        static Result compute(fstd::span<const BlasInfo> blases, const Options& options);
+    };
+}
@@ -0,0 +1,892 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "CPUSceneRayQuery.h"
+#include "Scene.h"
+#include "Animation/AnimationController.h"
+#include "Core/Error.h"
+#include "Utils/Logger.h"
+#include "Utils/NumericRange.h"
+#include "Utils/Math/Common.h"
+#include "Utils/Scripting/ScriptBindings.h"
+#include "Utils/Scripting/ndarray.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <execution>
+#include <limits>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define FALCOR_CPU_RAY_QUERY_SSE 1
+#include <xmmintrin.h>
+#else
+#define FALCOR_CPU_RAY_QUERY_SSE 0
+#endif
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kInvalidIndex = std::numeric_limits<uint32_t>::max();
+
+        const uint32_t kBinCount = 16;                  ///< Number of bins used for finding SAH splits.
+        const uint32_t kMaxLeafSize = 4;                ///< Max number of primitives per leaf.
+        const uint32_t kMaxSAHDepth = 48;               ///< Depth after which primitives are split at the median, bounding the tree depth.
+        const uint32_t kParallelBuildThreshold = 16384; ///< Primitive ranges larger than this are processed in parallel.
+        const uint32_t kStackSize = 256;                ///< Traversal stack size. Sufficient for trees of depth up to 85.
+        const uint32_t kRaysPerTask = 256;              ///< Number of rays processed per task in batched queries.
+
+        /** Range of primitives during the BVH build.
+        */
+        struct BuildRange
+        {
+            uint32_t begin = 0;
+            uint32_t end = 0;
+            AABB bounds;                                ///< Bounds of the primitives.
+            AABB centroidBounds;                        ///< Bounds of the primitive centroids.
+
+            uint32_t count() const { return end - begin; }
+        };
+
+        /** Ray with precomputed data for the ray-box tests.
+        */
+        struct TraversalRay
+        {
+            float3 origin;
+            float3 dir;
+            float3 invDir;
+            uint32_t dirIsNeg[3];
+            float tMin;
+            float tMax;
+
+            TraversalRay(const float3& origin_, const float3& dir_, float tMin_, float tMax_)
+                : origin(origin_), dir(dir_), tMin(tMin_), tMax(tMax_)
+            {
+                // Avoid infinite reciprocals, which produce NaNs in the slab test for rays starting on a slab plane.
+                const float kMinDir = 1e-20f;
+                for (uint32_t i = 0; i < 3; i++)
+                {
+                    float d = std::abs(dir[i]) < kMinDir ? std::copysign(kMinDir, dir[i]) : dir[i];
+                    invDir[i] = 1.f / d;
+                    dirIsNeg[i] = invDir[i] < 0.f ? 1 : 0;
+                }
+            }
+        };
+
+        struct StackEntry
+        {
+            uint32_t child;
+            uint32_t count;
+            float tNear;
+        };
+    }
+
+    /** 4-wide BVH over a set of primitive bounds.
+        Each node stores the bounds of its four children in SoA layout, so the ray can be tested against all of them at once.
+    */
+    struct CPUSceneRayQuery::BVH
+    {
+        static constexpr uint32_t kWidth = 4;
+
+        struct alignas(64) Node
+        {
+            float bounds[2][3][kWidth];                 ///< Child bounds, indexed by [min/max][axis][child]. Empty slots have min bounds at +inf and max bounds at -inf.
+            uint32_t child[kWidth];                     ///< Child node index for inner nodes, index of the first primitive for leaves, or kInvalidIndex for empty slots.
+            uint32_t count[kWidth];                     ///< Number of primitives for leaves, or zero for inner nodes and empty slots.
+        };
+        static_assert(sizeof(Node) == 128);
+
+        std::vector<Node> nodes;                        ///< Nodes. The root is the first node.
+        std::vector<uint32_t> primIndices;              ///< Primitive indices in leaf order.
+        AABB bounds;                                    ///< Bounds of all primitives.
+
+        /** Build the BVH.
+            \param[in] primBounds Bounds of the primitives. Invalid bounds are excluded from the BVH.
+        */
+        void build(const std::vector<AABB>& primBounds);
+
+        /** Traverse the BVH.
+            \param[in,out] ray Ray. The max distance is updated by the intersection function for closest-hit queries.
+            \param[in] intersectLeaf Function called for the primitives of each leaf hit by the ray, with the arguments (primBegin, primEnd, ray).
+                Returns true if traversal should be terminated.
+            \return True if traversal was terminated by the intersection function.
+        */
+        template<bool TOrdered, typename IntersectFunc>
+        bool traverse(TraversalRay& ray, IntersectFunc intersectLeaf) const;
+
+    private:
+        struct Builder;
+    };
+
+    struct CPUSceneRayQuery::BVH::Builder
+    {
+        const std::vector<AABB>& primBounds;
+        std::vector<uint32_t>& primIndices;
+
+        struct Bin
+        {
+            AABB bounds;
+            uint32_t count = 0;
+        };
+        using Bins = std::array<std::array<Bin, kBinCount>, 3>;
+
+        Builder(const std::vector<AABB>& primBounds, std::vector<uint32_t>& primIndices) : primBounds(primBounds), primIndices(primIndices) {}
+
+        template<typename Func>
+        void forEachChunk(const BuildRange& range, Func func)
+        {
+            // Ranges of primitives are processed in parallel chunks if they are large, which is the case in the top levels of the tree.
+            const uint32_t chunkCount = div_round_up(range.count(), kParallelBuildThreshold);
+            if (chunkCount == 1)
+            {
+                func(0, range.begin, range.end);
+                return;
+            }
+            auto chunks = NumericRange<uint32_t>(0, chunkCount);
+            std::for_each(std::execution::par, chunks.begin(), chunks.end(), [&](uint32_t chunk)
+            {
+                const uint32_t begin = range.begin + chunk * kParallelBuildThreshold;
+                func(chunk, begin, std::min(range.end, begin + kParallelBuildThreshold));
+            });
+        }
+
+        void computeBounds(BuildRange& range)
+        {
+            const uint32_t chunkCount = div_round_up(range.count(), kParallelBuildThreshold);
+            std::vector<AABB> bounds(chunkCount), centroidBounds(chunkCount);
+            forEachChunk(range, [&](uint32_t chunk, uint32_t begin, uint32_t end)
+            {
+                for (uint32_t i = begin; i < end; i++)
+                {
+                    const AABB& b = primBounds[primIndices[i]];
+                    bounds[chunk].include(b);
+                    centroidBounds[chunk].include(b.center());
+                }
+            });
+
+            range.bounds = AABB();
+            range.centroidBounds = AABB();
+            for (uint32_t chunk = 0; chunk < chunkCount; chunk++)
+            {
+                range.bounds.include(bounds[chunk]);
+                range.centroidBounds.include(centroidBounds[chunk]);
+            }
+        }
+
+        BuildRange makeRange(uint32_t begin, uint32_t end)
+        {
+            BuildRange range;
+            range.begin = begin;
+            range.end = end;
+            computeBounds(range);
+            return range;
+        }
+
+        uint32_t getBinIndex(const BuildRange& range, uint32_t axis, float centroid) const
+        {
+            const float extent = range.centroidBounds.maxPoint[axis] - range.centroidBounds.minPoint[axis];
+            const float scale = kBinCount / extent;
+            return std::min(kBinCount - 1, (uint32_t)((centroid - range.centroidBounds.minPoint[axis]) * scale));
+        }
+
+        /** Split a range of primitives in two.
+            The split is chosen using the binned SAH, or at the median for deep trees and when all centroids coincide.
+            \return True if the range was split.
+        */
+        bool split(const BuildRange& range, uint32_t depth, BuildRange& left, BuildRange& right)
+        {
+            if (range.count() <= kMaxLeafSize)
+                return false;
+
+            const float3 centroidExtent = range.centroidBounds.extent();
+            uint32_t bestAxis = kInvalidIndex;
+            uint32_t bestSplit = 0;
+
+            if (depth < kMaxSAHDepth && any(centroidExtent > float3(0.f)))
+            {
+                // Bin the primitives by their centroids on all axes.
+                const uint32_t chunkCount = div_round_up(range.count(), kParallelBuildThreshold);
+                std::vector<Bins> chunkBins(chunkCount);
+                forEachChunk(range, [&](uint32_t chunk, uint32_t begin, uint32_t end)
+                {
+                    Bins& bins = chunkBins[chunk];
+                    for (uint32_t i = begin; i < end; i++)
+                    {
+                        const AABB& b = primBounds[primIndices[i]];
+                        const float3 c = b.center();
+                        for (uint32_t axis = 0; axis < 3; axis++)
+                        {
+                            if (centroidExtent[axis] <= 0.f) continue;
+                            Bin& bin = bins[axis][getBinIndex(range, axis, c[axis])];
+                            bin.bounds.include(b);
+                            bin.count++;
+                        }
+                    }
+                });
+
+                Bins bins = chunkBins[0];
+                for (uint32_t chunk = 1; chunk < chunkCount; chunk++)
+                {
+                    for (uint32_t axis = 0; axis < 3; axis++)
+                    {
+                        for (uint32_t i = 0; i < kBinCount; i++)
+                        {
+                            bins[axis][i].bounds.include(chunkBins[chunk][axis][i].bounds);
+                            bins[axis][i].count += chunkBins[chunk][axis][i].count;
+                        }
+                    }
+                }
+
+                // Evaluate the SAH cost of the splits between the bins, using a sweep from the right followed by a sweep from the left.
+                float bestCost = std::numeric_limits<float>::infinity();
+                for (uint32_t axis = 0; axis < 3; axis++)
+                {
+                    if (centroidExtent[axis] <= 0.f) continue;
+
+                    std::array<float, kBinCount> rightCost;
+                    AABB rightBounds;
+                    uint32_t rightCount = 0;
+                    for (uint32_t i = kBinCount - 1; i > 0; i--)
+                    {
+                        rightBounds.include(bins[axis][i].bounds);
+                        rightCount += bins[axis][i].count;
+                        rightCost[i] = rightCount > 0 ? rightBounds.area() * rightCount : 0.f;
+                    }
+
+                    AABB leftBounds;
+                    uint32_t leftCount = 0;
+                    for (uint32_t i = 1; i < kBinCount; i++)
+                    {
+                        leftBounds.include(bins[axis][i - 1].bounds);
+                        leftCount += bins[axis][i - 1].count;
+                        if (leftCount == 0 || leftCount == range.count()) continue;
+
+                        float cost = leftBounds.area() * leftCount + rightCost[i];
+                        if (cost < bestCost)
+                        {
+                            bestCost = cost;
+                            bestAxis = axis;
+                            bestSplit = i;
+                        }
+                    }
+                }
+            }
+
+            uint32_t mid = 0;
+            if (bestAxis != kInvalidIndex)
+            {
+                auto isLeft = [&](uint32_t primIndex) { return getBinIndex(range, bestAxis, primBounds[primIndex].center()[bestAxis]) < bestSplit; };
+                auto begin = primIndices.begin() + range.begin;
+                auto end = primIndices.begin() + range.end;
+                auto it = range.count() > kParallelBuildThreshold ? std::partition(std::execution::par, begin, end, isLeft) : std::partition(begin, end, isLeft);
+                mid = (uint32_t)(it - primIndices.begin());
+            }
+            else
+            {
+                // Split at the median along the axis of largest centroid extent.
+                const uint32_t axis = centroidExtent.x >= centroidExtent.y && centroidExtent.x >= centroidExtent.z ? 0 : (centroidExtent.y >= centroidExtent.z ? 1 : 2);
+                mid = range.begin + range.count() / 2;
+                std::nth_element(primIndices.begin() + range.begin, primIndices.begin() + mid, primIndices.begin() + range.end,
+                    [&](uint32_t a, uint32_t b) { return primBounds[a].center()[axis] < primBounds[b].center()[axis]; });
+            }
+            FALCOR_ASSERT(mid > range.begin && mid < range.end);
+
+            left = makeRange(range.begin, mid);
+            right = makeRange(mid, range.end);
+            return true;
+        }
+
+        /** Build the subtree for a range of primitives.
+            \param[in] range Primitive range.
+            \param[in] depth Depth of the node.
+            \param[in,out] nodes Nodes. The subtree is appended.
+            \return Index of the root node of the subtree.
+        */
+        uint32_t buildNode(const BuildRange& range, uint32_t depth, std::vector<Node>& nodes)
+        {
+            // Split the range into up to four children, always splitting the child with the largest surface area.
+            std::array<BuildRange, kWidth> children;
+            uint32_t childCount = 1;
+            children[0] = range;
+            while (childCount < kWidth)
+            {
+                uint32_t bestChild = kInvalidIndex;
+                float bestArea = -1.f;
+                for (uint32_t i = 0; i < childCount; i++)
+                {
+                    if (children[i].count() > kMaxLeafSize && children[i].bounds.area() > bestArea)
+                    {
+                        bestChild = i;
+                        bestArea = children[i].bounds.area();
+                    }
+                }
+                if (bestChild == kInvalidIndex) break;
+
+                BuildRange left, right;
+                if (!split(children[bestChild], depth, left, right)) break;
+                children[bestChild] = left;
+                children[childCount++] = right;
+            }
+
+            const uint32_t nodeIndex = (uint32_t)nodes.size();
+            nodes.emplace_back();
+            {
+                Node& node = nodes[nodeIndex];
+                for (uint32_t i = 0; i < kWidth; i++)
+                {
+                    // Empty slots have inverted infinite bounds, so that the slab test fails for any ray, including rays with an infinite tMax.
+                    const bool valid = i < childCount;
+                    for (uint32_t axis = 0; axis < 3; axis++)
+                    {
+                        node.bounds[0][axis][i] = valid ? children[i].bounds.minPoint[axis] : std::numeric_limits<float>::infinity();
+                        node.bounds[1][axis][i] = valid ? children[i].bounds.maxPoint[axis] : -std::numeric_limits<float>::infinity();
+                    }
+                    node.child[i] = valid ? children[i].begin : kInvalidIndex;
+                    node.count[i] = valid ? children[i].count() : 0;
+                }
+            }
+
+            // Build the subtrees of the inner children. Large subtrees are built in parallel into separate node lists, which are appended afterwards.
+            std::array<std::vector<Node>, kWidth> subtrees;
+            std::array<uint32_t, kWidth> subtreeRoots;
+            auto buildChild = [&](uint32_t i)
+            {
+                if (i < childCount && children[i].count() > kMaxLeafSize)
+                    subtreeRoots[i] = buildNode(children[i], depth + 1, subtrees[i]);
+            };
+
+            if (range.count() > kParallelBuildThreshold)
+            {
+                auto childRange = NumericRange<uint32_t>(0, kWidth);
+                std::for_each(std::execution::par, childRange.begin(), childRange.end(), buildChild);
+            }
+            else
+            {
+                for (uint32_t i = 0; i < kWidth; i++) buildChild(i);
+            }
+
+            for (uint32_t i = 0; i < childCount; i++)
+            {
+                if (children[i].count() <= kMaxLeafSize) continue;
+
+                // Relocate the child indices of the subtree nodes.
+                const uint32_t offset = (uint32_t)nodes.size();
+                for (Node& subtreeNode : subtrees[i])
+                {
+                    for (uint32_t j = 0; j < kWidth; j++)
+                    {
+                        if (subtreeNode.count[j] == 0 && subtreeNode.child[j] != kInvalidIndex) subtreeNode.child[j] += offset;
+                    }
+                }
+                nodes.insert(nodes.end(), subtrees[i].begin(), subtrees[i].end());
+                nodes[nodeIndex].child[i] = subtreeRoots[i] + offset;
+                nodes[nodeIndex].count[i] = 0;
+            }
+
+            return nodeIndex;
+        }
+    };
+
+    void CPUSceneRayQuery::BVH::build(const std::vector<AABB>& primBounds)
+    {
+        nodes.clear();
+        primIndices.clear();
+        for (uint32_t i = 0; i < (uint32_t)primBounds.size(); i++)
+        {
+            if (primBounds[i].valid()) primIndices.push_back(i);
+        }
+
+        Builder builder(primBounds, primIndices);
+        BuildRange range = builder.makeRange(0, (uint32_t)primIndices.size());
+        bounds = range.bounds;
+
+        if (range.count() == 0) return;
+        builder.buildNode(range, 0, nodes);
+    }
+
+    template<bool TOrdered, typename IntersectFunc>
+    bool CPUSceneRayQuery::BVH::traverse(TraversalRay& ray, IntersectFunc intersectLeaf) const
+    {
+        if (nodes.empty()) return false;
+
+        StackEntry stack[kStackSize];
+        uint32_t stackSize = 0;
+        stack[stackSize++] = { 0, 0, ray.tMin };
+
+#if FALCOR_CPU_RAY_QUERY_SSE
+        const __m128 originX = _mm_set1_ps(ray.origin.x);
+        const __m128 originY = _mm_set1_ps(ray.origin.y);
+        const __m128 originZ = _mm_set1_ps(ray.origin.z);
+        const __m128 invDirX = _mm_set1_ps(ray.invDir.x);
+        const __m128 invDirY = _mm_set1_ps(ray.invDir.y);
+        const __m128 invDirZ = _mm_set1_ps(ray.invDir.z);
+#endif
+
+        while (stackSize > 0)
+        {
+            const StackEntry entry = stack[--stackSize];
+            if (entry.tNear > ray.tMax) continue;
+
+            if (entry.count > 0)
+            {
+                if (intersectLeaf(entry.child, entry.child + entry.count, ray)) return true;
+                continue;
+            }
+
+            // Intersect the ray with the bounds of the four children.
+            const Node& node = nodes[entry.child];
+            alignas(16) float tNear[kWidth];
+            uint32_t hitMask = 0;
+#if FALCOR_CPU_RAY_QUERY_SSE
+            {
+                const __m128 tx0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.bounds[ray.dirIsNeg[0]][0]), originX), invDirX);
+                const __m128 tx1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.bounds[1 - ray.dirIsNeg[0]][0]), originX), invDirX);
+                const __m128 ty0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.bounds[ray.dirIsNeg[1]][1]), originY), invDirY);
+                const __m128 ty1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.bounds[1 - ray.dirIsNeg[1]][1]), originY), invDirY);
+                const __m128 tz0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.bounds[ray.dirIsNeg[2]][2]), originZ), invDirZ);
+                const __m128 tz1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.bounds[1 - ray.dirIsNeg[2]][2]), originZ), invDirZ);
+                const __m128 t0 = _mm_max_ps(_mm_max_ps(tx0, ty0), _mm_max_ps(tz0, _mm_set1_ps(ray.tMin)));
+                const __m128 t1 = _mm_min_ps(_mm_min_ps(tx1, ty1), _mm_min_ps(tz1, _mm_set1_ps(ray.tMax)));
+                _mm_store_ps(tNear, t0);
+                hitMask = (uint32_t)_mm_movemask_ps(_mm_cmple_ps(t0, t1));
+            }
+#else
+            for (uint32_t i = 0; i < kWidth; i++)
+            {
+                float t0 = ray.tMin;
+                float t1 = ray.tMax;
+                for (uint32_t axis = 0; axis < 3; axis++)
+                {
+                    t0 = std::max(t0, (node.bounds[ray.dirIsNeg[axis]][axis][i] - ray.origin[axis]) * ray.invDir[axis]);
+                    t1 = std::min(t1, (node.bounds[1 - ray.dirIsNeg[axis]][axis][i] - ray.origin[axis]) * ray.invDir[axis]);
+                }
+                tNear[i] = t0;
+                if (t0 <= t1) hitMask |= 1u << i;
+            }
+#endif
+
+            // Push the children that were hit. For ordered traversal, the nearest child is pushed last so it is visited first.
+            const uint32_t stackBegin = stackSize;
+            for (uint32_t i = 0; i < kWidth; i++)
+            {
+                if ((hitMask & (1u << i)) == 0) continue;
+                FALCOR_ASSERT(node.child[i] != kInvalidIndex);
+                FALCOR_ASSERT(stackSize < kStackSize);
+                StackEntry childEntry = { node.child[i], node.count[i], tNear[i] };
+                uint32_t j = stackSize++;
+                if constexpr (TOrdered)
+                {
+                    for (; j > stackBegin && stack[j - 1].tNear < childEntry.tNear; j--) stack[j] = stack[j - 1];
+                }
+                stack[j] = childEntry;
+            }
+        }
+
+        return false;
+    }
+
+    /** Bottom-level BVH over the triangles of a mesh.
+    */
+    struct CPUSceneRayQuery::BLAS
+    {
+        /** Triangle in the layout used for intersection.
+        */
+        struct Triangle
+        {
+            float3 v0;
+            float3 e1;                                  ///< v1 - v0.
+            float3 e2;                                  ///< v2 - v0.
+            uint32_t primitiveIndex;                    ///< Triangle index in the mesh.
+        };
+
+        BVH bvh;
+        std::vector<Triangle> triangles;                ///< Triangles in leaf order.
+
+        void build(const MeshData& mesh)
+        {
+            const uint32_t triangleCount = (uint32_t)(mesh.indices.empty() ? mesh.positions.size() : mesh.indices.size()) / 3;
+            auto getVertex = [&](uint32_t triangle, uint32_t vertex)
+            {
+                const uint32_t index = mesh.indices.empty() ? triangle * 3 + vertex : mesh.indices[triangle * 3 + vertex];
+                return mesh.positions[index];
+            };
+
+            std::vector<AABB> primBounds(triangleCount);
+            auto range = NumericRange<uint32_t>(0, triangleCount);
+            std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t i)
+            {
+                AABB b(getVertex(i, 0));
+                b.include(getVertex(i, 1));
+                b.include(getVertex(i, 2));
+                // Exclude triangles with non-finite vertices.
+                if (all(isfinite(b.minPoint)) && all(isfinite(b.maxPoint))) primBounds[i] = b;
+            });
+
+            bvh.build(primBounds);
+
+            // Store the triangles in leaf order, so that the primitive index of the BVH directly indexes the triangle list.
+            triangles.resize(bvh.primIndices.size());
+            auto leafRange = NumericRange<size_t>(0, triangles.size());
+            std::for_each(std::execution::par, leafRange.begin(), leafRange.end(), [&](size_t i)
+            {
+                const uint32_t primitiveIndex = bvh.primIndices[i];
+                const float3 v0 = getVertex(primitiveIndex, 0);
+                triangles[i] = { v0, getVertex(primitiveIndex, 1) - v0, getVertex(primitiveIndex, 2) - v0, primitiveIndex };
+            });
+            bvh.primIndices.clear();
+            bvh.primIndices.shrink_to_fit();
+        }
+
+        /** Intersect a ray with a triangle using the Moller-Trumbore algorithm.
+            The test is watertight enough for our purposes, but not exactly watertight.
+        */
+        static bool intersect(const Triangle& tri, const TraversalRay& ray, float& t, float2& barycentrics)
+        {
+            const float3 p = cross(ray.dir, tri.e2);
+            const float det = dot(tri.e1, p);
+            if (det == 0.f) return false;
+            const float invDet = 1.f / det;
+
+            const float3 s = ray.origin - tri.v0;
+            const float u = dot(s, p) * invDet;
+            if (u < 0.f || u > 1.f) return false;
+
+            const float3 q = cross(s, tri.e1);
+            const float v = dot(ray.dir, q) * invDet;
+            if (v < 0.f || u + v > 1.f) return false;
+
+            t = dot(tri.e2, q) * invDet;
+            if (!(t >= ray.tMin && t <= ray.tMax)) return false;
+
+            barycentrics = float2(u, v);
+            return true;
+        }
+
+        uint64_t getMemoryUsageInBytes() const
+        {
+            return bvh.nodes.size() * sizeof(BVH::Node) + triangles.size() * sizeof(Triangle);
+        }
+    };
+
+    CPUSceneRayQuery::CPUSceneRayQuery() = default;
+    CPUSceneRayQuery::~CPUSceneRayQuery() = default;
+
+    ref<CPUSceneRayQuery> CPUSceneRayQuery::create(const Scene& scene)
+    {
+        const auto& vertexData = scene.getMeshStaticData();
+        const auto& indexData = scene.getMeshIndexData();
+        FALCOR_CHECK(vertexData.hasCpuData() && (indexData.hasCpuData() || indexData.empty()), "Scene does not have CPU-side geometry data.");
+
+        // Gather the vertex positions and indices of all meshes.
+        const uint32_t meshCount = scene.getMeshCount();
+        std::vector<std::vector<float3>> positions(meshCount);
+        std::vector<std::vector<uint32_t>> indices(meshCount);
+        std::vector<MeshData> meshes(meshCount);
+
+        auto meshRange = NumericRange<uint32_t>(0, meshCount);
+        std::for_each(std::execution::par, meshRange.begin(), meshRange.end(), [&](uint32_t meshID)
+        {
+            const MeshDesc& mesh = scene.getMesh(MeshID{ meshID });
+            if (mesh.vertexCount == 0) return;
+
+            positions[meshID].resize(mesh.vertexCount);
+            const PackedStaticVertexData* pVertices = &vertexData[mesh.vbOffset];
+            for (uint32_t i = 0; i < mesh.vertexCount; i++) positions[meshID][i] = pVertices[i].position;
+
+            if (mesh.indexCount > 0)
+            {
+                indices[meshID].resize(mesh.indexCount);
+                const uint32_t* pIndices = &indexData[mesh.ibOffset];
+                for (uint32_t i = 0; i < mesh.indexCount; i++)
+                {
+                    indices[meshID][i] = mesh.use16BitIndices() ? reinterpret_cast<const uint16_t*>(pIndices)[i] : pIndices[i];
+                }
+            }
+
+            meshes[meshID] = { positions[meshID], indices[meshID] };
+        });
+
+        // Create instances for all triangle mesh geometry instances.
+        std::vector<InstanceData> instances;
+        const auto& globalMatrices = scene.getAnimationController()->getGlobalMatrices();
+        uint32_t skippedCount = 0;
+        for (uint32_t instanceID = 0; instanceID < scene.getGeometryInstanceCount(); instanceID++)
+        {
+            const GeometryInstanceData& instance = scene.getGeometryInstance(instanceID);
+            if (instance.getType() != GeometryType::TriangleMesh)
+            {
+                skippedCount++;
+                continue;
+            }
+            instances.push_back({ instance.geometryID, instanceID, globalMatrices[instance.globalMatrixID] });
+        }
+        if (skippedCount > 0) logWarning("CPUSceneRayQuery only supports triangle meshes. Ignoring {} geometry instances of other types.", skippedCount);
+
+        return create(meshes, instances);
+    }
+
+    ref<CPUSceneRayQuery> CPUSceneRayQuery::create(fstd::span<const MeshData> meshes, fstd::span<const InstanceData> instances)
+    {
+        ref<CPUSceneRayQuery> pRayQuery(new CPUSceneRayQuery());
+        pRayQuery->build(meshes, instances);
+        return pRayQuery;
+    }
+
+    void CPUSceneRayQuery::build(fstd::span<const MeshData> meshes, fstd::span<const InstanceData> instances)
+    {
+        auto startTime = CpuTimer::getCurrentTimePoint();
+
+        // Validate the input before the parallel build, as exceptions cannot be propagated out of parallel algorithms.
+        for (size_t i = 0; i < meshes.size(); i++)
+        {
+            const auto maxIndex = std::max_element(meshes[i].indices.begin(), meshes[i].indices.end());
+            FALCOR_CHECK(maxIndex == meshes[i].indices.end() || *maxIndex < meshes[i].positions.size(), "Mesh {} has out of bounds vertex index {}.", i, *maxIndex);
+        }
+        for (const InstanceData& instance : instances)
+        {
+            FALCOR_CHECK(instance.meshIndex < meshes.size(), "Instance references invalid mesh {}.", instance.meshIndex);
+        }
+
+        // Build the BLASes in parallel. Each build is parallelized internally for large meshes.
+        mBlas.clear();
+        mBlas.resize(meshes.size());
+        auto meshRange = NumericRange<size_t>(0, meshes.size());
+        std::for_each(std::execution::par, meshRange.begin(), meshRange.end(), [&](size_t i)
+        {
+            mBlas[i].build(meshes[i]);
+        });
+
+        // Build the TLAS over the world-space bounds of the instances.
+        std::vector<AABB> instanceBounds(instances.size());
+        for (size_t i = 0; i < instances.size(); i++)
+        {
+            instanceBounds[i] = mBlas[instances[i].meshIndex].bvh.bounds.transform(instances[i].transform);
+        }
+        mpTlas = std::make_unique<BVH>();
+        mpTlas->build(instanceBounds);
+        mBounds = mpTlas->bounds;
+
+        // Store the instances in leaf order.
+        mInstances.resize(mpTlas->primIndices.size());
+        mWorldToObject.resize(mpTlas->primIndices.size());
+        for (size_t i = 0; i < mInstances.size(); i++)
+        {
+            mInstances[i] = instances[mpTlas->primIndices[i]];
+            mWorldToObject[i] = inverse(mInstances[i].transform);
+        }
+
+        mStats = {};
+        mStats.meshCount = (uint32_t)meshes.size();
+        mStats.instanceCount = (uint32_t)mInstances.size();
+        mStats.nodeCount = mpTlas->nodes.size();
+        mStats.memoryInBytes = mpTlas->nodes.size() * sizeof(BVH::Node) + mInstances.size() * (sizeof(InstanceData) + sizeof(float4x4));
+        for (const BLAS& blas : mBlas)
+        {
+            mStats.triangleCount += blas.triangles.size();
+            mStats.nodeCount += blas.bvh.nodes.size();
+            mStats.memoryInBytes += blas.getMemoryUsageInBytes();
+        }
+        mStats.buildTimeInMs = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+    }
+
+    template<bool TAnyHit>
+    bool CPUSceneRayQuery::traceRay(const Ray& ray, Hit* pHit) const
+    {
+        if (!mpTlas) return false;
+
+        TraversalRay worldRay(ray.origin, ray.dir, ray.tMin, ray.tMax);
+        bool hit = false;
+
+        mpTlas->traverse<!TAnyHit>(worldRay, [&](uint32_t begin, uint32_t end, TraversalRay& tlasRay)
+        {
+            for (uint32_t i = begin; i < end; i++)
+            {
+                // Transform the ray to object space. The direction is not normalized so that hit distances are preserved.
+                const float4x4& worldToObject = mWorldToObject[i];
+                TraversalRay objectRay(transformPoint(worldToObject, tlasRay.origin), transformVector(worldToObject, tlasRay.dir), tlasRay.tMin, tlasRay.tMax);
+
+                const BLAS& blas = mBlas[mInstances[i].meshIndex];
+                bool terminated = blas.bvh.traverse<!TAnyHit>(objectRay, [&](uint32_t triBegin, uint32_t triEnd, TraversalRay& blasRay)
+                {
+                    for (uint32_t j = triBegin; j < triEnd; j++)
+                    {
+                        const BLAS::Triangle& tri = blas.triangles[j];
+                        float t;
+                        float2 barycentrics;
+                        if (!BLAS::intersect(tri, blasRay, t, barycentrics)) continue;
+
+                        hit = true;
+                        if constexpr (TAnyHit) return true;
+
+                        blasRay.tMax = t;
+                        pHit->type = HitType::Triangle;
+                        pHit->instanceID = mInstances[i].instanceID;
+                        pHit->primitiveIndex = tri.primitiveIndex;
+                        pHit->barycentrics = barycentrics;
+                        pHit->t = t;
+                    }
+                    return false;
+                });
+                if (terminated) return true;
+
+                tlasRay.tMax = objectRay.tMax;
+            }
+            return false;
+        });
+
+        return hit;
+    }
+
+    CPUSceneRayQuery::Hit CPUSceneRayQuery::closestHit(const Ray& ray) const
+    {
+        Hit hit;
+        traceRay<false>(ray, &hit);
+        return hit;
+    }
+
+    bool CPUSceneRayQuery::anyHit(const Ray& ray) const
+    {
+        return traceRay<true>(ray, nullptr);
+    }
+
+    void CPUSceneRayQuery::closestHit(fstd::span<const Ray> rays, fstd::span<Hit> hits) const
+    {
+        FALCOR_CHECK(rays.size() == hits.size(), "Number of rays ({}) and hits ({}) do not match.", rays.size(), hits.size());
+
+        auto range = NumericRange<size_t>(0, div_round_up(rays.size(), (size_t)kRaysPerTask));
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](size_t task)
+        {
+            const size_t end = std::min(rays.size(), (task + 1) * kRaysPerTask);
+            for (size_t i = task * kRaysPerTask; i < end; i++) hits[i] = closestHit(rays[i]);
+        });
+    }
+
+    void CPUSceneRayQuery::anyHit(fstd::span<const Ray> rays, fstd::span<uint8_t> hits) const
+    {
+        FALCOR_CHECK(rays.size() == hits.size(), "Number of rays ({}) and hits ({}) do not match.", rays.size(), hits.size());
+
+        auto range = NumericRange<size_t>(0, div_round_up(rays.size(), (size_t)kRaysPerTask));
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](size_t task)
+        {
+            const size_t end = std::min(rays.size(), (task + 1) * kRaysPerTask);
+            for (size_t i = task * kRaysPerTask; i < end; i++) hits[i] = anyHit(rays[i]) ? 1 : 0;
+        });
+    }
+
+    FALCOR_SCRIPT_BINDING(CPUSceneRayQuery)
+    {
+        using namespace pybind11::literals;
+
+        FALCOR_SCRIPT_BINDING_DEPENDENCY(Scene)
+        FALCOR_SCRIPT_BINDING_DEPENDENCY(AABB)
+
+        using RayArray = pybind11::ndarray<float, pybind11::shape<pybind11::any, 3>, pybind11::c_contig, pybind11::device::cpu>;
+
+        // Create the rays for a batch query from arrays of origins and directions.
+        auto createRays = [](const RayArray& origins, const RayArray& directions, float tMin, float tMax)
+        {
+            FALCOR_CHECK(origins.shape(0) == directions.shape(0), "Number of ray origins ({}) and directions ({}) do not match.", origins.shape(0), directions.shape(0));
+            std::vector<Ray> rays(origins.shape(0));
+            const float3* pOrigins = reinterpret_cast<const float3*>(origins.data());
+            const float3* pDirections = reinterpret_cast<const float3*>(directions.data());
+            for (size_t i = 0; i < rays.size(); i++) rays[i] = Ray(pOrigins[i], pDirections[i], tMin, tMax);
+            return rays;
+        };
+
+        // Create a numpy array owning its data.
+        auto createArray = [](auto* pData, size_t count, size_t channelCount)
+        {
+            using T = std::remove_pointer_t<decltype(pData)>;
+            pybind11::capsule owner(pData, [](void* p) noexcept { delete[] reinterpret_cast<T*>(p); });
+            size_t shape[2] = { count, channelCount };
+            return pybind11::ndarray<pybind11::numpy>(pData, channelCount > 1 ? 2 : 1, shape, owner, nullptr, pybind11::dtype<T>(), pybind11::device::cpu::value);
+        };
+
+        pybind11::class_<CPUSceneRayQuery, ref<CPUSceneRayQuery>> rayQuery(m, "CPUSceneRayQuery");
+        rayQuery.def(pybind11::init([](const ref<Scene>& pScene) { return CPUSceneRayQuery::create(*pScene); }), "scene"_a);
+        rayQuery.def_property_readonly("bounds", &CPUSceneRayQuery::getBounds, pybind11::return_value_policy::copy);
+        rayQuery.def_property_readonly("stats", [](const CPUSceneRayQuery& self)
+        {
+            const auto& stats = self.getStats();
+            pybind11::dict d;
+            d["mesh_count"] = stats.meshCount;
+            d["instance_count"] = stats.instanceCount;
+            d["triangle_count"] = stats.triangleCount;
+            d["node_count"] = stats.nodeCount;
+            d["memory_in_bytes"] = stats.memoryInBytes;
+            d["build_time_in_ms"] = stats.buildTimeInMs;
+            return d;
+        });
+
+        // Batch queries take arrays of shape [N, 3] and return a dict of arrays.
+        rayQuery.def("closest_hit", [=](const CPUSceneRayQuery& self, const RayArray& origins, const RayArray& directions, float tMin, float tMax)
+        {
+            std::vector<Ray> rays = createRays(origins, directions, tMin, tMax);
+            std::vector<CPUSceneRayQuery::Hit> hits(rays.size());
+            {
+                pybind11::gil_scoped_release release;
+                self.closestHit(rays, hits);
+            }
+
+            const size_t count = hits.size();
+            uint8_t* pHit = new uint8_t[count];
+            float* pT = new float[count];
+            uint32_t* pInstanceID = new uint32_t[count];
+            uint32_t* pPrimitiveIndex = new uint32_t[count];
+            float* pBarycentrics = new float[count * 2];
+            for (size_t i = 0; i < count; i++)
+            {
+                pHit[i] = hits[i].isValid() ? 1 : 0;
+                pT[i] = hits[i].isValid() ? hits[i].t : std::numeric_limits<float>::infinity();
+                pInstanceID[i] = hits[i].instanceID;
+                pPrimitiveIndex[i] = hits[i].primitiveIndex;
+                pBarycentrics[2 * i + 0] = hits[i].barycentrics.x;
+                pBarycentrics[2 * i + 1] = hits[i].barycentrics.y;
+            }
+
+            pybind11::dict d;
+            d["hit"] = createArray(pHit, count, 1);
+            d["t"] = createArray(pT, count, 1);
+            d["instance_id"] = createArray(pInstanceID, count, 1);
+            d["primitive_index"] = createArray(pPrimitiveIndex, count, 1);
+            d["barycentrics"] = createArray(pBarycentrics, count, 2);
+            return d;
+        }, "origins"_a, "directions"_a, "t_min"_a = 0.f, "t_max"_a = std::numeric_limits<float>::max());
+
+        rayQuery.def("any_hit", [=](const CPUSceneRayQuery& self, const RayArray& origins, const RayArray& directions, float tMin, float tMax)
+        {
+            std::vector<Ray> rays = createRays(origins, directions, tMin, tMax);
+            uint8_t* pHit = new uint8_t[rays.size()];
+            {
+                pybind11::gil_scoped_release release;
+                self.anyHit(rays, fstd::span<uint8_t>(pHit, rays.size()));
+            }
+            return createArray(pHit, rays.size(), 1);
+        }, "origins"_a, "directions"_a, "t_min"_a = 0.f, "t_max"_a = std::numeric_limits<float>::max());
+    }
+}
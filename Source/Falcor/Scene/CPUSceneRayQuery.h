@@ -0,0 +1,171 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "HitInfoType.slang"
+#include "Core/Macros.h"
+#include "Core/Object.h"
+#include "Utils/Math/AABB.h"
+#include "Utils/Math/Matrix.h"
+#include "Utils/Math/Ray.h"
+#include "Utils/Math/Vector.h"
+#include <fstd/span.h>
+#include <memory>
+#include <vector>
+
+namespace Falcor
+{
+    class Scene;
+
+    /** Ray queries against the triangle geometry of a scene on the CPU.
+
+        This is useful for picking, visibility precomputation and validation without using the GPU.
+        The geometry is stored in a two-level BVH, mirroring the TLAS/BLAS structure used on the GPU:
+        each mesh has a 4-wide SAH BVH over its triangles in object space, and a top-level BVH
+        references the mesh instances with their transforms.
+        The BVHs are built in parallel and the ray-box tests of the four children of a node are done using SIMD.
+
+        Hits are reported in the same form as TriangleHit (see HitInfo.slang), so results can be compared
+        directly with hits produced on the GPU.
+
+        Limitations:
+        - Only triangle meshes are supported. Curves, SDF grids and custom primitives are ignored.
+        - All geometry is treated as opaque, i.e., alpha testing is not supported.
+        - Dynamic meshes are included in their initial pose.
+    */
+    class FALCOR_API CPUSceneRayQuery : public Object
+    {
+        FALCOR_OBJECT(CPUSceneRayQuery)
+    public:
+        /** Triangle mesh geometry in object space.
+        */
+        struct MeshData
+        {
+            fstd::span<const float3> positions;     ///< Vertex positions.
+            fstd::span<const uint32_t> indices;     ///< Triangle vertex indices, or empty if the mesh is non-indexed.
+        };
+
+        /** Instance of a mesh.
+        */
+        struct InstanceData
+        {
+            uint32_t meshIndex = 0;                 ///< Index of the mesh.
+            uint32_t instanceID = 0;                ///< Instance ID reported in hits, i.e., the geometry instance ID for scenes.
+            float4x4 transform = float4x4::identity(); ///< Object-to-world transform.
+        };
+
+        /** Result of a ray query. The fields match TriangleHit in HitInfo.slang.
+        */
+        struct Hit
+        {
+            HitType type = HitType::None;           ///< Hit type. HitType::None if no hit was found.
+            uint32_t instanceID = 0;                ///< Instance ID.
+            uint32_t primitiveIndex = 0;            ///< Triangle index in the mesh.
+            float2 barycentrics = float2(0.f);      ///< Barycentric coordinates of the hit point (weights of vertex 1 and 2).
+            float t = 0.f;                          ///< Hit distance along the ray.
+
+            bool isValid() const { return type != HitType::None; }
+        };
+
+        struct Stats
+        {
+            uint32_t meshCount = 0;                 ///< Number of meshes.
+            uint32_t instanceCount = 0;             ///< Number of instances.
+            uint64_t triangleCount = 0;             ///< Number of unique triangles.
+            uint64_t nodeCount = 0;                 ///< Total number of BVH nodes.
+            uint64_t memoryInBytes = 0;             ///< Total memory used by the BVHs.
+            double buildTimeInMs = 0.0;             ///< Build time in milliseconds.
+        };
+
+        /** Create the acceleration structure for the triangle meshes in a scene.
+            The scene must have CPU-side geometry data, which is the case for all scenes created by the SceneBuilder.
+            \param[in] scene The scene.
+            \return The acceleration structure.
+        */
+        static ref<CPUSceneRayQuery> create(const Scene& scene);
+
+        /** Create the acceleration structure for a set of mesh instances.
+            The mesh data is only accessed during creation.
+            \param[in] meshes List of meshes.
+            \param[in] instances List of instances.
+            \return The acceleration structure.
+        */
+        static ref<CPUSceneRayQuery> create(fstd::span<const MeshData> meshes, fstd::span<const InstanceData> instances);
+
+        ~CPUSceneRayQuery();
+
+        /** Find the closest hit along a ray in the range [tMin, tMax].
+            \param[in] ray The ray. The direction does not need to be normalized.
+            \return The closest hit, or a hit of type HitType::None if the ray missed.
+        */
+        Hit closestHit(const Ray& ray) const;
+
+        /** Test if there is any hit along a ray in the range [tMin, tMax].
+            \param[in] ray The ray. The direction does not need to be normalized.
+            \return True if the ray hit anything.
+        */
+        bool anyHit(const Ray& ray) const;
+
+        /** Find the closest hits for a batch of rays.
+            The rays are processed in parallel.
+            \param[in] rays List of rays.
+            \param[out] hits List of hits. Must be of the same size as the list of rays.
+        */
+        void closestHit(fstd::span<const Ray> rays, fstd::span<Hit> hits) const;
+
+        /** Test a batch of rays for any hit.
+            The rays are processed in parallel.
+            \param[in] rays List of rays.
+            \param[out] hits List of results, set to 1 if the ray hit anything and 0 otherwise. Must be of the same size as the list of rays.
+        */
+        void anyHit(fstd::span<const Ray> rays, fstd::span<uint8_t> hits) const;
+
+        /** Get the world-space bounds of all geometry.
+        */
+        const AABB& getBounds() const { return mBounds; }
+
+        const Stats& getStats() const { return mStats; }
+
+    private:
+        struct BVH;
+        struct BLAS;
+
+        CPUSceneRayQuery();
+
+        void build(fstd::span<const MeshData> meshes, fstd::span<const InstanceData> instances);
+
+        template<bool TAnyHit>
+        bool traceRay(const Ray& ray, Hit* pHit) const;
+
+        std::vector<BLAS> mBlas;                    ///< Bottom-level BVHs, one per mesh.
+        std::unique_ptr<BVH> mpTlas;                ///< Top-level BVH over the instances.
+        std::vector<InstanceData> mInstances;       ///< Instances in TLAS leaf order.
+        std::vector<float4x4> mWorldToObject;       ///< World-to-object transforms of the instances in TLAS leaf order.
+        AABB mBounds;
+        Stats mStats;
+    };
+}
@@ -32,7 +32,12 @@
 #include "Utils/Math/CubicSpline.h"
 #include "Utils/Math/Matrix.h"
 #include "Utils/Math/Quaternion.h"
+#include "Utils/NumericRange.h"
+#include <algorithm>
 #include <cmath>
+#include <execution>
+#include <limits>
+#include <numeric>
 
 namespace Falcor
 {
@@ -98,7 +103,7 @@ namespace Falcor
             return std::max(w, (float)std::numeric_limits<float16_t>::min());
         }
 
-        void optimizeStrandGeometry(CubicSplineCache& splineCache, const CurveArrays& curveArrays, StrandArrays& strandArrays, StrandArrays& optimizedStrandArrays, uint32_t pointOffset, uint32_t subdivPerSegment, uint32_t keepOneEveryXVerticesPerStrand, float widthScale)
+        void removeDuplicateControlPoints(const CurveArrays& curveArrays, StrandArrays& strandArrays, uint32_t pointOffset)
         {
             strandArrays.controlPoints.clear();
             strandArrays.UVs.clear();
@@ -119,6 +124,11 @@ namespace Falcor
             strandArrays.controlPoints.push_back(curveArrays.controlPoints[pointOffset + strandArrays.vertexCount - 1]);
             strandArrays.widths.push_back(curveArrays.widths[pointOffset + strandArrays.vertexCount - 1]);
             if (curveArrays.UVs) strandArrays.UVs.push_back(curveArrays.UVs[pointOffset + strandArrays.vertexCount - 1]);
+        }
+
+        void optimizeStrandGeometry(CubicSplineCache& splineCache, const CurveArrays& curveArrays, StrandArrays& strandArrays, StrandArrays& optimizedStrandArrays, uint32_t pointOffset, uint32_t subdivPerSegment, uint32_t keepOneEveryXVerticesPerStrand, float widthScale)
+        {
+            removeDuplicateControlPoints(curveArrays, strandArrays, pointOffset);
 
             optimizedStrandArrays.vertexCount = static_cast<uint32_t>(strandArrays.controlPoints.size());
 
@@ -203,7 +213,7 @@ namespace Falcor
             FALCOR_ASSERT_LT(std::abs(length(t) - 1.f), 1e-3f);
         }
 
-        void updateMeshResultBuffers(CurveTessellation::MeshResult& result, const CurveArrays& curveArrays, StrandArrays& optimizedStrandArrays, const float3& fwd, const float3& s, const float3& t, uint32_t pointCountPerCrossSection, uint32_t j)
+        void updateMeshResultBuffers(CurveTessellation::MeshResult& result, const CurveArrays& curveArrays, StrandArrays& optimizedStrandArrays, const float3& fwd, const float3& s, const float3& t, uint32_t pointCountPerCrossSection, uint32_t meshVertexOffset, uint32_t j)
         {
             // Mesh vertices, normals, tangents, and texCrds (if any).
             for (uint32_t k = 0; k < pointCountPerCrossSection; k++)
@@ -211,37 +221,153 @@ namespace Falcor
                 float phi = (float)k / (float)pointCountPerCrossSection * (float)M_PI * 2.f;
                 float3 vNormal = std::cos(phi) * s + std::sin(phi) * t;
 
+                const uint32_t vertexIndex = meshVertexOffset + j * pointCountPerCrossSection + k;
                 float curveRadius = 0.5f * optimizedStrandArrays.widths[j];
-                result.vertices.push_back(optimizedStrandArrays.controlPoints[j] + curveRadius * vNormal);
-                result.normals.push_back(vNormal);
-                result.tangents.push_back(float4(fwd.x, fwd.y, fwd.z, 1));
-                result.radii.push_back(curveRadius);
+                result.vertices[vertexIndex] = optimizedStrandArrays.controlPoints[j] + curveRadius * vNormal;
+                result.normals[vertexIndex] = vNormal;
+                result.tangents[vertexIndex] = float4(fwd.x, fwd.y, fwd.z, 1);
+                result.radii[vertexIndex] = curveRadius;
 
                 if (curveArrays.UVs)
                 {
-                    result.texCrds.push_back(optimizedStrandArrays.UVs[j]);
+                    result.texCrds[vertexIndex] = optimizedStrandArrays.UVs[j];
                 }
             }
         }
 
-        void connectFaceVertices(CurveTessellation::MeshResult& result, uint32_t meshVertexOffset, uint32_t pointCountPerCrossSection, uint32_t quadCountLimit, uint32_t nextCrossSectionVertexOffset, uint32_t multiplier, uint32_t j)
+        void connectFaceVertices(CurveTessellation::MeshResult& result, uint32_t faceOffset, uint32_t meshVertexOffset, uint32_t pointCountPerCrossSection, uint32_t quadCountLimit, uint32_t nextCrossSectionVertexOffset, uint32_t multiplier, uint32_t j)
         {
             for (uint32_t k = 0; k < quadCountLimit; k++)
             {
-                result.faceVertexCounts.push_back(3);
-                result.faceVertexIndices.push_back(meshVertexOffset + multiplier * j * pointCountPerCrossSection + k);
-                result.faceVertexIndices.push_back(meshVertexOffset + multiplier * j * pointCountPerCrossSection + (k + nextCrossSectionVertexOffset) % pointCountPerCrossSection);
-                result.faceVertexIndices.push_back(meshVertexOffset + (multiplier * j + 1) * pointCountPerCrossSection + (k + nextCrossSectionVertexOffset) % pointCountPerCrossSection);
-
-                result.faceVertexCounts.push_back(3);
-                result.faceVertexIndices.push_back(meshVertexOffset + multiplier * j * pointCountPerCrossSection + k);
-                result.faceVertexIndices.push_back(meshVertexOffset + (multiplier * j + 1) * pointCountPerCrossSection + (k + nextCrossSectionVertexOffset) % pointCountPerCrossSection);
-                result.faceVertexIndices.push_back(meshVertexOffset + (multiplier * j + 1) * pointCountPerCrossSection + k);
+                const uint32_t faceIndex = faceOffset + 2 * k;
+                uint32_t* pIndices = result.faceVertexIndices.data() + 3 * faceIndex;
+
+                result.faceVertexCounts[faceIndex] = 3;
+                pIndices[0] = meshVertexOffset + multiplier * j * pointCountPerCrossSection + k;
+                pIndices[1] = meshVertexOffset + multiplier * j * pointCountPerCrossSection + (k + nextCrossSectionVertexOffset) % pointCountPerCrossSection;
+                pIndices[2] = meshVertexOffset + (multiplier * j + 1) * pointCountPerCrossSection + (k + nextCrossSectionVertexOffset) % pointCountPerCrossSection;
+
+                result.faceVertexCounts[faceIndex + 1] = 3;
+                pIndices[3] = meshVertexOffset + multiplier * j * pointCountPerCrossSection + k;
+                pIndices[4] = meshVertexOffset + (multiplier * j + 1) * pointCountPerCrossSection + (k + nextCrossSectionVertexOffset) % pointCountPerCrossSection;
+                pIndices[5] = meshVertexOffset + (multiplier * j + 1) * pointCountPerCrossSection + k;
+            }
+        }
+
+        /** Layout of the output points of the kept strands.
+            This is computed in a first pass, so that the strands can be tessellated in parallel into preallocated arrays.
+        */
+        struct StrandLayout
+        {
+            uint32_t strandCount = 0;               ///< Number of kept strands.
+            uint32_t maxVertexCount = 0;            ///< Max number of control points of a kept strand.
+            std::vector<uint32_t> inputOffsets;     ///< Offset of the first control point of each kept strand in the input arrays.
+            std::vector<uint32_t> outputOffsets;    ///< Offset of the first output point of each kept strand. The last entry is the total point count.
+
+            uint32_t getPointCount() const { return outputOffsets.back(); }
+            uint32_t getSegmentCount() const { return outputOffsets.back() - strandCount; }
+
+            /// Offset of the first segment of a kept strand. Each strand has one segment less than it has points.
+            uint32_t getSegmentOffset(uint32_t strand) const { return outputOffsets[strand] - strand; }
+        };
+
+        StrandLayout computeStrandLayout(const CurveTessellation::StrandData& strands, uint32_t subdivPerSegment, uint32_t keepOneEveryXStrands, uint32_t keepOneEveryXVerticesPerStrand)
+        {
+            FALCOR_CHECK(subdivPerSegment > 0, "'subdivPerSegment' must be positive.");
+            FALCOR_CHECK(keepOneEveryXStrands > 0, "'keepOneEveryXStrands' must be positive.");
+            FALCOR_CHECK(keepOneEveryXVerticesPerStrand > 0, "'keepOneEveryXVerticesPerStrand' must be positive.");
+
+            const uint32_t strandCount = (uint32_t)strands.vertexCountsPerStrand.size();
+
+            StrandLayout layout;
+            layout.strandCount = div_round_up(strandCount, keepOneEveryXStrands);
+            layout.inputOffsets.resize(layout.strandCount);
+            layout.outputOffsets.resize(layout.strandCount + 1, 0);
+
+            // The input offsets include the control points of skipped strands.
+            uint64_t inputOffset = 0;
+            for (uint32_t i = 0; i < strandCount; i++)
+            {
+                if (i % keepOneEveryXStrands == 0)
+                {
+                    layout.inputOffsets[i / keepOneEveryXStrands] = (uint32_t)inputOffset;
+                    layout.maxVertexCount = std::max(layout.maxVertexCount, strands.vertexCountsPerStrand[i]);
+                }
+                inputOffset += strands.vertexCountsPerStrand[i];
             }
+
+            FALCOR_CHECK(inputOffset <= std::numeric_limits<uint32_t>::max(), "Too many curve control points.");
+            FALCOR_CHECK(inputOffset <= strands.controlPoints.size(), "Not enough control points for the given strand vertex counts.");
+            FALCOR_CHECK(inputOffset <= strands.widths.size(), "Not enough widths for the given strand vertex counts.");
+            FALCOR_CHECK(strands.UVs.empty() || inputOffset <= strands.UVs.size(), "Not enough texture coordinates for the given strand vertex counts.");
+
+            // Count the output points of each strand. Consecutive duplicate control points are removed before subdivision.
+            auto range = NumericRange<uint32_t>(0, layout.strandCount);
+            std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t strand)
+            {
+                const uint32_t vertexCount = strands.vertexCountsPerStrand[strand * keepOneEveryXStrands];
+                const float3* pControlPoints = strands.controlPoints.data() + layout.inputOffsets[strand];
+                uint32_t uniqueVertexCount = 1;
+                for (uint32_t j = 0; j + 1 < vertexCount; j++)
+                {
+                    if (any(pControlPoints[j] != pControlPoints[j + 1])) uniqueVertexCount++;
+                }
+                layout.outputOffsets[strand + 1] = div_round_up(subdivPerSegment * (uniqueVertexCount - 1), keepOneEveryXVerticesPerStrand) + 1;
+            });
+
+            // Exclusive scan of the point counts.
+            std::partial_sum(layout.outputOffsets.begin(), layout.outputOffsets.end(), layout.outputOffsets.begin());
+
+            return layout;
+        }
+
+        /** Call a function for all kept strands in parallel.
+            The strands are split into batches, which are processed in parallel. The function is called with
+            the index of the kept strand and scratch data that is reused for all strands in a batch.
+        */
+        template<typename Func>
+        void forEachStrand(const StrandLayout& layout, Func func)
+        {
+            const uint32_t kStrandsPerBatch = 256;
+
+            auto range = NumericRange<uint32_t>(0, div_round_up(layout.strandCount, kStrandsPerBatch));
+            std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t batch)
+            {
+                StrandArrays strandArrays;
+                strandArrays.controlPoints.reserve(layout.maxVertexCount);
+                strandArrays.widths.reserve(layout.maxVertexCount);
+                strandArrays.UVs.reserve(layout.maxVertexCount);
+                StrandArrays optimizedStrandArrays;
+                CubicSplineCache splineCache;
+
+                const uint32_t strandEnd = std::min(layout.strandCount, (batch + 1) * kStrandsPerBatch);
+                for (uint32_t strand = batch * kStrandsPerBatch; strand < strandEnd; strand++)
+                {
+                    func(strand, strandArrays, optimizedStrandArrays, splineCache);
+                }
+            });
+        }
+
+        CurveTessellation::StrandData getStrandData(uint32_t strandCount, const uint32_t* vertexCountsPerStrand, const float3* controlPoints, const float* widths, const float2* UVs)
+        {
+            size_t vertexCount = 0;
+            for (uint32_t i = 0; i < strandCount; i++) vertexCount += vertexCountsPerStrand[i];
+
+            CurveTessellation::StrandData strands;
+            strands.vertexCountsPerStrand = fstd::span<const uint32_t>(vertexCountsPerStrand, strandCount);
+            strands.controlPoints = fstd::span<const float3>(controlPoints, vertexCount);
+            strands.widths = fstd::span<const float>(widths, vertexCount);
+            if (UVs) strands.UVs = fstd::span<const float2>(UVs, vertexCount);
+            return strands;
         }
     }
 
     CurveTessellation::SweptSphereResult CurveTessellation::convertToLinearSweptSphere(uint32_t strandCount, const uint32_t* vertexCountsPerStrand, const float3* controlPoints, const float* widths, const float2* UVs, uint32_t degree, uint32_t subdivPerSegment, uint32_t keepOneEveryXStrands, uint32_t keepOneEveryXVerticesPerStrand, float widthScale, const float4x4& xform)
+    {
+        return convertToLinearSweptSphere(getStrandData(strandCount, vertexCountsPerStrand, controlPoints, widths, UVs), degree, subdivPerSegment, keepOneEveryXStrands, keepOneEveryXVerticesPerStrand, widthScale, xform);
+    }
+
+    CurveTessellation::SweptSphereResult CurveTessellation::convertToLinearSweptSphere(const StrandData& strands, uint32_t degree, uint32_t subdivPerSegment, uint32_t keepOneEveryXStrands, uint32_t keepOneEveryXVerticesPerStrand, float widthScale, const float4x4& xform)
     {
         SweptSphereResult result;
 
@@ -250,44 +376,26 @@ namespace Falcor
         FALCOR_ASSERT(degree == 1);
         result.degree = degree;
 
-        uint32_t pointCounts = 0;
-        uint32_t segCounts = 0;
-        uint32_t maxVertexCountsPerStrand = 0;
-        for (uint32_t i = 0; i < strandCount; i += keepOneEveryXStrands)
-        {
-            uint32_t tmpPointCount = div_round_up(subdivPerSegment * (vertexCountsPerStrand[i] - 1), keepOneEveryXVerticesPerStrand) + 1;
-            pointCounts += tmpPointCount;
-            segCounts += tmpPointCount - 1;
-            maxVertexCountsPerStrand = std::max(maxVertexCountsPerStrand, vertexCountsPerStrand[i]);
-        }
-        result.indices.reserve(segCounts);
-        result.points.reserve(pointCounts);
-        result.radius.reserve(pointCounts);
-        result.texCrds.reserve(pointCounts);
-
-        uint32_t pointOffset = 0;
-
-        StrandArrays strandArrays;
-        strandArrays.controlPoints.reserve(maxVertexCountsPerStrand);
-        strandArrays.widths.reserve(maxVertexCountsPerStrand);
-        strandArrays.UVs.reserve(maxVertexCountsPerStrand);
-        CurveArrays curveArrays(controlPoints, widths, UVs);
-
-        StrandArrays optimizedStrandArrays;
-        CubicSplineCache splineCache;
-        for (uint32_t i = 0; i < strandCount; i += keepOneEveryXStrands)
-        {
-            optimizedStrandArrays.controlPoints.clear();
-            optimizedStrandArrays.UVs.clear();
-            optimizedStrandArrays.widths.clear();
-            optimizedStrandArrays.vertexCount = 0;
-            strandArrays.vertexCount = vertexCountsPerStrand[i];
+        const StrandLayout layout = computeStrandLayout(strands, subdivPerSegment, keepOneEveryXStrands, keepOneEveryXVerticesPerStrand);
+        result.indices.resize(layout.getSegmentCount());
+        result.points.resize(layout.getPointCount());
+        result.radius.resize(layout.getPointCount());
+        if (!strands.UVs.empty()) result.texCrds.resize(layout.getPointCount());
 
-            optimizeStrandGeometry(splineCache, curveArrays, strandArrays, optimizedStrandArrays, pointOffset, subdivPerSegment, keepOneEveryXVerticesPerStrand, widthScale);
+        CurveArrays curveArrays(strands.controlPoints.data(), strands.widths.data(), strands.UVs.empty() ? nullptr : strands.UVs.data());
+
+        forEachStrand(layout, [&](uint32_t strand, StrandArrays& strandArrays, StrandArrays& optimizedStrandArrays, CubicSplineCache& splineCache)
+        {
+            // Only the control points without duplicates are needed, the subdivision is done below.
+            strandArrays.vertexCount = strands.vertexCountsPerStrand[strand * keepOneEveryXStrands];
+            removeDuplicateControlPoints(curveArrays, strandArrays, layout.inputOffsets[strand]);
+            optimizedStrandArrays.vertexCount = static_cast<uint32_t>(strandArrays.controlPoints.size());
 
             const CubicSpline<float3>& splinePoints = splineCache.splinePoints.setup(strandArrays.controlPoints.data(), optimizedStrandArrays.vertexCount);
             const CubicSpline<float>& splineWidths = splineCache.splineWidths.setup(strandArrays.widths.data(), optimizedStrandArrays.vertexCount);
 
+            uint32_t pointIndex = layout.outputOffsets[strand];
+            uint32_t segmentIndex = layout.getSegmentOffset(strand);
             uint32_t tmpCount = 0;
             for (uint32_t j = 0; j < optimizedStrandArrays.vertexCount - 1; j++)
             {
@@ -296,13 +404,14 @@ namespace Falcor
                     if (tmpCount % keepOneEveryXVerticesPerStrand == 0)
                     {
                         float t = (float)k / (float)subdivPerSegment;
-                        result.indices.push_back((uint32_t)result.points.size());
+                        result.indices[segmentIndex++] = pointIndex;
 
                         // Pre-transform curve points.
                         float4 sph = transformSphere(xform, float4(splinePoints.interpolate(j, t), sanitizeWidth(splineWidths.interpolate(j, t) * 0.5f * widthScale)));
 
-                        result.points.push_back(sph.xyz());
-                        result.radius.push_back(sph.w);
+                        result.points[pointIndex] = sph.xyz();
+                        result.radius[pointIndex] = sph.w;
+                        pointIndex++;
                     }
                     tmpCount++;
                 }
@@ -310,13 +419,15 @@ namespace Falcor
 
             // Always keep the last vertex.
             float4 sph = transformSphere(xform, float4(splinePoints.interpolate(optimizedStrandArrays.vertexCount - 2, 1.f), sanitizeWidth(splineWidths.interpolate(optimizedStrandArrays.vertexCount - 2, 1.f) * 0.5f * widthScale)));
-            result.points.push_back(sph.xyz());
-            result.radius.push_back(sph.w);
+            result.points[pointIndex] = sph.xyz();
+            result.radius[pointIndex] = sph.w;
+            FALCOR_ASSERT(pointIndex + 1 == layout.outputOffsets[strand + 1]);
 
             // Texture coordinates.
-            if (UVs)
+            if (curveArrays.UVs)
             {
                 const CubicSpline<float2>& splineUVs = splineCache.splineUVs.setup(strandArrays.UVs.data(), optimizedStrandArrays.vertexCount);
+                uint32_t texCrdIndex = layout.outputOffsets[strand];
                 tmpCount = 0;
                 for (uint32_t j = 0; j < optimizedStrandArrays.vertexCount - 1; j++)
                 {
@@ -325,66 +436,56 @@ namespace Falcor
                         if (tmpCount % keepOneEveryXVerticesPerStrand == 0)
                         {
                             float t = (float)k / (float)subdivPerSegment;
-                            result.texCrds.push_back(splineUVs.interpolate(j, t));
+                            result.texCrds[texCrdIndex++] = splineUVs.interpolate(j, t);
                         }
                         tmpCount++;
                     }
                 }
 
                 // Always keep the last vertex.
-                result.texCrds.push_back(splineUVs.interpolate(optimizedStrandArrays.vertexCount - 2, 1.f));
+                result.texCrds[texCrdIndex] = splineUVs.interpolate(optimizedStrandArrays.vertexCount - 2, 1.f);
             }
-
-            for (uint32_t j = i; j < std::min(strandCount, i + keepOneEveryXStrands); j++) pointOffset += vertexCountsPerStrand[j];
-        }
+        });
 
         return result;
     }
 
     CurveTessellation::MeshResult CurveTessellation::convertToPolytube(uint32_t strandCount, const uint32_t* vertexCountsPerStrand, const float3* controlPoints, const float* widths, const float2* UVs, uint32_t subdivPerSegment, uint32_t keepOneEveryXStrands, uint32_t keepOneEveryXVerticesPerStrand, float widthScale, uint32_t pointCountPerCrossSection)
+    {
+        return convertToPolytube(getStrandData(strandCount, vertexCountsPerStrand, controlPoints, widths, UVs), subdivPerSegment, keepOneEveryXStrands, keepOneEveryXVerticesPerStrand, widthScale, pointCountPerCrossSection);
+    }
+
+    CurveTessellation::MeshResult CurveTessellation::convertToPolytube(const StrandData& strands, uint32_t subdivPerSegment, uint32_t keepOneEveryXStrands, uint32_t keepOneEveryXVerticesPerStrand, float widthScale, uint32_t pointCountPerCrossSection)
     {
         MeshResult result;
-        uint32_t vertexCounts = 0;
-        uint32_t faceCounts = 0;
-        uint32_t maxVertexCountsPerStrand = 0;
-        for (uint32_t i = 0; i < strandCount; i += keepOneEveryXStrands)
-        {
-            uint32_t tmpPointCount = div_round_up(subdivPerSegment * (vertexCountsPerStrand[i] - 1), keepOneEveryXVerticesPerStrand) + 1;
-            vertexCounts += pointCountPerCrossSection * tmpPointCount;
-            faceCounts += 2 * pointCountPerCrossSection * (tmpPointCount - 1);
-            maxVertexCountsPerStrand = std::max(maxVertexCountsPerStrand, vertexCountsPerStrand[i]);
-        }
-        result.vertices.reserve(vertexCounts);
-        result.normals.reserve(vertexCounts);
-        result.tangents.reserve(vertexCounts);
-        result.texCrds.reserve(vertexCounts);
-        result.radii.reserve(vertexCounts);
-        result.faceVertexCounts.reserve(faceCounts);
-        result.faceVertexIndices.reserve(faceCounts * 3);
-
-        uint32_t pointOffset = 0;
-        uint32_t meshVertexOffset = 0;
-
-        StrandArrays strandArrays;
-        strandArrays.controlPoints.reserve(maxVertexCountsPerStrand);
-        strandArrays.widths.reserve(maxVertexCountsPerStrand);
-        strandArrays.UVs.reserve(maxVertexCountsPerStrand);
-        CurveArrays curveArrays(controlPoints, widths, UVs);
-
-        StrandArrays optimizedStrandArrays;
-        CubicSplineCache splineCache;
-        for (uint32_t i = 0; i < strandCount; i += keepOneEveryXStrands)
+
+        const StrandLayout layout = computeStrandLayout(strands, subdivPerSegment, keepOneEveryXStrands, keepOneEveryXVerticesPerStrand);
+        const uint32_t vertexCount = pointCountPerCrossSection * layout.getPointCount();
+        const uint32_t faceCount = 2 * pointCountPerCrossSection * layout.getSegmentCount();
+        result.vertices.resize(vertexCount);
+        result.normals.resize(vertexCount);
+        result.tangents.resize(vertexCount);
+        if (!strands.UVs.empty()) result.texCrds.resize(vertexCount);
+        result.radii.resize(vertexCount);
+        result.faceVertexCounts.resize(faceCount);
+        result.faceVertexIndices.resize(faceCount * 3);
+
+        CurveArrays curveArrays(strands.controlPoints.data(), strands.widths.data(), strands.UVs.empty() ? nullptr : strands.UVs.data());
+
+        forEachStrand(layout, [&](uint32_t strand, StrandArrays& strandArrays, StrandArrays& optimizedStrandArrays, CubicSplineCache& splineCache)
         {
             optimizedStrandArrays.controlPoints.clear();
             optimizedStrandArrays.UVs.clear();
             optimizedStrandArrays.widths.clear();
             optimizedStrandArrays.vertexCount = 0;
 
-            strandArrays.vertexCount = vertexCountsPerStrand[i];
+            strandArrays.vertexCount = strands.vertexCountsPerStrand[strand * keepOneEveryXStrands];
 
-            optimizeStrandGeometry(splineCache, curveArrays, strandArrays, optimizedStrandArrays, pointOffset, subdivPerSegment, keepOneEveryXVerticesPerStrand, widthScale);
+            optimizeStrandGeometry(splineCache, curveArrays, strandArrays, optimizedStrandArrays, layout.inputOffsets[strand], subdivPerSegment, keepOneEveryXVerticesPerStrand, widthScale);
+            FALCOR_ASSERT(optimizedStrandArrays.controlPoints.size() == layout.outputOffsets[strand + 1] - layout.outputOffsets[strand]);
 
-            for (uint32_t j = i; j < std::min(strandCount, i + keepOneEveryXStrands); j++) pointOffset += vertexCountsPerStrand[j];
+            const uint32_t meshVertexOffset = pointCountPerCrossSection * layout.outputOffsets[strand];
+            const uint32_t faceOffset = 2 * pointCountPerCrossSection * layout.getSegmentOffset(strand);
 
             // Build the initial frame.
             float3 fwd, s, t;
@@ -399,21 +500,17 @@ namespace Falcor
                 updateCurveFrame(optimizedStrandArrays, fwd, s, t, j);
 
                 // Mesh vertices, normals, tangents, and texCrds (if any).
-                updateMeshResultBuffers(result, curveArrays, optimizedStrandArrays, fwd, s, t, pointCountPerCrossSection, j);
+                updateMeshResultBuffers(result, curveArrays, optimizedStrandArrays, fwd, s, t, pointCountPerCrossSection, meshVertexOffset, j);
 
                 // Mesh faces.
                 if (j < optimizedStrandArrays.controlPoints.size() - 1)
                 {
                     uint32_t quadCountLimit = pointCountPerCrossSection;
-                    connectFaceVertices(result, meshVertexOffset, pointCountPerCrossSection, quadCountLimit, 1, 1, j);
+                    connectFaceVertices(result, faceOffset + 2 * quadCountLimit * j, meshVertexOffset, pointCountPerCrossSection, quadCountLimit, 1, 1, j);
                 }
             }
-
-            meshVertexOffset += pointCountPerCrossSection * (uint32_t)optimizedStrandArrays.controlPoints.size();
-        }
+        });
 
         return result;
     }
-
-
 }
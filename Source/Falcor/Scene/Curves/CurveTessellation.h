@@ -30,6 +30,7 @@
 #include "Utils/Math/Matrix.h"
 #include "Utils/Math/Vector.h"
 #include "Utils/fast_vector.h"
+#include <fstd/span.h>
 #include <vector>
 
 namespace Falcor
@@ -37,6 +38,17 @@ namespace Falcor
     class FALCOR_API CurveTessellation
     {
     public:
+        /** Input curve strands.
+            The per-vertex attributes are stored in separate arrays, with the vertices of all strands stored contiguously.
+        */
+        struct StrandData
+        {
+            fstd::span<const uint32_t> vertexCountsPerStrand;   ///< Number of control points per strand.
+            fstd::span<const float3> controlPoints;             ///< Array of control points.
+            fstd::span<const float> widths;                     ///< Array of curve widths, i.e., diameters of swept spheres.
+            fstd::span<const float2> UVs;                       ///< Array of texture coordinates (optional, may be empty).
+        };
+
         // Swept spheres
 
         struct SweptSphereResult
@@ -64,6 +76,14 @@ namespace Falcor
         */
         static SweptSphereResult convertToLinearSweptSphere(uint32_t strandCount, const uint32_t* vertexCountsPerStrand, const float3* controlPoints, const float* widths, const float2* UVs, uint32_t degree, uint32_t subdivPerSegment, uint32_t keepOneEveryXStrands, uint32_t keepOneEveryXVerticesPerStrand, float widthScale, const float4x4& xform);
 
+        /** Convert cubic B-splines to a couple of linear swept sphere segments.
+            The strands are processed in parallel. The output is identical to the version above.
+            \param[in] strands Curve strands.
+            See above for the other parameters.
+            \return Linear swept sphere segments.
+        */
+        static SweptSphereResult convertToLinearSweptSphere(const StrandData& strands, uint32_t degree, uint32_t subdivPerSegment, uint32_t keepOneEveryXStrands, uint32_t keepOneEveryXVerticesPerStrand, float widthScale, const float4x4& xform);
+
         // Tessellated mesh
 
         struct MeshResult
@@ -92,6 +112,13 @@ namespace Falcor
         */
         static MeshResult convertToPolytube(uint32_t strandCount, const uint32_t* vertexCountsPerStrand, const float3* controlPoints, const float* widths, const float2* UVs, uint32_t subdivPerSegment, uint32_t keepOneEveryXStrands, uint32_t keepOneEveryXVerticesPerStrand, float widthScale, uint32_t pointCountPerCrossSection);
 
+        /** Tessellate cubic B-splines to a triangular mesh.
+            The strands are processed in parallel. The output is identical to the version above.
+            \param[in] strands Curve strands.
+            See above for the other parameters.
+            \return Tessellated mesh.
+        */
+        static MeshResult convertToPolytube(const StrandData& strands, uint32_t subdivPerSegment, uint32_t keepOneEveryXStrands, uint32_t keepOneEveryXVerticesPerStrand, float widthScale, uint32_t pointCountPerCrossSection);
 
     private:
         CurveTessellation() = default;
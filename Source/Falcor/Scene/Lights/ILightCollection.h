@@ -151,6 +151,11 @@ namespace Falcor
         */
         virtual const std::vector<MeshLightData>& getMeshLights() const = 0;
 
+        /** Returns the indices of the mesh lights whose transform changed in the last call to update().
+            The list is valid when the update flags signal is emitted with UpdateFlags::MatrixChanged.
+        */
+        virtual const std::vector<uint32_t>& getUpdatedLights() const = 0;
+
         /** Prepare for syncing the CPU data.
             If the mesh light triangles will be accessed with getMeshLightTriangles()
             performance can be improved by calling this function ahead of time.
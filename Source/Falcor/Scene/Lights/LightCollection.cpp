@@ -31,9 +31,14 @@
 #include "Scene/Scene.h"
 #include "Scene/Material/BasicMaterial.h"
 #include "Utils/Logger.h"
+#include "Utils/NumericRange.h"
+#include "Utils/Color/ColorHelpers.slang"
+#include "Utils/Math/PackedFormats.h"
 #include "Utils/Timing/TimeReport.h"
 #include "Utils/Timing/Profiler.h"
 
+#include <algorithm>
+#include <execution>
 #include <fstream>
 
 namespace Falcor
@@ -48,11 +53,46 @@ namespace Falcor
         const char kBuildTriangleListFile[] = "Scene/Lights/BuildTriangleList.cs.slang";
         const char kUpdateTriangleVerticesFile[] = "Scene/Lights/UpdateTriangleVertices.cs.slang";
         const char kFinalizeIntegrationFile[] = "Scene/Lights/FinalizeIntegration.cs.slang";
+
+        /** Calls a function for each range of consecutive emissive triangles covered by a sorted list of mesh lights.
+            Adjacent mesh lights are merged into a single range to reduce the number of copies.
+        */
+        template<typename Func>
+        void forEachTriangleRange(const std::vector<MeshLightData>& meshLights, const std::vector<uint32_t>& lightIndices, Func func)
+        {
+            uint32_t rangeOffset = 0;
+            uint32_t rangeCount = 0;
+            for (uint32_t lightIdx : lightIndices)
+            {
+                const MeshLightData& meshLight = meshLights[lightIdx];
+                if (rangeCount > 0 && rangeOffset + rangeCount == meshLight.triangleOffset)
+                {
+                    rangeCount += meshLight.triangleCount;
+                }
+                else
+                {
+                    if (rangeCount > 0) func(rangeOffset, rangeCount);
+                    rangeOffset = meshLight.triangleOffset;
+                    rangeCount = meshLight.triangleCount;
+                }
+            }
+            if (rangeCount > 0) func(rangeOffset, rangeCount);
+        }
+
+        /** Calls a function for each element of a range, either in parallel or serially.
+        */
+        template<typename Range, typename Func>
+        void forEach(bool parallel, const Range& range, Func func)
+        {
+            if (parallel) std::for_each(std::execution::par, range.begin(), range.end(), func);
+            else std::for_each(range.begin(), range.end(), func);
+        }
     }
 
-    LightCollection::LightCollection(ref<Device> pDevice, RenderContext* pRenderContext, Scene* pScene)
+    LightCollection::LightCollection(ref<Device> pDevice, RenderContext* pRenderContext, Scene* pScene, const Options& options)
         : mpDevice(pDevice)
         , mpScene(pScene)
+        , mOptions(options)
     {
         FALCOR_ASSERT(mpScene);
 
@@ -87,8 +127,7 @@ namespace Falcor
 
         // Update transform matrices and check for updates.
         // TODO: Move per-mesh instance update flags into Scene. Return just a list of mesh lights that have changed.
-        std::vector<uint32_t> updatedLights;
-        updatedLights.reserve(mMeshLights.size());
+        mUpdatedLights.clear();
 
         for (uint32_t lightIdx = 0; lightIdx < mMeshLights.size(); ++lightIdx)
         {
@@ -99,14 +138,14 @@ namespace Falcor
             if (mpScene->getAnimationController()->isMatrixChanged(NodeID{ instanceData.globalMatrixID })) updateFlags |= UpdateFlags::MatrixChanged;
 
             // Store update status.
-            if (updateFlags != UpdateFlags::None) updatedLights.push_back(lightIdx);
+            if (updateFlags != UpdateFlags::None) mUpdatedLights.push_back(lightIdx);
             if (pUpdateStatus) pUpdateStatus->lightsUpdateInfo.push_back(updateFlags);
         }
 
         // Update light data if needed.
-        if (!updatedLights.empty())
+        if (!mUpdatedLights.empty())
         {
-            updateTrianglePositions(pRenderContext, *mpScene, updatedLights);
+            updateTrianglePositions(pRenderContext, *mpScene, mUpdatedLights);
             mUpdateFlagsSignal(UpdateFlags::MatrixChanged);
             return true;
         }
@@ -225,6 +264,9 @@ namespace Falcor
         {
             // If there are no emissive triangle, clear everything and mark the CPU data/stats as valid.
             mMeshLightTriangles.clear();
+            mHasCPUGeometry.clear();
+            mGPUTriangleDataLights.clear();
+            mGPUFluxDataLights.clear();
             mMeshLightStats = MeshLightStats();
 
             mCPUInvalidData = CPUOutOfDateFlags::None;
@@ -245,9 +287,16 @@ namespace Falcor
 
             timeReport.measure("LightCollection::build integrate emissive");
 
+            // Compute the CPU-side triangle data. Only the data produced on the GPU is read back.
+            prepareCPUTriangleData(scene);
+
+            timeReport.measure("LightCollection::build CPU triangle data");
+
             // Build list of active triangles.
-            mCPUInvalidData = CPUOutOfDateFlags::All;
-            mStagingBufferValid = false;
+            mCPUInvalidData = CPUOutOfDateFlags::None;
+            if (!mGPUTriangleDataLights.empty()) mCPUInvalidData |= CPUOutOfDateFlags::TriangleData;
+            if (!mGPUFluxDataLights.empty()) mCPUInvalidData |= CPUOutOfDateFlags::FluxData;
+            mStagingBufferValid = mCPUInvalidData == CPUOutOfDateFlags::None;
             mStatsValid = false;
 
             prepareSyncCPUData(pRenderContext);
@@ -491,6 +540,131 @@ namespace Falcor
         }
     }
 
+    void LightCollection::prepareCPUTriangleData(const Scene& scene)
+    {
+        FALCOR_ASSERT(mTriangleCount > 0);
+
+        // The triangle geometry is computed from the CPU-side scene data. This is not possible for dynamic meshes,
+        // whose vertices are only up-to-date on the GPU, or if the scene does not keep its geometry on the CPU.
+        const auto& vertexData = scene.getMeshStaticData();
+        const auto& indexData = scene.getMeshIndexData();
+        const bool hasSceneCPUData = vertexData.hasCpuData() && (indexData.hasCpuData() || indexData.empty());
+
+        mMeshLightTriangles.clear();
+        mMeshLightTriangles.resize(mTriangleCount);
+        mHasCPUGeometry.assign(mMeshLights.size(), false);
+        mGPUTriangleDataLights.clear();
+        mGPUFluxDataLights.clear();
+
+        for (uint32_t lightIdx = 0; lightIdx < mMeshLights.size(); ++lightIdx)
+        {
+            const MeshLightData& meshLight = mMeshLights[lightIdx];
+            const GeometryInstanceData& instanceData = scene.getGeometryInstance(meshLight.instanceID);
+            auto pMaterial = scene.getMaterial(MaterialID::fromSlang(meshLight.materialID))->toBasicMaterial();
+            FALCOR_ASSERT(pMaterial);
+
+            bool hasCPUGeometry = hasSceneCPUData && !instanceData.isDynamic();
+            mHasCPUGeometry[lightIdx] = hasCPUGeometry;
+            if (!hasCPUGeometry) mGPUTriangleDataLights.push_back(lightIdx);
+
+            // Textured emission is integrated over the covered texels on the GPU.
+            if (!hasCPUGeometry || pMaterial->getEmissiveTexture()) mGPUFluxDataLights.push_back(lightIdx);
+        }
+
+        // Compute the triangle data over the mesh lights. Each mesh light writes to its own range of triangles.
+        auto lights = NumericRange<uint32_t>(0, (uint32_t)mMeshLights.size());
+        forEach(mOptions.parallelCPUTriangleData, lights, [&](uint32_t lightIdx)
+        {
+            if (!mHasCPUGeometry[lightIdx]) return;
+            computeCPUTriangleGeometry(scene, lightIdx);
+
+            // Compute the flux for non-textured emission. This matches the computation in FinalizeIntegration.cs.slang.
+            const MeshLightData& meshLight = mMeshLights[lightIdx];
+            auto pMaterial = scene.getMaterial(MaterialID::fromSlang(meshLight.materialID))->toBasicMaterial();
+            if (pMaterial->getEmissiveTexture()) return;
+
+            const BasicMaterialData& materialData = pMaterial->getData();
+            const float3 averageRadiance = materialData.emissive * materialData.emissiveFactor;
+            for (uint32_t triIdx = meshLight.triangleOffset; triIdx < meshLight.triangleOffset + meshLight.triangleCount; triIdx++)
+            {
+                auto& tri = mMeshLightTriangles[triIdx];
+                tri.averageRadiance = averageRadiance;
+                tri.flux = luminance(averageRadiance) * tri.area * (float)M_PI;
+            }
+        });
+    }
+
+    bool LightCollection::updateCPUTrianglePositions(const Scene& scene, const std::vector<uint32_t>& updatedLights)
+    {
+        // Recompute the world-space geometry of the updated mesh lights that have their geometry on the CPU.
+        forEach(mOptions.parallelCPUTriangleData, updatedLights, [&](uint32_t lightIdx)
+        {
+            if (mHasCPUGeometry[lightIdx]) computeCPUTriangleGeometry(scene, lightIdx);
+        });
+
+        // Return true if the geometry of any of the updated mesh lights has to be read back from the GPU.
+        return std::any_of(updatedLights.begin(), updatedLights.end(), [&](uint32_t lightIdx) { return !mHasCPUGeometry[lightIdx]; });
+    }
+
+    void LightCollection::computeCPUTriangleGeometry(const Scene& scene, uint32_t lightIdx)
+    {
+        // This computes the same data as the GPU-side triangle list builder (see BuildTriangleList.cs.slang).
+        const MeshLightData& meshLight = mMeshLights[lightIdx];
+        const GeometryInstanceData& instanceData = scene.getGeometryInstance(meshLight.instanceID);
+        const MeshDesc& meshDesc = scene.getMesh(MeshID::fromSlang(instanceData.geometryID));
+        const float4x4& worldMat = scene.getAnimationController()->getGlobalMatrices()[instanceData.globalMatrixID];
+        const auto& vertexData = scene.getMeshStaticData();
+        FALCOR_ASSERT(meshLight.triangleCount == meshDesc.getTriangleCount());
+
+        const uint8_t* meshIndexData8 = nullptr;
+        if (meshDesc.useVertexIndices())
+            meshIndexData8 = reinterpret_cast<const uint8_t*>(&scene.getMeshIndexData()[meshDesc.ibOffset]);
+
+        for (uint32_t triangleIndex = 0; triangleIndex < meshLight.triangleCount; triangleIndex++)
+        {
+            // Compute local vertex indices within the mesh.
+            uint32_t vidx[3] = {};
+            if (meshDesc.useVertexIndices())
+            {
+                if (meshDesc.use16BitIndices())
+                {
+                    const uint16_t* indices = reinterpret_cast<const uint16_t*>(meshIndexData8 + triangleIndex * 3 * sizeof(uint16_t));
+                    for (uint32_t j = 0; j < 3; j++) vidx[j] = indices[j];
+                }
+                else
+                {
+                    const uint32_t* indices = reinterpret_cast<const uint32_t*>(meshIndexData8 + triangleIndex * 3 * sizeof(uint32_t));
+                    for (uint32_t j = 0; j < 3; j++) vidx[j] = indices[j];
+                }
+            }
+            else
+            {
+                for (uint32_t j = 0; j < 3; j++) vidx[j] = triangleIndex * 3 + j;
+            }
+
+            auto& tri = mMeshLightTriangles[meshLight.triangleOffset + triangleIndex];
+            tri.lightIdx = lightIdx;
+
+            for (uint32_t j = 0; j < 3; j++)
+            {
+                FALCOR_ASSERT(vidx[j] < meshDesc.vertexCount);
+                const StaticVertexData vertex = vertexData[(size_t)meshDesc.vbOffset + vidx[j]].unpack();
+                tri.vtx[j].pos = transformPoint(worldMat, vertex.position);
+                tri.vtx[j].uv = vertex.texCrd;
+            }
+
+            // Compute face normal and area in world space.
+            float3 N = cross(tri.vtx[1].pos - tri.vtx[0].pos, tri.vtx[2].pos - tri.vtx[0].pos);
+            tri.area = 0.5f * length(N);
+
+            // Flip the normal depending on final winding order in world space.
+            if (instanceData.isWorldFrontFaceCW()) N = -N;
+
+            // Apply the same quantization as the packed GPU-side triangle data.
+            tri.normal = decodeNormal2x16(encodeNormal2x16(normalize(N)));
+        }
+    }
+
     void LightCollection::updateActiveTriangleList(RenderContext* pRenderContext)
     {
         // This function updates the list of active (non-culled) triangles based on the pre-integrated flux.
@@ -498,7 +672,7 @@ namespace Falcor
         // dynamically changing emissive intensities, it should be run as part of update().
         // In that case, we may want to move it to the GPU to avoid syncing the data to the CPU first.
 
-        // Read back the current data. This is potentially expensive.
+        // Read back the GPU-produced data. This only stalls if there are textured or dynamic mesh lights.
         syncCPUData(pRenderContext);
 
         const uint32_t triCount = (uint32_t)mMeshLightTriangles.size();
@@ -570,8 +744,14 @@ namespace Falcor
         // Run compute pass to update all triangles.
         mpTrianglePositionUpdater->execute(pRenderContext, mTriangleCount, 1u, 1u);
 
-        mCPUInvalidData |= CPUOutOfDateFlags::TriangleData;
-        mStagingBufferValid = false;
+        // Update the CPU-side data. Only the geometry that is not available on the CPU is read back.
+        // The readback is scheduled right away so that it has normally completed by the time the data is accessed.
+        if (updateCPUTrianglePositions(scene, updatedLights))
+        {
+            mCPUInvalidData |= CPUOutOfDateFlags::TriangleData;
+            mStagingBufferValid = false;
+            copyDataToStagingBuffer(pRenderContext);
+        }
     }
 
     void LightCollection::bindShaderData(const ShaderVar& var) const
@@ -612,37 +792,48 @@ namespace Falcor
     {
         if (mStagingBufferValid) return;
 
+        // The staging buffers are double buffered. The copy is written to the buffer not holding the most recent copy,
+        // so that a new readback can be scheduled while the previous one is still in flight. The previous copy into
+        // this buffer was scheduled two readbacks ago, so waiting for it normally doesn't block.
+        const uint32_t stagingIndex = (mStagingIndex + 1) % (uint32_t)mStagingBuffers.size();
+        StagingBuffer& staging = mStagingBuffers[stagingIndex];
+        mpStagingFence->wait(staging.fenceValue);
+
         // Allocate staging buffer for readback. The data from our different GPU buffers is stored consecutively.
+        const uint64_t fluxOffset = mpTriangleData->getSize();
         const size_t stagingSize = mpTriangleData->getSize() + mpFluxData->getSize();
-        if (!mpStagingBuffer || mpStagingBuffer->getSize() < stagingSize)
+        if (!staging.pBuffer || staging.pBuffer->getSize() < stagingSize)
         {
-            mpStagingBuffer = mpDevice->createBuffer(stagingSize, ResourceBindFlags::None, MemoryType::ReadBack);
-            mpStagingBuffer->setName("LightCollection::mpStagingBuffer");
-            mCPUInvalidData = CPUOutOfDateFlags::All;
+            staging.pBuffer = mpDevice->createBuffer(stagingSize, ResourceBindFlags::None, MemoryType::ReadBack);
+            staging.pBuffer->setName("LightCollection::mStagingBuffers[" + std::to_string(stagingIndex) + "]");
         }
 
-        // Schedule the copy operations for data that is invalid.
+        // Schedule the copy operations for data that is invalid. Only the ranges of the mesh lights whose data
+        // is produced on the GPU are copied, at the same offsets as in the GPU buffers.
         // Note that the staging buffer is allocated for the worst-case encountered so far.
-        // If the number of triangles ever decreases, we'll be copying unnecessary data. This currently doesn't happen as geometry is not added/removed from the scene.
-        // TODO: Update this code if we start removing geometry dynamically.
         FALCOR_ASSERT(mCPUInvalidData != CPUOutOfDateFlags::None); // We shouldn't get here unless at least some data is out of date.
-        bool copyTriangleData = is_set(mCPUInvalidData, CPUOutOfDateFlags::TriangleData);
-        bool copyFluxData = is_set(mCPUInvalidData, CPUOutOfDateFlags::FluxData);
-
-        uint64_t offset = 0;
-        if (copyTriangleData) pRenderContext->copyBufferRegion(mpStagingBuffer.get(), offset, mpTriangleData.get(), 0, mpTriangleData->getSize());
-        offset += mpTriangleData->getSize();
-        if (copyFluxData) pRenderContext->copyBufferRegion(mpStagingBuffer.get(), offset, mpFluxData.get(), 0, mpFluxData->getSize());
-        offset += mpFluxData->getSize();
-        FALCOR_ASSERT(offset == stagingSize);
+        if (is_set(mCPUInvalidData, CPUOutOfDateFlags::TriangleData))
+        {
+            forEachTriangleRange(mMeshLights, mGPUTriangleDataLights, [&](uint32_t triOffset, uint32_t triCount)
+            {
+                const uint64_t offset = triOffset * sizeof(PackedEmissiveTriangle);
+                pRenderContext->copyBufferRegion(staging.pBuffer.get(), offset, mpTriangleData.get(), offset, triCount * sizeof(PackedEmissiveTriangle));
+            });
+        }
+        if (is_set(mCPUInvalidData, CPUOutOfDateFlags::FluxData))
+        {
+            forEachTriangleRange(mMeshLights, mGPUFluxDataLights, [&](uint32_t triOffset, uint32_t triCount)
+            {
+                const uint64_t offset = triOffset * sizeof(EmissiveFlux);
+                pRenderContext->copyBufferRegion(staging.pBuffer.get(), fluxOffset + offset, mpFluxData.get(), offset, triCount * sizeof(EmissiveFlux));
+            });
+        }
 
-        // Submit command list and insert signal.
+        // Submit command list and insert signal. The fence is only waited on when the data is accessed.
         pRenderContext->submit(false);
-        pRenderContext->signal(mpStagingFence.get());
-
-        // Resize the CPU-side triangle list (array-of-structs) buffer and mark the data as invalid.
-        mMeshLightTriangles.resize(mTriangleCount);
+        staging.fenceValue = pRenderContext->signal(mpStagingFence.get());
 
+        mStagingIndex = stagingIndex;
         mStagingBufferValid = true;
     }
 
@@ -658,51 +849,60 @@ namespace Falcor
             prepareSyncCPUData(pRenderContext);
         }
 
-        // Wait for signal.
-        mpStagingFence->wait();
-
+        // Wait for the most recent copy. This doesn't block if the copy has already completed.
         FALCOR_ASSERT(mStagingBufferValid);
+        const StagingBuffer& staging = mStagingBuffers[mStagingIndex];
+        mpStagingFence->wait(staging.fenceValue);
+
         FALCOR_ASSERT(mpTriangleData && mpFluxData);
-        const void* mappedData = mpStagingBuffer->map();
+        const void* mappedData = staging.pBuffer->map();
 
         uint64_t offset = 0;
         const PackedEmissiveTriangle* triangleData = reinterpret_cast<const PackedEmissiveTriangle*>(reinterpret_cast<uintptr_t>(mappedData) + offset);
         offset += mpTriangleData->getSize();
         const EmissiveFlux* fluxData = reinterpret_cast<const EmissiveFlux*>(reinterpret_cast<uintptr_t>(mappedData) + offset);
         offset += mpFluxData->getSize();
-        FALCOR_ASSERT(offset <= mpStagingBuffer->getSize());
-
-        bool updateTriangleData = is_set(mCPUInvalidData, CPUOutOfDateFlags::TriangleData);
-        bool updateFluxData = is_set(mCPUInvalidData, CPUOutOfDateFlags::FluxData);
+        FALCOR_ASSERT(offset <= staging.pBuffer->getSize());
 
         FALCOR_ASSERT(mTriangleCount > 0);
         FALCOR_ASSERT(mMeshLightTriangles.size() == (size_t)mTriangleCount);
-        for (uint32_t triIdx = 0; triIdx < mTriangleCount; triIdx++)
-        {
-            const auto tri = triangleData[triIdx].unpack();
-            auto& meshLightTri = mMeshLightTriangles[triIdx];
 
-            if (updateTriangleData)
+        // Merge the GPU-produced data into the CPU-side triangle list.
+        if (is_set(mCPUInvalidData, CPUOutOfDateFlags::TriangleData))
+        {
+            forEachTriangleRange(mMeshLights, mGPUTriangleDataLights, [&](uint32_t triOffset, uint32_t triCount)
             {
-                meshLightTri.lightIdx = tri.lightIdx;
-                meshLightTri.normal = tri.normal;
-                meshLightTri.area = tri.area;
-
-                for (uint32_t j = 0; j < 3; j++)
+                for (uint32_t triIdx = triOffset; triIdx < triOffset + triCount; triIdx++)
                 {
-                    meshLightTri.vtx[j].pos = tri.posW[j];
-                    meshLightTri.vtx[j].uv = tri.texCoords[j];
+                    const auto tri = triangleData[triIdx].unpack();
+                    auto& meshLightTri = mMeshLightTriangles[triIdx];
+
+                    meshLightTri.lightIdx = tri.lightIdx;
+                    meshLightTri.normal = tri.normal;
+                    meshLightTri.area = tri.area;
+
+                    for (uint32_t j = 0; j < 3; j++)
+                    {
+                        meshLightTri.vtx[j].pos = tri.posW[j];
+                        meshLightTri.vtx[j].uv = tri.texCoords[j];
+                    }
                 }
-            }
+            });
+        }
 
-            if (updateFluxData)
+        if (is_set(mCPUInvalidData, CPUOutOfDateFlags::FluxData))
+        {
+            forEachTriangleRange(mMeshLights, mGPUFluxDataLights, [&](uint32_t triOffset, uint32_t triCount)
             {
-                meshLightTri.flux = fluxData[triIdx].flux;
-                meshLightTri.averageRadiance = fluxData[triIdx].averageRadiance;
-            }
+                for (uint32_t triIdx = triOffset; triIdx < triOffset + triCount; triIdx++)
+                {
+                    mMeshLightTriangles[triIdx].flux = fluxData[triIdx].flux;
+                    mMeshLightTriangles[triIdx].averageRadiance = fluxData[triIdx].averageRadiance;
+                }
+            });
         }
 
-        mpStagingBuffer->unmap();
+        staging.pBuffer->unmap();
         mCPUInvalidData = CPUOutOfDateFlags::None;
     }
 
@@ -715,7 +915,10 @@ namespace Falcor
         if (mpFluxData) m += mpFluxData->getSize();
         if (mpMeshData) m += mpMeshData->getSize();
         if (mpPerMeshInstanceOffset) m += mpPerMeshInstanceOffset->getSize();
-        if (mpStagingBuffer) m += mpStagingBuffer->getSize();
+        for (const auto& staging : mStagingBuffers)
+        {
+            if (staging.pBuffer) m += staging.pBuffer->getSize();
+        }
         if (mIntegrator.pResultBuffer) m += mIntegrator.pResultBuffer->getSize();
         return m;
     }
@@ -38,6 +38,7 @@
 #include "Core/Program/ProgramVars.h"
 #include "Core/Pass/ComputePass.h"
 #include "Utils/Math/Vector.h"
+#include <array>
 #include <memory>
 #include <vector>
 
@@ -59,24 +60,35 @@ namespace Falcor
     {
         FALCOR_OBJECT(LightCollection)
     public:
+        /** LightCollection configuration.
+        */
+        struct Options
+        {
+            bool parallelCPUTriangleData = true;    ///< Compute the CPU-side triangle data in parallel over the mesh lights.
+        };
 
         /** Creates a light collection for the given scene.
             Note that update() must be called before the collection is ready to use.
             \param[in] pDevice GPU device.
             \param[in] pRenderContext The render context.
             \param[in] pScene The scene.
+            \param[in] options The options to override the default behavior.
             \return A pointer to a new light collection object, or throws an exception if creation failed.
         */
-        static ref<LightCollection> create(ref<Device> pDevice, RenderContext* pRenderContext, Scene* pScene)
+        static ref<LightCollection> create(ref<Device> pDevice, RenderContext* pRenderContext, Scene* pScene, const Options& options = Options())
         {
-            return make_ref<LightCollection>(pDevice, pRenderContext, pScene);
+            return make_ref<LightCollection>(pDevice, pRenderContext, pScene, options);
         }
 
-        LightCollection(ref<Device> pDevice, RenderContext* pRenderContext, Scene* pScene);
+        LightCollection(ref<Device> pDevice, RenderContext* pRenderContext, Scene* pScene, const Options& options = Options());
         ~LightCollection() = default;
 
         const ref<Device>& getDevice() const override { return mpDevice; }
 
+        /** Returns the current configuration.
+        */
+        const Options& getOptions() const { return mOptions; }
+
         /** Updates the light collection to the current state of the scene.
             \param[in] pRenderContext The render context.
             \param[out] pUpdateStatus Stores information about which type of updates were performed for each mesh light. This is an optional output parameter.
@@ -99,7 +111,8 @@ namespace Falcor
 
         /** Returns a CPU buffer with all emissive triangles in world space.
             Note that update() must have been called before for the data to be valid.
-            Call prepareSyncCPUData() ahead of time to avoid stalling the GPU.
+            Most of the data is computed on the CPU. Only data produced on the GPU (dynamic geometry and
+            textured emission) is read back, which may stall if prepareSyncCPUData() was not called ahead of time.
         */
         const std::vector<MeshLightTriangle>& getMeshLightTriangles(RenderContext* pRenderContext) const override { syncCPUData(pRenderContext); return mMeshLightTriangles; }
 
@@ -108,10 +121,15 @@ namespace Falcor
         */
         const std::vector<MeshLightData>& getMeshLights() const override { return mMeshLights; }
 
+        /** Returns the indices of the mesh lights whose transform changed in the last call to update().
+        */
+        const std::vector<uint32_t>& getUpdatedLights() const override { return mUpdatedLights; }
+
         /** Prepare for syncing the CPU data.
             If the mesh light triangles will be accessed with getMeshLightTriangles()
             performance can be improved by calling this function ahead of time.
             This function schedules the copies so that it can be read back without delay later.
+            Only the data that is produced on the GPU is copied. The copy is tracked by a fence and does not block.
         */
         void prepareSyncCPUData(RenderContext* pRenderContext) const override { copyDataToStagingBuffer(pRenderContext); }
 
@@ -145,17 +163,26 @@ namespace Falcor
         void updateActiveTriangleList(RenderContext* pRenderContext);
         void updateTrianglePositions(RenderContext* pRenderContext, const Scene& scene, const std::vector<uint32_t>& updatedLights);
 
+        void prepareCPUTriangleData(const Scene& scene);
+        bool updateCPUTrianglePositions(const Scene& scene, const std::vector<uint32_t>& updatedLights);
+        void computeCPUTriangleGeometry(const Scene& scene, uint32_t lightIdx);
+
         void copyDataToStagingBuffer(RenderContext* pRenderContext) const;
         void syncCPUData(RenderContext* pRenderContext) const;
 
         // Internal state
         ref<Device>                             mpDevice;
         Scene*                                  mpScene;                ///< Unowning pointer to scene (scene owns LightCollection).
+        Options                                 mOptions;               ///< Configuration.
 
         std::vector<MeshLightData>              mMeshLights;            ///< List of all mesh lights.
+        std::vector<uint32_t>                   mUpdatedLights;         ///< List of mesh lights whose transform changed in the last call to update().
         uint32_t                                mTriangleCount = 0;     ///< Total number of triangles in all mesh lights (= mMeshLightTriangles.size()). This may include culled triangles.
 
         mutable std::vector<MeshLightTriangle>  mMeshLightTriangles;    ///< List of all pre-processed mesh light triangles.
+        std::vector<bool>                       mHasCPUGeometry;        ///< Per mesh light flag indicating if the triangle geometry is computed on the CPU.
+        std::vector<uint32_t>                   mGPUTriangleDataLights; ///< List of mesh lights whose triangle geometry is only available on the GPU (dynamic geometry or no CPU-side scene data).
+        std::vector<uint32_t>                   mGPUFluxDataLights;     ///< List of mesh lights whose flux is only available on the GPU (textured emission or GPU-only geometry).
         mutable std::vector<uint32_t>           mActiveTriangleList;    ///< List of active (non-culled) emissive triangles.
         mutable std::vector<uint32_t>           mTriToActiveList;       ///< Mapping of all light triangles to index in mActiveTriangleList.
 
@@ -170,8 +197,15 @@ namespace Falcor
         ref<Buffer>                             mpMeshData;             ///< Per-mesh data for emissive meshes (mMeshLights.size() elements).
         ref<Buffer>                             mpPerMeshInstanceOffset; ///< Per-mesh instance offset into emissive triangles array (Scene::getMeshInstanceCount() elements).
 
-        mutable ref<Buffer>                     mpStagingBuffer;        ///< Staging buffer used for retrieving the vertex positions, texture coordinates and light IDs from the GPU.
-        ref<Fence>                              mpStagingFence;         ///< Fence used for waiting on the staging buffer being filled in.
+        struct StagingBuffer
+        {
+            ref<Buffer>                         pBuffer;                ///< Readback buffer with the same layout as the triangle data followed by the flux data.
+            uint64_t                            fenceValue = 0;         ///< Fence value signaled when the copy to the buffer has completed.
+        };
+
+        mutable std::array<StagingBuffer, 2>    mStagingBuffers;        ///< Double-buffered staging buffers used for retrieving GPU-produced triangle and flux data.
+        mutable uint32_t                        mStagingIndex = 0;      ///< Index of the staging buffer holding the most recently scheduled copy.
+        ref<Fence>                              mpStagingFence;         ///< Fence used for tracking the copies to the staging buffers.
 
         ref<Sampler>                            mpSamplerState;         ///< Material sampler for emissive textures.
 
@@ -581,6 +581,16 @@ namespace Falcor
         return (*this) == (*other);
     }
 
+    size_t BasicMaterial::getContentHash() const
+    {
+        // Hash a subset of the fields compared in operator==() to separate materials sharing the same textures.
+        size_t hash = Material::getContentHash();
+        hashCombine(hash, mData.flags);
+        hashCombine(hash, mData.emissiveFactor);
+        hashCombine(hash, (float4)mData.baseColor);
+        return hash;
+    }
+
     bool BasicMaterial::operator==(const BasicMaterial& other) const
     {
         if (!isBaseEqual(other)) return false;
@@ -247,6 +247,14 @@ namespace Falcor
         return nullptr;
     }
 
+    void Material::setName(const std::string& name)
+    {
+        mName = name;
+
+        // Notify the material system without marking any updates, so that it can track the name change.
+        if (mUpdateCallback) mUpdateCallback(UpdateFlags::None);
+    }
+
     void Material::markUpdates(UpdateFlags updates)
     {
         // Mark updates locally in this material.
@@ -328,6 +336,20 @@ namespace Falcor
         return true;
     }
 
+    size_t Material::getContentHash() const
+    {
+        // Only hash data compared by isBaseEqual(). Materials that compare equal must produce the same hash.
+        size_t hash = 0;
+        hashCombine(hash, mHeader.packedData);
+
+        for (size_t i = 0; i < mTextureSlotData.size(); i++)
+        {
+            if (hasTextureSlot((TextureSlot)i)) hashCombine(hash, mTextureSlotData[i].pTexture);
+        }
+
+        return hash;
+    }
+
     NormalMapType Material::detectNormalMapType(const ref<Texture>& pNormalMap)
     {
         NormalMapType type = NormalMapType::None;
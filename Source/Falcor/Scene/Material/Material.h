@@ -129,8 +129,9 @@ namespace Falcor
         virtual Material::UpdateFlags update(MaterialSystem* pOwner) = 0;
 
         /** Set the material name.
+            This notifies the material system with an empty set of update flags, as the name does not affect rendering.
         */
-        virtual void setName(const std::string& name) { mName = name; }
+        virtual void setName(const std::string& name);
 
         /** Get the material name.
         */
@@ -163,6 +164,13 @@ namespace Falcor
         */
         virtual bool isEqual(const ref<Material>& pOther) const = 0;
 
+        /** Compute a hash of the material content.
+            The hash is consistent with isEqual(): materials that compare equal have identical hashes.
+            The name is not included. Derived classes may include additional properties to reduce collisions.
+            \return Hash value.
+        */
+        virtual size_t getContentHash() const;
+
         /** Set the double-sided flag. This flag doesn't affect the cull state, just the shading.
         */
         virtual void setDoubleSided(bool doubleSided);
@@ -361,6 +369,12 @@ namespace Falcor
         void updateDefaultTextureSamplerID(MaterialSystem* pOwner, const ref<Sampler>& pSampler);
         bool isBaseEqual(const Material& other) const;
 
+        template<typename T>
+        static void hashCombine(size_t& hash, const T& value)
+        {
+            hash ^= std::hash<T>()(value) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        }
+
         static NormalMapType detectNormalMapType(const ref<Texture>& pNormalMap);
 
         template<typename T>
@@ -32,6 +32,7 @@
 #include "Utils/StringUtils.h"
 #include "MaterialTypeRegistry.h"
 #include "Scene/Lights/LightProfile.h"
+#include <algorithm>
 #include <numeric>
 
 namespace Falcor
@@ -226,9 +227,9 @@ namespace Falcor
         FALCOR_CHECK(pMaterial != nullptr, "'pMaterial' is missing");
 
         // Reuse previously added materials.
-        if (auto it = std::find(mMaterials.begin(), mMaterials.end(), pMaterial); it != mMaterials.end())
+        if (auto it = mMaterialIDs.find(pMaterial.get()); it != mMaterialIDs.end())
         {
-            return MaterialID{(size_t)std::distance(mMaterials.begin(), it) };
+            return it->second;
         }
 
         // Add material.
@@ -238,12 +239,7 @@ namespace Falcor
         }
         const MaterialID materialID{ mMaterials.size() };
 
-        if (pMaterial->getDefaultTextureSampler() == nullptr)
-        {
-            pMaterial->setDefaultTextureSampler(mpDefaultTextureSampler);
-        }
-
-        pMaterial->registerUpdateCallback([this](auto flags) { mMaterialUpdates |= flags; });
+        registerMaterial(materialID, pMaterial);
         mMaterials.push_back(pMaterial);
         mMaterialsChanged = true;
 
@@ -265,6 +261,7 @@ namespace Falcor
         mpTextureManager->removeTextures(material.get());
 
         // Remove the material.
+        unregisterMaterial(materialID);
         mMaterials[materialID.get()] = nullptr;
         mMaterialsChanged = true;
     }
@@ -277,14 +274,8 @@ namespace Falcor
         // Remove the previous material.
         removeMaterial(materialID);
 
-        // Prepare replacement material.
-        if (pReplacement->getDefaultTextureSampler() == nullptr)
-        {
-            pReplacement->setDefaultTextureSampler(mpDefaultTextureSampler);
-        }
-        pReplacement->registerUpdateCallback([this](auto flags) { mMaterialUpdates |= flags; });
-
         // Replace the material.
+        registerMaterial(materialID, pReplacement);
         mMaterials[materialID.get()] = pReplacement;
         mMaterialsChanged = true;
     }
@@ -294,10 +285,9 @@ namespace Falcor
         FALCOR_CHECK(pMaterial != nullptr, "'pMaterial' is missing");
 
         // Find material to replace.
-        if (auto it = std::find(mMaterials.begin(), mMaterials.end(), pMaterial); it != mMaterials.end())
+        if (auto it = mMaterialIDs.find(pMaterial.get()); it != mMaterialIDs.end())
         {
-            auto materialID = MaterialID{ (size_t)std::distance(mMaterials.begin(), it) };
-            replaceMaterial(materialID, pReplacement);
+            replaceMaterial(it->second, pReplacement);
         }
         else
         {
@@ -338,39 +328,50 @@ namespace Falcor
 
     ref<Material> MaterialSystem::getMaterialByName(const std::string& name) const
     {
-        for (const auto& pMaterial : mMaterials)
-        {
-            if (pMaterial->getName() == name) return pMaterial;
-        }
-        return nullptr;
+        updateNameIndex();
+        auto it = mNameIndex.find(name);
+        return it != mNameIndex.end() ? mMaterials[it->second.get()] : nullptr;
     }
 
     size_t MaterialSystem::removeDuplicateMaterials(std::vector<MaterialID>& idMap)
     {
         std::vector<ref<Material>> uniqueMaterials;
+        std::unordered_map<size_t, std::vector<MaterialID>> uniqueMaterialsByHash;
         idMap.resize(mMaterials.size());
 
         // Find unique set of materials.
+        // Materials are bucketed by content hash, so isEqual() is only called for materials with colliding hashes.
         for (MaterialID id{ 0 }; id.get() < mMaterials.size(); ++id)
         {
             const auto& pMaterial = mMaterials[id.get()];
-            auto it = std::find_if(uniqueMaterials.begin(), uniqueMaterials.end(), [&pMaterial](const auto& m) { return m->isEqual(pMaterial); });
-            if (it == uniqueMaterials.end())
+            auto& bucket = uniqueMaterialsByHash[pMaterial->getContentHash()];
+            auto it = std::find_if(bucket.begin(), bucket.end(), [&](MaterialID uniqueID) { return uniqueMaterials[uniqueID.get()]->isEqual(pMaterial); });
+            if (it == bucket.end())
             {
                 idMap[id.get()] = MaterialID{ uniqueMaterials.size() };
+                bucket.push_back(idMap[id.get()]);
                 uniqueMaterials.push_back(pMaterial);
             }
             else
             {
-                logInfo("Removing duplicate material '{}' (duplicate of '{}').", pMaterial->getName(), (*it)->getName());
-                idMap[id.get()] = MaterialID{ (size_t)std::distance(uniqueMaterials.begin(), it) };
+                logInfo("Removing duplicate material '{}' (duplicate of '{}').", pMaterial->getName(), uniqueMaterials[it->get()]->getName());
+                idMap[id.get()] = *it;
             }
         }
 
         size_t removed = mMaterials.size() - uniqueMaterials.size();
         if (removed > 0)
         {
-            mMaterials = uniqueMaterials;
+            // Stop tracking updates of the removed duplicates.
+            for (MaterialID id{ 0 }; id.get() < mMaterials.size(); ++id)
+            {
+                if (uniqueMaterials[idMap[id.get()].get()] != mMaterials[id.get()]) mMaterials[id.get()]->registerUpdateCallback({});
+            }
+
+            mMaterials = std::move(uniqueMaterials);
+            mMaterialIDs.clear();
+            for (MaterialID id{ 0 }; id.get() < mMaterials.size(); ++id) mMaterialIDs[mMaterials[id.get()].get()] = id;
+            mNameIndexDirty = true;
             mMaterialsChanged = true;
         }
 
@@ -468,12 +469,12 @@ namespace Falcor
         }
 
         // Update all materials.
-        // Do either a full update of all materials with deferred texture loading, or an update of just the dynamic materials.
+        // Do either a full update of all materials, or an update of just the materials that recorded updates and the dynamic materials.
         // We track per-material update flags along with the combined update flags across all materials.
         // Note that materials can record updates in between calls to update() and/or return flags from their update() calls.
         Material::UpdateFlags updateFlags = Material::UpdateFlags::None;
         mMaterialsUpdateFlags.resize(mMaterials.size());
-        std::fill(mMaterialsUpdateFlags.begin(), mMaterialsUpdateFlags.end(), Material::UpdateFlags::None);
+        std::vector<MaterialID> updatedMaterialIDs;
 
         auto updateMaterial = [&](const MaterialID materialID) {
             auto& pMaterial = getMaterial(materialID);
@@ -482,10 +483,11 @@ namespace Falcor
             Material::UpdateFlags flags = pMaterial->update(this);
             // Record update flags.
             mMaterialsUpdateFlags[materialID.get()] = flags;
+            updatedMaterialIDs.push_back(materialID);
             updateFlags |= flags;
         };
 
-        if (forceUpdate || mMaterialUpdates != Material::UpdateFlags::None)
+        if (forceUpdate)
         {
             mpTextureManager->beginDeferredLoading();
 
@@ -496,8 +498,21 @@ namespace Falcor
         }
         else
         {
-            for (const auto& materialID : mDynamicMaterialIDs)
+            std::vector<MaterialID> materialIDs = mDynamicMaterialIDs;
+            for (const Material* pMaterial : mDirtyMaterials)
+            {
+                if (auto it = mMaterialIDs.find(pMaterial); it != mMaterialIDs.end()) materialIDs.push_back(it->second);
+            }
+            std::sort(materialIDs.begin(), materialIDs.end());
+            materialIDs.erase(std::unique(materialIDs.begin(), materialIDs.end()), materialIDs.end());
+
+            const bool deferredLoading = !mDirtyMaterials.empty();
+            if (deferredLoading) mpTextureManager->beginDeferredLoading();
+
+            for (const auto& materialID : materialIDs)
                 updateMaterial(materialID);
+
+            if (deferredLoading) mpTextureManager->endDeferredLoading();
         }
 
         if (reupdateMetadata)
@@ -516,6 +531,13 @@ namespace Falcor
         // After this point no more material changes are expected.
         updateFlags |= mMaterialUpdates;
         mMaterialUpdates = Material::UpdateFlags::None;
+        mDirtyMaterials.clear();
+
+        // Update the resident mip levels of streamed textures. Replaced textures need to be rebound.
+        if (mpTextureManager->updateResidency(mpDevice->getRenderContext()))
+        {
+            updateFlags |= Material::UpdateFlags::ResourcesChanged;
+        }
 
         // Create parameter block if needed.
         if (!mpMaterialsBlock)
@@ -530,13 +552,18 @@ namespace Falcor
         }
 
         // Upload all modified materials.
-        if (forceUpdate || is_set(updateFlags, Material::UpdateFlags::DataChanged))
+        if (forceUpdate)
         {
             for (uint32_t materialID = 0; materialID < (uint32_t)mMaterials.size(); ++materialID)
+                uploadMaterial(materialID);
+        }
+        else if (is_set(updateFlags, Material::UpdateFlags::DataChanged))
+        {
+            for (const auto& materialID : updatedMaterialIDs)
             {
-                if (forceUpdate || is_set(mMaterialsUpdateFlags[materialID], Material::UpdateFlags::DataChanged))
+                if (is_set(mMaterialsUpdateFlags[materialID.get()], Material::UpdateFlags::DataChanged))
                 {
-                    uploadMaterial(materialID);
+                    uploadMaterial((uint32_t)materialID.get());
                 }
             }
         }
@@ -809,4 +836,55 @@ namespace Falcor
         FALCOR_ASSERT(mpMaterialDataBuffer);
         mpMaterialDataBuffer->setElement(materialID, pMaterial->getDataBlob());
     }
+
+    void MaterialSystem::registerMaterial(const MaterialID materialID, const ref<Material>& pMaterial)
+    {
+        if (pMaterial->getDefaultTextureSampler() == nullptr)
+        {
+            pMaterial->setDefaultTextureSampler(mpDefaultTextureSampler);
+        }
+
+        // Track updates per material so that update() only needs to visit materials that changed.
+        // Materials report an empty set of update flags when renamed.
+        const Material* pKey = pMaterial.get();
+        pMaterial->registerUpdateCallback([this, pKey](auto flags) {
+            if (flags == Material::UpdateFlags::None)
+            {
+                mNameIndexDirty = true;
+                return;
+            }
+            mMaterialUpdates |= flags;
+            mDirtyMaterials.insert(pKey);
+        });
+
+        mMaterialIDs[pKey] = materialID;
+
+        // Materials are appended with increasing IDs, so the name index can be extended in place.
+        // Replaced materials may use a lower ID than an existing material of the same name.
+        if (materialID.get() < mMaterials.size()) mNameIndexDirty = true;
+        else if (!mNameIndexDirty) mNameIndex.emplace(pMaterial->getName(), materialID);
+    }
+
+    void MaterialSystem::unregisterMaterial(const MaterialID materialID)
+    {
+        const auto& pMaterial = mMaterials[materialID.get()];
+        if (!pMaterial) return;
+
+        pMaterial->registerUpdateCallback({});
+        mMaterialIDs.erase(pMaterial.get());
+        mDirtyMaterials.erase(pMaterial.get());
+        mNameIndexDirty = true;
+    }
+
+    void MaterialSystem::updateNameIndex() const
+    {
+        if (!mNameIndexDirty) return;
+
+        mNameIndex.clear();
+        for (MaterialID id{ 0 }; id.get() < mMaterials.size(); ++id)
+        {
+            if (const auto& pMaterial = mMaterials[id.get()]) mNameIndex.emplace(pMaterial->getName(), id);
+        }
+        mNameIndexDirty = false;
+    }
 }
@@ -39,6 +39,9 @@
 #include <memory>
 #include <vector>
 #include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace Falcor
 {
@@ -229,11 +232,13 @@ namespace Falcor
         const ref<Material>& getMaterial(const MaterialID materialID) const;
 
         /** Get a material by name.
+            If several materials share the name, the one with the lowest ID is returned.
             \return The material, or nullptr if material doesn't exist.
         */
         ref<Material> getMaterialByName(const std::string& name) const;
 
         /** Remove all duplicate materials.
+            Materials are bucketed by their content hash and only compared with isEqual() within a bucket.
             \param[in] idMap Vector that holds for each material the ID of the material that replaces it.
             \return The number of materials removed.
         */
@@ -261,11 +266,18 @@ namespace Falcor
         void updateUI();
         void createParameterBlock();
         void uploadMaterial(const uint32_t materialID);
+        void registerMaterial(const MaterialID materialID, const ref<Material>& pMaterial);
+        void unregisterMaterial(const MaterialID materialID);
+        void updateNameIndex() const;
 
         ref<Device> mpDevice;
 
         std::vector<ref<Material>> mMaterials;                      ///< List of all materials.
         std::vector<Material::UpdateFlags> mMaterialsUpdateFlags;   ///< List of all material update flags, after the update() calls
+        std::unordered_map<const Material*, MaterialID> mMaterialIDs; ///< Map from material to material ID.
+        std::unordered_set<const Material*> mDirtyMaterials;        ///< Materials that recorded updates since last update.
+        mutable std::unordered_map<std::string, MaterialID> mNameIndex; ///< Map from material name to the lowest material ID using it.
+        mutable bool mNameIndexDirty = false;                       ///< Flag indicating if the name index needs to be rebuilt.
         std::unique_ptr<TextureManager> mpTextureManager;           ///< Texture manager holding all material textures.
         ProgramDesc::ShaderModuleList mShaderModules;                   ///< Shader modules for all materials in use.
         std::map<MaterialType, TypeConformanceList> mTypeConformances; ///< Type conformances for each material type in use.
@@ -40,7 +40,6 @@ namespace Falcor
         const std::string kSDFCountSurfaceVoxelsShaderName = "Scene/SDFs/SDFSurfaceVoxelCounter.cs.slang";
         const std::string kSDFSVOBuildLevelFromTextureShaderName = "Scene/SDFs/SparseVoxelOctree/SDFSVOBuildLevelFromTexture.cs.slang";
         const std::string kSDFSVOBuildOctreeFromLevelsShaderName = "Scene/SDFs/SparseVoxelOctree/SDFSVOBuildOctreeFromLevels.cs.slang";
-        const std::string kSDFSVOLocationCodeSorterShaderName = "Scene/SDFs/SparseVoxelOctree/SDFSVOLocationCodeSorter.cs.slang";
         const std::string kSDFSVOWriteSVOOffsetsShaderName = "Scene/SDFs/SparseVoxelOctree/SDFSVOWriteSVOOffsets.cs.slang";
         const std::string kSDFSVOBuildOctreeShaderName = "Scene/SDFs/SparseVoxelOctree/SDFSVOBuildOctree.cs.slang";
 
@@ -242,70 +241,9 @@ namespace Falcor
 
         // Sort the location codes.
         {
-            const uint32_t kLocationCodeSorterMaxGroupSize = 128;
-            const uint32_t kSDFSVOLocationCodeLocalBMS = 0;
-            const uint32_t kSDFSVOLocationCodeLocalDisperse = 1;
-            const uint32_t kSDFSVOLocationCodeBigFlip = 2;
-            const uint32_t kSDFSVOLocationCodeBigDisperse = 3;
-
-            uint32_t groupSize = std::min(kLocationCodeSorterMaxGroupSize, hashTableCapacity >> 1);
-
-            if (!mpSortLocationCodesPass)
-            {
-                DefineList definesList;
-                definesList.add("GROUP_SIZE", std::to_string(groupSize));
-                definesList.add("BUFFER_SIZE", std::to_string(hashTableCapacity));
-                definesList.add("LOCAL_BMS", std::to_string(kSDFSVOLocationCodeLocalBMS));
-                definesList.add("LOCAL_DISPERSE", std::to_string(kSDFSVOLocationCodeLocalDisperse));
-                definesList.add("BIG_FLIP", std::to_string(kSDFSVOLocationCodeBigFlip));
-                definesList.add("BIG_DISPERSE", std::to_string(kSDFSVOLocationCodeBigDisperse));
-
-                ProgramDesc desc;
-                desc.addShaderLibrary(kSDFSVOLocationCodeSorterShaderName).csEntry("main");
-                mpSortLocationCodesPass = ComputePass::create(mpDevice, desc, definesList);
-            }
-            else
-            {
-                mpSortLocationCodesPass->addDefine("GROUP_SIZE", std::to_string(groupSize));
-                mpSortLocationCodesPass->addDefine("BUFFER_SIZE", std::to_string(hashTableCapacity));
-            }
-
-            auto rootVar = mpSortLocationCodesPass->getRootVar();
-            auto cbVar = rootVar["CB"];
-            rootVar["gBuffer"] = mpLocationCodesBuffer;
-            uint32_t dispatchSize = hashTableCapacity >> 1;
-
-            // Dispatch a local bitonic merge sort (BMS) that will sort as many elements as possible in group memory.
+            if (!mpRadixSort) mpRadixSort = std::make_unique<RadixSort>(mpDevice);
             pRenderContext->uavBarrier(mpLocationCodesBuffer.get());
-            uint32_t doubleGroupSize = groupSize << 1;
-            cbVar["gComparisonHeight"] = doubleGroupSize;
-            cbVar["gAlgorithm"] = kSDFSVOLocationCodeLocalBMS;
-            mpSortLocationCodesPass->execute(pRenderContext, dispatchSize, 1);
-
-            for (uint32_t comparisonHeight = doubleGroupSize << 1; comparisonHeight <= hashTableCapacity; comparisonHeight <<= 1)
-            {
-                // All flips after the first local BMS step are big e.g., they cannot fit inside a single dispatch.
-                cbVar["gComparisonHeight"] = comparisonHeight;
-                cbVar["gAlgorithm"] = kSDFSVOLocationCodeBigFlip;
-                mpSortLocationCodesPass->execute(pRenderContext, dispatchSize, 1);
-
-                for (uint32_t disperseComparisonHeight = comparisonHeight >> 1; disperseComparisonHeight > 1; disperseComparisonHeight >>= 1)
-                {
-                    cbVar["gComparisonHeight"] = disperseComparisonHeight;
-
-                    if (disperseComparisonHeight <= doubleGroupSize)
-                    {
-                        // We can fit all the next disperse steps into a single dispatch, dispatch it then stop disperses.
-                        cbVar["gAlgorithm"] = kSDFSVOLocationCodeLocalDisperse;
-                        mpSortLocationCodesPass->execute(pRenderContext, dispatchSize, 1);
-                        break;
-                    }
-
-                    // Dispatch big disperse step.
-                    cbVar["gAlgorithm"] = kSDFSVOLocationCodeBigDisperse;
-                    mpSortLocationCodesPass->execute(pRenderContext, dispatchSize, 1);
-                }
-            }
+            mpRadixSort->execute(pRenderContext, mpLocationCodesBuffer, nullptr, hashTableCapacity, RadixSort::KeyType::Uint64);
         }
 
         // Copy child count from staging buffer to CPU.
@@ -380,7 +318,7 @@ namespace Falcor
             mpCountSurfaceVoxelsPass.reset();
             mpBuildFinestLevelFromDistanceTexturePass.reset();
             mpBuildLevelFromDistanceTexturePass.reset();
-            mpSortLocationCodesPass.reset();
+            mpRadixSort.reset();
             mpWriteSVOOffsetsPass.reset();
             mpBuildOctreePass.reset();
             mpSDFGridTexture.reset();
@@ -31,6 +31,8 @@
 #include "Core/API/Buffer.h"
 #include "Core/API/Texture.h"
 #include "Core/Pass/ComputePass.h"
+#include "Utils/Algorithm/RadixSort.h"
+#include <memory>
 
 namespace Falcor
 {
@@ -81,11 +83,11 @@ namespace Falcor
         ref<ComputePass> mpCountSurfaceVoxelsPass;
         ref<ComputePass> mpBuildFinestLevelFromDistanceTexturePass;
         ref<ComputePass> mpBuildLevelFromDistanceTexturePass;
-        ref<ComputePass> mpSortLocationCodesPass;
         ref<ComputePass> mpWriteSVOOffsetsPass;
         ref<ComputePass> mpBuildOctreePass;
 
         // Scratch data used for building.
+        std::unique_ptr<RadixSort> mpRadixSort;
         ref<Texture> mpSDFGridTexture;
         ref<Buffer> mpSurfaceVoxelCounter;
         ref<Buffer> mpSurfaceVoxelCounterStagingBuffer;
@@ -50,6 +50,7 @@
 #include "Utils/NumericRange.h"
 
 #include <fstream>
+#include <limits>
 #include <numeric>
 #include <sstream>
 #include <algorithm>
@@ -64,7 +65,7 @@ namespace Falcor
     namespace
     {
         // Large scenes are split into multiple BLAS groups in order to reduce build memory usage.
-        // The target is max 0.5GB intermediate memory per BLAS group. Note that this is not a strict limit.
+        // The target is max 0.5GB memory per BLAS group, including the compacted BLASes. Note that this is not a strict limit.
         const size_t kMaxBLASBuildMemory = 1ull << 29;
 
         const std::string kParameterBlockName = "gScene";
@@ -186,6 +187,7 @@ namespace Falcor
         mGeometryInstanceData.insert(std::end(mGeometryInstanceData), std::begin(sceneData.sdfGridInstances), std::end(sceneData.sdfGridInstances));
 
         mMeshDesc = std::move(sceneData.meshDesc);
+        mMeshletDesc = std::move(sceneData.meshletDesc);
         mMeshNames = std::move(sceneData.meshNames);
         mMeshBBs = std::move(sceneData.meshBBs);
         mMeshIdToInstanceIds = std::move(sceneData.meshIdToInstanceIds);
@@ -194,6 +196,9 @@ namespace Falcor
         mUseCompressedHitInfo = sceneData.useCompressedHitInfo;
         mHas16BitIndices = sceneData.has16BitIndices;
         mHas32BitIndices = sceneData.has32BitIndices;
+        mSceneStats.deduplicatedMeshCount = sceneData.deduplicatedMeshCount;
+        mSceneStats.deduplicatedMeshMemoryInBytes = sceneData.deduplicatedMeshMemoryInBytes;
+        mSceneStats.meshletCount = mMeshletDesc.size();
 
         mCurveDesc = std::move(sceneData.curveDesc);
         mCurveBBs = std::move(sceneData.curveBBs);
@@ -1747,6 +1752,56 @@ namespace Falcor
         return flags;
     }
 
+    void Scene::requestStreamedTextureMips()
+    {
+        TextureManager& textureManager = mpMaterials->getTextureManager();
+        const auto& residencyOptions = textureManager.getResidencyOptions();
+        if (!residencyOptions.enabled || mCameras.empty()) return;
+
+        // Estimate the screen size of each material from the bounding spheres of the instances using it.
+        // This assumes that the textures cover each instance once and ignores occlusion and the view frustum.
+        const auto& pCamera = getCamera();
+        const float pixelsPerUnit = residencyOptions.screenHeight * pCamera->getFocalLength() / pCamera->getFrameHeight();
+        const float3 cameraPos = pCamera->getPosition();
+        const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
+
+        std::vector<float> screenSizes(getMaterialCount(), 0.f);
+        for (const auto& inst : mGeometryInstanceData)
+        {
+            AABB bounds;
+            switch (inst.getType())
+            {
+            case GeometryType::TriangleMesh:
+            case GeometryType::DisplacedTriangleMesh:
+                bounds = mMeshBBs[inst.geometryID].transform(globalMatrices[inst.globalMatrixID]);
+                break;
+            case GeometryType::Curve:
+                bounds = mCurveBBs[inst.geometryID].transform(globalMatrices[inst.globalMatrixID]);
+                break;
+            default:
+                continue;
+            }
+            if (!bounds.valid()) continue;
+
+            // Instances containing the camera need the most detailed mip level.
+            const float radius = bounds.radius();
+            const float distance = length(bounds.center() - cameraPos) - radius;
+            const float screenSize = distance > 0.f ? 2.f * radius * pixelsPerUnit / distance : std::numeric_limits<float>::infinity();
+            screenSizes[inst.materialID] = std::max(screenSizes[inst.materialID], screenSize);
+        }
+
+        for (uint32_t materialID = 0; materialID < screenSizes.size(); ++materialID)
+        {
+            if (screenSizes[materialID] <= 0.f) continue;
+            const auto& pMaterial = getMaterial(MaterialID(materialID));
+            for (uint32_t slot = 0; slot < (uint32_t)Material::TextureSlot::Count; ++slot)
+            {
+                if (auto pTexture = pMaterial->getTexture(Material::TextureSlot(slot)))
+                    textureManager.requestTextureScreenSize(pTexture.get(), screenSizes[materialID]);
+            }
+        }
+    }
+
     IScene::UpdateFlags Scene::updateMaterials(bool forceUpdate)
     {
         // Update material system.
@@ -1843,6 +1898,7 @@ namespace Falcor
 
         // Perform updates that may affect the scene defines.
         updateGeometryTypes();
+        requestStreamedTextureMips();
         mUpdates |= updateMaterials(false);
 
         // Update scene defines.
@@ -2167,6 +2223,9 @@ namespace Falcor
                 << "  Vertex buffer memory: " << formatByteSize(s.vertexMemoryInBytes) << std::endl
                 << "  Geometry data memory: " << formatByteSize(s.geometryMemoryInBytes) << std::endl
                 << "  Animation data memory: " << formatByteSize(s.animationMemoryInBytes) << std::endl
+                << "  Deduplicated mesh count: " << s.deduplicatedMeshCount << " (dedup ratio: " << (s.meshCount > 0 ? (double)(s.meshCount + s.deduplicatedMeshCount) / s.meshCount : 1.0) << ")" << std::endl
+                << "  Deduplicated mesh memory: " << formatByteSize(s.deduplicatedMeshMemoryInBytes) << std::endl
+                << "  Meshlet count: " << s.meshletCount << std::endl
                 << "  Curve count: " << s.curveCount << std::endl
                 << "  Curve instance count: " << s.curveInstanceCount << std::endl
                 << "  Unique curve segment count: " << s.uniqueCurveSegmentCount << std::endl
@@ -2689,6 +2748,12 @@ namespace Falcor
         mBlasUpdateMode = mode;
     }
 
+    void Scene::setBlasGroupingPolicy(BlasGrouping::Policy policy)
+    {
+        if (policy != mBlasGroupingPolicy) mRebuildBlas = true;
+        mBlasGroupingPolicy = policy;
+    }
+
     void Scene::createDrawList()
     {
         if (!mpMeshVao)
@@ -3105,45 +3170,49 @@ namespace Falcor
 
     void Scene::computeBlasGroups()
     {
+        std::vector<BlasGrouping::BlasInfo> blasInfos(mBlasData.size());
+        for (size_t blasId = 0; blasId < mBlasData.size(); blasId++)
+        {
+            const auto& blas = mBlasData[blasId];
+            auto& info = blasInfos[blasId];
+            info.resultByteSize = blas.resultByteSize;
+            info.scratchByteSize = blas.scratchByteSize;
+            info.useCompaction = blas.useCompaction;
+            info.isUpdated = blas.hasDynamicGeometry() || blas.hasProceduralPrimitives;
+        }
+
+        BlasGrouping::Options options;
+        options.policy = mBlasGroupingPolicy;
+        options.maxGroupByteSize = kMaxBLASBuildMemory;
+        options.compactionRatio = mBlasCompactionRatio;
+        BlasGrouping::Result grouping = BlasGrouping::compute(blasInfos, options);
+
         mBlasGroups.clear();
-        uint64_t groupSize = 0;
+        mBlasGroups.resize(grouping.groups.size());
+        for (size_t blasGroupIndex = 0; blasGroupIndex < mBlasGroups.size(); blasGroupIndex++)
+        {
+            auto& group = mBlasGroups[blasGroupIndex];
+            group.blasIndices = std::move(grouping.groups[blasGroupIndex].blasIndices);
+            group.resultByteSize = grouping.groups[blasGroupIndex].resultByteSize;
+            group.scratchByteSize = grouping.groups[blasGroupIndex].scratchByteSize;
+        }
 
         for (uint32_t blasId = 0; blasId < mBlasData.size(); blasId++)
         {
             auto& blas = mBlasData[blasId];
-            size_t blasSize = blas.resultByteSize + blas.scratchByteSize;
-
-            // Start new BLAS group on first iteration or if group size would exceed the target.
-            if (groupSize == 0 || groupSize + blasSize > kMaxBLASBuildMemory)
-            {
-                mBlasGroups.push_back({});
-                groupSize = 0;
-            }
-
-            // Add BLAS to current group.
-            FALCOR_ASSERT(mBlasGroups.size() > 0);
-            auto& group = mBlasGroups.back();
-            group.blasIndices.push_back(blasId);
-            blas.blasGroupIndex = (uint32_t)mBlasGroups.size() - 1;
-
-            // Update data offsets and sizes.
-            blas.resultByteOffset = group.resultByteSize;
-            blas.scratchByteOffset = group.scratchByteSize;
-            group.resultByteSize += blas.resultByteSize;
-            group.scratchByteSize += blas.scratchByteSize;
-
-            groupSize += blasSize;
+            blas.blasGroupIndex = grouping.groupIndices[blasId];
+            blas.resultByteOffset = grouping.resultByteOffsets[blasId];
+            blas.scratchByteOffset = grouping.scratchByteOffsets[blasId];
         }
 
+        logInfo("BLAS build estimated peak memory: {}", formatByteSize(grouping.getPeakByteSize()));
+
         // Validation that all offsets and sizes are correct.
-        uint64_t totalResultSize = 0;
-        uint64_t totalScratchSize = 0;
         std::set<uint32_t> blasIDs;
 
         for (size_t blasGroupIndex = 0; blasGroupIndex < mBlasGroups.size(); blasGroupIndex++)
         {
             uint64_t resultSize = 0;
-            uint64_t scratchSize = 0;
 
             const auto& group = mBlasGroups[blasGroupIndex];
             FALCOR_ASSERT(!group.blasIndices.empty());
@@ -3161,15 +3230,13 @@ namespace Falcor
                 resultSize += blas.resultByteSize;
 
                 FALCOR_ASSERT(blas.scratchByteSize > 0);
-                FALCOR_ASSERT(blas.scratchByteOffset == scratchSize);
-                scratchSize += blas.scratchByteSize;
+                FALCOR_ASSERT(blas.scratchByteOffset + blas.scratchByteSize <= group.scratchByteSize);
 
                 FALCOR_ASSERT(blas.blasByteOffset == 0);
                 FALCOR_ASSERT(blas.blasByteSize == 0);
             }
 
             FALCOR_ASSERT(resultSize == group.resultByteSize);
-            FALCOR_ASSERT(scratchSize == group.scratchByteSize);
         }
         FALCOR_ASSERT(blasIDs.size() == mBlasData.size());
     }
@@ -3432,6 +3499,17 @@ namespace Falcor
                     pRenderContext->uavBarrier(pBlas.get());
                 }
 
+                // Record the compaction ratio to anticipate the final BLAS sizes when grouping BLASes in the next build.
+                uint64_t compactedByteSize = 0;
+                uint64_t uncompactedByteSize = 0;
+                for (const auto& blas : mBlasData)
+                {
+                    if (!blas.useCompaction) continue;
+                    compactedByteSize += blas.blasByteSize;
+                    uncompactedByteSize += blas.resultByteSize;
+                }
+                if (uncompactedByteSize > 0) mBlasCompactionRatio = std::min(1.f, (float)((double)compactedByteSize / uncompactedByteSize));
+
                 // Release scratch buffer if there is no animated content. We will not need it.
                 if (!hasDynamicGeometry && !hasProceduralPrimitives) mpBlasScratch.reset();
             }
@@ -4055,6 +4133,13 @@ namespace Falcor
         mpAnimationController->setNodeEdited(nodeID);
     }
 
+    fstd::span<const MeshletDesc> Scene::getMeshlets(MeshID meshID) const
+    {
+        auto first = std::lower_bound(mMeshletDesc.begin(), mMeshletDesc.end(), meshID.get(), [](const MeshletDesc& m, uint32_t id) { return m.meshID < id; });
+        auto last = std::upper_bound(first, mMeshletDesc.end(), meshID.get(), [](uint32_t id, const MeshletDesc& m) { return id < m.meshID; });
+        return fstd::span<const MeshletDesc>(mMeshletDesc.data() + (first - mMeshletDesc.begin()), size_t(last - first));
+    }
+
     void Scene::getMeshVerticesAndIndices(MeshID meshID, const std::map<std::string, ref<Buffer>>& buffers)
     {
         if (!mpLoadMeshPass)
@@ -4118,6 +4203,9 @@ namespace Falcor
         d["vertexMemoryInBytes"] = stats.vertexMemoryInBytes;
         d["geometryMemoryInBytes"] = stats.geometryMemoryInBytes;
         d["animationMemoryInBytes"] = stats.animationMemoryInBytes;
+        d["deduplicatedMeshCount"] = stats.deduplicatedMeshCount;
+        d["deduplicatedMeshMemoryInBytes"] = stats.deduplicatedMeshMemoryInBytes;
+        d["meshletCount"] = stats.meshletCount;
 
         // Curve stats
         d["curveCount"] = stats.curveCount;
@@ -28,6 +28,7 @@
 #pragma once
 #include "SceneIDs.h"
 #include "SceneTypes.slang"
+#include "BlasGrouping.h"
 #include "HitInfo.h"
 #include "IScene.h"
 #include "Animation/Animation.h"
@@ -57,6 +58,7 @@
 #include "Utils/SplitBuffer.h"
 
 #include <sigs/sigs.h>
+#include <fstd/span.h>
 
 #include <functional>
 #include <memory>
@@ -272,6 +274,9 @@ namespace Falcor
             bool has16BitIndices = false;                           ///< True if 16-bit mesh indices are used.
             bool has32BitIndices = false;                           ///< True if 32-bit mesh indices are used.
             uint32_t meshDrawCount = 0;                             ///< Number of meshes to draw.
+            std::vector<MeshletDesc> meshletDesc;                   ///< List of meshlets, sorted by mesh ID.
+            uint32_t deduplicatedMeshCount = 0;                     ///< Number of meshes merged into instances of identical meshes by the scene builder.
+            uint64_t deduplicatedMeshMemoryInBytes = 0;             ///< Vertex and index memory in bytes saved by mesh deduplication.
 
             /// Vertex indices for all meshes in either 32-bit or 16-bit format packed tightly, decided per mesh.
             SplitIndexBuffer meshIndexData;
@@ -317,6 +322,9 @@ namespace Falcor
             uint64_t vertexMemoryInBytes = 0;           ///< Total memory in bytes used by the vertex buffer.
             uint64_t geometryMemoryInBytes = 0;         ///< Total memory in bytes used by the geometry data (meshes, curves, custom primitives, instances etc.).
             uint64_t animationMemoryInBytes = 0;        ///< Total memory in bytes used by the animation system (transforms, skinning buffers).
+            uint64_t deduplicatedMeshCount = 0;         ///< Number of meshes merged into instances of identical meshes when building the scene.
+            uint64_t deduplicatedMeshMemoryInBytes = 0; ///< Vertex and index memory in bytes saved by mesh deduplication.
+            uint64_t meshletCount = 0;                  ///< Number of meshlets.
 
             // Curve stats
             uint64_t curveCount = 0;                    ///< Number of curves.
@@ -654,6 +662,17 @@ namespace Falcor
         */
         const MeshDesc& getMesh(MeshID meshID) const { return mMeshDesc[meshID.get()]; }
 
+        /** Get the meshlets of all meshes, sorted by mesh ID.
+            Meshlets are only generated when the scene is built with SceneBuilder::Flags::OptimizeMeshLayout.
+        */
+        const std::vector<MeshletDesc>& getMeshlets() const { return mMeshletDesc; }
+
+        /** Get the meshlets of a mesh.
+            \param[in] meshID Mesh ID.
+            \return The meshlets, which are empty if no meshlets were generated for the mesh.
+        */
+        fstd::span<const MeshletDesc> getMeshlets(MeshID meshID) const;
+
         /** Get mesh vertex and index data.
             \param[in] meshID Mesh ID.
             \param[in] buffers Map of buffers containing mesh data: "triangleIndices", "positions", and "texcrds" are required.
@@ -895,6 +914,15 @@ namespace Falcor
         */
         UpdateMode getBlasUpdateMode() { return mBlasUpdateMode; }
 
+        /** Set how the scene's BLASes are organized into groups for building.
+            BLASes are grouped using first-fit-decreasing bin packing by default.
+        */
+        void setBlasGroupingPolicy(BlasGrouping::Policy policy);
+
+        /** Get the policy used for grouping the scene's BLASes for building.
+        */
+        BlasGrouping::Policy getBlasGroupingPolicy() const { return mBlasGroupingPolicy; }
+
         /** Update the scene. Call this once per frame to update the camera location, animations, etc.
             \param[in] pRenderContext The render context.
             \param[in] currentTime The current time in seconds.
@@ -1200,6 +1228,7 @@ namespace Falcor
         IScene::UpdateFlags updateGridVolumes(bool forceUpdate);
         IScene::UpdateFlags updateEnvMap(bool forceUpdate);
         IScene::UpdateFlags updateMaterials(bool forceUpdate);
+        void requestStreamedTextureMips();
         IScene::UpdateFlags updateGeometry(RenderContext* pRenderContext, bool forceUpdate);
         IScene::UpdateFlags updateProceduralPrimitives(bool forceUpdate);
         IScene::UpdateFlags updateRaytracingAABBData(bool forceUpdate);
@@ -1250,6 +1279,7 @@ namespace Falcor
 
         // Triangle meshes
         std::vector<MeshDesc> mMeshDesc;                            ///< Copy of mesh data GPU buffer (mpMeshesBuffer).
+        std::vector<MeshletDesc> mMeshletDesc;                      ///< Meshlets of all meshes, sorted by mesh ID.
         std::vector<std::vector<Rectangle>> mMeshUVTiles;           ///< Bounding tiles for the mesh UVs
         std::vector<MeshGroup> mMeshGroups;                         ///< Groups of meshes. Each group maps to a BLAS for ray tracing.
         std::vector<std::string> mMeshNames;                        ///< Mesh names, indxed by mesh ID
@@ -1364,6 +1394,8 @@ namespace Falcor
         // Raytracing data
         UpdateMode mTlasUpdateMode = UpdateMode::Rebuild;   ///< How the TLAS should be updated when there are changes in the scene.
         UpdateMode mBlasUpdateMode = UpdateMode::Refit;     ///< How the BLAS should be updated when there are changes to meshes.
+        BlasGrouping::Policy mBlasGroupingPolicy = BlasGrouping::Policy::FirstFitDecreasing; ///< How BLASes are organized into groups for building.
+        float mBlasCompactionRatio = 1.f;                   ///< Ratio of compacted to uncompacted size of the compacted BLASes in the last build.
 
         std::vector<RtInstanceDesc> mInstanceDescs;         ///< Shared between TLAS builds to avoid reallocating CPU memory.
 
@@ -1417,7 +1449,7 @@ namespace Falcor
             std::vector<uint32_t> blasIndices;              ///< Indices of all BLASes in the group.
 
             uint64_t resultByteSize = 0;                    ///< Maximum result data size for all BLASes in the group, including padding.
-            uint64_t scratchByteSize = 0;                   ///< Maximum scratch data size for all BLASes in the group, including padding.
+            uint64_t scratchByteSize = 0;                   ///< Scratch data size for the group, including padding. BLASes that are not updated share scratch memory.
             uint64_t finalByteSize = 0;                     ///< Size of the final BLASes in the group post-compaction, including padding.
 
             ref<Buffer> pBlas;                              ///< Buffer containing all final BLASes in the group.
@@ -1451,5 +1483,10 @@ namespace Falcor
         {
             return mMeshStaticData;
         }
+
+        const SplitIndexBuffer& getMeshIndexData() const
+        {
+            return mMeshIndexData;
+        }
     };
 }
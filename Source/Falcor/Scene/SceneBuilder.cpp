@@ -30,9 +30,13 @@
 #include "Importer.h"
 #include "Curves/CurveConfig.h"
 #include "Material/StandardMaterial.h"
+#include "Utils/CryptoUtils.h"
 #include "Utils/Logger.h"
+#include "Utils/StringUtils.h"
+#include "Utils/Geometry/MeshOptimizer.h"
 #include "Utils/Math/Common.h"
 #include "Utils/Image/TextureAnalyzer.h"
+#include "Utils/Image/TextureCache.h"
 #include "Utils/Timing/TimeReport.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "Utils/Math/MathHelpers.h"
@@ -41,7 +45,9 @@
 #include <mikktspace.h>
 #include <filesystem>
 #include <cmath>
+#include <cstring>
 #include <execution>
+#include <map>
 
 namespace Falcor
 {
@@ -55,6 +61,10 @@ namespace Falcor
         // We'll log a warning if the maximum quantization error exceeds this value.
         const float kMaxTexelError = 0.5f;
 
+        // Relative tolerance for matching vertex positions of meshes that only differ by a translation.
+        // Positions are compared relative to the first vertex, which introduces rounding errors on the order of the float epsilon.
+        const float kTranslatedMeshTolerance = 1e-6f;
+
         int largestAxis(const float3& v)
         {
             if (v.x >= v.y && v.x >= v.z) return 0;
@@ -193,7 +203,7 @@ namespace Falcor
 
         SceneCache::Key computeSceneCacheKey(const std::filesystem::path& path, SceneBuilder::Flags buildFlags)
         {
-            SceneBuilder::Flags cacheFlags = buildFlags & (~(SceneBuilder::Flags::UseCache | SceneBuilder::Flags::RebuildCache));
+            SceneBuilder::Flags cacheFlags = buildFlags & (~(SceneBuilder::Flags::UseCache | SceneBuilder::Flags::RebuildCache | SceneBuilder::Flags::UseTextureCache | SceneBuilder::Flags::UseTextureStreaming));
             SHA1 sha1;
             auto pathStr = path.string();
             sha1.update(pathStr.data(), pathStr.size());
@@ -201,6 +211,26 @@ namespace Falcor
             return sha1.finalize();
 
         }
+
+        /** Get the texture cache options from the settings.
+            The cache is configured with the options 'TextureCache:directory', 'TextureCache:maxSizeMB'
+            and 'TextureCache:compression' (None, BC1, BC3 or BC7).
+        */
+        TextureCache::Options getTextureCacheOptions(const Settings& settings)
+        {
+            TextureCache::Options options;
+            options.directory = settings.getOption("TextureCache:directory", std::string());
+            options.maxSizeInBytes = settings.getOption("TextureCache:maxSizeMB", options.maxSizeInBytes >> 20) << 20;
+
+            const std::string compression = settings.getOption("TextureCache:compression", std::string("None"));
+            if (compression == "None") options.compressionMode = ImageIO::CompressionMode::None;
+            else if (compression == "BC1") options.compressionMode = ImageIO::CompressionMode::BC1;
+            else if (compression == "BC3") options.compressionMode = ImageIO::CompressionMode::BC3;
+            else if (compression == "BC7") options.compressionMode = ImageIO::CompressionMode::BC7;
+            else FALCOR_THROW("Invalid texture cache compression mode '{}'. Expected None, BC1, BC3 or BC7.", compression);
+
+            return options;
+        }
     }
 
     SceneBuilder::SceneBuilder(ref<Device> pDevice, const Settings& settings, Flags flags)
@@ -210,6 +240,18 @@ namespace Falcor
     {
         mAssetResolver = AssetResolver::getDefaultResolver();
         mSceneData.pMaterials = std::make_unique<MaterialSystem>(mpDevice);
+
+        if (is_set(flags, Flags::UseTextureCache) || is_set(flags, Flags::UseTextureStreaming))
+        {
+            mSceneData.pMaterials->getTextureManager().setTextureCache(std::make_shared<TextureCache>(getTextureCacheOptions(mSettings)));
+        }
+
+        if (is_set(flags, Flags::UseTextureStreaming))
+        {
+            TextureManager::ResidencyOptions residencyOptions;
+            residencyOptions.enabled = true;
+            mSceneData.pMaterials->getTextureManager().setResidencyOptions(residencyOptions);
+        }
     }
 
     SceneBuilder::SceneBuilder(ref<Device> pDevice, const std::filesystem::path& path, const Settings& settings, Flags flags)
@@ -354,6 +396,7 @@ namespace Falcor
         prepareSceneGraph();
         prepareMeshes();
         removeUnusedMeshes();
+        removeDuplicateMeshes();
         flattenStaticMeshInstances();
         pretransformStaticMeshes();
         unifyTriangleWinding();
@@ -362,6 +405,7 @@ namespace Falcor
         createMeshGroups();
         optimizeGeometry();
         sortMeshes();
+        optimizeMeshLayout();
         createGlobalBuffers();
         createCurveGlobalBuffers();
         collectVolumeGrids();
@@ -1419,51 +1463,202 @@ namespace Falcor
         if (unusedCount > 0)
         {
             logWarning("Scene has {} unused meshes that will be removed.", unusedCount);
+            removeMeshesWithoutInstances();
+        }
+    }
 
-            const size_t meshCount = mMeshes.size();
-            MeshList meshes;
-            meshes.reserve(meshCount);
+    void SceneBuilder::removeDuplicateMeshes()
+    {
+        // This function optionally merges static meshes with identical content into a single mesh, which is
+        // instanced by the scene graph nodes of all the duplicates. Candidates are found by hashing the mesh data
+        // in parallel, and meshes with equal hashes are compared in full before they are merged.
+        // Duplicates that only differ by a translation are optionally merged too, by inserting a translation node.
 
-            for (MeshID meshID{ 0 }; meshID.get() < (uint32_t)meshCount; ++meshID)
-            {
-                auto& mesh = mMeshes[meshID.get()];
-                if (mesh.instances.empty()) continue; // Skip unused meshes
+        const bool matchTranslated = is_set(mFlags, Flags::DeduplicateTranslatedMeshes);
+        if (!is_set(mFlags, Flags::DeduplicateMeshes) && !matchTranslated)
+        {
+            return;
+        }
 
-                // Get new mesh ID.
-                const MeshID newMeshID(meshes.size());
+        if (is_set(mFlags, Flags::FlattenStaticMeshInstances))
+        {
+            logWarning("Mesh deduplication is disabled as it would be reverted by 'FlattenStaticMeshInstances'.");
+            return;
+        }
 
-                // Update the mesh IDs in the scene graph nodes.
-                for (const auto& nodeID : mesh.instances)
+        // Dynamic meshes have separate vertex data per mesh at runtime, and are left as is.
+        auto isCandidate = [](const MeshSpec& mesh)
+        {
+            return !mesh.isDynamic() && mesh.skeletonNodeID == NodeID::Invalid() && !mesh.instances.empty() && !mesh.staticData.empty();
+        };
+
+        // Hash the mesh data. Positions are excluded when matching translated meshes.
+        std::vector<SHA1::MD> hashes(mMeshes.size());
+        auto range = NumericRange<size_t>(0, mMeshes.size());
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](size_t i)
+        {
+            const auto& mesh = mMeshes[i];
+            if (!isCandidate(mesh)) return;
+
+            SHA1 sha1;
+            sha1.update(static_cast<uint32_t>(mesh.topology));
+            sha1.update(mesh.materialId.get());
+            sha1.update(mesh.isFrontFaceCW);
+            sha1.update(mesh.use16BitIndices);
+            sha1.update(mesh.indexCount);
+            sha1.update(mesh.vertexCount);
+            sha1.update(mesh.indexData.data(), mesh.indexData.size() * sizeof(uint32_t));
+            if (matchTranslated)
+            {
+                for (const auto& v : mesh.staticData)
                 {
-                    FALCOR_ASSERT(nodeID.get() < mSceneGraph.size());
-                    auto& node = mSceneGraph[nodeID.get()];
-                    std::replace(node.meshes.begin(), node.meshes.end(), meshID, newMeshID);
+                    sha1.update(&v.normal, sizeof(v.normal));
+                    sha1.update(&v.tangent, sizeof(v.tangent));
+                    sha1.update(&v.texCrd, sizeof(v.texCrd));
+                    sha1.update(v.curveRadius);
                 }
+            }
+            else
+            {
+                sha1.update(mesh.staticData.data(), mesh.staticData.size() * sizeof(StaticVertexData));
+            }
+            hashes[i] = sha1.finalize();
+        });
+
+        // Returns the translation from the canonical mesh to the given mesh if their contents match.
+        auto matchMesh = [matchTranslated](const MeshSpec& canonical, const MeshSpec& mesh) -> std::optional<float3>
+        {
+            if (canonical.topology != mesh.topology || canonical.materialId != mesh.materialId || canonical.isFrontFaceCW != mesh.isFrontFaceCW ||
+                canonical.use16BitIndices != mesh.use16BitIndices || canonical.indexCount != mesh.indexCount ||
+                canonical.indexData != mesh.indexData || canonical.staticData.size() != mesh.staticData.size())
+            {
+                return {};
+            }
+
+            if (!matchTranslated)
+            {
+                bool equal = std::memcmp(canonical.staticData.data(), mesh.staticData.data(), mesh.staticData.size() * sizeof(StaticVertexData)) == 0;
+                return equal ? std::make_optional(float3(0.f)) : std::nullopt;
+            }
+
+            const float3 canonicalOrigin = canonical.staticData[0].position;
+            const float3 origin = mesh.staticData[0].position;
+            for (size_t i = 0; i < mesh.staticData.size(); ++i)
+            {
+                const auto& a = canonical.staticData[i];
+                const auto& b = mesh.staticData[i];
+                float3 scale = max(max(abs(a.position), abs(canonicalOrigin)), max(abs(b.position), abs(origin)));
+                if (any(abs((b.position - origin) - (a.position - canonicalOrigin)) > kTranslatedMeshTolerance * scale)) return {};
+                if (any(a.normal != b.normal) || any(a.tangent != b.tangent) || any(a.texCrd != b.texCrd) || a.curveRadius != b.curveRadius) return {};
+            }
+            return origin - canonicalOrigin;
+        };
+
+        // Find duplicates in mesh order and move their instances to the first matching mesh.
+        std::map<SHA1::MD, std::vector<MeshID>> canonicalMeshes;
+        uint32_t duplicateCount = 0;
+        uint64_t savedMemory = 0;
 
-                // Update the mesh IDs of cached meshes.
-                for (auto &cachedMesh : mSceneData.cachedMeshes)
+        for (MeshID meshID{ 0 }; meshID.get() < (uint32_t)mMeshes.size(); ++meshID)
+        {
+            if (!isCandidate(mMeshes[meshID.get()])) continue;
+
+            auto& candidates = canonicalMeshes[hashes[meshID.get()]];
+            std::optional<float3> translation;
+            MeshID canonicalID;
+            for (MeshID candidateID : candidates)
+            {
+                if ((translation = matchMesh(mMeshes[candidateID.get()], mMeshes[meshID.get()])))
                 {
-                    if (cachedMesh.meshID == meshID) cachedMesh.meshID = newMeshID;
+                    canonicalID = candidateID;
+                    break;
                 }
-                for (auto& cache : mSceneData.cachedCurves)
+            }
+            if (!translation)
+            {
+                candidates.push_back(meshID);
+                continue;
+            }
+
+            // Instance the canonical mesh in the nodes of the duplicate. A child node is added for translated meshes,
+            // or if the node already instances the canonical mesh, as a node references each mesh at most once.
+            auto& mesh = mMeshes[meshID.get()];
+            for (NodeID nodeID : mesh.instances)
+            {
+                auto& nodeMeshes = mSceneGraph[nodeID.get()].meshes;
+                if (all(*translation == float3(0.f)) && std::find(nodeMeshes.begin(), nodeMeshes.end(), canonicalID) == nodeMeshes.end())
                 {
-                    if (cache.tessellationMode != CurveTessellationMode::LinearSweptSphere)
-                    {
-                        if (cache.geometryID == CurveOrMeshID{ meshID }) cache.geometryID = CurveOrMeshID{ newMeshID };
-                    }
+                    std::replace(nodeMeshes.begin(), nodeMeshes.end(), meshID, canonicalID);
+                    mMeshes[canonicalID.get()].instances.insert(nodeID);
+                    continue;
                 }
 
-                meshes.push_back(std::move(mesh));
+                nodeMeshes.erase(std::remove(nodeMeshes.begin(), nodeMeshes.end(), meshID), nodeMeshes.end());
+                NodeID childID = addNode(Node{ mesh.name, math::matrixFromTranslation(*translation), float4x4::identity(), float4x4::identity(), nodeID });
+                mSceneGraph[childID.get()].meshes.push_back(canonicalID);
+                mMeshes[canonicalID.get()].instances.insert(childID);
             }
+            mesh.instances.clear();
+
+            duplicateCount++;
+            savedMemory += mesh.indexData.size() * sizeof(uint32_t) + mesh.staticData.size() * sizeof(PackedStaticVertexData);
+        }
+
+        if (duplicateCount > 0)
+        {
+            logInfo("Merged {} duplicate meshes into instances, saving {} of vertex and index data.", duplicateCount, formatByteSize(savedMemory));
+            removeMeshesWithoutInstances();
+        }
+
+        mSceneData.deduplicatedMeshCount = duplicateCount;
+        mSceneData.deduplicatedMeshMemoryInBytes = savedMemory;
+    }
 
-            mMeshes = std::move(meshes);
+    void SceneBuilder::removeMeshesWithoutInstances()
+    {
+        // Rebuild the mesh list and update the mesh IDs in the scene graph.
+        const size_t meshCount = mMeshes.size();
+        MeshList meshes;
+        meshes.reserve(meshCount);
+
+        for (MeshID meshID{ 0 }; meshID.get() < (uint32_t)meshCount; ++meshID)
+        {
+            auto& mesh = mMeshes[meshID.get()];
+            if (mesh.instances.empty()) continue; // Skip unused meshes
+
+            // Get new mesh ID.
+            const MeshID newMeshID(meshes.size());
+
+            // Update the mesh IDs in the scene graph nodes.
+            for (const auto& nodeID : mesh.instances)
+            {
+                FALCOR_ASSERT(nodeID.get() < mSceneGraph.size());
+                auto& node = mSceneGraph[nodeID.get()];
+                std::replace(node.meshes.begin(), node.meshes.end(), meshID, newMeshID);
+            }
 
-            // Validate scene graph.
-            FALCOR_ASSERT(mMeshes.size() == meshCount - unusedCount);
-            for (const auto& node : mSceneGraph)
+            // Update the mesh IDs of cached meshes.
+            for (auto &cachedMesh : mSceneData.cachedMeshes)
             {
-                for (MeshID meshID : node.meshes) FALCOR_ASSERT_LT(meshID.get(), mMeshes.size());
+                if (cachedMesh.meshID == meshID) cachedMesh.meshID = newMeshID;
             }
+            for (auto& cache : mSceneData.cachedCurves)
+            {
+                if (cache.tessellationMode != CurveTessellationMode::LinearSweptSphere)
+                {
+                    if (cache.geometryID == CurveOrMeshID{ meshID }) cache.geometryID = CurveOrMeshID{ newMeshID };
+                }
+            }
+
+            meshes.push_back(std::move(mesh));
+        }
+
+        mMeshes = std::move(meshes);
+
+        // Validate scene graph.
+        for (const auto& node : mSceneGraph)
+        {
+            for (MeshID meshID : node.meshes) FALCOR_ASSERT_LT(meshID.get(), mMeshes.size());
         }
     }
 
@@ -2414,6 +2609,101 @@ namespace Falcor
         }
     }
 
+    void SceneBuilder::optimizeMeshLayout()
+    {
+        // This function optionally reorders the triangles of static indexed meshes for post-transform vertex cache
+        // locality and the vertices for fetch locality, and splits the meshes into meshlets.
+        // The meshes are processed in parallel. The vertex cache efficiency before and after is logged.
+
+        if (!is_set(mFlags, Flags::OptimizeMeshLayout))
+        {
+            return;
+        }
+
+        if (is_set(mFlags, Flags::NonIndexedVertices))
+        {
+            logWarning("Mesh layout optimization is disabled for non-indexed vertices.");
+            return;
+        }
+
+        std::vector<VertexCacheStats> statsBefore(mMeshes.size());
+        std::vector<VertexCacheStats> statsAfter(mMeshes.size());
+        std::vector<std::vector<Meshlet>> meshlets(mMeshes.size());
+
+        auto range = NumericRange<size_t>(0, mMeshes.size());
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](size_t meshIndex)
+        {
+            auto& mesh = mMeshes[meshIndex];
+
+            // Vertex data of dynamic meshes is referenced by index in animation data, so only static meshes are optimized.
+            if (mesh.topology != Vao::Topology::TriangleList || mesh.indexCount == 0 || mesh.isDynamic()) return;
+
+            std::vector<uint32_t> indices(mesh.indexCount);
+            for (uint32_t i = 0; i < mesh.indexCount; i++) indices[i] = mesh.getIndex(i);
+
+            statsBefore[meshIndex] = analyzeVertexCache(indices, mesh.vertexCount);
+            indices = optimizeVertexCache(indices, mesh.vertexCount);
+            std::vector<uint32_t> remap = optimizeVertexFetch(indices, mesh.vertexCount);
+            statsAfter[meshIndex] = analyzeVertexCache(indices, mesh.vertexCount);
+
+            // Reorder the vertices.
+            std::vector<StaticVertexData> staticData(mesh.staticData.size());
+            for (size_t i = 0; i < remap.size(); i++) staticData[remap[i]] = mesh.staticData[i];
+            mesh.staticData = std::move(staticData);
+
+            std::vector<float3> positions(mesh.staticData.size());
+            for (size_t i = 0; i < positions.size(); i++) positions[i] = mesh.staticData[i].position;
+            meshlets[meshIndex] = buildMeshlets(indices, positions);
+
+            // Store the indices in the original format.
+            if (mesh.use16BitIndices)
+            {
+                uint16_t* pIndices = reinterpret_cast<uint16_t*>(mesh.indexData.data());
+                for (uint32_t i = 0; i < mesh.indexCount; i++) pIndices[i] = (uint16_t)indices[i];
+            }
+            else
+            {
+                mesh.indexData = std::move(indices);
+            }
+        });
+
+        // Create the meshlet descriptors and accumulate the stats over all meshes.
+        VertexCacheStats totalBefore, totalAfter;
+        auto accumulate = [](VertexCacheStats& total, const VertexCacheStats& stats)
+        {
+            total.triangleCount += stats.triangleCount;
+            total.vertexCount += stats.vertexCount;
+            total.transformCount += stats.transformCount;
+        };
+
+        auto& meshletDesc = mSceneData.meshletDesc;
+        FALCOR_ASSERT(meshletDesc.empty());
+        for (size_t meshIndex = 0; meshIndex < mMeshes.size(); meshIndex++)
+        {
+            accumulate(totalBefore, statsBefore[meshIndex]);
+            accumulate(totalAfter, statsAfter[meshIndex]);
+
+            for (const auto& meshlet : meshlets[meshIndex])
+            {
+                MeshletDesc desc;
+                desc.boundsMin = meshlet.bounds.minPoint;
+                desc.boundsMax = meshlet.bounds.maxPoint;
+                desc.meshID = (uint32_t)meshIndex;
+                desc.triangleOffset = meshlet.triangleOffset;
+                desc.triangleCount = meshlet.triangleCount;
+                desc.vertexCount = meshlet.vertexCount;
+                desc.coneAxis = meshlet.coneAxis;
+                desc.coneCutoff = meshlet.coneCutoff;
+                meshletDesc.push_back(desc);
+            }
+        }
+
+        logInfo(
+            "Optimized mesh layout of {} triangles: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}, {} meshlets.",
+            totalAfter.triangleCount, totalBefore.getACMR(), totalAfter.getACMR(), totalBefore.getATVR(), totalAfter.getATVR(), meshletDesc.size()
+        );
+    }
+
     void SceneBuilder::createGlobalBuffers()
     {
         FALCOR_ASSERT(mSceneData.meshIndexData.empty());
@@ -2962,8 +3252,13 @@ namespace Falcor
         flags.value("DontUseDisplacement", SceneBuilder::Flags::DontUseDisplacement);
         flags.value("UseCompressedHitInfo", SceneBuilder::Flags::UseCompressedHitInfo);
         flags.value("TessellateCurvesIntoPolyTubes", SceneBuilder::Flags::TessellateCurvesIntoPolyTubes);
+        flags.value("DeduplicateMeshes", SceneBuilder::Flags::DeduplicateMeshes);
+        flags.value("DeduplicateTranslatedMeshes", SceneBuilder::Flags::DeduplicateTranslatedMeshes);
+        flags.value("OptimizeMeshLayout", SceneBuilder::Flags::OptimizeMeshLayout);
         flags.value("UseCache", SceneBuilder::Flags::UseCache);
         flags.value("RebuildCache", SceneBuilder::Flags::RebuildCache);
+        flags.value("UseTextureCache", SceneBuilder::Flags::UseTextureCache);
+        flags.value("UseTextureStreaming", SceneBuilder::Flags::UseTextureStreaming);
         ScriptBindings::addEnumBinaryOperators(flags);
 
         pybind11::class_<SceneBuilder> sceneBuilder(m, "SceneBuilder");
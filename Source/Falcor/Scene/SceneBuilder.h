@@ -77,9 +77,14 @@ namespace Falcor
             DontUseDisplacement             = 0x4000,   ///< Don't use displacement mapping.
             UseCompressedHitInfo            = 0x8000,   ///< Use compressed hit info (on scenes with triangle meshes only).
             TessellateCurvesIntoPolyTubes   = 0x10000,  ///< Tessellate curves into poly-tubes (the default is linear swept spheres).
+            DeduplicateMeshes               = 0x20000,  ///< Merge static meshes with identical geometry and material into a single instanced mesh.
+            DeduplicateTranslatedMeshes     = 0x40000,  ///< Also merge static meshes whose geometry only differs by a translation. Implies DeduplicateMeshes.
+            OptimizeMeshLayout              = 0x80000,  ///< Reorder triangles and vertices of static meshes for cache locality and generate meshlets.
 
             UseCache                        = 0x10000000, ///< Enable scene caching. This caches the runtime scene representation on disk to reduce load time.
             RebuildCache                    = 0x20000000, ///< Rebuild scene cache.
+            UseTextureCache                 = 0x40000000, ///< Enable texture caching. This caches processed textures including their mip levels on disk to reduce load time.
+            UseTextureStreaming             = 0x08000000, ///< Enable texture streaming. Only the coarse mip levels are loaded upfront, finer mip levels are streamed from the texture cache based on the screen size of the instances using each material. Implies UseTextureCache.
 
             Default = None
         };
@@ -816,6 +821,8 @@ namespace Falcor
         void prepareSceneGraph();
         void prepareMeshes();
         void removeUnusedMeshes();
+        void removeDuplicateMeshes();
+        void removeMeshesWithoutInstances();
         void flattenStaticMeshInstances();
         void optimizeSceneGraph();
         void pretransformStaticMeshes();
@@ -824,6 +831,7 @@ namespace Falcor
         void createMeshGroups();
         void optimizeGeometry();
         void sortMeshes();
+        void optimizeMeshLayout();
         void createGlobalBuffers();
         void createCurveGlobalBuffers();
         void optimizeMaterials();
@@ -43,7 +43,7 @@ namespace Falcor
         /** Specfies the current cache file version.
             This needs to be incremented every time the file format changes!
         */
-        const uint32_t kVersion = 25;
+        const uint32_t kVersion = 27;
 
         /** Scene cache directory (subdirectory in the application data directory).
         */
@@ -348,6 +348,7 @@ namespace Falcor
 
         writeMarker(stream, "Meshes");
         stream.write(sceneData.meshDesc);
+        stream.write(sceneData.meshletDesc);
         stream.write(sceneData.meshNames);
         stream.write(sceneData.meshBBs);
         stream.write(sceneData.meshInstanceData);
@@ -375,6 +376,8 @@ namespace Falcor
         stream.write(sceneData.has16BitIndices);
         stream.write(sceneData.has32BitIndices);
         stream.write(sceneData.meshDrawCount);
+        stream.write(sceneData.deduplicatedMeshCount);
+        stream.write(sceneData.deduplicatedMeshMemoryInBytes);
         writeSplitBuffer(stream, sceneData.meshIndexData);
         writeSplitBuffer(stream, sceneData.meshStaticData);
         stream.write(sceneData.meshSkinningData);
@@ -474,6 +477,7 @@ namespace Falcor
 
         readMarker(stream, "Meshes");
         stream.read(sceneData.meshDesc);
+        stream.read(sceneData.meshletDesc);
         stream.read(sceneData.meshNames);
         stream.read(sceneData.meshBBs);
         stream.read(sceneData.meshInstanceData);
@@ -501,6 +505,8 @@ namespace Falcor
         stream.read(sceneData.has16BitIndices);
         stream.read(sceneData.has32BitIndices);
         stream.read(sceneData.meshDrawCount);
+        stream.read(sceneData.deduplicatedMeshCount);
+        stream.read(sceneData.deduplicatedMeshMemoryInBytes);
         readSplitBuffer(stream, sceneData.meshIndexData);
         readSplitBuffer(stream, sceneData.meshStaticData);
         stream.read(sceneData.meshSkinningData);
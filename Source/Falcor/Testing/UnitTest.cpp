@@ -42,10 +42,12 @@
 #include <fmt/format.h>
 #include <fmt/color.h>
 #include <pugixml.hpp>
+#include <nlohmann/json.hpp>
 #include <BS_thread_pool/BS_thread_pool_light.hpp>
 
 #include <algorithm>
 #include <chrono>
+#include <fstream>
 #include <regex>
 #include <cstdint>
 
@@ -61,6 +63,8 @@ struct TestDesc
     unittest::Options options;
     CPUTestFunc cpuFunc;
     GPUTestFunc gpuFunc;
+    CPUBenchmarkFunc benchmarkFunc;
+    GPUBenchmarkFunc gpuBenchmarkFunc;
 };
 
 struct TestResult
@@ -76,8 +80,12 @@ struct TestResult
     std::vector<std::string> messages;
     std::string extraMessage;
     uint64_t elapsedMS = 0;
+    std::vector<BenchmarkResult> benchmarks;
 };
 
+/// Benchmark results of a previous run, indexed by benchmark key.
+using BenchmarkBaseline = std::map<std::string, BenchmarkResult>;
+
 static std::vector<TestDesc>& getTestRegistry()
 {
     static std::vector<TestDesc> registry;
@@ -143,6 +151,26 @@ void registerGPUTest(std::filesystem::path path, std::string name, unittest::Opt
     getTestRegistry().push_back(desc);
 }
 
+void registerCPUBenchmark(std::filesystem::path path, std::string name, unittest::Options options, CPUBenchmarkFunc func)
+{
+    TestDesc desc;
+    desc.path = std::move(path);
+    desc.name = std::move(name);
+    desc.options = std::move(options);
+    desc.benchmarkFunc = std::move(func);
+    getTestRegistry().push_back(desc);
+}
+
+void registerGPUBenchmark(std::filesystem::path path, std::string name, unittest::Options options, GPUBenchmarkFunc func)
+{
+    TestDesc desc;
+    desc.path = std::move(path);
+    desc.name = std::move(name);
+    desc.options = std::move(options);
+    desc.gpuBenchmarkFunc = std::move(func);
+    getTestRegistry().push_back(desc);
+}
+
 /// Prints the UnitTest report line, making sure it is always printed to the console once.
 template<typename... Args>
 void reportLine(const std::string_view format, Args&&... args)
@@ -211,7 +239,112 @@ inline void writeXmlReport(const std::filesystem::path& path, const std::vector<
     doc.save_file(path.native().c_str());
 }
 
-inline TestResult runTest(const Test& test, DevicePool& devicePool)
+/// Returns the key used to identify a benchmark measurement in reports.
+inline std::string getBenchmarkKey(const Test& test, const BenchmarkResult& benchmark)
+{
+    return fmt::format("{}:{}/{}", test.suiteName, test.name, benchmark.name);
+}
+
+/**
+ * Write benchmark results in JSON format.
+ * @param[in] path File path.
+ * @param[in] report List of tests/results.
+ */
+inline void writeBenchmarkReport(const std::filesystem::path& path, const std::vector<std::pair<Test, TestResult>>& report)
+{
+    nlohmann::json benchmarks = nlohmann::json::array();
+
+    for (const auto& [test, result] : report)
+    {
+        for (const auto& benchmark : result.benchmarks)
+        {
+            benchmarks.push_back({
+                {"key", getBenchmarkKey(test, benchmark)},
+                {"suite", test.suiteName},
+                {"test", test.name},
+                {"name", benchmark.name},
+                {"iterations", benchmark.iterations},
+                {"samples", benchmark.samples},
+                {"median_ns", benchmark.timeNS.median},
+                {"mad_ns", benchmark.timeNS.mad},
+                {"min_ns", benchmark.timeNS.min},
+                {"max_ns", benchmark.timeNS.max},
+                {"mean_ns", benchmark.timeNS.mean},
+                {"items_per_second", benchmark.itemsPerSecond},
+            });
+        }
+    }
+
+    nlohmann::json j = {{"version", getLongVersionString()}, {"benchmarks", benchmarks}};
+
+    std::ofstream ofs(path);
+    if (!ofs.good())
+        FALCOR_THROW("Failed to write benchmark report to '{}'.", path);
+    ofs << j.dump(4);
+}
+
+/**
+ * Read benchmark results previously written by writeBenchmarkReport().
+ * @param[in] path File path.
+ * @return Results indexed by benchmark key.
+ */
+inline BenchmarkBaseline readBenchmarkBaseline(const std::filesystem::path& path)
+{
+    std::ifstream ifs(path);
+    if (!ifs.good())
+        FALCOR_THROW("Failed to read benchmark baseline from '{}'.", path);
+
+    BenchmarkBaseline baseline;
+    nlohmann::json j = nlohmann::json::parse(ifs);
+    for (const auto& item : j.at("benchmarks"))
+    {
+        BenchmarkResult benchmark;
+        benchmark.name = item.at("name").get<std::string>();
+        benchmark.iterations = item.at("iterations").get<uint64_t>();
+        benchmark.samples = item.at("samples").get<uint32_t>();
+        benchmark.timeNS.median = item.at("median_ns").get<double>();
+        benchmark.timeNS.mad = item.at("mad_ns").get<double>();
+        benchmark.timeNS.min = item.at("min_ns").get<double>();
+        benchmark.timeNS.max = item.at("max_ns").get<double>();
+        benchmark.timeNS.mean = item.at("mean_ns").get<double>();
+        benchmark.itemsPerSecond = item.at("items_per_second").get<double>();
+        baseline[item.at("key").get<std::string>()] = benchmark;
+    }
+    return baseline;
+}
+
+/// Returns a failure message if the median time of a benchmark regressed by more than the threshold.
+inline std::optional<std::string> checkBenchmarkRegression(
+    const Test& test,
+    const BenchmarkResult& benchmark,
+    const BenchmarkBaseline& baseline,
+    double threshold
+)
+{
+    auto it = baseline.find(getBenchmarkKey(test, benchmark));
+    if (it == baseline.end() || it->second.timeNS.median <= 0.0)
+        return {};
+
+    double ratio = benchmark.timeNS.median / it->second.timeNS.median;
+    if (ratio <= 1.0 + threshold)
+        return {};
+
+    return fmt::format(
+        "Benchmark '{}' regressed: median {:.1f} ns vs. baseline {:.1f} ns (+{:.1f}%, threshold {:.1f}%)",
+        benchmark.name,
+        benchmark.timeNS.median,
+        it->second.timeNS.median,
+        (ratio - 1.0) * 100.0,
+        threshold * 100.0
+    );
+}
+
+inline TestResult runTest(
+    const Test& test,
+    DevicePool& devicePool,
+    const BenchmarkOptions& benchmarkOptions,
+    const BenchmarkBaseline& baseline
+)
 {
     if (!test.skipMessage.empty())
         return {TestResult::Status::Skipped, {test.skipMessage}};
@@ -243,6 +376,38 @@ inline TestResult runTest(const Test& test, DevicePool& devicePool)
             pDevice->wait();
             devicePool.releaseDevice(std::move(pDevice));
         }
+        else if (test.benchmarkFunc)
+        {
+            CPUBenchmarkContext benchmarkCtx(benchmarkOptions);
+            test.benchmarkFunc(benchmarkCtx);
+            result.messages = benchmarkCtx.getFailureMessages();
+            result.benchmarks = benchmarkCtx.getResults();
+        }
+        else if (test.gpuBenchmarkFunc)
+        {
+            ref<Device> pDevice;
+            pDevice = devicePool.acquireDevice(test.deviceType);
+
+            {
+                GPUBenchmarkContext benchmarkCtx(pDevice, benchmarkOptions);
+                test.gpuBenchmarkFunc(benchmarkCtx);
+                result.messages = benchmarkCtx.getFailureMessages();
+                result.benchmarks = benchmarkCtx.getResults();
+            }
+
+            pDevice->endFrame();
+            pDevice->wait();
+            devicePool.releaseDevice(std::move(pDevice));
+        }
+
+        for (const auto& benchmark : result.benchmarks)
+        {
+            if (auto message = checkBenchmarkRegression(test, benchmark, baseline, benchmarkOptions.regressionThreshold))
+            {
+                reportLine("{}", *message);
+                result.messages.push_back(*message);
+            }
+        }
     }
     catch (const SkippingTestException& e)
     {
@@ -282,7 +447,7 @@ inline TestResult runTest(const Test& test, DevicePool& devicePool)
     return result;
 }
 
-inline int32_t runTestsParallel(const RunOptions& options)
+inline int32_t runTestsParallel(const RunOptions& options, const BenchmarkBaseline& baseline)
 {
     // Abort on Ctrl-C.
     std::atomic<bool> abort{false};
@@ -300,7 +465,9 @@ inline int32_t runTestsParallel(const RunOptions& options)
 
     // Gather tests.
     std::vector<Test> tests = enumerateTests();
-    tests = filterTests(tests, options.testSuiteFilter, options.testCaseFilter, options.tagFilter, options.deviceDesc.type);
+    tests = filterTests(
+        tests, options.testSuiteFilter, options.testCaseFilter, options.tagFilter, options.deviceDesc.type, options.benchmark
+    );
 
     std::vector<TestResult> results(tests.size());
 
@@ -311,7 +478,7 @@ inline int32_t runTestsParallel(const RunOptions& options)
     for (size_t testIndex = 0; testIndex < tests.size(); ++testIndex)
     {
         threadPool.push_task(
-            [&abort, &tests, &results, &devicePool, testIndex]()
+            [&abort, &tests, &results, &devicePool, &options, &baseline, testIndex]()
             {
                 if (abort)
                     return;
@@ -322,7 +489,7 @@ inline int32_t runTestsParallel(const RunOptions& options)
 
                 reportLine("[ RUN      ] {}:{}{}", test.suiteName, test.name, repeats);
 
-                result = runTest(test, devicePool);
+                result = runTest(test, devicePool, options.benchmarkOptions, baseline);
 
                 std::string statusTag;
                 switch (result.status)
@@ -355,6 +522,14 @@ inline int32_t runTestsParallel(const RunOptions& options)
     auto endTime = std::chrono::steady_clock::now();
     uint64_t totalMS = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
 
+    if (!options.benchmarkOptions.reportPath.empty())
+    {
+        std::vector<std::pair<Test, TestResult>> report;
+        for (size_t i = 0; i < tests.size(); ++i)
+            report.emplace_back(tests[i], results[i]);
+        writeBenchmarkReport(options.benchmarkOptions.reportPath, report);
+    }
+
     int32_t failureCount = 0;
     for (const auto& result : results)
         failureCount += result.status == TestResult::Status::Failed ? 1 : 0;
@@ -374,7 +549,7 @@ inline int32_t runTestsParallel(const RunOptions& options)
     return failureCount;
 }
 
-inline int32_t runTestsSerial(const RunOptions& options)
+inline int32_t runTestsSerial(const RunOptions& options, const BenchmarkBaseline& baseline)
 {
     // Abort on Ctrl-C.
     std::atomic<bool> abort{false};
@@ -392,7 +567,9 @@ inline int32_t runTestsSerial(const RunOptions& options)
 
     // Gather tests.
     std::vector<Test> tests = enumerateTests();
-    tests = filterTests(tests, options.testSuiteFilter, options.testCaseFilter, options.tagFilter, options.deviceDesc.type);
+    tests = filterTests(
+        tests, options.testSuiteFilter, options.testCaseFilter, options.tagFilter, options.deviceDesc.type, options.benchmark
+    );
 
     // Split tests into suites.
     std::map<std::string, std::vector<Test>> suites;
@@ -430,7 +607,7 @@ inline int32_t runTestsSerial(const RunOptions& options)
                 if (options.repeat > 1)
                     repeats = fmt::format("[{}/{}]", repeatIndex + 1, options.repeat);
                 reportLine("[ RUN      ] {}:{}{}", suiteName, test.name, repeats);
-                TestResult result = runTest(test, devicePool);
+                TestResult result = runTest(test, devicePool, options.benchmarkOptions, baseline);
                 report.emplace_back(test, result);
 
                 std::string statusTag;
@@ -474,6 +651,9 @@ inline int32_t runTestsSerial(const RunOptions& options)
     if (!options.xmlReportPath.empty())
         writeXmlReport(options.xmlReportPath, report);
 
+    if (!options.benchmarkOptions.reportPath.empty())
+        writeBenchmarkReport(options.benchmarkOptions.reportPath, report);
+
     reportLine(
         "[==========] {} test{} from {} test suite{} ran. ({} ms total)",
         testCount,
@@ -507,7 +687,11 @@ int32_t runTests(const RunOptions& options)
     Threading::start();
     Scripting::start();
 
-    int32_t failureCount = options.parallel > 1 ? runTestsParallel(options) : runTestsSerial(options);
+    BenchmarkBaseline baseline;
+    if (options.benchmark && !options.benchmarkOptions.baselinePath.empty())
+        baseline = readBenchmarkBaseline(options.benchmarkOptions.baselinePath);
+
+    int32_t failureCount = options.parallel > 1 ? runTestsParallel(options, baseline) : runTestsSerial(options, baseline);
 
     Scripting::shutdown();
     Threading::shutdown();
@@ -531,12 +715,14 @@ std::vector<Test> enumerateTests()
         test.deviceType = Device::Type::Default;
         test.cpuFunc = desc.cpuFunc;
         test.gpuFunc = desc.gpuFunc;
+        test.benchmarkFunc = desc.benchmarkFunc;
+        test.gpuBenchmarkFunc = desc.gpuBenchmarkFunc;
 
-        if (test.cpuFunc)
+        if (test.cpuFunc || test.benchmarkFunc)
         {
             tests.push_back(test);
         }
-        else if (test.gpuFunc)
+        else if (test.gpuFunc || test.gpuBenchmarkFunc)
         {
 #if FALCOR_HAS_D3D12
             if (desc.options.deviceTypes.empty() || desc.options.deviceTypes.count(Device::Type::D3D12))
@@ -554,6 +740,13 @@ std::vector<Test> enumerateTests()
                 tests.push_back(test);
             }
 #endif
+            // The CPU device only supports a subset of the features, so tests have to opt in explicitly.
+            if (desc.options.deviceTypes.count(Device::Type::CPU))
+            {
+                test.deviceType = Device::Type::CPU;
+                test.name = fmt::format("{} (CPU)", desc.name);
+                tests.push_back(test);
+            }
         }
     }
 
@@ -577,7 +770,8 @@ std::vector<Test> filterTests(
     std::string testSuiteFilter,
     std::string testCaseFilter,
     std::string tagFilter,
-    Device::Type deviceType
+    Device::Type deviceType,
+    bool benchmarks
 )
 {
     std::vector<Test> filtered;
@@ -624,6 +818,8 @@ std::vector<Test> filterTests(
             continue;
         if (deviceType != Device::Type::Default && test.deviceType != deviceType)
             continue;
+        if (test.isBenchmark() != benchmarks)
+            continue;
         filtered.push_back(test);
     }
 
@@ -645,6 +841,125 @@ void UnitTestContext::reportFailure(const std::string& message)
 
 ///////////////////////////////////////////////////////////////////////////
 
+BenchmarkStats computeBenchmarkStats(std::vector<double> samples)
+{
+    BenchmarkStats stats;
+    if (samples.empty())
+        return stats;
+
+    auto median = [](std::vector<double>& values)
+    {
+        size_t n = values.size();
+        std::sort(values.begin(), values.end());
+        return n % 2 == 1 ? values[n / 2] : 0.5 * (values[n / 2 - 1] + values[n / 2]);
+    };
+
+    stats.median = median(samples);
+    stats.min = samples.front();
+    stats.max = samples.back();
+
+    double sum = 0.0;
+    for (double sample : samples)
+        sum += sample;
+    stats.mean = sum / samples.size();
+
+    std::vector<double> deviations(samples.size());
+    for (size_t i = 0; i < samples.size(); ++i)
+        deviations[i] = std::abs(samples[i] - stats.median);
+    stats.mad = median(deviations);
+
+    return stats;
+}
+
+/**
+ * Measure the time per call of a function.
+ * @param[in] sync Called after each warmup call and at the end of each sample, before the time is taken.
+ */
+static BenchmarkResult measureFunction(
+    const BenchmarkOptions& options,
+    std::string name,
+    const std::function<void()>& func,
+    const std::function<void()>& sync,
+    uint64_t itemsPerCall
+)
+{
+    using Clock = std::chrono::steady_clock;
+    auto elapsedNS = [](Clock::time_point start) { return std::chrono::duration<double, std::nano>(Clock::now() - start).count(); };
+
+    // Warmup. The function is run at least once, the average time per call is used to determine the number of calls per sample.
+    uint64_t warmupCalls = 0;
+    double warmupNS = 0.0;
+    auto warmupStart = Clock::now();
+    do
+    {
+        func();
+        sync();
+        ++warmupCalls;
+        warmupNS = elapsedNS(warmupStart);
+    } while (warmupNS < options.warmupMS * 1e6);
+
+    double estimatedNS = std::max(warmupNS / warmupCalls, 1.0);
+    uint64_t iterations = std::max<uint64_t>(1, uint64_t(options.sampleMS * 1e6 / estimatedNS));
+
+    // Take samples until we have the minimum number of samples and the time limit is reached.
+    uint32_t maxSamples = std::max(options.maxSamples, 1u);
+    std::vector<double> samples;
+    samples.reserve(maxSamples);
+    auto measureStart = Clock::now();
+    while (samples.size() < maxSamples)
+    {
+        auto sampleStart = Clock::now();
+        for (uint64_t i = 0; i < iterations; ++i)
+            func();
+        sync();
+        samples.push_back(elapsedNS(sampleStart) / iterations);
+
+        if (samples.size() >= options.minSamples && elapsedNS(measureStart) >= options.maxTimeMS * 1e6)
+            break;
+    }
+
+    BenchmarkResult result;
+    result.name = std::move(name);
+    result.iterations = iterations;
+    result.samples = (uint32_t)samples.size();
+    result.timeNS = computeBenchmarkStats(std::move(samples));
+    if (itemsPerCall > 0 && result.timeNS.median > 0.0)
+        result.itemsPerSecond = itemsPerCall * 1e9 / result.timeNS.median;
+
+    std::string throughput;
+    if (result.itemsPerSecond > 0.0)
+        throughput = fmt::format(", {:.3g} items/s", result.itemsPerSecond);
+    reportLine(
+        "[ BENCH    ] {}: {:.1f} ns +/- {:.1f} ns ({} samples x {} iterations{})",
+        result.name,
+        result.timeNS.median,
+        result.timeNS.mad,
+        result.samples,
+        result.iterations,
+        throughput
+    );
+
+    return result;
+}
+
+const BenchmarkResult& CPUBenchmarkContext::measure(std::string name, const std::function<void()>& func, uint64_t itemsPerCall)
+{
+    mResults.push_back(measureFunction(mOptions, std::move(name), func, []() {}, itemsPerCall));
+    return mResults.back();
+}
+
+const BenchmarkResult& GPUBenchmarkContext::measure(std::string name, const std::function<void()>& func, uint64_t itemsPerCall)
+{
+    auto sync = [this]()
+    {
+        getRenderContext()->submit(true);
+    };
+    mResults.push_back(measureFunction(mOptions, std::move(name), func, sync, itemsPerCall));
+    return mResults.back();
+}
+
+///////////////////////////////////////////////////////////////////////////
+
 void GPUUnitTestContext::createProgram(
     const std::filesystem::path& path,
     const std::string& entry,
@@ -798,4 +1113,39 @@ CPU_TEST(TestTags, TAGS("tag1", "tag2", "tag3"))
     EXPECT(true);
 }
 
+CPU_TEST(TestBenchmarkStats)
+{
+    unittest::BenchmarkStats stats = unittest::computeBenchmarkStats({5.0, 1.0, 3.0, 2.0, 100.0});
+    EXPECT_EQ(stats.median, 3.0);
+    EXPECT_EQ(stats.mad, 2.0);
+    EXPECT_EQ(stats.min, 1.0);
+    EXPECT_EQ(stats.max, 100.0);
+    EXPECT_EQ(stats.mean, 22.2);
+
+    stats = unittest::computeBenchmarkStats({4.0, 1.0, 2.0, 3.0});
+    EXPECT_EQ(stats.median, 2.5);
+    EXPECT_EQ(stats.mad, 1.0);
+}
+
+CPU_BENCHMARK(TestBenchmark)
+{
+    std::vector<uint32_t> values(1024);
+    for (uint32_t i = 0; i < values.size(); ++i)
+        values[i] = i * 7919u;
+
+    const auto& result = ctx.measure(
+        "sum",
+        [&]()
+        {
+            uint32_t sum = 0;
+            for (uint32_t value : values)
+                sum += value;
+            unittest::doNotOptimize(sum);
+        },
+        values.size()
+    );
+    EXPECT_GT(result.samples, 0u);
+    EXPECT_GT(result.timeNS.median, 0.0);
+}
+
 } // namespace Falcor
@@ -84,6 +84,26 @@ public:
     SkippingTestException(const std::string& what) : std::runtime_error(what.c_str()) {}
 };
 
+struct BenchmarkOptions
+{
+    /// Minimum time spent running the function before measurements are taken (ms).
+    double warmupMS = 100.0;
+    /// Target duration of a single sample (ms). The number of iterations per sample is adapted to reach it.
+    double sampleMS = 10.0;
+    /// Minimum number of samples per measurement.
+    uint32_t minSamples = 10;
+    /// Maximum number of samples per measurement.
+    uint32_t maxSamples = 100;
+    /// Time after which sampling stops once the minimum number of samples is reached (ms).
+    double maxTimeMS = 2000.0;
+    /// JSON report output file (optional).
+    std::filesystem::path reportPath;
+    /// JSON report of a previous run to compare against (optional).
+    std::filesystem::path baselinePath;
+    /// Relative increase of the median time over the baseline that is reported as a failure.
+    double regressionThreshold = 0.1;
+};
+
 struct RunOptions
 {
     Device::Desc deviceDesc;
@@ -93,15 +113,22 @@ struct RunOptions
     std::filesystem::path xmlReportPath;
     uint32_t parallel = 1;
     uint32_t repeat = 1;
+    /// Run benchmarks instead of tests.
+    bool benchmark = false;
+    BenchmarkOptions benchmarkOptions;
 };
 
 FALCOR_API int32_t runTests(const RunOptions& options);
 
 class CPUUnitTestContext;
 class GPUUnitTestContext;
+class CPUBenchmarkContext;
+class GPUBenchmarkContext;
 
 using CPUTestFunc = std::function<void(CPUUnitTestContext& ctx)>;
 using GPUTestFunc = std::function<void(GPUUnitTestContext& ctx)>;
+using CPUBenchmarkFunc = std::function<void(CPUBenchmarkContext& ctx)>;
+using GPUBenchmarkFunc = std::function<void(GPUBenchmarkContext& ctx)>;
 
 struct Test
 {
@@ -113,18 +140,56 @@ struct Test
 
     CPUTestFunc cpuFunc;
     GPUTestFunc gpuFunc;
+    CPUBenchmarkFunc benchmarkFunc;
+    GPUBenchmarkFunc gpuBenchmarkFunc;
+
+    bool isBenchmark() const { return benchmarkFunc || gpuBenchmarkFunc; }
+};
+
+/**
+ * Robust statistics over a set of benchmark samples.
+ */
+struct BenchmarkStats
+{
+    double median = 0.0;
+    /// Median absolute deviation from the median.
+    double mad = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+    double mean = 0.0;
+};
+
+/**
+ * Result of a single benchmark measurement.
+ */
+struct BenchmarkResult
+{
+    std::string name;
+    /// Number of calls per sample.
+    uint64_t iterations = 0;
+    /// Number of samples taken.
+    uint32_t samples = 0;
+    /// Statistics of the time per call (ns).
+    BenchmarkStats timeNS;
+    /// Throughput based on the median time per call (0 if no item count was given).
+    double itemsPerSecond = 0.0;
 };
 
+/// Compute median, median absolute deviation, min, max and mean of a set of samples.
+FALCOR_API BenchmarkStats computeBenchmarkStats(std::vector<double> samples);
+
 /// Enumerate all tests.
 FALCOR_API std::vector<Test> enumerateTests();
 
 /// Filter tests by suite and case name.
+/// Benchmarks are only returned if `benchmarks` is set, in which case regular tests are omitted.
 FALCOR_API std::vector<Test> filterTests(
     std::vector<Test> tests,
     std::string testSuiteFilter,
     std::string testCaseFilter,
     std::string tagFilter,
-    Device::Type deviceType
+    Device::Type deviceType,
+    bool benchmarks = false
 );
 
 class FALCOR_API UnitTestContext
@@ -153,6 +218,47 @@ private:
 class FALCOR_API CPUUnitTestContext : public UnitTestContext
 {};
 
+class FALCOR_API CPUBenchmarkContext : public CPUUnitTestContext
+{
+public:
+    CPUBenchmarkContext(const BenchmarkOptions& options) : mOptions(options) {}
+
+    /**
+     * Measure the time per call of a function.
+     * The function is first run for the warmup period, which is also used to estimate the
+     * number of calls needed per sample to reach the target sample duration. Samples are
+     * then taken until the minimum number of samples and the time limit are reached.
+     * @param[in] name Name of the measurement, used in the report and for baseline comparison.
+     * @param[in] func Function to measure.
+     * @param[in] itemsPerCall Number of items processed per call, used to report throughput (0 to disable).
+     * @return The measurement result.
+     */
+    const BenchmarkResult& measure(std::string name, const std::function<void()>& func, uint64_t itemsPerCall = 0);
+
+    const BenchmarkOptions& getOptions() const { return mOptions; }
+
+    const std::vector<BenchmarkResult>& getResults() const { return mResults; }
+
+private:
+    BenchmarkOptions mOptions;
+    std::vector<BenchmarkResult> mResults;
+};
+
+/**
+ * Prevent the compiler from optimizing away the computation of a value in a benchmark.
+ */
+template<typename T>
+inline void doNotOptimize(const T& value)
+{
+#if FALCOR_MSVC
+    // Storing the address through a volatile pointer is an observable side effect, so the value has to be materialized.
+    static const void* volatile sink;
+    sink = &value;
+#else
+    asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
 class FALCOR_API GPUUnitTestContext : public UnitTestContext
 {
 public:
@@ -279,6 +385,31 @@ private:
     std::map<std::string, ref<Buffer>> mStructuredBuffers;
 };
 
+class FALCOR_API GPUBenchmarkContext : public GPUUnitTestContext
+{
+public:
+    GPUBenchmarkContext(ref<Device> pDevice, const BenchmarkOptions& options) : GPUUnitTestContext(pDevice), mOptions(options) {}
+
+    /**
+     * Measure the time per call of a function recording GPU work.
+     * This works like CPUBenchmarkContext::measure(), except that the work is submitted and the
+     * device is waited on at the end of each sample, so the time includes the GPU execution.
+     * @param[in] name Name of the measurement, used in the report and for baseline comparison.
+     * @param[in] func Function to measure.
+     * @param[in] itemsPerCall Number of items processed per call, used to report throughput (0 to disable).
+     * @return The measurement result.
+     */
+    const BenchmarkResult& measure(std::string name, const std::function<void()>& func, uint64_t itemsPerCall = 0);
+
+    const BenchmarkOptions& getOptions() const { return mOptions; }
+
+    const std::vector<BenchmarkResult>& getResults() const { return mResults; }
+
+private:
+    BenchmarkOptions mOptions;
+    std::vector<BenchmarkResult> mResults;
+};
+
 struct Tags
 {
     Tags(std::string tag) { tags.push_back(std::move(tag)); }
@@ -351,6 +482,8 @@ void applyArgs(Options& options, Args&&... args)
 
 FALCOR_API void registerCPUTest(std::filesystem::path path, std::string name, unittest::Options options, CPUTestFunc func);
 FALCOR_API void registerGPUTest(std::filesystem::path path, std::string name, unittest::Options options, GPUTestFunc func);
+FALCOR_API void registerCPUBenchmark(std::filesystem::path path, std::string name, unittest::Options options, CPUBenchmarkFunc func);
+FALCOR_API void registerGPUBenchmark(std::filesystem::path path, std::string name, unittest::Options options, GPUBenchmarkFunc func);
 
 /**
  * StreamSink is a utility class used by the testing framework that either
@@ -533,6 +666,8 @@ inline std::optional<std::string> createBinaryMessage(std::string_view lhsStr, s
 using UnitTestContext = unittest::UnitTestContext;
 using CPUUnitTestContext = unittest::CPUUnitTestContext;
 using GPUUnitTestContext = unittest::GPUUnitTestContext;
+using CPUBenchmarkContext = unittest::CPUBenchmarkContext;
+using GPUBenchmarkContext = unittest::GPUBenchmarkContext;
 
 /**
  * Macro to define a CPU unit test. The optional arguments include:
@@ -582,6 +717,8 @@ using GPUUnitTestContext = unittest::GPUUnitTestContext;
  * GPU_TEST(Test3, TAGS("tag1", "tag2")) {} // Test is run and tagged with "tag1" and "tag2"
  * GPU_TEST(Test4, DEVICE_TYPES(Device::Type::D3D12)) {} // Test is only run on D3D12
  *
+ * Tests are only run on the CPU device if Device::Type::CPU is listed explicitly.
+ *
  * For convenience, and for backwards compatibility, a string can be used as an
  * optional argument to skip the test:
  *
@@ -609,6 +746,68 @@ using GPUUnitTestContext = unittest::GPUUnitTestContext;
     } RegisterGPUTest##name;                                                    \
     static void GPUUnitTest##name(GPUUnitTestContext& ctx) /* over to the user for the braces */
 
+/**
+ * Macro to define a CPU benchmark. Benchmarks are not run as part of the regular
+ * tests, they are run when FalcorTest is invoked with --benchmark. The optional
+ * arguments are the same as for CPU_TEST.
+ *
+ * Within the benchmark, an instance of CPUBenchmarkContext is available via a parameter
+ * named `ctx`. Use ctx.measure() to time a function, the EXPECT_* macros can be used as usual:
+ *
+ * CPU_BENCHMARK(Sort, TAGS("math"))
+ * {
+ *     std::vector<float> data = ...;
+ *     ctx.measure("sort", [&]() { auto copy = data; std::sort(copy.begin(), copy.end()); }, data.size());
+ * }
+ *
+ * Note: All benchmarks are implicitly tagged with "cpu" and "benchmark".
+ */
+#define CPU_BENCHMARK(name, ...)                                                      \
+    static void CPUBenchmark##name(CPUBenchmarkContext& ctx);                         \
+    struct CPUBenchmarkRegisterer##name                                               \
+    {                                                                                 \
+        CPUBenchmarkRegisterer##name()                                                \
+        {                                                                             \
+            std::filesystem::path path = __FILE__;                                    \
+            unittest::Options options;                                                \
+            applyArgs(options, ##__VA_ARGS__);                                        \
+            options.tags.insert("cpu");                                               \
+            options.tags.insert("benchmark");                                         \
+            unittest::registerCPUBenchmark(path, #name, options, CPUBenchmark##name); \
+        }                                                                             \
+    } RegisterCPUBenchmark##name;                                                     \
+    static void CPUBenchmark##name(CPUBenchmarkContext& ctx) /* over to the user for the braces */
+
+/**
+ * Macro to define a GPU benchmark. The optional arguments are the same as for GPU_TEST.
+ *
+ * Within the benchmark, an instance of GPUBenchmarkContext is available via a parameter
+ * named `ctx`. Use ctx.measure() to time a function recording GPU work:
+ *
+ * GPU_BENCHMARK(PrefixSum)
+ * {
+ *     PrefixSum prefixSum(ctx.getDevice());
+ *     ctx.measure("scan", [&]() { prefixSum.execute(ctx.getRenderContext(), pData, count); }, count);
+ * }
+ *
+ * Note: All GPU benchmarks are implicitly tagged with "gpu" and "benchmark".
+ */
+#define GPU_BENCHMARK(name, ...)                                                      \
+    static void GPUBenchmark##name(GPUBenchmarkContext& ctx);                         \
+    struct GPUBenchmarkRegisterer##name                                               \
+    {                                                                                 \
+        GPUBenchmarkRegisterer##name()                                                \
+        {                                                                             \
+            std::filesystem::path path = __FILE__;                                    \
+            unittest::Options options;                                                \
+            applyArgs(options, ##__VA_ARGS__);                                        \
+            options.tags.insert("gpu");                                               \
+            options.tags.insert("benchmark");                                         \
+            unittest::registerGPUBenchmark(path, #name, options, GPUBenchmark##name); \
+        }                                                                             \
+    } RegisterGPUBenchmark##name;                                                     \
+    static void GPUBenchmark##name(GPUBenchmarkContext& ctx) /* over to the user for the braces */
+
 // clang-format off
 
 /// Used as an argument of CPU_TEST/GPU_TEST to tag a test with a set of strings.
@@ -0,0 +1,173 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "RadixSort.h"
+#include "Core/Error.h"
+#include "Core/API/RenderContext.h"
+#include "Utils/Math/Common.h"
+#include "Utils/Timing/Profiler.h"
+
+namespace Falcor
+{
+namespace
+{
+const char kShaderFile[] = "Utils/Algorithm/RadixSort.cs.slang";
+
+const uint32_t kRadixBits = 8;
+const uint32_t kRadix = 1 << kRadixBits;
+const uint32_t kGroupSize = kRadix; // One thread per digit in the histogram passes.
+const uint32_t kKeysPerThread = 8;
+const uint32_t kBlockSize = kGroupSize * kKeysPerThread;
+const uint32_t kMaxBlockCount = 65535; // Maximum dispatch size in one dimension.
+
+ref<Buffer> ensureBufferSize(ref<Device> pDevice, ref<Buffer> pBuffer, uint64_t size)
+{
+    if (pBuffer && pBuffer->getSize() >= size)
+        return pBuffer;
+    return pDevice->createBuffer(size, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess, MemoryType::DeviceLocal, nullptr);
+}
+} // namespace
+
+RadixSort::RadixSort(ref<Device> pDevice) : mpDevice(pDevice)
+{
+    mpPrefixSum = std::make_unique<PrefixSum>(mpDevice);
+}
+
+uint32_t RadixSort::getMaxElementCount()
+{
+    return kMaxBlockCount * kBlockSize;
+}
+
+RadixSort::Kernels& RadixSort::getKernels(KeyType keyType, bool hasValues)
+{
+    Kernels& kernels = mKernels[keyType == KeyType::Uint64 ? 1 : 0][hasValues ? 1 : 0];
+    if (!kernels.pCountPass)
+    {
+        DefineList defines = {
+            {"GROUP_SIZE", std::to_string(kGroupSize)},
+            {"KEYS_PER_THREAD", std::to_string(kKeysPerThread)},
+            {"KEY_WORDS", keyType == KeyType::Uint64 ? "2" : "1"},
+            {"HAS_VALUES", hasValues ? "1" : "0"},
+        };
+        kernels.pCountPass = ComputePass::create(mpDevice, kShaderFile, "countDigits", defines);
+        kernels.pScatterPass = ComputePass::create(mpDevice, kShaderFile, "scatter", defines);
+    }
+    return kernels;
+}
+
+void RadixSort::execute(
+    RenderContext* pRenderContext,
+    ref<Buffer> pKeys,
+    ref<Buffer> pValues,
+    uint32_t elementCount,
+    KeyType keyType,
+    uint32_t keyBits
+)
+{
+    FALCOR_PROFILE(pRenderContext, "RadixSort::execute");
+
+    FALCOR_ASSERT(pRenderContext);
+    const uint32_t keySize = keyType == KeyType::Uint64 ? 8 : 4;
+    const uint32_t maxKeyBits = keySize * 8;
+    FALCOR_CHECK(pKeys && pKeys->getSize() >= uint64_t(elementCount) * keySize, "Key buffer is too small.");
+    FALCOR_CHECK(!pValues || pValues->getSize() >= uint64_t(elementCount) * 4, "Value buffer is too small.");
+    FALCOR_CHECK(keyBits <= maxKeyBits, "Key bit count {} exceeds the key size of {} bits.", keyBits, maxKeyBits);
+    FALCOR_CHECK(elementCount <= getMaxElementCount(), "Element count {} exceeds the maximum of {}.", elementCount, getMaxElementCount());
+
+    if (elementCount <= 1)
+        return;
+
+    const uint32_t blockCount = div_round_up(elementCount, kBlockSize);
+    const uint32_t passCount = div_round_up(keyBits == 0 ? maxKeyBits : keyBits, kRadixBits);
+    const bool hasValues = pValues != nullptr;
+
+    // Allocate temporary buffers.
+    mpTempKeys = ensureBufferSize(mpDevice, mpTempKeys, uint64_t(elementCount) * keySize);
+    if (hasValues)
+        mpTempValues = ensureBufferSize(mpDevice, mpTempValues, uint64_t(elementCount) * 4);
+    mpBlockCounts = ensureBufferSize(mpDevice, mpBlockCounts, uint64_t(blockCount) * kRadix * 4);
+
+    Kernels& kernels = getKernels(keyType, hasValues);
+
+    ref<Buffer> pKeysIn = pKeys;
+    ref<Buffer> pKeysOut = mpTempKeys;
+    ref<Buffer> pValuesIn = pValues;
+    ref<Buffer> pValuesOut = mpTempValues;
+
+    for (uint32_t pass = 0; pass < passCount; pass++)
+    {
+        // Pass 1: count the digits in each block of keys.
+        {
+            auto var = kernels.pCountPass->getRootVar();
+            var["CB"]["gElementCount"] = elementCount;
+            var["CB"]["gBlockCount"] = blockCount;
+            var["CB"]["gShift"] = pass * kRadixBits;
+            var["gKeysIn"] = pKeysIn;
+            var["gBlockCounts"] = mpBlockCounts;
+            kernels.pCountPass->execute(pRenderContext, blockCount * kGroupSize, 1);
+        }
+
+        pRenderContext->uavBarrier(mpBlockCounts.get());
+
+        // Pass 2: compute the destination offset of each digit and block. The counts are stored digit-major,
+        // so the exclusive prefix sum over all counts yields the offsets directly.
+        mpPrefixSum->execute(pRenderContext, mpBlockCounts, blockCount * kRadix);
+
+        // Pass 3: scatter the keys and values to their destinations.
+        {
+            auto var = kernels.pScatterPass->getRootVar();
+            var["CB"]["gElementCount"] = elementCount;
+            var["CB"]["gBlockCount"] = blockCount;
+            var["CB"]["gShift"] = pass * kRadixBits;
+            var["gKeysIn"] = pKeysIn;
+            var["gKeysOut"] = pKeysOut;
+            var["gBlockCounts"] = mpBlockCounts;
+            if (hasValues)
+            {
+                var["gValuesIn"] = pValuesIn;
+                var["gValuesOut"] = pValuesOut;
+            }
+            kernels.pScatterPass->execute(pRenderContext, blockCount * kGroupSize, 1);
+        }
+
+        pRenderContext->uavBarrier(pKeysOut.get());
+        if (hasValues)
+            pRenderContext->uavBarrier(pValuesOut.get());
+
+        std::swap(pKeysIn, pKeysOut);
+        std::swap(pValuesIn, pValuesOut);
+    }
+
+    // After an odd number of passes the result is in the temporary buffers.
+    if (passCount % 2 == 1)
+    {
+        pRenderContext->copyBufferRegion(pKeys.get(), 0, mpTempKeys.get(), 0, uint64_t(elementCount) * keySize);
+        if (hasValues)
+            pRenderContext->copyBufferRegion(pValues.get(), 0, mpTempValues.get(), 0, uint64_t(elementCount) * 4);
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,101 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "PrefixSum.h"
+#include "Core/Macros.h"
+#include "Core/API/Buffer.h"
+#include "Core/Pass/ComputePass.h"
+#include <memory>
+
+namespace Falcor
+{
+class RenderContext;
+
+/**
+ * Stable LSD radix sort on the GPU.
+ *
+ * Sorts 32-bit or 64-bit unsigned keys in ascending order, optionally reordering a buffer of 32-bit values along with the keys.
+ * The keys are sorted 8 bits at a time. Each pass counts the digits per block of keys, computes the destination
+ * offsets of all blocks with a single prefix sum over the digit-major block histograms, and scatters the keys.
+ * Keys are ranked within a block using per-digit match masks in shared memory, which keeps the sort stable.
+ *
+ * The sort is done in place, using temporary buffers of the same size as the input.
+ */
+class FALCOR_API RadixSort
+{
+public:
+    enum class KeyType
+    {
+        Uint32, ///< 32-bit keys.
+        Uint64, ///< 64-bit keys, stored as pairs of 32-bit words (low word first).
+    };
+
+    /// Constructor. Throws an exception if creation failed.
+    RadixSort(ref<Device> pDevice);
+
+    /**
+     * Sort keys in ascending order. The sort is stable, i.e., elements with equal keys keep their relative order.
+     * @param[in] pRenderContext The render context.
+     * @param[in] pKeys Buffer of keys to sort in place. Must be bound as unordered access.
+     * @param[in] pValues (Optional) Buffer of 32-bit values to reorder along with the keys, or nullptr for a key-only sort.
+     * @param[in] elementCount Number of elements to sort.
+     * @param[in] keyType Key type.
+     * @param[in] keyBits Number of low key bits to sort on, or 0 to sort on all bits. Higher bits are ignored.
+     *                    Sorting on fewer bits reduces the number of passes, for example for 30-bit Morton codes.
+     */
+    void execute(
+        RenderContext* pRenderContext,
+        ref<Buffer> pKeys,
+        ref<Buffer> pValues,
+        uint32_t elementCount,
+        KeyType keyType = KeyType::Uint32,
+        uint32_t keyBits = 0
+    );
+
+    /// Get the maximum number of elements that can be sorted.
+    static uint32_t getMaxElementCount();
+
+private:
+    struct Kernels
+    {
+        ref<ComputePass> pCountPass;
+        ref<ComputePass> pScatterPass;
+    };
+
+    Kernels& getKernels(KeyType keyType, bool hasValues);
+
+    ref<Device> mpDevice;
+    std::unique_ptr<PrefixSum> mpPrefixSum;
+
+    Kernels mKernels[2][2]; ///< Kernels indexed by key type and whether values are sorted.
+
+    ref<Buffer> mpTempKeys;    ///< Temporary key buffer for ping-ponging between passes.
+    ref<Buffer> mpTempValues;  ///< Temporary value buffer for ping-ponging between passes.
+    ref<Buffer> mpBlockCounts; ///< Digit counts per block, converted to destination offsets by a prefix sum.
+};
+} // namespace Falcor
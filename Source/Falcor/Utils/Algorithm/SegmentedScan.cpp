@@ -0,0 +1,155 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "SegmentedScan.h"
+#include "Core/Error.h"
+#include "Core/API/RenderContext.h"
+#include "Utils/Math/Common.h"
+#include "Utils/Timing/Profiler.h"
+
+namespace Falcor
+{
+namespace
+{
+const char kShaderFile[] = "Utils/Algorithm/SegmentedScan.cs.slang";
+
+const uint32_t kGroupSize = 256;
+const uint32_t kElementsPerThread = 4;
+const uint32_t kBlockSize = kGroupSize * kElementsPerThread;
+const uint32_t kMaxBlockCount = 65535; // Maximum dispatch size in one dimension.
+
+ref<Buffer> ensureBufferSize(ref<Device> pDevice, ref<Buffer> pBuffer, uint64_t size)
+{
+    if (pBuffer && pBuffer->getSize() >= size)
+        return pBuffer;
+    return pDevice->createBuffer(size, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess, MemoryType::DeviceLocal, nullptr);
+}
+} // namespace
+
+SegmentedScan::SegmentedScan(ref<Device> pDevice) : mpDevice(pDevice) {}
+
+uint32_t SegmentedScan::getMaxElementCount()
+{
+    return kMaxBlockCount * kBlockSize;
+}
+
+SegmentedScan::Kernels& SegmentedScan::getKernels(Type type)
+{
+    Kernels& kernels = mKernels[type == Type::Float32 ? 1 : 0];
+    if (!kernels.pScanBlocksPass)
+    {
+        DefineList defines = {
+            {"GROUP_SIZE", std::to_string(kGroupSize)},
+            {"ELEMENTS_PER_THREAD", std::to_string(kElementsPerThread)},
+            {"USE_FLOAT", type == Type::Float32 ? "1" : "0"},
+        };
+        kernels.pScanBlocksPass = ComputePass::create(mpDevice, kShaderFile, "scanBlocks", defines);
+        kernels.pAddCarriesPass = ComputePass::create(mpDevice, kShaderFile, "addCarries", defines);
+    }
+    return kernels;
+}
+
+void SegmentedScan::execute(
+    RenderContext* pRenderContext,
+    ref<Buffer> pInput,
+    ref<Buffer> pFlags,
+    ref<Buffer> pOutput,
+    uint32_t elementCount,
+    Type type,
+    Mode mode
+)
+{
+    FALCOR_PROFILE(pRenderContext, "SegmentedScan::execute");
+
+    FALCOR_ASSERT(pRenderContext);
+    FALCOR_CHECK(pInput && pInput->getSize() >= uint64_t(elementCount) * 4, "Input buffer is too small.");
+    FALCOR_CHECK(pFlags && pFlags->getSize() >= uint64_t(elementCount) * 4, "Flag buffer is too small.");
+    FALCOR_CHECK(pOutput && pOutput->getSize() >= uint64_t(elementCount) * 4, "Output buffer is too small.");
+    FALCOR_CHECK(elementCount <= getMaxElementCount(), "Element count {} exceeds the maximum of {}.", elementCount, getMaxElementCount());
+
+    if (elementCount == 0)
+        return;
+
+    Kernels& kernels = getKernels(type);
+
+    // Element counts of all levels. Level 0 is the input, each following level holds the block totals of the previous level.
+    std::vector<uint32_t> counts = {elementCount};
+    while (counts.back() > kBlockSize)
+        counts.push_back(div_round_up(counts.back(), kBlockSize));
+
+    // Allocate block totals for all levels. The top level also writes its (unused) total.
+    if (mLevels.size() < counts.size())
+        mLevels.resize(counts.size());
+    for (size_t i = 0; i < counts.size(); i++)
+    {
+        uint64_t size = uint64_t(div_round_up(counts[i], kBlockSize)) * 4;
+        mLevels[i].pValues = ensureBufferSize(mpDevice, mLevels[i].pValues, size);
+        mLevels[i].pFlags = ensureBufferSize(mpDevice, mLevels[i].pFlags, size);
+    }
+
+    // Level i is scanned in place, except for level 0 which is read from the input and written to the output.
+    auto getValues = [&](size_t level) { return level == 0 ? pOutput : mLevels[level - 1].pValues; };
+    auto getFlags = [&](size_t level) { return level == 0 ? pFlags : mLevels[level - 1].pFlags; };
+
+    // Up-sweep: scan each block and write the block totals to the next level.
+    for (size_t level = 0; level < counts.size(); level++)
+    {
+        auto var = kernels.pScanBlocksPass->getRootVar();
+        var["CB"]["gElementCount"] = counts[level];
+        var["gInput"] = level == 0 ? pInput : getValues(level);
+        var["gFlags"] = getFlags(level);
+        var["gOutput"] = getValues(level);
+        var["gBlockValues"] = mLevels[level].pValues;
+        var["gBlockFlags"] = mLevels[level].pFlags;
+        kernels.pScanBlocksPass->execute(pRenderContext, div_round_up(counts[level], kBlockSize) * kGroupSize, 1);
+
+        pRenderContext->uavBarrier(getValues(level).get());
+        pRenderContext->uavBarrier(mLevels[level].pValues.get());
+        pRenderContext->uavBarrier(mLevels[level].pFlags.get());
+    }
+
+    // Down-sweep: add the scanned totals of the preceding blocks, starting below the top level, which is a single block.
+    // The exclusive scan is computed when finalizing level 0, so that pass is also needed if there is only one level.
+    const bool exclusive = mode == Mode::Exclusive;
+    int32_t topLevel = (int32_t)counts.size() - 2;
+    if (topLevel < 0 && exclusive)
+        topLevel = 0;
+
+    for (int32_t level = topLevel; level >= 0; level--)
+    {
+        auto var = kernels.pAddCarriesPass->getRootVar();
+        var["CB"]["gElementCount"] = counts[level];
+        var["CB"]["gExclusive"] = (level == 0 && exclusive) ? 1u : 0u;
+        var["gFlags"] = getFlags(level);
+        var["gOutput"] = getValues(level);
+        var["gCarries"] = getValues(level + 1);
+        kernels.pAddCarriesPass->execute(pRenderContext, div_round_up(counts[level], kBlockSize) * kGroupSize, 1);
+
+        pRenderContext->uavBarrier(getValues(level).get());
+    }
+}
+} // namespace Falcor
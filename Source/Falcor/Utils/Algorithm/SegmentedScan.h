@@ -0,0 +1,108 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Core/API/Buffer.h"
+#include "Core/Pass/ComputePass.h"
+#include <vector>
+
+namespace Falcor
+{
+class RenderContext;
+
+/**
+ * Computes segmented prefix sums on the GPU.
+ *
+ * The input is split into segments by a buffer of head flags. An element with a nonzero flag starts a new segment,
+ * the first element always starts a segment. The prefix sum restarts at zero in each segment.
+ *
+ * Each thread group scans a block of 1024 elements and writes the block total, which is scanned recursively.
+ * The scanned block totals are then added to the elements before the first segment head of each block.
+ */
+class FALCOR_API SegmentedScan
+{
+public:
+    enum class Type
+    {
+        Uint32,  ///< 32-bit unsigned integers. Also gives the correct result for 32-bit signed integers.
+        Float32, ///< 32-bit floats.
+    };
+
+    enum class Mode
+    {
+        Inclusive, ///< y[i] = x[s] + ... + x[i], where s is the start of the segment of i.
+        Exclusive, ///< y[i] = x[s] + ... + x[i-1], i.e., zero for the first element of each segment.
+    };
+
+    /// Constructor. Throws an exception if creation failed.
+    SegmentedScan(ref<Device> pDevice);
+
+    /**
+     * Compute a segmented prefix sum.
+     * @param[in] pRenderContext The render context.
+     * @param[in] pInput Buffer of 32-bit input values.
+     * @param[in] pFlags Buffer of 32-bit segment head flags.
+     * @param[out] pOutput Buffer of 32-bit output values. This can be the same buffer as the input buffer.
+     * @param[in] elementCount Number of elements.
+     * @param[in] type Value type.
+     * @param[in] mode Scan mode.
+     */
+    void execute(
+        RenderContext* pRenderContext,
+        ref<Buffer> pInput,
+        ref<Buffer> pFlags,
+        ref<Buffer> pOutput,
+        uint32_t elementCount,
+        Type type = Type::Uint32,
+        Mode mode = Mode::Inclusive
+    );
+
+    /// Get the maximum number of elements that can be scanned.
+    static uint32_t getMaxElementCount();
+
+private:
+    struct Kernels
+    {
+        ref<ComputePass> pScanBlocksPass;
+        ref<ComputePass> pAddCarriesPass;
+    };
+
+    /// Block totals of one level of the recursive scan.
+    struct Level
+    {
+        ref<Buffer> pValues;
+        ref<Buffer> pFlags;
+    };
+
+    Kernels& getKernels(Type type);
+
+    ref<Device> mpDevice;
+    Kernels mKernels[2]; ///< Kernels indexed by type.
+    std::vector<Level> mLevels;
+};
+} // namespace Falcor
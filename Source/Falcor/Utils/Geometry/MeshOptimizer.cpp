@@ -0,0 +1,285 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "MeshOptimizer.h"
+#include "Core/Error.h"
+#include <algorithm>
+#include <limits>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kInvalidIndex = std::numeric_limits<uint32_t>::max();
+
+/// Triangles adjacent to each vertex, stored in compressed row format.
+struct VertexAdjacency
+{
+    std::vector<uint32_t> offsets;   ///< Offset of the first adjacent triangle of each vertex. Has vertexCount + 1 entries.
+    std::vector<uint32_t> triangles; ///< Adjacent triangles.
+
+    VertexAdjacency(fstd::span<const uint32_t> indices, uint32_t vertexCount) : offsets(vertexCount + 1, 0), triangles(indices.size())
+    {
+        for (uint32_t index : indices)
+            offsets[index + 1]++;
+        for (uint32_t v = 0; v < vertexCount; ++v)
+            offsets[v + 1] += offsets[v];
+
+        std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); ++i)
+            triangles[cursor[indices[i]]++] = uint32_t(i / 3);
+    }
+
+    fstd::span<const uint32_t> get(uint32_t v) const { return {triangles.data() + offsets[v], offsets[v + 1] - offsets[v]}; }
+};
+
+void validateIndices(fstd::span<const uint32_t> indices, uint32_t vertexCount)
+{
+    FALCOR_CHECK(indices.size() % 3 == 0, "Index count ({}) must be a multiple of 3.", indices.size());
+    for (uint32_t index : indices)
+        FALCOR_CHECK(index < vertexCount, "Vertex index ({}) is out of range.", index);
+}
+} // namespace
+
+VertexCacheStats analyzeVertexCache(fstd::span<const uint32_t> indices, uint32_t vertexCount, uint32_t cacheSize)
+{
+    validateIndices(indices, vertexCount);
+    FALCOR_CHECK(cacheSize > 0, "Cache size must be positive.");
+
+    VertexCacheStats stats;
+    stats.triangleCount = uint32_t(indices.size() / 3);
+
+    // A vertex is in the FIFO cache if it was inserted within the last 'cacheSize' insertions.
+    std::vector<uint32_t> insertTime(vertexCount, kInvalidIndex);
+    for (uint32_t index : indices)
+    {
+        if (insertTime[index] == kInvalidIndex)
+            stats.vertexCount++;
+        if (insertTime[index] == kInvalidIndex || stats.transformCount - insertTime[index] >= cacheSize)
+            insertTime[index] = stats.transformCount++;
+    }
+
+    return stats;
+}
+
+std::vector<uint32_t> optimizeVertexCache(fstd::span<const uint32_t> indices, uint32_t vertexCount, uint32_t cacheSize)
+{
+    validateIndices(indices, vertexCount);
+    FALCOR_CHECK(cacheSize > 0, "Cache size must be positive.");
+
+    const uint32_t triangleCount = uint32_t(indices.size() / 3);
+    const VertexAdjacency adjacency(indices, vertexCount);
+
+    // Number of adjacent triangles that have not been emitted yet.
+    std::vector<uint32_t> liveTriangles(vertexCount);
+    for (uint32_t v = 0; v < vertexCount; ++v)
+        liveTriangles[v] = uint32_t(adjacency.get(v).size());
+
+    std::vector<uint32_t> cacheTime(vertexCount, 0);
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<uint32_t> deadEnd;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+
+    uint32_t timestamp = cacheSize + 1;
+    uint32_t cursor = 0;
+
+    auto getNextVertex = [&]() -> uint32_t
+    {
+        // Pick the candidate that stays in the cache while its remaining triangles are emitted, preferring the oldest one.
+        uint32_t bestVertex = kInvalidIndex;
+        int64_t bestPriority = -1;
+        for (uint32_t v : candidates)
+        {
+            if (liveTriangles[v] == 0)
+                continue;
+            int64_t priority = 0;
+            if (timestamp - cacheTime[v] + 2 * liveTriangles[v] <= cacheSize)
+                priority = timestamp - cacheTime[v];
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                bestVertex = v;
+            }
+        }
+        if (bestVertex != kInvalidIndex)
+            return bestVertex;
+
+        // Dead end. Continue with the most recently used vertex that has triangles left.
+        while (!deadEnd.empty())
+        {
+            uint32_t v = deadEnd.back();
+            deadEnd.pop_back();
+            if (liveTriangles[v] > 0)
+                return v;
+        }
+
+        // Continue with the next vertex in input order.
+        for (; cursor < vertexCount; ++cursor)
+        {
+            if (liveTriangles[cursor] > 0)
+                return cursor;
+        }
+        return kInvalidIndex;
+    };
+
+    uint32_t fan = getNextVertex();
+    while (fan != kInvalidIndex)
+    {
+        // Emit all remaining triangles around the fanning vertex.
+        candidates.clear();
+        for (uint32_t triangle : adjacency.get(fan))
+        {
+            if (emitted[triangle])
+                continue;
+            for (uint32_t i = 0; i < 3; ++i)
+            {
+                uint32_t v = indices[triangle * 3 + i];
+                result.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                liveTriangles[v]--;
+                if (timestamp - cacheTime[v] > cacheSize)
+                    cacheTime[v] = timestamp++;
+            }
+            emitted[triangle] = true;
+        }
+
+        fan = getNextVertex();
+    }
+
+    FALCOR_ASSERT(result.size() == indices.size());
+    return result;
+}
+
+std::vector<uint32_t> optimizeVertexFetch(fstd::span<uint32_t> indices, uint32_t vertexCount)
+{
+    validateIndices(indices, vertexCount);
+
+    std::vector<uint32_t> remap(vertexCount, kInvalidIndex);
+    uint32_t nextVertex = 0;
+    for (uint32_t& index : indices)
+    {
+        if (remap[index] == kInvalidIndex)
+            remap[index] = nextVertex++;
+        index = remap[index];
+    }
+
+    for (uint32_t& newIndex : remap)
+    {
+        if (newIndex == kInvalidIndex)
+            newIndex = nextVertex++;
+    }
+
+    return remap;
+}
+
+std::vector<Meshlet> buildMeshlets(
+    fstd::span<const uint32_t> indices,
+    fstd::span<const float3> positions,
+    uint32_t maxVertices,
+    uint32_t maxTriangles
+)
+{
+    validateIndices(indices, uint32_t(positions.size()));
+    FALCOR_CHECK(maxVertices >= 3, "Meshlets must allow at least 3 vertices.");
+    FALCOR_CHECK(maxTriangles >= 1, "Meshlets must allow at least 1 triangle.");
+
+    std::vector<Meshlet> meshlets;
+
+    // Index of the meshlet that last referenced each vertex, used to count unique vertices.
+    std::vector<uint32_t> vertexMeshlet(positions.size(), kInvalidIndex);
+    float3 normalSum(0.f);
+
+    auto finishMeshlet = [&](Meshlet& meshlet)
+    {
+        // Compute the normal cone. Degenerate triangles don't constrain the cone.
+        float len = length(normalSum);
+        if (len == 0.f)
+            return;
+        meshlet.coneAxis = normalSum / len;
+        meshlet.coneCutoff = 1.f;
+        for (uint32_t t = meshlet.triangleOffset; t < meshlet.triangleOffset + meshlet.triangleCount; ++t)
+        {
+            const float3& p0 = positions[indices[t * 3 + 0]];
+            float3 n = cross(positions[indices[t * 3 + 1]] - p0, positions[indices[t * 3 + 2]] - p0);
+            float nLen = length(n);
+            if (nLen > 0.f)
+                meshlet.coneCutoff = std::min(meshlet.coneCutoff, dot(meshlet.coneAxis, n / nLen));
+        }
+    };
+
+    const uint32_t triangleCount = uint32_t(indices.size() / 3);
+    for (uint32_t t = 0; t < triangleCount; ++t)
+    {
+        uint32_t newVertexCount = 0;
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            uint32_t v = indices[t * 3 + i];
+            bool isDuplicate = (i > 0 && indices[t * 3] == v) || (i > 1 && indices[t * 3 + 1] == v);
+            if (!isDuplicate && (meshlets.empty() || vertexMeshlet[v] != meshlets.size() - 1))
+                newVertexCount++;
+        }
+
+        if (meshlets.empty() || meshlets.back().triangleCount == maxTriangles || meshlets.back().vertexCount + newVertexCount > maxVertices)
+        {
+            if (!meshlets.empty())
+                finishMeshlet(meshlets.back());
+            Meshlet meshlet;
+            meshlet.triangleOffset = t;
+            meshlets.push_back(meshlet);
+            normalSum = float3(0.f);
+        }
+
+        Meshlet& meshlet = meshlets.back();
+        const uint32_t meshletIndex = uint32_t(meshlets.size() - 1);
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            uint32_t v = indices[t * 3 + i];
+            if (vertexMeshlet[v] != meshletIndex)
+            {
+                vertexMeshlet[v] = meshletIndex;
+                meshlet.vertexCount++;
+            }
+            meshlet.bounds.include(positions[v]);
+        }
+        meshlet.triangleCount++;
+
+        const float3& p0 = positions[indices[t * 3 + 0]];
+        float3 n = cross(positions[indices[t * 3 + 1]] - p0, positions[indices[t * 3 + 2]] - p0);
+        float nLen = length(n);
+        if (nLen > 0.f)
+            normalSum += n / nLen;
+    }
+
+    if (!meshlets.empty())
+        finishMeshlet(meshlets.back());
+
+    return meshlets;
+}
+} // namespace Falcor
@@ -0,0 +1,122 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Utils/Math/AABB.h"
+#include "Utils/Math/Vector.h"
+#include <fstd/span.h>
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * CPU utilities for optimizing the memory locality of indexed triangle meshes.
+ *
+ * Triangles are reordered for post-transform vertex cache locality using the Tipsify algorithm
+ * (Sander et al., "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw", 2007),
+ * and vertices are reordered by first use for vertex fetch locality. Meshes can then be split
+ * into meshlets, i.e. clusters of consecutive triangles with a bounded number of vertices.
+ */
+
+/// Default size of the simulated post-transform vertex cache.
+static constexpr uint32_t kDefaultVertexCacheSize = 16;
+
+struct VertexCacheStats
+{
+    uint32_t triangleCount = 0;  ///< Number of triangles.
+    uint32_t vertexCount = 0;    ///< Number of unique vertices referenced by the triangles.
+    uint32_t transformCount = 0; ///< Number of vertex transforms, i.e. cache misses.
+
+    /// Average cache miss ratio, i.e. vertex transforms per triangle. Between 0.5 (optimal for large meshes) and 3.
+    float getACMR() const { return triangleCount > 0 ? (float)transformCount / triangleCount : 0.f; }
+    /// Average transform to vertex ratio, i.e. vertex transforms per vertex. 1 is optimal.
+    float getATVR() const { return vertexCount > 0 ? (float)transformCount / vertexCount : 0.f; }
+};
+
+struct Meshlet
+{
+    uint32_t triangleOffset = 0; ///< Index of the first triangle in the mesh.
+    uint32_t triangleCount = 0;  ///< Number of triangles.
+    uint32_t vertexCount = 0;    ///< Number of unique vertices referenced by the triangles.
+    AABB bounds;                 ///< Bounds of the vertices.
+    float3 coneAxis{0.f};        ///< Axis of the cone containing all triangle normals.
+    float coneCutoff = -1.f;     ///< Cosine of the cone half-angle. -1 if the normals are not bounded.
+};
+
+/**
+ * Measure the efficiency of a triangle order by simulating a FIFO post-transform vertex cache.
+ * @param[in] indices Triangle list indices.
+ * @param[in] vertexCount Number of vertices.
+ * @param[in] cacheSize Number of entries in the simulated cache.
+ * @return Cache statistics.
+ */
+FALCOR_API VertexCacheStats analyzeVertexCache(
+    fstd::span<const uint32_t> indices,
+    uint32_t vertexCount,
+    uint32_t cacheSize = kDefaultVertexCacheSize
+);
+
+/**
+ * Reorder triangles for post-transform vertex cache locality.
+ * @param[in] indices Triangle list indices.
+ * @param[in] vertexCount Number of vertices.
+ * @param[in] cacheSize Number of entries in the targeted cache.
+ * @return Triangle list indices with the triangles reordered.
+ */
+FALCOR_API std::vector<uint32_t> optimizeVertexCache(
+    fstd::span<const uint32_t> indices,
+    uint32_t vertexCount,
+    uint32_t cacheSize = kDefaultVertexCacheSize
+);
+
+/**
+ * Reorder vertices by the order in which they are first referenced, to improve vertex fetch locality.
+ * Unreferenced vertices are moved to the end, preserving their relative order.
+ * @param[in,out] indices Triangle list indices. These are updated to refer to the reordered vertices.
+ * @param[in] vertexCount Number of vertices.
+ * @return Mapping from old to new vertex indices, to be used for reordering the vertex data.
+ */
+FALCOR_API std::vector<uint32_t> optimizeVertexFetch(fstd::span<uint32_t> indices, uint32_t vertexCount);
+
+/**
+ * Split a mesh into meshlets of consecutive triangles.
+ * Triangles are not reordered, so the triangle order should be optimized for locality first.
+ * @param[in] indices Triangle list indices.
+ * @param[in] positions Vertex positions.
+ * @param[in] maxVertices Maximum number of vertices per meshlet.
+ * @param[in] maxTriangles Maximum number of triangles per meshlet.
+ * @return List of meshlets covering all triangles in order.
+ */
+FALCOR_API std::vector<Meshlet> buildMeshlets(
+    fstd::span<const uint32_t> indices,
+    fstd::span<const float3> positions,
+    uint32_t maxVertices = 64,
+    uint32_t maxTriangles = 124
+);
+} // namespace Falcor
@@ -0,0 +1,247 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "AsyncImageWriter.h"
+#include "Core/Error.h"
+#include "Core/API/Texture.h"
+#include "Utils/Logger.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <memory>
+
+namespace Falcor
+{
+AsyncImageWriter::AsyncImageWriter(const Options& options) : mOptions(options)
+{
+    mOptions.threadCount = std::max<size_t>(mOptions.threadCount, 1);
+    mOptions.maxPendingImages = std::max<size_t>(mOptions.maxPendingImages, 1);
+
+    if (!mOptions.logPath.empty())
+    {
+        mLogStream.open(mOptions.logPath, std::ios::out | std::ios::trunc);
+        if (!mLogStream.is_open())
+            logWarning("AsyncImageWriter: Failed to open log file '{}'.", mOptions.logPath);
+    }
+
+    for (size_t i = 0; i < mOptions.threadCount; ++i)
+        mThreads.emplace_back(&AsyncImageWriter::runWorker, this);
+}
+
+AsyncImageWriter::~AsyncImageWriter()
+{
+    terminateWorkers();
+}
+
+uint64_t AsyncImageWriter::write(
+    const std::filesystem::path& path,
+    uint32_t width,
+    uint32_t height,
+    Bitmap::FileFormat fileFormat,
+    Bitmap::ExportFlags exportFlags,
+    ResourceFormat resourceFormat,
+    std::vector<uint8_t> data
+)
+{
+    FALCOR_CHECK(
+        data.size() == size_t(width) * height * getFormatBytesPerBlock(resourceFormat),
+        "Image data size ({} bytes) does not match the image dimensions.",
+        data.size()
+    );
+
+    // Capture the encoder settings at submission time.
+    auto writeFunc = [=, data = std::move(data), encoderOptions = getEncoderOptions()]() mutable
+    { Bitmap::saveImage(path, width, height, fileFormat, exportFlags, resourceFormat, true, data.data(), encoderOptions); };
+    return submit(path, std::move(writeFunc));
+}
+
+uint64_t AsyncImageWriter::writeTexture(
+    Texture* pTexture,
+    uint32_t mipLevel,
+    uint32_t arraySlice,
+    const std::filesystem::path& path,
+    Bitmap::FileFormat fileFormat,
+    Bitmap::ExportFlags exportFlags
+)
+{
+    FALCOR_CHECK(pTexture, "'pTexture' must not be null.");
+
+    ResourceFormat resourceFormat;
+    std::vector<uint8_t> data = pTexture->readImageData(mipLevel, arraySlice, fileFormat, resourceFormat);
+    return write(
+        path, pTexture->getWidth(mipLevel), pTexture->getHeight(mipLevel), fileFormat, exportFlags, resourceFormat, std::move(data)
+    );
+}
+
+uint64_t AsyncImageWriter::writeExr(const std::filesystem::path& path, ExrWriter exrWriter)
+{
+    // std::function requires a copyable target, share the writer instead of copying the layers.
+    auto pExrWriter = std::make_shared<ExrWriter>(std::move(exrWriter));
+    return submit(path, [path, pExrWriter]() { pExrWriter->write(path); });
+}
+
+void AsyncImageWriter::flush()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mSpaceCondition.wait(lock, [&]() { return mStats.pendingCount == 0; });
+    if (mLogStream.is_open())
+        mLogStream.flush();
+}
+
+void AsyncImageWriter::setEncoderOptions(const Bitmap::EncoderOptions& encoderOptions)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mOptions.encoderOptions = encoderOptions;
+}
+
+Bitmap::EncoderOptions AsyncImageWriter::getEncoderOptions() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mOptions.encoderOptions;
+}
+
+AsyncImageWriter::Stats AsyncImageWriter::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats;
+}
+
+uint64_t AsyncImageWriter::submit(const std::filesystem::path& path, std::function<void()> writeFunc)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    // Wait until there is space in the queue.
+    if (mStats.pendingCount >= mOptions.maxPendingImages)
+    {
+        auto startTime = CpuTimer::getCurrentTimePoint();
+        mSpaceCondition.wait(lock, [&]() { return mStats.pendingCount < mOptions.maxPendingImages; });
+        mStats.totalStallTimeMS += CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+    }
+
+    uint64_t id = mStats.submittedCount++;
+    mStats.pendingCount++;
+    mStats.maxPendingCount = std::max(mStats.maxPendingCount, mStats.pendingCount);
+
+    mRequestQueue.push(WriteRequest{id, path, std::move(writeFunc)});
+    mWorkCondition.notify_one();
+    return id;
+}
+
+void AsyncImageWriter::runWorker()
+{
+    // This function is the entry point for worker threads.
+    // The workers wait on the request queue and write an image when woken up.
+    // On termination the workers keep going until the queue is empty.
+
+    while (true)
+    {
+        // Wait on condition until more work is ready.
+        std::unique_lock<std::mutex> lock(mMutex);
+        mWorkCondition.wait(lock, [&]() { return mTerminate || !mRequestQueue.empty(); });
+
+        // Terminate thread unless there is more work to do.
+        if (mRequestQueue.empty())
+            break;
+
+        // Pop next write request from queue.
+        auto request = std::move(mRequestQueue.front());
+        mRequestQueue.pop();
+
+        lock.unlock();
+
+        // Encode and write the image (this part is running in parallel).
+        WriteResult result{request.path, {}, 0.0};
+        auto startTime = CpuTimer::getCurrentTimePoint();
+        try
+        {
+            request.writeFunc();
+        }
+        catch (const std::exception& e)
+        {
+            result.error = e.what();
+            logWarning("AsyncImageWriter: Failed to write image '{}': {}", request.path, result.error);
+        }
+        result.encodeTimeMS = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+
+        // Release the image data before making room in the queue.
+        request.writeFunc = {};
+
+        lock.lock();
+
+        mStats.pendingCount--;
+        if (result.error.empty())
+            mStats.writtenCount++;
+        else
+            mStats.failedCount++;
+        mStats.lastEncodeTimeMS = result.encodeTimeMS;
+        mStats.totalEncodeTimeMS += result.encodeTimeMS;
+
+        if (mLogStream.is_open())
+        {
+            mPendingLog.emplace(request.id, std::move(result));
+            logResults();
+        }
+
+        mSpaceCondition.notify_all();
+    }
+}
+
+void AsyncImageWriter::terminateWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mTerminate = true;
+    }
+
+    mWorkCondition.notify_all();
+
+    for (auto& thread : mThreads)
+        thread.join();
+
+    if (mLogStream.is_open())
+        mLogStream.flush();
+}
+
+void AsyncImageWriter::logResults()
+{
+    // Write all results that are next in submission order.
+    for (auto it = mPendingLog.find(mNextLogId); it != mPendingLog.end(); it = mPendingLog.find(++mNextLogId))
+    {
+        const WriteResult& result = it->second;
+        nlohmann::json entry = {
+            {"id", it->first},
+            {"path", result.path.string()},
+            {"success", result.error.empty()},
+            {"encode_ms", result.encodeTimeMS},
+        };
+        if (!result.error.empty())
+            entry["error"] = result.error;
+        mLogStream << entry.dump() << "\n";
+        mPendingLog.erase(it);
+    }
+}
+} // namespace Falcor
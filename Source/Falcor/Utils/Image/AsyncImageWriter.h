@@ -0,0 +1,185 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Bitmap.h"
+#include "ExrWriter.h"
+#include "Core/Macros.h"
+#include "Core/API/Formats.h"
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Falcor
+{
+class Texture;
+
+/**
+ * Utility class to encode and write images asynchronously using multiple worker threads.
+ *
+ * Images are submitted with their pixel data and written with Bitmap::saveImage() or ExrWriter on a worker thread.
+ * The number of pending images is bounded. Submitting blocks while the queue is full, which bounds the
+ * memory use and throttles the producer when encoding can't keep up.
+ * The results are optionally written to a log file in submission order, independent of the order in
+ * which the workers finish. The destructor waits for all pending images to be written.
+ */
+class FALCOR_API AsyncImageWriter
+{
+public:
+    struct Options
+    {
+        /// Number of worker threads.
+        size_t threadCount = 4;
+        /// Maximum number of images queued or being encoded. Submitting blocks while this many images are pending.
+        size_t maxPendingImages = 8;
+        /// Optional path of a log file. One JSON object per line is written for each image, in submission order.
+        std::filesystem::path logPath;
+        /// Encoder settings.
+        Bitmap::EncoderOptions encoderOptions;
+
+        // Note: Empty constructor needed for clang due to the use of the nested struct constructor in the parent constructor.
+        Options() {}
+    };
+
+    struct Stats
+    {
+        uint64_t submittedCount = 0;    ///< Number of submitted images.
+        uint64_t writtenCount = 0;      ///< Number of images written successfully.
+        uint64_t failedCount = 0;       ///< Number of images that failed to be written.
+        size_t pendingCount = 0;        ///< Number of images currently queued or being encoded.
+        size_t maxPendingCount = 0;     ///< Maximum number of pending images so far.
+        double lastEncodeTimeMS = 0.0;  ///< Encode time of the last finished image in milliseconds.
+        double totalEncodeTimeMS = 0.0; ///< Total encode time of all finished images in milliseconds, summed over all workers.
+        double totalStallTimeMS = 0.0;  ///< Total time in milliseconds submitting threads were blocked on a full queue.
+    };
+
+    /**
+     * Constructor.
+     * @param[in] options Writer options.
+     */
+    AsyncImageWriter(const Options& options = {});
+
+    /**
+     * Destructor.
+     * Blocks until all pending images are written and the threads have terminated.
+     */
+    ~AsyncImageWriter();
+
+    AsyncImageWriter(const AsyncImageWriter&) = delete;
+    AsyncImageWriter& operator=(const AsyncImageWriter&) = delete;
+
+    /**
+     * Submit an image for writing. Blocks while the queue is full.
+     * The arguments are the same as for Bitmap::saveImage(), the image data is expected in top-down order.
+     * @return Sequence number of the image, starting at zero.
+     */
+    uint64_t write(
+        const std::filesystem::path& path,
+        uint32_t width,
+        uint32_t height,
+        Bitmap::FileFormat fileFormat,
+        Bitmap::ExportFlags exportFlags,
+        ResourceFormat resourceFormat,
+        std::vector<uint8_t> data
+    );
+
+    /**
+     * Read back a 2D texture subresource and submit it for writing. Blocks while the queue is full.
+     * The readback happens on the calling thread, see Texture::readImageData().
+     * @return Sequence number of the image, starting at zero.
+     */
+    uint64_t writeTexture(
+        Texture* pTexture,
+        uint32_t mipLevel,
+        uint32_t arraySlice,
+        const std::filesystem::path& path,
+        Bitmap::FileFormat fileFormat,
+        Bitmap::ExportFlags exportFlags = Bitmap::ExportFlags::None
+    );
+
+    /**
+     * Submit a multi-layer EXR image for writing. Blocks while the queue is full.
+     * The layers should own their pixel data, or the data must be kept alive until the image is written.
+     * @return Sequence number of the image, starting at zero.
+     */
+    uint64_t writeExr(const std::filesystem::path& path, ExrWriter exrWriter);
+
+    /// Block until all submitted images are written.
+    void flush();
+
+    /// Set the encoder settings used for subsequently submitted images.
+    void setEncoderOptions(const Bitmap::EncoderOptions& encoderOptions);
+
+    /// Get the encoder settings.
+    Bitmap::EncoderOptions getEncoderOptions() const;
+
+    /// Get statistics.
+    Stats getStats() const;
+
+private:
+    struct WriteRequest
+    {
+        uint64_t id;
+        std::filesystem::path path;
+        std::function<void()> writeFunc; ///< Encodes and writes the image, throws on error.
+    };
+
+    struct WriteResult
+    {
+        std::filesystem::path path;
+        std::string error; ///< Error message, empty on success.
+        double encodeTimeMS;
+    };
+
+    uint64_t submit(const std::filesystem::path& path, std::function<void()> writeFunc);
+    void runWorker();
+    void terminateWorkers();
+    void logResults();
+
+    Options mOptions;
+
+    mutable std::mutex mMutex;               ///< Mutex for synchronizing access to shared resources.
+    std::condition_variable mWorkCondition;  ///< Condition variable for workers to wait on.
+    std::condition_variable mSpaceCondition; ///< Condition variable for submitting and flushing threads to wait on.
+    std::vector<std::thread> mThreads;       ///< Worker threads.
+    std::ofstream mLogStream;                ///< Completion log, if enabled.
+
+    // Internal state. Do not access outside of critical section.
+    std::queue<WriteRequest> mRequestQueue;         ///< Write request queue.
+    std::map<uint64_t, WriteResult> mPendingLog;    ///< Results that can't be logged yet as an earlier image is still pending.
+    uint64_t mNextLogId = 0;                        ///< Sequence number of the next result to log.
+    Stats mStats;
+    bool mTerminate = false; ///< Flag to terminate worker threads.
+};
+} // namespace Falcor
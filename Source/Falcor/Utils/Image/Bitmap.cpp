@@ -26,13 +26,15 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "Bitmap.h"
+#include "ExrWriter.h"
+#include "PixelConversion.h"
 #include "Core/Macros.h"
 #include "Core/API/Texture.h"
 #include "Core/Platform/MemoryMappedFile.h"
 #include "Utils/Math/ScalarMath.h"
-#include "Utils/Math/Float16.h"
 #include "Utils/Logger.h"
 #include "Utils/StringUtils.h"
+#include "Utils/Scripting/ScriptBindings.h"
 
 #include <ImfIO.h>
 #include <ImfInputFile.h>
@@ -109,56 +111,15 @@ static bool isConvertibleToRGBA32Float(ResourceFormat format)
 {
     FormatType type = getFormatType(format);
     bool isHalfFormat = (type == FormatType::Float && getNumChannelBits(format, 0) == 16);
+    bool isFloatFormatWithoutRGB = (type == FormatType::Float && getNumChannelBits(format, 0) == 32 && getFormatChannelCount(format) < 3);
     bool isLargeIntFormat = ((type == FormatType::Uint || type == FormatType::Sint) && getNumChannelBits(format, 0) >= 16);
-    return isHalfFormat || isLargeIntFormat;
-}
-
-/**
- * Converts half float image to RGBA float image.
- */
-static std::vector<float> convertHalfToRGBA32Float(uint32_t width, uint32_t height, uint32_t channelCount, const void* pData)
-{
-    std::vector<float> newData(width * height * 4u, 0.f);
-    const float16_t* pSrc = reinterpret_cast<const float16_t*>(pData);
-    float* pDst = newData.data();
-
-    for (uint32_t i = 0; i < width * height; ++i)
-    {
-        for (uint32_t c = 0; c < channelCount; ++c)
-        {
-            *pDst++ = float(*pSrc++);
-        }
-        pDst += (4 - channelCount);
-    }
-
-    return newData;
-}
-
-/**
- * Converts integer image to RGBA float image.
- * Unsigned integers are normalized to [0,1], signed integers to [-1,1].
- */
-template<typename SrcT>
-static std::vector<float> convertIntToRGBA32Float(uint32_t width, uint32_t height, uint32_t channelCount, const void* pData)
-{
-    std::vector<float> newData(width * height * 4u, 0.f);
-    const SrcT* pSrc = reinterpret_cast<const SrcT*>(pData);
-    float* pDst = newData.data();
-
-    for (uint32_t i = 0; i < width * height; ++i)
-    {
-        for (uint32_t c = 0; c < channelCount; ++c)
-        {
-            *pDst++ = float(*pSrc++) / float(std::numeric_limits<SrcT>::max());
-        }
-        pDst += (4 - channelCount);
-    }
-
-    return newData;
+    return isHalfFormat || isFloatFormatWithoutRGB || isLargeIntFormat;
 }
 
 /**
  * Converts an image of the given format to an RGBA float image.
+ * Unsigned integers are normalized to [0,1], signed integers to [-1,1].
+ * Missing color channels are set to 0 and missing alpha to 1.
  */
 static std::vector<float> convertToRGBA32Float(ResourceFormat format, uint32_t width, uint32_t height, const void* pData)
 {
@@ -168,38 +129,44 @@ static std::vector<float> convertToRGBA32Float(ResourceFormat format, uint32_t w
     uint32_t channelCount = getFormatChannelCount(format);
     uint32_t channelBits = getNumChannelBits(format, 0);
 
-    std::vector<float> floatData;
+    const size_t pixelCount = size_t(width) * height;
+    const size_t valueCount = pixelCount * channelCount;
+    std::vector<float> floatData(valueCount);
 
     if (type == FormatType::Float && channelBits == 16)
     {
-        floatData = convertHalfToRGBA32Float(width, height, channelCount, pData);
+        convertFloat16ToFloat32(reinterpret_cast<const uint16_t*>(pData), floatData.data(), valueCount);
+    }
+    else if (type == FormatType::Float && channelBits == 32)
+    {
+        std::memcpy(floatData.data(), pData, valueCount * sizeof(float));
     }
     else if (type == FormatType::Uint && channelBits == 16)
     {
-        floatData = convertIntToRGBA32Float<uint16_t>(width, height, channelCount, pData);
+        convertIntToFloat32(reinterpret_cast<const uint16_t*>(pData), floatData.data(), valueCount);
     }
     else if (type == FormatType::Uint && channelBits == 32)
     {
-        floatData = convertIntToRGBA32Float<uint32_t>(width, height, channelCount, pData);
+        convertIntToFloat32(reinterpret_cast<const uint32_t*>(pData), floatData.data(), valueCount);
     }
     else if (type == FormatType::Sint && channelBits == 16)
     {
-        floatData = convertIntToRGBA32Float<int16_t>(width, height, channelCount, pData);
+        convertIntToFloat32(reinterpret_cast<const int16_t*>(pData), floatData.data(), valueCount);
     }
     else if (type == FormatType::Sint && channelBits == 32)
     {
-        floatData = convertIntToRGBA32Float<int32_t>(width, height, channelCount, pData);
+        convertIntToFloat32(reinterpret_cast<const int32_t*>(pData), floatData.data(), valueCount);
     }
     else
     {
         FALCOR_UNREACHABLE();
     }
 
-    // Default alpha channel to 1.
     if (channelCount < 4)
     {
-        for (uint32_t i = 0; i < width * height; ++i)
-            floatData[i * 4 + 3] = 1.f;
+        std::vector<float> rgbaData(pixelCount * 4);
+        expandToRGBA32Float(floatData.data(), channelCount, rgbaData.data(), pixelCount);
+        return rgbaData;
     }
 
     return floatData;
@@ -225,17 +192,8 @@ static FIBITMAP* convertToRGBAF(FIBITMAP* pDib)
 
     for (unsigned y = 0; y < height; y++)
     {
-        const FIRGBF* src_pixel = (FIRGBF*)src_bits;
-        FIRGBAF* dst_pixel = (FIRGBAF*)dst_bits;
-
-        for (unsigned x = 0; x < width; x++)
-        {
-            // Convert pixels directly, while adding a "dummy" alpha of 1.0
-            dst_pixel[x].red = src_pixel[x].red;
-            dst_pixel[x].green = src_pixel[x].green;
-            dst_pixel[x].blue = src_pixel[x].blue;
-            dst_pixel[x].alpha = 1.0F;
-        }
+        // Convert pixels directly, while adding a "dummy" alpha of 1.0
+        expandToRGBA32Float((const float*)src_bits, 3, (float*)dst_bits, width);
         src_bits += src_pitch;
         dst_bits += dst_pitch;
     }
@@ -265,19 +223,18 @@ static FIBITMAP* convertToRGBA16Float(FIBITMAP* pDib)
     const BYTE* src_bits = (BYTE*)FreeImage_GetBits(pDib);
     BYTE* dst_bits = (BYTE*)FreeImage_GetBits(pNew);
 
+    // Scratch row for adding a "dummy" alpha of 1.0 if source format doesn't have alpha.
+    std::vector<float> rgbaRow(type == FIT_RGBAF ? 0 : width * 4);
+
     for (uint32_t y = 0; y < height; y++)
     {
-        const FIRGBAF* src_pixel = (FIRGBAF*)src_bits;
-        FIRGBA16* dst_pixel = (tagFIRGBA16*)dst_bits;
-
-        for (uint32_t x = 0; x < width; x++)
+        const float* src_pixel = (const float*)src_bits;
+        if (type != FIT_RGBAF)
         {
-            // Convert pixels to float16_t directly, while adding a "dummy" alpha of 1.0 if source format doesn't have alpha.
-            dst_pixel[x].red = float16_t(src_pixel[x].red).toBits();
-            dst_pixel[x].green = float16_t(src_pixel[x].green).toBits();
-            dst_pixel[x].blue = float16_t(src_pixel[x].blue).toBits();
-            dst_pixel[x].alpha = float16_t(type == FIT_RGBAF ? src_pixel[x].alpha : 1.0f).toBits();
+            expandToRGBA32Float(src_pixel, 3, rgbaRow.data(), width);
+            src_pixel = rgbaRow.data();
         }
+        convertFloat32ToFloat16(src_pixel, (uint16_t*)dst_bits, width * 4);
         src_bits += src_pitch;
         dst_bits += dst_pitch;
     }
@@ -595,7 +552,8 @@ void Bitmap::saveImage(
     ExportFlags exportFlags,
     ResourceFormat resourceFormat,
     bool isTopDown,
-    void* pData
+    void* pData,
+    const EncoderOptions& encoderOptions
 )
 {
     FALCOR_CHECK(pData, "Provided data must not be nullptr.");
@@ -603,29 +561,22 @@ void Bitmap::saveImage(
     if (is_set(exportFlags, ExportFlags::Uncompressed) && is_set(exportFlags, ExportFlags::Lossy))
         FALCOR_THROW("Incompatible flags: lossy cannot be combined with uncompressed.");
     if (is_set(exportFlags, ExportFlags::ExrFloat16) &&
-        (!is_set(exportFlags, ExportFlags::Uncompressed) || fileFormat != FileFormat::ExrFile))
-        FALCOR_THROW("Incompatible flags: EXR float16 can only be set for uncompressed EXR files.");
+        ((!is_set(exportFlags, ExportFlags::Uncompressed) && encoderOptions.exrCompression == ExrCompression::Default) ||
+         fileFormat != FileFormat::ExrFile))
+        FALCOR_THROW("Incompatible flags: EXR float16 can only be set for uncompressed or explicitly compressed EXR files.");
+    FALCOR_CHECK(encoderOptions.pngCompressionLevel <= 9, "PNG compression level must be in the range 0-9.");
 
     int flags = 0;
     FIBITMAP* pImage = nullptr;
     uint32_t bytesPerPixel = getFormatBytesPerBlock(resourceFormat);
 
     // Convert 8-bit RGBA to BGRA byte order.
-    // TODO: Replace this code for swapping channels. Can't use FreeImage masks b/c they only care about 16 bpp images.
+    // Can't use FreeImage masks for swapping channels b/c they only care about 16 bpp images.
     if (resourceFormat == ResourceFormat::RGBA8Unorm || resourceFormat == ResourceFormat::RGBA8Snorm ||
         resourceFormat == ResourceFormat::RGBA8UnormSrgb)
     {
-        for (uint32_t a = 0; a < width * height; a++)
-        {
-            uint32_t* pPixel = (uint32_t*)pData;
-            pPixel += a;
-            uint8_t* ch = (uint8_t*)pPixel;
-            std::swap(ch[0], ch[2]);
-            if (is_set(exportFlags, ExportFlags::ExportAlpha) == false)
-            {
-                ch[3] = 0xff;
-            }
-        }
+        const bool forceOpaque = is_set(exportFlags, ExportFlags::ExportAlpha) == false;
+        swizzleRGBA8ToBGRA8((const uint8_t*)pData, (uint8_t*)pData, size_t(width) * height, forceOpaque);
     }
 
     if (fileFormat == Bitmap::FileFormat::PfmFile || fileFormat == Bitmap::FileFormat::ExrFile)
@@ -654,6 +605,24 @@ void Bitmap::saveImage(
         if (exportAlpha && bytesPerPixel != 16)
             FALCOR_THROW("Requesting to export alpha-channel to EXR file, but the resource doesn't have an alpha-channel");
 
+        if (fileFormat == Bitmap::FileFormat::ExrFile && encoderOptions.exrCompression != ExrCompression::Default)
+        {
+            // Write explicitly compressed EXR files with OpenEXR directly, which supports more compression types
+            // and compresses in parallel.
+            ExrWriter::Options exrOptions;
+            exrOptions.compression = encoderOptions.exrCompression;
+            ExrWriter writer(width, height, exrOptions);
+            writer.addLayer(
+                "",
+                bytesPerPixel == 16 ? ResourceFormat::RGBA32Float : ResourceFormat::RGB32Float,
+                pData,
+                is_set(exportFlags, ExportFlags::ExrFloat16) ? ExrWriter::PixelType::Half : ExrWriter::PixelType::Float,
+                exportAlpha ? std::vector<std::string>{"R", "G", "B", "A"} : std::vector<std::string>{"R", "G", "B"}
+            );
+            writer.write(path);
+            return;
+        }
+
         // Upload the image manually and flip it vertically
         bool scanlineCopy = exportAlpha ? bytesPerPixel == 16 : bytesPerPixel == 12;
 
@@ -669,12 +638,7 @@ void Bitmap::saveImage(
             else
             {
                 FALCOR_ASSERT(exportAlpha == false);
-                for (unsigned x = 0; x < width; x++)
-                {
-                    dstBits[x * 3 + 0] = (((float*)head)[x * 4 + 0]);
-                    dstBits[x * 3 + 1] = (((float*)head)[x * 4 + 1]);
-                    dstBits[x * 3 + 2] = (((float*)head)[x * 4 + 2]);
-                }
+                extractRGBFromRGBA32Float((const float*)head, dstBits, width);
             }
             head += bytesPerPixel * width;
         }
@@ -696,6 +660,33 @@ void Bitmap::saveImage(
     }
     else
     {
+        // LDR formats store 8-bit sRGB encoded colors. Floating-point data is converted to RGBA and encoded.
+        std::vector<uint8_t> ldrData;
+        if (getFormatType(resourceFormat) == FormatType::Float &&
+            (isConvertibleToRGBA32Float(resourceFormat) || getNumChannelBits(resourceFormat, 0) == 32))
+        {
+            const size_t pixelCount = size_t(width) * height;
+            const float* pFloatData = reinterpret_cast<const float*>(pData);
+            std::vector<float> floatData;
+            if (isConvertibleToRGBA32Float(resourceFormat))
+            {
+                floatData = convertToRGBA32Float(resourceFormat, width, height, pData);
+                pFloatData = floatData.data();
+            }
+            else if (getFormatChannelCount(resourceFormat) == 3)
+            {
+                floatData.resize(pixelCount * 4);
+                expandToRGBA32Float(pFloatData, 3, floatData.data(), pixelCount);
+                pFloatData = floatData.data();
+            }
+
+            ldrData.resize(pixelCount * 4);
+            convertRGBA32FloatToRGBA8Srgb(pFloatData, ldrData.data(), pixelCount);
+            swizzleRGBA8ToBGRA8(ldrData.data(), ldrData.data(), pixelCount, !is_set(exportFlags, ExportFlags::ExportAlpha));
+            pData = ldrData.data();
+            bytesPerPixel = 4;
+        }
+
         FIBITMAP* pTemp = FreeImage_ConvertFromRawBits(
             (BYTE*)pData,
             width,
@@ -733,7 +724,10 @@ void Bitmap::saveImage(
 
         // Lossless formats
         case FileFormat::PngFile:
-            flags = is_set(exportFlags, ExportFlags::Uncompressed) ? PNG_Z_NO_COMPRESSION : PNG_Z_BEST_COMPRESSION;
+            if (encoderOptions.pngCompressionLevel >= 0)
+                flags = encoderOptions.pngCompressionLevel == 0 ? PNG_Z_NO_COMPRESSION : encoderOptions.pngCompressionLevel;
+            else
+                flags = is_set(exportFlags, ExportFlags::Uncompressed) ? PNG_Z_NO_COMPRESSION : PNG_Z_BEST_COMPRESSION;
 
             if (is_set(exportFlags, ExportFlags::Lossy))
             {
@@ -774,4 +768,9 @@ void Bitmap::saveImage(
 
     FreeImage_Unload(pImage);
 }
+
+FALCOR_SCRIPT_BINDING(Bitmap)
+{
+    pybind11::falcor_enum<Bitmap::ExrCompression>(m, "ExrCompression");
+}
 } // namespace Falcor
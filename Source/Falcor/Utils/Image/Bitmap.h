@@ -27,6 +27,7 @@
  **************************************************************************/
 #pragma once
 #include "Core/Macros.h"
+#include "Core/Enum.h"
 #include "Core/Platform/OS.h"
 #include "Core/API/Formats.h"
 #include <memory>
@@ -51,6 +52,46 @@ public:
         ExrFloat16 = 1u << 3,   //< Use half-float instead of float when writing EXRs
     };
 
+    /// Compression used when writing EXR files.
+    enum class ExrCompression
+    {
+        Default, ///< Derive the compression from the export flags.
+        None,    ///< No compression.
+        Zip,     ///< Lossless zlib compression of blocks of 16 scan lines.
+        Piz,     ///< Lossless wavelet compression.
+        Pxr24,   ///< Lossy 24-bit float compression.
+        B44,     ///< Lossy 4x4 block compression of 16-bit float data.
+        Dwaa,    ///< Lossy DCT-based compression of blocks of 32 scan lines.
+        Dwab,    ///< Lossy DCT-based compression of blocks of 256 scan lines.
+    };
+
+    FALCOR_ENUM_INFO(
+        ExrCompression,
+        {
+            {ExrCompression::Default, "Default"},
+            {ExrCompression::None, "None"},
+            {ExrCompression::Zip, "Zip"},
+            {ExrCompression::Piz, "Piz"},
+            {ExrCompression::Pxr24, "Pxr24"},
+            {ExrCompression::B44, "B44"},
+            {ExrCompression::Dwaa, "Dwaa"},
+            {ExrCompression::Dwab, "Dwab"},
+        }
+    );
+
+    /// Encoder settings refining the export flags.
+    struct EncoderOptions
+    {
+        /// zlib compression level (0-9) for PNG files. If negative, the level is derived from the export flags.
+        int pngCompressionLevel = -1;
+        /// Compression for EXR files. Explicitly compressed EXR files are written with ExrWriter and store 32-bit floats unless
+        /// ExportFlags::ExrFloat16 is set.
+        ExrCompression exrCompression = ExrCompression::Default;
+
+        // Note: Empty constructor needed for clang due to the use of the nested struct constructor in the parent constructor.
+        EncoderOptions() {}
+    };
+
     enum class ImportFlags : uint32_t
     {
         None = 0u,                  ///< Default.
@@ -99,10 +140,11 @@ public:
      * @param[in] height The height of the image.
      * @param[in] fileFormat The destination file format. See FileFormat enum above.
      * @param[in] exportFlags The flags to export the file. See ExportFlags above.
-     * @param[in] ResourceFormat the format of the resource data
+     * @param[in] ResourceFormat the format of the resource data. Floating-point data written to LDR file formats is sRGB encoded.
      * @param[in] isTopDown Control the memory layout of the image. If true, the top-left pixel will be stored first, otherwise the
      * bottom-left pixel will be stored first
      * @param[in] pData Pointer to the buffer containing the image
+     * @param[in] encoderOptions Optional encoder settings. See EncoderOptions above.
      */
     static void saveImage(
         const std::filesystem::path& path,
@@ -112,7 +154,8 @@ public:
         ExportFlags exportFlags,
         ResourceFormat resourceFormat,
         bool isTopDown,
-        void* pData
+        void* pData,
+        const EncoderOptions& encoderOptions = {}
     );
 
     /**
@@ -170,6 +213,7 @@ protected:
     ResourceFormat mFormat = ResourceFormat::Unknown;
 };
 
+FALCOR_ENUM_REGISTER(Bitmap::ExrCompression);
 FALCOR_ENUM_CLASS_OPERATORS(Bitmap::ExportFlags);
 FALCOR_ENUM_CLASS_OPERATORS(Bitmap::ImportFlags);
 } // namespace Falcor
@@ -0,0 +1,319 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "ExrWriter.h"
+#include "PixelConversion.h"
+#include "Core/Error.h"
+#include "Utils/Scripting/ScriptBindings.h"
+
+#include <ImfChannelList.h>
+#include <ImfFrameBuffer.h>
+#include <ImfHeader.h>
+#include <ImfMultiPartOutputFile.h>
+#include <ImfOutputPart.h>
+#include <ImfPartType.h>
+#include <ImfStandardAttributes.h>
+#include <ImfThreading.h>
+#include <ImfTileDescription.h>
+#include <ImfTiledOutputPart.h>
+
+#include <algorithm>
+#include <mutex>
+#include <thread>
+
+namespace Falcor
+{
+namespace
+{
+const std::string kDefaultChannelNames[] = {"R", "G", "B", "A"};
+const std::string kDefaultPartName = "rgba";
+
+Imf::Compression toImfCompression(Bitmap::ExrCompression compression)
+{
+    switch (compression)
+    {
+    case Bitmap::ExrCompression::Default:
+    case Bitmap::ExrCompression::Zip:
+        return Imf::ZIP_COMPRESSION;
+    case Bitmap::ExrCompression::None:
+        return Imf::NO_COMPRESSION;
+    case Bitmap::ExrCompression::Piz:
+        return Imf::PIZ_COMPRESSION;
+    case Bitmap::ExrCompression::Pxr24:
+        return Imf::PXR24_COMPRESSION;
+    case Bitmap::ExrCompression::B44:
+        return Imf::B44_COMPRESSION;
+    case Bitmap::ExrCompression::Dwaa:
+        return Imf::DWAA_COMPRESSION;
+    case Bitmap::ExrCompression::Dwab:
+        return Imf::DWAB_COMPRESSION;
+    default:
+        FALCOR_UNREACHABLE();
+    }
+    return Imf::ZIP_COMPRESSION;
+}
+
+Imf::PixelType toImfPixelType(ExrWriter::PixelType pixelType)
+{
+    switch (pixelType)
+    {
+    case ExrWriter::PixelType::Uint:
+        return Imf::UINT;
+    case ExrWriter::PixelType::Half:
+        return Imf::HALF;
+    case ExrWriter::PixelType::Float:
+        return Imf::FLOAT;
+    default:
+        FALCOR_UNREACHABLE();
+    }
+    return Imf::HALF;
+}
+
+void initThreadPool()
+{
+    // OpenEXR compresses blocks of scan lines or tiles in parallel, but its global thread pool is empty by default.
+    static std::once_flag flag;
+    std::call_once(
+        flag,
+        []()
+        {
+            if (Imf::globalThreadCount() == 0)
+                Imf::setGlobalThreadCount((int)std::max(std::thread::hardware_concurrency(), 1u));
+        }
+    );
+}
+} // namespace
+
+ExrWriter::ExrWriter(uint32_t width, uint32_t height, const Options& options) : mWidth(width), mHeight(height), mOptions(options)
+{
+    FALCOR_CHECK(width > 0 && height > 0, "ExrWriter: Image dimensions must be non-zero.");
+    FALCOR_CHECK(!options.tiled || options.tileSize > 0, "ExrWriter: Tile size must be non-zero.");
+}
+
+void ExrWriter::addLayer(
+    const std::string& name,
+    ResourceFormat format,
+    const void* pData,
+    PixelType pixelType,
+    std::vector<std::string> channelNames
+)
+{
+    FALCOR_CHECK(pData, "ExrWriter: Data of layer '{}' must not be nullptr.", name);
+    FALCOR_CHECK(isFormatSupported(format), "ExrWriter: Unsupported format '{}' of layer '{}'.", to_string(format), name);
+
+    const uint32_t channelCount = getFormatChannelCount(format);
+    if (channelNames.empty())
+        channelNames.assign(kDefaultChannelNames, kDefaultChannelNames + channelCount);
+    FALCOR_CHECK(
+        channelNames.size() <= channelCount,
+        "ExrWriter: Layer '{}' has {} channel names, but format '{}' only has {} channels.",
+        name,
+        channelNames.size(),
+        to_string(format),
+        channelCount
+    );
+    FALCOR_CHECK(
+        pixelType != PixelType::Uint || getFormatType(format) == FormatType::Uint,
+        "ExrWriter: Layer '{}' can only be stored as uint if the format is uint.",
+        name
+    );
+
+    FALCOR_CHECK(canAddLayer(name, channelNames), "ExrWriter: Layer '{}' conflicts with an existing layer.", name);
+
+    mLayers.push_back(Layer{name, format, pData, {}, pixelType, std::move(channelNames)});
+}
+
+void ExrWriter::addLayer(
+    const std::string& name,
+    ResourceFormat format,
+    std::vector<uint8_t> data,
+    PixelType pixelType,
+    std::vector<std::string> channelNames
+)
+{
+    FALCOR_CHECK(
+        data.size() == size_t(mWidth) * mHeight * getFormatBytesPerBlock(format),
+        "ExrWriter: Data size ({} bytes) of layer '{}' does not match the image dimensions.",
+        data.size(),
+        name
+    );
+
+    addLayer(name, format, data.data(), pixelType, std::move(channelNames));
+    // Moving the vector keeps the buffer, so the data pointer stays valid.
+    mLayers.back().data = std::move(data);
+}
+
+bool ExrWriter::canAddLayer(const std::string& name, const std::vector<std::string>& channelNames) const
+{
+    for (const auto& layer : mLayers)
+    {
+        if (layer.name != name)
+            continue;
+        if (mOptions.layout == Layout::MultiPart || channelNames.empty())
+            return false;
+        for (const auto& channelName : channelNames)
+        {
+            if (std::find(layer.channelNames.begin(), layer.channelNames.end(), channelName) != layer.channelNames.end())
+                return false;
+        }
+    }
+    return true;
+}
+
+void ExrWriter::write(const std::filesystem::path& path) const
+{
+    FALCOR_CHECK(!mLayers.empty(), "ExrWriter: No layers to write to '{}'.", path);
+
+    initThreadPool();
+
+    const bool multiPart = mOptions.layout == Layout::MultiPart;
+    const size_t partCount = multiPart ? mLayers.size() : 1;
+
+    // Create the part headers.
+    std::vector<Imf::Header> headers;
+    headers.reserve(partCount);
+    for (size_t i = 0; i < partCount; ++i)
+    {
+        Imf::Header header((int)mWidth, (int)mHeight);
+        header.compression() = toImfCompression(mOptions.compression);
+        if (header.compression() == Imf::DWAA_COMPRESSION || header.compression() == Imf::DWAB_COMPRESSION)
+            Imf::addDwaCompressionLevel(header, mOptions.dwaCompressionLevel);
+        if (mOptions.tiled)
+            header.setTileDescription(Imf::TileDescription(mOptions.tileSize, mOptions.tileSize, Imf::ONE_LEVEL));
+        header.setType(mOptions.tiled ? Imf::TILEDIMAGE : Imf::SCANLINEIMAGE);
+        if (multiPart)
+            header.setName(mLayers[i].name.empty() ? kDefaultPartName : mLayers[i].name);
+        headers.push_back(header);
+    }
+
+    // Add the channels and describe the source data. OpenEXR converts from the source to the file pixel type.
+    std::vector<Imf::FrameBuffer> frameBuffers(partCount);
+    std::vector<std::vector<float>> convertedData;
+    for (size_t i = 0; i < mLayers.size(); ++i)
+    {
+        const Layer& layer = mLayers[i];
+        Imf::Header& header = headers[multiPart ? i : 0];
+        Imf::FrameBuffer& frameBuffer = frameBuffers[multiPart ? i : 0];
+
+        const uint32_t channelCount = getFormatChannelCount(layer.format);
+        const uint32_t channelBits = getNumChannelBits(layer.format, 0);
+        const char* pBase = static_cast<const char*>(layer.pData);
+        Imf::PixelType sourceType = Imf::FLOAT;
+        size_t channelSize = sizeof(float);
+
+        switch (getFormatType(layer.format))
+        {
+        case FormatType::Float:
+            sourceType = channelBits == 16 ? Imf::HALF : Imf::FLOAT;
+            channelSize = channelBits / 8;
+            break;
+        case FormatType::Uint:
+            sourceType = Imf::UINT;
+            break;
+        default:
+        {
+            // Normalize unorm data to float.
+            const size_t count = size_t(mWidth) * mHeight * channelCount;
+            std::vector<float>& floatData = convertedData.emplace_back(count);
+            if (channelBits == 8)
+                convertIntToFloat32(static_cast<const uint8_t*>(layer.pData), floatData.data(), count);
+            else
+                convertIntToFloat32(static_cast<const uint16_t*>(layer.pData), floatData.data(), count);
+            pBase = reinterpret_cast<const char*>(floatData.data());
+            break;
+        }
+        }
+
+        const size_t xStride = channelSize * channelCount;
+        const size_t yStride = xStride * mWidth;
+        const std::string prefix = multiPart || layer.name.empty() ? "" : layer.name + ".";
+        for (size_t c = 0; c < layer.channelNames.size(); ++c)
+        {
+            const std::string channelName = prefix + layer.channelNames[c];
+            FALCOR_CHECK(header.channels().findChannel(channelName) == nullptr, "ExrWriter: Duplicate channel '{}'.", channelName);
+            header.channels().insert(channelName, Imf::Channel(toImfPixelType(layer.pixelType)));
+            frameBuffer.insert(channelName, Imf::Slice(sourceType, const_cast<char*>(pBase + c * channelSize), xStride, yStride));
+        }
+    }
+
+    try
+    {
+        Imf::MultiPartOutputFile file(path.string().c_str(), headers.data(), (int)headers.size());
+        for (int i = 0; i < (int)partCount; ++i)
+        {
+            if (mOptions.tiled)
+            {
+                Imf::TiledOutputPart part(file, i);
+                part.setFrameBuffer(frameBuffers[i]);
+                part.writeTiles(0, part.numXTiles() - 1, 0, part.numYTiles() - 1);
+            }
+            else
+            {
+                Imf::OutputPart part(file, i);
+                part.setFrameBuffer(frameBuffers[i]);
+                part.writePixels((int)mHeight);
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        FALCOR_THROW("Failed to write EXR file '{}': {}", path, e.what());
+    }
+}
+
+bool ExrWriter::isFormatSupported(ResourceFormat format)
+{
+    switch (format)
+    {
+    case ResourceFormat::R16Float:
+    case ResourceFormat::RG16Float:
+    case ResourceFormat::RGBA16Float:
+    case ResourceFormat::R32Float:
+    case ResourceFormat::RG32Float:
+    case ResourceFormat::RGB32Float:
+    case ResourceFormat::RGBA32Float:
+    case ResourceFormat::R32Uint:
+    case ResourceFormat::RG32Uint:
+    case ResourceFormat::RGB32Uint:
+    case ResourceFormat::RGBA32Uint:
+    case ResourceFormat::R8Unorm:
+    case ResourceFormat::RG8Unorm:
+    case ResourceFormat::RGBA8Unorm:
+    case ResourceFormat::R16Unorm:
+    case ResourceFormat::RG16Unorm:
+    case ResourceFormat::RGBA16Unorm:
+        return true;
+    default:
+        return false;
+    }
+}
+
+FALCOR_SCRIPT_BINDING(ExrWriter)
+{
+    pybind11::falcor_enum<ExrWriter::Layout>(m, "ExrLayout");
+}
+} // namespace Falcor
@@ -0,0 +1,173 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Bitmap.h"
+#include "Core/Macros.h"
+#include "Core/Enum.h"
+#include "Core/API/Formats.h"
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * Writer for multi-layer and multi-part OpenEXR files.
+ *
+ * Each layer is a set of named channels sharing the image dimensions. Layers are stored either as channel
+ * groups in a single part ("layer.R", "layer.G", ...) or as separate parts of a multi-part file. The pixel
+ * type can be chosen per layer, the conversion from the source format is done by OpenEXR.
+ * Compression runs on OpenEXR's global thread pool, which is initialized to the hardware concurrency on
+ * first use.
+ *
+ * The pixel data is expected in top-down order and is referenced (or owned) until write() returns.
+ */
+class FALCOR_API ExrWriter
+{
+public:
+    /// Pixel type stored in the file.
+    enum class PixelType
+    {
+        Uint,  ///< 32-bit unsigned integer.
+        Half,  ///< 16-bit float.
+        Float, ///< 32-bit float.
+    };
+
+    /// How layers are stored in the file.
+    enum class Layout
+    {
+        MultiLayer, ///< Single part, channels are prefixed by the layer name.
+        MultiPart,  ///< One part per layer, named after the layer.
+    };
+
+    FALCOR_ENUM_INFO(
+        Layout,
+        {
+            {Layout::MultiLayer, "MultiLayer"},
+            {Layout::MultiPart, "MultiPart"},
+        }
+    );
+
+    struct Options
+    {
+        /// Compression of all parts. Default maps to Zip.
+        Bitmap::ExrCompression compression = Bitmap::ExrCompression::Zip;
+        /// Storage layout of the layers.
+        Layout layout = Layout::MultiLayer;
+        /// Write tiles instead of scan lines.
+        bool tiled = false;
+        /// Tile size in pixels if tiled is set.
+        uint32_t tileSize = 64;
+        /// Compression level of the lossy DWAA/DWAB compression. Higher values give smaller files.
+        float dwaCompressionLevel = 45.f;
+
+        // Note: Empty constructor needed for clang due to the use of the nested struct constructor in the parent constructor.
+        Options() {}
+    };
+
+    /**
+     * Constructor.
+     * @param[in] width Image width in pixels.
+     * @param[in] height Image height in pixels.
+     * @param[in] options Writer options.
+     */
+    ExrWriter(uint32_t width, uint32_t height, const Options& options = {});
+
+    /**
+     * Add a layer referencing external pixel data.
+     * @param[in] name Layer name. The empty name is the default layer, whose channels are not prefixed.
+     * @param[in] format Format of the pixel data, see isFormatSupported().
+     * @param[in] pData Tightly packed pixel data in top-down order. Must stay valid until write() returns.
+     * @param[in] pixelType Pixel type stored in the file.
+     * @param[in] channelNames Channel names. If fewer names than format channels are given, only the first channels are
+     * written. If empty, the channels are named R, G, B, A.
+     */
+    void addLayer(
+        const std::string& name,
+        ResourceFormat format,
+        const void* pData,
+        PixelType pixelType = PixelType::Half,
+        std::vector<std::string> channelNames = {}
+    );
+
+    /**
+     * Add a layer owning its pixel data.
+     * Same as above, but the writer keeps the data alive.
+     */
+    void addLayer(
+        const std::string& name,
+        ResourceFormat format,
+        std::vector<uint8_t> data,
+        PixelType pixelType = PixelType::Half,
+        std::vector<std::string> channelNames = {}
+    );
+
+    /**
+     * Check if a layer can be added without conflicting with existing layers.
+     * In the multi-layer layout the channels of layers with the same name must be distinct, in the multi-part layout
+     * the layer names must be unique.
+     * @param[in] name Layer name.
+     * @param[in] channelNames Channel names. If empty, the layer conflicts with any layer of the same name.
+     */
+    bool canAddLayer(const std::string& name, const std::vector<std::string>& channelNames) const;
+
+    /// Get the number of layers.
+    size_t getLayerCount() const { return mLayers.size(); }
+
+    uint32_t getWidth() const { return mWidth; }
+    uint32_t getHeight() const { return mHeight; }
+
+    /**
+     * Write all layers to a file. Throws on error.
+     * @param[in] path File path.
+     */
+    void write(const std::filesystem::path& path) const;
+
+    /// Check if a resource format can be used as layer source. Supported are 16/32-bit float, 32-bit uint and 8/16-bit unorm
+    /// formats with R, RG, RGB or RGBA channel order.
+    static bool isFormatSupported(ResourceFormat format);
+
+private:
+    struct Layer
+    {
+        std::string name;
+        ResourceFormat format;
+        const void* pData;
+        std::vector<uint8_t> data; ///< Owned pixel data, pData points into it if not empty.
+        PixelType pixelType;
+        std::vector<std::string> channelNames;
+    };
+
+    uint32_t mWidth;
+    uint32_t mHeight;
+    Options mOptions;
+    std::vector<Layer> mLayers;
+};
+
+FALCOR_ENUM_REGISTER(ExrWriter::Layout);
+} // namespace Falcor
@@ -31,6 +31,7 @@
 #include "Core/API/CopyContext.h"
 #include "Core/API/NativeFormats.h"
 #include "Core/Platform/MemoryMappedFile.h"
+#include "Utils/Math/Common.h"
 #include "Utils/Math/ScalarMath.h"
 #include "Utils/Logger.h"
 
@@ -519,10 +520,9 @@ void readDDSHeader(ImportData& data, const void* pHeaderData, size_t& headerSize
     }
 }
 
-// Loads the information and data for the specified image. This function does not handle creation of the texture for the image.
-void loadDDS(const std::filesystem::path& path, bool loadAsSrgb, ImportData& data)
+// Reads the DDS header of a memory mapped file. Returns the size of the header in bytes.
+size_t readDDSHeader(const MemoryMappedFile& file, bool loadAsSrgb, ImportData& data)
 {
-    MemoryMappedFile file(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
     if (!file.isOpen())
     {
         FALCOR_THROW("Failed to open file.");
@@ -547,11 +547,53 @@ void loadDDS(const std::filesystem::path& path, bool loadAsSrgb, ImportData& dat
         FALCOR_THROW("No image data after DDS header.");
     }
 
+    return headerSize;
+}
+
+// Loads the information and data for the specified image. This function does not handle creation of the texture for the image.
+void loadDDS(const std::filesystem::path& path, bool loadAsSrgb, ImportData& data)
+{
+    MemoryMappedFile file(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
+    size_t headerSize = readDDSHeader(file, loadAsSrgb, data);
+
     // Read image data.
     size_t imageSize = file.getSize() - headerSize;
     data.imageData.resize(imageSize);
     std::memcpy(data.imageData.data(), reinterpret_cast<const uint8_t*>(file.getData()) + headerSize, imageSize);
 }
+
+// Computes the layout of a DDS file containing a single 2D image with mip levels.
+ImageIO::DDSLayout getDDSLayout(const ImportData& data, size_t headerSize, size_t fileSize)
+{
+    if (data.type != Resource::Type::Texture2D || data.arraySize != 1)
+        FALCOR_THROW("Expected a single 2D image, got {} with array size {}.", to_string(data.type), data.arraySize);
+
+    ImageIO::DDSLayout layout;
+    layout.format = data.format;
+    layout.width = data.width;
+    layout.height = data.height;
+    layout.mipLevels = data.mipLevels;
+
+    // Mip levels are stored contiguously from the most detailed level, each level consists of tightly packed rows of blocks.
+    const uint32_t blockWidth = getFormatWidthCompressionRatio(data.format);
+    const uint32_t blockHeight = getFormatHeightCompressionRatio(data.format);
+    const uint32_t bytesPerBlock = getFormatBytesPerBlock(data.format);
+    uint64_t offset = headerSize;
+    for (uint32_t mip = 0; mip < data.mipLevels; ++mip)
+    {
+        uint64_t width = std::max(1u, data.width >> mip);
+        uint64_t height = std::max(1u, data.height >> mip);
+        uint64_t size = div_round_up(width, (uint64_t)blockWidth) * div_round_up(height, (uint64_t)blockHeight) * bytesPerBlock;
+        layout.mipOffsets.push_back(offset);
+        layout.mipSizes.push_back(size);
+        offset += size;
+    }
+
+    if (offset > fileSize)
+        FALCOR_THROW("DDS file is too small for {} mip levels.", data.mipLevels);
+
+    return layout;
+}
 } // namespace
 
 Bitmap::UniqueConstPtr ImageIO::loadBitmapFromDDS(const std::filesystem::path& path)
@@ -577,7 +619,12 @@ Bitmap::UniqueConstPtr ImageIO::loadBitmapFromDDS(const std::filesystem::path& p
     return Bitmap::create(data.width, data.height, data.format, data.imageData.data());
 }
 
-ref<Texture> ImageIO::loadTextureFromDDS(ref<Device> pDevice, const std::filesystem::path& path, bool loadAsSrgb)
+ref<Texture> ImageIO::loadTextureFromDDS(
+    ref<Device> pDevice,
+    const std::filesystem::path& path,
+    bool loadAsSrgb,
+    ResourceBindFlags bindFlags
+)
 {
     ImportData data;
     try
@@ -595,16 +642,22 @@ ref<Texture> ImageIO::loadTextureFromDDS(ref<Device> pDevice, const std::filesys
     switch (data.type)
     {
     case Resource::Type::Texture1D:
-        pTex = pDevice->createTexture1D(data.width, data.format, data.arraySize, data.mipLevels, data.imageData.data());
+        pTex = pDevice->createTexture1D(data.width, data.format, data.arraySize, data.mipLevels, data.imageData.data(), bindFlags);
         break;
     case Resource::Type::Texture2D:
-        pTex = pDevice->createTexture2D(data.width, data.height, data.format, data.arraySize, data.mipLevels, data.imageData.data());
+        pTex = pDevice->createTexture2D(
+            data.width, data.height, data.format, data.arraySize, data.mipLevels, data.imageData.data(), bindFlags
+        );
         break;
     case Resource::Type::TextureCube:
-        pTex = pDevice->createTextureCube(data.width, data.height, data.format, data.arraySize / 6, data.mipLevels, data.imageData.data());
+        pTex = pDevice->createTextureCube(
+            data.width, data.height, data.format, data.arraySize / 6, data.mipLevels, data.imageData.data(), bindFlags
+        );
         break;
     case Resource::Type::Texture3D:
-        pTex = pDevice->createTexture3D(data.width, data.height, data.depth, data.format, data.mipLevels, data.imageData.data());
+        pTex = pDevice->createTexture3D(
+            data.width, data.height, data.depth, data.format, data.mipLevels, data.imageData.data(), bindFlags
+        );
         break;
     default:
         logWarning("Failed to load DDS image from '{}': Unrecognized texture type.", path);
@@ -619,6 +672,59 @@ ref<Texture> ImageIO::loadTextureFromDDS(ref<Device> pDevice, const std::filesys
     return pTex;
 }
 
+ImageIO::DDSLayout ImageIO::readDDSLayout(const std::filesystem::path& path, bool loadAsSrgb)
+{
+    // Only the pages containing the header are read.
+    MemoryMappedFile file(path);
+    ImportData data;
+    size_t headerSize = readDDSHeader(file, loadAsSrgb, data);
+    return getDDSLayout(data, headerSize, file.getSize());
+}
+
+ref<Texture> ImageIO::loadTextureFromDDS(
+    ref<Device> pDevice,
+    const std::filesystem::path& path,
+    bool loadAsSrgb,
+    uint32_t mostDetailedMip,
+    ResourceBindFlags bindFlags
+)
+{
+    ref<Texture> pTex;
+    try
+    {
+        MemoryMappedFile file(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::RandomAccess);
+        ImportData data;
+        size_t headerSize = readDDSHeader(file, loadAsSrgb, data);
+        DDSLayout layout = getDDSLayout(data, headerSize, file.getSize());
+        if (mostDetailedMip >= layout.mipLevels)
+            FALCOR_THROW("Mip level {} is out of range ({} mip levels).", mostDetailedMip, layout.mipLevels);
+
+        // The mip levels are uploaded directly from the mapped file, so only the pages of the requested levels are read.
+        const uint8_t* pData = reinterpret_cast<const uint8_t*>(file.getData()) + layout.mipOffsets[mostDetailedMip];
+        pTex = pDevice->createTexture2D(
+            std::max(1u, layout.width >> mostDetailedMip),
+            std::max(1u, layout.height >> mostDetailedMip),
+            layout.format,
+            1,
+            layout.mipLevels - mostDetailedMip,
+            pData,
+            bindFlags
+        );
+    }
+    catch (const RuntimeError& e)
+    {
+        logWarning("Failed to load DDS image from '{}': {}", path, e.what());
+        return nullptr;
+    }
+
+    if (pTex != nullptr)
+    {
+        pTex->setSourcePath(path);
+    }
+
+    return pTex;
+}
+
 void ImageIO::saveToDDS(const std::filesystem::path& path, const Bitmap& bitmap, CompressionMode mode, bool generateMips)
 {
     if (!hasExtension(path, "dds"))
@@ -30,6 +30,7 @@
 #include "Core/Macros.h"
 #include "Core/API/Texture.h"
 #include <filesystem>
+#include <vector>
 
 namespace Falcor
 {
@@ -72,6 +73,17 @@ public:
         None
     };
 
+    /// Layout of a DDS file containing a single 2D image with mip levels.
+    struct DDSLayout
+    {
+        ResourceFormat format = ResourceFormat::Unknown;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t mipLevels = 0;
+        std::vector<uint64_t> mipOffsets; ///< Byte offset of each mip level in the file, most detailed level first.
+        std::vector<uint64_t> mipSizes;   ///< Size in bytes of each mip level.
+    };
+
     /**
      * Load a DDS file to a Bitmap. If the file contains an image array and/or mips, only the first image will be loaded.
      * Throws an exception if the DDS file is malformed.
@@ -86,9 +98,42 @@ public:
      * @param[in] path Path of file to load.
      * @param[in] loadAsSrgb If true, convert the image format property to a corresponding sRGB format if available. Image data is not
      * changed.
+     * @param[in] bindFlags The bind flags for the texture resource.
      * @return Texture object containing image data if loading was successful. Otherwise, nullptr.
      */
-    static ref<Texture> loadTextureFromDDS(ref<Device> pDevice, const std::filesystem::path& path, bool loadAsSrgb);
+    static ref<Texture> loadTextureFromDDS(
+        ref<Device> pDevice,
+        const std::filesystem::path& path,
+        bool loadAsSrgb,
+        ResourceBindFlags bindFlags = ResourceBindFlags::ShaderResource
+    );
+
+    /**
+     * Read the layout of a DDS file containing a single 2D image with mip levels.
+     * Only the file header is read. Throws an exception if the DDS file is malformed or contains a different resource type.
+     * @param[in] path Path of file to read.
+     * @param[in] loadAsSrgb If true, convert the image format to a corresponding sRGB format if available.
+     * @return Layout of the mip levels in the file.
+     */
+    static DDSLayout readDDSLayout(const std::filesystem::path& path, bool loadAsSrgb);
+
+    /**
+     * Load a range of mip levels of a DDS file containing a single 2D image to a Texture.
+     * The file is memory mapped and only the data of mip levels [mostDetailedMip, mipLevels) is read.
+     * These become mip levels [0, mipLevels - mostDetailedMip) of the texture.
+     * @param[in] path Path of file to load.
+     * @param[in] loadAsSrgb If true, convert the image format property to a corresponding sRGB format if available.
+     * @param[in] mostDetailedMip Most detailed mip level to load.
+     * @param[in] bindFlags The bind flags for the texture resource.
+     * @return Texture object containing image data if loading was successful. Otherwise, nullptr.
+     */
+    static ref<Texture> loadTextureFromDDS(
+        ref<Device> pDevice,
+        const std::filesystem::path& path,
+        bool loadAsSrgb,
+        uint32_t mostDetailedMip,
+        ResourceBindFlags bindFlags = ResourceBindFlags::ShaderResource
+    );
 
     /**
      * Saves a bitmap to a DDS file.
@@ -0,0 +1,522 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "PixelConversion.h"
+#include "Core/Error.h"
+#include "Utils/Math/Float16.h"
+#include "Utils/Color/ColorHelpers.slang"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define FALCOR_PIXEL_CONVERSION_SSE2 1
+#include <emmintrin.h>
+#else
+#define FALCOR_PIXEL_CONVERSION_SSE2 0
+#endif
+
+namespace Falcor
+{
+namespace
+{
+/// Clamp to [0,1] with NaN and -0 mapping to +0. This matches the semantics of the SSE max/min instructions.
+inline float clampUnit(float v)
+{
+    v = v > 0.f ? v : 0.f;
+    return v < 1.f ? v : 1.f;
+}
+
+inline uint8_t floatToUnorm8(float v)
+{
+    return uint8_t(clampUnit(v) * 255.f + 0.5f);
+}
+
+inline uint16_t floatToUnorm16(float v)
+{
+    return uint16_t(clampUnit(v) * 65535.f + 0.5f);
+}
+
+inline uint8_t floatToSrgb8(float v)
+{
+    return uint8_t(linearToSRGB(clampUnit(v)) * 255.f + 0.5f);
+}
+
+template<typename T>
+void convertIntToFloat32Scalar(const T* pSrc, float* pDst, size_t count)
+{
+    const float scale = float(std::numeric_limits<T>::max());
+    for (size_t i = 0; i < count; ++i)
+        pDst[i] = float(pSrc[i]) / scale;
+}
+
+/**
+ * Lookup table for sRGB encoding.
+ * The table is indexed by the upper bits of the clamped float value. The buckets are narrow enough that the encoded
+ * value increases by at most one within a bucket, so each bucket stores the encoded value at its start and the
+ * smallest float in the bucket that encodes to the next value.
+ */
+struct SrgbEncodeTable
+{
+    static constexpr uint32_t kShift = 16;
+    static constexpr uint32_t kBucketCount = (0x3f800000u >> kShift) + 1;
+
+    std::vector<float> thresholds;
+    std::vector<uint8_t> values;
+
+    SrgbEncodeTable() : thresholds(kBucketCount), values(kBucketCount)
+    {
+        auto encodeBits = [](uint32_t bits)
+        {
+            float v;
+            std::memcpy(&v, &bits, sizeof(v));
+            return floatToSrgb8(v);
+        };
+
+        for (uint32_t b = 0; b < kBucketCount; ++b)
+        {
+            uint32_t lo = b << kShift;
+            uint32_t hi = std::min(((b + 1) << kShift) - 1, 0x3f800000u);
+            uint8_t value = encodeBits(lo);
+            values[b] = value;
+            thresholds[b] = std::numeric_limits<float>::infinity();
+            if (encodeBits(hi) == value)
+                continue;
+
+            FALCOR_ASSERT(encodeBits(hi) == value + 1);
+            // Binary search for the first float in the bucket that encodes to the next value.
+            while (lo + 1 < hi)
+            {
+                uint32_t mid = lo + (hi - lo) / 2;
+                if (encodeBits(mid) == value)
+                    lo = mid;
+                else
+                    hi = mid;
+            }
+            std::memcpy(&thresholds[b], &hi, sizeof(float));
+        }
+    }
+
+    static const SrgbEncodeTable& get()
+    {
+        static const SrgbEncodeTable table;
+        return table;
+    }
+};
+
+struct SrgbDecodeTable
+{
+    std::array<float, 256> values;
+
+    SrgbDecodeTable()
+    {
+        for (uint32_t i = 0; i < 256; ++i)
+            values[i] = sRGBToLinear(float(i) / 255.f);
+    }
+
+    static const SrgbDecodeTable& get()
+    {
+        static const SrgbDecodeTable table;
+        return table;
+    }
+};
+
+#if FALCOR_PIXEL_CONVERSION_SSE2
+inline __m128i blend(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+/// Pack the low 16 bits of each 32-bit lane of two vectors into one vector.
+inline __m128i packLow16(__m128i a, __m128i b)
+{
+    a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+    b = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+    return _mm_packs_epi32(a, b);
+}
+
+/// Convert four float16 values in the low 16 bits of each lane to float32. Matches math::float16ToFloat32().
+inline __m128 float16ToFloat32x4(__m128i h)
+{
+    const __m128i sign = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x8000)), 16);
+    const __m128i em = _mm_and_si128(h, _mm_set1_epi32(0x7fff));
+
+    // Normalized numbers: rebias the exponent. Infinity and NaN: rebias twice to get an exponent of 0xff.
+    const __m128i rebias = _mm_set1_epi32((127 - 15) << 23);
+    __m128i bits = _mm_add_epi32(_mm_slli_epi32(em, 13), rebias);
+    const __m128i isInfNan = _mm_cmpgt_epi32(em, _mm_set1_epi32(0x7bff));
+    bits = _mm_add_epi32(bits, _mm_and_si128(isInfNan, rebias));
+
+    // Denormalized numbers and zero: the value is exactly m * 2^-24.
+    const __m128i isDenorm = _mm_cmplt_epi32(em, _mm_set1_epi32(0x0400));
+    const __m128 denorm = _mm_mul_ps(_mm_cvtepi32_ps(em), _mm_set1_ps(1.f / 16777216.f));
+    bits = blend(isDenorm, _mm_castps_si128(denorm), bits);
+
+    return _mm_castsi128_ps(_mm_or_si128(bits, sign));
+}
+
+/// Convert four float32 values to float16 in the low 16 bits of each lane. Matches math::float32ToFloat16().
+inline __m128i float32ToFloat16x4(__m128 f)
+{
+    const __m128i x = _mm_castps_si128(f);
+    const __m128i absBits = _mm_and_si128(x, _mm_set1_epi32(0x7fffffff));
+    const __m128i sign = _mm_and_si128(_mm_srli_epi32(x, 16), _mm_set1_epi32(0x8000));
+
+    // Normalized half: rebias the exponent and round half away from zero.
+    // A carry out of the significand correctly increments the exponent, exponent overflow produces infinity.
+    __m128i t = _mm_sub_epi32(absBits, _mm_set1_epi32((127 - 15) << 23));
+    t = _mm_add_epi32(t, _mm_slli_epi32(_mm_and_si128(t, _mm_set1_epi32(0x1000)), 1));
+    __m128i normal = _mm_srai_epi32(t, 13);
+    normal = blend(_mm_cmpgt_epi32(normal, _mm_set1_epi32(0x7bff)), _mm_set1_epi32(0x7c00), normal);
+
+    // Denormalized half: the result is the value in units of 2^-24 rounded half up.
+    // The scaling is exact and the rounding is done in integers, as adding 0.5 in floating-point may round.
+    const __m128 scaled = _mm_mul_ps(_mm_castsi128_ps(absBits), _mm_set1_ps(16777216.f));
+    __m128i denorm = _mm_cvttps_epi32(scaled);
+    const __m128 frac = _mm_sub_ps(scaled, _mm_cvtepi32_ps(denorm));
+    denorm = _mm_sub_epi32(denorm, _mm_castps_si128(_mm_cmpge_ps(frac, _mm_set1_ps(0.5f))));
+
+    // Infinity and NaN: keep the upper significand bits, making sure a NaN doesn't turn into infinity.
+    const __m128i m = _mm_srli_epi32(_mm_and_si128(absBits, _mm_set1_epi32(0x007fffff)), 13);
+    const __m128i isNan = _mm_cmpgt_epi32(absBits, _mm_set1_epi32(0x7f800000));
+    const __m128i nanBit = _mm_and_si128(_mm_and_si128(isNan, _mm_cmpeq_epi32(m, _mm_setzero_si128())), _mm_set1_epi32(1));
+    const __m128i infNan = _mm_or_si128(_mm_or_si128(m, nanBit), _mm_set1_epi32(0x7c00));
+
+    const __m128i isDenorm = _mm_cmplt_epi32(absBits, _mm_set1_epi32(0x38800000));
+    const __m128i isInfNan = _mm_cmpgt_epi32(absBits, _mm_set1_epi32(0x7f7fffff));
+    __m128i h = blend(isInfNan, infNan, normal);
+    h = blend(isDenorm, denorm, h);
+
+    return _mm_or_si128(h, sign);
+}
+
+/// Convert four floats to integers in [0,scale], clamping to [0,1] first. NaN maps to zero.
+inline __m128i floatToUnorm(__m128 v, float scale)
+{
+    v = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.f));
+    return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, _mm_set1_ps(scale)), _mm_set1_ps(0.5f)));
+}
+
+inline void storeFloat32(float* pDst, __m128i v, float scale)
+{
+    _mm_storeu_ps(pDst, _mm_div_ps(_mm_cvtepi32_ps(v), _mm_set1_ps(scale)));
+}
+
+/// Encode one RGBA pixel to 8-bit values in each lane. The color channels are sRGB encoded, alpha is linear.
+/// The clamping, bucket computation and threshold compare are vectorized, the table lookups are scalar as SSE2 has no gather.
+inline __m128i floatToSrgbA8(__m128 v, const float* pThresholds, const uint8_t* pValues)
+{
+    const __m128 c = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.f));
+
+    alignas(16) uint32_t buckets[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(buckets), _mm_srli_epi32(_mm_castps_si128(c), SrgbEncodeTable::kShift));
+    const __m128 thresholds = _mm_setr_ps(pThresholds[buckets[0]], pThresholds[buckets[1]], pThresholds[buckets[2]], 0.f);
+    const __m128i values = _mm_setr_epi32(pValues[buckets[0]], pValues[buckets[1]], pValues[buckets[2]], 0);
+
+    // The compare mask is -1 for values at or above the threshold, subtracting it increments the encoded value.
+    const __m128i srgb = _mm_sub_epi32(values, _mm_castps_si128(_mm_cmpge_ps(c, thresholds)));
+    const __m128i unorm = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(c, _mm_set1_ps(255.f)), _mm_set1_ps(0.5f)));
+    return blend(_mm_setr_epi32(0, 0, 0, -1), unorm, srgb);
+}
+#endif // FALCOR_PIXEL_CONVERSION_SSE2
+} // namespace
+
+void convertFloat16ToFloat32(const uint16_t* pSrc, float* pDst, size_t count)
+{
+    size_t i = 0;
+#if FALCOR_PIXEL_CONVERSION_SSE2
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i));
+        _mm_storeu_ps(pDst + i, float16ToFloat32x4(_mm_unpacklo_epi16(h, _mm_setzero_si128())));
+        _mm_storeu_ps(pDst + i + 4, float16ToFloat32x4(_mm_unpackhi_epi16(h, _mm_setzero_si128())));
+    }
+#endif
+    for (; i < count; ++i)
+        pDst[i] = math::float16ToFloat32(pSrc[i]);
+}
+
+void convertFloat32ToFloat16(const float* pSrc, uint16_t* pDst, size_t count)
+{
+    size_t i = 0;
+#if FALCOR_PIXEL_CONVERSION_SSE2
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m128i lo = float32ToFloat16x4(_mm_loadu_ps(pSrc + i));
+        const __m128i hi = float32ToFloat16x4(_mm_loadu_ps(pSrc + i + 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i), packLow16(lo, hi));
+    }
+#endif
+    for (; i < count; ++i)
+        pDst[i] = math::float32ToFloat16(pSrc[i]);
+}
+
+void convertIntToFloat32(const uint8_t* pSrc, float* pDst, size_t count)
+{
+    size_t i = 0;
+#if FALCOR_PIXEL_CONVERSION_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= count; i += 16)
+    {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i));
+        const __m128i lo = _mm_unpacklo_epi8(v, zero);
+        const __m128i hi = _mm_unpackhi_epi8(v, zero);
+        storeFloat32(pDst + i, _mm_unpacklo_epi16(lo, zero), 255.f);
+        storeFloat32(pDst + i + 4, _mm_unpackhi_epi16(lo, zero), 255.f);
+        storeFloat32(pDst + i + 8, _mm_unpacklo_epi16(hi, zero), 255.f);
+        storeFloat32(pDst + i + 12, _mm_unpackhi_epi16(hi, zero), 255.f);
+    }
+#endif
+    convertIntToFloat32Scalar(pSrc + i, pDst + i, count - i);
+}
+
+void convertIntToFloat32(const uint16_t* pSrc, float* pDst, size_t count)
+{
+    size_t i = 0;
+#if FALCOR_PIXEL_CONVERSION_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i));
+        storeFloat32(pDst + i, _mm_unpacklo_epi16(v, zero), 65535.f);
+        storeFloat32(pDst + i + 4, _mm_unpackhi_epi16(v, zero), 65535.f);
+    }
+#endif
+    convertIntToFloat32Scalar(pSrc + i, pDst + i, count - i);
+}
+
+void convertIntToFloat32(const int16_t* pSrc, float* pDst, size_t count)
+{
+    size_t i = 0;
+#if FALCOR_PIXEL_CONVERSION_SSE2
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i));
+        // Sign extend to 32 bits by placing the values in the upper half of each lane.
+        storeFloat32(pDst + i, _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16), 32767.f);
+        storeFloat32(pDst + i + 4, _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16), 32767.f);
+    }
+#endif
+    convertIntToFloat32Scalar(pSrc + i, pDst + i, count - i);
+}
+
+void convertIntToFloat32(const uint32_t* pSrc, float* pDst, size_t count)
+{
+    // There is no unsigned 32-bit integer to float conversion in SSE2, the compiler handles this case.
+    convertIntToFloat32Scalar(pSrc, pDst, count);
+}
+
+void convertIntToFloat32(const int32_t* pSrc, float* pDst, size_t count)
+{
+    size_t i = 0;
+#if FALCOR_PIXEL_CONVERSION_SSE2
+    for (; i + 4 <= count; i += 4)
+        storeFloat32(pDst + i, _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i)), float(std::numeric_limits<int32_t>::max()));
+#endif
+    convertIntToFloat32Scalar(pSrc + i, pDst + i, count - i);
+}
+
+void convertFloat32ToUnorm8(const float* pSrc, uint8_t* pDst, size_t count)
+{
+    size_t i = 0;
+#if FALCOR_PIXEL_CONVERSION_SSE2
+    for (; i + 16 <= count; i += 16)
+    {
+        const __m128i a = floatToUnorm(_mm_loadu_ps(pSrc + i), 255.f);
+        const __m128i b = floatToUnorm(_mm_loadu_ps(pSrc + i + 4), 255.f);
+        const __m128i c = floatToUnorm(_mm_loadu_ps(pSrc + i + 8), 255.f);
+        const __m128i d = floatToUnorm(_mm_loadu_ps(pSrc + i + 12), 255.f);
+        const __m128i v = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i), v);
+    }
+#endif
+    for (; i < count; ++i)
+        pDst[i] = floatToUnorm8(pSrc[i]);
+}
+
+void convertFloat32ToUnorm16(const float* pSrc, uint16_t* pDst, size_t count)
+{
+    size_t i = 0;
+#if FALCOR_PIXEL_CONVERSION_SSE2
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m128i lo = floatToUnorm(_mm_loadu_ps(pSrc + i), 65535.f);
+        const __m128i hi = floatToUnorm(_mm_loadu_ps(pSrc + i + 4), 65535.f);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i), packLow16(lo, hi));
+    }
+#endif
+    for (; i < count; ++i)
+        pDst[i] = floatToUnorm16(pSrc[i]);
+}
+
+void convertSrgb8ToFloat32(const uint8_t* pSrc, float* pDst, size_t count)
+{
+    const auto& table = SrgbDecodeTable::get().values;
+    for (size_t i = 0; i < count; ++i)
+        pDst[i] = table[pSrc[i]];
+}
+
+void convertFloat32ToSrgb8(const float* pSrc, uint8_t* pDst, size_t count)
+{
+    const auto& table = SrgbEncodeTable::get();
+    const float* pThresholds = table.thresholds.data();
+    const uint8_t* pValues = table.values.data();
+    for (size_t i = 0; i < count; ++i)
+    {
+        float v = clampUnit(pSrc[i]);
+        uint32_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        uint32_t bucket = bits >> SrgbEncodeTable::kShift;
+        pDst[i] = uint8_t(pValues[bucket] + (v >= pThresholds[bucket] ? 1 : 0));
+    }
+}
+
+void convertRGBA32FloatToRGBA8Srgb(const float* pSrc, uint8_t* pDst, size_t pixelCount)
+{
+    const auto& table = SrgbEncodeTable::get();
+    const float* pThresholds = table.thresholds.data();
+    const uint8_t* pValues = table.values.data();
+
+    size_t i = 0;
+#if FALCOR_PIXEL_CONVERSION_SSE2
+    for (; i + 4 <= pixelCount; i += 4)
+    {
+        const __m128i a = floatToSrgbA8(_mm_loadu_ps(pSrc + i * 4), pThresholds, pValues);
+        const __m128i b = floatToSrgbA8(_mm_loadu_ps(pSrc + i * 4 + 4), pThresholds, pValues);
+        const __m128i c = floatToSrgbA8(_mm_loadu_ps(pSrc + i * 4 + 8), pThresholds, pValues);
+        const __m128i d = floatToSrgbA8(_mm_loadu_ps(pSrc + i * 4 + 12), pThresholds, pValues);
+        const __m128i v = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i * 4), v);
+    }
+#endif
+    for (; i < pixelCount; ++i)
+    {
+        for (uint32_t j = 0; j < 3; ++j)
+        {
+            float v = clampUnit(pSrc[i * 4 + j]);
+            uint32_t bits;
+            std::memcpy(&bits, &v, sizeof(bits));
+            uint32_t bucket = bits >> SrgbEncodeTable::kShift;
+            pDst[i * 4 + j] = uint8_t(pValues[bucket] + (v >= pThresholds[bucket] ? 1 : 0));
+        }
+        pDst[i * 4 + 3] = floatToUnorm8(pSrc[i * 4 + 3]);
+    }
+}
+
+void expandToRGBA32Float(const float* pSrc, uint32_t srcChannelCount, float* pDst, size_t pixelCount)
+{
+    FALCOR_CHECK(srcChannelCount >= 1 && srcChannelCount <= 4, "Invalid channel count {}.", srcChannelCount);
+
+    switch (srcChannelCount)
+    {
+    case 1:
+        for (size_t i = 0; i < pixelCount; ++i, pDst += 4)
+        {
+            pDst[0] = pSrc[i];
+            pDst[1] = 0.f;
+            pDst[2] = 0.f;
+            pDst[3] = 1.f;
+        }
+        break;
+    case 2:
+        for (size_t i = 0; i < pixelCount; ++i, pSrc += 2, pDst += 4)
+        {
+            pDst[0] = pSrc[0];
+            pDst[1] = pSrc[1];
+            pDst[2] = 0.f;
+            pDst[3] = 1.f;
+        }
+        break;
+    case 3:
+        for (size_t i = 0; i < pixelCount; ++i, pSrc += 3, pDst += 4)
+        {
+            pDst[0] = pSrc[0];
+            pDst[1] = pSrc[1];
+            pDst[2] = pSrc[2];
+            pDst[3] = 1.f;
+        }
+        break;
+    case 4:
+        std::memcpy(pDst, pSrc, pixelCount * 4 * sizeof(float));
+        break;
+    }
+}
+
+void extractRGBFromRGBA32Float(const float* pSrc, float* pDst, size_t pixelCount)
+{
+    for (size_t i = 0; i < pixelCount; ++i, pSrc += 4, pDst += 3)
+    {
+        pDst[0] = pSrc[0];
+        pDst[1] = pSrc[1];
+        pDst[2] = pSrc[2];
+    }
+}
+
+void swizzleRGBA8ToBGRA8(const uint8_t* pSrc, uint8_t* pDst, size_t pixelCount, bool forceOpaque)
+{
+    const uint32_t alpha = forceOpaque ? 0xff000000u : 0u;
+    size_t i = 0;
+#if FALCOR_PIXEL_CONVERSION_SSE2
+    const __m128i rbMask = _mm_set1_epi32(0x00ff00ff);
+    const __m128i alphaMask = _mm_set1_epi32(int(alpha));
+    for (; i + 4 <= pixelCount; i += 4)
+    {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i * 4));
+        const __m128i rb = _mm_and_si128(v, rbMask);
+        const __m128i ga = _mm_andnot_si128(rbMask, v);
+        const __m128i br = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i * 4), _mm_or_si128(_mm_or_si128(ga, br), alphaMask));
+    }
+#endif
+    for (; i < pixelCount; ++i)
+    {
+        uint32_t v;
+        std::memcpy(&v, pSrc + i * 4, sizeof(v));
+        const uint32_t rb = v & 0x00ff00ffu;
+        v = (v & 0xff00ff00u) | (rb << 16) | (rb >> 16) | alpha;
+        std::memcpy(pDst + i * 4, &v, sizeof(v));
+    }
+}
+
+void flipRowsVertically(void* pData, size_t rowPitch, uint32_t rowCount)
+{
+    std::vector<uint8_t> row(rowPitch);
+    uint8_t* pBytes = static_cast<uint8_t*>(pData);
+    for (uint32_t y = 0; y < rowCount / 2; ++y)
+    {
+        uint8_t* pTop = pBytes + y * rowPitch;
+        uint8_t* pBottom = pBytes + (rowCount - y - 1) * rowPitch;
+        std::memcpy(row.data(), pTop, rowPitch);
+        std::memcpy(pTop, pBottom, rowPitch);
+        std::memcpy(pBottom, row.data(), rowPitch);
+    }
+}
+
+} // namespace Falcor
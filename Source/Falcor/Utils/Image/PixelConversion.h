@@ -0,0 +1,153 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace Falcor
+{
+/**
+ * Bulk pixel format conversion kernels.
+ *
+ * These functions convert spans of pixel data and are used on the image import/export paths.
+ * On x64 the kernels are vectorized with SSE2, elsewhere a scalar fallback is used.
+ * All kernels produce results that are bit-identical to their scalar counterparts, in particular
+ * the float16 conversions match math::float32ToFloat16() and math::float16ToFloat32() exactly
+ * (hardware F16C conversion is not used since it rounds ties to even rather than away from zero).
+ *
+ * Unless noted otherwise, source and destination must not overlap.
+ */
+
+/**
+ * Convert float16 values to float32.
+ * @param[in] pSrc Source values (float16 bit patterns).
+ * @param[out] pDst Destination values.
+ * @param[in] count Number of values.
+ */
+FALCOR_API void convertFloat16ToFloat32(const uint16_t* pSrc, float* pDst, size_t count);
+
+/**
+ * Convert float32 values to float16.
+ * @param[in] pSrc Source values.
+ * @param[out] pDst Destination values (float16 bit patterns).
+ * @param[in] count Number of values.
+ */
+FALCOR_API void convertFloat32ToFloat16(const float* pSrc, uint16_t* pDst, size_t count);
+
+/**
+ * Convert integer values to float32, normalized by the maximum value of the source type.
+ * Unsigned integers map to [0,1], signed integers to approximately [-1,1].
+ * @param[in] pSrc Source values.
+ * @param[out] pDst Destination values.
+ * @param[in] count Number of values.
+ */
+FALCOR_API void convertIntToFloat32(const uint8_t* pSrc, float* pDst, size_t count);
+FALCOR_API void convertIntToFloat32(const uint16_t* pSrc, float* pDst, size_t count);
+FALCOR_API void convertIntToFloat32(const int16_t* pSrc, float* pDst, size_t count);
+FALCOR_API void convertIntToFloat32(const uint32_t* pSrc, float* pDst, size_t count);
+FALCOR_API void convertIntToFloat32(const int32_t* pSrc, float* pDst, size_t count);
+
+/**
+ * Convert float32 values to 8-bit unorm. Values are clamped to [0,1] and rounded to nearest, NaN maps to zero.
+ * @param[in] pSrc Source values.
+ * @param[out] pDst Destination values.
+ * @param[in] count Number of values.
+ */
+FALCOR_API void convertFloat32ToUnorm8(const float* pSrc, uint8_t* pDst, size_t count);
+
+/**
+ * Convert float32 values to 16-bit unorm. Values are clamped to [0,1] and rounded to nearest, NaN maps to zero.
+ * @param[in] pSrc Source values.
+ * @param[out] pDst Destination values.
+ * @param[in] count Number of values.
+ */
+FALCOR_API void convertFloat32ToUnorm16(const float* pSrc, uint16_t* pDst, size_t count);
+
+/**
+ * Decode 8-bit sRGB values to linear float32 using sRGBToLinear().
+ * @param[in] pSrc Source values.
+ * @param[out] pDst Destination values.
+ * @param[in] count Number of values.
+ */
+FALCOR_API void convertSrgb8ToFloat32(const uint8_t* pSrc, float* pDst, size_t count);
+
+/**
+ * Encode linear float32 values to 8-bit sRGB.
+ * The result is identical to rounding linearToSRGB() of the value clamped to [0,1], NaN maps to zero.
+ * @param[in] pSrc Source values.
+ * @param[out] pDst Destination values.
+ * @param[in] count Number of values.
+ */
+FALCOR_API void convertFloat32ToSrgb8(const float* pSrc, uint8_t* pDst, size_t count);
+
+/**
+ * Encode float32 RGBA pixels to 8-bit RGBA pixels for export to LDR image formats.
+ * The color channels are sRGB encoded, identical to rounding linearToSRGB() of the value clamped to [0,1].
+ * The alpha channel is linear, clamped to [0,1] and rounded to nearest. NaN maps to zero.
+ * @param[in] pSrc Source RGBA pixels.
+ * @param[out] pDst Destination RGBA pixels.
+ * @param[in] pixelCount Number of pixels.
+ */
+FALCOR_API void convertRGBA32FloatToRGBA8Srgb(const float* pSrc, uint8_t* pDst, size_t pixelCount);
+
+/**
+ * Expand float32 pixels with 1-4 channels to RGBA. Missing color channels are set to 0 and missing alpha to 1.
+ * @param[in] pSrc Source pixels.
+ * @param[in] srcChannelCount Number of channels in the source pixels (1-4).
+ * @param[out] pDst Destination RGBA pixels.
+ * @param[in] pixelCount Number of pixels.
+ */
+FALCOR_API void expandToRGBA32Float(const float* pSrc, uint32_t srcChannelCount, float* pDst, size_t pixelCount);
+
+/**
+ * Extract the RGB channels of float32 RGBA pixels.
+ * @param[in] pSrc Source RGBA pixels.
+ * @param[out] pDst Destination RGB pixels.
+ * @param[in] pixelCount Number of pixels.
+ */
+FALCOR_API void extractRGBFromRGBA32Float(const float* pSrc, float* pDst, size_t pixelCount);
+
+/**
+ * Swap the red and blue channels of 8-bit RGBA pixels (RGBA <-> BGRA). Source and destination may be identical.
+ * @param[in] pSrc Source pixels.
+ * @param[out] pDst Destination pixels.
+ * @param[in] pixelCount Number of pixels.
+ * @param[in] forceOpaque If true, the alpha channel of the destination is set to 0xff.
+ */
+FALCOR_API void swizzleRGBA8ToBGRA8(const uint8_t* pSrc, uint8_t* pDst, size_t pixelCount, bool forceOpaque = false);
+
+/**
+ * Flip an image vertically in place.
+ * @param[in,out] pData Image data.
+ * @param[in] rowPitch Size of a row in bytes.
+ * @param[in] rowCount Number of rows.
+ */
+FALCOR_API void flipRowsVertically(void* pData, size_t rowPitch, uint32_t rowCount);
+
+} // namespace Falcor
@@ -0,0 +1,314 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "TextureCache.h"
+#include "Core/API/Device.h"
+#include "Core/API/Texture.h"
+#include "Core/Platform/OS.h"
+#include "Core/Platform/MemoryMappedFile.h"
+#include "Utils/Logger.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+const std::string kDirectory = "NVIDIA/Falcor/TextureCache";
+
+/// Version of the cache entries. Increment when the processing of entries changes to invalidate existing entries.
+const uint32_t kCacheVersion = 1;
+
+static constexpr bool kTopDown = true; // Memory layout when loading from file
+
+/**
+ * Determine the compression mode used for storing a bitmap in the cache.
+ * Only formats that are stored without changing the format semantics are cached.
+ * @param[in] bitmap Decoded source bitmap.
+ * @param[in] requestedMode Requested compression mode.
+ * @return The compression mode, or an empty optional if the bitmap cannot be cached.
+ */
+std::optional<ImageIO::CompressionMode> getEntryCompressionMode(const Bitmap& bitmap, ImageIO::CompressionMode requestedMode)
+{
+    // The DX spec requires the dimensions of BC encoded textures to be a multiple of 4.
+    bool compressible = requestedMode != ImageIO::CompressionMode::None && bitmap.getWidth() % 4 == 0 && bitmap.getHeight() % 4 == 0;
+
+    switch (bitmap.getFormat())
+    {
+    case ResourceFormat::BGRA8Unorm:
+        return compressible ? requestedMode : ImageIO::CompressionMode::None;
+    case ResourceFormat::RG8Unorm:
+        // NVTT pads two-channel images to four channels, so only cache them as two-channel BC5.
+        if (compressible)
+            return ImageIO::CompressionMode::BC5;
+        return {};
+    case ResourceFormat::RGBA16Float:
+    case ResourceFormat::RGBA32Float:
+        return ImageIO::CompressionMode::None;
+    default:
+        return {};
+    }
+}
+} // namespace
+
+TextureCache::TextureCache(const Options& options) : mOptions(options)
+{
+    if (mOptions.directory.empty())
+        mOptions.directory = getAppDataDirectory() / kDirectory;
+
+    // Determine the current cache size.
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(mOptions.directory, ec))
+    {
+        if (entry.is_regular_file(ec) && hasExtension(entry.path(), "dds"))
+            mStats.sizeInBytes += entry.file_size(ec);
+    }
+}
+
+ref<Texture> TextureCache::loadTexture(
+    ref<Device> pDevice,
+    const std::filesystem::path& path,
+    bool generateMipLevels,
+    bool loadAsSRGB,
+    ResourceBindFlags bindFlags,
+    Bitmap::ImportFlags importFlags
+)
+{
+    Bitmap::UniqueConstPtr pBitmap;
+    std::filesystem::path entryPath = getEntry(path, generateMipLevels, bindFlags, importFlags, &pBitmap);
+
+    // Load from the cache entry.
+    if (!entryPath.empty())
+    {
+        if (ref<Texture> pTex = ImageIO::loadTextureFromDDS(pDevice, entryPath, loadAsSRGB, bindFlags))
+        {
+            pTex->setSourcePath(path);
+            pTex->setImportFlags(importFlags);
+            return pTex;
+        }
+        logWarning("Failed to load texture cache entry '{}' for '{}'.", entryPath, path);
+    }
+
+    // Create the texture from the decoded bitmap if it could not be cached.
+    if (pBitmap)
+        return createTexture(pDevice, *pBitmap, path, generateMipLevels, loadAsSRGB, bindFlags, importFlags);
+
+    return Texture::createFromFile(pDevice, path, generateMipLevels, loadAsSRGB, bindFlags, importFlags);
+}
+
+std::filesystem::path TextureCache::getEntry(
+    const std::filesystem::path& path,
+    bool generateMipLevels,
+    ResourceBindFlags bindFlags,
+    Bitmap::ImportFlags importFlags,
+    Bitmap::UniqueConstPtr* pBitmap
+)
+{
+    // DDS files are already stored in a format that is ready for upload.
+    if (hasExtension(path, "dds") || !std::filesystem::exists(path))
+        return {};
+
+    // Block compressed textures cannot be bound for writing.
+    ImageIO::CompressionMode compressionMode = mOptions.compressionMode;
+    if (is_set(bindFlags, ResourceBindFlags::UnorderedAccess) || is_set(bindFlags, ResourceBindFlags::RenderTarget))
+        compressionMode = ImageIO::CompressionMode::None;
+
+    const std::filesystem::path entryPath = getEntryPath(computeKey(path, generateMipLevels, importFlags, compressionMode));
+
+    // Use an existing cache entry. Only the header is validated, entries are written atomically.
+    if (std::filesystem::exists(entryPath))
+    {
+        try
+        {
+            ImageIO::readDDSLayout(entryPath, false);
+
+            // Mark the entry as recently used.
+            std::error_code ec;
+            std::filesystem::last_write_time(entryPath, std::filesystem::file_time_type::clock::now(), ec);
+
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStats.hitCount++;
+            return entryPath;
+        }
+        catch (const std::exception& e)
+        {
+            logWarning("Invalid texture cache entry '{}' for '{}': {}. Rebuilding the entry.", entryPath, path, e.what());
+        }
+    }
+
+    // Decode the source file.
+    Bitmap::UniqueConstPtr pDecoded = Bitmap::createFromFile(path, kTopDown, importFlags);
+    if (!pDecoded)
+        return {};
+
+    // Write the processed texture to the cache.
+    // The entry is written to a temporary file first so that other threads or processes never see a partial entry.
+    if (auto entryMode = getEntryCompressionMode(*pDecoded, compressionMode))
+    {
+        try
+        {
+            std::filesystem::create_directories(entryPath.parent_path());
+            std::filesystem::path tmpPath = entryPath;
+            tmpPath += fmt::format(".{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+            ImageIO::saveToDDS(tmpPath, *pDecoded, *entryMode, generateMipLevels);
+            std::filesystem::rename(tmpPath, entryPath);
+            addEntry(entryPath);
+            return entryPath;
+        }
+        catch (const std::exception& e)
+        {
+            logWarning("Failed to write texture cache entry for '{}': {}", path, e.what());
+        }
+    }
+
+    if (pBitmap)
+        *pBitmap = std::move(pDecoded);
+    return {};
+}
+
+ref<Texture> TextureCache::createTexture(
+    ref<Device> pDevice,
+    const Bitmap& bitmap,
+    const std::filesystem::path& path,
+    bool generateMipLevels,
+    bool loadAsSRGB,
+    ResourceBindFlags bindFlags,
+    Bitmap::ImportFlags importFlags
+)
+{
+    ResourceFormat texFormat = bitmap.getFormat();
+    if (loadAsSRGB)
+        texFormat = linearToSrgbFormat(texFormat);
+
+    ref<Texture> pTex = pDevice->createTexture2D(
+        bitmap.getWidth(), bitmap.getHeight(), texFormat, 1, generateMipLevels ? Texture::kMaxPossible : 1, bitmap.getData(), bindFlags
+    );
+
+    if (pTex)
+    {
+        pTex->setSourcePath(path);
+        pTex->setImportFlags(importFlags);
+    }
+
+    return pTex;
+}
+
+TextureCache::Key TextureCache::computeKey(
+    const std::filesystem::path& path,
+    bool generateMipLevels,
+    Bitmap::ImportFlags importFlags,
+    ImageIO::CompressionMode compressionMode
+)
+{
+    SHA1 sha1;
+    sha1.update(kCacheVersion);
+    sha1.update(generateMipLevels);
+    sha1.update(static_cast<uint32_t>(importFlags));
+    sha1.update(static_cast<uint32_t>(compressionMode));
+
+    // Hash the file content, so that entries are independent of the file location and invalidated when the file changes.
+    MemoryMappedFile file(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
+    if (!file.isOpen())
+        FALCOR_THROW("Failed to open texture file '{}'.", path);
+    sha1.update(file.getData(), file.getSize());
+
+    return sha1.finalize();
+}
+
+void TextureCache::evict(uint64_t maxSizeInBytes)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    struct Entry
+    {
+        std::filesystem::path path;
+        std::filesystem::file_time_type lastUsed;
+        uint64_t size;
+    };
+
+    // Gather all entries. The size is recomputed as other processes may share the cache directory.
+    std::vector<Entry> entries;
+    uint64_t totalSize = 0;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(mOptions.directory, ec))
+    {
+        if (!entry.is_regular_file(ec) || !hasExtension(entry.path(), "dds"))
+            continue;
+        Entry e{entry.path(), entry.last_write_time(ec), entry.file_size(ec)};
+        totalSize += e.size;
+        entries.push_back(std::move(e));
+    }
+
+    // Remove least recently used entries first.
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.lastUsed < b.lastUsed; });
+    for (const auto& entry : entries)
+    {
+        if (totalSize <= maxSizeInBytes)
+            break;
+        if (std::filesystem::remove(entry.path, ec))
+        {
+            totalSize -= entry.size;
+            mStats.evictCount++;
+        }
+    }
+
+    mStats.sizeInBytes = totalSize;
+}
+
+TextureCache::Stats TextureCache::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats;
+}
+
+std::filesystem::path TextureCache::getEntryPath(const Key& key) const
+{
+    return mOptions.directory / (SHA1::toString(key) + ".dds");
+}
+
+void TextureCache::addEntry(const std::filesystem::path& entryPath)
+{
+    std::error_code ec;
+    uint64_t size = std::filesystem::file_size(entryPath, ec);
+
+    bool overBudget = false;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStats.missCount++;
+        mStats.sizeInBytes += ec ? 0 : size;
+        overBudget = mStats.sizeInBytes > mOptions.maxSizeInBytes;
+    }
+
+    if (overBudget)
+        evict(mOptions.maxSizeInBytes);
+}
+} // namespace Falcor
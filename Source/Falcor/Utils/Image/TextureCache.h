@@ -0,0 +1,180 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Bitmap.h"
+#include "ImageIO.h"
+#include "Core/Macros.h"
+#include "Core/API/fwd.h"
+#include "Core/API/Resource.h"
+#include "Utils/CryptoUtils.h"
+#include <filesystem>
+#include <mutex>
+#include <optional>
+
+namespace Falcor
+{
+/**
+ * Persistent on-disk cache of processed textures.
+ *
+ * Decoding image files and converting them to a GPU format is expensive, and mip levels
+ * are regenerated every time a texture is loaded. The texture cache stores the processed
+ * texture as a DDS file containing the full mip chain, optionally block compressed.
+ * Subsequent loads of the same source file read the DDS file and upload it as-is.
+ *
+ * Cache entries are keyed by a hash of the source file content and the import settings,
+ * so entries are reused when a file is moved and invalidated when it is modified.
+ * The total size of the cache is bounded, least recently used entries are evicted first.
+ * The access time of an entry is stored in its file modification time, so the eviction
+ * order persists across runs.
+ *
+ * All operations are thread-safe, so the cache can be populated from multiple threads.
+ */
+class FALCOR_API TextureCache
+{
+public:
+    using Key = SHA1::MD;
+
+    struct Options
+    {
+        /// Cache directory. If empty, the default directory in the application data directory is used.
+        std::filesystem::path directory;
+        /// Maximum total size of the cache in bytes.
+        uint64_t maxSizeInBytes = 16ull * 1024 * 1024 * 1024;
+        /// Block compression mode for 8-bit color textures (BC1, BC3 or BC7). Two-channel 8-bit textures use BC5 instead.
+        /// Textures are only compressed if their dimensions are a multiple of 4 and they are not bound for writing.
+        ImageIO::CompressionMode compressionMode = ImageIO::CompressionMode::None;
+
+        // Note: Empty constructor needed for clang due to the use of the nested struct constructor in the parent constructor.
+        Options() {}
+    };
+
+    struct Stats
+    {
+        uint64_t hitCount = 0;      ///< Number of textures loaded from the cache.
+        uint64_t missCount = 0;     ///< Number of textures added to the cache.
+        uint64_t evictCount = 0;    ///< Number of entries evicted from the cache.
+        uint64_t sizeInBytes = 0;   ///< Current total size of the cache in bytes.
+    };
+
+    /**
+     * Constructor. Scans the cache directory to determine the current cache size.
+     * @param[in] options Cache options.
+     */
+    TextureCache(const Options& options = Options());
+
+    /**
+     * Load a texture from file through the cache.
+     * If a cache entry exists, the texture is loaded from it. Otherwise the source file is decoded,
+     * processed and written to the cache before loading. Source files that cannot be stored in the
+     * cache without changing their format (DDS files, formats with less than four channels) are loaded directly.
+     * The parameters are the same as for Texture::createFromFile().
+     * @return The texture, or nullptr if loading failed.
+     */
+    ref<Texture> loadTexture(
+        ref<Device> pDevice,
+        const std::filesystem::path& path,
+        bool generateMipLevels,
+        bool loadAsSRGB,
+        ResourceBindFlags bindFlags = ResourceBindFlags::ShaderResource,
+        Bitmap::ImportFlags importFlags = Bitmap::ImportFlags::None
+    );
+
+    /**
+     * Get the cache entry for a source file, creating the entry if it does not exist.
+     * The entry is a DDS file containing a single 2D image with all mip levels stored contiguously,
+     * so individual mip levels can be read with ImageIO::readDDSLayout().
+     * @param[in] path Source file path.
+     * @param[in] generateMipLevels Whether the full mip chain is generated.
+     * @param[in] bindFlags The bind flags for the texture resource. Textures bound for writing are not compressed.
+     * @param[in] importFlags Flags used for the file import.
+     * @param[out] pBitmap If the source file was decoded but cannot be cached, receives the decoded bitmap (optional).
+     * @return Path of the cache entry, or an empty path if the source file cannot be cached.
+     */
+    std::filesystem::path getEntry(
+        const std::filesystem::path& path,
+        bool generateMipLevels,
+        ResourceBindFlags bindFlags,
+        Bitmap::ImportFlags importFlags,
+        Bitmap::UniqueConstPtr* pBitmap = nullptr
+    );
+
+    /**
+     * Create a texture from a decoded bitmap, as done for source files that cannot be cached.
+     * The parameters are the same as for Texture::createFromFile().
+     * @return The texture, or nullptr if creation failed.
+     */
+    static ref<Texture> createTexture(
+        ref<Device> pDevice,
+        const Bitmap& bitmap,
+        const std::filesystem::path& path,
+        bool generateMipLevels,
+        bool loadAsSRGB,
+        ResourceBindFlags bindFlags,
+        Bitmap::ImportFlags importFlags
+    );
+
+    /**
+     * Compute the cache key for a source file.
+     * @param[in] path Source file path.
+     * @param[in] generateMipLevels Whether the full mip chain is generated.
+     * @param[in] importFlags Flags used for the file import.
+     * @param[in] compressionMode Block compression mode used for the entry.
+     * @return The cache key.
+     */
+    static Key computeKey(
+        const std::filesystem::path& path,
+        bool generateMipLevels,
+        Bitmap::ImportFlags importFlags,
+        ImageIO::CompressionMode compressionMode
+    );
+
+    /**
+     * Evict least recently used entries until the cache size is within the given size.
+     * @param[in] maxSizeInBytes Maximum size in bytes.
+     */
+    void evict(uint64_t maxSizeInBytes);
+
+    /**
+     * Remove all entries from the cache.
+     */
+    void clear() { evict(0); }
+
+    const Options& getOptions() const { return mOptions; }
+
+    Stats getStats() const;
+
+private:
+    std::filesystem::path getEntryPath(const Key& key) const;
+    void addEntry(const std::filesystem::path& entryPath);
+
+    Options mOptions;
+
+    mutable std::mutex mMutex;
+    Stats mStats;
+};
+} // namespace Falcor
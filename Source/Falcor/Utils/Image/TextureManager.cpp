@@ -28,9 +28,12 @@
 #include "TextureManager.h"
 #include "Core/AssetResolver.h"
 #include "Core/API/Device.h"
+#include "Core/API/RenderContext.h"
+#include "Core/Platform/MemoryMappedFile.h"
 #include "Utils/Logger.h"
 #include "Utils/NumericRange.h"
 
+#include <algorithm>
 #include <execution>
 
 // Temporarily disable asynchronous texture loader until Falcor supports parallel GPU work submission.
@@ -43,6 +46,27 @@ namespace
 {
 const size_t kMaxTextureHandleCount = std::numeric_limits<uint32_t>::max();
 static_assert(TextureManager::CpuTextureHandle::kInvalidID >= kMaxTextureHandleCount);
+
+/// Returns the most detailed mip level of the mip tail of a streamed texture.
+uint32_t getTailMip(const ImageIO::DDSLayout& layout, uint32_t tailSize)
+{
+    // The most detailed mip level of a block compressed texture needs dimensions that are a multiple of the block size.
+    const uint32_t blockWidth = getFormatWidthCompressionRatio(layout.format);
+    const uint32_t blockHeight = getFormatHeightCompressionRatio(layout.format);
+
+    uint32_t tailMip = 0;
+    while (tailMip + 1 < layout.mipLevels)
+    {
+        if (std::max(1u, layout.width >> tailMip) <= tailSize && std::max(1u, layout.height >> tailMip) <= tailSize)
+            break;
+        uint32_t nextWidth = std::max(1u, layout.width >> (tailMip + 1));
+        uint32_t nextHeight = std::max(1u, layout.height >> (tailMip + 1));
+        if (nextWidth % blockWidth != 0 || nextHeight % blockHeight != 0)
+            break;
+        tailMip++;
+    }
+    return tailMip;
+}
 } // namespace
 
 TextureManager::TextureManager(ref<Device> pDevice, size_t maxTextureCount, size_t threadCount)
@@ -323,15 +347,8 @@ TextureManager::CpuTextureHandle TextureManager::loadTexture(
         }
 #else
         // Load texture from main thread.
-        ref<Texture> pTexture;
-        if (paths.size() > 1)
-        {
-            pTexture = Texture::createMippedFromFiles(mpDevice, paths, loadAsSRGB, bindFlags, importFlags);
-        }
-        else
-        {
-            pTexture = Texture::createFromFile(mpDevice, paths[0], generateMipLevels, loadAsSRGB, bindFlags, importFlags);
-        }
+        StreamedTexture streamed;
+        ref<Texture> pTexture = loadTextureFromFiles(textureKey, &streamed);
 
         // Add new texture desc.
         TextureDesc desc = {TextureState::Loaded, pTexture};
@@ -344,6 +361,9 @@ TextureManager::CpuTextureHandle TextureManager::loadTexture(
         if (pTexture)
             mTextureToHandle[pTexture.get()] = handle;
 
+        if (streamed.pTailTexture)
+            addStreamedTexture(handle, std::move(streamed));
+
         mCondition.notify_all();
 #endif
     }
@@ -391,6 +411,7 @@ void TextureManager::endDeferredLoading()
     {
         TextureKey key;
         CpuTextureHandle handle;
+        StreamedTexture streamed;
     };
 
     // Get a list of textures to load.
@@ -399,7 +420,7 @@ void TextureManager::endDeferredLoading()
     {
         auto& desc = getDesc(handle);
         if (desc.state == TextureState::Referenced)
-            jobs.push_back(Job{key, handle});
+            jobs.push_back(Job{key, handle, {}});
     }
 
     // Early out if there are no textures to load.
@@ -416,21 +437,9 @@ void TextureManager::endDeferredLoading()
         jobRange.end(),
         [&](size_t i)
         {
-            const auto& job = jobs[i];
+            auto& job = jobs[i];
             auto& desc = getDesc(job.handle);
-            if (job.key.fullPaths.size() == 1)
-            {
-                desc.pTexture = Texture::createFromFile(
-                    mpDevice, job.key.fullPaths[0], job.key.generateMipLevels, job.key.loadAsSRGB, job.key.bindFlags, job.key.importFlags
-                );
-                logDebug("Loading texture from '{}'", job.key.fullPaths[0]);
-            }
-            else
-            {
-                desc.pTexture =
-                    Texture::createMippedFromFiles(mpDevice, job.key.fullPaths, job.key.loadAsSRGB, job.key.bindFlags, job.key.importFlags);
-                logDebug("Loading mipped texture from '{}'", job.key.fullPaths[0]);
-            }
+            desc.pTexture = loadTextureFromFiles(job.key, &job.streamed);
             if (texturesLoaded.fetch_add(1) % 10 == 9)
             {
                 logDebug("Flush");
@@ -442,11 +451,25 @@ void TextureManager::endDeferredLoading()
     mpDevice->wait();
 
     // Mark loaded textures and add them to lookup table.
-    for (const auto& job : jobs)
+    for (auto& job : jobs)
     {
         auto& desc = getDesc(job.handle);
         desc.state = desc.pTexture ? TextureState::Loaded : TextureState::Invalid;
         mTextureToHandle[desc.pTexture.get()] = job.handle;
+        if (job.streamed.pTailTexture)
+            addStreamedTexture(job.handle, std::move(job.streamed));
+    }
+
+    if (mpTextureCache)
+    {
+        auto stats = mpTextureCache->getStats();
+        logInfo(
+            "Texture cache: {} hits, {} misses, {} evicted, {:.1f} MB in use.",
+            stats.hitCount,
+            stats.missCount,
+            stats.evictCount,
+            stats.sizeInBytes / (1024.0 * 1024.0)
+        );
     }
 }
 
@@ -498,6 +521,14 @@ void TextureManager::removeNonUdimTexture(const CpuTextureHandle& handle)
         mTextureToHandle.erase(desc.pTexture.get());
     }
 
+    // Remove streaming state, including the alias of the initial mip tail texture.
+    if (auto it = mStreamedTextures.find(handle.getID()); it != mStreamedTextures.end())
+    {
+        mTextureToHandle.erase(it->second.pTailTexture.get());
+        mResidencyScheduler.removeTexture(handle.getID());
+        mStreamedTextures.erase(it);
+    }
+
     // Clear texture desc.
     desc = {};
 
@@ -645,6 +676,231 @@ TextureManager::Stats TextureManager::getStats() const
     return s;
 }
 
+void TextureManager::setResidencyOptions(const ResidencyOptions& options)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (options.enabled && !mpTextureCache)
+        logWarning("TextureManager::setResidencyOptions() - Texture streaming requires a texture cache. Textures are loaded fully.");
+
+    mResidencyOptions = options;
+    mResidencyScheduler.setOptions(options.scheduler);
+}
+
+void TextureManager::requestTextureMip(const CpuTextureHandle& handle, uint32_t mip)
+{
+    if (!handle)
+        return;
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto request = [&](uint32_t textureID)
+    {
+        if (mResidencyScheduler.hasTexture(textureID))
+            mResidencyScheduler.requestMip(textureID, mip);
+    };
+
+    if (handle.isUdim())
+    {
+        size_t rangeStart = handle.getID();
+        FALCOR_CHECK(rangeStart < mUdimIndirectionSize.size(), "Handle is out of range.");
+        for (size_t i = rangeStart; i < rangeStart + mUdimIndirectionSize[rangeStart]; ++i)
+        {
+            if (mUdimIndirection[i] >= 0)
+                request((uint32_t)mUdimIndirection[i]);
+        }
+    }
+    else
+    {
+        request(handle.getID());
+    }
+}
+
+void TextureManager::requestTextureScreenSize(const Texture* pTexture, float screenSize)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto handleIt = mTextureToHandle.find(pTexture);
+    if (handleIt == mTextureToHandle.end())
+        return;
+
+    const uint32_t textureID = handleIt->second.getID();
+    auto streamedIt = mStreamedTextures.find(textureID);
+    if (streamedIt == mStreamedTextures.end())
+        return;
+
+    const auto& layout = streamedIt->second.layout;
+    const uint32_t mip = TextureResidencyScheduler::computeRequiredMip(std::max(layout.width, layout.height), screenSize);
+    mResidencyScheduler.requestMip(textureID, mip);
+}
+
+bool TextureManager::updateResidency(RenderContext* pRenderContext)
+{
+    FALCOR_ASSERT(pRenderContext);
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mStreamedTextures.empty())
+        return false;
+
+    bool texturesChanged = false;
+    for (const auto& change : mResidencyScheduler.update())
+    {
+        const CpuTextureHandle handle{change.textureID};
+        auto& streamed = mStreamedTextures.at(change.textureID);
+        auto& desc = getDesc(handle);
+        FALCOR_ASSERT(streamed.residentMip == change.prevResidentMip);
+
+        ref<Texture> pTexture = createResidentTexture(pRenderContext, streamed, desc.pTexture.get(), change.residentMip);
+        if (!pTexture)
+        {
+            // The cache entry is no longer available. Keep the current texture and stop streaming it.
+            logWarning(
+                "Failed to stream texture '{}' from '{}'. Streaming is disabled for it.", desc.pTexture->getSourcePath(), streamed.entryPath
+            );
+            mResidencyScheduler.removeTexture(change.textureID);
+            if (desc.pTexture != streamed.pTailTexture)
+                mTextureToHandle.erase(streamed.pTailTexture.get());
+            mStreamedTextures.erase(change.textureID);
+            continue;
+        }
+
+        // Replace the texture. The initial mip tail texture stays mapped to the handle, as materials reference it.
+        if (desc.pTexture != streamed.pTailTexture)
+            mTextureToHandle.erase(desc.pTexture.get());
+        mTextureToHandle[pTexture.get()] = handle;
+        desc.pTexture = pTexture;
+        streamed.residentMip = change.residentMip;
+        texturesChanged = true;
+    }
+
+    return texturesChanged;
+}
+
+TextureResidencyScheduler::Stats TextureManager::getResidencyStats() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mResidencyScheduler.getStats();
+}
+
+ref<Texture> TextureManager::loadTextureFromFiles(const TextureKey& key, StreamedTexture* pStreamed)
+{
+    if (key.fullPaths.size() > 1)
+    {
+        logDebug("Loading mipped texture from '{}'", key.fullPaths[0]);
+        return Texture::createMippedFromFiles(mpDevice, key.fullPaths, key.loadAsSRGB, key.bindFlags, key.importFlags);
+    }
+
+    logDebug("Loading texture from '{}'", key.fullPaths[0]);
+    if (mpTextureCache)
+    {
+        // Streamed textures need a full mip chain in the cache entry.
+        if (pStreamed && mResidencyOptions.enabled && key.generateMipLevels)
+        {
+            Bitmap::UniqueConstPtr pBitmap;
+            std::filesystem::path entryPath =
+                mpTextureCache->getEntry(key.fullPaths[0], key.generateMipLevels, key.bindFlags, key.importFlags, &pBitmap);
+            if (!entryPath.empty())
+            {
+                if (ref<Texture> pTexture = loadStreamedTexture(key, entryPath, *pStreamed))
+                    return pTexture;
+            }
+            else if (pBitmap)
+            {
+                return TextureCache::createTexture(
+                    mpDevice, *pBitmap, key.fullPaths[0], key.generateMipLevels, key.loadAsSRGB, key.bindFlags, key.importFlags
+                );
+            }
+        }
+
+        return mpTextureCache->loadTexture(
+            mpDevice, key.fullPaths[0], key.generateMipLevels, key.loadAsSRGB, key.bindFlags, key.importFlags
+        );
+    }
+    return Texture::createFromFile(mpDevice, key.fullPaths[0], key.generateMipLevels, key.loadAsSRGB, key.bindFlags, key.importFlags);
+}
+
+ref<Texture> TextureManager::loadStreamedTexture(const TextureKey& key, const std::filesystem::path& entryPath, StreamedTexture& streamed)
+{
+    ImageIO::DDSLayout layout;
+    try
+    {
+        layout = ImageIO::readDDSLayout(entryPath, key.loadAsSRGB);
+    }
+    catch (const RuntimeError& e)
+    {
+        logWarning("Failed to read texture cache entry '{}': {}", entryPath, e.what());
+        return nullptr;
+    }
+
+    // Only load the mip tail.
+    const uint32_t tailMip = getTailMip(layout, mResidencyOptions.tailSize);
+    ref<Texture> pTexture = ImageIO::loadTextureFromDDS(mpDevice, entryPath, key.loadAsSRGB, tailMip, key.bindFlags);
+    if (!pTexture)
+        return nullptr;
+
+    pTexture->setSourcePath(key.fullPaths[0]);
+    pTexture->setImportFlags(key.importFlags);
+
+    // Textures that fit into the mip tail are not streamed.
+    if (tailMip > 0)
+        streamed = StreamedTexture{entryPath, std::move(layout), tailMip, pTexture};
+
+    return pTexture;
+}
+
+ref<Texture> TextureManager::createResidentTexture(
+    RenderContext* pRenderContext,
+    const StreamedTexture& streamed,
+    const Texture* pPrevTexture,
+    uint32_t residentMip
+)
+{
+    const auto& layout = streamed.layout;
+
+    // Map the cache entry if new mip levels are loaded. Only the pages of these mip levels are read.
+    MemoryMappedFile file;
+    if (residentMip < streamed.residentMip)
+    {
+        if (!file.open(streamed.entryPath, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::RandomAccess) ||
+            file.getSize() < layout.mipOffsets[streamed.residentMip - 1] + layout.mipSizes[streamed.residentMip - 1])
+            return nullptr;
+    }
+
+    ref<Texture> pTexture = mpDevice->createTexture2D(
+        std::max(1u, layout.width >> residentMip),
+        std::max(1u, layout.height >> residentMip),
+        layout.format,
+        1,
+        layout.mipLevels - residentMip,
+        nullptr,
+        pPrevTexture->getBindFlags()
+    );
+    pTexture->setSourcePath(pPrevTexture->getSourcePath());
+    pTexture->setImportFlags(pPrevTexture->getImportFlags());
+
+    // Copy the mip levels that are resident in both textures.
+    for (uint32_t mip = std::max(residentMip, streamed.residentMip); mip < layout.mipLevels; ++mip)
+    {
+        pRenderContext->copySubresource(
+            pTexture.get(),
+            pTexture->getSubresourceIndex(0, mip - residentMip),
+            pPrevTexture,
+            pPrevTexture->getSubresourceIndex(0, mip - streamed.residentMip)
+        );
+    }
+
+    // Upload the newly resident mip levels.
+    for (uint32_t mip = residentMip; mip < streamed.residentMip; ++mip)
+    {
+        const uint8_t* pData = static_cast<const uint8_t*>(file.getData()) + layout.mipOffsets[mip];
+        pRenderContext->updateSubresourceData(pTexture.get(), pTexture->getSubresourceIndex(0, mip - residentMip), pData);
+    }
+
+    return pTexture;
+}
+
+void TextureManager::addStreamedTexture(const CpuTextureHandle& handle, StreamedTexture streamed)
+{
+    mResidencyScheduler.addTexture(handle.getID(), streamed.layout.mipSizes, streamed.residentMip);
+    mStreamedTextures[handle.getID()] = std::move(streamed);
+}
+
 TextureManager::CpuTextureHandle TextureManager::addDesc(const TextureDesc& desc)
 {
     CpuTextureHandle handle;
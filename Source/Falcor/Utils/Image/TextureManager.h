@@ -27,6 +27,8 @@
  **************************************************************************/
 #pragma once
 #include "AsyncTextureLoader.h"
+#include "TextureCache.h"
+#include "TextureResidency.h"
 #include "Core/Macros.h"
 #include "Core/API/fwd.h"
 #include "Core/API/Resource.h"
@@ -138,6 +140,22 @@ public:
         bool isValid() const { return state != TextureState::Invalid; }
     };
 
+    /// Options for streaming texture mip levels on demand.
+    struct ResidencyOptions
+    {
+        /// Enable streaming. Applies to textures with mip levels that are loaded through the texture cache after enabling it.
+        bool enabled = false;
+        /// Mip levels with a width and height of at most this size form the mip tail, which is loaded upfront and always resident.
+        uint32_t tailSize = 128;
+        /// Vertical screen resolution in pixels that the scene assumes when estimating the mip levels needed for rendering.
+        uint32_t screenHeight = 1080;
+        /// Memory budget and streaming limit for the streamed textures.
+        TextureResidencyScheduler::Options scheduler;
+
+        // Note: Empty constructor needed for clang due to the use of the nested struct constructor in the parent constructor.
+        ResidencyOptions() {}
+    };
+
     /**
      * Constructor.
      * @param[in] pDevice GPU device.
@@ -279,6 +297,63 @@ public:
      */
     Stats getStats() const;
 
+    /**
+     * Set the texture cache used for loading textures from file.
+     * Textures loaded after this call are loaded through the cache, which stores processed textures
+     * including their mip levels on disk to reduce subsequent load times.
+     * @param[in] pTextureCache Texture cache, or nullptr to load textures directly.
+     */
+    void setTextureCache(std::shared_ptr<TextureCache> pTextureCache) { mpTextureCache = std::move(pTextureCache); }
+
+    /**
+     * Get the texture cache used for loading textures from file, or nullptr if none is used.
+     */
+    const std::shared_ptr<TextureCache>& getTextureCache() const { return mpTextureCache; }
+
+    /**
+     * Set the options for streaming textures.
+     * When streaming is enabled, textures loaded through the texture cache initially only have their mip tail resident.
+     * Finer mip levels are loaded on demand with requestTextureMip() or requestTextureScreenSize() and updateResidency()
+     * (the scene requests the mip levels of all material textures every frame), and the least recently
+     * requested mip levels are evicted when the memory budget is exceeded. The mip levels are read from the texture
+     * cache entries, which are memory mapped so that only the requested mip levels are paged in.
+     * @param[in] options Streaming options.
+     */
+    void setResidencyOptions(const ResidencyOptions& options);
+
+    const ResidencyOptions& getResidencyOptions() const { return mResidencyOptions; }
+
+    /**
+     * Request a mip level of a texture to be resident.
+     * The request takes effect on the next call to updateResidency(). Requests for textures that are not streamed are ignored.
+     * Requests for a UDIM texture apply to all its textures.
+     * @param[in] handle Texture handle.
+     * @param[in] mip Requested mip level.
+     */
+    void requestTextureMip(const CpuTextureHandle& handle, uint32_t mip);
+
+    /**
+     * Request the mip levels of a texture needed to render it at a given size on screen.
+     * The requested mip level is the coarsest one with at least `screenSize` texels along the larger dimension.
+     * Requests for textures that are not managed or not streamed are ignored.
+     * @param[in] pTexture Texture, typically the mip tail texture referenced by a material.
+     * @param[in] screenSize Size of the texture on screen in pixels.
+     */
+    void requestTextureScreenSize(const Texture* pTexture, float screenSize);
+
+    /**
+     * Update the resident mip levels of streamed textures.
+     * Textures with changed mip levels are replaced by new textures, so the texture descs change.
+     * @param[in] pRenderContext Render context used for copying and uploading mip levels.
+     * @return True if any texture was replaced, in which case bindShaderData() needs to be called again.
+     */
+    bool updateResidency(RenderContext* pRenderContext);
+
+    /**
+     * Returns stats for the streamed textures.
+     */
+    TextureResidencyScheduler::Stats getResidencyStats() const;
+
 private:
     size_t getUdimRange(size_t requiredSize);
     void freeUdimRange(size_t rangeStart);
@@ -339,6 +414,24 @@ private:
         }
     };
 
+    /// Texture whose mip levels are streamed from a texture cache entry.
+    struct StreamedTexture
+    {
+        std::filesystem::path entryPath; ///< Path of the texture cache entry.
+        ImageIO::DDSLayout layout;       ///< Layout of the mip levels in the cache entry.
+        uint32_t residentMip = 0;        ///< Most detailed mip level of the current texture.
+        ref<Texture> pTailTexture;       ///< Texture initially created with the mip tail. It remains an alias of the handle.
+    };
+
+    ref<Texture> loadTextureFromFiles(const TextureKey& key, StreamedTexture* pStreamed = nullptr);
+    ref<Texture> loadStreamedTexture(const TextureKey& key, const std::filesystem::path& entryPath, StreamedTexture& streamed);
+    ref<Texture> createResidentTexture(
+        RenderContext* pRenderContext,
+        const StreamedTexture& streamed,
+        const Texture* pPrevTexture,
+        uint32_t residentMip
+    );
+    void addStreamedTexture(const CpuTextureHandle& handle, StreamedTexture streamed);
     CpuTextureHandle addDesc(const TextureDesc& desc);
     TextureDesc& getDesc(const CpuTextureHandle& handle);
     void registerOwner(const CpuTextureHandle& handle, const Object* owner);
@@ -370,9 +463,14 @@ private:
 
     bool mUseDeferredLoading = false;
 
-    AsyncTextureLoader mAsyncTextureLoader; ///< Utility for asynchronous texture loading.
+    AsyncTextureLoader mAsyncTextureLoader;       ///< Utility for asynchronous texture loading.
+    std::shared_ptr<TextureCache> mpTextureCache; ///< Optional cache of processed textures.
     size_t mLoadRequestsInProgress = 0;     ///< Number of load requests currently in progress.
 
+    ResidencyOptions mResidencyOptions;                     ///< Options for streaming textures.
+    TextureResidencyScheduler mResidencyScheduler;          ///< Scheduler for the resident mip levels of streamed textures.
+    std::map<uint32_t, StreamedTexture> mStreamedTextures;  ///< Streamed textures, indexed by handle ID.
+
     const size_t mMaxTextureCount; ///< Maximum number of textures that can be simultaneously managed.
 };
 } // namespace Falcor
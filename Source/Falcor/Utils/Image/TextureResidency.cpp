@@ -0,0 +1,254 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "TextureResidency.h"
+#include "Core/Error.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Falcor
+{
+TextureResidencyScheduler::TextureResidencyScheduler(const Options& options) : mOptions(options) {}
+
+void TextureResidencyScheduler::addTexture(uint32_t textureID, std::vector<uint64_t> mipSizes, uint32_t tailMip)
+{
+    FALCOR_CHECK(!hasTexture(textureID), "Texture {} is already managed by the residency scheduler.", textureID);
+    FALCOR_CHECK(tailMip < mipSizes.size(), "Mip tail ({}) is out of range ({} mip levels).", tailMip, mipSizes.size());
+
+    Texture texture;
+    texture.mipSizes = std::move(mipSizes);
+    texture.tailMip = tailMip;
+    texture.residentMip = tailMip;
+    texture.requestedMip = tailMip;
+
+    for (uint32_t mip = tailMip; mip < texture.mipSizes.size(); ++mip)
+    {
+        mStats.residentBytes += texture.mipSizes[mip];
+        mStats.tailBytes += texture.mipSizes[mip];
+    }
+
+    mTextures.emplace(textureID, std::move(texture));
+}
+
+void TextureResidencyScheduler::removeTexture(uint32_t textureID)
+{
+    auto it = mTextures.find(textureID);
+    if (it == mTextures.end())
+        return;
+
+    const Texture& texture = it->second;
+    for (uint32_t mip = texture.residentMip; mip < texture.mipSizes.size(); ++mip)
+    {
+        mStats.residentBytes -= texture.mipSizes[mip];
+        if (mip >= texture.tailMip)
+            mStats.tailBytes -= texture.mipSizes[mip];
+    }
+
+    mTextures.erase(it);
+}
+
+void TextureResidencyScheduler::requestMip(uint32_t textureID, uint32_t mip)
+{
+    auto it = mTextures.find(textureID);
+    FALCOR_CHECK(it != mTextures.end(), "Texture {} is not managed by the residency scheduler.", textureID);
+
+    Texture& texture = it->second;
+    mip = std::min(mip, texture.tailMip);
+    if (texture.lastRequestFrame != mFrame)
+    {
+        texture.requestedMip = mip;
+        texture.lastRequestFrame = mFrame;
+    }
+    else
+    {
+        texture.requestedMip = std::min(texture.requestedMip, mip);
+    }
+}
+
+std::vector<TextureResidencyScheduler::Change> TextureResidencyScheduler::update()
+{
+    // Resident mip level of each changed texture before the update.
+    std::unordered_map<uint32_t, uint32_t> prevResidentMips;
+    auto recordChange = [&](uint32_t textureID, const Texture& texture) { prevResidentMips.try_emplace(textureID, texture.residentMip); };
+
+    // Gather eviction candidates, least recently requested first.
+    using Entry = std::pair<uint32_t, Texture*>;
+    std::vector<Entry> candidates;
+    std::vector<Entry> pending;
+    for (auto& [textureID, texture] : mTextures)
+    {
+        // Textures not requested in the current frame only need their mip tail.
+        if (texture.lastRequestFrame != mFrame)
+            texture.requestedMip = texture.tailMip;
+
+        if (texture.residentMip < texture.tailMip)
+            candidates.emplace_back(textureID, &texture);
+        if (texture.requestedMip < texture.residentMip)
+            pending.emplace_back(textureID, &texture);
+    }
+    std::sort(
+        candidates.begin(),
+        candidates.end(),
+        [](const Entry& a, const Entry& b)
+        {
+            if (a.second->lastRequestFrame != b.second->lastRequestFrame)
+                return a.second->lastRequestFrame < b.second->lastRequestFrame;
+            return a.first < b.first;
+        }
+    );
+
+    // Evict mip levels of textures last requested before the given frame until the given number of bytes fits in the budget.
+    size_t nextCandidate = 0;
+    auto makeRoom = [&](uint64_t byteCount, uint64_t frame)
+    {
+        while (mStats.residentBytes + byteCount > mOptions.budgetInBytes)
+        {
+            while (nextCandidate < candidates.size() &&
+                   candidates[nextCandidate].second->residentMip >= candidates[nextCandidate].second->tailMip)
+                nextCandidate++;
+            if (nextCandidate == candidates.size() || candidates[nextCandidate].second->lastRequestFrame >= frame)
+                return false;
+
+            auto [textureID, pTexture] = candidates[nextCandidate];
+            recordChange(textureID, *pTexture);
+            evictMip(*pTexture);
+        }
+        return true;
+    };
+
+    // Enforce the budget, which may have been reduced since the last update.
+    makeRoom(0, std::numeric_limits<uint64_t>::max());
+
+    // Load pending mip levels, most recently requested textures first, then coarsest resident mip first.
+    // Mip levels are loaded one at a time in round-robin order, so that all requested textures get sharper at the same rate.
+    std::sort(
+        pending.begin(),
+        pending.end(),
+        [](const Entry& a, const Entry& b)
+        {
+            if (a.second->lastRequestFrame != b.second->lastRequestFrame)
+                return a.second->lastRequestFrame > b.second->lastRequestFrame;
+            if (a.second->residentMip != b.second->residentMip)
+                return a.second->residentMip > b.second->residentMip;
+            return a.first < b.first;
+        }
+    );
+
+    uint64_t loadedBytes = 0;
+    bool limitReached = false;
+    while (!pending.empty() && !limitReached)
+    {
+        size_t keptCount = 0;
+        for (size_t i = 0; i < pending.size(); ++i)
+        {
+            auto [textureID, pTexture] = pending[i];
+            if (pTexture->residentMip <= pTexture->requestedMip)
+                continue;
+
+            const uint32_t mip = pTexture->residentMip - 1;
+            const uint64_t size = pTexture->mipSizes[mip];
+            if (loadedBytes > 0 && loadedBytes + size > mOptions.maxLoadBytesPerUpdate)
+            {
+                limitReached = true;
+                break;
+            }
+
+            // Skip the texture if the budget is taken by more recently requested textures.
+            if (!makeRoom(size, pTexture->lastRequestFrame))
+                continue;
+
+            recordChange(textureID, *pTexture);
+            pTexture->residentMip = mip;
+            mStats.residentBytes += size;
+            mStats.loadedBytes += size;
+            mStats.loadCount++;
+            loadedBytes += size;
+
+            if (pTexture->residentMip > pTexture->requestedMip)
+                pending[keptCount++] = pending[i];
+        }
+        pending.resize(keptCount);
+    }
+
+    std::vector<Change> changes;
+    for (const auto& [textureID, prevResidentMip] : prevResidentMips)
+    {
+        uint32_t residentMip = mTextures.at(textureID).residentMip;
+        if (residentMip != prevResidentMip)
+            changes.push_back(Change{textureID, prevResidentMip, residentMip});
+    }
+    std::sort(changes.begin(), changes.end(), [](const Change& a, const Change& b) { return a.textureID < b.textureID; });
+
+    mFrame++;
+    return changes;
+}
+
+uint32_t TextureResidencyScheduler::getResidentMip(uint32_t textureID) const
+{
+    return getTexture(textureID).residentMip;
+}
+
+uint32_t TextureResidencyScheduler::getTailMip(uint32_t textureID) const
+{
+    return getTexture(textureID).tailMip;
+}
+
+TextureResidencyScheduler::Stats TextureResidencyScheduler::getStats() const
+{
+    Stats stats = mStats;
+    stats.textureCount = mTextures.size();
+    return stats;
+}
+
+const TextureResidencyScheduler::Texture& TextureResidencyScheduler::getTexture(uint32_t textureID) const
+{
+    auto it = mTextures.find(textureID);
+    FALCOR_CHECK(it != mTextures.end(), "Texture {} is not managed by the residency scheduler.", textureID);
+    return it->second;
+}
+
+void TextureResidencyScheduler::evictMip(Texture& texture)
+{
+    FALCOR_ASSERT(texture.residentMip < texture.tailMip);
+    const uint64_t size = texture.mipSizes[texture.residentMip];
+    texture.residentMip++;
+    mStats.residentBytes -= size;
+    mStats.evictedBytes += size;
+    mStats.evictCount++;
+}
+
+uint32_t TextureResidencyScheduler::computeRequiredMip(uint32_t textureSize, float screenSize)
+{
+    if (!(screenSize < float(textureSize)))
+        return 0;
+    if (screenSize < 1.f)
+        screenSize = 1.f;
+    return (uint32_t)std::floor(std::log2(float(textureSize) / screenSize));
+}
+} // namespace Falcor
@@ -0,0 +1,162 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * CPU-side scheduler deciding which mip levels of streamed textures are resident.
+ *
+ * Each texture has a resident mip tail (the coarsest mip levels) that is never evicted.
+ * Finer mip levels are requested on demand and loaded one level at a time, coarse to fine,
+ * bounded by a per-update streaming limit. When loading a mip level would exceed the memory
+ * budget, the finest mip levels of the least recently used textures are evicted.
+ *
+ * The scheduler only tracks mip ranges and sizes; it does not own any GPU resources.
+ * The caller applies the returned changes, e.g. by recreating the texture with the new mip range.
+ */
+class FALCOR_API TextureResidencyScheduler
+{
+public:
+    struct Options
+    {
+        /// Memory budget in bytes for all streamed textures, including their mip tails.
+        uint64_t budgetInBytes = 4ull * 1024 * 1024 * 1024;
+        /// Maximum number of bytes loaded per update. At least one mip level is loaded per update.
+        uint64_t maxLoadBytesPerUpdate = 64ull * 1024 * 1024;
+
+        // Note: Empty constructor needed for clang due to the use of the nested struct constructor in the parent constructor.
+        Options() {}
+    };
+
+    /// Change of the resident mip range of a texture.
+    struct Change
+    {
+        uint32_t textureID;       ///< Texture ID.
+        uint32_t prevResidentMip; ///< Most detailed resident mip level before the update.
+        uint32_t residentMip;     ///< Most detailed resident mip level after the update.
+    };
+
+    struct Stats
+    {
+        uint64_t textureCount = 0;  ///< Number of streamed textures.
+        uint64_t residentBytes = 0; ///< Total size of all resident mip levels in bytes.
+        uint64_t tailBytes = 0;     ///< Total size of all mip tails in bytes.
+        uint64_t loadedBytes = 0;   ///< Total number of bytes loaded.
+        uint64_t evictedBytes = 0;  ///< Total number of bytes evicted.
+        uint64_t loadCount = 0;     ///< Total number of mip levels loaded.
+        uint64_t evictCount = 0;    ///< Total number of mip levels evicted.
+    };
+
+    TextureResidencyScheduler(const Options& options = Options());
+
+    /**
+     * Set the scheduler options. A reduced budget is enforced on the next update().
+     */
+    void setOptions(const Options& options) { mOptions = options; }
+    const Options& getOptions() const { return mOptions; }
+
+    /**
+     * Add a texture. Only its mip tail is initially resident.
+     * @param[in] textureID Unique texture ID.
+     * @param[in] mipSizes Size in bytes of each mip level, most detailed level first.
+     * @param[in] tailMip Most detailed mip level of the mip tail. Mip levels [tailMip, mipCount) stay resident.
+     */
+    void addTexture(uint32_t textureID, std::vector<uint64_t> mipSizes, uint32_t tailMip);
+
+    /**
+     * Remove a texture. Its resident mip levels no longer count towards the budget.
+     */
+    void removeTexture(uint32_t textureID);
+
+    bool hasTexture(uint32_t textureID) const { return mTextures.find(textureID) != mTextures.end(); }
+
+    /**
+     * Request a mip level of a texture to be resident.
+     * Multiple requests for a texture in the same frame keep the most detailed mip level.
+     * Requests only apply to the current frame, textures that are not requested again only keep their mip tail requested.
+     * Loaded mip levels stay resident until they are evicted to stay within the budget.
+     * @param[in] textureID Texture ID.
+     * @param[in] mip Requested mip level. Levels coarser than the mip tail are clamped to it.
+     */
+    void requestMip(uint32_t textureID, uint32_t mip);
+
+    /**
+     * Compute the residency changes for the current frame and advance to the next frame.
+     * Loads are prioritized by the most recently requested textures. Mip levels of textures requested
+     * in the current frame are never evicted for loads of other textures.
+     * @return List of textures whose resident mip range changed.
+     */
+    std::vector<Change> update();
+
+    /**
+     * Get the most detailed resident mip level of a texture.
+     */
+    uint32_t getResidentMip(uint32_t textureID) const;
+
+    /**
+     * Get the most detailed mip level of the mip tail of a texture.
+     */
+    uint32_t getTailMip(uint32_t textureID) const;
+
+    uint64_t getFrame() const { return mFrame; }
+
+    Stats getStats() const;
+
+    /**
+     * Compute the mip level needed to render a texture at a given size on screen.
+     * This is the coarsest mip level that still has at least one texel per pixel.
+     * @param[in] textureSize Larger dimension of the most detailed mip level in texels.
+     * @param[in] screenSize Size of the texture on screen in pixels.
+     * @return Required mip level. This may be coarser than the coarsest mip level of the texture.
+     */
+    static uint32_t computeRequiredMip(uint32_t textureSize, float screenSize);
+
+private:
+    struct Texture
+    {
+        std::vector<uint64_t> mipSizes;
+        uint32_t tailMip = 0;
+        uint32_t residentMip = 0;
+        uint32_t requestedMip = 0;
+        uint64_t lastRequestFrame = 0;
+    };
+
+    const Texture& getTexture(uint32_t textureID) const;
+    void evictMip(Texture& texture);
+
+    Options mOptions;
+    std::unordered_map<uint32_t, Texture> mTextures;
+    uint64_t mFrame = 1;
+    Stats mStats;
+};
+} // namespace Falcor
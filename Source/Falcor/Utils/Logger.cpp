@@ -29,22 +29,51 @@
 #include "Core/Error.h"
 #include "Core/Platform/OS.h"
 #include "Utils/Scripting/ScriptBindings.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <mutex>
 #include <set>
+#include <thread>
+#include <vector>
 
 namespace Falcor
 {
 namespace
 {
 std::mutex sMutex;
-Logger::Level sVerbosity = Logger::Level::Info;
-Logger::OutputFlags sOutputs = Logger::OutputFlags::Console | Logger::OutputFlags::File | Logger::OutputFlags::DebugWindow;
+std::atomic<Logger::Level> sVerbosity{Logger::Level::Info};
+std::atomic<Logger::OutputFlags> sOutputs{Logger::OutputFlags::Console | Logger::OutputFlags::File | Logger::OutputFlags::DebugWindow};
+std::atomic<Logger::OverflowPolicy> sOverflowPolicy{Logger::OverflowPolicy::Block};
 std::filesystem::path sLogFilePath;
+std::filesystem::path sJsonLogFilePath;
 
 bool sInitialized = false;
 FILE* sLogFile = nullptr;
+bool sJsonInitialized = false;
+FILE* sJsonLogFile = nullptr;
+
+std::atomic<uint64_t> sNextSequence{0};
+std::atomic<uint32_t> sNextThreadIndex{0};
+const auto sStartTime = std::chrono::steady_clock::now();
+
+/// Set when the asynchronous writer is destroyed during static destruction. Later messages are written synchronously.
+std::atomic<bool> sAsyncWriterDestroyed{false};
+
+struct Message
+{
+    uint64_t sequence;
+    Logger::Level level;
+    uint32_t threadIndex;
+    double time; ///< Time in seconds since startup.
+    std::string msg;
+};
 
 std::filesystem::path generateLogFilePath()
 {
@@ -74,6 +103,21 @@ FILE* openLogFile()
     return pFile;
 }
 
+FILE* openJsonLogFile()
+{
+    if (sJsonLogFilePath.empty())
+    {
+        if (sLogFilePath.empty())
+            sLogFilePath = generateLogFilePath();
+        sJsonLogFilePath = sLogFilePath;
+        sJsonLogFilePath.replace_extension("jsonl");
+    }
+
+    FILE* pFile = std::fopen(sJsonLogFilePath.string().c_str(), "w");
+    FALCOR_ASSERT(pFile != nullptr);
+    return pFile;
+}
+
 void printToLogFile(const std::string& s)
 {
     if (!sInitialized)
@@ -84,20 +128,47 @@ void printToLogFile(const std::string& s)
 
     if (sLogFile)
     {
-        std::fprintf(sLogFile, "%s", s.c_str());
+        std::fwrite(s.data(), 1, s.size(), sLogFile);
         std::fflush(sLogFile);
     }
 }
-} // namespace
 
-void Logger::shutdown()
+void printToJsonLogFile(const std::string& s)
+{
+    if (!sJsonInitialized)
+    {
+        sJsonLogFile = openJsonLogFile();
+        sJsonInitialized = true;
+    }
+
+    if (sJsonLogFile)
+    {
+        std::fwrite(s.data(), 1, s.size(), sJsonLogFile);
+        std::fflush(sJsonLogFile);
+    }
+}
+
+void closeLogFiles()
 {
     if (sLogFile)
     {
         fclose(sLogFile);
         sLogFile = nullptr;
-        sInitialized = false;
     }
+    sInitialized = false;
+
+    if (sJsonLogFile)
+    {
+        fclose(sJsonLogFile);
+        sJsonLogFile = nullptr;
+    }
+    sJsonInitialized = false;
+}
+
+uint32_t getThreadIndex()
+{
+    thread_local uint32_t index = sNextThreadIndex++;
+    return index;
 }
 
 inline const char* getLogLevelString(Logger::Level level)
@@ -120,6 +191,325 @@ inline const char* getLogLevelString(Logger::Level level)
     }
 }
 
+inline const char* getLogLevelName(Logger::Level level)
+{
+    switch (level)
+    {
+    case Logger::Level::Fatal:
+        return "Fatal";
+    case Logger::Level::Error:
+        return "Error";
+    case Logger::Level::Warning:
+        return "Warning";
+    case Logger::Level::Info:
+        return "Info";
+    case Logger::Level::Debug:
+        return "Debug";
+    default:
+        FALCOR_UNREACHABLE();
+        return nullptr;
+    }
+}
+
+/**
+ * Write a batch of messages to the outputs.
+ * Each output is written and flushed once per batch. Must be called with sMutex held.
+ */
+void writeMessages(const Message* pMessages, size_t count, Logger::OutputFlags outputs)
+{
+    std::string text;
+    for (size_t i = 0; i < count; ++i)
+        text += fmt::format("{} {}\n", getLogLevelString(pMessages[i].level), pMessages[i].msg);
+
+    // Write to console. Consecutive messages going to the same stream are written at once.
+    if (is_set(outputs, Logger::OutputFlags::Console))
+    {
+        size_t offset = 0;
+        for (size_t i = 0; i < count;)
+        {
+            const bool isError = pMessages[i].level <= Logger::Level::Error;
+            size_t length = 0;
+            for (; i < count && (pMessages[i].level <= Logger::Level::Error) == isError; ++i)
+                length += std::strlen(getLogLevelString(pMessages[i].level)) + pMessages[i].msg.size() + 2;
+            auto& os = isError ? std::cerr : std::cout;
+            os.write(text.data() + offset, length);
+            os.flush();
+            offset += length;
+        }
+    }
+
+    // Write to file.
+    if (is_set(outputs, Logger::OutputFlags::File))
+    {
+        printToLogFile(text);
+    }
+
+    // Write to debug window if debugger is attached.
+    if (is_set(outputs, Logger::OutputFlags::DebugWindow) && isDebuggerPresent())
+    {
+        printToDebugWindow(text);
+    }
+
+    // Write to JSON-lines file.
+    if (is_set(outputs, Logger::OutputFlags::JsonFile))
+    {
+        std::string lines;
+        for (size_t i = 0; i < count; ++i)
+        {
+            const Message& message = pMessages[i];
+            nlohmann::json entry = {
+                {"seq", message.sequence},
+                {"time", message.time},
+                {"thread", message.threadIndex},
+                {"level", getLogLevelName(message.level)},
+                {"msg", message.msg},
+            };
+            lines += entry.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+            lines += '\n';
+        }
+        printToJsonLogFile(lines);
+    }
+}
+
+/**
+ * Bounded single-producer single-consumer message queue of one thread.
+ * The producer is the owning thread, the consumer is whoever holds the drain lock of the async writer.
+ */
+class MessageQueue
+{
+public:
+    static constexpr size_t kCapacity = 1024; ///< Must be a power of two.
+
+    MessageQueue() : mMessages(kCapacity) {}
+
+    bool push(Message&& message)
+    {
+        const size_t tail = mTail.load(std::memory_order_relaxed);
+        if (tail - mHead.load(std::memory_order_acquire) == kCapacity)
+            return false;
+        mMessages[tail & (kCapacity - 1)] = std::move(message);
+        mTail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    void pop(std::vector<Message>& messages)
+    {
+        const size_t head = mHead.load(std::memory_order_relaxed);
+        const size_t tail = mTail.load(std::memory_order_acquire);
+        for (size_t i = head; i != tail; ++i)
+            messages.push_back(std::move(mMessages[i & (kCapacity - 1)]));
+        mHead.store(tail, std::memory_order_release);
+    }
+
+    size_t size() const { return mTail.load(std::memory_order_acquire) - mHead.load(std::memory_order_acquire); }
+
+    bool isOrphaned() const { return mOrphaned.load(std::memory_order_acquire); }
+    void setOrphaned() { mOrphaned.store(true, std::memory_order_release); }
+
+private:
+    std::vector<Message> mMessages;
+    std::atomic<size_t> mHead{0};
+    std::atomic<size_t> mTail{0};
+    std::atomic<bool> mOrphaned{false}; ///< Set when the owning thread has exited.
+};
+
+/**
+ * Background writer for asynchronous logging.
+ * Each logging thread pushes to its own queue without locking. The writer thread periodically collects the
+ * messages of all queues, restores their order and writes them in a single batch per output.
+ */
+class AsyncWriter
+{
+public:
+    static AsyncWriter& instance()
+    {
+        static AsyncWriter sInstance;
+        return sInstance;
+    }
+
+    ~AsyncWriter()
+    {
+        stop();
+        sAsyncWriterDestroyed = true;
+    }
+
+    void enqueue(Message&& message, bool block)
+    {
+        start();
+
+        MessageQueue& queue = getThreadQueue();
+        if (!queue.push(std::move(message)))
+        {
+            if (!block)
+            {
+                mDroppedCount++;
+                mTotalDroppedCount++;
+                return;
+            }
+            // Wait for the writer to make room.
+            do
+            {
+                wake();
+                std::this_thread::yield();
+            } while (!queue.push(std::move(message)));
+        }
+
+        // Wake the writer early if the queue fills up, otherwise messages are collected periodically.
+        if (queue.size() >= MessageQueue::kCapacity / 2)
+            wake();
+    }
+
+    /// Write all queued messages on the calling thread.
+    void flush() { drain(); }
+
+    /// Stop the writer thread after writing all queued messages. The thread is restarted on the next message.
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mWakeMutex);
+            if (!mThread.joinable())
+                return;
+            mTerminate = true;
+        }
+        mWakeCondition.notify_all();
+        mThread.join();
+        mRunning = false;
+        drain();
+    }
+
+    uint64_t getTotalDroppedCount() const { return mTotalDroppedCount; }
+
+private:
+    static constexpr auto kWriteInterval = std::chrono::milliseconds(10);
+
+    struct ThreadQueueHandle
+    {
+        std::shared_ptr<MessageQueue> pQueue;
+        ~ThreadQueueHandle()
+        {
+            if (pQueue)
+                pQueue->setOrphaned();
+        }
+    };
+
+    AsyncWriter() = default;
+
+    void start()
+    {
+        if (mRunning.load(std::memory_order_acquire))
+            return;
+        std::lock_guard<std::mutex> lock(mWakeMutex);
+        if (mThread.joinable())
+            return;
+        mTerminate = false;
+        mThread = std::thread(&AsyncWriter::run, this);
+        mRunning = true;
+    }
+
+    void wake()
+    {
+        if (!mWakePending.exchange(true))
+            mWakeCondition.notify_one();
+    }
+
+    MessageQueue& getThreadQueue()
+    {
+        thread_local ThreadQueueHandle handle;
+        if (!handle.pQueue)
+        {
+            handle.pQueue = std::make_shared<MessageQueue>();
+            std::lock_guard<std::mutex> lock(mQueuesMutex);
+            mQueues.push_back(handle.pQueue);
+        }
+        return *handle.pQueue;
+    }
+
+    void run()
+    {
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mWakeMutex);
+                mWakeCondition.wait_for(lock, kWriteInterval, [&]() { return mTerminate || mWakePending.load(); });
+                if (mTerminate)
+                    break;
+            }
+            mWakePending = false;
+            drain();
+        }
+    }
+
+    void drain()
+    {
+        std::lock_guard<std::mutex> drainLock(mDrainMutex);
+
+        mBatch.clear();
+        {
+            std::lock_guard<std::mutex> lock(mQueuesMutex);
+            for (auto it = mQueues.begin(); it != mQueues.end();)
+            {
+                // Check before popping, an orphaned queue doesn't receive new messages.
+                const bool orphaned = (*it)->isOrphaned();
+                (*it)->pop(mBatch);
+                it = orphaned ? mQueues.erase(it) : std::next(it);
+            }
+        }
+
+        // Restore the logging order across threads.
+        std::sort(mBatch.begin(), mBatch.end(), [](const Message& a, const Message& b) { return a.sequence < b.sequence; });
+
+        if (uint64_t droppedCount = mDroppedCount.exchange(0); droppedCount > 0)
+        {
+            const double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - sStartTime).count();
+            mBatch.push_back(Message{
+                sNextSequence++,
+                Logger::Level::Warning,
+                getThreadIndex(),
+                time,
+                fmt::format("Dropped {} log messages because the log queue was full.", droppedCount),
+            });
+        }
+
+        if (mBatch.empty())
+            return;
+
+        std::lock_guard<std::mutex> lock(sMutex);
+        writeMessages(mBatch.data(), mBatch.size(), sOutputs.load());
+    }
+
+    std::mutex mQueuesMutex;                          ///< Protects the queue list.
+    std::vector<std::shared_ptr<MessageQueue>> mQueues; ///< Queues of all threads that logged asynchronously.
+
+    std::mutex mDrainMutex;     ///< Serializes consumers of the queues.
+    std::vector<Message> mBatch; ///< Messages of the current batch. Protected by mDrainMutex.
+
+    std::mutex mWakeMutex;
+    std::condition_variable mWakeCondition;
+    std::thread mThread;
+    bool mTerminate = false;
+    std::atomic<bool> mRunning{false};
+    std::atomic<bool> mWakePending{false};
+
+    std::atomic<uint64_t> mDroppedCount{0};      ///< Messages dropped since the last batch.
+    std::atomic<uint64_t> mTotalDroppedCount{0}; ///< Messages dropped in total.
+};
+} // namespace
+
+void Logger::shutdown()
+{
+    if (!sAsyncWriterDestroyed)
+        AsyncWriter::instance().stop();
+
+    std::lock_guard<std::mutex> lock(sMutex);
+    closeLogFiles();
+}
+
+void Logger::flush()
+{
+    if (!sAsyncWriterDestroyed)
+        AsyncWriter::instance().flush();
+}
+
 class MessageDeduplicator
 {
 public:
@@ -148,62 +538,59 @@ private:
 
 void Logger::log(Level level, const std::string_view msg, Frequency frequency)
 {
-    std::lock_guard<std::mutex> lock(sMutex);
-    if (level <= sVerbosity)
-    {
-        std::string s = fmt::format("{} {}\n", getLogLevelString(level), msg);
+    if (level > sVerbosity.load())
+        return;
 
-        if (frequency == Frequency::Once && MessageDeduplicator::instance().isDuplicate(s))
-            return;
+    if (frequency == Frequency::Once && MessageDeduplicator::instance().isDuplicate(fmt::format("{} {}", getLogLevelString(level), msg)))
+        return;
 
-        // Write to console.
-        if (is_set(sOutputs, OutputFlags::Console))
-        {
-            auto& os = level > Logger::Level::Error ? std::cout : std::cerr;
-            os << s;
-            os.flush();
-        }
+    const double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - sStartTime).count();
+    Message message{sNextSequence++, level, getThreadIndex(), time, std::string(msg)};
 
-        // Write to file.
-        if (is_set(sOutputs, OutputFlags::File))
-        {
-            printToLogFile(s);
-        }
-
-        // Write to debug window if debugger is attached.
-        if (is_set(sOutputs, OutputFlags::DebugWindow) && isDebuggerPresent())
-        {
-            printToDebugWindow(s);
-        }
+    const OutputFlags outputs = sOutputs.load();
+    if (is_set(outputs, OutputFlags::Async) && !sAsyncWriterDestroyed)
+    {
+        // Errors are never dropped and are written immediately, so they are visible before a message box
+        // is shown or the application terminates.
+        const bool isError = level <= Level::Error;
+        AsyncWriter& writer = AsyncWriter::instance();
+        writer.enqueue(std::move(message), isError || sOverflowPolicy.load() == OverflowPolicy::Block);
+        if (isError)
+            writer.flush();
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(sMutex);
+        writeMessages(&message, 1, outputs);
     }
 }
 
 void Logger::setVerbosity(Level level)
 {
-    std::lock_guard<std::mutex> lock(sMutex);
     sVerbosity = level;
 }
 
 Logger::Level Logger::getVerbosity()
 {
-    std::lock_guard<std::mutex> lock(sMutex);
     return sVerbosity;
 }
 
 void Logger::setOutputs(OutputFlags outputs)
 {
-    std::lock_guard<std::mutex> lock(sMutex);
+    // Write pending messages before switching outputs.
+    flush();
     sOutputs = outputs;
 }
 
 Logger::OutputFlags Logger::getOutputs()
 {
-    std::lock_guard<std::mutex> lock(sMutex);
     return sOutputs;
 }
 
 void Logger::setLogFilePath(const std::filesystem::path& path)
 {
+    // Write pending messages to the previous file.
+    flush();
     std::lock_guard<std::mutex> lock(sMutex);
     if (sLogFile)
     {
@@ -220,6 +607,41 @@ std::filesystem::path Logger::getLogFilePath()
     return sLogFilePath;
 }
 
+void Logger::setJsonLogFilePath(const std::filesystem::path& path)
+{
+    // Write pending messages to the previous file.
+    flush();
+    std::lock_guard<std::mutex> lock(sMutex);
+    if (sJsonLogFile)
+    {
+        fclose(sJsonLogFile);
+        sJsonLogFile = nullptr;
+        sJsonInitialized = false;
+    }
+    sJsonLogFilePath = path;
+}
+
+std::filesystem::path Logger::getJsonLogFilePath()
+{
+    std::lock_guard<std::mutex> lock(sMutex);
+    return sJsonLogFilePath;
+}
+
+void Logger::setOverflowPolicy(OverflowPolicy policy)
+{
+    sOverflowPolicy = policy;
+}
+
+Logger::OverflowPolicy Logger::getOverflowPolicy()
+{
+    return sOverflowPolicy;
+}
+
+uint64_t Logger::getDroppedMessageCount()
+{
+    return sAsyncWriterDestroyed ? 0 : AsyncWriter::instance().getTotalDroppedCount();
+}
+
 FALCOR_SCRIPT_BINDING(Logger)
 {
     using namespace pybind11::literals;
@@ -239,6 +661,12 @@ FALCOR_SCRIPT_BINDING(Logger)
     outputFlags.value("Console", Logger::OutputFlags::Console);
     outputFlags.value("File", Logger::OutputFlags::File);
     outputFlags.value("DebugWindow", Logger::OutputFlags::DebugWindow);
+    outputFlags.value("JsonFile", Logger::OutputFlags::JsonFile);
+    outputFlags.value("Async", Logger::OutputFlags::Async);
+
+    pybind11::enum_<Logger::OverflowPolicy> overflowPolicy(logger, "OverflowPolicy");
+    overflowPolicy.value("Drop", Logger::OverflowPolicy::Drop);
+    overflowPolicy.value("Block", Logger::OverflowPolicy::Block);
 
     logger.def_property_static(
         "verbosity",
@@ -255,6 +683,17 @@ FALCOR_SCRIPT_BINDING(Logger)
         [](pybind11::object) { return Logger::getLogFilePath(); },
         [](pybind11::object, std::filesystem::path path) { Logger::setLogFilePath(path); }
     );
+    logger.def_property_static(
+        "json_log_file_path",
+        [](pybind11::object) { return Logger::getJsonLogFilePath(); },
+        [](pybind11::object, std::filesystem::path path) { Logger::setJsonLogFilePath(path); }
+    );
+    logger.def_property_static(
+        "overflow_policy",
+        [](pybind11::object) { return Logger::getOverflowPolicy(); },
+        [](pybind11::object, Logger::OverflowPolicy policy) { Logger::setOverflowPolicy(policy); }
+    );
+    logger.def_property_readonly_static("dropped_message_count", [](pybind11::object) { return Logger::getDroppedMessageCount(); });
 
     logger.def_static(
         "log",
@@ -262,6 +701,7 @@ FALCOR_SCRIPT_BINDING(Logger)
         "level"_a,
         "msg"_a
     );
+    logger.def_static("flush", &Logger::flush);
 }
 
 } // namespace Falcor
@@ -66,13 +66,29 @@ public:
         Console = 0x2,     ///< Output to console (stdout/stderr).
         File = 0x1,        ///< Output to log file.
         DebugWindow = 0x4, ///< Output to debug window (if debugger is attached).
+        JsonFile = 0x8,    ///< Output to JSON-lines file, one object per message.
+        Async = 0x10,      ///< Write messages in batches on a background thread instead of on the logging thread. Not enabled by default.
+    };
+
+    /// Behavior of asynchronous logging when the message queue of a thread is full.
+    enum class OverflowPolicy
+    {
+        Drop,  ///< Drop the message. Errors and fatal messages are never dropped.
+        Block, ///< Block until there is space in the queue. This is the default.
     };
 
     /**
-     * Shutdown the logger and close the log file.
+     * Shutdown the logger, write all pending messages and close the log files.
      */
     static void shutdown();
 
+    /**
+     * Write all pending messages.
+     * Messages of the calling thread are written when this returns. This is only needed with OutputFlags::Async,
+     * errors and fatal messages are flushed implicitly.
+     */
+    static void flush();
+
     /**
      * Set the logger verbosity.
      * @param level Log level.
@@ -109,6 +125,37 @@ public:
      */
     static std::filesystem::path getLogFilePath();
 
+    /**
+     * Set the path of the JSON-lines logfile.
+     * If not set, the path of the logfile with the extension '.jsonl' is used.
+     * @param[in] path JSON-lines logfile path.
+     */
+    static void setJsonLogFilePath(const std::filesystem::path& path);
+
+    /**
+     * Get the path of the JSON-lines logfile.
+     * @return Returns the path of the JSON-lines logfile.
+     */
+    static std::filesystem::path getJsonLogFilePath();
+
+    /**
+     * Set the behavior of asynchronous logging when a message queue is full.
+     * @param[in] policy Overflow policy.
+     */
+    static void setOverflowPolicy(OverflowPolicy policy);
+
+    /**
+     * Get the behavior of asynchronous logging when a message queue is full.
+     * @return Returns the overflow policy.
+     */
+    static OverflowPolicy getOverflowPolicy();
+
+    /**
+     * Get the number of messages dropped by asynchronous logging so far.
+     * @return Returns the number of dropped messages.
+     */
+    static uint64_t getDroppedMessageCount();
+
     /**
      * Log a message.
      * @param[in] level Log level.
@@ -0,0 +1,423 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "BatchRenderer.h"
+#include "Mogwai.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <nlohmann/json.hpp>
+#include <iostream>
+
+using json = nlohmann::ordered_json;
+
+namespace Mogwai
+{
+    namespace
+    {
+        // Job fields.
+        const char kId[] = "id";
+        const char kScene[] = "scene";
+        const char kScript[] = "script";
+        const char kGraph[] = "graph";
+        const char kResolution[] = "resolution";
+        const char kCamera[] = "camera";
+        const char kTime[] = "time";
+        const char kFrames[] = "frames";
+        const char kPasses[] = "passes";
+        const char kMaterials[] = "materials";
+        const char kOutputs[] = "outputs";
+        const char kOutputDir[] = "outputDir";
+        const char kExit[] = "exit";
+
+        // Camera fields.
+        const char kCameraName[] = "name";
+        const char kCameraPosition[] = "position";
+        const char kCameraTarget[] = "target";
+        const char kCameraUp[] = "up";
+        const char kCameraFocalLength[] = "focalLength";
+        const char kCameraFocalDistance[] = "focalDistance";
+        const char kCameraApertureRadius[] = "apertureRadius";
+
+        float3 parseFloat3(const json& j, const char* name)
+        {
+            FALCOR_CHECK(j.is_array() && j.size() == 3, "'{}' must be an array of three numbers.", name);
+            return float3(j[0].get<float>(), j[1].get<float>(), j[2].get<float>());
+        }
+
+        /// Check that a job id is usable as a file name stem, so outputs can't be written outside the output directory.
+        bool isValidJobId(const std::string& id)
+        {
+            return !id.empty() && id != "." && id != ".." && id.find_first_of("/\\:") == std::string::npos;
+        }
+
+        double elapsedMs(CpuTimer::TimePoint start)
+        {
+            return CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+        }
+    }
+
+    BatchRenderer::BatchRenderer(Renderer* pRenderer, const Options& options)
+        : mpRenderer(pRenderer)
+        , mOptions(options)
+    {
+        FALCOR_ASSERT(mpRenderer);
+        mOptions.maxResidentScenes = std::max<size_t>(mOptions.maxResidentScenes, 1);
+        mpImageWriter = std::make_unique<AsyncImageWriter>();
+
+        // The currently loaded scene (if any) counts as resident, so jobs can refer to it by path without reloading.
+        if (mpRenderer->mpScene && !mpRenderer->mOptions.sceneFile.empty())
+        {
+            mScenes.push_front({ std::filesystem::absolute(mpRenderer->mOptions.sceneFile).lexically_normal(), mpRenderer->mpScene });
+        }
+    }
+
+    BatchRenderer::~BatchRenderer() = default;
+
+    uint32_t BatchRenderer::run(std::istream& input, std::ostream& results)
+    {
+        uint32_t failedCount = 0;
+        std::string line;
+
+        while (std::getline(input, line))
+        {
+            if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+
+            json result;
+            bool exit = false;
+            try
+            {
+                const json job = json::parse(line);
+                FALCOR_CHECK(job.is_object(), "Job must be a JSON object.");
+                exit = job.value(kExit, false);
+                if (exit && job.size() == 1) break;
+                result = runJob(job);
+            }
+            catch (const std::exception& e)
+            {
+                // Only parse errors end up here, errors while running a job are reported in the job result.
+                result = json::object();
+                result[kId] = fmt::format("job{}", mJobCount++);
+                result["success"] = false;
+                result["error"] = e.what();
+            }
+
+            if (!result.value("success", false)) failedCount++;
+            results << result.dump() << std::endl;
+
+            if (exit) break;
+        }
+
+        return failedCount;
+    }
+
+    json BatchRenderer::runJob(const json& job)
+    {
+        const auto jobStart = CpuTimer::getCurrentTimePoint();
+        const std::string jobId = job.contains(kId) ? (job[kId].is_string() ? job[kId].get<std::string>() : job[kId].dump()) : fmt::format("job{}", mJobCount);
+        mJobCount++;
+
+        json result = json::object();
+        result[kId] = jobId;
+        json timing = json::object();
+
+        // Deltas are reverted in reverse order after the job, also if it fails.
+        UndoList undo;
+
+        try
+        {
+            if (job.contains(kId))
+            {
+                FALCOR_CHECK(job[kId].is_string(), "'{}' must be a string.", kId);
+                FALCOR_CHECK(isValidJobId(jobId), "'{}' must be a file name without path separators, got '{}'.", kId, jobId);
+            }
+
+            // Scene and script loading is where reuse pays off. Both are no-ops if already resident.
+            auto start = CpuTimer::getCurrentTimePoint();
+            if (job.contains(kScene)) selectScene(job[kScene].get<std::string>());
+            timing["sceneLoadMs"] = elapsedMs(start);
+
+            start = CpuTimer::getCurrentTimePoint();
+            if (job.contains(kScript))
+            {
+                auto path = std::filesystem::absolute(job[kScript].get<std::string>()).lexically_normal();
+                if (mLoadedScripts.insert(path).second) mpRenderer->loadScript(path);
+            }
+            timing["scriptMs"] = elapsedMs(start);
+
+            if (job.contains(kGraph)) selectGraph(job[kGraph].get<std::string>());
+            RenderGraph* pGraph = mpRenderer->getActiveGraph();
+            FALCOR_CHECK(pGraph, "No render graph is loaded.");
+
+            // Apply deltas.
+            start = CpuTimer::getCurrentTimePoint();
+            if (job.contains(kResolution))
+            {
+                const auto& res = job[kResolution];
+                FALCOR_CHECK(res.is_array() && res.size() == 2, "'{}' must be an array of two integers.", kResolution);
+                const auto& pFbo = mpRenderer->getTargetFbo();
+                uint2 prevSize(pFbo->getWidth(), pFbo->getHeight());
+                mpRenderer->resizeFrameBuffer(res[0].get<uint32_t>(), res[1].get<uint32_t>());
+                undo.push_back([this, prevSize]() { mpRenderer->resizeFrameBuffer(prevSize.x, prevSize.y); });
+            }
+            if (job.contains(kCamera)) applyCamera(job[kCamera], undo);
+            if (job.contains(kPasses)) applyPassProperties(job[kPasses], undo);
+            if (job.contains(kMaterials)) applyMaterials(job[kMaterials], undo);
+            if (job.contains(kTime))
+            {
+                // Render all frames of the job at the given time.
+                auto& clock = mpRenderer->getGlobalClock();
+                double prevTime = clock.getTime();
+                bool prevPaused = clock.isPaused();
+                clock.setTime(job[kTime].get<double>()).pause();
+                undo.push_back([this, prevTime, prevPaused]() {
+                    auto& clock = mpRenderer->getGlobalClock();
+                    clock.setTime(prevTime);
+                    if (!prevPaused) clock.play();
+                });
+            }
+            std::vector<std::string> outputs = prepareOutputs(job.contains(kOutputs) ? job[kOutputs] : json(), undo);
+            timing["applyMs"] = elapsedMs(start);
+
+            // Render. Passes that accumulate over frames are reset, so each job starts from scratch.
+            start = CpuTimer::getCurrentTimePoint();
+            uint32_t frames = job.value(kFrames, 1u);
+            FALCOR_CHECK(frames > 0, "'{}' must be at least 1.", kFrames);
+            mpRenderer->mRefreshFlags |= RenderPassRefreshFlags::RenderOptionsChanged;
+            for (uint32_t i = 0; i < frames; i++) mpRenderer->renderFrame();
+            mpRenderer->getDevice()->wait();
+            timing["renderMs"] = elapsedMs(start);
+            timing["frames"] = frames;
+
+            // Write outputs.
+            start = CpuTimer::getCurrentTimePoint();
+            std::filesystem::path outputDir = job.contains(kOutputDir) ? std::filesystem::path(job[kOutputDir].get<std::string>()) : mOptions.outputDir;
+            result[kOutputs] = writeOutputs(outputs, outputDir, jobId);
+            timing["writeMs"] = elapsedMs(start);
+
+            result["success"] = true;
+        }
+        catch (const std::exception& e)
+        {
+            result["success"] = false;
+            result["error"] = e.what();
+        }
+
+        // Revert deltas. A failure here leaves the renderer in an unknown state, so report it but keep going.
+        for (auto it = undo.rbegin(); it != undo.rend(); ++it)
+        {
+            try
+            {
+                (*it)();
+            }
+            catch (const std::exception& e)
+            {
+                logError("Batch job '{}': failed to revert job settings: {}", jobId, e.what());
+            }
+        }
+
+        timing["totalMs"] = elapsedMs(jobStart);
+        result["timing"] = timing;
+        return result;
+    }
+
+    void BatchRenderer::selectScene(const std::filesystem::path& path)
+    {
+        const auto absPath = std::filesystem::absolute(path).lexically_normal();
+
+        auto it = std::find_if(mScenes.begin(), mScenes.end(), [&](const ResidentScene& s) { return s.path == absPath; });
+        if (it != mScenes.end())
+        {
+            // Move to front of the LRU list.
+            mScenes.splice(mScenes.begin(), mScenes, it);
+        }
+        else
+        {
+            ref<Scene> pScene = SceneBuilder(mpRenderer->getDevice(), absPath, mpRenderer->getSettings(), mpRenderer->getSceneBuildFlags()).getScene();
+            mScenes.push_front({ absPath, pScene });
+
+            // Release the least recently used scenes. The device is idle between jobs, so their resources can be freed immediately.
+            while (mScenes.size() > mOptions.maxResidentScenes) mScenes.pop_back();
+        }
+
+        if (mpRenderer->mpScene != mScenes.front().pScene) mpRenderer->setScene(mScenes.front().pScene);
+    }
+
+    void BatchRenderer::selectGraph(const std::string& name)
+    {
+        size_t index = mpRenderer->findGraph(name);
+        FALCOR_CHECK(index != size_t(-1), "Can't find render graph '{}'.", name);
+        if (index != mpRenderer->getActiveGraphIndex()) mpRenderer->setActiveGraph((uint32_t)index);
+    }
+
+    void BatchRenderer::applyCamera(const json& desc, UndoList& undo)
+    {
+        const ref<Scene>& pScene = mpRenderer->mpScene;
+        FALCOR_CHECK(pScene, "Can't set camera without a scene.");
+        FALCOR_CHECK(desc.is_object(), "'{}' must be a JSON object.", kCamera);
+
+        if (desc.contains(kCameraName))
+        {
+            const auto& cameras = pScene->getCameras();
+            uint32_t prevIndex = (uint32_t)std::distance(cameras.begin(), std::find(cameras.begin(), cameras.end(), pScene->getCamera()));
+            pScene->selectCamera(desc[kCameraName].get<std::string>());
+            undo.push_back([pScene, prevIndex]() { pScene->selectCamera(prevIndex); });
+        }
+
+        ref<Camera> pCamera = pScene->getCamera();
+        FALCOR_CHECK(pCamera, "Scene has no camera.");
+
+        // Save the camera state after selecting the camera, the undo list is executed in reverse order.
+        undo.push_back([pCamera, position = pCamera->getPosition(), target = pCamera->getTarget(), up = pCamera->getUpVector(),
+                        focalLength = pCamera->getFocalLength(), focalDistance = pCamera->getFocalDistance(), apertureRadius = pCamera->getApertureRadius()]()
+        {
+            pCamera->setPosition(position);
+            pCamera->setTarget(target);
+            pCamera->setUpVector(up);
+            pCamera->setFocalLength(focalLength);
+            pCamera->setFocalDistance(focalDistance);
+            pCamera->setApertureRadius(apertureRadius);
+        });
+
+        for (const auto& [key, value] : desc.items())
+        {
+            if (key == kCameraName) continue;
+            else if (key == kCameraPosition) pCamera->setPosition(parseFloat3(value, kCameraPosition));
+            else if (key == kCameraTarget) pCamera->setTarget(parseFloat3(value, kCameraTarget));
+            else if (key == kCameraUp) pCamera->setUpVector(parseFloat3(value, kCameraUp));
+            else if (key == kCameraFocalLength) pCamera->setFocalLength(value.get<float>());
+            else if (key == kCameraFocalDistance) pCamera->setFocalDistance(value.get<float>());
+            else if (key == kCameraApertureRadius) pCamera->setApertureRadius(value.get<float>());
+            else FALCOR_THROW("Unknown camera field '{}'.", key);
+        }
+    }
+
+    void BatchRenderer::applyPassProperties(const json& desc, UndoList& undo)
+    {
+        RenderGraph* pGraph = mpRenderer->getActiveGraph();
+        FALCOR_CHECK(desc.is_object(), "'{}' must be a JSON object.", kPasses);
+
+        for (const auto& [passName, props] : desc.items())
+        {
+            const ref<RenderPass>& pPass = pGraph->getPass(passName);
+            FALCOR_CHECK(props.is_object(), "Properties of pass '{}' must be a JSON object.", passName);
+
+            // Passes only update the properties that are set, so merge the delta into the current properties.
+            Properties prevProps = pPass->getProperties();
+            json newProps = prevProps.toJson();
+            newProps.update(props);
+            pPass->setProperties(Properties(newProps));
+            undo.push_back([pPass, prevProps]() { pPass->setProperties(prevProps); });
+        }
+    }
+
+    void BatchRenderer::applyMaterials(const json& desc, UndoList& undo)
+    {
+        const ref<Scene>& pScene = mpRenderer->mpScene;
+        FALCOR_CHECK(pScene, "Can't override materials without a scene.");
+        FALCOR_CHECK(desc.is_object(), "'{}' must be a JSON object.", kMaterials);
+
+        for (const auto& [materialName, params] : desc.items())
+        {
+            ref<Material> pMaterial = pScene->getMaterialByName(materialName);
+            FALCOR_CHECK(pMaterial, "Can't find material '{}'.", materialName);
+            FALCOR_CHECK(params.is_object(), "Parameters of material '{}' must be a JSON object.", materialName);
+
+            // Overrides go through the generic parameter layout, so they work for all materials that support it.
+            const MaterialParamLayout& layout = pMaterial->getParamLayout();
+            const SerializedMaterialParams prevParams = pMaterial->serializeParams();
+            SerializedMaterialParams newParams = prevParams;
+
+            for (const auto& [paramName, value] : params.items())
+            {
+                auto entry = std::find_if(layout.begin(), layout.end(), [&](const MaterialParamLayoutEntry& e) { return paramName == e.name || paramName == e.pythonName; });
+                FALCOR_CHECK(entry != layout.end(), "Material '{}' has no parameter '{}'.", materialName, paramName);
+
+                if (entry->size == 1 && value.is_number())
+                {
+                    newParams.write(value.get<float>(), entry->offset);
+                }
+                else
+                {
+                    FALCOR_CHECK(value.is_array() && value.size() == entry->size, "Parameter '{}' of material '{}' must have {} components.", paramName, materialName, entry->size);
+                    for (uint32_t i = 0; i < entry->size; i++) newParams.write(value[i].get<float>(), entry->offset + i);
+                }
+            }
+
+            pMaterial->deserializeParams(newParams);
+            undo.push_back([pMaterial, prevParams]() { pMaterial->deserializeParams(prevParams); });
+        }
+    }
+
+    std::vector<std::string> BatchRenderer::prepareOutputs(const json& desc, UndoList& undo)
+    {
+        RenderGraph* pGraph = mpRenderer->getActiveGraph();
+
+        // Default to all marked outputs.
+        if (desc.is_null())
+        {
+            std::vector<std::string> outputs;
+            for (size_t i = 0; i < pGraph->getOutputCount(); i++) outputs.push_back(pGraph->getOutputName(i));
+            return outputs;
+        }
+
+        FALCOR_CHECK(desc.is_array(), "'{}' must be an array of graph output names.", kOutputs);
+        std::vector<std::string> outputs = desc.get<std::vector<std::string>>();
+
+        // Temporarily mark outputs that are not marked. The graph is recompiled before the first frame.
+        for (const auto& output : outputs)
+        {
+            if (pGraph->isGraphOutput(output)) continue;
+            pGraph->markOutput(output);
+            undo.push_back([pGraph, output]() { pGraph->unmarkOutput(output); });
+        }
+        return outputs;
+    }
+
+    json BatchRenderer::writeOutputs(const std::vector<std::string>& outputs, const std::filesystem::path& outputDir, const std::string& jobId)
+    {
+        RenderGraph* pGraph = mpRenderer->getActiveGraph();
+        if (!outputDir.empty()) std::filesystem::create_directories(outputDir);
+
+        json paths = json::object();
+        for (const auto& output : outputs)
+        {
+            ref<Resource> pResource = pGraph->getOutput(output);
+            ref<Texture> pTex = pResource ? pResource->asTexture() : nullptr;
+            FALCOR_CHECK(pTex, "Graph output '{}' is not a texture.", output);
+
+            auto ext = Bitmap::getFileExtFromResourceFormat(pTex->getFormat());
+            auto path = outputDir / (jobId + "." + output + "." + ext);
+            mpImageWriter->writeTexture(pTex.get(), 0, 0, path, Bitmap::getFormatFromFileExtension(ext));
+            paths[output] = path.string();
+        }
+
+        // Wait for the images, so the files exist when the result is reported.
+        uint64_t failedCount = mpImageWriter->getStats().failedCount;
+        mpImageWriter->flush();
+        FALCOR_CHECK(mpImageWriter->getStats().failedCount == failedCount, "Failed to write outputs to '{}'.", outputDir);
+        return paths;
+    }
+}
@@ -0,0 +1,105 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Falcor.h"
+#include "Utils/Image/AsyncImageWriter.h"
+#include <nlohmann/json_fwd.hpp>
+#include <filesystem>
+#include <functional>
+#include <iosfwd>
+#include <list>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace Falcor;
+
+namespace Mogwai
+{
+    class Renderer;
+
+    /** Renders a queue of jobs while keeping the device, loaded scenes and compiled render graphs resident.
+
+        Jobs are read as JSON objects, one per line. Each job selects a scene and a graph, applies a set of
+        deltas (camera, time, pass properties, material overrides, resolution), renders a number of frames
+        and writes the requested graph outputs. All deltas are reverted after the job, so jobs are independent
+        of each other. Only the scene and graph selection carry over to the next job, which avoids reloading.
+
+        For each job, a JSON object with the result and timing breakdown is written as a single line to the result stream.
+        See docs/usage/batch-mode.md for the job format.
+    */
+    class BatchRenderer
+    {
+    public:
+        struct Options
+        {
+            size_t maxResidentScenes = 2;           ///< Maximum number of scenes kept loaded. The least recently used scene is released first.
+            std::filesystem::path outputDir;        ///< Default output directory for jobs that don't specify one.
+        };
+
+        BatchRenderer(Renderer* pRenderer, const Options& options);
+        ~BatchRenderer();
+
+        /** Run jobs read from a stream until the end of the stream or an exit job is reached.
+            \param[in] input Stream of jobs, one JSON object per line. Empty lines are ignored.
+            \param[out] results Stream receiving one JSON object per line for each job.
+            \return Number of jobs that failed.
+        */
+        uint32_t run(std::istream& input, std::ostream& results);
+
+        /** Run a single job.
+            \param[in] job Job description.
+            \return Result of the job.
+        */
+        nlohmann::ordered_json runJob(const nlohmann::ordered_json& job);
+
+    private:
+        using UndoList = std::vector<std::function<void()>>;
+
+        void selectScene(const std::filesystem::path& path);
+        void selectGraph(const std::string& name);
+        void applyCamera(const nlohmann::ordered_json& desc, UndoList& undo);
+        void applyPassProperties(const nlohmann::ordered_json& desc, UndoList& undo);
+        void applyMaterials(const nlohmann::ordered_json& desc, UndoList& undo);
+        std::vector<std::string> prepareOutputs(const nlohmann::ordered_json& desc, UndoList& undo);
+        nlohmann::ordered_json writeOutputs(const std::vector<std::string>& outputs, const std::filesystem::path& outputDir, const std::string& jobId);
+
+        struct ResidentScene
+        {
+            std::filesystem::path path;
+            ref<Scene> pScene;
+        };
+
+        Renderer* mpRenderer;
+        Options mOptions;
+        std::list<ResidentScene> mScenes;           ///< Resident scenes, most recently used first.
+        std::set<std::filesystem::path> mLoadedScripts;
+        std::unique_ptr<AsyncImageWriter> mpImageWriter;
+        uint64_t mJobCount = 0;
+    };
+}
@@ -41,6 +41,14 @@ namespace Mogwai
         const std::string kUI = "ui";
         const std::string kOutputs = "outputs";
         const std::string kCapture = "capture";
+        const std::string kFlush = "flush";
+        const std::string kExrCompression = "exrCompression";
+        const std::string kPngCompressionLevel = "pngCompressionLevel";
+        const std::string kEncoderThreads = "encoderThreads";
+        const std::string kMaxPendingImages = "maxPendingImages";
+        const std::string kCaptureLog = "captureLog";
+        const std::string kExrLayers = "exrLayers";
+        const std::string kExrLayout = "exrLayout";
 
         template<typename T>
         std::vector<typename T::value_type::first_type> getFirstOfPair(const T& pair)
@@ -63,6 +71,65 @@ namespace Mogwai
         : CaptureTrigger(pRenderer, "Frame Capture")
     {
         mpImageProcessing = std::make_unique<ImageProcessing>(pRenderer->getDevice());
+        mpImageWriter = std::make_unique<AsyncImageWriter>(mWriterOptions);
+    }
+
+    FrameCapture::~FrameCapture()
+    {
+        // Wait for all pending images to be written.
+        mpImageWriter.reset();
+    }
+
+    void FrameCapture::flush()
+    {
+        mpImageWriter->flush();
+    }
+
+    void FrameCapture::setWriterOptions(const AsyncImageWriter::Options& options)
+    {
+        // The encoder settings can be changed on the fly, everything else requires a new writer.
+        const bool recreate = options.threadCount != mWriterOptions.threadCount || options.maxPendingImages != mWriterOptions.maxPendingImages || options.logPath != mWriterOptions.logPath;
+        mWriterOptions = options;
+        if (recreate)
+        {
+            mpImageWriter.reset();
+            mpImageWriter = std::make_unique<AsyncImageWriter>(mWriterOptions);
+        }
+        else
+        {
+            mpImageWriter->setEncoderOptions(mWriterOptions.encoderOptions);
+        }
+    }
+
+    void FrameCapture::renderWriterUI(Gui::Window& w)
+    {
+        if (auto g = w.group("Encoder"))
+        {
+            auto options = mWriterOptions;
+            bool changed = false;
+            changed |= g.dropdown("EXR Compression", options.encoderOptions.exrCompression);
+            g.tooltip("Compression of EXR files. 'Default' derives the compression from the export flags.");
+            g.checkbox("EXR Layers", mExrLayers);
+            g.tooltip("Write all EXR outputs of a frame as layers of a single file.");
+            if (mExrLayers) g.dropdown("EXR Layout", mExrLayout);
+            changed |= g.var("PNG Compression Level", options.encoderOptions.pngCompressionLevel, -1, 9);
+            g.tooltip("zlib compression level (0-9) of PNG files. -1 uses the default level.");
+            uint32_t threadCount = (uint32_t)options.threadCount;
+            if (g.var("Encoder Threads", threadCount, 1u, 64u)) { options.threadCount = threadCount; changed = true; }
+            uint32_t maxPendingImages = (uint32_t)options.maxPendingImages;
+            if (g.var("Max Pending Images", maxPendingImages, 1u, 256u)) { options.maxPendingImages = maxPendingImages; changed = true; }
+            g.tooltip("Maximum number of images queued for encoding. Capturing blocks while the queue is full.");
+            if (changed) setWriterOptions(options);
+
+            const auto stats = mpImageWriter->getStats();
+            const uint64_t finishedCount = stats.writtenCount + stats.failedCount;
+            std::string text;
+            text += fmt::format("Pending images: {} (max {})\n", stats.pendingCount, stats.maxPendingCount);
+            text += fmt::format("Written images: {} ({} failed)\n", stats.writtenCount, stats.failedCount);
+            text += fmt::format("Encode time: {:.1f} ms (avg {:.1f} ms)\n", stats.lastEncodeTimeMS, finishedCount > 0 ? stats.totalEncodeTimeMS / finishedCount : 0.0);
+            text += fmt::format("Stall time: {:.1f} ms", stats.totalStallTimeMS);
+            g.text(text);
+        }
     }
 
     void FrameCapture::renderUI(Gui* pGui)
@@ -77,6 +144,8 @@ namespace Mogwai
             w.tooltip("Capture all available outputs instead of the marked ones only.");
 
             if (w.button("Capture Current Frame")) capture();
+
+            renderWriterUI(w);
         }
     }
 
@@ -95,6 +164,7 @@ namespace Mogwai
         auto printGraph = [](FrameCapture* pFC, RenderGraph* pGraph) { pybind11::print(pFC->graphFramesStr(pGraph)); };
         frameCapture.def(kPrintFrames.c_str(), printGraph, "graph"_a);
         frameCapture.def(kCapture.c_str(), &FrameCapture::capture);
+        frameCapture.def(kFlush.c_str(), &FrameCapture::flush);
         auto printAllGraphs = [](FrameCapture* pFC)
         {
             std::string s;
@@ -111,6 +181,43 @@ namespace Mogwai
         frameCapture.def_property("captureAllOutputs",
             [](FrameCapture* pFC){ return pFC->mCaptureAllOutputs;},
             [](FrameCapture* pFC, bool all){ pFC->mCaptureAllOutputs = all; });
+
+        // Encoder settings
+        frameCapture.def_property(kEncoderThreads.c_str(),
+            [](FrameCapture* pFC) { return pFC->mWriterOptions.threadCount; },
+            [](FrameCapture* pFC, size_t count) { auto options = pFC->mWriterOptions; options.threadCount = count; pFC->setWriterOptions(options); });
+        frameCapture.def_property(kMaxPendingImages.c_str(),
+            [](FrameCapture* pFC) { return pFC->mWriterOptions.maxPendingImages; },
+            [](FrameCapture* pFC, size_t count) { auto options = pFC->mWriterOptions; options.maxPendingImages = count; pFC->setWriterOptions(options); });
+        frameCapture.def_property(kCaptureLog.c_str(),
+            [](FrameCapture* pFC) { return pFC->mWriterOptions.logPath; },
+            [](FrameCapture* pFC, const std::filesystem::path& path) { auto options = pFC->mWriterOptions; options.logPath = path; pFC->setWriterOptions(options); });
+        frameCapture.def_property(kExrCompression.c_str(),
+            [](FrameCapture* pFC) { return pFC->mWriterOptions.encoderOptions.exrCompression; },
+            [](FrameCapture* pFC, Bitmap::ExrCompression compression) { auto options = pFC->mWriterOptions; options.encoderOptions.exrCompression = compression; pFC->setWriterOptions(options); });
+        frameCapture.def_property(kExrLayers.c_str(),
+            [](FrameCapture* pFC) { return pFC->mExrLayers; },
+            [](FrameCapture* pFC, bool enable) { pFC->mExrLayers = enable; });
+        frameCapture.def_property(kExrLayout.c_str(),
+            [](FrameCapture* pFC) { return pFC->mExrLayout; },
+            [](FrameCapture* pFC, ExrWriter::Layout layout) { pFC->mExrLayout = layout; });
+        frameCapture.def_property(kPngCompressionLevel.c_str(),
+            [](FrameCapture* pFC) { return pFC->mWriterOptions.encoderOptions.pngCompressionLevel; },
+            [](FrameCapture* pFC, int level) { auto options = pFC->mWriterOptions; options.encoderOptions.pngCompressionLevel = level; pFC->setWriterOptions(options); });
+        frameCapture.def_property_readonly("stats", [](FrameCapture* pFC)
+        {
+            const auto stats = pFC->mpImageWriter->getStats();
+            pybind11::dict d;
+            d["submittedCount"] = stats.submittedCount;
+            d["writtenCount"] = stats.writtenCount;
+            d["failedCount"] = stats.failedCount;
+            d["pendingCount"] = stats.pendingCount;
+            d["maxPendingCount"] = stats.maxPendingCount;
+            d["lastEncodeTimeMS"] = stats.lastEncodeTimeMS;
+            d["totalEncodeTimeMS"] = stats.totalEncodeTimeMS;
+            d["totalStallTimeMS"] = stats.totalStallTimeMS;
+            return d;
+        });
     }
 
     std::string FrameCapture::getScriptVar() const
@@ -125,6 +232,15 @@ namespace Mogwai
         s += "# Frame Capture\n";
         s += CaptureTrigger::getScript(var);
 
+        const AsyncImageWriter::Options defaultOptions;
+        if (mWriterOptions.encoderOptions.exrCompression != defaultOptions.encoderOptions.exrCompression) s += ScriptWriter::makeSetProperty(var, kExrCompression, mWriterOptions.encoderOptions.exrCompression);
+        if (mExrLayers) s += ScriptWriter::makeSetProperty(var, kExrLayers, mExrLayers);
+        if (mExrLayout != ExrWriter::Layout::MultiLayer) s += ScriptWriter::makeSetProperty(var, kExrLayout, mExrLayout);
+        if (mWriterOptions.encoderOptions.pngCompressionLevel != defaultOptions.encoderOptions.pngCompressionLevel) s += ScriptWriter::makeSetProperty(var, kPngCompressionLevel, mWriterOptions.encoderOptions.pngCompressionLevel);
+        if (mWriterOptions.threadCount != defaultOptions.threadCount) s += ScriptWriter::makeSetProperty(var, kEncoderThreads, mWriterOptions.threadCount);
+        if (mWriterOptions.maxPendingImages != defaultOptions.maxPendingImages) s += ScriptWriter::makeSetProperty(var, kMaxPendingImages, mWriterOptions.maxPendingImages);
+        if (!mWriterOptions.logPath.empty()) s += ScriptWriter::makeSetProperty(var, kCaptureLog, ScriptWriter::getPathString(mWriterOptions.logPath));
+
         for (const auto& g : mGraphRanges)
         {
             s += ScriptWriter::makeMemberFunc(var, kAddFrames, g.first->getName(), getFirstOfPair(g.second));
@@ -144,9 +260,16 @@ namespace Mogwai
             pGraph->execute(pRenderContext);
         }
 
+        std::unique_ptr<ExrWriter> pExrWriter;
         for (uint32_t i = 0 ; i < pGraph->getOutputCount() ; i++)
         {
-            captureOutput(pRenderContext, pGraph, i);
+            captureOutput(pRenderContext, pGraph, i, mExrLayers ? &pExrWriter : nullptr);
+        }
+
+        if (pExrWriter)
+        {
+            auto path = getOutputPath() / (getBaseFilename() + "." + std::to_string(mpRenderer->getGlobalClock().getFrame()) + ".exr");
+            mpImageWriter->writeExr(path, std::move(*pExrWriter));
         }
 
         if (mCaptureAllOutputs && !unmarkedOutputs.empty())
@@ -156,7 +279,7 @@ namespace Mogwai
         }
     }
 
-    void FrameCapture::captureOutput(RenderContext* pRenderContext, RenderGraph* pGraph, const uint32_t outputIndex)
+    void FrameCapture::captureOutput(RenderContext* pRenderContext, RenderGraph* pGraph, const uint32_t outputIndex, std::unique_ptr<ExrWriter>* ppExrWriter)
     {
         const std::string outputName = pGraph->getOutputName(outputIndex);
         const std::string basename = getOutputNamePrefix(outputName) + std::to_string(mpRenderer->getGlobalClock().getFrame());
@@ -248,10 +371,53 @@ namespace Mogwai
             Bitmap::ExportFlags flags = Bitmap::ExportFlags::None;
             if (mask == TextureChannelFlags::RGBA) flags |= Bitmap::ExportFlags::ExportAlpha;
 
-            pTex->captureToFile(0, 0, filename, fileformat, flags);
+            // Collect EXR images as layers of a single file if enabled. Images that don't fit are written separately.
+            if (ppExrWriter && fileformat == Bitmap::FileFormat::ExrFile && addExrLayer(*ppExrWriter, pTex.get(), outputName, mask)) continue;
+
+            // Read back the image and hand it to the encoder threads. This blocks if too many images are pending.
+            mpImageWriter->writeTexture(pTex.get(), 0, 0, filename, fileformat, flags);
         }
     }
 
+    bool FrameCapture::addExrLayer(std::unique_ptr<ExrWriter>& pExrWriter, Texture* pTex, const std::string& layerName, TextureChannelFlags mask)
+    {
+        // Name single channels after the mask, e.g. "output.A".
+        std::vector<std::string> channelNames;
+        switch (mask)
+        {
+        case TextureChannelFlags::Red: channelNames = { "R" }; break;
+        case TextureChannelFlags::Green: channelNames = { "G" }; break;
+        case TextureChannelFlags::Blue: channelNames = { "B" }; break;
+        case TextureChannelFlags::Alpha: channelNames = { "A" }; break;
+        case TextureChannelFlags::RGB: channelNames = { "R", "G", "B" }; break;
+        default: channelNames = { "R", "G", "B", "A" }; break;
+        }
+        channelNames.resize(std::min<size_t>(channelNames.size(), getFormatChannelCount(pTex->getFormat())));
+
+        const ResourceFormat format = pTex->getFormat();
+        if (!ExrWriter::isFormatSupported(format)) return false;
+
+        if (!pExrWriter)
+        {
+            ExrWriter::Options options;
+            options.compression = mWriterOptions.encoderOptions.exrCompression;
+            options.layout = mExrLayout;
+            pExrWriter = std::make_unique<ExrWriter>(pTex->getWidth(), pTex->getHeight(), options);
+        }
+
+        if (pTex->getWidth() != pExrWriter->getWidth() || pTex->getHeight() != pExrWriter->getHeight() || !pExrWriter->canAddLayer(layerName, channelNames)) return false;
+
+        // Keep the precision of the output.
+        ExrWriter::PixelType pixelType = ExrWriter::PixelType::Half;
+        if (getFormatType(format) == FormatType::Uint) pixelType = ExrWriter::PixelType::Uint;
+        else if (getNumChannelBits(format, 0) > 16) pixelType = ExrWriter::PixelType::Float;
+
+        ResourceFormat dataFormat;
+        std::vector<uint8_t> data = pTex->readImageData(0, 0, Bitmap::FileFormat::ExrFile, dataFormat);
+        pExrWriter->addLayer(layerName, dataFormat, std::move(data), pixelType, std::move(channelNames));
+        return true;
+    }
+
     void FrameCapture::addFrames(const RenderGraph* pGraph, const uint64_vec& frames)
     {
         for (auto f : frames) addRange(pGraph, f, 1);
@@ -28,6 +28,8 @@
 #pragma once
 #include "../../Mogwai.h"
 #include "CaptureTrigger.h"
+#include "Utils/Image/AsyncImageWriter.h"
+#include "Utils/Image/ExrWriter.h"
 #include "Utils/Image/ImageProcessing.h"
 
 namespace Mogwai
@@ -36,12 +38,14 @@ namespace Mogwai
     {
     public:
         static UniquePtr create(Renderer* pRenderer);
+        virtual ~FrameCapture();
         virtual void renderUI(Gui* pGui) override;
         virtual void registerScriptBindings(pybind11::module& m) override;
         virtual std::string getScriptVar() const override;
         virtual std::string getScript(const std::string& var) const override;
         virtual void triggerFrame(RenderContext* pRenderContext, RenderGraph* pGraph, uint64_t frameID) override;
         void capture();
+        void flush();
 
     private:
         FrameCapture(Renderer* pRenderer);
@@ -50,9 +54,16 @@ namespace Mogwai
         void addFrames(const RenderGraph* pGraph, const uint64_vec& frames);
         void addFrames(const std::string& graphName, const uint64_vec& frames);
         std::string graphFramesStr(const RenderGraph* pGraph);
-        void captureOutput(RenderContext* pRenderContext, RenderGraph* pGraph, const uint32_t outputIndex);
+        void captureOutput(RenderContext* pRenderContext, RenderGraph* pGraph, const uint32_t outputIndex, std::unique_ptr<ExrWriter>* ppExrWriter);
+        bool addExrLayer(std::unique_ptr<ExrWriter>& pExrWriter, Texture* pTex, const std::string& layerName, TextureChannelFlags mask);
+        void setWriterOptions(const AsyncImageWriter::Options& options);
+        void renderWriterUI(Gui::Window& w);
 
         bool mCaptureAllOutputs = false;
+        bool mExrLayers = false; ///< Write all EXR outputs of a frame to a single file.
+        ExrWriter::Layout mExrLayout = ExrWriter::Layout::MultiLayer;
         std::unique_ptr<ImageProcessing> mpImageProcessing;
+        AsyncImageWriter::Options mWriterOptions;
+        std::unique_ptr<AsyncImageWriter> mpImageWriter;
     };
 }
@@ -28,6 +28,7 @@
 #include "Falcor.h"
 #include "Mogwai.h"
 #include "MogwaiSettings.h"
+#include "BatchRenderer.h"
 #include "GlobalState.h"
 #include "Core/AssetResolver.h"
 #include "Scene/Importer.h"
@@ -40,6 +41,8 @@
 #include <args.hxx>
 
 #include <filesystem>
+#include <fstream>
+#include <iostream>
 #include <algorithm>
 
 FALCOR_EXPORT_D3D12_AGILITY_SDK
@@ -101,7 +104,7 @@ namespace Mogwai
     void Renderer::onLoad(RenderContext* pRenderContext)
     {
         // Load all plugins
-        PluginManager::instance().loadAllPlugins();
+        PluginManager::instance().loadAllPlugins(mOptions.lazyPlugins);
 
         mpExtensions.push_back(MogwaiSettings::create(this));
         if (gExtensions)
@@ -135,6 +138,50 @@ namespace Mogwai
             // Add scene to recent files only if not in silent mode (which is used during image tests).
             if (!mOptions.silentMode) mAppData.addRecentScene(mOptions.sceneFile);
         }
+
+        // Run batch jobs and exit.
+        if (!mOptions.batchFile.empty())
+        {
+            shutdown(runBatch());
+        }
+    }
+
+    int Renderer::runBatch()
+    {
+        std::ifstream jobFile;
+        if (mOptions.batchFile != "-")
+        {
+            jobFile.open(mOptions.batchFile);
+            if (!jobFile.good())
+            {
+                logError("Failed to open batch job file '{}'.", mOptions.batchFile);
+                return 1;
+            }
+        }
+
+        std::ofstream resultFile;
+        bool resultsToStdout = mOptions.batchResultsFile.empty() || mOptions.batchResultsFile == "-";
+        if (!resultsToStdout)
+        {
+            resultFile.open(mOptions.batchResultsFile);
+            if (!resultFile.good())
+            {
+                logError("Failed to open batch result file '{}'.", mOptions.batchResultsFile);
+                return 1;
+            }
+        }
+
+        // Keep stdout clean for the results.
+        auto prevLogOutputs = Logger::getOutputs();
+        if (resultsToStdout) Logger::setOutputs(prevLogOutputs & ~Logger::OutputFlags::Console);
+
+        BatchRenderer::Options options;
+        options.maxResidentScenes = mOptions.batchMaxResidentScenes;
+        uint32_t failedCount = BatchRenderer(this, options).run(jobFile.is_open() ? jobFile : std::cin, resultsToStdout ? std::cout : resultFile);
+
+        Logger::setOutputs(prevLogOutputs);
+        if (failedCount > 0) logWarning("{} batch job(s) failed.", failedCount);
+        return failedCount > 0 ? 1 : 0;
     }
 
     void Renderer::onOptionsChange()
@@ -533,10 +580,17 @@ namespace Mogwai
         }
     }
 
-    void Renderer::loadScene(std::filesystem::path path, SceneBuilder::Flags buildFlags)
+    SceneBuilder::Flags Renderer::getSceneBuildFlags(SceneBuilder::Flags buildFlags) const
     {
         if (mOptions.useSceneCache) buildFlags |= SceneBuilder::Flags::UseCache;
         if (mOptions.rebuildSceneCache) buildFlags |= SceneBuilder::Flags::RebuildCache;
+        if (mOptions.useTextureCache) buildFlags |= SceneBuilder::Flags::UseTextureCache;
+        return buildFlags;
+    }
+
+    void Renderer::loadScene(std::filesystem::path path, SceneBuilder::Flags buildFlags)
+    {
+        buildFlags = getSceneBuildFlags(buildFlags);
 
         while (true)
         {
@@ -653,7 +707,8 @@ namespace Mogwai
         }
 
         // Execute graph.
-        pGraph->getPassesDictionary()[kRenderPassRefreshFlags] = RenderPassRefreshFlags::None;
+        pGraph->getPassesDictionary()[kRenderPassRefreshFlags] = mRefreshFlags;
+        mRefreshFlags = RenderPassRefreshFlags::None;
         pGraph->execute(pRenderContext);
     }
 
@@ -839,6 +894,7 @@ int runMain(int argc, char** argv)
     args::Flag deferredFlag(parser, "deferred", "The script is loaded deferred.", {"deferred"});
     args::ValueFlag<std::string> sceneFlag(parser, "path", "Scene file (for example, a .pyscene file) to open.", { 'S', "scene" });
     args::ValueFlag<std::string> shaderCacheFlag(parser, "shadercache", "Path to the GFX shader cache.", { "shadercache" });
+    args::ValueFlag<std::string> programCacheFlag(parser, "programcache", "Path to the Slang program cache (empty to disable).", { "programcache" });
     args::ValueFlag<std::string> logfileFlag(parser, "path", "File to write log into.", {'l', "logfile"});
     args::ValueFlag<int32_t> verbosityFlag(parser, "verbosity", "Logging verbosity (0=disabled, 1=fatal errors, 2=errors, 3=warnings, 4=infos, 5=debugging)", { 'v', "verbosity" }, 4);
     args::Flag silentFlag(parser, "", "Start without opening a window and handling user input (deprecated: use --headless).", {"silent"});
@@ -847,10 +903,15 @@ int runMain(int argc, char** argv)
     args::ValueFlag<uint32_t> heightFlag(parser, "pixels", "Initial window height.", {"height"});
     args::Flag useSceneCacheFlag(parser, "", "Use scene cache to improve scene load times.", {'c', "use-cache"});
     args::Flag rebuildSceneCacheFlag(parser, "", "Rebuild the scene cache.", {"rebuild-cache"});
+    args::Flag useTextureCacheFlag(parser, "", "Use texture cache to improve texture load times.", {"use-texture-cache"});
+    args::Flag lazyPluginsFlag(parser, "", "Load plugin libraries on first use (script bindings of unloaded plugins are unavailable).", {"lazy-plugins"});
     args::Flag generateShaderDebugInfoFlag(parser, "", "Generate shader debug info.", {"debug-shaders"});
     args::Flag enableDebugLayerFlag(parser, "", "Enable debug layer (enabled by default in Debug build).", {"enable-debug-layer"});
     args::Flag preciseProgramFlag(parser, "", "Force all slang programs to run in precise mode", { "precise" });
     args::ValueFlag<std::string> attributesFlag(parser, "path", "JSON attributes file.", { 'a', "attributes" });
+    args::ValueFlag<std::string> batchFlag(parser, "path", "Run batch render jobs from a JSON-lines file ('-' for stdin) and exit.", {"batch"});
+    args::ValueFlag<std::string> batchResultsFlag(parser, "path", "File to write batch job results to (default: stdout).", {"batch-results"});
+    args::ValueFlag<uint32_t> batchMaxScenesFlag(parser, "count", "Maximum number of scenes kept loaded in batch mode.", {"batch-max-scenes"}, 2);
     args::Flag rayTracingValidationFlag(parser, "", "Enable ray tracing validation (requires env-var NV_ALLOW_RAYTRACING_VALIDATION=1)", {"enable-raytracing-validation"});
 
     args::CompletionFlag completionFlag(parser, {"complete"});
@@ -934,6 +995,8 @@ int runMain(int argc, char** argv)
         config.headless = true;
     if (shaderCacheFlag)
         config.deviceDesc.shaderCachePath = args::get(shaderCacheFlag);
+    if (programCacheFlag)
+        config.deviceDesc.programCachePath = args::get(programCacheFlag);
     if (enableDebugLayerFlag)
         config.deviceDesc.enableDebugLayer = true;
     if (generateShaderDebugInfoFlag)
@@ -963,6 +1026,11 @@ int runMain(int argc, char** argv)
     if (silentFlag) options.silentMode = true;
     if (useSceneCacheFlag) options.useSceneCache = true;
     if (rebuildSceneCacheFlag) options.rebuildSceneCache = true;
+    if (useTextureCacheFlag) options.useTextureCache = true;
+    if (lazyPluginsFlag) options.lazyPlugins = true;
+    if (batchFlag) options.batchFile = args::get(batchFlag);
+    if (batchResultsFlag) options.batchResultsFile = args::get(batchResultsFlag);
+    options.batchMaxResidentScenes = args::get(batchMaxScenesFlag);
 
     Mogwai::Renderer renderer(config, options);
     return renderer.run();
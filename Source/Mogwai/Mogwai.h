@@ -30,6 +30,7 @@
 #include "Core/SampleApp.h"
 #include "Scene/SceneBuilder.h"
 #include "RenderGraph/RenderGraph.h"
+#include "RenderGraph/RenderPassStandardFlags.h"
 #include "AppData.h"
 
 namespace Falcor
@@ -87,6 +88,11 @@ namespace Mogwai
             bool silentMode = false;
             bool useSceneCache = false;
             bool rebuildSceneCache = false;
+            bool useTextureCache = false;
+            bool lazyPlugins = false;       ///< Load plugin libraries on first use from the plugin manifest.
+            std::string batchFile;          ///< Batch job file to run after loading, or "-" for stdin. See BatchRenderer.
+            std::string batchResultsFile;   ///< Batch result file, or empty/"-" for stdout.
+            size_t batchMaxResidentScenes = 2;
         };
 
         using KeyCallback = std::function<bool(bool pressed, uint32_t key)>;
@@ -169,10 +175,12 @@ namespace Mogwai
         void removeActiveGraph();
         void loadSceneDialog();
         void loadScene(std::filesystem::path path, SceneBuilder::Flags buildFlags = SceneBuilder::Flags::Default);
+        SceneBuilder::Flags getSceneBuildFlags(SceneBuilder::Flags buildFlags = SceneBuilder::Flags::Default) const;
         void unloadScene();
         void setScene(const ref<Scene>& pScene);
         ref<Scene> getScene() const;
         void executeActiveGraph(RenderContext* pRenderContext);
+        int runBatch();
         void beginFrame(RenderContext* pRenderContext, const ref<Fbo>& pTargetFbo);
         void endFrame(RenderContext* pRenderContext, const ref<Fbo>& pTargetFbo);
 
@@ -190,6 +198,7 @@ namespace Mogwai
 
         std::vector<GraphData> mGraphs;
         uint32_t mActiveGraph = 0;
+        RenderPassRefreshFlags mRefreshFlags = RenderPassRefreshFlags::None; ///< Refresh flags passed to the active graph on the next frame.
         ref<Sampler> mpSampler = nullptr;
         std::filesystem::path mScriptPath;
 
@@ -233,6 +233,10 @@ namespace Mogwai
                 << "Program kernels time (total): " << s.programKernelsTotalTime << " s" << std::endl
                 << "Program version time (max): " << s.programVersionMaxTime << " s" << std::endl
                 << "Program kernels time (max): " << s.programKernelsMaxTime << " s" << std::endl
+                << "Program cache hits/misses: " << s.programCacheHitCount << "/" << s.programCacheMissCount << std::endl
+                << "Program cache time saved: " << s.programCacheTimeSaved << " s" << std::endl
+                << "Program prewarm count: " << s.programPrewarmCount << std::endl
+                << "Program prewarm time: " << s.programPrewarmTime << " s" << std::endl
                 << "Total shader code-gen time: " << totalTime << " s" << std::endl
                 << "Downstream compilation time: " << downstreamTime << " s" << std::endl;
             g.text(oss.str());
@@ -46,6 +46,7 @@ namespace
 const char kShaderFile[] = "RenderPasses/AccumulatePass/Accumulate.cs.slang";
 
 const char kInputChannel[] = "input";
+const char kInputMask[] = "mask";
 const char kOutputChannel[] = "output";
 
 // Serialized parameters
@@ -117,6 +118,9 @@ RenderPassReflection AccumulatePass::reflect(const CompileData& compileData)
     const auto fmt = mOutputFormat != ResourceFormat::Unknown ? mOutputFormat : ResourceFormat::RGBA32Float;
 
     reflector.addInput(kInputChannel, "Input data to be temporally accumulated").bindFlags(ResourceBindFlags::ShaderResource);
+    reflector.addInput(kInputMask, "Mask of pixels to exclude from accumulation (nonzero = excluded, integer format)")
+        .bindFlags(ResourceBindFlags::ShaderResource)
+        .flags(RenderPassReflection::Field::Flags::Optional);
     reflector.addOutput(kOutputChannel, "Output data that is temporally accumulated")
         .bindFlags(ResourceBindFlags::RenderTarget | ResourceBindFlags::UnorderedAccess | ResourceBindFlags::ShaderResource)
         .format(fmt)
@@ -173,6 +177,7 @@ void AccumulatePass::execute(RenderContext* pRenderContext, const RenderData& re
     // Grab our input/output buffers.
     ref<Texture> pSrc = renderData.getTexture(kInputChannel);
     ref<Texture> pDst = renderData.getTexture(kOutputChannel);
+    ref<Texture> pMask = renderData.getTexture(kInputMask);
     FALCOR_ASSERT(pSrc && pDst);
 
     const uint2 resolution = uint2(pSrc->getWidth(), pSrc->getHeight());
@@ -208,7 +213,12 @@ void AccumulatePass::execute(RenderContext* pRenderContext, const RenderData& re
     }
     else if (resolutionMatch)
     {
-        accumulate(pRenderContext, pSrc, pDst);
+        if (pMask && (pMask->getWidth() != resolution.x || pMask->getHeight() != resolution.y || getFormatType(pMask->getFormat()) != FormatType::Uint))
+        {
+            logWarningOnce("AccumulatePass mask must be of unsigned integer format and match the input size. The mask will be ignored.");
+            pMask = nullptr;
+        }
+        accumulate(pRenderContext, pSrc, pDst, pMask);
     }
     else
     {
@@ -217,7 +227,53 @@ void AccumulatePass::execute(RenderContext* pRenderContext, const RenderData& re
     }
 }
 
-void AccumulatePass::accumulate(RenderContext* pRenderContext, const ref<Texture>& pSrc, const ref<Texture>& pDst)
+void AccumulatePass::collectProgramVersions(const RenderData& renderData, std::vector<ProgramVersionRequest>& requests)
+{
+    ref<Texture> pSrc = renderData.getTexture(kInputChannel);
+    if (!pSrc)
+        return;
+
+    // Create the programs for the input format without vars, so that the program of the current mode is compiled by the prewarm.
+    const FormatType srcType = getFormatType(pSrc->getFormat());
+    if (mpProgram.empty() || srcType != mSrcType)
+        createPrograms(srcType);
+    requests.push_back({mpProgram[mPrecisionMode]});
+}
+
+void AccumulatePass::createPrograms(FormatType srcType)
+{
+    DefineList defines;
+    switch (srcType)
+    {
+    case FormatType::Uint:
+        defines.add("_INPUT_FORMAT", "INPUT_FORMAT_UINT");
+        break;
+    case FormatType::Sint:
+        defines.add("_INPUT_FORMAT", "INPUT_FORMAT_SINT");
+        break;
+    default:
+        defines.add("_INPUT_FORMAT", "INPUT_FORMAT_FLOAT");
+        break;
+    }
+    // Create accumulation programs.
+    // Note only compensated summation needs precise floating-point mode.
+    mpProgram[Precision::Double] =
+        Program::createCompute(mpDevice, kShaderFile, "accumulateDouble", defines, SlangCompilerFlags::TreatWarningsAsErrors);
+    mpProgram[Precision::Single] =
+        Program::createCompute(mpDevice, kShaderFile, "accumulateSingle", defines, SlangCompilerFlags::TreatWarningsAsErrors);
+    mpProgram[Precision::SingleCompensated] = Program::createCompute(
+        mpDevice,
+        kShaderFile,
+        "accumulateSingleCompensated",
+        defines,
+        SlangCompilerFlags::FloatingPointModePrecise | SlangCompilerFlags::TreatWarningsAsErrors
+    );
+    mpVars = nullptr;
+
+    mSrcType = srcType;
+}
+
+void AccumulatePass::accumulate(RenderContext* pRenderContext, const ref<Texture>& pSrc, const ref<Texture>& pDst, const ref<Texture>& pMask)
 {
     FALCOR_ASSERT(pSrc && pDst);
     FALCOR_ASSERT(pSrc->getWidth() == mFrameDim.x && pSrc->getHeight() == mFrameDim.y);
@@ -226,40 +282,12 @@ void AccumulatePass::accumulate(RenderContext* pRenderContext, const ref<Texture
 
     // If for the first time, or if the input format type has changed, (re)compile the programs.
     if (mpProgram.empty() || srcType != mSrcType)
-    {
-        DefineList defines;
-        switch (srcType)
-        {
-        case FormatType::Uint:
-            defines.add("_INPUT_FORMAT", "INPUT_FORMAT_UINT");
-            break;
-        case FormatType::Sint:
-            defines.add("_INPUT_FORMAT", "INPUT_FORMAT_SINT");
-            break;
-        default:
-            defines.add("_INPUT_FORMAT", "INPUT_FORMAT_FLOAT");
-            break;
-        }
-        // Create accumulation programs.
-        // Note only compensated summation needs precise floating-point mode.
-        mpProgram[Precision::Double] =
-            Program::createCompute(mpDevice, kShaderFile, "accumulateDouble", defines, SlangCompilerFlags::TreatWarningsAsErrors);
-        mpProgram[Precision::Single] =
-            Program::createCompute(mpDevice, kShaderFile, "accumulateSingle", defines, SlangCompilerFlags::TreatWarningsAsErrors);
-        mpProgram[Precision::SingleCompensated] = Program::createCompute(
-            mpDevice,
-            kShaderFile,
-            "accumulateSingleCompensated",
-            defines,
-            SlangCompilerFlags::FloatingPointModePrecise | SlangCompilerFlags::TreatWarningsAsErrors
-        );
+        createPrograms(srcType);
+    if (!mpVars)
         mpVars = ProgramVars::create(mpDevice, mpProgram[mPrecisionMode]->getReflector());
 
-        mSrcType = srcType;
-    }
-
     // Setup accumulation.
-    prepareAccumulation(pRenderContext, mFrameDim.x, mFrameDim.y);
+    prepareAccumulation(pRenderContext, mFrameDim.x, mFrameDim.y, pMask != nullptr);
 
     // Set shader parameters.
     auto var = mpVars->getRootVar();
@@ -267,14 +295,17 @@ void AccumulatePass::accumulate(RenderContext* pRenderContext, const ref<Texture
     var["PerFrameCB"]["gAccumCount"] = mFrameCount;
     var["PerFrameCB"]["gAccumulate"] = mEnabled;
     var["PerFrameCB"]["gMovingAverageMode"] = (mMaxFrameCount > 0);
+    var["PerFrameCB"]["gUseMask"] = pMask != nullptr;
     var["gCurFrame"] = pSrc;
     var["gOutputFrame"] = pDst;
+    var["gMask"] = pMask; // Can be nullptr
 
     // Bind accumulation buffers. Some of these may be nullptr's.
     var["gLastFrameSum"] = mpLastFrameSum;
     var["gLastFrameCorr"] = mpLastFrameCorr;
     var["gLastFrameSumLo"] = mpLastFrameSumLo;
     var["gLastFrameSumHi"] = mpLastFrameSumHi;
+    var["gLastFrameCount"] = mpLastFrameCount;
 
     // Update the frame count.
     // The accumulation limit (mMaxFrameCount) has a special value of 0 (no limit) and is not supported in the SingleCompensated mode.
@@ -377,7 +408,7 @@ void AccumulatePass::reset()
     mFrameCount = 0;
 }
 
-void AccumulatePass::prepareAccumulation(RenderContext* pRenderContext, uint32_t width, uint32_t height)
+void AccumulatePass::prepareAccumulation(RenderContext* pRenderContext, uint32_t width, uint32_t height, bool useMask)
 {
     // Allocate/resize/clear buffers for intermedate data. These are different depending on accumulation mode.
     // Buffers that are not used in the current mode are released.
@@ -407,6 +438,8 @@ void AccumulatePass::prepareAccumulation(RenderContext* pRenderContext, uint32_t
         }
     };
 
+    // The per-pixel frame count is prepared first, as creating it resets accumulation and all buffers need to be cleared.
+    prepareBuffer(mpLastFrameCount, ResourceFormat::R32Uint, useMask);
     prepareBuffer(
         mpLastFrameSum, ResourceFormat::RGBA32Float, mPrecisionMode == Precision::Single || mPrecisionMode == Precision::SingleCompensated
     );
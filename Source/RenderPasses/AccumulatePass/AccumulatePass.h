@@ -41,6 +41,10 @@ using namespace Falcor;
  * For accumulating many samples for ground truth rendering etc., fp32 precision
  * is not always sufficient. The pass supports higher precision modes using
  * either error compensation (Kahan summation) or double precision math.
+ *
+ * An optional mask input excludes pixels from accumulation, e.g. pixels that
+ * have converged with adaptive sampling. The accumulated value of masked pixels
+ * is retained and the number of accumulated frames is tracked per pixel.
  */
 class AccumulatePass : public RenderPass
 {
@@ -54,6 +58,7 @@ public:
 
     virtual Properties getProperties() const override;
     virtual RenderPassReflection reflect(const CompileData& compileData) override;
+    virtual void collectProgramVersions(const RenderData& renderData, std::vector<ProgramVersionRequest>& requests) override;
     virtual void execute(RenderContext* pRenderContext, const RenderData& renderData) override;
     virtual void renderUI(Gui::Widgets& widget) override;
     virtual void setScene(RenderContext* pRenderContext, const ref<Scene>& pScene) override;
@@ -100,8 +105,9 @@ public:
     );
 
 protected:
-    void prepareAccumulation(RenderContext* pRenderContext, uint32_t width, uint32_t height);
-    void accumulate(RenderContext* pRenderContext, const ref<Texture>& pSrc, const ref<Texture>& pDst);
+    void createPrograms(FormatType srcType);
+    void prepareAccumulation(RenderContext* pRenderContext, uint32_t width, uint32_t height, bool useMask);
+    void accumulate(RenderContext* pRenderContext, const ref<Texture>& pSrc, const ref<Texture>& pDst, const ref<Texture>& pMask);
 
     // Internal state
 
@@ -128,6 +134,8 @@ protected:
     ref<Texture> mpLastFrameSumLo;
     /// Last frame running sum (hi bits). Used in Double mode.
     ref<Texture> mpLastFrameSumHi;
+    /// Per-pixel number of accumulated frames. Used when the mask input is connected.
+    ref<Texture> mpLastFrameCount;
 
     // UI variables
 
@@ -0,0 +1,369 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "AdaptiveSampling.h"
+#include "RenderGraph/RenderPassStandardFlags.h"
+#include "RenderPasses/PathTracer/Params.slang"
+
+static void regAdaptiveSampling(pybind11::module& m)
+{
+    pybind11::class_<AdaptiveSampling, RenderPass, ref<AdaptiveSampling>> pass(m, "AdaptiveSampling");
+    pass.def_property_readonly("converged", &AdaptiveSampling::isConverged);
+    pass.def_property_readonly("convergedFraction", &AdaptiveSampling::getConvergedFraction);
+    pass.def_property_readonly("frameCount", &AdaptiveSampling::getFrameCount);
+    pass.def("reset", &AdaptiveSampling::reset);
+}
+
+extern "C" FALCOR_API_EXPORT void registerPlugin(Falcor::PluginRegistry& registry)
+{
+    registry.registerClass<RenderPass, AdaptiveSampling>();
+    ScriptBindings::registerBinding(regAdaptiveSampling);
+}
+
+namespace
+{
+const char kShaderFile[] = "RenderPasses/AdaptiveSampling/AdaptiveSampling.cs.slang";
+
+const char kInputColor[] = "color";
+const char kOutputSampleCount[] = "sampleCount";
+const char kOutputConvergenceMask[] = "convergenceMask";
+const char kOutputError[] = "error";
+
+// Serialized parameters
+const char kEnabled[] = "enabled";
+const char kTargetError[] = "targetError";
+const char kMinFrameCount[] = "minFrameCount";
+const char kMinSamples[] = "minSamples";
+const char kMaxSamples[] = "maxSamples";
+const char kTileSize[] = "tileSize";
+const char kConvergedThreshold[] = "convergedThreshold";
+const char kMaxFrameCount[] = "maxFrameCount";
+const char kAutoReset[] = "autoReset";
+
+const uint32_t kMaxTileSize = 64;
+} // namespace
+
+AdaptiveSampling::AdaptiveSampling(ref<Device> pDevice, const Properties& props) : RenderPass(pDevice)
+{
+    for (const auto& [key, value] : props)
+    {
+        if (key == kEnabled)
+            mEnabled = value;
+        else if (key == kTargetError)
+            mTargetError = value;
+        else if (key == kMinFrameCount)
+            mMinFrameCount = value;
+        else if (key == kMinSamples)
+            mMinSamples = value;
+        else if (key == kMaxSamples)
+            mMaxSamples = value;
+        else if (key == kTileSize)
+            mTileSize = value;
+        else if (key == kConvergedThreshold)
+            mConvergedThreshold = value;
+        else if (key == kMaxFrameCount)
+            mMaxFrameCount = value;
+        else if (key == kAutoReset)
+            mAutoReset = value;
+        else
+            logWarning("Unknown property '{}' in AdaptiveSampling properties.", key);
+    }
+
+    if (mTargetError <= 0.f)
+        FALCOR_THROW("AdaptiveSampling: 'targetError' must be positive.");
+    mMinFrameCount = std::max(mMinFrameCount, 2u);
+    // The sample count map is consumed by the path tracer, which renders at most kMaxSamplesPerPixel samples per pixel and frame.
+    mMaxSamples = std::clamp(mMaxSamples, 1u, kMaxSamplesPerPixel);
+    mMinSamples = std::clamp(mMinSamples, 1u, mMaxSamples);
+    mTileSize = std::clamp(mTileSize, 1u, kMaxTileSize);
+
+    mpUpdateStatsPass = ComputePass::create(mpDevice, kShaderFile, "updateStats");
+    mpReduceTilesPass = ComputePass::create(mpDevice, kShaderFile, "reduceTiles");
+    mpSampleCountPass = ComputePass::create(mpDevice, kShaderFile, "computeSampleCount");
+    mpParallelReduction = std::make_unique<ParallelReduction>(mpDevice);
+}
+
+Properties AdaptiveSampling::getProperties() const
+{
+    Properties props;
+    props[kEnabled] = mEnabled;
+    props[kTargetError] = mTargetError;
+    props[kMinFrameCount] = mMinFrameCount;
+    props[kMinSamples] = mMinSamples;
+    props[kMaxSamples] = mMaxSamples;
+    props[kTileSize] = mTileSize;
+    props[kConvergedThreshold] = mConvergedThreshold;
+    props[kMaxFrameCount] = mMaxFrameCount;
+    props[kAutoReset] = mAutoReset;
+    return props;
+}
+
+RenderPassReflection AdaptiveSampling::reflect(const CompileData& compileData)
+{
+    RenderPassReflection reflector;
+    reflector.addInput(kInputColor, "Color of the current frame").bindFlags(ResourceBindFlags::ShaderResource);
+    reflector.addOutput(kOutputSampleCount, "Sample count for the next frame").format(ResourceFormat::R8Uint);
+    reflector.addOutput(kOutputConvergenceMask, "Convergence mask (1 = converged)").format(ResourceFormat::R8Uint);
+    reflector.addOutput(kOutputError, "Relative error estimate").format(ResourceFormat::R32Float);
+    return reflector;
+}
+
+void AdaptiveSampling::execute(RenderContext* pRenderContext, const RenderData& renderData)
+{
+    auto& dict = renderData.getDictionary();
+
+    if (mAutoReset)
+    {
+        // Reset upon refresh flags and scene changes, except camera jitter and history changes.
+        auto refreshFlags = dict.getValue(kRenderPassRefreshFlags, RenderPassRefreshFlags::None);
+        if (refreshFlags != RenderPassRefreshFlags::None)
+            reset();
+
+        if (mpScene)
+        {
+            auto sceneUpdates = mpScene->getUpdates();
+            if ((sceneUpdates & ~IScene::UpdateFlags::CameraPropertiesChanged) != IScene::UpdateFlags::None)
+                reset();
+            if (is_set(sceneUpdates, IScene::UpdateFlags::CameraPropertiesChanged))
+            {
+                auto excluded = Camera::Changes::Jitter | Camera::Changes::History;
+                if ((mpScene->getCamera()->getChanges() & ~excluded) != Camera::Changes::None)
+                    reset();
+            }
+        }
+    }
+
+    ref<Texture> pColor = renderData.getTexture(kInputColor);
+    FALCOR_ASSERT(pColor);
+
+    const uint2 frameDim = uint2(pColor->getWidth(), pColor->getHeight());
+    if (any(frameDim != mFrameDim))
+    {
+        mFrameDim = frameDim;
+        reset();
+    }
+
+    if (!mEnabled)
+    {
+        // Let the path tracer fall back to its fixed sample count.
+        dict[kRenderPassAdaptiveSampleCount] = ref<Texture>();
+        mSampleCountPublished = false;
+
+        for (const char* output : {kOutputSampleCount, kOutputConvergenceMask, kOutputError})
+        {
+            if (auto pDst = renderData.getTexture(output))
+                pRenderContext->clearUAV(pDst->getUAV().get(), uint4(0));
+        }
+        return;
+    }
+
+    FALCOR_PROFILE(pRenderContext, "AdaptiveSampling");
+
+    readbackConvergedCount();
+    prepareResources(pRenderContext, frameDim);
+
+    const uint2 tileCount = div_round_up(frameDim, uint2(mTileSize));
+    const bool useTiles = mTileSize > 1;
+
+    auto bindShaderData = [&](const ref<ComputePass>& pPass)
+    {
+        auto var = pPass->getRootVar();
+        var["CB"]["gFrameDim"] = frameDim;
+        var["CB"]["gTileCount"] = tileCount;
+        var["CB"]["gTileSize"] = mTileSize;
+        var["CB"]["gUseTiles"] = useTiles;
+        var["CB"]["gHasSampleCount"] = mSampleCountPublished;
+        var["CB"]["gTargetError"] = mTargetError;
+        var["CB"]["gMinFrameCount"] = mMinFrameCount;
+        var["CB"]["gMinSamples"] = mMinSamples;
+        var["CB"]["gMaxSamples"] = mMaxSamples;
+        var["gColor"] = pColor;
+        var["gStats"] = mpStats;
+        var["gError"] = mpError;
+        var["gTileError"] = mpTileError; // Can be nullptr
+        var["gSampleCount"] = mpSampleCount;
+        var["gConvergenceMask"] = mpConvergenceMask;
+    };
+
+    // Update the statistics with the current frame, which was rendered with the sample count computed in the last frame.
+    bindShaderData(mpUpdateStatsPass);
+    mpUpdateStatsPass->execute(pRenderContext, uint3(frameDim, 1));
+    mFrameCount++;
+
+    if (useTiles)
+    {
+        bindShaderData(mpReduceTilesPass);
+        mpReduceTilesPass->execute(pRenderContext, uint3(tileCount, 1));
+    }
+
+    // Compute the sample count for the next frame and publish it to the path tracer.
+    bindShaderData(mpSampleCountPass);
+    mpSampleCountPass->execute(pRenderContext, uint3(frameDim, 1));
+
+    dict[kRenderPassAdaptiveSampleCount] = mpSampleCount;
+    mSampleCountPublished = true;
+
+    // Count the converged pixels. The result is read back in a later frame to avoid a GPU flush.
+    if (!mWaitingForData)
+    {
+        mpParallelReduction->execute<uint4>(pRenderContext, mpConvergenceMask, ParallelReduction::Type::Sum, nullptr, mpReductionResult);
+        pRenderContext->submit(false);
+        mReadbackFenceValue = pRenderContext->signal(mpFence.get());
+        mWaitingForData = true;
+    }
+
+    // Copy the internal data to the connected outputs.
+    auto copyOutput = [&](const char* output, const ref<Texture>& pSrc)
+    {
+        auto pDst = renderData.getTexture(output);
+        if (!pDst)
+            return;
+        if (pDst->getWidth() == frameDim.x && pDst->getHeight() == frameDim.y)
+            pRenderContext->copyResource(pDst.get(), pSrc.get());
+        else
+            logWarningOnce("AdaptiveSampling: Output '{}' does not match the input size. The output will not be written.", output);
+    };
+    copyOutput(kOutputSampleCount, mpSampleCount);
+    copyOutput(kOutputConvergenceMask, mpConvergenceMask);
+    copyOutput(kOutputError, mpError);
+}
+
+void AdaptiveSampling::renderUI(Gui::Widgets& widget)
+{
+    bool dirty = false;
+
+    dirty |= widget.checkbox("Enabled", mEnabled);
+    if (!mEnabled)
+    {
+        if (dirty)
+            reset();
+        return;
+    }
+
+    if (widget.button("Reset", true))
+        reset();
+
+    widget.checkbox("Auto Reset", mAutoReset);
+    widget.tooltip("Reset the statistics automatically upon scene changes and refresh flags.");
+
+    dirty |= widget.var("Target error", mTargetError, 1e-4f, 1.f, 1e-3f);
+    widget.tooltip("Relative error (standard deviation of the pixel estimate divided by its mean) at which a pixel is converged.");
+
+    dirty |= widget.var("Min frames", mMinFrameCount, 2u, 1024u);
+    widget.tooltip("Minimum number of frames before a pixel can be considered converged.");
+
+    dirty |= widget.var("Min samples", mMinSamples, 1u, mMaxSamples);
+    widget.tooltip("Minimum number of samples per frame for pixels that are not converged.");
+
+    dirty |= widget.var("Max samples", mMaxSamples, mMinSamples, kMaxSamplesPerPixel);
+    widget.tooltip("Maximum number of samples per frame.");
+
+    dirty |= widget.var("Tile size", mTileSize, 1u, kMaxTileSize);
+    widget.tooltip("Size of the screen tiles in pixels. The tiles converge when the maximum error over all pixels in the tile is below the target error. Use 1 for per-pixel convergence.");
+
+    if (dirty)
+        reset();
+
+    widget.var("Converged threshold", mConvergedThreshold, 0.f, 1.f, 1e-3f);
+    widget.tooltip("Fraction of converged pixels at which rendering is considered converged.");
+
+    widget.var("Max frames", mMaxFrameCount, 0u);
+    widget.tooltip("Maximum number of frames after which rendering is considered converged. 0 means no limit.");
+
+    widget.text(fmt::format("Frames: {}", mFrameCount));
+    widget.text(fmt::format("Converged pixels: {:.2f}%", mConvergedFraction * 100.f));
+    widget.text(isConverged() ? "Converged" : "Not converged");
+}
+
+void AdaptiveSampling::setScene(RenderContext* pRenderContext, const ref<Scene>& pScene)
+{
+    mpScene = pScene;
+    reset();
+}
+
+void AdaptiveSampling::reset()
+{
+    mFrameCount = 0;
+    mConvergedFraction = 0.f;
+    // Discard a readback in flight, it refers to the statistics before the reset.
+    mWaitingForData = false;
+}
+
+bool AdaptiveSampling::isConverged() const
+{
+    if (!mEnabled || mFrameCount < mMinFrameCount)
+        return false;
+    if (mMaxFrameCount > 0 && mFrameCount >= mMaxFrameCount)
+        return true;
+    return mConvergedFraction >= mConvergedThreshold;
+}
+
+void AdaptiveSampling::prepareResources(RenderContext* pRenderContext, const uint2 frameDim)
+{
+    auto prepareTexture = [&](ref<Texture>& pTex, uint2 dim, ResourceFormat format)
+    {
+        if (!pTex || pTex->getWidth() != dim.x || pTex->getHeight() != dim.y)
+        {
+            pTex = mpDevice->createTexture2D(
+                dim.x, dim.y, format, 1, 1, nullptr, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess
+            );
+        }
+    };
+
+    prepareTexture(mpStats, frameDim, ResourceFormat::RGBA32Float);
+    prepareTexture(mpError, frameDim, ResourceFormat::R32Float);
+    prepareTexture(mpSampleCount, frameDim, ResourceFormat::R8Uint);
+    prepareTexture(mpConvergenceMask, frameDim, ResourceFormat::R8Uint);
+
+    if (mTileSize > 1)
+        prepareTexture(mpTileError, div_round_up(frameDim, uint2(mTileSize)), ResourceFormat::R32Float);
+    else
+        mpTileError = nullptr;
+
+    if (!mpReductionResult)
+        mpReductionResult = mpDevice->createBuffer(sizeof(uint4), ResourceBindFlags::None, MemoryType::ReadBack);
+    if (!mpFence)
+        mpFence = mpDevice->createFence();
+
+    // Clear the statistics after a reset.
+    if (mFrameCount == 0)
+        pRenderContext->clearUAV(mpStats->getUAV().get(), float4(0.f));
+}
+
+void AdaptiveSampling::readbackConvergedCount()
+{
+    // Poll the fence so that rendering never waits for the readback.
+    if (!mWaitingForData || mpFence->getCurrentValue() < mReadbackFenceValue)
+        return;
+
+    const uint4* result = static_cast<const uint4*>(mpReductionResult->map());
+    FALCOR_ASSERT(result);
+    mConvergedFraction = (float)result->x / ((float)mFrameDim.x * mFrameDim.y);
+    mpReductionResult->unmap();
+
+    mWaitingForData = false;
+}
@@ -0,0 +1,139 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Falcor.h"
+#include "RenderGraph/RenderPass.h"
+#include "Utils/Algorithm/ParallelReduction.h"
+
+using namespace Falcor;
+
+/**
+ * Variance-driven adaptive sampling.
+ *
+ * The pass takes the per-frame output of a path tracer as input and tracks the running mean
+ * and variance of the luminance of each pixel using Welford's algorithm. Each frame is weighted
+ * by the number of samples it was rendered with. From these statistics, the relative error of
+ * the pixel estimate is computed, optionally as the maximum over screen tiles.
+ *
+ * Based on the error, the pass computes the sample count for the next frame. Pixels whose error
+ * is below the target error are considered converged and receive no more samples. The sample
+ * count map is passed to the path tracer via the render pass dictionary (kRenderPassAdaptiveSampleCount),
+ * as the path tracer output depends on it and it can therefore not be connected as a graph edge.
+ * The convergence mask output can be connected to the AccumulatePass 'mask' input to stop
+ * accumulating converged pixels.
+ *
+ * The fraction of converged pixels is read back asynchronously. Scripts can query 'converged'
+ * to finish rendering once the convergence criterion is met.
+ */
+class AdaptiveSampling : public RenderPass
+{
+public:
+    FALCOR_PLUGIN_CLASS(AdaptiveSampling, "AdaptiveSampling", "Variance-driven adaptive sampling.");
+
+    static ref<AdaptiveSampling> create(ref<Device> pDevice, const Properties& props) { return make_ref<AdaptiveSampling>(pDevice, props); }
+
+    AdaptiveSampling(ref<Device> pDevice, const Properties& props);
+
+    virtual Properties getProperties() const override;
+    virtual RenderPassReflection reflect(const CompileData& compileData) override;
+    virtual void execute(RenderContext* pRenderContext, const RenderData& renderData) override;
+    virtual void renderUI(Gui::Widgets& widget) override;
+    virtual void setScene(RenderContext* pRenderContext, const ref<Scene>& pScene) override;
+
+    // Scripting functions
+    void reset();
+    bool isConverged() const;
+    float getConvergedFraction() const { return mConvergedFraction; }
+    uint32_t getFrameCount() const { return mFrameCount; }
+
+private:
+    void prepareResources(RenderContext* pRenderContext, const uint2 frameDim);
+    void readbackConvergedCount();
+
+    /// Compute pass updating the per-pixel statistics.
+    ref<ComputePass> mpUpdateStatsPass;
+    /// Compute pass computing the per-tile error.
+    ref<ComputePass> mpReduceTilesPass;
+    /// Compute pass computing the sample count and convergence mask.
+    ref<ComputePass> mpSampleCountPass;
+    /// Helper for counting the converged pixels.
+    std::unique_ptr<ParallelReduction> mpParallelReduction;
+
+    /// The current scene (or nullptr if no scene).
+    ref<Scene> mpScene;
+
+    /// Per-pixel statistics (mean, M2, total sample count, frame count).
+    ref<Texture> mpStats;
+    /// Per-pixel relative error.
+    ref<Texture> mpError;
+    /// Per-tile relative error.
+    ref<Texture> mpTileError;
+    /// Per-pixel sample count. Holds the sample count of the current frame until it is updated for the next frame.
+    ref<Texture> mpSampleCount;
+    /// Per-pixel convergence mask (1 = converged).
+    ref<Texture> mpConvergenceMask;
+
+    /// Readback buffer for the number of converged pixels.
+    ref<Buffer> mpReductionResult;
+    /// GPU fence for synchronizing readback.
+    ref<Fence> mpFence;
+    /// Fence value to wait for before the readback buffer can be accessed.
+    uint64_t mReadbackFenceValue = 0;
+    /// True if a readback is in flight.
+    bool mWaitingForData = false;
+
+    /// Current frame dimension in pixels.
+    uint2 mFrameDim = {0, 0};
+    /// Number of frames since the last reset.
+    uint32_t mFrameCount = 0;
+    /// True if the sample count map was published for the current frame.
+    bool mSampleCountPublished = false;
+    /// Fraction of converged pixels as of the last readback.
+    float mConvergedFraction = 0.f;
+
+    // Configuration
+
+    /// True if adaptive sampling is enabled. Otherwise the path tracer uses its fixed sample count.
+    bool mEnabled = true;
+    /// Target relative error.
+    float mTargetError = 0.01f;
+    /// Minimum number of frames before a pixel can be considered converged.
+    uint32_t mMinFrameCount = 4;
+    /// Minimum number of samples per frame for pixels that are not converged.
+    uint32_t mMinSamples = 1;
+    /// Maximum number of samples per frame.
+    uint32_t mMaxSamples = 4;
+    /// Tile size in pixels over which the error is reduced. 1 means per-pixel error.
+    uint32_t mTileSize = 1;
+    /// Fraction of converged pixels at which rendering is considered converged.
+    float mConvergedThreshold = 0.999f;
+    /// Maximum number of frames before rendering is considered converged. 0 means no limit.
+    uint32_t mMaxFrameCount = 0;
+    /// Reset statistics automatically upon scene changes and refresh flags.
+    bool mAutoReset = true;
+};
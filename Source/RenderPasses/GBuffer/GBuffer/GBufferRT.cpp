@@ -92,6 +92,27 @@ RenderPassReflection GBufferRT::reflect(const CompileData& compileData)
     return reflector;
 }
 
+void GBufferRT::collectProgramVersions(const RenderData& renderData, std::vector<ProgramVersionRequest>& requests)
+{
+    if (mpScene == nullptr)
+        return;
+
+    // Create the program without vars, so that it is not compiled until the version is prewarmed.
+    mComputeDOF = mUseDOF && mpScene->getCamera()->getApertureRadius() > 0.f;
+    if (mUseTraceRayInline)
+    {
+        if (!mpComputePass)
+            createComputePass(renderData);
+        requests.push_back({mpComputePass->getProgram(), getShaderDefines(renderData)});
+    }
+    else
+    {
+        if (!mRaytrace.pProgram)
+            createRaytraceProgram(renderData);
+        requests.push_back({mRaytrace.pProgram, getShaderDefines(renderData)});
+    }
+}
+
 void GBufferRT::execute(RenderContext* pRenderContext, const RenderData& renderData)
 {
     GBuffer::execute(pRenderContext, renderData);
@@ -216,63 +237,88 @@ void GBufferRT::parseProperties(const Properties& props)
 void GBufferRT::recreatePrograms()
 {
     mRaytrace.pProgram = nullptr;
+    mRaytrace.pBindingTable = nullptr;
     mRaytrace.pVars = nullptr;
     mpComputePass = nullptr;
 }
 
+void GBufferRT::createRaytraceProgram(const RenderData& renderData)
+{
+    DefineList defines;
+    defines.add(mpScene->getSceneDefines());
+    defines.add(mpSampleGenerator->getDefines());
+    defines.add(getShaderDefines(renderData));
+
+    // Create ray tracing program.
+    ProgramDesc desc;
+    desc.addShaderModules(mpScene->getShaderModules());
+    desc.addShaderLibrary(kProgramRaytraceFile);
+    desc.addTypeConformances(mpScene->getTypeConformances());
+    desc.setMaxPayloadSize(kMaxPayloadSizeBytes);
+    desc.setMaxAttributeSize(mpScene->getRaytracingMaxAttributeSize());
+    desc.setMaxTraceRecursionDepth(kMaxRecursionDepth);
+
+    ref<RtBindingTable> sbt = RtBindingTable::create(1, 1, mpScene->getGeometryCount());
+    sbt->setRayGen(desc.addRayGen("rayGen"));
+    sbt->setMiss(0, desc.addMiss("miss"));
+    sbt->setHitGroup(0, mpScene->getGeometryIDs(Scene::GeometryType::TriangleMesh), desc.addHitGroup("closestHit", "anyHit"));
+
+    // Add hit group with intersection shader for displaced meshes.
+    if (mpScene->hasGeometryType(Scene::GeometryType::DisplacedTriangleMesh))
+    {
+        sbt->setHitGroup(
+            0,
+            mpScene->getGeometryIDs(Scene::GeometryType::DisplacedTriangleMesh),
+            desc.addHitGroup("displacedTriangleMeshClosestHit", "", "displacedTriangleMeshIntersection")
+        );
+    }
+
+    // Add hit group with intersection shader for curves (represented as linear swept spheres).
+    if (mpScene->hasGeometryType(Scene::GeometryType::Curve))
+    {
+        sbt->setHitGroup(
+            0, mpScene->getGeometryIDs(Scene::GeometryType::Curve), desc.addHitGroup("curveClosestHit", "", "curveIntersection")
+        );
+    }
+
+    // Add hit group with intersection shader for SDF grids.
+    if (mpScene->hasGeometryType(Scene::GeometryType::SDFGrid))
+    {
+        sbt->setHitGroup(
+            0, mpScene->getGeometryIDs(Scene::GeometryType::SDFGrid), desc.addHitGroup("sdfGridClosestHit", "", "sdfGridIntersection")
+        );
+    }
+
+    // Add hit groups for for other procedural primitives here.
+
+    mRaytrace.pProgram = Program::create(mpDevice, desc, defines);
+    mRaytrace.pBindingTable = sbt;
+    mRaytrace.pVars = nullptr;
+}
+
+void GBufferRT::createComputePass(const RenderData& renderData)
+{
+    ProgramDesc desc;
+    desc.addShaderModules(mpScene->getShaderModules());
+    desc.addShaderLibrary(kProgramComputeFile).csEntry("main");
+    desc.addTypeConformances(mpScene->getTypeConformances());
+
+    DefineList defines;
+    defines.add(mpScene->getSceneDefines());
+    defines.add(mpSampleGenerator->getDefines());
+    defines.add(getShaderDefines(renderData));
+
+    mpComputePass = ComputePass::create(mpDevice, desc, defines, false);
+}
+
 void GBufferRT::executeRaytrace(RenderContext* pRenderContext, const RenderData& renderData)
 {
-    if (!mRaytrace.pProgram || !mRaytrace.pVars)
+    if (!mRaytrace.pProgram)
+        createRaytraceProgram(renderData);
+
+    if (!mRaytrace.pVars)
     {
-        DefineList defines;
-        defines.add(mpScene->getSceneDefines());
-        defines.add(mpSampleGenerator->getDefines());
-        defines.add(getShaderDefines(renderData));
-
-        // Create ray tracing program.
-        ProgramDesc desc;
-        desc.addShaderModules(mpScene->getShaderModules());
-        desc.addShaderLibrary(kProgramRaytraceFile);
-        desc.addTypeConformances(mpScene->getTypeConformances());
-        desc.setMaxPayloadSize(kMaxPayloadSizeBytes);
-        desc.setMaxAttributeSize(mpScene->getRaytracingMaxAttributeSize());
-        desc.setMaxTraceRecursionDepth(kMaxRecursionDepth);
-
-        ref<RtBindingTable> sbt = RtBindingTable::create(1, 1, mpScene->getGeometryCount());
-        sbt->setRayGen(desc.addRayGen("rayGen"));
-        sbt->setMiss(0, desc.addMiss("miss"));
-        sbt->setHitGroup(0, mpScene->getGeometryIDs(Scene::GeometryType::TriangleMesh), desc.addHitGroup("closestHit", "anyHit"));
-
-        // Add hit group with intersection shader for displaced meshes.
-        if (mpScene->hasGeometryType(Scene::GeometryType::DisplacedTriangleMesh))
-        {
-            sbt->setHitGroup(
-                0,
-                mpScene->getGeometryIDs(Scene::GeometryType::DisplacedTriangleMesh),
-                desc.addHitGroup("displacedTriangleMeshClosestHit", "", "displacedTriangleMeshIntersection")
-            );
-        }
-
-        // Add hit group with intersection shader for curves (represented as linear swept spheres).
-        if (mpScene->hasGeometryType(Scene::GeometryType::Curve))
-        {
-            sbt->setHitGroup(
-                0, mpScene->getGeometryIDs(Scene::GeometryType::Curve), desc.addHitGroup("curveClosestHit", "", "curveIntersection")
-            );
-        }
-
-        // Add hit group with intersection shader for SDF grids.
-        if (mpScene->hasGeometryType(Scene::GeometryType::SDFGrid))
-        {
-            sbt->setHitGroup(
-                0, mpScene->getGeometryIDs(Scene::GeometryType::SDFGrid), desc.addHitGroup("sdfGridClosestHit", "", "sdfGridIntersection")
-            );
-        }
-
-        // Add hit groups for for other procedural primitives here.
-
-        mRaytrace.pProgram = Program::create(mpDevice, desc, defines);
-        mRaytrace.pVars = RtProgramVars::create(mpDevice, mRaytrace.pProgram, sbt);
+        mRaytrace.pVars = RtProgramVars::create(mpDevice, mRaytrace.pProgram, mRaytrace.pBindingTable);
 
         // Bind static resources.
         ShaderVar var = mRaytrace.pVars->getRootVar();
@@ -292,18 +338,11 @@ void GBufferRT::executeCompute(RenderContext* pRenderContext, const RenderData&
 {
     // Create compute pass.
     if (!mpComputePass)
-    {
-        ProgramDesc desc;
-        desc.addShaderModules(mpScene->getShaderModules());
-        desc.addShaderLibrary(kProgramComputeFile).csEntry("main");
-        desc.addTypeConformances(mpScene->getTypeConformances());
+        createComputePass(renderData);
 
-        DefineList defines;
-        defines.add(mpScene->getSceneDefines());
-        defines.add(mpSampleGenerator->getDefines());
-        defines.add(getShaderDefines(renderData));
-
-        mpComputePass = ComputePass::create(mpDevice, desc, defines, true);
+    if (!mpComputePass->hasVars())
+    {
+        mpComputePass->setVars(nullptr);
 
         // Bind static resources
         ShaderVar var = mpComputePass->getRootVar();
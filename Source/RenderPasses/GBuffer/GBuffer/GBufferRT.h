@@ -46,6 +46,7 @@ public:
     GBufferRT(ref<Device> pDevice, const Properties& props);
 
     RenderPassReflection reflect(const CompileData& compileData) override;
+    void collectProgramVersions(const RenderData& renderData, std::vector<ProgramVersionRequest>& requests) override;
     void execute(RenderContext* pRenderContext, const RenderData& renderData) override;
     void renderUI(Gui::Widgets& widget) override;
     Properties getProperties() const override;
@@ -54,6 +55,8 @@ public:
 private:
     void parseProperties(const Properties& props) override;
 
+    void createRaytraceProgram(const RenderData& renderData);
+    void createComputePass(const RenderData& renderData);
     void executeRaytrace(RenderContext* pRenderContext, const RenderData& renderData);
     void executeCompute(RenderContext* pRenderContext, const RenderData& renderData);
 
@@ -78,6 +81,7 @@ private:
     struct
     {
         ref<Program> pProgram;
+        ref<RtBindingTable> pBindingTable;
         ref<RtProgramVars> pVars;
     } mRaytrace;
 
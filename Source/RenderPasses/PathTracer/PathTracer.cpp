@@ -37,6 +37,7 @@ namespace
     const std::string kTracePassFilename = "RenderPasses/PathTracer/TracePass.rt.slang";
     const std::string kResolvePassFilename = "RenderPasses/PathTracer/ResolvePass.cs.slang";
     const std::string kReflectTypesFile = "RenderPasses/PathTracer/ReflectTypes.cs.slang";
+    const std::string kWavefrontPassFilename = "RenderPasses/PathTracer/WavefrontPass.cs.slang";
 
     // Render pass inputs and outputs.
     const std::string kInputVBuffer = "vbuffer";
@@ -142,10 +143,25 @@ namespace
     const std::string kUseNRDDemodulation = "useNRDDemodulation";
 
     const std::string kUseSER = "useSER";
+    const std::string kUseWavefront = "useWavefront";
+    const std::string kTileSize = "tileSize";
 
     const std::string kOutputSize = "outputSize";
     const std::string kFixedOutputSize = "fixedOutputSize";
     const std::string kColorFormat = "colorFormat";
+
+    const uint32_t kMaxSampleBatchCount = 4096; ///< Maximum number of sample batches per frame.
+
+    // Wavefront path state buffers, allocated from the reflected types.
+    const std::string kWavefrontPathBuffers[] =
+    {
+        "pathOrigin", "pathDir", "pathNormal", "pathThp", "pathRadiance", "pathHit",
+        "pathGuideData", "pathInteriorList", "pathSampleGenerator", "pathStatus", "shadowRay", "shadowContribution",
+    };
+    const std::string kWavefrontQueueKeys = "queueKeys";
+    const std::string kWavefrontQueueValues = "queueValues";
+    const std::string kWavefrontExtendQueue = "extendQueue";
+    const uint32_t kMaxWavefrontGroupCount = 65535; ///< Maximum number of thread groups of the indirect dispatches over the wavefront queues.
 }
 
 extern "C" FALCOR_API_EXPORT void registerPlugin(Falcor::PluginRegistry& registry)
@@ -248,6 +264,8 @@ void PathTracer::parseProperties(const Properties& props)
 
         // Scheduling parameters
         else if (key == kUseSER) mStaticParams.useSER = value;
+        else if (key == kUseWavefront) mStaticParams.useWavefront = value;
+        else if (key == kTileSize) mTileSize = value;
 
         // Output parameters
         else if (key == kOutputSize) mOutputSizeSelection = value;
@@ -291,10 +309,20 @@ void PathTracer::validateOptions()
     }
 
     // Static parameters.
-    if (mStaticParams.samplesPerPixel < 1 || mStaticParams.samplesPerPixel > kMaxSamplesPerPixel)
+    const uint32_t maxSamplesPerPixel = kMaxSamplesPerPixel * kMaxSampleBatchCount;
+    if (mStaticParams.samplesPerPixel < 1 || mStaticParams.samplesPerPixel > maxSamplesPerPixel)
     {
-        logWarning("'samplesPerPixel' must be in the range [1, {}]. Clamping to this range.", kMaxSamplesPerPixel);
-        mStaticParams.samplesPerPixel = std::clamp(mStaticParams.samplesPerPixel, 1u, kMaxSamplesPerPixel);
+        logWarning("'samplesPerPixel' must be in the range [1, {}]. Clamping to this range.", maxSamplesPerPixel);
+        mStaticParams.samplesPerPixel = std::clamp(mStaticParams.samplesPerPixel, 1u, maxSamplesPerPixel);
+    }
+
+    // Sample counts above kMaxSamplesPerPixel are rendered in multiple batches with the same sample count.
+    const uint32_t batchCount = mStaticParams.getSampleBatchCount();
+    if (mStaticParams.samplesPerPixel % batchCount != 0)
+    {
+        uint32_t samplesPerPixel = div_round_up(mStaticParams.samplesPerPixel, batchCount) * batchCount;
+        logWarning("'samplesPerPixel' is rendered in {} sample batches of equal size. Rounding up to {}.", batchCount, samplesPerPixel);
+        mStaticParams.samplesPerPixel = samplesPerPixel;
     }
 
     auto clampBounces = [] (uint32_t& bounces, const std::string& name)
@@ -326,6 +354,13 @@ void PathTracer::validateOptions()
         logWarning("Shader Execution Reordering (SER) is not supported on this device. Disabling SER.");
         mStaticParams.useSER = false;
     }
+
+    // RTXDI needs the surface data of the full frame before tracing paths.
+    if (mStaticParams.useRTXDI && any(mTileSize != uint2(0)))
+    {
+        logWarning("Tiled rendering is not supported with RTXDI. Disabling tiling.");
+        mTileSize = uint2(0);
+    }
 }
 
 Properties PathTracer::getProperties() const
@@ -373,6 +408,8 @@ Properties PathTracer::getProperties() const
 
     // Scheduling parameters
     props[kUseSER] = mStaticParams.useSER;
+    props[kUseWavefront] = mStaticParams.useWavefront;
+    if (any(mTileSize != uint2(0))) props[kTileSize] = mTileSize;
 
     // Output parameters
     props[kOutputSize] = mOutputSizeSelection;
@@ -395,7 +432,7 @@ RenderPassReflection PathTracer::reflect(const CompileData& compileData)
 void PathTracer::setFrameDim(const uint2 frameDim)
 {
     auto prevFrameDim = mParams.frameDim;
-    auto prevScreenTiles = mParams.screenTiles;
+    auto prevRenderTileDim = mRenderTileDim;
 
     mParams.frameDim = frameDim;
     if (mParams.frameDim.x > kMaxFrameDimension || mParams.frameDim.y > kMaxFrameDimension)
@@ -403,17 +440,29 @@ void PathTracer::setFrameDim(const uint2 frameDim)
         FALCOR_THROW("Frame dimensions up to {} pixels width/height are supported.", kMaxFrameDimension);
     }
 
+    // Determine the render tile dimension. The frame is not split along axes where the tile size is zero.
+    mRenderTileDim.x = mTileSize.x > 0 ? std::min(mTileSize.x, frameDim.x) : frameDim.x;
+    mRenderTileDim.y = mTileSize.y > 0 ? std::min(mTileSize.y, frameDim.y) : frameDim.y;
+
     // Tile dimensions have to be powers-of-two.
     FALCOR_ASSERT(isPowerOf2(kScreenTileDim.x) && isPowerOf2(kScreenTileDim.y));
     FALCOR_ASSERT(kScreenTileDim.x == (1 << kScreenTileBits.x) && kScreenTileDim.y == (1 << kScreenTileBits.y));
-    mParams.screenTiles = div_round_up(mParams.frameDim, kScreenTileDim);
+    setRenderTile(uint2(0));
 
-    if (any(mParams.frameDim != prevFrameDim) || any(mParams.screenTiles != prevScreenTiles))
+    if (any(mParams.frameDim != prevFrameDim) || any(mRenderTileDim != prevRenderTileDim))
     {
         mVarsChanged = true;
     }
 }
 
+void PathTracer::setRenderTile(const uint2 tileOffset)
+{
+    FALCOR_ASSERT(all(tileOffset < mParams.frameDim) || any(mParams.frameDim == uint2(0)));
+    mParams.renderTileOffset = tileOffset;
+    mParams.renderTileDim = min(mRenderTileDim, mParams.frameDim - tileOffset);
+    mParams.screenTiles = div_round_up(mParams.renderTileDim, kScreenTileDim);
+}
+
 void PathTracer::setScene(RenderContext* pRenderContext, const ref<Scene>& pScene)
 {
     mUpdateFlagsConnection = {};
@@ -423,6 +472,9 @@ void PathTracer::setScene(RenderContext* pRenderContext, const ref<Scene>& pScen
     mParams.frameCount = 0;
     mParams.frameDim = {};
     mParams.screenTiles = {};
+    mParams.renderTileOffset = {};
+    mParams.renderTileDim = {};
+    mRenderTileDim = {};
 
     // Need to recreate the RTXDI module when the scene changes.
     mpRTXDI = nullptr;
@@ -449,7 +501,7 @@ void PathTracer::execute(RenderContext* pRenderContext, const RenderData& render
     if (!beginFrame(pRenderContext, renderData)) return;
 
     // Update shader program specialization.
-    updatePrograms();
+    updatePrograms(renderData);
 
     // Prepare resources.
     prepareResources(pRenderContext, renderData);
@@ -458,19 +510,57 @@ void PathTracer::execute(RenderContext* pRenderContext, const RenderData& render
     // This should be called after all resources have been created.
     preparePathTracer(renderData);
 
+    // Render the frame in render tiles. The per-sample buffers hold the samples of a single render tile,
+    // so the memory usage is proportional to the tile size rather than the frame size.
+    // Each render tile is rendered in one or more sample batches that are accumulated by the resolve pass.
+    const uint32_t frameSeed = mParams.seed;
+    const uint32_t batchCount = mFixedSampleCount ? mStaticParams.getSampleBatchCount() : 1;
+    const uint2 tileCount = div_round_up(mParams.frameDim, mRenderTileDim);
+
+    for (uint32_t tileY = 0; tileY < tileCount.y; tileY++)
+    {
+        for (uint32_t tileX = 0; tileX < tileCount.x; tileX++)
+        {
+            setRenderTile(uint2(tileX, tileY) * mRenderTileDim);
+
+            for (uint32_t batch = 0; batch < batchCount; batch++)
+            {
+                // Use a unique seed for each sample batch.
+                mParams.sampleBatch = batch;
+                mParams.seed = frameSeed * batchCount + batch;
+                renderSampleBatch(pRenderContext, renderData);
+            }
+        }
+    }
+
+    endFrame(pRenderContext, renderData);
+}
+
+void PathTracer::renderSampleBatch(RenderContext* pRenderContext, const RenderData& renderData)
+{
+    // Update the runtime parameters for the current render tile and sample batch.
+    mpPathTracerBlock->getRootVar()["params"].setBlob(mParams);
+
     // Generate paths at primary hits.
     generatePaths(pRenderContext, renderData);
 
-    // Update RTXDI.
-    if (mpRTXDI)
+    // Update RTXDI. Tiling is disabled with RTXDI, so this is done once per frame.
+    if (mpRTXDI && mParams.sampleBatch == 0)
     {
         const auto& pMotionVectors = renderData.getTexture(kInputMotionVectors);
         mpRTXDI->update(pRenderContext, pMotionVectors);
     }
 
     // Trace pass.
-    FALCOR_ASSERT(mpTracePass);
-    tracePass(pRenderContext, renderData, *mpTracePass);
+    if (mUseWavefront)
+    {
+        traceWavefront(pRenderContext, renderData);
+    }
+    else
+    {
+        FALCOR_ASSERT(mpTracePass);
+        tracePass(pRenderContext, renderData, *mpTracePass);
+    }
 
     // Launch separate passes to trace delta reflection and transmission paths to generate respective guide buffers.
     if (mOutputNRDAdditionalData)
@@ -482,8 +572,6 @@ void PathTracer::execute(RenderContext* pRenderContext, const RenderData& render
 
     // Resolve pass.
     resolvePass(pRenderContext, renderData);
-
-    endFrame(pRenderContext, renderData);
 }
 
 void PathTracer::renderUI(Gui::Widgets& widget)
@@ -511,11 +599,15 @@ bool PathTracer::renderRenderingUI(Gui::Widgets& widget)
 
     if (mFixedSampleCount)
     {
-        dirty |= widget.var("Samples/pixel", mStaticParams.samplesPerPixel, 1u, kMaxSamplesPerPixel);
+        dirty |= widget.var("Samples/pixel", mStaticParams.samplesPerPixel, 1u, kMaxSamplesPerPixel * kMaxSampleBatchCount);
     }
     else widget.text("Samples/pixel: Variable");
     widget.tooltip("Number of samples per pixel. One path is traced for each sample.\n\n"
-        "When the '" + kInputSampleCount + "' input is connected, the number of samples per pixel is loaded from the texture.");
+        "Sample counts above " + std::to_string(kMaxSamplesPerPixel) + " are rendered in multiple sample batches.\n\n"
+        "All samples of a pixel, in all sample batches, start from the same primary hit loaded from the V-buffer. "
+        "They do not antialias edges or sample the lens, use a jittered V-buffer and accumulate over frames for that.\n\n"
+        "When the '" + kInputSampleCount + "' input is connected, the number of samples per pixel is loaded from the texture.\n\n"
+        "When an AdaptiveSampling pass is used, the number of samples per pixel is computed by that pass.");
 
     if (widget.var("Max surface bounces", mStaticParams.maxSurfaceBounces, 0u, kMaxBounces))
     {
@@ -633,6 +725,15 @@ bool PathTracer::renderRenderingUI(Gui::Widgets& widget)
     {
         dirty |= widget.checkbox("Use SER", mStaticParams.useSER);
         widget.tooltip("Use Shader Execution Reordering (SER) to improve GPU utilization.");
+
+        dirty |= widget.checkbox("Use wavefront", mStaticParams.useWavefront);
+        widget.tooltip("Trace paths with separate compute passes for path extension, shading and shadow rays using inline ray queries. "
+            "Hits are sorted by material type before shading, which reduces divergence in scenes with many material types.\n\n"
+            "NRD outputs are not supported and fall back to the trace pass.");
+
+        runtimeDirty |= widget.var("Tile size", mTileSize, 0u, kMaxFrameDimension, 16.f);
+        widget.tooltip("Size of the render tiles in pixels. The frame is rendered one tile at a time, and the internal per-sample buffers are allocated for a single tile.\n\n"
+            "Zero along an axis means the frame is not split along that axis.");
     }
 
     if (auto group = widget.group("Output options"))
@@ -765,11 +866,16 @@ PathTracer::TracePass::TracePass(ref<Device> pDevice, const std::string& name, c
 }
 
 
-void PathTracer::TracePass::prepareProgram(ref<Device> pDevice, const DefineList& defines)
+void PathTracer::TracePass::prepareProgram(const DefineList& defines)
 {
     FALCOR_ASSERT(pProgram != nullptr && pBindingTable != nullptr);
     pProgram->setDefines(defines);
     if (!passDefine.empty()) pProgram->addDefine(passDefine);
+}
+
+void PathTracer::TracePass::createVars(ref<Device> pDevice)
+{
+    FALCOR_ASSERT(pProgram != nullptr && pBindingTable != nullptr);
     pVars = RtProgramVars::create(pDevice, pProgram, pBindingTable);
 }
 
@@ -780,11 +886,15 @@ void PathTracer::resetPrograms()
     mpTraceDeltaTransmissionPass = nullptr;
     mpGeneratePaths = nullptr;
     mpReflectTypes = nullptr;
+    mpWavefrontGenerate = nullptr;
+    mpWavefrontShade = nullptr;
+    mpWavefrontShadow = nullptr;
+    mpWavefrontExtend = nullptr;
 
     mRecompile = true;
 }
 
-void PathTracer::updatePrograms()
+void PathTracer::updatePrograms(const RenderData& renderData)
 {
     FALCOR_ASSERT(mpScene);
 
@@ -794,16 +904,46 @@ void PathTracer::updatePrograms()
     // This may be due to change of scene defines, type conformances, shader modules, or other changes that require recompilation.
     // When type conformances and/or shader modules change, the programs need to be recreated. We assume programs have been reset upon such changes.
     // When only defines have changed, it is sufficient to update the existing programs and recreate the program vars.
+    createPrograms(renderData);
 
+    // Recreate program vars. This may trigger recompilation if needed.
+    // Note that program versions are cached, so switching to a previously used specialization is faster.
+    // The versions declared by collectProgramVersions() have already been compiled when the render graph was compiled.
+    if (!mUseWavefront) mpTracePass->createVars(mpDevice);
+    if (mOutputNRDAdditionalData)
+    {
+        mpTraceDeltaReflectionPass->createVars(mpDevice);
+        mpTraceDeltaTransmissionPass->createVars(mpDevice);
+    }
+
+    mpGeneratePaths->setVars(nullptr);
+    mpResolvePass->setVars(nullptr);
+    mpReflectTypes->setVars(nullptr);
+    if (mStaticParams.useWavefront)
+    {
+        for (const auto& pass : { mpWavefrontGenerate, mpWavefrontShade, mpWavefrontShadow, mpWavefrontExtend }) pass->setVars(nullptr);
+    }
+
+    mVarsChanged = true;
+    mRecompile = false;
+}
+
+void PathTracer::createPrograms(const RenderData& renderData)
+{
+    // Create the programs and set their defines, but don't create any vars. The programs are only compiled when vars are created or the versions are prewarmed.
+    // The passes are specialized for the connected inputs and outputs up front, so that each program is compiled once with the defines it is executed with.
     auto defines = mStaticParams.getDefines(*this);
+    auto passDefines = defines;
+    passDefines.add(getPassDefines(renderData));
+
     TypeConformanceList globalTypeConformances;
     mpScene->getTypeConformances(globalTypeConformances);
 
-    // Create trace pass.
+    // Create trace pass. Its program is only compiled when it is used.
     if (!mpTracePass)
         mpTracePass = TracePass::create(mpDevice, "tracePass", "", mpScene, defines, globalTypeConformances);
 
-    mpTracePass->prepareProgram(mpDevice, defines);
+    mpTracePass->prepareProgram(passDefines);
 
     // Create specialized trace passes.
     if (mOutputNRDAdditionalData)
@@ -813,8 +953,8 @@ void PathTracer::updatePrograms()
         if (!mpTraceDeltaTransmissionPass)
             mpTraceDeltaTransmissionPass = TracePass::create(mpDevice, "traceDeltaTransmissionPass", "DELTA_TRANSMISSION_PASS", mpScene, defines, globalTypeConformances);
 
-        mpTraceDeltaReflectionPass->prepareProgram(mpDevice, defines);
-        mpTraceDeltaTransmissionPass->prepareProgram(mpDevice, defines);
+        mpTraceDeltaReflectionPass->prepareProgram(passDefines);
+        mpTraceDeltaTransmissionPass->prepareProgram(passDefines);
     }
 
     // Create compute passes.
@@ -835,43 +975,101 @@ void PathTracer::updatePrograms()
         mpReflectTypes = ComputePass::create(mpDevice, desc, defines, false);
     }
 
-    auto preparePass = [&](ref<ComputePass> pass)
+    // Note that we must use set instead of add defines to replace any stale state.
+    mpGeneratePaths->getProgram()->setDefines(passDefines);
+    mpResolvePass->getProgram()->setDefines(passDefines);
+    mpReflectTypes->getProgram()->setDefines(defines);
+
+    // Create wavefront passes.
+    if (mStaticParams.useWavefront)
     {
-        // Note that we must use set instead of add defines to replace any stale state.
-        pass->getProgram()->setDefines(defines);
+        auto createWavefrontPass = [&](ref<ComputePass>& pass, const std::string& entryPoint)
+        {
+            if (!pass)
+            {
+                ProgramDesc desc = baseDesc;
+                desc.addShaderLibrary(kWavefrontPassFilename).csEntry(entryPoint);
+                pass = ComputePass::create(mpDevice, desc, defines, false);
+            }
+            pass->getProgram()->setDefines(passDefines);
+        };
+        createWavefrontPass(mpWavefrontGenerate, "generate");
+        createWavefrontPass(mpWavefrontShade, "shade");
+        createWavefrontPass(mpWavefrontShadow, "shadow");
+        createWavefrontPass(mpWavefrontExtend, "extend");
+
+        if (!mpWavefrontSort) mpWavefrontSort = std::make_unique<RadixSort>(mpDevice);
+
+        // The shading queue is sorted on the material type. The key with all bits set sorts last and marks slots without a hit.
+        uint32_t maxMaterialType = 0;
+        for (const auto materialType : mpScene->getMaterialSystem().getMaterialTypes())
+            maxMaterialType = std::max(maxMaterialType, (uint32_t)materialType);
+        mWavefrontKeyBits = bitScanReverse(maxMaterialType + 1) + 1;
+    }
+}
 
-        // Recreate program vars. This may trigger recompilation if needed.
-        // Note that program versions are cached, so switching to a previously used specialization is faster.
-        pass->setVars(nullptr);
-    };
-    preparePass(mpGeneratePaths);
-    preparePass(mpResolvePass);
-    preparePass(mpReflectTypes);
+DefineList PathTracer::getPassDefines(const RenderData& renderData) const
+{
+    // Specialization to the connected inputs and outputs. This shouldn't change resource declarations.
+    DefineList defines;
+    defines.add("USE_VIEW_DIR", (mpScene->getCamera()->getApertureRadius() > 0 && renderData[kInputViewDir] != nullptr) ? "1" : "0");
+    defines.add("OUTPUT_GUIDE_DATA", mOutputGuideData ? "1" : "0");
+    defines.add("OUTPUT_NRD_DATA", mOutputNRDData ? "1" : "0");
+    defines.add("OUTPUT_NRD_ADDITIONAL_DATA", mOutputNRDAdditionalData ? "1" : "0");
+    return defines;
+}
 
-    mVarsChanged = true;
-    mRecompile = false;
+void PathTracer::collectProgramVersions(const RenderData& renderData, std::vector<ProgramVersionRequest>& requests)
+{
+    if (mpScene == nullptr || !mEnabled) return;
+
+    // Bring the specialization up to date as beginFrame() does, so that the programs are prewarmed with the defines they are executed with.
+    // Lighting changes found here are reported by the next beginFrame().
+    mLightingChanged |= prepareSpecialization(mpDevice->getRenderContext(), renderData);
+
+    if (mRecompile) createPrograms(renderData);
+
+    // Declare the programs that are executed with the current settings.
+    if (mUseWavefront)
+    {
+        for (const auto& pass : { mpWavefrontGenerate, mpWavefrontShade, mpWavefrontShadow, mpWavefrontExtend }) requests.push_back({ pass->getProgram() });
+    }
+    else
+    {
+        requests.push_back({ mpTracePass->pProgram });
+    }
+    if (mOutputNRDAdditionalData)
+    {
+        requests.push_back({ mpTraceDeltaReflectionPass->pProgram });
+        requests.push_back({ mpTraceDeltaTransmissionPass->pProgram });
+    }
+    requests.push_back({ mpGeneratePaths->getProgram() });
+    requests.push_back({ mpResolvePass->getProgram() });
+    requests.push_back({ mpReflectTypes->getProgram() });
 }
 
 void PathTracer::prepareResources(RenderContext* pRenderContext, const RenderData& renderData)
 {
-    // Compute allocation requirements for paths and output samples.
-    // Note that the sample buffers are padded to whole tiles, while the max path count depends on actual frame dimension.
+    // Compute allocation requirements for output samples.
+    // The sample buffers hold the samples of one sample batch for a single render tile.
+    // Note that the sample buffers are padded to whole screen-tiles.
     // If we don't have a fixed sample count, assume the worst case.
-    uint32_t spp = mFixedSampleCount ? mStaticParams.samplesPerPixel : kMaxSamplesPerPixel;
-    uint32_t tileCount = mParams.screenTiles.x * mParams.screenTiles.y;
-    const uint32_t sampleCount = tileCount * kScreenTileDim.x * kScreenTileDim.y * spp;
-    const uint32_t screenPixelCount = mParams.frameDim.x * mParams.frameDim.y;
-    const uint32_t pathCount = screenPixelCount * spp;
+    uint32_t spp = mFixedSampleCount ? mStaticParams.getBatchSamplesPerPixel() : kMaxSamplesPerPixel;
+    const uint2 screenTiles = div_round_up(mRenderTileDim, kScreenTileDim);
+    const uint64_t tileCount = uint64_t(screenTiles.x) * screenTiles.y;
+    if (tileCount * kScreenTileDim.x * kScreenTileDim.y * spp > std::numeric_limits<uint32_t>::max())
+        FALCOR_THROW("PathTracer: Per-sample buffers for a {}x{} render tile are too large. Use a smaller '{}'.", mRenderTileDim.x, mRenderTileDim.y, kTileSize);
+    const uint32_t sampleCount = uint32_t(tileCount * kScreenTileDim.x * kScreenTileDim.y * spp);
 
     // Allocate output sample offset buffer if needed.
     // This buffer stores the output offset to where the samples for each pixel are stored consecutively.
     // The offsets are local to the current tile, so 16-bit format is sufficient and reduces bandwidth usage.
     if (!mFixedSampleCount)
     {
-        if (!mpSampleOffset || mpSampleOffset->getWidth() != mParams.frameDim.x || mpSampleOffset->getHeight() != mParams.frameDim.y)
+        if (!mpSampleOffset || mpSampleOffset->getWidth() != mRenderTileDim.x || mpSampleOffset->getHeight() != mRenderTileDim.y)
         {
             FALCOR_ASSERT(kScreenTileDim.x * kScreenTileDim.y * kMaxSamplesPerPixel <= (1u << 16));
-            mpSampleOffset = mpDevice->createTexture2D(mParams.frameDim.x, mParams.frameDim.y, ResourceFormat::R16Uint, 1, 1, nullptr, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess);
+            mpSampleOffset = mpDevice->createTexture2D(mRenderTileDim.x, mRenderTileDim.y, ResourceFormat::R16Uint, 1, 1, nullptr, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess);
             mVarsChanged = true;
         }
     }
@@ -904,6 +1102,35 @@ void PathTracer::prepareResources(RenderContext* pRenderContext, const RenderDat
         mpSampleNRDReflectance = mpDevice->createStructuredBuffer(var["sampleNRDReflectance"], sampleCount, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess, MemoryType::DeviceLocal, nullptr, false);
         mVarsChanged = true;
     }
+
+    // Allocate wavefront buffers. These hold one path per pixel of the render tile, padded to whole screen-tiles.
+    if (mUseWavefront)
+    {
+        const uint32_t tileSize = kScreenTileDim.x * kScreenTileDim.y;
+        const uint32_t slotCount = uint32_t(tileCount * tileSize);
+        if (slotCount > std::min(RadixSort::getMaxElementCount(), kMaxWavefrontGroupCount * tileSize))
+            FALCOR_THROW("PathTracer: Wavefront buffers for a {}x{} render tile are too large. Use a smaller '{}'.", mRenderTileDim.x, mRenderTileDim.y, kTileSize);
+
+        auto schedulerVar = mpWavefrontGenerate->getRootVar()["CB"]["gScheduler"];
+        for (const auto& name : kWavefrontPathBuffers)
+        {
+            auto& pBuffer = mWavefrontBuffers[name];
+            if (!pBuffer || pBuffer->getElementCount() < slotCount)
+                pBuffer = mpDevice->createStructuredBuffer(schedulerVar[name], slotCount, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess, MemoryType::DeviceLocal, nullptr, false);
+        }
+        for (const auto& name : { kWavefrontQueueKeys, kWavefrontQueueValues, kWavefrontExtendQueue })
+        {
+            auto& pBuffer = mWavefrontBuffers[name];
+            if (!pBuffer || pBuffer->getSize() < slotCount * sizeof(uint32_t))
+                pBuffer = mpDevice->createBuffer(slotCount * sizeof(uint32_t), ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess);
+        }
+        for (auto pBuffer : { &mpWavefrontShadeWork, &mpWavefrontExtendWork })
+        {
+            // Indirect dispatch arguments followed by the number of queue entries.
+            if (!*pBuffer)
+                *pBuffer = mpDevice->createBuffer(sizeof(DispatchArguments) + sizeof(uint32_t), ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess | ResourceBindFlags::IndirectArg);
+        }
+    }
 }
 
 void PathTracer::preparePathTracer(const RenderData& renderData)
@@ -1109,17 +1336,12 @@ void PathTracer::bindShaderData(const ShaderVar& var, const RenderData& renderDa
         if (!pViewDir) logWarning("Depth-of-field requires the '{}' input. Expect incorrect rendering.", kInputViewDir);
     }
 
-    ref<Texture> pSampleCount;
-    if (!mFixedSampleCount)
-    {
-        pSampleCount = renderData.getTexture(kInputSampleCount);
-        if (!pSampleCount) FALCOR_THROW("PathTracer: Missing sample count input texture");
-    }
+    if (!mFixedSampleCount && !mpSampleCount) FALCOR_THROW("PathTracer: Missing sample count input texture");
 
     var["params"].setBlob(mParams);
     var["vbuffer"] = renderData.getTexture(kInputVBuffer);
     var["viewDir"] = pViewDir; // Can be nullptr
-    var["sampleCount"] = pSampleCount; // Can be nullptr
+    var["sampleCount"] = mpSampleCount; // Can be nullptr
     var["outputColor"] = renderData.getTexture(kOutputColor);
 
     if (useLightSampling && mpEmissiveSampler)
@@ -1129,6 +1351,71 @@ void PathTracer::bindShaderData(const ShaderVar& var, const RenderData& renderDa
     }
 }
 
+bool PathTracer::prepareSpecialization(RenderContext* pRenderContext, const RenderData& renderData)
+{
+    // Update materials.
+    prepareMaterials(pRenderContext);
+
+    // Update the env map and emissive sampler to the current frame.
+    bool lightingChanged = prepareLighting(pRenderContext);
+
+    // Prepare RTXDI.
+    prepareRTXDI(pRenderContext);
+
+    // The scene changes have been handled.
+    mUpdateFlags = IScene::UpdateFlags::None;
+
+    // Check if GBuffer has adjusted shading normals enabled.
+    auto& dict = renderData.getDictionary();
+    bool gbufferAdjustShadingNormals = dict.getValue(Falcor::kRenderPassGBufferAdjustShadingNormals, false);
+    if (gbufferAdjustShadingNormals != mGBufferAdjustShadingNormals)
+    {
+        mGBufferAdjustShadingNormals = gbufferAdjustShadingNormals;
+        mRecompile = true;
+    }
+
+    // Check if guide data should be generated.
+    mOutputGuideData = renderData[kOutputAlbedo] != nullptr || renderData[kOutputSpecularAlbedo] != nullptr
+        || renderData[kOutputIndirectAlbedo] != nullptr || renderData[kOutputGuideNormal] != nullptr
+        || renderData[kOutputReflectionPosW] != nullptr;
+
+    // Check if NRD data should be generated.
+    mOutputNRDData =
+        renderData[kOutputNRDDiffuseRadianceHitDist] != nullptr
+        || renderData[kOutputNRDSpecularRadianceHitDist] != nullptr
+        || renderData[kOutputNRDResidualRadianceHitDist] != nullptr
+        || renderData[kOutputNRDEmission] != nullptr
+        || renderData[kOutputNRDDiffuseReflectance] != nullptr
+        || renderData[kOutputNRDSpecularReflectance] != nullptr;
+
+    // Check if additional NRD data should be generated.
+    bool prevOutputNRDAdditionalData = mOutputNRDAdditionalData;
+    mOutputNRDAdditionalData =
+        renderData[kOutputNRDDeltaReflectionRadianceHitDist] != nullptr
+        || renderData[kOutputNRDDeltaTransmissionRadianceHitDist] != nullptr
+        || renderData[kOutputNRDDeltaReflectionReflectance] != nullptr
+        || renderData[kOutputNRDDeltaReflectionEmission] != nullptr
+        || renderData[kOutputNRDDeltaReflectionNormWRoughMaterialID] != nullptr
+        || renderData[kOutputNRDDeltaReflectionPathLength] != nullptr
+        || renderData[kOutputNRDDeltaReflectionHitDist] != nullptr
+        || renderData[kOutputNRDDeltaTransmissionReflectance] != nullptr
+        || renderData[kOutputNRDDeltaTransmissionEmission] != nullptr
+        || renderData[kOutputNRDDeltaTransmissionNormWRoughMaterialID] != nullptr
+        || renderData[kOutputNRDDeltaTransmissionPathLength] != nullptr
+        || renderData[kOutputNRDDeltaTransmissionPosW] != nullptr;
+    if (mOutputNRDAdditionalData != prevOutputNRDAdditionalData) mRecompile = true;
+
+    // Check if the wavefront scheduler can be used.
+    // NRD outputs are written while shading, before the deferred shadow rays have been traced, so they require the trace pass.
+    bool prevUseWavefront = mUseWavefront;
+    mUseWavefront = mStaticParams.useWavefront && !mOutputNRDData && !mOutputNRDAdditionalData;
+    if (mStaticParams.useWavefront && !mUseWavefront)
+        logWarningOnce("PathTracer: The wavefront scheduler does not support NRD outputs. Using the trace pass instead.");
+    if (mUseWavefront != prevUseWavefront) mRecompile = true;
+
+    return lightingChanged;
+}
+
 bool PathTracer::beginFrame(RenderContext* pRenderContext, const RenderData& renderData)
 {
     const auto& pOutputColor = renderData.getTexture(kOutputColor);
@@ -1173,14 +1460,11 @@ bool PathTracer::beginFrame(RenderContext* pRenderContext, const RenderData& ren
         return false;
     }
 
-    // Update materials.
-    prepareMaterials(pRenderContext);
-
-    // Update the env map and emissive sampler to the current frame.
-    bool lightingChanged = prepareLighting(pRenderContext);
+    // Update the program specialization to the current scene and render graph state.
+    // Lighting changes found when the programs were prewarmed are reported here.
+    bool lightingChanged = prepareSpecialization(pRenderContext, renderData) || mLightingChanged;
+    mLightingChanged = false;
 
-    // Prepare RTXDI.
-    prepareRTXDI(pRenderContext);
     if (mpRTXDI) mpRTXDI->beginFrame(pRenderContext, mParams.frameDim);
 
     // Update refresh flag if changes that affect the output have occured.
@@ -1194,48 +1478,23 @@ bool PathTracer::beginFrame(RenderContext* pRenderContext, const RenderData& ren
         mOptionsChanged = false;
     }
 
-    // Check if GBuffer has adjusted shading normals enabled.
-    bool gbufferAdjustShadingNormals = dict.getValue(Falcor::kRenderPassGBufferAdjustShadingNormals, false);
-    if (gbufferAdjustShadingNormals != mGBufferAdjustShadingNormals)
+    // Check if fixed sample count should be used. When the sample count input is connected we load the count from there instead.
+    // Otherwise an adaptive sampling pass may have provided the sample count for this frame via the dictionary.
+    mpSampleCount = renderData.getTexture(kInputSampleCount);
+    if (!mpSampleCount && dict.keyExists(kRenderPassAdaptiveSampleCount))
+    {
+        ref<Texture> pAdaptiveSampleCount = dict[kRenderPassAdaptiveSampleCount];
+        dict[kRenderPassAdaptiveSampleCount] = ref<Texture>();
+        if (pAdaptiveSampleCount && pAdaptiveSampleCount->getWidth() == mParams.frameDim.x && pAdaptiveSampleCount->getHeight() == mParams.frameDim.y)
+            mpSampleCount = pAdaptiveSampleCount;
+    }
+    bool fixedSampleCount = mpSampleCount == nullptr;
+    if (fixedSampleCount != mFixedSampleCount)
     {
-        mGBufferAdjustShadingNormals = gbufferAdjustShadingNormals;
+        mFixedSampleCount = fixedSampleCount;
         mRecompile = true;
     }
 
-    // Check if fixed sample count should be used. When the sample count input is connected we load the count from there instead.
-    mFixedSampleCount = renderData[kInputSampleCount] == nullptr;
-
-    // Check if guide data should be generated.
-    mOutputGuideData = renderData[kOutputAlbedo] != nullptr || renderData[kOutputSpecularAlbedo] != nullptr
-        || renderData[kOutputIndirectAlbedo] != nullptr || renderData[kOutputGuideNormal] != nullptr
-        || renderData[kOutputReflectionPosW] != nullptr;
-
-    // Check if NRD data should be generated.
-    mOutputNRDData =
-        renderData[kOutputNRDDiffuseRadianceHitDist] != nullptr
-        || renderData[kOutputNRDSpecularRadianceHitDist] != nullptr
-        || renderData[kOutputNRDResidualRadianceHitDist] != nullptr
-        || renderData[kOutputNRDEmission] != nullptr
-        || renderData[kOutputNRDDiffuseReflectance] != nullptr
-        || renderData[kOutputNRDSpecularReflectance] != nullptr;
-
-    // Check if additional NRD data should be generated.
-    bool prevOutputNRDAdditionalData = mOutputNRDAdditionalData;
-    mOutputNRDAdditionalData =
-        renderData[kOutputNRDDeltaReflectionRadianceHitDist] != nullptr
-        || renderData[kOutputNRDDeltaTransmissionRadianceHitDist] != nullptr
-        || renderData[kOutputNRDDeltaReflectionReflectance] != nullptr
-        || renderData[kOutputNRDDeltaReflectionEmission] != nullptr
-        || renderData[kOutputNRDDeltaReflectionNormWRoughMaterialID] != nullptr
-        || renderData[kOutputNRDDeltaReflectionPathLength] != nullptr
-        || renderData[kOutputNRDDeltaReflectionHitDist] != nullptr
-        || renderData[kOutputNRDDeltaTransmissionReflectance] != nullptr
-        || renderData[kOutputNRDDeltaTransmissionEmission] != nullptr
-        || renderData[kOutputNRDDeltaTransmissionNormWRoughMaterialID] != nullptr
-        || renderData[kOutputNRDDeltaTransmissionPathLength] != nullptr
-        || renderData[kOutputNRDDeltaTransmissionPosW] != nullptr;
-    if (mOutputNRDAdditionalData != prevOutputNRDAdditionalData) mRecompile = true;
-
     // Enable pixel stats if rayCount or pathLength outputs are connected.
     if (renderData[kOutputRayCount] != nullptr || renderData[kOutputPathLength] != nullptr)
     {
@@ -1248,8 +1507,6 @@ bool PathTracer::beginFrame(RenderContext* pRenderContext, const RenderData& ren
     // Update the random seed.
     mParams.seed = mParams.useFixedSeed ? mParams.fixedSeed : mParams.frameCount;
 
-    mUpdateFlags = IScene::UpdateFlags::None;
-
     return true;
 }
 
@@ -1279,6 +1536,7 @@ void PathTracer::endFrame(RenderContext* pRenderContext, const RenderData& rende
 
     if (mpRTXDI) mpRTXDI->endFrame(pRenderContext);
 
+    mpSampleCount = nullptr;
     mVarsChanged = false;
     mParams.frameCount++;
 }
@@ -1296,10 +1554,7 @@ void PathTracer::generatePaths(RenderContext* pRenderContext, const RenderData&
     FALCOR_ASSERT(mpGeneratePaths->getThreadGroupSize().y == 1 && mpGeneratePaths->getThreadGroupSize().z == 1);
 
     // Additional specialization. This shouldn't change resource declarations.
-    mpGeneratePaths->addDefine("USE_VIEW_DIR", (mpScene->getCamera()->getApertureRadius() > 0 && renderData[kInputViewDir] != nullptr) ? "1" : "0");
-    mpGeneratePaths->addDefine("OUTPUT_GUIDE_DATA", mOutputGuideData ? "1" : "0");
-    mpGeneratePaths->addDefine("OUTPUT_NRD_DATA", mOutputNRDData ? "1" : "0");
-    mpGeneratePaths->addDefine("OUTPUT_NRD_ADDITIONAL_DATA", mOutputNRDAdditionalData ? "1" : "0");
+    mpGeneratePaths->getProgram()->addDefines(getPassDefines(renderData));
 
     // Bind resources.
     auto var = mpGeneratePaths->getRootVar()["CB"]["gPathGenerator"];
@@ -1309,7 +1564,7 @@ void PathTracer::generatePaths(RenderContext* pRenderContext, const RenderData&
 
     if (mpRTXDI) mpRTXDI->bindShaderData(mpGeneratePaths->getRootVar());
 
-    // Launch one thread per pixel.
+    // Launch one thread per pixel in the current render tile.
     // The dimensions are padded to whole tiles to allow re-indexing the threads in the shader.
     mpGeneratePaths->execute(pRenderContext, { mParams.screenTiles.x * tileSize, mParams.screenTiles.y, 1u });
 }
@@ -1321,10 +1576,7 @@ void PathTracer::tracePass(RenderContext* pRenderContext, const RenderData& rend
     FALCOR_ASSERT(tracePass.pProgram != nullptr && tracePass.pBindingTable != nullptr && tracePass.pVars != nullptr);
 
     // Additional specialization. This shouldn't change resource declarations.
-    tracePass.pProgram->addDefine("USE_VIEW_DIR", (mpScene->getCamera()->getApertureRadius() > 0 && renderData[kInputViewDir] != nullptr) ? "1" : "0");
-    tracePass.pProgram->addDefine("OUTPUT_GUIDE_DATA", mOutputGuideData ? "1" : "0");
-    tracePass.pProgram->addDefine("OUTPUT_NRD_DATA", mOutputNRDData ? "1" : "0");
-    tracePass.pProgram->addDefine("OUTPUT_NRD_ADDITIONAL_DATA", mOutputNRDAdditionalData ? "1" : "0");
+    tracePass.pProgram->addDefines(getPassDefines(renderData));
 
     // Bind global resources.
     auto var = tracePass.pVars->getRootVar();
@@ -1338,8 +1590,109 @@ void PathTracer::tracePass(RenderContext* pRenderContext, const RenderData& rend
     // Bind the path tracer.
     var["gPathTracer"] = mpPathTracerBlock;
 
-    // Full screen dispatch.
-    mpScene->raytrace(pRenderContext, tracePass.pProgram.get(), tracePass.pVars, uint3(mParams.frameDim, 1));
+    // Dispatch over the current render tile.
+    mpScene->raytrace(pRenderContext, tracePass.pProgram.get(), tracePass.pVars, uint3(mParams.renderTileDim, 1));
+}
+
+void PathTracer::traceWavefront(RenderContext* pRenderContext, const RenderData& renderData)
+{
+    FALCOR_PROFILE(pRenderContext, "traceWavefront");
+
+    FALCOR_ASSERT(mpWavefrontGenerate && mpWavefrontShade && mpWavefrontShadow && mpWavefrontExtend && mpWavefrontSort);
+
+    const ref<ComputePass> passes[] = { mpWavefrontGenerate, mpWavefrontShade, mpWavefrontShadow, mpWavefrontExtend };
+    for (const auto& pass : passes)
+    {
+        // Additional specialization. This shouldn't change resource declarations.
+        pass->getProgram()->addDefines(getPassDefines(renderData));
+
+        // Bind global resources.
+        auto var = pass->getRootVar();
+
+        mpScene->bindShaderDataForRaytracing(pRenderContext, var["gScene"]);
+        if (mVarsChanged) mpSampleGenerator->bindShaderData(var);
+        if (mpRTXDI) mpRTXDI->bindShaderData(var);
+
+        mpPixelStats->prepareProgram(pass->getProgram(), var);
+        mpPixelDebug->prepareProgram(pass->getProgram(), var);
+
+        // Bind the path tracer and the wavefront buffers.
+        var["gPathTracer"] = mpPathTracerBlock;
+
+        auto schedulerVar = var["CB"]["gScheduler"];
+        for (const auto& [name, pBuffer] : mWavefrontBuffers) schedulerVar[name] = pBuffer;
+        schedulerVar["invalidKey"] = (1u << mWavefrontKeyBits) - 1;
+        schedulerVar["lastIteration"] = false;
+    }
+
+    // The work buffers are only bound to the passes filling the queues. The passes consuming a queue use its work buffer as dispatch arguments.
+    mpWavefrontGenerate->getRootVar()["CB"]["gScheduler"]["shadeWork"] = mpWavefrontShadeWork;
+    mpWavefrontShadow->getRootVar()["CB"]["gScheduler"]["extendWork"] = mpWavefrontExtendWork;
+    mpWavefrontExtend->getRootVar()["CB"]["gScheduler"]["shadeWork"] = mpWavefrontShadeWork;
+
+    // The generate pass launches one thread per path slot, with one thread group per screen-tile in the current render tile.
+    const uint32_t tileSize = kScreenTileDim.x * kScreenTileDim.y;
+    FALCOR_ASSERT(kScreenTileBits.x <= 4 && kScreenTileBits.y <= 4); // Since we use 8-bit deinterleave.
+    const uint3 dispatchDim = { mParams.screenTiles.x * tileSize, mParams.screenTiles.y, 1u };
+    const uint32_t slotCount = mParams.screenTiles.x * mParams.screenTiles.y * tileSize;
+
+    // The other passes are dispatched indirectly over the queues filled on the GPU.
+    // The queues are cleared before they are filled. Unused shading queue entries hold the key with all bits set, which sorts last.
+    const auto& pQueueKeys = mWavefrontBuffers[kWavefrontQueueKeys];
+    auto clearShadingQueue = [&]()
+    {
+        pRenderContext->clearUAV(pQueueKeys->getUAV().get(), uint4((1u << mWavefrontKeyBits) - 1));
+        pRenderContext->clearUAV(mpWavefrontShadeWork->getUAV().get(), uint4(0));
+    };
+    auto clearExtendQueue = [&]()
+    {
+        pRenderContext->clearUAV(mWavefrontBuffers[kWavefrontExtendQueue]->getUAV().get(), uint4(0xffffffff));
+        pRenderContext->clearUAV(mpWavefrontExtendWork->getUAV().get(), uint4(0));
+    };
+
+    // The paths are traced one sample index at a time, so the path state buffers hold one path per pixel.
+    // Each path is shaded once per surface bounce, once more at the last vertex, and once for each rejected hit.
+    // Recording this many iterations terminates all paths without reading back the number of active paths.
+    // The iterations after all paths have terminated only run empty dispatches.
+    const uint32_t sampleCount = mFixedSampleCount ? mStaticParams.getBatchSamplesPerPixel() : kMaxSamplesPerPixel;
+    const uint32_t iterationCount = mStaticParams.maxSurfaceBounces + 2 + kMaxRejectedHits;
+
+    for (uint32_t sampleIdx = 0; sampleIdx < sampleCount; sampleIdx++)
+    {
+        {
+            FALCOR_PROFILE(pRenderContext, "generate");
+            clearShadingQueue();
+            mpWavefrontGenerate->getRootVar()["CB"]["gScheduler"]["sampleIdx"] = sampleIdx;
+            mpWavefrontGenerate->execute(pRenderContext, dispatchDim);
+        }
+
+        for (uint32_t iteration = 0; iteration < iterationCount; iteration++)
+        {
+            const bool lastIteration = iteration + 1 == iterationCount;
+
+            {
+                // The queue is sorted in full, as the sort takes its element count from the host.
+                FALCOR_PROFILE(pRenderContext, "sort");
+                mpWavefrontSort->execute(pRenderContext, pQueueKeys, mWavefrontBuffers[kWavefrontQueueValues], slotCount, RadixSort::KeyType::Uint32, mWavefrontKeyBits);
+            }
+            {
+                FALCOR_PROFILE(pRenderContext, "shade");
+                mpWavefrontShade->executeIndirect(pRenderContext, mpWavefrontShadeWork.get());
+            }
+            {
+                FALCOR_PROFILE(pRenderContext, "shadow");
+                clearExtendQueue();
+                mpWavefrontShadow->getRootVar()["CB"]["gScheduler"]["lastIteration"] = lastIteration;
+                mpWavefrontShadow->executeIndirect(pRenderContext, mpWavefrontShadeWork.get());
+            }
+            if (!lastIteration)
+            {
+                FALCOR_PROFILE(pRenderContext, "extend");
+                clearShadingQueue();
+                mpWavefrontExtend->executeIndirect(pRenderContext, mpWavefrontExtendWork.get());
+            }
+        }
+    }
 }
 
 void PathTracer::resolvePass(RenderContext* pRenderContext, const RenderData& renderData)
@@ -1355,13 +1708,12 @@ void PathTracer::resolvePass(RenderContext* pRenderContext, const RenderData& re
     // locate the samples for each pixel.
 
     // Additional specialization. This shouldn't change resource declarations.
-    mpResolvePass->addDefine("OUTPUT_GUIDE_DATA", mOutputGuideData ? "1" : "0");
-    mpResolvePass->addDefine("OUTPUT_NRD_DATA", mOutputNRDData ? "1" : "0");
+    mpResolvePass->getProgram()->addDefines(getPassDefines(renderData));
 
     // Bind resources.
     auto var = mpResolvePass->getRootVar()["CB"]["gResolvePass"];
     var["params"].setBlob(mParams);
-    var["sampleCount"] = renderData.getTexture(kInputSampleCount); // Can be nullptr
+    var["sampleCount"] = mpSampleCount; // Can be nullptr
     var["outputColor"] = renderData.getTexture(kOutputColor);
     var["outputAlbedo"] = renderData.getTexture(kOutputAlbedo);
     var["outputSpecularAlbedo"] = renderData.getTexture(kOutputSpecularAlbedo);
@@ -1388,8 +1740,8 @@ void PathTracer::resolvePass(RenderContext* pRenderContext, const RenderData& re
         var["primaryHitDiffuseReflectance"] = renderData.getTexture(kOutputNRDDiffuseReflectance);
     }
 
-    // Launch one thread per pixel.
-    mpResolvePass->execute(pRenderContext, { mParams.frameDim, 1u });
+    // Launch one thread per pixel in the current render tile.
+    mpResolvePass->execute(pRenderContext, { mParams.renderTileDim, 1u });
 }
 
 DefineList PathTracer::StaticParams::getDefines(const PathTracer& owner) const
@@ -1397,7 +1749,7 @@ DefineList PathTracer::StaticParams::getDefines(const PathTracer& owner) const
     DefineList defines;
 
     // Path tracer configuration.
-    defines.add("SAMPLES_PER_PIXEL", (owner.mFixedSampleCount ? std::to_string(samplesPerPixel) : "0")); // 0 indicates a variable sample count
+    defines.add("SAMPLES_PER_PIXEL", (owner.mFixedSampleCount ? std::to_string(getBatchSamplesPerPixel()) : "0")); // 0 indicates a variable sample count
     defines.add("MAX_SURFACE_BOUNCES", std::to_string(maxSurfaceBounces));
     defines.add("MAX_DIFFUSE_BOUNCES", std::to_string(maxDiffuseBounces));
     defines.add("MAX_SPECULAR_BOUNCES", std::to_string(maxSpecularBounces));
@@ -31,6 +31,7 @@
 #include "RenderGraph/RenderPassHelpers.h"
 #include "Utils/Debug/PixelDebug.h"
 #include "Utils/Sampling/SampleGenerator.h"
+#include "Utils/Algorithm/RadixSort.h"
 #include "Rendering/Lights/LightBVHSampler.h"
 #include "Rendering/Lights/EmissivePowerSampler.h"
 #include "Rendering/Lights/EnvMapSampler.h"
@@ -39,6 +40,7 @@
 #include "Rendering/RTXDI/RTXDI.h"
 
 #include "Params.slang"
+#include <map>
 
 using namespace Falcor;
 
@@ -58,6 +60,7 @@ public:
     virtual RenderPassReflection reflect(const CompileData& compileData) override;
     virtual void setScene(RenderContext* pRenderContext, const ref<Scene>& pScene) override;
     virtual void execute(RenderContext* pRenderContext, const RenderData& renderData) override;
+    virtual void collectProgramVersions(const RenderData& renderData, std::vector<ProgramVersionRequest>& requests) override;
     virtual void renderUI(Gui::Widgets& widget) override;
     virtual bool onMouseEvent(const MouseEvent& mouseEvent) override;
     virtual bool onKeyEvent(const KeyboardEvent& keyEvent) override { return false; }
@@ -85,14 +88,18 @@ private:
             return {};
         }
 
-        void prepareProgram(ref<Device> pDevice, const DefineList& defines);
+        void prepareProgram(const DefineList& defines);
+        void createVars(ref<Device> pDevice);
     };
 
     void parseProperties(const Properties& props);
     void validateOptions();
     void resetPrograms();
-    void updatePrograms();
+    void createPrograms(const RenderData& renderData);
+    void updatePrograms(const RenderData& renderData);
+    DefineList getPassDefines(const RenderData& renderData) const;
     void setFrameDim(const uint2 frameDim);
+    void setRenderTile(const uint2 tileOffset);
     void prepareResources(RenderContext* pRenderContext, const RenderData& renderData);
     void preparePathTracer(const RenderData& renderData);
     void resetLighting();
@@ -104,10 +111,13 @@ private:
     bool renderRenderingUI(Gui::Widgets& widget);
     bool renderDebugUI(Gui::Widgets& widget);
     void renderStatsUI(Gui::Widgets& widget);
+    bool prepareSpecialization(RenderContext* pRenderContext, const RenderData& renderData);
     bool beginFrame(RenderContext* pRenderContext, const RenderData& renderData);
     void endFrame(RenderContext* pRenderContext, const RenderData& renderData);
+    void renderSampleBatch(RenderContext* pRenderContext, const RenderData& renderData);
     void generatePaths(RenderContext* pRenderContext, const RenderData& renderData);
     void tracePass(RenderContext* pRenderContext, const RenderData& renderData, TracePass& tracePass);
+    void traceWavefront(RenderContext* pRenderContext, const RenderData& renderData);
     void resolvePass(RenderContext* pRenderContext, const RenderData& renderData);
 
     /** Static configuration. Changing any of these options require shader recompilation.
@@ -115,7 +125,7 @@ private:
     struct StaticParams
     {
         // Rendering parameters
-        uint32_t    samplesPerPixel = 1;                        ///< Number of samples (paths) per pixel, unless a sample density map is used.
+        uint32_t    samplesPerPixel = 1;                        ///< Number of samples (paths) per pixel, unless a sample density map is used. Counts above kMaxSamplesPerPixel are rendered in multiple sample batches.
         uint32_t    maxSurfaceBounces = 0;                      ///< Max number of surface bounces (diffuse + specular + transmission), up to kMaxPathLenth. This will be initialized at startup.
         uint32_t    maxDiffuseBounces = 3;                      ///< Max number of diffuse bounces (0 = direct only), up to kMaxBounces.
         uint32_t    maxSpecularBounces = 3;                     ///< Max number of specular bounces (0 = direct only), up to kMaxBounces.
@@ -142,6 +152,7 @@ private:
 
         // Scheduling parameters
         bool        useSER = true;                              ///< Enable SER (Shader Execution Reordering).
+        bool        useWavefront = false;                       ///< Use the wavefront scheduler with separate compute passes for path extension, shading and shadow rays instead of the trace pass.
 
         // Output parameters
         ColorFormat colorFormat = ColorFormat::LogLuvHDR;       ///< Color format used for internal per-sample color and denoiser buffers.
@@ -150,6 +161,11 @@ private:
         bool        useNRDDemodulation = true;                  ///< Global switch for NRD demodulation.
 
         DefineList getDefines(const PathTracer& owner) const;
+
+        /// Number of sample batches needed to render 'samplesPerPixel' samples.
+        uint32_t getSampleBatchCount() const { return div_round_up(samplesPerPixel, kMaxSamplesPerPixel); }
+        /// Number of samples per pixel in each sample batch. All batches have the same sample count.
+        uint32_t getBatchSamplesPerPixel() const { return samplesPerPixel / getSampleBatchCount(); }
     };
 
     // Configuration
@@ -161,6 +177,7 @@ private:
     bool                            mEnabled = true;            ///< Switch to enable/disable the path tracer. When disabled the pass outputs are cleared.
     RenderPassHelpers::IOSize       mOutputSizeSelection = RenderPassHelpers::IOSize::Default;  ///< Selected output size.
     uint2                           mFixedOutputSize = { 512, 512 };                            ///< Output size in pixels when 'Fixed' size is selected.
+    uint2                           mTileSize = { 0, 0 };       ///< Render tile size in pixels. Zero along an axis means the full frame dimension is used.
 
     bool                            mSERSupported = false;      ///< True if the device supports SER.
 
@@ -179,14 +196,19 @@ private:
 
     ref<ParameterBlock>             mpPathTracerBlock;          ///< Parameter block for the path tracer.
 
+    uint2                           mRenderTileDim = { 0, 0 };  ///< Render tile dimension for the current frame in pixels. The per-sample buffers are allocated for a single render tile.
+
     bool                            mRecompile = false;         ///< Set to true when program specialization has changed.
     bool                            mVarsChanged = true;        ///< This is set to true whenever the program vars have changed and resources need to be rebound.
     bool                            mOptionsChanged = false;    ///< True if the config has changed since last frame.
+    bool                            mLightingChanged = false;   ///< True if lighting changes were found when prewarming the programs. These are reported in the next frame.
     bool                            mGBufferAdjustShadingNormals = false; ///< True if GBuffer/VBuffer has adjusted shading normals enabled.
     bool                            mFixedSampleCount = true;   ///< True if a fixed sample count per pixel is used. Otherwise load it from the pass sample count input.
+    ref<Texture>                    mpSampleCount;              ///< Sample count texture for the current frame, from the sample count input or an adaptive sampling pass. Only set during execute().
     bool                            mOutputGuideData = false;   ///< True if guide data should be generated as outputs.
     bool                            mOutputNRDData = false;     ///< True if NRD diffuse/specular data should be generated as outputs.
     bool                            mOutputNRDAdditionalData = false;   ///< True if NRD data from delta and residual paths should be generated as designated outputs rather than being included in specular NRD outputs.
+    bool                            mUseWavefront = false;      ///< True if the wavefront scheduler is used for the current frame.
 
     ref<ComputePass>                mpGeneratePaths;            ///< Fullscreen compute pass generating paths starting at primary hits.
     ref<ComputePass>                mpResolvePass;              ///< Sample resolve pass.
@@ -196,7 +218,17 @@ private:
     std::unique_ptr<TracePass>      mpTraceDeltaReflectionPass; ///< Delta reflection trace pass (for NRD).
     std::unique_ptr<TracePass>      mpTraceDeltaTransmissionPass;   ///< Delta transmission trace pass (for NRD).
 
-    ref<Texture>                    mpSampleOffset;             ///< Output offset into per-sample buffers to where the samples for each pixel are stored (the offset is relative the start of the tile). Only used with non-fixed sample count.
+    ref<ComputePass>                mpWavefrontGenerate;        ///< Wavefront pass generating paths at primary hits.
+    ref<ComputePass>                mpWavefrontShade;           ///< Wavefront pass shading the hits in the shading queue.
+    ref<ComputePass>                mpWavefrontShadow;          ///< Wavefront pass tracing deferred shadow rays.
+    ref<ComputePass>                mpWavefrontExtend;          ///< Wavefront pass tracing scatter rays.
+    std::unique_ptr<RadixSort>      mpWavefrontSort;            ///< Sort of the shading queue by material type.
+    std::map<std::string, ref<Buffer>> mWavefrontBuffers;       ///< Wavefront path state, shadow ray and queue buffers by shader variable name. Allocated for a single render tile.
+    ref<Buffer>                     mpWavefrontShadeWork;       ///< Indirect dispatch arguments and number of entries of the wavefront shading queue.
+    ref<Buffer>                     mpWavefrontExtendWork;      ///< Indirect dispatch arguments and number of entries of the wavefront extend queue.
+    uint32_t                        mWavefrontKeyBits = 0;      ///< Number of bits of the shading queue keys. The key with all bits set marks slots without a hit.
+
+    ref<Texture>                    mpSampleOffset;             ///< Output offset into per-sample buffers to where the samples for each pixel are stored (the offset is relative the start of the tile). Allocated for a single render tile. Only used with non-fixed sample count.
     ref<Buffer>                     mpSampleColor;              ///< Compact per-sample color buffer. This is used only if spp > 1.
     ref<Buffer>                     mpSampleGuideData;          ///< Compact per-sample denoiser guide data.
     ref<Buffer>                     mpSampleNRDRadiance;        ///< Compact per-sample NRD radiance data.
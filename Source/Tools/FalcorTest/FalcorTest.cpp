@@ -45,7 +45,7 @@ int runMain(int argc, char** argv)
     parser.helpParams.programName = "FalcorTest";
     args::HelpFlag helpFlag(parser, "help", "Display this help menu.", {'h', "help"});
     args::ValueFlag<uint32_t> parallelFlag(parser, "N", "EXPERIMENTAL: Number of worker threads (default: 1).", {'p', "parallel"});
-    args::ValueFlag<std::string> deviceTypeFlag(parser, "d3d12|vulkan", "Graphics device type.", {'d', "device-type"});
+    args::ValueFlag<std::string> deviceTypeFlag(parser, "d3d12|vulkan|cpu", "Graphics device type.", {'d', "device-type"});
     args::Flag listGPUsFlag(parser, "", "List available GPUs", {"list-gpus"});
     args::ValueFlag<uint32_t> gpuFlag(parser, "index", "Select specific GPU to use", {"gpu"});
     args::Flag listTestSuites(parser, "", "List test suites", {"list-test-suites"});
@@ -56,6 +56,17 @@ int runMain(int argc, char** argv)
     args::ValueFlag<std::string> tagFilterFlag(parser, "tags", "Filter test cases by tags.", {'t', "tags"});
     args::ValueFlag<std::string> xmlReportFlag(parser, "path", "XML report output file.", {'x', "xml-report"});
     args::ValueFlag<uint32_t> repeatFlag(parser, "N", "Number of times to repeat the test.", {'r', "repeat"});
+    args::Flag benchmarkFlag(parser, "", "Run benchmarks instead of tests.", {'b', "benchmark"});
+    args::ValueFlag<std::string> benchmarkReportFlag(parser, "path", "Benchmark JSON report output file.", {"benchmark-report"});
+    args::ValueFlag<std::string> benchmarkBaselineFlag(
+        parser, "path", "Benchmark JSON report to compare against. Regressions are reported as failures.", {"benchmark-baseline"}
+    );
+    args::ValueFlag<double> benchmarkThresholdFlag(
+        parser, "ratio", "Relative slowdown over the baseline that is reported as a regression (default: 0.1).", {"benchmark-threshold"}
+    );
+    args::ValueFlag<double> benchmarkTimeFlag(
+        parser, "ms", "Time limit for sampling a single benchmark measurement (default: 2000).", {"benchmark-time"}
+    );
     args::Flag enableDebugLayerFlag(parser, "", "Enable debug layer (enabled by default in Debug build).", {"enable-debug-layer"});
     args::Flag enableAftermathFlag(parser, "", "Enable Aftermath GPU crash dump.", {"enable-aftermath"});
 
@@ -96,9 +107,11 @@ int runMain(int argc, char** argv)
             options.deviceDesc.type = Device::Type::D3D12;
         else if (args::get(deviceTypeFlag) == "vulkan")
             options.deviceDesc.type = Device::Type::Vulkan;
+        else if (args::get(deviceTypeFlag) == "cpu")
+            options.deviceDesc.type = Device::Type::CPU;
         else
         {
-            std::cerr << "Invalid device type, use 'd3d12' or 'vulkan'" << std::endl;
+            std::cerr << "Invalid device type, use 'd3d12', 'vulkan' or 'cpu'" << std::endl;
             return 1;
         }
     }
@@ -129,11 +142,23 @@ int runMain(int argc, char** argv)
         options.parallel = args::get(parallelFlag);
     if (repeatFlag)
         options.repeat = args::get(repeatFlag);
+    if (benchmarkFlag)
+        options.benchmark = true;
+    if (benchmarkReportFlag)
+        options.benchmarkOptions.reportPath = args::get(benchmarkReportFlag);
+    if (benchmarkBaselineFlag)
+        options.benchmarkOptions.baselinePath = args::get(benchmarkBaselineFlag);
+    if (benchmarkThresholdFlag)
+        options.benchmarkOptions.regressionThreshold = args::get(benchmarkThresholdFlag);
+    if (benchmarkTimeFlag)
+        options.benchmarkOptions.maxTimeMS = args::get(benchmarkTimeFlag);
 
     if (listTestSuites || listTestCases || listTags)
     {
         std::vector<unittest::Test> tests = unittest::enumerateTests();
-        tests = unittest::filterTests(tests, options.testSuiteFilter, options.testCaseFilter, options.tagFilter, options.deviceDesc.type);
+        tests = unittest::filterTests(
+            tests, options.testSuiteFilter, options.testCaseFilter, options.tagFilter, options.deviceDesc.type, options.benchmark
+        );
 
         if (listTestSuites)
         {
@@ -0,0 +1,102 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Core/Pass/ComputePass.h"
+
+namespace Falcor
+{
+GPU_TEST(CPUDeviceFeatures, Device::Type::CPU)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    EXPECT(pDevice->getType() == Device::Type::CPU);
+    EXPECT(!pDevice->isFeatureSupported(Device::SupportedFeatures::Rasterization));
+    EXPECT(!pDevice->isFeatureSupported(Device::SupportedFeatures::Raytracing));
+}
+
+GPU_TEST(CPUDeviceDispatch, Device::Type::CPU)
+{
+    // Use enough groups for the dispatch to be split into multiple tasks, and a partial last row of groups.
+    const uint3 dispatchSize = {1000, 7, 3};
+    const uint32_t elemCount = dispatchSize.x * dispatchSize.y * dispatchSize.z;
+
+    std::vector<uint32_t> initData(elemCount);
+    for (uint32_t i = 0; i < elemCount; i++)
+        initData[i] = i * 3;
+
+    ctx.createProgram("Tests/Core/CPUDeviceTests.cs.slang", "main");
+    ctx["CB"]["dispatchSize"] = dispatchSize;
+    ctx["CB"]["scale"] = 5u;
+    ctx.allocateStructuredBuffer("input", elemCount, initData.data(), initData.size() * sizeof(uint32_t));
+    ctx.allocateStructuredBuffer("result", elemCount);
+    ctx.runProgram(dispatchSize);
+
+    std::vector<uint32_t> result = ctx.readBuffer<uint32_t>("result");
+    for (uint32_t i = 0; i < elemCount; i++)
+        EXPECT_EQ(result[i], initData[i] * 5 + 1) << "i = " << i;
+
+    // Run a second dispatch with new parameters to make sure they are picked up.
+    ctx["CB"]["scale"] = 2u;
+    ctx.allocateStructuredBuffer("input", elemCount, result.data(), result.size() * sizeof(uint32_t));
+    ctx.runProgram(dispatchSize);
+
+    std::vector<uint32_t> result2 = ctx.readBuffer<uint32_t>("result");
+    for (uint32_t i = 0; i < elemCount; i++)
+        EXPECT_EQ(result2[i], result[i] * 2 + 1) << "i = " << i;
+}
+
+GPU_TEST(CPUDeviceTextures, Device::Type::CPU)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    // Use a size that is not a multiple of the group size.
+    const uint2 dim = {37, 21};
+    std::vector<float4> initData(dim.x * dim.y);
+    for (uint32_t i = 0; i < initData.size(); i++)
+        initData[i] = float4(i, i + 1, i * 2, 7);
+
+    ref<Texture> pInput =
+        pDevice->createTexture2D(dim.x, dim.y, ResourceFormat::RGBA32Float, 1, 1, initData.data(), ResourceBindFlags::ShaderResource);
+    ref<Texture> pResult =
+        pDevice->createTexture2D(dim.x, dim.y, ResourceFormat::RGBA32Float, 1, 1, nullptr, ResourceBindFlags::UnorderedAccess);
+
+    ref<ComputePass> pPass = ComputePass::create(pDevice, "Tests/Core/CPUDeviceTests.cs.slang", "scaleTexture");
+    auto var = pPass->getRootVar();
+    var["CB"]["dispatchSize"] = uint3(dim, 1);
+    var["CB"]["scale"] = 3u;
+    var["inputTex"] = pInput;
+    var["resultTex"] = pResult;
+    pPass->execute(ctx.getRenderContext(), uint3(dim, 1));
+
+    std::vector<uint8_t> data = ctx.getRenderContext()->readTextureSubresource(pResult.get(), 0);
+    ASSERT_EQ(data.size(), initData.size() * sizeof(float4));
+    const float4* result = reinterpret_cast<const float4*>(data.data());
+    for (uint32_t i = 0; i < initData.size(); i++)
+        EXPECT_EQ(result[i], initData[i] * 3.f + 1.f) << "i = " << i;
+}
+} // namespace Falcor
@@ -27,6 +27,8 @@
  **************************************************************************/
 #include "Testing/UnitTest.h"
 #include "Core/Plugin.h"
+#include <nlohmann/json.hpp>
+#include <fstream>
 
 namespace Falcor
 {
@@ -38,6 +40,12 @@ public:
     struct PluginInfo
     {
         std::string desc;
+
+        template<typename Archive>
+        void serialize(Archive& ar)
+        {
+            ar("desc", desc);
+        }
     };
 
     using PluginCreate = std::function<std::shared_ptr<PluginBaseA>(const std::string&)>;
@@ -221,4 +229,52 @@ CPU_TEST(Plugin)
     }
 }
 
+CPU_TEST(PluginManifest)
+{
+    PluginManager pm;
+
+    // Write a manifest advertising classes in an existing and a missing plugin library.
+    // Note: The manifest is typically generated at build time by the PluginManifest tool.
+    const auto path = std::filesystem::temp_directory_path() / "FalcorPluginManifestTest.json";
+    {
+        nlohmann::json json = {
+            {"version", 1},
+            {"libraries",
+             {
+                 {{"name", "DebugPasses"},
+                  {"classes",
+                   {
+                       {{"base", "PluginBaseA"}, {"type", "LazyPluginA"}, {"info", {{"desc", "This is LazyPluginA"}}}},
+                       {{"base", "PluginBaseB"}, {"type", "LazyPluginB"}},
+                   }}},
+                 {{"name", "MissingPluginLibrary"}, {"classes", {{{"base", "PluginBaseA"}, {"type", "MissingPluginA"}}}}},
+             }},
+        };
+        std::ofstream(path) << json.dump();
+    }
+
+    EXPECT(!pm.loadManifest(std::filesystem::temp_directory_path() / "FalcorPluginManifestTestMissing.json"));
+    EXPECT(pm.loadManifest(path));
+    std::filesystem::remove(path);
+
+    // Classes listed in the manifest are available without loading their library.
+    EXPECT(pm.hasClass<PluginBaseA>("LazyPluginA"));
+    EXPECT(pm.hasClass<PluginBaseB>("LazyPluginB"));
+    EXPECT(!pm.hasClass<PluginBaseB>("LazyPluginA"));
+    EXPECT(!pm.hasClass<PluginBaseA>("MissingPluginA"));
+
+    // Serializable infos are read from the manifest and merged with registered classes.
+    {
+        PluginRegistry registry(pm, 0);
+        registry.registerClass<PluginBaseA, PluginA1>();
+    }
+
+    auto infos = pm.getInfos<PluginBaseA>();
+    ASSERT_EQ(infos.size(), 2);
+    EXPECT_EQ(infos[0].first, "LazyPluginA");
+    EXPECT_EQ(infos[0].second.desc, "This is LazyPluginA");
+    EXPECT_EQ(infos[1].first, "PluginA1");
+    EXPECT_EQ(infos[1].second.desc, "This is PluginA1");
+}
+
 } // namespace Falcor
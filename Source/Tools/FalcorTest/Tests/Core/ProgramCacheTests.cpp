@@ -0,0 +1,191 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Core/Program/ProgramCache.h"
+#include "Core/Program/ProgramManager.h"
+#include <fstream>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+const std::filesystem::path kTestDirectory = std::filesystem::temp_directory_path() / "FalcorProgramCacheTest";
+
+void writeFile(const std::filesystem::path& path, const std::string& content)
+{
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    stream << content;
+}
+
+uint32_t jenkinsHash(uint32_t a)
+{
+    a = (a + 0x7ed55d16) + (a << 12);
+    a = (a ^ 0xc761c23c) ^ (a >> 19);
+    a = (a + 0x165667b1) + (a << 5);
+    a = (a + 0xd3a2646c) ^ (a << 9);
+    a = (a + 0xfd7046c5) + (a << 3);
+    a = (a ^ 0xb55a4f09) ^ (a >> 16);
+    return a;
+}
+} // namespace
+
+CPU_TEST(ProgramCache_StoreLoad)
+{
+    std::filesystem::remove_all(kTestDirectory);
+    std::filesystem::create_directories(kTestDirectory);
+    const auto sourcePath = kTestDirectory / "Module.slang";
+    writeFile(sourcePath, "void foo() {}");
+
+    ProgramCache cache(kTestDirectory / "cache");
+    ProgramCache::Key key = SHA1::compute("key", 3);
+    EXPECT(!cache.load(key).has_value());
+
+    ProgramCache::Entry entry;
+    entry.modules.push_back({"Imported", "Imported.slang", {1, 2, 3}});
+    entry.modules.push_back({"Module", sourcePath.string(), {4, 5}});
+    entry.shaderModuleIndices = {1};
+    entry.dependencies = {sourcePath};
+    entry.compileTime = 1.5;
+    cache.store(key, entry);
+
+    auto loaded = cache.load(key);
+    ASSERT(loaded.has_value());
+    ASSERT_EQ(loaded->modules.size(), 2u);
+    EXPECT_EQ(loaded->modules[0].name, "Imported");
+    EXPECT_EQ(loaded->modules[0].path, "Imported.slang");
+    EXPECT(loaded->modules[0].ir == std::vector<uint8_t>({1, 2, 3}));
+    EXPECT_EQ(loaded->modules[1].name, "Module");
+    EXPECT(loaded->modules[1].ir == std::vector<uint8_t>({4, 5}));
+    EXPECT(loaded->shaderModuleIndices == std::vector<uint32_t>({1}));
+    ASSERT_EQ(loaded->dependencies.size(), 1u);
+    EXPECT(loaded->dependencies[0] == sourcePath);
+    EXPECT_EQ(loaded->compileTime, 1.5);
+
+    // Entries are persistent.
+    ProgramCache cache2(kTestDirectory / "cache");
+    EXPECT(cache2.load(key).has_value());
+
+    // Other keys miss.
+    EXPECT(!cache.load(SHA1::compute("other", 5)).has_value());
+
+    cache.clear();
+    EXPECT(!cache.load(key).has_value());
+
+    std::filesystem::remove_all(kTestDirectory);
+}
+
+CPU_TEST(ProgramCache_Invalidation)
+{
+    std::filesystem::remove_all(kTestDirectory);
+    std::filesystem::create_directories(kTestDirectory);
+    const auto sourcePath = kTestDirectory / "Module.slang";
+    writeFile(sourcePath, "void foo() {}");
+
+    ProgramCache cache(kTestDirectory / "cache");
+    ProgramCache::Key key = SHA1::compute("key", 3);
+    ProgramCache::Entry entry;
+    entry.modules.push_back({"Module", sourcePath.string(), {1}});
+    entry.shaderModuleIndices = {0};
+    entry.dependencies = {sourcePath};
+    cache.store(key, entry);
+    EXPECT(cache.load(key).has_value());
+
+    // Touching a dependency without changing its content keeps the entry valid.
+    std::filesystem::last_write_time(sourcePath, std::filesystem::last_write_time(sourcePath) + std::chrono::seconds(2));
+    EXPECT(cache.load(key).has_value());
+
+    // Changing the content of a dependency invalidates the entry.
+    writeFile(sourcePath, "void bar() {}");
+    std::filesystem::last_write_time(sourcePath, std::filesystem::last_write_time(sourcePath) + std::chrono::seconds(4));
+    EXPECT(!cache.load(key).has_value());
+
+    // Removing a dependency invalidates the entry.
+    cache.store(key, entry);
+    EXPECT(cache.load(key).has_value());
+    std::filesystem::remove(sourcePath);
+    EXPECT(!cache.load(key).has_value());
+
+    std::filesystem::remove_all(kTestDirectory);
+}
+
+CPU_TEST(ProgramCache_CorruptEntry)
+{
+    std::filesystem::remove_all(kTestDirectory);
+    std::filesystem::create_directories(kTestDirectory);
+
+    ProgramCache cache(kTestDirectory / "cache");
+    ProgramCache::Key key = SHA1::compute("key", 3);
+    ProgramCache::Entry entry;
+    entry.modules.push_back({"Module", "", std::vector<uint8_t>(100, 7)});
+    entry.shaderModuleIndices = {0};
+    cache.store(key, entry);
+    EXPECT(cache.load(key).has_value());
+
+    // Truncate the entry file.
+    for (const auto& file : std::filesystem::directory_iterator(kTestDirectory / "cache"))
+        std::filesystem::resize_file(file.path(), 50);
+    EXPECT(!cache.load(key).has_value());
+
+    std::filesystem::remove_all(kTestDirectory);
+}
+
+GPU_TEST(ProgramCache_Reuse)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    ProgramManager* pProgramManager = pDevice->getProgramManager();
+    if (!pProgramManager->getProgramCache())
+        ctx.skip("Program cache is disabled");
+
+    const uint32_t kElementCount = 256;
+    ref<Buffer> pResultBuffer = pDevice->createStructuredBuffer(sizeof(uint32_t), kElementCount, ResourceBindFlags::UnorderedAccess);
+
+    // Use a random define, so the first compilation misses the cache even if the test was run before.
+    const uint32_t offset = std::random_device{}() % 1000000;
+    DefineList defines = {{"OFFSET", std::to_string(offset)}};
+
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        const auto stats = pProgramManager->getCompilationStats();
+
+        ctx.createProgram("Tests/Core/ProgramCacheTests.cs.slang", "main", defines);
+        ctx["result"] = pResultBuffer;
+        ctx.runProgram(kElementCount, 1, 1);
+
+        const auto& newStats = pProgramManager->getCompilationStats();
+        if (i == 0)
+            EXPECT_EQ(newStats.programCacheMissCount, stats.programCacheMissCount + 1);
+        else
+            EXPECT_EQ(newStats.programCacheHitCount, stats.programCacheHitCount + 1);
+
+        std::vector<uint32_t> result = pResultBuffer->getElements<uint32_t>();
+        for (uint32_t j = 0; j < kElementCount; ++j)
+            EXPECT_EQ(result[j], jenkinsHash(j) + offset) << "j = " << j;
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,94 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Core/Pass/ComputePass.h"
+#include "Core/Program/ProgramManager.h"
+
+namespace Falcor
+{
+namespace
+{
+const char kShaderFile[] = "Tests/Core/ProgramPrewarmTests.cs.slang";
+const uint32_t kElementCount = 256;
+
+uint32_t evalReference(const std::string& entryPoint, uint32_t i, uint32_t offset)
+{
+    return entryPoint == "add" ? i + offset : i * offset;
+}
+} // namespace
+
+GPU_TEST(ProgramPrewarm, DEVICE_TYPES(Device::Type::D3D12, Device::Type::Vulkan, Device::Type::CPU))
+{
+    ref<Device> pDevice = ctx.getDevice();
+    ProgramManager* pProgramManager = pDevice->getProgramManager();
+
+    ref<Buffer> pResultBuffer = pDevice->createStructuredBuffer(sizeof(uint32_t), kElementCount, ResourceBindFlags::UnorderedAccess);
+
+    // Request two versions for each of two programs.
+    const std::vector<std::string> entryPoints = {"add", "mul"};
+    const std::vector<uint32_t> offsets = {3, 7};
+
+    std::vector<ref<ComputePass>> passes;
+    std::vector<ProgramVersionRequest> requests;
+    for (const auto& entryPoint : entryPoints)
+    {
+        passes.push_back(ComputePass::create(pDevice, kShaderFile, entryPoint, DefineList(), false));
+        for (uint32_t offset : offsets)
+            requests.push_back({passes.back()->getProgram(), {{"OFFSET", std::to_string(offset)}}});
+    }
+
+    auto stats = pProgramManager->getCompilationStats();
+    pProgramManager->prewarmPrograms(requests);
+    EXPECT_EQ(pProgramManager->getCompilationStats().programPrewarmCount, stats.programPrewarmCount + 4);
+    EXPECT_EQ(pProgramManager->getCompilationStats().programVersionCount, stats.programVersionCount + 4);
+    EXPECT_EQ(pProgramManager->getCompilationStats().programKernelsCount, stats.programKernelsCount + 4);
+
+    // Prewarming existing versions is a no-op.
+    stats = pProgramManager->getCompilationStats();
+    pProgramManager->prewarmPrograms(requests);
+    EXPECT_EQ(pProgramManager->getCompilationStats().programPrewarmCount, stats.programPrewarmCount);
+
+    // Running the programs uses the prewarmed versions and kernels without compiling.
+    for (size_t i = 0; i < entryPoints.size(); ++i)
+    {
+        for (uint32_t offset : offsets)
+        {
+            passes[i]->addDefine("OFFSET", std::to_string(offset));
+            passes[i]->setVars(nullptr);
+            passes[i]->getRootVar()["result"] = pResultBuffer;
+            passes[i]->execute(ctx.getRenderContext(), kElementCount, 1, 1);
+
+            std::vector<uint32_t> result = pResultBuffer->getElements<uint32_t>();
+            for (uint32_t j = 0; j < kElementCount; ++j)
+                EXPECT_EQ(result[j], evalReference(entryPoints[i], j, offset)) << "entryPoint = " << entryPoints[i] << ", j = " << j;
+        }
+    }
+    EXPECT_EQ(pProgramManager->getCompilationStats().programVersionCount, stats.programVersionCount);
+    EXPECT_EQ(pProgramManager->getCompilationStats().programKernelsCount, stats.programKernelsCount);
+}
+} // namespace Falcor
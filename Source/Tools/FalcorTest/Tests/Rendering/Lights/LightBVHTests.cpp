@@ -0,0 +1,294 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Scene.h"
+#include "Scene/SceneBuilder.h"
+#include "Scene/Material/StandardMaterial.h"
+#include "Rendering/Lights/LightBVH.h"
+#include "Rendering/Lights/LightBVHBuilder.h"
+#include <algorithm>
+#include <cstring>
+
+namespace Falcor
+{
+namespace
+{
+/// Number of quad lights along each side of the grid.
+const uint32_t kGridSize = 16;
+const uint32_t kLightCount = kGridSize * kGridSize;
+
+/// Exposes the internal data of the BVH for validation.
+class TestLightBVH : public LightBVH
+{
+public:
+    using LightBVH::LightBVH;
+
+    const std::vector<PackedNode>& getNodes() const
+    {
+        syncDataToCPU();
+        return mNodes;
+    }
+    const std::vector<uint32_t>& getTriangleIndices() const { return mTriangleIndices; }
+    const std::vector<uint64_t>& getTriangleBitmasks() const { return mTriangleBitmasks; }
+    const std::vector<uint32_t>& getTriangleLeafIndices() const { return mTriangleLeafIndices; }
+};
+
+float4x4 getGridTransform(uint32_t i)
+{
+    return math::matrixFromTranslation(float3(2.f * (i % kGridSize), 0.f, 2.f * (i / kGridSize)) - float3(kGridSize - 1.f, 0.f, kGridSize - 1.f));
+}
+
+/**
+ * Build a grid of quad lights. Each light is a separate dynamic mesh, so that it is not pretransformed and can be moved.
+ * Light i is scene graph node i. Node kLightCount is a light with a single degenerate triangle, which is culled from the BVH.
+ */
+ref<Scene> buildLightGridScene(ref<Device> pDevice)
+{
+    SceneBuilder builder(pDevice, Settings(), SceneBuilder::Flags::DontOptimizeGraph);
+    ref<StandardMaterial> pMaterial = StandardMaterial::create(pDevice, "Emissive");
+    pMaterial->setEmissiveColor(float3(1.f));
+
+    auto addLight = [&](const ref<TriangleMesh>& pMesh, const std::string& name, const float4x4& transform)
+    {
+        NodeID nodeID = builder.addNode(SceneBuilder::Node{name, transform, float4x4::identity()});
+        builder.addMeshInstance(nodeID, builder.addTriangleMesh(pMesh, pMaterial, true));
+    };
+
+    for (uint32_t i = 0; i < kLightCount; ++i)
+        addLight(TriangleMesh::createQuad(float2(0.5f)), "Light" + std::to_string(i), getGridTransform(i));
+    addLight(TriangleMesh::createDummy(), "CulledLight", float4x4::identity());
+
+    return builder.getScene();
+}
+
+/// Move a light to a new location in the grid, raised and tilted. The move takes effect on the next scene update.
+void moveLight(Scene& scene, uint32_t lightIndex, uint32_t gridIndex)
+{
+    float4x4 transform = mul(getGridTransform(gridIndex), mul(math::matrixFromTranslation(float3(0.f, 1.f, 0.f)), math::matrixFromRotationX(0.5f)));
+    scene.updateNodeTransform(lightIndex, transform);
+}
+
+/// Returns the global indices of the triangles of the mesh lights updated by the last scene update.
+std::vector<uint32_t> getUpdatedTriangles(const LightCollection& lightCollection)
+{
+    std::vector<uint32_t> triangles;
+    for (uint32_t lightIdx : lightCollection.getUpdatedLights())
+    {
+        const MeshLightData& meshLight = lightCollection.getMeshLights()[lightIdx];
+        for (uint32_t i = 0; i < meshLight.triangleCount; ++i)
+            triangles.push_back(meshLight.triangleOffset + i);
+    }
+    return triangles;
+}
+
+bool isEqual(const std::vector<PackedNode>& a, const std::vector<PackedNode>& b)
+{
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(PackedNode)) == 0;
+}
+
+/// Compare the bounds and flux of two nodes. The node extents are stored in half precision.
+bool isClose(const PackedNode& a, const PackedNode& b)
+{
+    auto isCloseFloat = [](float x, float y) { return std::abs(x - y) <= 1e-3f * std::max({1.f, std::abs(x), std::abs(y)}); };
+
+    SharedNodeAttributes attribsA = a.getNodeAttributes();
+    SharedNodeAttributes attribsB = b.getNodeAttributes();
+    float3 minA, maxA, minB, maxB;
+    attribsA.getAABB(minA, maxA);
+    attribsB.getAABB(minB, maxB);
+
+    for (int k = 0; k < 3; ++k)
+    {
+        if (!isCloseFloat(minA[k], minB[k]) || !isCloseFloat(maxA[k], maxB[k]))
+            return false;
+    }
+    return isCloseFloat(attribsA.flux, attribsB.flux);
+}
+
+/// Check that each non-culled triangle is referenced by a single leaf, which its traversal bitmask leads to.
+void validateTopology(GPUUnitTestContext& ctx, const TestLightBVH& bvh)
+{
+    const auto& nodes = bvh.getNodes();
+    const auto& triangleIndices = bvh.getTriangleIndices();
+    const auto& bitmasks = bvh.getTriangleBitmasks();
+    const auto& leafIndices = bvh.getTriangleLeafIndices();
+
+    uint32_t referencedTriangleCount = 0;
+    for (uint32_t nodeIndex = 0; nodeIndex < nodes.size(); ++nodeIndex)
+    {
+        if (!nodes[nodeIndex].isLeaf())
+            continue;
+
+        const LeafNode leaf = nodes[nodeIndex].getLeafNode();
+        for (uint32_t j = leaf.triangleOffset; j < leaf.triangleOffset + leaf.triangleCount; ++j)
+        {
+            const uint32_t triangleIndex = triangleIndices[j];
+            EXPECT_EQ(leafIndices[triangleIndex], nodeIndex);
+
+            uint32_t traversedIndex = 0;
+            for (uint32_t depth = 0; !nodes[traversedIndex].isLeaf(); ++depth)
+            {
+                const bool right = (bitmasks[triangleIndex] >> depth) & 1;
+                traversedIndex = right ? nodes[traversedIndex].getInternalNode().rightChildIdx : traversedIndex + 1;
+            }
+            EXPECT_EQ(traversedIndex, nodeIndex) << "triangle " << triangleIndex;
+            ++referencedTriangleCount;
+        }
+    }
+    EXPECT_EQ(referencedTriangleCount, triangleIndices.size());
+}
+} // namespace
+
+GPU_TEST(LightBVH_PartialRefit)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    RenderContext* pRenderContext = pDevice->getRenderContext();
+
+    ref<Scene> pScene = buildLightGridScene(pDevice);
+    ref<LightCollection> pLightCollection = pScene->getLightCollection(pRenderContext);
+    pScene->update(pRenderContext, 0.0);
+
+    LightBVHBuilder builder(LightBVHBuilder::Options{});
+    TestLightBVH partial(pDevice, pLightCollection);
+    TestLightBVH full(pDevice, pLightCollection);
+    builder.build(pRenderContext, partial);
+    builder.build(pRenderContext, full);
+    ASSERT(partial.isValid());
+    ASSERT_GE(partial.getStats().treeHeight, 3);
+
+    // Refit both BVHs once, so that the nodes untouched by the partial refit hold GPU-computed values as well.
+    partial.refit(pRenderContext);
+    full.refit(pRenderContext);
+    const std::vector<PackedNode> initialNodes = partial.getNodes();
+    EXPECT(isEqual(initialNodes, full.getNodes()));
+
+    // Move a few lights. Only the leaves referencing their triangles and the ancestors are refit.
+    const uint32_t movedLights[] = {0, 17, 130, kLightCount - 1};
+    for (uint32_t i : movedLights)
+        moveLight(*pScene, i, i);
+    pScene->update(pRenderContext, 0.0);
+
+    EXPECT_EQ(pLightCollection->getUpdatedLights().size(), std::size(movedLights));
+    const std::vector<uint32_t> updatedTriangles = getUpdatedTriangles(*pLightCollection);
+
+    partial.resetRefitStats();
+    full.resetRefitStats();
+    partial.refit(pRenderContext, updatedTriangles);
+    full.refit(pRenderContext);
+
+    const auto& partialStats = partial.getRefitStats();
+    EXPECT_GT(partialStats.leafNodeCount, 0);
+    EXPECT_LE(partialStats.leafNodeCount, 2 * std::size(movedLights));
+    EXPECT_LT(partialStats.leafNodeCount + partialStats.internalNodeCount, full.getRefitStats().leafNodeCount + full.getRefitStats().internalNodeCount);
+    EXPECT(!isEqual(partial.getNodes(), initialNodes));
+    EXPECT(isEqual(partial.getNodes(), full.getNodes()));
+
+    // Moving a light whose triangles are all culled from the BVH doesn't refit anything.
+    const std::vector<PackedNode> refitNodes = partial.getNodes();
+    pScene->updateNodeTransform(kLightCount, math::matrixFromTranslation(float3(1.f)));
+    pScene->update(pRenderContext, 0.0);
+
+    const std::vector<uint32_t> culledTriangles = getUpdatedTriangles(*pLightCollection);
+    ASSERT_EQ(culledTriangles.size(), 1);
+    EXPECT_EQ(partial.getTriangleLeafIndices()[culledTriangles[0]], LightBVH::kInvalidIndex);
+
+    partial.resetRefitStats();
+    partial.refit(pRenderContext, culledTriangles);
+    EXPECT_EQ(partial.getRefitStats().leafNodeCount, 0);
+    EXPECT_EQ(partial.getRefitStats().internalNodeCount, 0);
+    EXPECT(isEqual(partial.getNodes(), refitNodes));
+}
+
+GPU_TEST(LightBVH_SubtreeRebuild)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    RenderContext* pRenderContext = pDevice->getRenderContext();
+
+    ref<Scene> pScene = buildLightGridScene(pDevice);
+    ref<LightCollection> pLightCollection = pScene->getLightCollection(pRenderContext);
+    pScene->update(pRenderContext, 0.0);
+
+    LightBVHBuilder builder(LightBVHBuilder::Options{});
+    TestLightBVH bvh(pDevice, pLightCollection);
+    builder.build(pRenderContext, bvh);
+    ASSERT(bvh.isValid());
+    ASSERT_GE(bvh.getStats().treeHeight, 3);
+
+    std::vector<uint32_t> sortedTriangleIndices = bvh.getTriangleIndices();
+    std::sort(sortedTriangleIndices.begin(), sortedTriangleIndices.end());
+
+    // Swap lights across the grid, which degrades the subtrees they belong to, and refit the affected nodes.
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        moveLight(*pScene, i, kLightCount - 1 - i);
+        moveLight(*pScene, kLightCount - 1 - i, i);
+    }
+    pScene->update(pRenderContext, 0.0);
+    bvh.refit(pRenderContext, getUpdatedTriangles(*pLightCollection));
+
+    // Force the rebuild of an internal node at depth 2.
+    uint32_t subtreeIndex = LightBVH::kInvalidIndex;
+    bvh.traverseBVH(
+        [&](const LightBVH::NodeLocation& location)
+        {
+            if (location.depth < 2)
+                return true;
+            subtreeIndex = location.nodeIndex;
+            return false;
+        },
+        [](const LightBVH::NodeLocation&) { return true; }
+    );
+    ASSERT_NE(subtreeIndex, LightBVH::kInvalidIndex);
+
+    bvh.resetRefitStats();
+    builder.rebuildSubtrees(pRenderContext, bvh, {subtreeIndex});
+    EXPECT_EQ(bvh.getRefitStats().rebuiltSubtreeCount, 1);
+    EXPECT_GT(bvh.getRefitStats().rebuiltNodeCount, 1);
+
+    // The rebuilt BVH references the same triangles and is consistent.
+    std::vector<uint32_t> rebuiltTriangleIndices = bvh.getTriangleIndices();
+    std::sort(rebuiltTriangleIndices.begin(), rebuiltTriangleIndices.end());
+    EXPECT(rebuiltTriangleIndices == sortedTriangleIndices);
+    EXPECT_EQ(bvh.getNodes().size(), bvh.getStats().internalNodeCount + bvh.getStats().leafNodeCount);
+    validateTopology(ctx, bvh);
+
+    // The rebuilt nodes and their ancestors match a full refit of the new hierarchy.
+    const std::vector<PackedNode> rebuiltNodes = bvh.getNodes();
+    bvh.refit(pRenderContext);
+    const auto& refitNodes = bvh.getNodes();
+    ASSERT_EQ(rebuiltNodes.size(), refitNodes.size());
+    for (size_t i = 0; i < rebuiltNodes.size(); ++i)
+        EXPECT(isClose(rebuiltNodes[i], refitNodes[i])) << "node " << i;
+
+    // The root matches a BVH built from scratch.
+    TestLightBVH reference(pDevice, pLightCollection);
+    builder.build(pRenderContext, reference);
+    EXPECT(isClose(refitNodes[0], reference.getNodes()[0]));
+    EXPECT_EQ(reference.getStats().triangleCount, bvh.getStats().triangleCount);
+}
+} // namespace Falcor
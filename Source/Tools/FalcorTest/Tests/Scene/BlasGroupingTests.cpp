@@ -0,0 +1,240 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/BlasGrouping.h"
+
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+using Policy = BlasGrouping::Policy;
+
+BlasGrouping::Result computeGroups(const std::vector<BlasGrouping::BlasInfo>& blases, Policy policy, uint64_t maxGroupByteSize, float compactionRatio = 1.f)
+{
+    BlasGrouping::Options options;
+    options.policy = policy;
+    options.maxGroupByteSize = maxGroupByteSize;
+    options.compactionRatio = compactionRatio;
+    return BlasGrouping::compute(blases, options);
+}
+
+/// Validate that every BLAS is placed exactly once and that the buffer layout is consistent.
+void validateGroups(CPUUnitTestContext& ctx, const std::vector<BlasGrouping::BlasInfo>& blases, const BlasGrouping::Result& result, uint64_t maxGroupByteSize)
+{
+    ASSERT_EQ(result.groupIndices.size(), blases.size());
+    ASSERT_EQ(result.resultByteOffsets.size(), blases.size());
+    ASSERT_EQ(result.scratchByteOffsets.size(), blases.size());
+
+    std::vector<uint32_t> placed(blases.size(), 0);
+    uint64_t resultBufferByteSize = 0;
+    uint64_t scratchBufferByteSize = 0;
+    uint64_t finalByteSize = 0;
+
+    for (uint32_t groupIndex = 0; groupIndex < result.groups.size(); groupIndex++)
+    {
+        const auto& group = result.groups[groupIndex];
+        ASSERT(!group.blasIndices.empty());
+        EXPECT(group.blasIndices.size() == 1 || group.getByteSize() <= maxGroupByteSize) << "group " << groupIndex;
+
+        uint64_t resultByteOffset = 0;
+        uint64_t dedicatedScratchByteOffset = 0;
+        for (size_t i = 0; i < group.blasIndices.size(); i++)
+        {
+            uint32_t blasIndex = group.blasIndices[i];
+            ASSERT_LT(blasIndex, blases.size());
+            if (i > 0) EXPECT_LT(group.blasIndices[i - 1], blasIndex);
+            placed[blasIndex]++;
+
+            const auto& blas = blases[blasIndex];
+            EXPECT_EQ(result.groupIndices[blasIndex], groupIndex);
+            EXPECT_EQ(result.resultByteOffsets[blasIndex], resultByteOffset);
+            resultByteOffset += blas.resultByteSize;
+
+            // Updated BLASes have dedicated scratch regions, the others share the start of the scratch buffer.
+            uint64_t expectedScratchByteOffset = blas.isUpdated ? dedicatedScratchByteOffset : 0;
+            EXPECT_EQ(result.scratchByteOffsets[blasIndex], expectedScratchByteOffset);
+            EXPECT_LE(result.scratchByteOffsets[blasIndex] + blas.scratchByteSize, group.scratchByteSize);
+            if (blas.isUpdated) dedicatedScratchByteOffset += blas.scratchByteSize;
+        }
+        EXPECT_EQ(resultByteOffset, group.resultByteSize);
+
+        resultBufferByteSize = std::max(resultBufferByteSize, group.resultByteSize);
+        scratchBufferByteSize = std::max(scratchBufferByteSize, group.scratchByteSize);
+        finalByteSize += group.finalByteSize;
+    }
+
+    for (size_t i = 0; i < blases.size(); i++)
+        EXPECT_EQ(placed[i], 1) << "BLAS " << i;
+
+    EXPECT_EQ(result.resultBufferByteSize, resultBufferByteSize);
+    EXPECT_EQ(result.scratchBufferByteSize, scratchBufferByteSize);
+    EXPECT_EQ(result.finalByteSize, finalByteSize);
+    EXPECT_EQ(result.getPeakByteSize(), resultBufferByteSize + scratchBufferByteSize + finalByteSize);
+}
+} // namespace
+
+CPU_TEST(BlasGrouping_Empty)
+{
+    auto result = computeGroups({}, Policy::FirstFitDecreasing, 100);
+    EXPECT(result.groups.empty());
+    EXPECT_EQ(result.getPeakByteSize(), 0);
+}
+
+CPU_TEST(BlasGrouping_FirstFitDecreasing)
+{
+    // Non-compacted BLASes without scratch, each costs twice its result size (intermediate and final).
+    // Group sizes: 50, 60, 40, 50 with a budget of 100.
+    std::vector<BlasGrouping::BlasInfo> blases(4);
+    blases[0].resultByteSize = 25;
+    blases[1].resultByteSize = 30;
+    blases[2].resultByteSize = 20;
+    blases[3].resultByteSize = 25;
+
+    // Sequential grouping yields {0}, {1, 2}, {3}.
+    auto sequential = computeGroups(blases, Policy::Sequential, 100);
+    validateGroups(ctx, blases, sequential, 100);
+    ASSERT_EQ(sequential.groups.size(), 3);
+    EXPECT(sequential.groups[0].blasIndices == std::vector<uint32_t>({0}));
+    EXPECT(sequential.groups[1].blasIndices == std::vector<uint32_t>({1, 2}));
+    EXPECT(sequential.groups[2].blasIndices == std::vector<uint32_t>({3}));
+
+    // First-fit-decreasing yields {1, 2}, {0, 3}.
+    auto ffd = computeGroups(blases, Policy::FirstFitDecreasing, 100);
+    validateGroups(ctx, blases, ffd, 100);
+    ASSERT_EQ(ffd.groups.size(), 2);
+    EXPECT(ffd.groups[0].blasIndices == std::vector<uint32_t>({1, 2}));
+    EXPECT(ffd.groups[1].blasIndices == std::vector<uint32_t>({0, 3}));
+    EXPECT_EQ(ffd.resultBufferByteSize, 50);
+    EXPECT_EQ(ffd.getPeakByteSize(), 150);
+}
+
+CPU_TEST(BlasGrouping_Oversized)
+{
+    // BLASes exceeding the budget are placed in a group of their own.
+    std::vector<BlasGrouping::BlasInfo> blases(3);
+    blases[0].resultByteSize = 10;
+    blases[1].resultByteSize = 200;
+    blases[2].resultByteSize = 10;
+
+    // Sequential grouping cannot place the last BLAS in the first group.
+    auto sequential = computeGroups(blases, Policy::Sequential, 100);
+    validateGroups(ctx, blases, sequential, 100);
+    EXPECT_EQ(sequential.groups.size(), 3);
+
+    auto ffd = computeGroups(blases, Policy::FirstFitDecreasing, 100);
+    validateGroups(ctx, blases, ffd, 100);
+    ASSERT_EQ(ffd.groups.size(), 2);
+    EXPECT(ffd.groups[0].blasIndices == std::vector<uint32_t>({1}));
+    EXPECT(ffd.groups[1].blasIndices == std::vector<uint32_t>({0, 2}));
+}
+
+CPU_TEST(BlasGrouping_ScratchSharing)
+{
+    // Static BLASes share one scratch region, updated BLASes get dedicated regions.
+    std::vector<BlasGrouping::BlasInfo> blases(4);
+    for (auto& blas : blases)
+        blas.resultByteSize = 1;
+    blases[0].scratchByteSize = 30;
+    blases[1].scratchByteSize = 20;
+    blases[2].scratchByteSize = 10;
+    blases[2].isUpdated = true;
+    blases[3].scratchByteSize = 15;
+    blases[3].isUpdated = true;
+
+    auto result = computeGroups(blases, Policy::FirstFitDecreasing, 1000);
+    validateGroups(ctx, blases, result, 1000);
+    ASSERT_EQ(result.groups.size(), 1);
+    EXPECT_EQ(result.scratchBufferByteSize, 30);
+    EXPECT_EQ(result.scratchByteOffsets[0], 0);
+    EXPECT_EQ(result.scratchByteOffsets[1], 0);
+    EXPECT_EQ(result.scratchByteOffsets[2], 0);
+    EXPECT_EQ(result.scratchByteOffsets[3], 10);
+
+    // The dedicated regions determine the size once they exceed the shared region.
+    blases[1].isUpdated = true;
+    result = computeGroups(blases, Policy::FirstFitDecreasing, 1000);
+    validateGroups(ctx, blases, result, 1000);
+    EXPECT_EQ(result.scratchBufferByteSize, 45);
+}
+
+CPU_TEST(BlasGrouping_CompactionRatio)
+{
+    std::vector<BlasGrouping::BlasInfo> blases(6);
+    for (auto& blas : blases)
+    {
+        blas.resultByteSize = 40;
+        blas.scratchByteSize = 10;
+        blas.useCompaction = true;
+    }
+
+    // Without compaction, the group size for two BLASes is 2 * 40 + 10 + 2 * 40.
+    auto uncompacted = computeGroups(blases, Policy::FirstFitDecreasing, 200, 1.f);
+    validateGroups(ctx, blases, uncompacted, 200);
+    EXPECT_EQ(uncompacted.groups.size(), 3);
+    EXPECT_EQ(uncompacted.finalByteSize, 240);
+
+    // With a compaction ratio of 0.25, the group size for three BLASes is 3 * 40 + 10 + 3 * 10.
+    auto compacted = computeGroups(blases, Policy::FirstFitDecreasing, 200, 0.25f);
+    validateGroups(ctx, blases, compacted, 200);
+    EXPECT_EQ(compacted.groups.size(), 2);
+    EXPECT_EQ(compacted.finalByteSize, 60);
+
+    EXPECT_THROW(computeGroups(blases, Policy::FirstFitDecreasing, 200, 1.5f));
+}
+
+CPU_TEST(BlasGrouping_Random)
+{
+    // A few huge BLASes among many small ones, as in large scenes.
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<uint64_t> smallSize(1, 1000);
+    std::uniform_int_distribution<uint64_t> largeSize(100000, 400000);
+    std::uniform_int_distribution<uint32_t> u(0, 99);
+
+    std::vector<BlasGrouping::BlasInfo> blases(2000);
+    for (auto& blas : blases)
+    {
+        bool large = u(rng) < 5;
+        blas.resultByteSize = large ? largeSize(rng) : smallSize(rng);
+        blas.scratchByteSize = blas.resultByteSize / 2 + 1;
+        blas.useCompaction = u(rng) < 80;
+        blas.isUpdated = u(rng) < 10;
+    }
+
+    const uint64_t maxGroupByteSize = 1000000;
+    auto sequential = computeGroups(blases, Policy::Sequential, maxGroupByteSize, 0.5f);
+    validateGroups(ctx, blases, sequential, maxGroupByteSize);
+    auto ffd = computeGroups(blases, Policy::FirstFitDecreasing, maxGroupByteSize, 0.5f);
+    validateGroups(ctx, blases, ffd, maxGroupByteSize);
+
+    EXPECT_LE(ffd.groups.size(), sequential.groups.size());
+    EXPECT_EQ(ffd.finalByteSize, sequential.finalByteSize);
+}
+} // namespace Falcor
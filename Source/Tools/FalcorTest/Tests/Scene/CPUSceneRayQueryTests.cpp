@@ -0,0 +1,327 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/CPUSceneRayQuery.h"
+
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+struct MeshBuffers
+{
+    std::vector<float3> positions;
+    std::vector<uint32_t> indices;
+};
+
+/// Create a unit sphere with the given number of segments around the equator.
+MeshBuffers createSphere(uint32_t segments)
+{
+    MeshBuffers mesh;
+    const uint32_t rings = segments / 2;
+    for (uint32_t r = 0; r <= rings; ++r)
+    {
+        float theta = float(r) / rings * float(M_PI);
+        for (uint32_t s = 0; s <= segments; ++s)
+        {
+            float phi = float(s) / segments * 2.f * float(M_PI);
+            mesh.positions.push_back(float3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)));
+        }
+    }
+    for (uint32_t r = 0; r < rings; ++r)
+    {
+        for (uint32_t s = 0; s < segments; ++s)
+        {
+            uint32_t i = r * (segments + 1) + s;
+            mesh.indices.insert(mesh.indices.end(), {i, i + segments + 1, i + 1});
+            mesh.indices.insert(mesh.indices.end(), {i + 1, i + segments + 1, i + segments + 2});
+        }
+    }
+    return mesh;
+}
+
+/// Create a soup of random triangles in the unit cube.
+MeshBuffers createTriangleSoup(uint32_t triangleCount, std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+    MeshBuffers mesh;
+    for (uint32_t i = 0; i < triangleCount; ++i)
+    {
+        float3 center(u(rng), u(rng), u(rng));
+        for (uint32_t j = 0; j < 3; ++j)
+            mesh.positions.push_back(center + 0.1f * float3(u(rng), u(rng), u(rng)) - 0.05f);
+    }
+    return mesh;
+}
+
+Ray createRandomRay(const AABB& bounds, std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+    float3 origin = bounds.minPoint + bounds.extent() * float3(u(rng), u(rng), u(rng)) * 1.2f - 0.1f * bounds.extent();
+    float3 target = bounds.minPoint + bounds.extent() * float3(u(rng), u(rng), u(rng));
+    return Ray(origin, normalize(target - origin));
+}
+
+/// Reference closest hit by testing all triangles in world space.
+CPUSceneRayQuery::Hit
+referenceClosestHit(const Ray& ray, const std::vector<MeshBuffers>& meshes, const std::vector<CPUSceneRayQuery::InstanceData>& instances)
+{
+    CPUSceneRayQuery::Hit hit;
+    float tMax = ray.tMax;
+    for (const auto& instance : instances)
+    {
+        const MeshBuffers& mesh = meshes[instance.meshIndex];
+        uint32_t triangleCount = uint32_t(mesh.indices.empty() ? mesh.positions.size() : mesh.indices.size()) / 3;
+        for (uint32_t i = 0; i < triangleCount; ++i)
+        {
+            float3 v[3];
+            for (uint32_t j = 0; j < 3; ++j)
+                v[j] = transformPoint(instance.transform, mesh.positions[mesh.indices.empty() ? 3 * i + j : mesh.indices[3 * i + j]]);
+
+            float3 e1 = v[1] - v[0], e2 = v[2] - v[0];
+            float3 p = cross(ray.dir, e2);
+            float det = dot(e1, p);
+            if (det == 0.f)
+                continue;
+            float3 s = ray.origin - v[0];
+            float b1 = dot(s, p) / det;
+            float3 q = cross(s, e1);
+            float b2 = dot(ray.dir, q) / det;
+            float t = dot(e2, q) / det;
+            if (b1 < 0.f || b2 < 0.f || b1 + b2 > 1.f || t < ray.tMin || t > tMax)
+                continue;
+
+            tMax = t;
+            hit.type = HitType::Triangle;
+            hit.instanceID = instance.instanceID;
+            hit.primitiveIndex = i;
+            hit.barycentrics = float2(b1, b2);
+            hit.t = t;
+        }
+    }
+    return hit;
+}
+
+std::vector<CPUSceneRayQuery::MeshData> getMeshData(const std::vector<MeshBuffers>& meshes)
+{
+    std::vector<CPUSceneRayQuery::MeshData> meshData;
+    for (const auto& mesh : meshes)
+        meshData.push_back({mesh.positions, mesh.indices});
+    return meshData;
+}
+} // namespace
+
+CPU_TEST(CPUSceneRayQuery_SingleTriangle)
+{
+    std::vector<float3> positions = {float3(0.f, 0.f, 0.f), float3(1.f, 0.f, 0.f), float3(0.f, 1.f, 0.f)};
+    std::vector<CPUSceneRayQuery::MeshData> meshes = {{positions, {}}};
+    std::vector<CPUSceneRayQuery::InstanceData> instances(1);
+    instances[0].instanceID = 7;
+    instances[0].transform = math::matrixFromTranslation(float3(0.f, 0.f, 2.f));
+
+    ref<CPUSceneRayQuery> pRayQuery = CPUSceneRayQuery::create(meshes, instances);
+    EXPECT_EQ(pRayQuery->getStats().triangleCount, 1);
+
+    // The ray direction is not normalized, the hit distance is in units of the direction length.
+    Ray ray(float3(0.25f, 0.5f, 0.f), float3(0.f, 0.f, 4.f));
+    CPUSceneRayQuery::Hit hit = pRayQuery->closestHit(ray);
+    EXPECT(hit.isValid());
+    EXPECT_EQ(hit.instanceID, 7);
+    EXPECT_EQ(hit.primitiveIndex, 0);
+    EXPECT_EQ(hit.t, 0.5f);
+    EXPECT_EQ(hit.barycentrics.x, 0.25f);
+    EXPECT_EQ(hit.barycentrics.y, 0.5f);
+    EXPECT(pRayQuery->anyHit(ray));
+
+    // The ray interval is respected.
+    ray.tMax = 0.4f;
+    EXPECT(!pRayQuery->closestHit(ray).isValid());
+    EXPECT(!pRayQuery->anyHit(ray));
+
+    // Rays outside the triangle miss.
+    Ray missRay(float3(0.75f, 0.75f, 0.f), float3(0.f, 0.f, 1.f));
+    EXPECT(!pRayQuery->closestHit(missRay).isValid());
+    EXPECT(!pRayQuery->anyHit(missRay));
+}
+
+CPU_TEST(CPUSceneRayQuery_InfiniteTMax)
+{
+    // A single triangle gives nodes with a single child, whose empty child slots must not be hit by rays with an infinite tMax.
+    std::vector<float3> positions = {float3(0.f, 0.f, 0.f), float3(1.f, 0.f, 0.f), float3(0.f, 1.f, 0.f)};
+    std::vector<CPUSceneRayQuery::MeshData> meshes = {{positions, {}}};
+    std::vector<CPUSceneRayQuery::InstanceData> instances(1);
+    instances[0].transform = math::matrixFromTranslation(float3(0.f, 0.f, 2.f));
+    ref<CPUSceneRayQuery> pRayQuery = CPUSceneRayQuery::create(meshes, instances);
+
+    // Rays with positive and negative direction components, hitting and missing the triangle.
+    const float inf = std::numeric_limits<float>::infinity();
+    Ray hitRay(float3(0.25f, 0.5f, 0.f), float3(0.f, 0.f, 1.f), 0.f, inf);
+    Ray hitRayNeg(float3(0.25f, 0.5f, 4.f), float3(0.f, 0.f, -1.f), 0.f, inf);
+    Ray missRay(float3(0.75f, 0.75f, 0.f), float3(0.f, 0.f, 1.f), 0.f, inf);
+    Ray missRayNeg(float3(0.75f, 0.75f, 4.f), float3(0.f, 0.f, -1.f), 0.f, inf);
+
+    EXPECT_EQ(pRayQuery->closestHit(hitRay).t, 2.f);
+    EXPECT_EQ(pRayQuery->closestHit(hitRayNeg).t, 2.f);
+    EXPECT(pRayQuery->anyHit(hitRay));
+    EXPECT(pRayQuery->anyHit(hitRayNeg));
+    EXPECT(!pRayQuery->closestHit(missRay).isValid());
+    EXPECT(!pRayQuery->closestHit(missRayNeg).isValid());
+    EXPECT(!pRayQuery->anyHit(missRay));
+    EXPECT(!pRayQuery->anyHit(missRayNeg));
+}
+
+CPU_TEST(CPUSceneRayQuery_Empty)
+{
+    ref<CPUSceneRayQuery> pRayQuery = CPUSceneRayQuery::create({}, {});
+    Ray ray(float3(0.f), float3(0.f, 0.f, 1.f));
+    EXPECT(!pRayQuery->closestHit(ray).isValid());
+    EXPECT(!pRayQuery->anyHit(ray));
+}
+
+CPU_TEST(CPUSceneRayQuery_CompareReference)
+{
+    std::mt19937 rng(1);
+    std::vector<MeshBuffers> meshes = {createSphere(24), createTriangleSoup(2000, rng)};
+
+    std::vector<CPUSceneRayQuery::InstanceData> instances;
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        CPUSceneRayQuery::InstanceData instance;
+        instance.meshIndex = i % 2;
+        instance.instanceID = i;
+        instance.transform = mul(
+            math::matrixFromTranslation(float3(float(i % 4) * 1.5f, float(i / 4) * 1.5f, 0.f)),
+            math::matrixFromRotationY(float(i) * 0.3f)
+        );
+        instances.push_back(instance);
+    }
+
+    ref<CPUSceneRayQuery> pRayQuery = CPUSceneRayQuery::create(getMeshData(meshes), instances);
+    EXPECT_EQ(pRayQuery->getStats().instanceCount, 8);
+    EXPECT_EQ(pRayQuery->getStats().triangleCount, 2000 + 24 * 12 * 2);
+
+    std::vector<Ray> rays(2000);
+    for (auto& ray : rays)
+        ray = createRandomRay(pRayQuery->getBounds(), rng);
+
+    std::vector<CPUSceneRayQuery::Hit> hits(rays.size());
+    std::vector<uint8_t> anyHits(rays.size());
+    pRayQuery->closestHit(rays, hits);
+    pRayQuery->anyHit(rays, anyHits);
+
+    uint32_t hitCount = 0;
+    for (size_t i = 0; i < rays.size(); ++i)
+    {
+        CPUSceneRayQuery::Hit refHit = referenceClosestHit(rays[i], meshes, instances);
+        EXPECT_EQ(hits[i].isValid(), refHit.isValid()) << "i = " << i;
+        EXPECT_EQ(anyHits[i] != 0, refHit.isValid()) << "i = " << i;
+        if (hits[i].isValid() && refHit.isValid())
+        {
+            EXPECT_LE(std::abs(hits[i].t - refHit.t), 1e-4f * refHit.t) << "i = " << i;
+
+            // Nearly coincident hits may be reported on different triangles, so check that the reported triangle is hit at the reported point.
+            const auto& instance = instances[hits[i].instanceID];
+            const MeshBuffers& mesh = meshes[instance.meshIndex];
+            float3 v[3];
+            for (uint32_t j = 0; j < 3; ++j)
+            {
+                uint32_t index = 3 * hits[i].primitiveIndex + j;
+                v[j] = transformPoint(instance.transform, mesh.positions[mesh.indices.empty() ? index : mesh.indices[index]]);
+            }
+            float3 p = v[0] + hits[i].barycentrics.x * (v[1] - v[0]) + hits[i].barycentrics.y * (v[2] - v[0]);
+            EXPECT_LE(length(p - (rays[i].origin + hits[i].t * rays[i].dir)), 1e-4f) << "i = " << i;
+            hitCount++;
+        }
+
+        // Single ray queries match batched queries.
+        CPUSceneRayQuery::Hit single = pRayQuery->closestHit(rays[i]);
+        EXPECT_EQ(single.t, hits[i].t);
+        EXPECT_EQ(single.primitiveIndex, hits[i].primitiveIndex);
+    }
+    EXPECT_GT(hitCount, rays.size() / 4);
+}
+
+CPU_TEST(CPUSceneRayQuery_InvalidInput)
+{
+    std::vector<float3> positions = {float3(0.f), float3(1.f, 0.f, 0.f), float3(0.f, 1.f, 0.f)};
+    std::vector<uint32_t> indices = {0, 1, 3};
+    std::vector<CPUSceneRayQuery::MeshData> meshes = {{positions, indices}};
+    std::vector<CPUSceneRayQuery::InstanceData> instances(1);
+    EXPECT_THROW(CPUSceneRayQuery::create(meshes, instances));
+
+    meshes[0].indices = {};
+    instances[0].meshIndex = 1;
+    EXPECT_THROW(CPUSceneRayQuery::create(meshes, instances));
+}
+
+CPU_BENCHMARK(CPUSceneRayQuery, TAGS("scene"))
+{
+    // Grid of 16 x 16 instances of a sphere with 80K triangles.
+    std::vector<MeshBuffers> meshes = {createSphere(200)};
+    std::vector<CPUSceneRayQuery::InstanceData> instances;
+    for (uint32_t i = 0; i < 256; ++i)
+    {
+        CPUSceneRayQuery::InstanceData instance;
+        instance.instanceID = i;
+        instance.transform = math::matrixFromTranslation(float3(float(i % 16) * 2.5f, 0.f, float(i / 16) * 2.5f));
+        instances.push_back(instance);
+    }
+
+    ref<CPUSceneRayQuery> pRayQuery;
+    ctx.measure("build", [&]() { pRayQuery = CPUSceneRayQuery::create(getMeshData(meshes), instances); });
+
+    const uint32_t kRayCount = 1 << 20;
+    const AABB bounds = pRayQuery->getBounds();
+
+    // Coherent rays from a pinhole camera looking down at the grid.
+    std::vector<Ray> coherentRays(kRayCount);
+    const uint32_t kWidth = 1024;
+    const float3 eye = bounds.center() + float3(0.f, bounds.extent().x, bounds.extent().z);
+    for (uint32_t i = 0; i < kRayCount; ++i)
+    {
+        float3 target = bounds.minPoint + bounds.extent() * float3((i % kWidth + 0.5f) / kWidth, 0.5f, (i / kWidth + 0.5f) / kWidth);
+        coherentRays[i] = Ray(eye, normalize(target - eye));
+    }
+
+    // Incoherent rays between random points in the scene.
+    std::mt19937 rng(1);
+    std::vector<Ray> incoherentRays(kRayCount);
+    for (auto& ray : incoherentRays)
+        ray = createRandomRay(bounds, rng);
+
+    std::vector<CPUSceneRayQuery::Hit> hits(kRayCount);
+    std::vector<uint8_t> anyHits(kRayCount);
+    ctx.measure("closestHit_coherent", [&]() { pRayQuery->closestHit(coherentRays, hits); }, kRayCount);
+    ctx.measure("anyHit_coherent", [&]() { pRayQuery->anyHit(coherentRays, anyHits); }, kRayCount);
+    ctx.measure("closestHit_incoherent", [&]() { pRayQuery->closestHit(incoherentRays, hits); }, kRayCount);
+    ctx.measure("anyHit_incoherent", [&]() { pRayQuery->anyHit(incoherentRays, anyHits); }, kRayCount);
+}
+} // namespace Falcor
@@ -0,0 +1,333 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Curves/CurveTessellation.h"
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+struct Strands
+{
+    std::vector<uint32_t> vertexCounts;
+    std::vector<float3> controlPoints;
+    std::vector<float> widths;
+    std::vector<float2> UVs;
+
+    CurveTessellation::StrandData getData() const { return {vertexCounts, controlPoints, widths, UVs}; }
+};
+
+/// Create random strands. About a quarter of the control points duplicate the previous one, except for the second
+/// control point of each strand, so that every strand has at least two unique control points.
+Strands createRandomStrands(uint32_t strandCount, bool useUVs)
+{
+    std::mt19937 rng(strandCount);
+    std::uniform_int_distribution<uint32_t> vertexCountDist(2, 12);
+    std::uniform_real_distribution<float> dist(0.f, 1.f);
+
+    Strands strands;
+    for (uint32_t i = 0; i < strandCount; i++)
+    {
+        const uint32_t vertexCount = vertexCountDist(rng);
+        strands.vertexCounts.push_back(vertexCount);
+
+        float3 p = float3(dist(rng), dist(rng), dist(rng)) * 10.f;
+        for (uint32_t j = 0; j < vertexCount; j++)
+        {
+            bool duplicate = j >= 2 && dist(rng) < 0.25f;
+            if (!duplicate)
+                p += float3(dist(rng) - 0.5f, dist(rng) - 0.5f, 1.f) * 0.1f;
+            strands.controlPoints.push_back(p);
+            strands.widths.push_back(duplicate ? strands.widths.back() : 0.01f + 0.01f * dist(rng));
+            if (useUVs)
+                strands.UVs.push_back(duplicate ? strands.UVs.back() : float2(dist(rng), dist(rng)));
+        }
+    }
+    return strands;
+}
+
+template<typename T>
+void append(fast_vector<T>& dst, const fast_vector<T>& src)
+{
+    for (const T& value : src)
+        dst.push_back(value);
+}
+
+/// Tessellate the kept strands one at a time and concatenate the results, as the serial implementation did.
+CurveTessellation::SweptSphereResult tessellateSweptSphereSerial(
+    const Strands& strands,
+    uint32_t subdivPerSegment,
+    uint32_t keepOneEveryXStrands,
+    uint32_t keepOneEveryXVerticesPerStrand,
+    float widthScale,
+    const float4x4& xform
+)
+{
+    CurveTessellation::SweptSphereResult result;
+    result.degree = 1;
+
+    uint32_t pointOffset = 0;
+    for (uint32_t i = 0; i < strands.vertexCounts.size(); i++)
+    {
+        if (i % keepOneEveryXStrands == 0)
+        {
+            auto strand = CurveTessellation::convertToLinearSweptSphere(
+                1,
+                &strands.vertexCounts[i],
+                &strands.controlPoints[pointOffset],
+                &strands.widths[pointOffset],
+                strands.UVs.empty() ? nullptr : &strands.UVs[pointOffset],
+                1,
+                subdivPerSegment,
+                1,
+                keepOneEveryXVerticesPerStrand,
+                widthScale,
+                xform
+            );
+
+            const uint32_t indexOffset = (uint32_t)result.points.size();
+            for (uint32_t index : strand.indices)
+                result.indices.push_back(indexOffset + index);
+            append(result.points, strand.points);
+            append(result.radius, strand.radius);
+            append(result.texCrds, strand.texCrds);
+        }
+        pointOffset += strands.vertexCounts[i];
+    }
+    return result;
+}
+
+/// Tessellate the kept strands one at a time and concatenate the results, as the serial implementation did.
+CurveTessellation::MeshResult tessellatePolytubeSerial(
+    const Strands& strands,
+    uint32_t subdivPerSegment,
+    uint32_t keepOneEveryXStrands,
+    uint32_t keepOneEveryXVerticesPerStrand,
+    float widthScale,
+    uint32_t pointCountPerCrossSection
+)
+{
+    CurveTessellation::MeshResult result;
+
+    uint32_t pointOffset = 0;
+    for (uint32_t i = 0; i < strands.vertexCounts.size(); i++)
+    {
+        if (i % keepOneEveryXStrands == 0)
+        {
+            auto strand = CurveTessellation::convertToPolytube(
+                1,
+                &strands.vertexCounts[i],
+                &strands.controlPoints[pointOffset],
+                &strands.widths[pointOffset],
+                strands.UVs.empty() ? nullptr : &strands.UVs[pointOffset],
+                subdivPerSegment,
+                1,
+                keepOneEveryXVerticesPerStrand,
+                widthScale,
+                pointCountPerCrossSection
+            );
+
+            const uint32_t vertexOffset = (uint32_t)result.vertices.size();
+            for (uint32_t index : strand.faceVertexIndices)
+                result.faceVertexIndices.push_back(vertexOffset + index);
+            append(result.faceVertexCounts, strand.faceVertexCounts);
+            append(result.vertices, strand.vertices);
+            append(result.normals, strand.normals);
+            append(result.tangents, strand.tangents);
+            append(result.texCrds, strand.texCrds);
+            append(result.radii, strand.radii);
+        }
+        pointOffset += strands.vertexCounts[i];
+    }
+    return result;
+}
+
+template<typename T>
+bool isIdentical(const fast_vector<T>& a, const fast_vector<T>& b)
+{
+    return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+}
+} // namespace
+
+CPU_TEST(CurveTessellation_SweptSphereFixed)
+{
+    // Two straight strands along the x-axis, separated by a strand that is skipped. The first strand contains a
+    // duplicate control point, which is removed, leaving four equally spaced control points. The spline through
+    // them is linear, so the tessellated points are known.
+    Strands strands;
+    strands.vertexCounts = {5, 3, 4};
+    strands.controlPoints = {
+        float3(0, 0, 0), float3(1, 0, 0), float3(1, 0, 0), float3(2, 0, 0), float3(3, 0, 0),
+        float3(0, 9, 0), float3(0, 9, 1), float3(0, 9, 2),
+        float3(0, 5, 0), float3(2, 5, 0), float3(4, 5, 0), float3(6, 5, 0),
+    };
+    strands.widths = std::vector<float>(strands.controlPoints.size(), 0.2f);
+
+    {
+        auto result = CurveTessellation::convertToLinearSweptSphere(strands.getData(), 1, 2, 2, 1, 1.f, float4x4::identity());
+
+        const std::vector<float3> expectedPoints = {
+            float3(0.0f, 0, 0), float3(0.5f, 0, 0), float3(1.0f, 0, 0), float3(1.5f, 0, 0), float3(2.0f, 0, 0), float3(2.5f, 0, 0), float3(3.0f, 0, 0),
+            float3(0.0f, 5, 0), float3(1.0f, 5, 0), float3(2.0f, 5, 0), float3(3.0f, 5, 0), float3(4.0f, 5, 0), float3(5.0f, 5, 0), float3(6.0f, 5, 0),
+        };
+        const std::vector<uint32_t> expectedIndices = {0, 1, 2, 3, 4, 5, 7, 8, 9, 10, 11, 12};
+
+        ASSERT_EQ(result.points.size(), expectedPoints.size());
+        ASSERT_EQ(result.indices.size(), expectedIndices.size());
+        for (size_t i = 0; i < expectedPoints.size(); i++)
+        {
+            EXPECT_LT(length(result.points[i] - expectedPoints[i]), 1e-5f) << "i = " << i;
+            EXPECT_LT(std::abs(result.radius[i] - 0.1f), 1e-6f) << "i = " << i;
+        }
+        for (size_t i = 0; i < expectedIndices.size(); i++)
+            EXPECT_EQ(result.indices[i], expectedIndices[i]) << "i = " << i;
+        EXPECT(result.texCrds.empty());
+    }
+
+    {
+        // Keeping one of every four points leaves the points at the start of every other input segment and the last point.
+        auto result = CurveTessellation::convertToLinearSweptSphere(strands.getData(), 1, 2, 2, 4, 1.f, float4x4::identity());
+
+        const std::vector<float3> expectedPoints = {
+            float3(0, 0, 0), float3(2, 0, 0), float3(3, 0, 0),
+            float3(0, 5, 0), float3(4, 5, 0), float3(6, 5, 0),
+        };
+        const std::vector<uint32_t> expectedIndices = {0, 1, 3, 4};
+
+        ASSERT_EQ(result.points.size(), expectedPoints.size());
+        ASSERT_EQ(result.indices.size(), expectedIndices.size());
+        for (size_t i = 0; i < expectedPoints.size(); i++)
+            EXPECT_LT(length(result.points[i] - expectedPoints[i]), 1e-5f) << "i = " << i;
+        for (size_t i = 0; i < expectedIndices.size(); i++)
+            EXPECT_EQ(result.indices[i], expectedIndices[i]) << "i = " << i;
+    }
+}
+
+CPU_TEST(CurveTessellation_PolytubeFixed)
+{
+    // A straight strand along the x-axis with a duplicate control point, see CurveTessellation_SweptSphereFixed.
+    Strands strands;
+    strands.vertexCounts = {5};
+    strands.controlPoints = {float3(0, 0, 0), float3(1, 0, 0), float3(1, 0, 0), float3(2, 0, 0), float3(3, 0, 0)};
+    strands.widths = std::vector<float>(strands.controlPoints.size(), 0.2f);
+
+    const uint32_t pointCountPerCrossSection = 4;
+    auto result = CurveTessellation::convertToPolytube(strands.getData(), 2, 1, 1, 1.f, pointCountPerCrossSection);
+
+    // Seven cross-sections with six segments in between.
+    const uint32_t crossSectionCount = 7;
+    ASSERT_EQ(result.vertices.size(), crossSectionCount * pointCountPerCrossSection);
+    ASSERT_EQ(result.faceVertexCounts.size(), 2 * (crossSectionCount - 1) * pointCountPerCrossSection);
+    ASSERT_EQ(result.faceVertexIndices.size(), 3 * result.faceVertexCounts.size());
+
+    // The radius includes the compensation for the quad-tube cross-section.
+    const float radius = 0.5f * 1.11f * 0.2f;
+    for (uint32_t i = 0; i < result.vertices.size(); i++)
+    {
+        const float x = 0.5f * (i / pointCountPerCrossSection);
+        EXPECT_LT(std::abs(result.vertices[i].x - x), 1e-5f) << "i = " << i;
+        EXPECT_LT(std::abs(length(result.vertices[i].yz()) - radius), 1e-5f) << "i = " << i;
+        EXPECT_LT(std::abs(result.radii[i] - radius), 1e-6f) << "i = " << i;
+        EXPECT_LT(length(result.tangents[i].xyz() - float3(1, 0, 0)), 1e-5f) << "i = " << i;
+    }
+    for (uint32_t count : result.faceVertexCounts)
+        EXPECT_EQ(count, 3u);
+    for (uint32_t index : result.faceVertexIndices)
+        EXPECT_LT(index, result.vertices.size());
+}
+
+CPU_TEST(CurveTessellation_SweptSphereMatchesSerial)
+{
+    const float4x4 xform = math::matrixFromScaling(float3(2.f));
+
+    for (bool useUVs : {false, true})
+    {
+        // Enough strands to be split into several batches.
+        const Strands strands = createRandomStrands(1000, useUVs);
+
+        for (uint32_t keepOneEveryXStrands : {1, 3})
+        {
+            for (uint32_t keepOneEveryXVerticesPerStrand : {1, 2, 5})
+            {
+                auto result = CurveTessellation::convertToLinearSweptSphere(
+                    strands.getData(), 1, 3, keepOneEveryXStrands, keepOneEveryXVerticesPerStrand, 0.5f, xform
+                );
+                auto expected = tessellateSweptSphereSerial(strands, 3, keepOneEveryXStrands, keepOneEveryXVerticesPerStrand, 0.5f, xform);
+
+                auto msg = fmt::format(
+                    "useUVs={} keepOneEveryXStrands={} keepOneEveryXVerticesPerStrand={}",
+                    useUVs,
+                    keepOneEveryXStrands,
+                    keepOneEveryXVerticesPerStrand
+                );
+                EXPECT(isIdentical(result.indices, expected.indices)) << msg;
+                EXPECT(isIdentical(result.points, expected.points)) << msg;
+                EXPECT(isIdentical(result.radius, expected.radius)) << msg;
+                EXPECT(isIdentical(result.texCrds, expected.texCrds)) << msg;
+                EXPECT_EQ(result.texCrds.size(), useUVs ? result.points.size() : 0) << msg;
+            }
+        }
+    }
+}
+
+CPU_TEST(CurveTessellation_PolytubeMatchesSerial)
+{
+    for (bool useUVs : {false, true})
+    {
+        const Strands strands = createRandomStrands(1000, useUVs);
+
+        for (uint32_t keepOneEveryXStrands : {1, 3})
+        {
+            for (uint32_t keepOneEveryXVerticesPerStrand : {1, 2, 5})
+            {
+                auto result = CurveTessellation::convertToPolytube(strands.getData(), 3, keepOneEveryXStrands, keepOneEveryXVerticesPerStrand, 0.5f, 4);
+                auto expected = tessellatePolytubeSerial(strands, 3, keepOneEveryXStrands, keepOneEveryXVerticesPerStrand, 0.5f, 4);
+
+                auto msg = fmt::format(
+                    "useUVs={} keepOneEveryXStrands={} keepOneEveryXVerticesPerStrand={}",
+                    useUVs,
+                    keepOneEveryXStrands,
+                    keepOneEveryXVerticesPerStrand
+                );
+                EXPECT(isIdentical(result.vertices, expected.vertices)) << msg;
+                EXPECT(isIdentical(result.normals, expected.normals)) << msg;
+                EXPECT(isIdentical(result.tangents, expected.tangents)) << msg;
+                EXPECT(isIdentical(result.texCrds, expected.texCrds)) << msg;
+                EXPECT(isIdentical(result.radii, expected.radii)) << msg;
+                EXPECT(isIdentical(result.faceVertexCounts, expected.faceVertexCounts)) << msg;
+                EXPECT(isIdentical(result.faceVertexIndices, expected.faceVertexIndices)) << msg;
+            }
+        }
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,163 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Scene.h"
+#include "Scene/SceneBuilder.h"
+#include "Scene/Lights/LightCollection.h"
+#include "Scene/Material/StandardMaterial.h"
+#include <algorithm>
+
+namespace Falcor
+{
+namespace
+{
+/// Exposes the GPU-side triangle data for validation.
+class TestLightCollection : public LightCollection
+{
+public:
+    using LightCollection::LightCollection;
+
+    std::vector<PackedEmissiveTriangle> getGPUTriangleData() const { return mpTriangleData->getElements<PackedEmissiveTriangle>(); }
+    std::vector<EmissiveFlux> getGPUFluxData() const { return mpFluxData->getElements<EmissiveFlux>(); }
+};
+
+/// Compare the CPU-side triangles against the GPU buffers.
+void compareTriangleData(GPUUnitTestContext& ctx, RenderContext* pRenderContext, const TestLightCollection& lightCollection)
+{
+    const auto& triangles = lightCollection.getMeshLightTriangles(pRenderContext);
+    const auto gpuTriangles = lightCollection.getGPUTriangleData();
+    const auto gpuFlux = lightCollection.getGPUFluxData();
+    ASSERT_EQ(triangles.size(), lightCollection.getTotalLightCount());
+    ASSERT_GE(gpuTriangles.size(), triangles.size());
+    ASSERT_GE(gpuFlux.size(), triangles.size());
+
+    auto isClose = [](float x, float y) { return std::abs(x - y) <= 1e-5f * std::max({1.f, std::abs(x), std::abs(y)}); };
+
+    for (size_t i = 0; i < triangles.size(); ++i)
+    {
+        const auto& tri = triangles[i];
+        const EmissiveTriangle gpuTri = gpuTriangles[i].unpack();
+
+        EXPECT_EQ(tri.lightIdx, gpuTri.lightIdx) << "triangle " << i;
+        for (uint32_t j = 0; j < 3; ++j)
+        {
+            for (int k = 0; k < 3; ++k)
+                EXPECT(isClose(tri.vtx[j].pos[k], gpuTri.posW[j][k])) << "triangle " << i << " vertex " << j;
+        }
+
+        // Both normals are quantized, but may be a quantization step apart.
+        EXPECT_GE(dot(tri.normal, gpuTri.normal), 0.9999f) << "triangle " << i;
+        EXPECT(isClose(tri.area, gpuTri.area)) << "triangle " << i;
+        EXPECT(isClose(tri.flux, gpuFlux[i].flux)) << "triangle " << i;
+        for (int k = 0; k < 3; ++k)
+            EXPECT(isClose(tri.averageRadiance[k], gpuFlux[i].averageRadiance[k])) << "triangle " << i;
+    }
+}
+
+/// Compare the triangles computed in parallel and serially, which are expected to be identical.
+void compareSerialTriangleData(GPUUnitTestContext& ctx, RenderContext* pRenderContext, const LightCollection& parallel, const LightCollection& serial)
+{
+    const auto& a = parallel.getMeshLightTriangles(pRenderContext);
+    const auto& b = serial.getMeshLightTriangles(pRenderContext);
+    ASSERT_EQ(a.size(), b.size());
+
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        for (uint32_t j = 0; j < 3; ++j)
+            EXPECT(all(a[i].vtx[j].pos == b[i].vtx[j].pos)) << "triangle " << i;
+        EXPECT(all(a[i].normal == b[i].normal)) << "triangle " << i;
+        EXPECT_EQ(a[i].area, b[i].area) << "triangle " << i;
+        EXPECT_EQ(a[i].flux, b[i].flux) << "triangle " << i;
+    }
+}
+} // namespace
+
+GPU_TEST(LightCollection_CPUTriangleData)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    RenderContext* pRenderContext = pDevice->getRenderContext();
+
+    // Build a scene with pretransformed, instanced and dynamic mesh lights, some of them with flipped winding.
+    SceneBuilder builder(pDevice, Settings(), SceneBuilder::Flags::DontOptimizeGraph);
+    ref<StandardMaterial> pMaterial = StandardMaterial::create(pDevice, "Emissive");
+    pMaterial->setEmissiveColor(float3(1.f, 0.5f, 0.25f));
+
+    auto addInstance = [&](MeshID meshID, const std::string& name, const float4x4& transform)
+    {
+        NodeID nodeID = builder.addNode(SceneBuilder::Node{name, transform, float4x4::identity()});
+        builder.addMeshInstance(nodeID, meshID);
+        return nodeID;
+    };
+
+    const float4x4 transforms[] = {
+        math::matrixFromTranslation(float3(-2.f, 0.f, 0.f)),
+        mul(math::matrixFromTranslation(float3(2.f, 1.f, 0.f)), math::matrixFromRotationZ(0.7f)),
+        mul(math::matrixFromTranslation(float3(0.f, -1.f, 3.f)), math::matrixFromScaling(float3(-1.f, 2.f, 0.5f))),
+    };
+
+    // Static meshes are pretransformed to world space.
+    for (size_t i = 0; i < std::size(transforms); ++i)
+        addInstance(builder.addTriangleMesh(TriangleMesh::createQuad(float2(1.f + i)), pMaterial), "Static" + std::to_string(i), transforms[i]);
+
+    // Instanced meshes keep their transforms, their geometry is computed on the CPU.
+    MeshID instancedMesh = builder.addTriangleMesh(TriangleMesh::createCube(float3(0.5f)), pMaterial);
+    NodeID movedNode = addInstance(instancedMesh, "Instance0", transforms[1]);
+    addInstance(instancedMesh, "Instance1", transforms[2]);
+
+    // The geometry of dynamic meshes is only available on the GPU.
+    addInstance(builder.addTriangleMesh(TriangleMesh::createQuad(), pMaterial, true), "Dynamic", transforms[0]);
+
+    ref<Scene> pScene = builder.getScene();
+    pScene->update(pRenderContext, 0.0);
+
+    LightCollection::Options serialOptions;
+    serialOptions.parallelCPUTriangleData = false;
+    auto pParallel = make_ref<TestLightCollection>(pDevice, pRenderContext, pScene.get());
+    auto pSerial = make_ref<TestLightCollection>(pDevice, pRenderContext, pScene.get(), serialOptions);
+    pParallel->update(pRenderContext);
+    pSerial->update(pRenderContext);
+
+    // Four quads and two cube instances.
+    EXPECT_EQ(pParallel->getTotalLightCount(), 4 * 2 + 2 * 12);
+
+    compareTriangleData(ctx, pRenderContext, *pParallel);
+    compareTriangleData(ctx, pRenderContext, *pSerial);
+    compareSerialTriangleData(ctx, pRenderContext, *pParallel, *pSerial);
+
+    // Moving a light updates its CPU-side geometry directly.
+    pScene->updateNodeTransform(movedNode.get(), mul(math::matrixFromTranslation(float3(1.f, 2.f, 3.f)), math::matrixFromRotationX(1.2f)));
+    pScene->update(pRenderContext, 0.0);
+    pParallel->update(pRenderContext);
+    pSerial->update(pRenderContext);
+    EXPECT_EQ(pParallel->getUpdatedLights().size(), 1);
+
+    compareTriangleData(ctx, pRenderContext, *pParallel);
+    compareTriangleData(ctx, pRenderContext, *pSerial);
+    compareSerialTriangleData(ctx, pRenderContext, *pParallel, *pSerial);
+}
+} // namespace Falcor
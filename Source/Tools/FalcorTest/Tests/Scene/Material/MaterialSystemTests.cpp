@@ -0,0 +1,101 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Material/MaterialSystem.h"
+#include "Scene/Material/StandardMaterial.h"
+
+namespace Falcor
+{
+GPU_TEST(MaterialSystem_RemoveDuplicates)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    MaterialSystem materials(pDevice);
+
+    // Create materials where every third one has a distinct base color.
+    std::vector<ref<StandardMaterial>> standardMaterials;
+    for (uint32_t i = 0; i < 30; i++)
+    {
+        auto pMaterial = StandardMaterial::create(pDevice, "Material" + std::to_string(i));
+        pMaterial->setBaseColor(float4(float(i % 3) / 3.f, 0.5f, 0.5f, 1.f));
+        standardMaterials.push_back(pMaterial);
+        materials.addMaterial(pMaterial);
+    }
+
+    // Equal materials must have equal content hashes.
+    for (uint32_t i = 3; i < 30; i++)
+    {
+        EXPECT(standardMaterials[i]->isEqual(standardMaterials[i % 3]));
+        EXPECT_EQ(standardMaterials[i]->getContentHash(), standardMaterials[i % 3]->getContentHash());
+    }
+    EXPECT(!standardMaterials[0]->isEqual(standardMaterials[1]));
+
+    // Adding the same material twice returns the existing ID.
+    EXPECT_EQ(materials.addMaterial(standardMaterials[7]), MaterialID{7});
+
+    std::vector<MaterialID> idMap;
+    size_t removed = materials.removeDuplicateMaterials(idMap);
+    EXPECT_EQ(removed, 27);
+    EXPECT_EQ(materials.getMaterialCount(), 3);
+    ASSERT_EQ(idMap.size(), 30);
+    for (uint32_t i = 0; i < 30; i++)
+        EXPECT_EQ(idMap[i], MaterialID{i % 3});
+
+    // Removed duplicates are not found by name, the remaining materials are.
+    EXPECT(materials.getMaterialByName("Material1") == standardMaterials[1]);
+    EXPECT(materials.getMaterialByName("Material4") == nullptr);
+}
+
+GPU_TEST(MaterialSystem_GetMaterialByName)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    MaterialSystem materials(pDevice);
+
+    auto pA = StandardMaterial::create(pDevice, "A");
+    auto pB = StandardMaterial::create(pDevice, "B");
+    auto pA2 = StandardMaterial::create(pDevice, "A");
+    materials.addMaterial(pA);
+    materials.addMaterial(pB);
+    materials.addMaterial(pA2);
+
+    // The material with the lowest ID is returned for duplicate names.
+    EXPECT(materials.getMaterialByName("A") == pA);
+    EXPECT(materials.getMaterialByName("B") == pB);
+    EXPECT(materials.getMaterialByName("C") == nullptr);
+
+    // Renaming a material updates the lookup.
+    pA->setName("C");
+    EXPECT(materials.getMaterialByName("A") == pA2);
+    EXPECT(materials.getMaterialByName("C") == pA);
+
+    // Replacing a material updates the lookup.
+    auto pD = StandardMaterial::create(pDevice, "D");
+    materials.replaceMaterial(pB, pD);
+    EXPECT(materials.getMaterialByName("B") == nullptr);
+    EXPECT(materials.getMaterialByName("D") == pD);
+}
+} // namespace Falcor
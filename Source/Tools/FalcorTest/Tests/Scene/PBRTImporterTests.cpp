@@ -0,0 +1,253 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Core/Plugin.h"
+#include "Scene/ImporterError.h"
+#include "Scene/SceneBuilder.h"
+#include <algorithm>
+#include <fstream>
+
+namespace Falcor
+{
+namespace
+{
+// Grid of vertices, large enough for the numeric arrays to be split into several chunks of 1 MB.
+const uint32_t kGridWidth = 400;
+const uint32_t kGridHeight = 300;
+
+// Separators between values. Runs of whitespace make chunk boundaries fall inside whitespace as well as inside values.
+const char* kSeparators[] = {" ", "   ", "\n", "\t", " \r\n  "};
+
+/// Line of the positions array in the written scene file. The indices array starts on the line after the positions.
+const uint32_t kPositionsLine = 3;
+
+/// Format the positions of the grid, mixing integer and floating-point notations.
+std::string formatPositions()
+{
+    std::string str;
+    for (uint32_t i = 0; i < kGridWidth * kGridHeight; ++i)
+    {
+        uint32_t x = i % kGridWidth;
+        uint32_t y = i / kGridWidth;
+        switch (i % 4)
+        {
+        case 0:
+            str += fmt::format("{} {}. -{}e-2", x, y, i % 100);
+            break;
+        case 1:
+            str += fmt::format("+{}.5 {}E0 {}", x, y, i % 7);
+            break;
+        case 2:
+            str += fmt::format("{}.0 +{} -0.{}", x, y, i % 10);
+            break;
+        default:
+            str += fmt::format("{}e0 {}.25 {}.", x, y, i % 3);
+            break;
+        }
+        str += kSeparators[i % std::size(kSeparators)];
+    }
+    return str;
+}
+
+/// Format the triangle indices of the grid.
+std::string formatIndices()
+{
+    std::string str;
+    for (uint32_t y = 0; y + 1 < kGridHeight; ++y)
+    {
+        for (uint32_t x = 0; x + 1 < kGridWidth; ++x)
+        {
+            uint32_t i = y * kGridWidth + x;
+            str += fmt::format("{} +{} {}", i, i + 1, i + kGridWidth);
+            str += kSeparators[i % std::size(kSeparators)];
+            str += fmt::format("{} {} {}", i + 1, i + kGridWidth + 1, i + kGridWidth);
+            str += kSeparators[(i + 1) % std::size(kSeparators)];
+        }
+    }
+    return str;
+}
+
+/// Write a pbrt scene with a single triangle mesh.
+void writeScene(const std::filesystem::path& path, const std::string& positions, const std::string& indices)
+{
+    std::ofstream ofs(path, std::ios::binary);
+    ofs << "WorldBegin\n";
+    ofs << "Shape \"trianglemesh\"\n";
+    ofs << "\"point3 P\" [" << positions << "]\n";
+    ofs << "\"integer indices\" [" << indices << "]\n";
+}
+
+/// Insert a comment at the end of an array. Arrays containing comments are parsed token by token.
+std::string addComment(const std::string& values)
+{
+    return values + "\n# Comment inside the array.\n";
+}
+
+struct MeshData
+{
+    uint32_t vertexCount = 0;
+    uint32_t triangleCount = 0;
+    std::vector<float3> positions;
+    std::vector<uint3> triangleIndices;
+};
+
+MeshData loadMesh(ref<Device> pDevice, const std::filesystem::path& path)
+{
+    ref<Scene> pScene = SceneBuilder(pDevice, path, Settings()).getScene();
+    MeshData data;
+    if (pScene->getMeshCount() != 1)
+        return data;
+
+    const auto& meshDesc = pScene->getMesh(MeshID{0});
+    data.vertexCount = meshDesc.vertexCount;
+    data.triangleCount = meshDesc.getTriangleCount();
+
+    std::map<std::string, ref<Buffer>> buffers = {
+        {"positions", pDevice->createStructuredBuffer(sizeof(float3), data.vertexCount)},
+        {"texcrds", pDevice->createStructuredBuffer(sizeof(float3), data.vertexCount)},
+        {"triangleIndices", pDevice->createStructuredBuffer(sizeof(uint3), data.triangleCount)},
+    };
+    pScene->getMeshVerticesAndIndices(MeshID{0}, buffers);
+    data.positions = buffers["positions"]->getElements<float3>();
+    data.triangleIndices = buffers["triangleIndices"]->getElements<uint3>();
+    return data;
+}
+
+/// Import a scene that is expected to fail and return the error message.
+std::string getImportError(ref<Device> pDevice, const std::filesystem::path& path)
+{
+    try
+    {
+        SceneBuilder(pDevice, path, Settings());
+    }
+    catch (const ImporterError& e)
+    {
+        return e.what();
+    }
+    return {};
+}
+
+/// Replace the value at the given offset and return the location string the parser reports for it.
+std::string replaceValue(std::string& values, size_t offset, const std::string& value, uint32_t firstLine)
+{
+    size_t end = values.find_first_of(" \t\r\n", offset);
+    values.replace(offset, end - offset, value);
+
+    // The column counts the characters before the value on its line, matching the tokenizer.
+    size_t lineStart = values.rfind('\n', offset);
+    FALCOR_ASSERT(lineStart != std::string::npos);
+    uint32_t line = firstLine + (uint32_t)std::count(values.begin(), values.begin() + offset, '\n');
+    uint32_t column = (uint32_t)(offset - lineStart - 1);
+    return fmt::format(":{}:{}: '{}'", line, column, value);
+}
+
+/// Find the start of the first value after the given offset.
+size_t findValue(const std::string& values, size_t offset)
+{
+    size_t pos = values.find_first_of(" \t\r\n", offset);
+    return values.find_first_not_of(" \t\r\n", pos);
+}
+} // namespace
+
+GPU_TEST(PBRTImporter_NumericArrays)
+{
+    PluginManager::instance().loadPluginByName("PBRTImporter");
+    ref<Device> pDevice = ctx.getDevice();
+
+    const std::string positions = formatPositions();
+    const std::string indices = formatIndices();
+    ASSERT_GT(positions.size(), 2u << 20);
+    ASSERT_GT(indices.size(), 2u << 20);
+
+    const auto path = std::filesystem::temp_directory_path() / "FalcorPBRTImporterTest.pbrt";
+
+    // Parallel parsing of the large arrays.
+    writeScene(path, positions, indices);
+    MeshData parallel = loadMesh(pDevice, path);
+
+    // Token by token parsing, as the arrays contain comments.
+    writeScene(path, addComment(positions), addComment(indices));
+    MeshData serial = loadMesh(pDevice, path);
+
+    std::filesystem::remove(path);
+
+    EXPECT_EQ(parallel.vertexCount, kGridWidth * kGridHeight);
+    EXPECT_EQ(parallel.triangleCount, 2 * (kGridWidth - 1) * (kGridHeight - 1));
+    EXPECT_EQ(parallel.vertexCount, serial.vertexCount);
+    EXPECT_EQ(parallel.triangleCount, serial.triangleCount);
+    EXPECT(parallel.positions == serial.positions);
+    EXPECT(parallel.triangleIndices == serial.triangleIndices);
+}
+
+GPU_TEST(PBRTImporter_NumericArrayErrors)
+{
+    PluginManager::instance().loadPluginByName("PBRTImporter");
+    ref<Device> pDevice = ctx.getDevice();
+
+    const std::string positions = formatPositions();
+    const std::string indices = formatIndices();
+    const auto path = std::filesystem::temp_directory_path() / "FalcorPBRTImporterErrorTest.pbrt";
+
+    // Invalid values deep inside the arrays, in the second chunk or later. Errors of both the parallel and the
+    // token by token path report the location of the offending value. The comment is added after the offending
+    // value, so that it doesn't shift its location.
+    const uint32_t indicesLine = kPositionsLine + (uint32_t)std::count(positions.begin(), positions.end(), '\n') + 1;
+    struct Case
+    {
+        bool inPositions;
+        size_t offset;
+        std::string value;
+    };
+    const Case cases[] = {
+        {true, positions.size() / 2, "1..5"},
+        {true, positions.size() - 100, "-"},
+        {false, indices.size() / 2, "1.5"},
+        {false, indices.size() * 3 / 4, "99999999999"},
+    };
+
+    for (const auto& c : cases)
+    {
+        std::string p = positions;
+        std::string i = indices;
+        std::string& values = c.inPositions ? p : i;
+        const uint32_t firstLine = c.inPositions ? kPositionsLine : indicesLine;
+        const std::string loc = replaceValue(values, findValue(values, c.offset), c.value, firstLine);
+
+        writeScene(path, p, i);
+        std::string parallelError = getImportError(pDevice, path);
+        values = addComment(values);
+        writeScene(path, p, i);
+        std::string serialError = getImportError(pDevice, path);
+
+        EXPECT(parallelError.find(loc) != std::string::npos) << parallelError << " (expected '" << loc << "')";
+        EXPECT(serialError.find(loc) != std::string::npos) << serialError << " (expected '" << loc << "')";
+    }
+
+    std::filesystem::remove(path);
+}
+} // namespace Falcor
@@ -0,0 +1,90 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SceneBuilder.h"
+#include "Scene/Material/StandardMaterial.h"
+
+namespace Falcor
+{
+namespace
+{
+ref<Scene> buildCubeScene(ref<Device> pDevice, SceneBuilder::Flags flags, const std::vector<float3>& translations)
+{
+    SceneBuilder builder(pDevice, Settings(), flags);
+    ref<Material> pMaterial = StandardMaterial::create(pDevice, "Cube");
+
+    // Each cube is added as a separate mesh, as done by importers that don't express instancing.
+    for (size_t i = 0; i < translations.size(); ++i)
+    {
+        auto pCube = TriangleMesh::createCube();
+        auto vertices = pCube->getVertices();
+        for (auto& vertex : vertices)
+            vertex.position += translations[i];
+        MeshID meshID = builder.addTriangleMesh(TriangleMesh::create(vertices, pCube->getIndices()), pMaterial);
+        NodeID nodeID = builder.addNode(SceneBuilder::Node{"Cube" + std::to_string(i), float4x4::identity(), float4x4::identity()});
+        builder.addMeshInstance(nodeID, meshID);
+    }
+
+    return builder.getScene();
+}
+} // namespace
+
+GPU_TEST(SceneBuilder_DeduplicateMeshes)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    const std::vector<float3> translations = {float3(0.f), float3(0.f), float3(0.f), float3(10.f, 0.f, 0.f)};
+
+    // Without deduplication each mesh is kept.
+    {
+        ref<Scene> pScene = buildCubeScene(pDevice, SceneBuilder::Flags::None, translations);
+        EXPECT_EQ(pScene->getMeshCount(), 4);
+        EXPECT_EQ(pScene->getSceneStats().deduplicatedMeshCount, 0);
+    }
+
+    // Identical meshes are merged, the translated mesh is kept.
+    {
+        ref<Scene> pScene = buildCubeScene(pDevice, SceneBuilder::Flags::DeduplicateMeshes, translations);
+        EXPECT_EQ(pScene->getMeshCount(), 2);
+        EXPECT_EQ(pScene->getGeometryInstanceCount(), 4);
+        EXPECT_EQ(pScene->getSceneStats().deduplicatedMeshCount, 2);
+        EXPECT_GT(pScene->getSceneStats().deduplicatedMeshMemoryInBytes, 0);
+    }
+
+    // Translated meshes are merged too.
+    {
+        ref<Scene> pScene = buildCubeScene(pDevice, SceneBuilder::Flags::DeduplicateTranslatedMeshes, translations);
+        EXPECT_EQ(pScene->getMeshCount(), 1);
+        EXPECT_EQ(pScene->getGeometryInstanceCount(), 4);
+        EXPECT_EQ(pScene->getSceneStats().deduplicatedMeshCount, 3);
+
+        // The merged instances keep their world space bounds.
+        const AABB& bounds = pScene->getSceneBounds();
+        EXPECT_GE(bounds.maxPoint.x, 10.f);
+    }
+}
+} // namespace Falcor
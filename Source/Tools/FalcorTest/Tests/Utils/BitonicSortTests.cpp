@@ -75,6 +75,7 @@ void testGpuSort(GPUUnitTestContext& ctx, BitonicSort& bitonicSort, const uint32
 }
 } // namespace
 
+// Not run on the CPU device, the sort relies on NVAPI shuffles and group barriers.
 #if FALCOR_NVAPI_AVAILABLE
 GPU_TEST(BitonicSort, Device::Type::D3D12)
 #else
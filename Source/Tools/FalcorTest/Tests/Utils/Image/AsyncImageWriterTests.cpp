@@ -0,0 +1,139 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/AsyncImageWriter.h"
+#include <nlohmann/json.hpp>
+#include <fstream>
+#include <string>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kWidth = 64;
+const uint32_t kHeight = 32;
+
+std::vector<uint8_t> createImage(uint32_t index)
+{
+    std::vector<uint8_t> data(kWidth * kHeight * 4);
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = uint8_t(i + index);
+    return data;
+}
+} // namespace
+
+CPU_TEST(AsyncImageWriter)
+{
+    const auto directory = std::filesystem::temp_directory_path() / "FalcorAsyncImageWriterTest";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    const uint32_t kImageCount = 16;
+
+    AsyncImageWriter::Options options;
+    options.threadCount = 3;
+    options.maxPendingImages = 2;
+    options.logPath = directory / "log.jsonl";
+    options.encoderOptions.pngCompressionLevel = 1;
+
+    {
+        AsyncImageWriter writer(options);
+        for (uint32_t i = 0; i < kImageCount; ++i)
+        {
+            uint64_t id = writer.write(
+                directory / fmt::format("image{}.png", i),
+                kWidth,
+                kHeight,
+                Bitmap::FileFormat::PngFile,
+                Bitmap::ExportFlags::ExportAlpha,
+                ResourceFormat::RGBA8Unorm,
+                createImage(i)
+            );
+            EXPECT_EQ(id, i);
+            EXPECT_LE(writer.getStats().pendingCount, options.maxPendingImages);
+        }
+
+        // Writing DDS files is not supported by Bitmap, so this request fails.
+        writer.write(
+            directory / "invalid.dds",
+            kWidth,
+            kHeight,
+            Bitmap::FileFormat::DdsFile,
+            Bitmap::ExportFlags::None,
+            ResourceFormat::RGBA8Unorm,
+            createImage(0)
+        );
+
+        writer.flush();
+
+        auto stats = writer.getStats();
+        EXPECT_EQ(stats.submittedCount, kImageCount + 1);
+        EXPECT_EQ(stats.writtenCount, kImageCount);
+        EXPECT_EQ(stats.failedCount, 1);
+        EXPECT_EQ(stats.pendingCount, 0);
+        EXPECT_LE(stats.maxPendingCount, options.maxPendingImages);
+    }
+
+    // Check that the images were written correctly.
+    for (uint32_t i = 0; i < kImageCount; ++i)
+    {
+        auto pBitmap = Bitmap::createFromFile(directory / fmt::format("image{}.png", i), true);
+        ASSERT(pBitmap != nullptr);
+        EXPECT_EQ(pBitmap->getWidth(), kWidth);
+        EXPECT_EQ(pBitmap->getHeight(), kHeight);
+        EXPECT_EQ(pBitmap->getSize(), kWidth * kHeight * 4);
+
+        // PNG files are loaded in BGRA order.
+        auto expected = createImage(i);
+        const uint8_t* pData = pBitmap->getData();
+        for (size_t p = 0; p < expected.size(); p += 4)
+        {
+            EXPECT_EQ(pData[p + 0], expected[p + 2]);
+            EXPECT_EQ(pData[p + 1], expected[p + 1]);
+            EXPECT_EQ(pData[p + 2], expected[p + 0]);
+            EXPECT_EQ(pData[p + 3], expected[p + 3]);
+        }
+    }
+
+    // Check that the log lists all images in submission order.
+    std::ifstream log(options.logPath);
+    std::string line;
+    uint32_t lineCount = 0;
+    while (std::getline(log, line))
+    {
+        auto entry = nlohmann::json::parse(line);
+        EXPECT_EQ(entry["id"].get<uint32_t>(), lineCount);
+        EXPECT_EQ(entry["success"].get<bool>(), lineCount < kImageCount);
+        lineCount++;
+    }
+    EXPECT_EQ(lineCount, kImageCount + 1);
+    log.close();
+
+    std::filesystem::remove_all(directory);
+}
+} // namespace Falcor
@@ -0,0 +1,275 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/ExrWriter.h"
+#include "Utils/Math/Float16.h"
+
+#include <ImfChannelList.h>
+#include <ImfFrameBuffer.h>
+#include <ImfHeader.h>
+#include <ImfInputPart.h>
+#include <ImfMultiPartInputFile.h>
+
+#include <cmath>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kWidth = 67;
+const uint32_t kHeight = 45;
+const size_t kPixelCount = size_t(kWidth) * kHeight;
+
+/// Test layers. All values are exactly representable as half.
+struct TestImage
+{
+    std::vector<float> color;     ///< RGBA32Float, stored as float.
+    std::vector<float> depth;     ///< R32Float, stored as float in channel Z.
+    std::vector<uint16_t> normal; ///< RGBA16Float, RGB stored as half.
+    std::vector<uint32_t> id;     ///< R32Uint, stored as uint.
+    std::vector<uint8_t> mask;    ///< R8Unorm, stored as half.
+
+    TestImage()
+    {
+        for (size_t i = 0; i < kPixelCount; ++i)
+        {
+            for (uint32_t c = 0; c < 4; ++c)
+            {
+                color.push_back(float(i % 97) + 0.25f * c);
+                normal.push_back(float16_t(float(c) - float(i % 13) / 8.f).toBits());
+            }
+            depth.push_back(float(i) * 0.5f);
+            id.push_back(uint32_t(i * 7919));
+            mask.push_back((i % 3) == 0 ? 255 : 0);
+        }
+    }
+
+    void addLayers(ExrWriter& writer) const
+    {
+        writer.addLayer("color", ResourceFormat::RGBA32Float, color.data(), ExrWriter::PixelType::Float);
+        writer.addLayer("depth", ResourceFormat::R32Float, depth.data(), ExrWriter::PixelType::Float, {"Z"});
+        writer.addLayer("normal", ResourceFormat::RGBA16Float, normal.data(), ExrWriter::PixelType::Half, {"R", "G", "B"});
+        writer.addLayer("id", ResourceFormat::R32Uint, id.data(), ExrWriter::PixelType::Uint);
+        writer.addLayer("mask", ResourceFormat::R8Unorm, std::vector<uint8_t>(mask), ExrWriter::PixelType::Half);
+    }
+};
+
+/// Read a channel of a part converted to float (or uint).
+template<typename T>
+std::vector<T> readChannel(Imf::InputPart& part, const std::string& name)
+{
+    const Imath::Box2i dataWindow = part.header().dataWindow();
+    const int width = dataWindow.max.x - dataWindow.min.x + 1;
+    std::vector<T> data(kPixelCount);
+    Imf::FrameBuffer frameBuffer;
+    char* pBase = reinterpret_cast<char*>(data.data()) - (dataWindow.min.x + dataWindow.min.y * width) * sizeof(T);
+    frameBuffer.insert(name, Imf::Slice(std::is_same_v<T, uint32_t> ? Imf::UINT : Imf::FLOAT, pBase, sizeof(T), sizeof(T) * width));
+    part.setFrameBuffer(frameBuffer);
+    part.readPixels(dataWindow.min.y, dataWindow.max.y);
+    return data;
+}
+
+void checkChannel(CPUUnitTestContext& ctx, Imf::InputPart& part, const std::string& name, Imf::PixelType type, const std::vector<float>& expected)
+{
+    const Imf::Channel* pChannel = part.header().channels().findChannel(name);
+    ASSERT_TRUE(pChannel != nullptr);
+    EXPECT_EQ((int)pChannel->type, (int)type);
+    auto data = readChannel<float>(part, name);
+    for (size_t i = 0; i < kPixelCount; ++i)
+    {
+        EXPECT_EQ(data[i], expected[i]) << "channel " << name << " i=" << i;
+    }
+}
+
+std::vector<float> getChannel(const std::vector<float>& data, uint32_t channelCount, uint32_t channel)
+{
+    std::vector<float> result(kPixelCount);
+    for (size_t i = 0; i < kPixelCount; ++i)
+        result[i] = data[i * channelCount + channel];
+    return result;
+}
+
+std::vector<float> getHalfChannel(const std::vector<uint16_t>& data, uint32_t channelCount, uint32_t channel)
+{
+    std::vector<float> result(kPixelCount);
+    for (size_t i = 0; i < kPixelCount; ++i)
+        result[i] = float16ToFloat32(data[i * channelCount + channel]);
+    return result;
+}
+
+void checkLayers(CPUUnitTestContext& ctx, Imf::MultiPartInputFile& file, const TestImage& image, bool multiPart)
+{
+    auto getPart = [&](const std::string& layer) -> int
+    {
+        if (!multiPart)
+            return 0;
+        for (int i = 0; i < file.parts(); ++i)
+            if (file.header(i).name() == layer)
+                return i;
+        return -1;
+    };
+    auto channelName = [&](const std::string& layer, const std::string& channel) { return multiPart ? channel : layer + "." + channel; };
+
+    const char* kRGBA[] = {"R", "G", "B", "A"};
+
+    {
+        Imf::InputPart part(file, getPart("color"));
+        for (uint32_t c = 0; c < 4; ++c)
+            checkChannel(ctx, part, channelName("color", kRGBA[c]), Imf::FLOAT, getChannel(image.color, 4, c));
+    }
+    {
+        Imf::InputPart part(file, getPart("depth"));
+        checkChannel(ctx, part, channelName("depth", "Z"), Imf::FLOAT, image.depth);
+    }
+    {
+        Imf::InputPart part(file, getPart("normal"));
+        for (uint32_t c = 0; c < 3; ++c)
+            checkChannel(ctx, part, channelName("normal", kRGBA[c]), Imf::HALF, getHalfChannel(image.normal, 4, c));
+        EXPECT(part.header().channels().findChannel(channelName("normal", "A")) == nullptr);
+    }
+    {
+        Imf::InputPart part(file, getPart("id"));
+        const std::string name = channelName("id", "R");
+        const Imf::Channel* pChannel = part.header().channels().findChannel(name);
+        ASSERT_TRUE(pChannel != nullptr);
+        EXPECT_EQ((int)pChannel->type, (int)Imf::UINT);
+        auto data = readChannel<uint32_t>(part, name);
+        for (size_t i = 0; i < kPixelCount; ++i)
+            EXPECT_EQ(data[i], image.id[i]) << "i=" << i;
+    }
+    {
+        Imf::InputPart part(file, getPart("mask"));
+        std::vector<float> expected(kPixelCount);
+        for (size_t i = 0; i < kPixelCount; ++i)
+            expected[i] = image.mask[i] / 255.f;
+        checkChannel(ctx, part, channelName("mask", "R"), Imf::HALF, expected);
+    }
+}
+} // namespace
+
+CPU_TEST(ExrWriter_MultiLayer)
+{
+    const auto path = std::filesystem::temp_directory_path() / "FalcorExrWriterMultiLayer.exr";
+    TestImage image;
+
+    ExrWriter::Options options;
+    options.compression = Bitmap::ExrCompression::Zip;
+    options.layout = ExrWriter::Layout::MultiLayer;
+    ExrWriter writer(kWidth, kHeight, options);
+    image.addLayers(writer);
+    EXPECT_EQ(writer.getLayerCount(), size_t(5));
+    writer.write(path);
+
+    Imf::MultiPartInputFile file(path.string().c_str());
+    ASSERT_EQ(file.parts(), 1);
+    EXPECT_EQ((int)file.header(0).compression(), (int)Imf::ZIP_COMPRESSION);
+    checkLayers(ctx, file, image, false);
+
+    std::filesystem::remove(path);
+}
+
+CPU_TEST(ExrWriter_MultiPartTiled)
+{
+    const auto path = std::filesystem::temp_directory_path() / "FalcorExrWriterMultiPart.exr";
+    TestImage image;
+
+    ExrWriter::Options options;
+    options.compression = Bitmap::ExrCompression::Piz;
+    options.layout = ExrWriter::Layout::MultiPart;
+    options.tiled = true;
+    options.tileSize = 16;
+    ExrWriter writer(kWidth, kHeight, options);
+    image.addLayers(writer);
+    writer.write(path);
+
+    Imf::MultiPartInputFile file(path.string().c_str());
+    ASSERT_EQ(file.parts(), 5);
+    for (int i = 0; i < file.parts(); ++i)
+    {
+        EXPECT(file.header(i).hasTileDescription());
+        EXPECT_EQ((int)file.header(i).compression(), (int)Imf::PIZ_COMPRESSION);
+    }
+    checkLayers(ctx, file, image, true);
+
+    std::filesystem::remove(path);
+}
+
+CPU_TEST(ExrWriter_Dwaa)
+{
+    // Lossy compression, only check that the file is readable and roughly matches.
+    const auto path = std::filesystem::temp_directory_path() / "FalcorExrWriterDwaa.exr";
+    std::vector<float> data(kPixelCount * 3);
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = float(i % 256) / 255.f;
+
+    ExrWriter::Options options;
+    options.compression = Bitmap::ExrCompression::Dwaa;
+    ExrWriter writer(kWidth, kHeight, options);
+    writer.addLayer("", ResourceFormat::RGB32Float, data.data(), ExrWriter::PixelType::Half);
+    writer.write(path);
+
+    Imf::MultiPartInputFile file(path.string().c_str());
+    ASSERT_EQ(file.parts(), 1);
+    EXPECT_EQ((int)file.header(0).compression(), (int)Imf::DWAA_COMPRESSION);
+    Imf::InputPart part(file, 0);
+    auto green = readChannel<float>(part, "G");
+    for (size_t i = 0; i < kPixelCount; ++i)
+        EXPECT_LE(std::abs(green[i] - data[i * 3 + 1]), 0.1f) << "i=" << i;
+
+    std::filesystem::remove(path);
+}
+
+CPU_TEST(ExrWriter_Conflicts)
+{
+    std::vector<float> data(kPixelCount * 4);
+
+    ExrWriter::Options options;
+    options.layout = ExrWriter::Layout::MultiLayer;
+    ExrWriter multiLayer(kWidth, kHeight, options);
+    multiLayer.addLayer("out", ResourceFormat::RGBA32Float, data.data(), ExrWriter::PixelType::Half, {"R", "G", "B"});
+    EXPECT(multiLayer.canAddLayer("out", {"A"}));
+    EXPECT(!multiLayer.canAddLayer("out", {"B"}));
+    EXPECT(!multiLayer.canAddLayer("out", {}));
+    EXPECT(multiLayer.canAddLayer("other", {"R"}));
+    EXPECT_THROW(multiLayer.addLayer("out", ResourceFormat::R32Float, data.data(), ExrWriter::PixelType::Half, {"G"}));
+
+    options.layout = ExrWriter::Layout::MultiPart;
+    ExrWriter multiPart(kWidth, kHeight, options);
+    multiPart.addLayer("out", ResourceFormat::R32Float, data.data());
+    EXPECT(!multiPart.canAddLayer("out", {"A"}));
+
+    // Unsupported formats, too many channel names and uint storage of float data.
+    EXPECT(!ExrWriter::isFormatSupported(ResourceFormat::BGRA8Unorm));
+    EXPECT_THROW(multiPart.addLayer("a", ResourceFormat::BGRA8Unorm, data.data()));
+    EXPECT_THROW(multiPart.addLayer("b", ResourceFormat::RG32Float, data.data(), ExrWriter::PixelType::Float, {"X", "Y", "Z"}));
+    EXPECT_THROW(multiPart.addLayer("c", ResourceFormat::R32Float, data.data(), ExrWriter::PixelType::Uint));
+}
+} // namespace Falcor
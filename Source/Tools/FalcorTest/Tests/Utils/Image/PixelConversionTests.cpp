@@ -0,0 +1,367 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/PixelConversion.h"
+#include "Utils/Math/Float16.h"
+#include "Utils/Color/ColorHelpers.slang"
+#include <fstd/bit.h> // TODO C++20: Replace with <bit>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+// 8K image dimensions used for benchmarks.
+const uint32_t kBenchmarkWidth = 7680;
+const uint32_t kBenchmarkHeight = 4320;
+const size_t kBenchmarkPixelCount = size_t(kBenchmarkWidth) * kBenchmarkHeight;
+
+// Scalar reference implementations.
+float clampUnit(float v)
+{
+    v = v > 0.f ? v : 0.f;
+    return v < 1.f ? v : 1.f;
+}
+
+uint8_t referenceUnorm8(float v)
+{
+    return uint8_t(clampUnit(v) * 255.f + 0.5f);
+}
+
+uint16_t referenceUnorm16(float v)
+{
+    return uint16_t(clampUnit(v) * 65535.f + 0.5f);
+}
+
+uint8_t referenceSrgb8(float v)
+{
+    return uint8_t(linearToSRGB(clampUnit(v)) * 255.f + 0.5f);
+}
+
+template<typename T>
+void testIntToFloat32(CPUUnitTestContext& ctx, const std::vector<T>& src)
+{
+    std::vector<float> dst(src.size());
+    convertIntToFloat32(src.data(), dst.data(), src.size());
+    for (size_t i = 0; i < src.size(); ++i)
+        EXPECT_EQ(fstd::bit_cast<uint32_t>(dst[i]), fstd::bit_cast<uint32_t>(float(src[i]) / float(std::numeric_limits<T>::max())));
+}
+
+/// Returns float values with special cases first followed by random values in the given range.
+std::vector<float> generateFloats(size_t count, float minValue, float maxValue)
+{
+    std::mt19937 rng;
+    std::uniform_real_distribution<float> dist(minValue, maxValue);
+    std::vector<float> values = {
+        0.f,
+        -0.f,
+        1.f,
+        -1.f,
+        0.5f,
+        std::numeric_limits<float>::infinity(),
+        -std::numeric_limits<float>::infinity(),
+        std::numeric_limits<float>::quiet_NaN(),
+        std::numeric_limits<float>::denorm_min(),
+        std::numeric_limits<float>::max(),
+    };
+    while (values.size() < count)
+        values.push_back(dist(rng));
+    return values;
+}
+} // namespace
+
+CPU_TEST(PixelConversion_Float16ToFloat32)
+{
+    // Test all float16 bit patterns.
+    std::vector<uint16_t> src(0x10000);
+    for (uint32_t i = 0; i < src.size(); ++i)
+        src[i] = (uint16_t)i;
+
+    std::vector<float> dst(src.size());
+    convertFloat16ToFloat32(src.data(), dst.data(), src.size());
+    for (uint32_t i = 0; i < src.size(); ++i)
+        EXPECT_EQ(fstd::bit_cast<uint32_t>(dst[i]), fstd::bit_cast<uint32_t>(math::float16ToFloat32(src[i])));
+}
+
+CPU_TEST(PixelConversion_Float32ToFloat16)
+{
+    // Test a strided subset of all float32 bit patterns. The stride is odd so all low bit patterns are covered,
+    // which includes the rounding cases. The count is not a multiple of the vector width to test the scalar tail.
+    const uint32_t kStride = 4099;
+    std::vector<float> src;
+    for (uint64_t bits = 0; bits <= std::numeric_limits<uint32_t>::max(); bits += kStride)
+        src.push_back(fstd::bit_cast<float>(uint32_t(bits)));
+    src.push_back(fstd::bit_cast<float>(0x33000000u)); // Exactly half the smallest denorm.
+    src.push_back(fstd::bit_cast<float>(0x387fe000u)); // Rounds up to the smallest normal.
+    src.push_back(fstd::bit_cast<float>(0x477ff000u)); // Rounds up to infinity.
+    src.push_back(fstd::bit_cast<float>(0x7f800001u)); // NaN with only low significand bits set.
+
+    std::vector<uint16_t> dst(src.size());
+    convertFloat32ToFloat16(src.data(), dst.data(), src.size());
+    for (size_t i = 0; i < src.size(); ++i)
+        EXPECT_EQ(dst[i], math::float32ToFloat16(src[i]));
+}
+
+CPU_TEST(PixelConversion_IntToFloat32)
+{
+    // Use an odd count to also exercise the scalar tail.
+    std::mt19937 rng;
+    const size_t kCount = 100003;
+
+    std::vector<uint8_t> u8(kCount);
+    std::vector<uint16_t> u16(kCount);
+    std::vector<int16_t> s16(kCount);
+    std::vector<uint32_t> u32(kCount);
+    std::vector<int32_t> s32(kCount);
+    for (size_t i = 0; i < kCount; ++i)
+    {
+        uint32_t r = rng();
+        u8[i] = (uint8_t)i;
+        u16[i] = (uint16_t)i;
+        s16[i] = (int16_t)i;
+        u32[i] = r;
+        s32[i] = (int32_t)r;
+    }
+
+    testIntToFloat32(ctx, u8);
+    testIntToFloat32(ctx, u16);
+    testIntToFloat32(ctx, s16);
+    testIntToFloat32(ctx, u32);
+    testIntToFloat32(ctx, s32);
+}
+
+CPU_TEST(PixelConversion_Float32ToUnorm)
+{
+    auto src = generateFloats(100003, -0.5f, 1.5f);
+
+    std::vector<uint8_t> u8(src.size());
+    std::vector<uint16_t> u16(src.size());
+    convertFloat32ToUnorm8(src.data(), u8.data(), src.size());
+    convertFloat32ToUnorm16(src.data(), u16.data(), src.size());
+    for (size_t i = 0; i < src.size(); ++i)
+    {
+        EXPECT_EQ(u8[i], referenceUnorm8(src[i]));
+        EXPECT_EQ(u16[i], referenceUnorm16(src[i]));
+    }
+}
+
+CPU_TEST(PixelConversion_Srgb)
+{
+    // Test decoding of all values.
+    std::vector<uint8_t> src8(256);
+    for (uint32_t i = 0; i < 256; ++i)
+        src8[i] = (uint8_t)i;
+
+    std::vector<float> decoded8(256);
+    convertSrgb8ToFloat32(src8.data(), decoded8.data(), src8.size());
+    for (uint32_t i = 0; i < 256; ++i)
+        EXPECT_EQ(fstd::bit_cast<uint32_t>(decoded8[i]), fstd::bit_cast<uint32_t>(sRGBToLinear(float(i) / 255.f)));
+
+    std::vector<uint8_t> encoded8(256);
+    convertFloat32ToSrgb8(decoded8.data(), encoded8.data(), decoded8.size());
+    for (uint32_t i = 0; i < 256; ++i)
+        EXPECT_EQ(encoded8[i], src8[i]);
+
+    // Test encoding round trips of all 8-bit values. The pixel count is not a multiple of the vector width.
+    const uint32_t kRoundTripPixelCount = 85;
+    std::vector<float> decoded(kRoundTripPixelCount * 4);
+    for (uint32_t i = 0; i < decoded.size(); ++i)
+        decoded[i] = (i % 4 == 3) ? float(i % 256) / 255.f : sRGBToLinear(float(i % 256) / 255.f);
+
+    std::vector<uint8_t> encoded(decoded.size());
+    convertRGBA32FloatToRGBA8Srgb(decoded.data(), encoded.data(), kRoundTripPixelCount);
+    for (uint32_t i = 0; i < encoded.size(); ++i)
+        EXPECT_EQ(encoded[i], i % 256) << "i = " << i;
+
+    // Test encoding of a strided subset of all float bit patterns in [0,1] and some values outside.
+    std::vector<float> src = generateFloats(10000, -0.5f, 1.5f);
+    for (uint32_t bits = 0; bits <= 0x3f800000; bits += 251)
+        src.push_back(fstd::bit_cast<float>(bits));
+    src.resize((src.size() + 3) / 4 * 4, 1.f);
+
+    const size_t pixelCount = src.size() / 4;
+    std::vector<uint8_t> dst(src.size());
+    convertRGBA32FloatToRGBA8Srgb(src.data(), dst.data(), pixelCount);
+    for (size_t i = 0; i < src.size(); ++i)
+        EXPECT_EQ(dst[i], i % 4 == 3 ? referenceUnorm8(src[i]) : referenceSrgb8(src[i])) << "i = " << i;
+
+    convertFloat32ToSrgb8(src.data(), dst.data(), src.size());
+    for (size_t i = 0; i < src.size(); ++i)
+        EXPECT_EQ(dst[i], referenceSrgb8(src[i])) << "i = " << i;
+}
+
+CPU_TEST(PixelConversion_Channels)
+{
+    const size_t kPixelCount = 1001;
+    auto src = generateFloats(kPixelCount * 4, -10.f, 10.f);
+
+    // Test expanding to RGBA.
+    for (uint32_t channelCount = 1; channelCount <= 4; ++channelCount)
+    {
+        std::vector<float> dst(kPixelCount * 4);
+        expandToRGBA32Float(src.data(), channelCount, dst.data(), kPixelCount);
+        for (size_t i = 0; i < kPixelCount; ++i)
+        {
+            for (uint32_t c = 0; c < 4; ++c)
+            {
+                float expected = c < channelCount ? src[i * channelCount + c] : (c == 3 ? 1.f : 0.f);
+                EXPECT_EQ(fstd::bit_cast<uint32_t>(dst[i * 4 + c]), fstd::bit_cast<uint32_t>(expected));
+            }
+        }
+    }
+
+    // Test extracting RGB.
+    std::vector<float> rgb(kPixelCount * 3);
+    extractRGBFromRGBA32Float(src.data(), rgb.data(), kPixelCount);
+    for (size_t i = 0; i < kPixelCount; ++i)
+        for (uint32_t c = 0; c < 3; ++c)
+            EXPECT_EQ(fstd::bit_cast<uint32_t>(rgb[i * 3 + c]), fstd::bit_cast<uint32_t>(src[i * 4 + c]));
+
+    // Test swizzling RGBA8 in place and out of place.
+    std::mt19937 rng;
+    std::vector<uint8_t> rgba8(kPixelCount * 4);
+    for (auto& v : rgba8)
+        v = (uint8_t)rng();
+
+    for (bool forceOpaque : {false, true})
+    {
+        std::vector<uint8_t> bgra8(rgba8.size());
+        swizzleRGBA8ToBGRA8(rgba8.data(), bgra8.data(), kPixelCount, forceOpaque);
+        for (size_t i = 0; i < kPixelCount; ++i)
+        {
+            EXPECT_EQ(bgra8[i * 4 + 0], rgba8[i * 4 + 2]);
+            EXPECT_EQ(bgra8[i * 4 + 1], rgba8[i * 4 + 1]);
+            EXPECT_EQ(bgra8[i * 4 + 2], rgba8[i * 4 + 0]);
+            EXPECT_EQ(bgra8[i * 4 + 3], forceOpaque ? 0xff : rgba8[i * 4 + 3]);
+        }
+
+        swizzleRGBA8ToBGRA8(bgra8.data(), bgra8.data(), kPixelCount, false);
+        for (size_t i = 0; i < kPixelCount; ++i)
+            for (uint32_t c = 0; c < 3; ++c)
+                EXPECT_EQ(bgra8[i * 4 + c], rgba8[i * 4 + c]);
+    }
+}
+
+CPU_TEST(PixelConversion_FlipRows)
+{
+    for (uint32_t rowCount : {0u, 1u, 2u, 7u})
+    {
+        const size_t kRowPitch = 13;
+        std::vector<uint8_t> data(rowCount * kRowPitch);
+        for (size_t i = 0; i < data.size(); ++i)
+            data[i] = (uint8_t)i;
+
+        std::vector<uint8_t> flipped = data;
+        flipRowsVertically(flipped.data(), kRowPitch, rowCount);
+        for (uint32_t y = 0; y < rowCount; ++y)
+            for (size_t x = 0; x < kRowPitch; ++x)
+                EXPECT_EQ(flipped[y * kRowPitch + x], data[(rowCount - y - 1) * kRowPitch + x]);
+    }
+}
+
+CPU_BENCHMARK(PixelConversion_Float16, TAGS("image"))
+{
+    const size_t count = kBenchmarkPixelCount * 4;
+    auto floats = generateFloats(count, -100.f, 100.f);
+    std::vector<uint16_t> halfs(count);
+
+    ctx.measure(
+        "float32ToFloat16_scalar",
+        [&]()
+        {
+            for (size_t i = 0; i < count; ++i)
+                halfs[i] = math::float32ToFloat16(floats[i]);
+        },
+        kBenchmarkPixelCount
+    );
+    ctx.measure("float32ToFloat16", [&]() { convertFloat32ToFloat16(floats.data(), halfs.data(), count); }, kBenchmarkPixelCount);
+
+    ctx.measure(
+        "float16ToFloat32_scalar",
+        [&]()
+        {
+            for (size_t i = 0; i < count; ++i)
+                floats[i] = math::float16ToFloat32(halfs[i]);
+        },
+        kBenchmarkPixelCount
+    );
+    ctx.measure("float16ToFloat32", [&]() { convertFloat16ToFloat32(halfs.data(), floats.data(), count); }, kBenchmarkPixelCount);
+}
+
+CPU_BENCHMARK(PixelConversion_Unorm8, TAGS("image"))
+{
+    const size_t count = kBenchmarkPixelCount * 4;
+    auto floats = generateFloats(count, 0.f, 1.f);
+    std::vector<uint8_t> bytes(count);
+
+    ctx.measure("unorm8ToFloat32", [&]() { convertIntToFloat32(bytes.data(), floats.data(), count); }, kBenchmarkPixelCount);
+    ctx.measure("float32ToUnorm8", [&]() { convertFloat32ToUnorm8(floats.data(), bytes.data(), count); }, kBenchmarkPixelCount);
+    ctx.measure(
+        "float32ToSrgb8_scalar",
+        [&]()
+        {
+            for (size_t i = 0; i < count; ++i)
+                bytes[i] = referenceSrgb8(floats[i]);
+        },
+        kBenchmarkPixelCount
+    );
+    ctx.measure("float32ToSrgb8", [&]() { convertFloat32ToSrgb8(floats.data(), bytes.data(), count); }, kBenchmarkPixelCount);
+    ctx.measure("srgb8ToFloat32", [&]() { convertSrgb8ToFloat32(bytes.data(), floats.data(), count); }, kBenchmarkPixelCount);
+    ctx.measure(
+        "rgba32FloatToRGBA8Srgb_scalar",
+        [&]()
+        {
+            for (size_t i = 0; i < count; ++i)
+                bytes[i] = i % 4 == 3 ? referenceUnorm8(floats[i]) : referenceSrgb8(floats[i]);
+        },
+        kBenchmarkPixelCount
+    );
+    ctx.measure(
+        "rgba32FloatToRGBA8Srgb", [&]() { convertRGBA32FloatToRGBA8Srgb(floats.data(), bytes.data(), kBenchmarkPixelCount); }, kBenchmarkPixelCount
+    );
+    ctx.measure(
+        "swizzleRGBA8ToBGRA8", [&]() { swizzleRGBA8ToBGRA8(bytes.data(), bytes.data(), kBenchmarkPixelCount, true); }, kBenchmarkPixelCount
+    );
+}
+
+CPU_BENCHMARK(PixelConversion_Channels, TAGS("image"))
+{
+    std::vector<float> rgb(kBenchmarkPixelCount * 3, 0.5f);
+    std::vector<float> rgba(kBenchmarkPixelCount * 4);
+
+    ctx.measure("expandRGBToRGBA", [&]() { expandToRGBA32Float(rgb.data(), 3, rgba.data(), kBenchmarkPixelCount); }, kBenchmarkPixelCount);
+    ctx.measure("extractRGB", [&]() { extractRGBFromRGBA32Float(rgba.data(), rgb.data(), kBenchmarkPixelCount); }, kBenchmarkPixelCount);
+    ctx.measure(
+        "flipRows",
+        [&]() { flipRowsVertically(rgba.data(), kBenchmarkWidth * 4 * sizeof(float), kBenchmarkHeight); },
+        kBenchmarkPixelCount
+    );
+}
+} // namespace Falcor
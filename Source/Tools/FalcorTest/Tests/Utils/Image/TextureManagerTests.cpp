@@ -27,6 +27,7 @@
  **************************************************************************/
 #include "Testing/UnitTest.h"
 #include "Utils/Image/TextureManager.h"
+#include "Utils/Image/TextureCache.h"
 
 namespace Falcor
 {
@@ -51,4 +52,123 @@ GPU_TEST(TextureManager_LoadMips)
     EXPECT_EQ(tex->getMipCount(), 3);
     EXPECT_EQ(tex->getArraySize(), 1);
 }
+
+GPU_TEST(TextureManager_TextureCache)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    std::filesystem::path path = getRuntimeDirectory() / "data/tests/texture1.png";
+
+    TextureCache::Options options;
+    options.directory = std::filesystem::temp_directory_path() / "FalcorTextureCacheTest";
+    std::filesystem::remove_all(options.directory);
+
+    ref<Texture> pRef = Texture::createFromFile(pDevice, path, true, false);
+    ASSERT(pRef != nullptr);
+    std::vector<uint8_t> refData = pDevice->getRenderContext()->readTextureSubresource(pRef.get(), 0);
+
+    // The first load populates the cache, the second load uses a new cache instance reading the same directory.
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        auto pTextureCache = std::make_shared<TextureCache>(options);
+        TextureManager textureManager(pDevice, 10);
+        textureManager.setTextureCache(pTextureCache);
+
+        auto handle = textureManager.loadTexture(path, true, false, ResourceBindFlags::ShaderResource, false);
+        ASSERT(handle.isValid());
+        auto pTex = textureManager.getTexture(handle);
+        ASSERT(pTex != nullptr);
+
+        auto stats = pTextureCache->getStats();
+        EXPECT_EQ(stats.hitCount, i == 0 ? 0 : 1);
+        EXPECT_EQ(stats.missCount, i == 0 ? 1 : 0);
+        EXPECT_GT(stats.sizeInBytes, 0);
+
+        EXPECT_EQ(pTex->getWidth(), pRef->getWidth());
+        EXPECT_EQ(pTex->getHeight(), pRef->getHeight());
+        EXPECT_EQ(pTex->getMipCount(), pRef->getMipCount());
+        EXPECT(pTex->getFormat() == pRef->getFormat());
+        EXPECT_EQ(pTex->getSourcePath(), path);
+
+        std::vector<uint8_t> data = pDevice->getRenderContext()->readTextureSubresource(pTex.get(), 0);
+        EXPECT(data == refData);
+    }
+
+    // Evicting everything empties the cache.
+    TextureCache textureCache(options);
+    textureCache.clear();
+    EXPECT_EQ(textureCache.getStats().sizeInBytes, 0);
+
+    std::filesystem::remove_all(options.directory);
+}
+GPU_TEST(TextureManager_Residency)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    RenderContext* pRenderContext = pDevice->getRenderContext();
+
+    std::filesystem::path path = getRuntimeDirectory() / "data/tests/texture1.png";
+
+    TextureCache::Options options;
+    options.directory = std::filesystem::temp_directory_path() / "FalcorTextureResidencyTest";
+    std::filesystem::remove_all(options.directory);
+
+    ref<Texture> pRef = Texture::createFromFile(pDevice, path, true, false);
+    ASSERT(pRef != nullptr);
+    ASSERT_EQ(pRef->getMipCount(), 6); // 33x59
+
+    TextureManager textureManager(pDevice, 10);
+    textureManager.setTextureCache(std::make_shared<TextureCache>(options));
+    TextureManager::ResidencyOptions residencyOptions;
+    residencyOptions.enabled = true;
+    residencyOptions.tailSize = 8;
+    textureManager.setResidencyOptions(residencyOptions);
+
+    auto handle = textureManager.loadTexture(path, true, false, ResourceBindFlags::ShaderResource, false);
+    ASSERT(handle.isValid());
+
+    // Only the mip tail starting at mip 3 (4x7) is loaded initially.
+    ref<Texture> pTail = textureManager.getTexture(handle);
+    ASSERT(pTail != nullptr);
+    EXPECT_EQ(pTail->getWidth(), 4);
+    EXPECT_EQ(pTail->getHeight(), 7);
+    EXPECT_EQ(pTail->getMipCount(), 3);
+    EXPECT(pRenderContext->readTextureSubresource(pTail.get(), 0) == pRenderContext->readTextureSubresource(pRef.get(), 3));
+    EXPECT(!textureManager.updateResidency(pRenderContext));
+
+    // Requesting a screen size through the mip tail texture referenced by materials streams in the required mip levels.
+    textureManager.requestTextureScreenSize(pTail.get(), 20.f); // 59 / 20 texels per pixel -> mip 1
+    EXPECT(textureManager.updateResidency(pRenderContext));
+    EXPECT_EQ(textureManager.getTexture(handle)->getWidth(), 16);
+    EXPECT_EQ(textureManager.getTexture(handle)->getHeight(), 29);
+    EXPECT_EQ(textureManager.getTexture(handle)->getMipCount(), 5);
+
+    // Requesting the most detailed mip level streams in the remaining mip levels.
+    textureManager.requestTextureMip(handle, 0);
+    EXPECT(textureManager.updateResidency(pRenderContext));
+    ref<Texture> pTex = textureManager.getTexture(handle);
+    ASSERT(pTex != nullptr);
+    EXPECT_EQ(pTex->getWidth(), pRef->getWidth());
+    EXPECT_EQ(pTex->getHeight(), pRef->getHeight());
+    ASSERT_EQ(pTex->getMipCount(), pRef->getMipCount());
+    EXPECT_EQ(pTex->getSourcePath(), path);
+    for (uint32_t mip = 0; mip < pRef->getMipCount(); ++mip)
+        EXPECT(pRenderContext->readTextureSubresource(pTex.get(), mip) == pRenderContext->readTextureSubresource(pRef.get(), mip));
+
+    // Both the mip tail texture referenced by materials and the streamed texture map to the same handle.
+    EXPECT(textureManager.addTexture(pTail) == handle);
+    EXPECT(textureManager.addTexture(pTex) == handle);
+
+    // Reducing the budget evicts the streamed mip levels, but not the mip tail.
+    residencyOptions.scheduler.budgetInBytes = 0;
+    textureManager.setResidencyOptions(residencyOptions);
+    EXPECT(textureManager.updateResidency(pRenderContext));
+    EXPECT_EQ(textureManager.getTexture(handle)->getMipCount(), 3);
+    EXPECT_EQ(textureManager.getResidencyStats().evictCount, 3);
+
+    textureManager.removeTexture(handle);
+    EXPECT_EQ(textureManager.getResidencyStats().textureCount, 0);
+    EXPECT_EQ(textureManager.getResidencyStats().residentBytes, 0);
+
+    std::filesystem::remove_all(options.directory);
+}
 } // namespace Falcor
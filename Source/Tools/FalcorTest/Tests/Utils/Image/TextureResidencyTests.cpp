@@ -0,0 +1,241 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/TextureResidency.h"
+#include <limits>
+
+namespace Falcor
+{
+namespace
+{
+/// Mip sizes of a square RGBA8 texture with the given dimension.
+std::vector<uint64_t> getMipSizes(uint32_t size)
+{
+    std::vector<uint64_t> mipSizes;
+    for (uint32_t dim = size; dim > 0; dim /= 2)
+        mipSizes.push_back(uint64_t(dim) * dim * 4);
+    return mipSizes;
+}
+
+uint64_t sum(const std::vector<uint64_t>& sizes, uint32_t first, uint32_t last)
+{
+    uint64_t result = 0;
+    for (uint32_t i = first; i < last; ++i)
+        result += sizes[i];
+    return result;
+}
+} // namespace
+
+CPU_TEST(TextureResidency_Tail)
+{
+    TextureResidencyScheduler scheduler;
+
+    auto mipSizes = getMipSizes(1024); // 11 levels
+    scheduler.addTexture(0, mipSizes, 4);
+    scheduler.addTexture(1, mipSizes, 4);
+
+    EXPECT_EQ(scheduler.getResidentMip(0), 4);
+    EXPECT_EQ(scheduler.getTailMip(1), 4);
+    EXPECT_EQ(scheduler.getStats().residentBytes, 2 * sum(mipSizes, 4, 11));
+    EXPECT_EQ(scheduler.getStats().tailBytes, 2 * sum(mipSizes, 4, 11));
+
+    // Without requests nothing changes.
+    EXPECT(scheduler.update().empty());
+
+    // Requests coarser than the tail are clamped.
+    scheduler.requestMip(0, 8);
+    EXPECT(scheduler.update().empty());
+
+    scheduler.removeTexture(0);
+    scheduler.removeTexture(1);
+    EXPECT(!scheduler.hasTexture(0));
+    EXPECT_EQ(scheduler.getStats().residentBytes, 0);
+    EXPECT_EQ(scheduler.getStats().tailBytes, 0);
+    EXPECT_EQ(scheduler.getStats().textureCount, 0);
+}
+
+CPU_TEST(TextureResidency_Load)
+{
+    auto mipSizes = getMipSizes(1024);
+
+    TextureResidencyScheduler::Options options;
+    options.budgetInBytes = 1ull << 30;
+    options.maxLoadBytesPerUpdate = 1ull << 30;
+    TextureResidencyScheduler scheduler(options);
+    scheduler.addTexture(0, mipSizes, 4);
+    scheduler.addTexture(1, mipSizes, 4);
+
+    // All requested mips are loaded in one update when there is no streaming limit.
+    scheduler.requestMip(0, 2);
+    scheduler.requestMip(0, 3); // The most detailed request in a frame wins.
+    auto changes = scheduler.update();
+    ASSERT_EQ(changes.size(), 1);
+    EXPECT_EQ(changes[0].textureID, 0);
+    EXPECT_EQ(changes[0].prevResidentMip, 4);
+    EXPECT_EQ(changes[0].residentMip, 2);
+    EXPECT_EQ(scheduler.getResidentMip(0), 2);
+    EXPECT_EQ(scheduler.getResidentMip(1), 4);
+    EXPECT_EQ(scheduler.getStats().loadCount, 2);
+    EXPECT_EQ(scheduler.getStats().loadedBytes, sum(mipSizes, 2, 4));
+    EXPECT_EQ(scheduler.getStats().residentBytes, sum(mipSizes, 2, 11) + sum(mipSizes, 4, 11));
+
+    // Requesting a coarser mip later does not evict loaded mips while within budget.
+    scheduler.requestMip(0, 4);
+    EXPECT(scheduler.update().empty());
+    EXPECT_EQ(scheduler.getResidentMip(0), 2);
+}
+
+CPU_TEST(TextureResidency_StreamingLimit)
+{
+    auto mipSizes = getMipSizes(1024);
+
+    TextureResidencyScheduler::Options options;
+    options.maxLoadBytesPerUpdate = mipSizes[3] + mipSizes[3];
+    TextureResidencyScheduler scheduler(options);
+    scheduler.addTexture(0, mipSizes, 4);
+    scheduler.addTexture(1, mipSizes, 4);
+
+    // Both textures get one mip level per round, so the limit allows mip 3 of both.
+    scheduler.requestMip(0, 0);
+    scheduler.requestMip(1, 0);
+    auto changes = scheduler.update();
+    ASSERT_EQ(changes.size(), 2);
+    EXPECT_EQ(scheduler.getResidentMip(0), 3);
+    EXPECT_EQ(scheduler.getResidentMip(1), 3);
+
+    // Loads continue in later updates while the textures are requested every frame.
+    // A single mip level larger than the limit is still loaded, coarser textures are loaded first.
+    auto requestAndUpdate = [&]()
+    {
+        scheduler.requestMip(0, 0);
+        scheduler.requestMip(1, 0);
+        scheduler.update();
+    };
+    requestAndUpdate();
+    EXPECT_EQ(scheduler.getResidentMip(0), 2);
+    EXPECT_EQ(scheduler.getResidentMip(1), 3);
+    requestAndUpdate();
+    EXPECT_EQ(scheduler.getResidentMip(1), 2);
+
+    for (uint32_t i = 0; i < 10; ++i)
+        requestAndUpdate();
+    EXPECT_EQ(scheduler.getResidentMip(0), 0);
+    EXPECT_EQ(scheduler.getResidentMip(1), 0);
+}
+
+CPU_TEST(TextureResidency_StaleRequest)
+{
+    auto mipSizes = getMipSizes(1024);
+
+    TextureResidencyScheduler::Options options;
+    options.maxLoadBytesPerUpdate = mipSizes[3];
+    TextureResidencyScheduler scheduler(options);
+    scheduler.addTexture(0, mipSizes, 4);
+
+    scheduler.requestMip(0, 0);
+    scheduler.update();
+    EXPECT_EQ(scheduler.getResidentMip(0), 3);
+
+    // Without a new request the texture only requests its mip tail, so no further mips are loaded.
+    for (uint32_t i = 0; i < 4; ++i)
+        EXPECT(scheduler.update().empty());
+    EXPECT_EQ(scheduler.getResidentMip(0), 3);
+    EXPECT_EQ(scheduler.getStats().loadCount, 1);
+}
+
+CPU_TEST(TextureResidency_Evict)
+{
+    auto mipSizes = getMipSizes(1024);
+    const uint64_t tailBytes = sum(mipSizes, 4, 11);
+
+    // The budget fits the tails of three textures and mip levels [1, 4) of one texture.
+    TextureResidencyScheduler::Options options;
+    options.budgetInBytes = 3 * tailBytes + sum(mipSizes, 1, 4);
+    options.maxLoadBytesPerUpdate = 1ull << 30;
+    TextureResidencyScheduler scheduler(options);
+    for (uint32_t i = 0; i < 3; ++i)
+        scheduler.addTexture(i, mipSizes, 4);
+
+    scheduler.requestMip(0, 1);
+    scheduler.update();
+    EXPECT_EQ(scheduler.getResidentMip(0), 1);
+
+    // Texture 1 is requested later, so the finest mip level of texture 0 is evicted to make room.
+    scheduler.requestMip(1, 2);
+    auto changes = scheduler.update();
+    ASSERT_EQ(changes.size(), 2);
+    EXPECT_EQ(changes[0].textureID, 0);
+    EXPECT_EQ(changes[0].residentMip, 2);
+    EXPECT_EQ(changes[1].textureID, 1);
+    EXPECT_EQ(changes[1].residentMip, 2);
+    EXPECT_EQ(scheduler.getStats().evictCount, 1);
+    EXPECT_LE(scheduler.getStats().residentBytes, options.budgetInBytes);
+
+    // Textures requested in the same frame don't evict each other, the most recently requested texture keeps its mips.
+    scheduler.requestMip(1, 2);
+    scheduler.requestMip(2, 0);
+    scheduler.update();
+    EXPECT_EQ(scheduler.getResidentMip(1), 2);
+    EXPECT_EQ(scheduler.getResidentMip(0), 4);
+    EXPECT_LE(scheduler.getStats().residentBytes, options.budgetInBytes);
+
+    // Mip tails are never evicted, even if the budget is reduced below their size.
+    options.budgetInBytes = 0;
+    scheduler.setOptions(options);
+    scheduler.update();
+    for (uint32_t i = 0; i < 3; ++i)
+        EXPECT_EQ(scheduler.getResidentMip(i), 4);
+    EXPECT_EQ(scheduler.getStats().residentBytes, 3 * tailBytes);
+}
+
+CPU_TEST(TextureResidency_RequiredMip)
+{
+    // The required mip level is the coarsest one with at least one texel per pixel.
+    EXPECT_EQ(TextureResidencyScheduler::computeRequiredMip(1024, std::numeric_limits<float>::infinity()), 0);
+    EXPECT_EQ(TextureResidencyScheduler::computeRequiredMip(1024, 2048.f), 0);
+    EXPECT_EQ(TextureResidencyScheduler::computeRequiredMip(1024, 1024.f), 0);
+    EXPECT_EQ(TextureResidencyScheduler::computeRequiredMip(1024, 1000.f), 0);
+    EXPECT_EQ(TextureResidencyScheduler::computeRequiredMip(1024, 512.f), 1);
+    EXPECT_EQ(TextureResidencyScheduler::computeRequiredMip(1024, 300.f), 1);
+    EXPECT_EQ(TextureResidencyScheduler::computeRequiredMip(1024, 256.f), 2);
+    EXPECT_EQ(TextureResidencyScheduler::computeRequiredMip(59, 20.f), 1);
+
+    // Sub-pixel sizes request the 1x1 mip level, which is clamped to the mip tail by requestMip().
+    EXPECT_EQ(TextureResidencyScheduler::computeRequiredMip(1024, 1.f), 10);
+    EXPECT_EQ(TextureResidencyScheduler::computeRequiredMip(1024, 0.f), 10);
+
+    TextureResidencyScheduler scheduler;
+    scheduler.addTexture(0, getMipSizes(1024), 4);
+    scheduler.requestMip(0, TextureResidencyScheduler::computeRequiredMip(1024, 0.f));
+    scheduler.update();
+    EXPECT_EQ(scheduler.getResidentMip(0), 4);
+    scheduler.requestMip(0, TextureResidencyScheduler::computeRequiredMip(1024, 300.f));
+    scheduler.update();
+    EXPECT_EQ(scheduler.getResidentMip(0), 1);
+}
+} // namespace Falcor
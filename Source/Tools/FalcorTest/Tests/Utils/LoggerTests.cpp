@@ -0,0 +1,145 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Logger.h"
+#include <nlohmann/json.hpp>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+/// Redirects the logger to a JSON-lines file and restores the previous settings on destruction.
+class ScopedJsonLog
+{
+public:
+    ScopedJsonLog(const std::filesystem::path& path, Logger::OutputFlags outputs)
+        : mOutputs(Logger::getOutputs()), mJsonLogFilePath(Logger::getJsonLogFilePath()), mOverflowPolicy(Logger::getOverflowPolicy())
+    {
+        Logger::setJsonLogFilePath(path);
+        Logger::setOutputs(outputs);
+    }
+
+    ~ScopedJsonLog()
+    {
+        Logger::setOutputs(mOutputs);
+        Logger::setJsonLogFilePath(mJsonLogFilePath);
+        Logger::setOverflowPolicy(mOverflowPolicy);
+    }
+
+private:
+    Logger::OutputFlags mOutputs;
+    std::filesystem::path mJsonLogFilePath;
+    Logger::OverflowPolicy mOverflowPolicy;
+};
+
+/// Read all entries of a JSON-lines log whose message starts with the given prefix.
+std::vector<nlohmann::json> readEntries(const std::filesystem::path& path, const std::string& prefix)
+{
+    std::vector<nlohmann::json> entries;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line))
+    {
+        auto entry = nlohmann::json::parse(line);
+        if (entry["msg"].get<std::string>().rfind(prefix, 0) == 0)
+            entries.push_back(entry);
+    }
+    return entries;
+}
+} // namespace
+
+CPU_TEST(Logger_JsonSink)
+{
+    const auto path = std::filesystem::temp_directory_path() / "FalcorLoggerJsonSink.jsonl";
+    {
+        ScopedJsonLog scopedLog(path, Logger::OutputFlags::JsonFile);
+        logWarning("LoggerJsonSink \"quoted\"\nsecond line");
+        logError("LoggerJsonSink error");
+    }
+
+    auto entries = readEntries(path, "LoggerJsonSink");
+    ASSERT_EQ(entries.size(), size_t(2));
+    EXPECT_EQ(entries[0]["level"].get<std::string>(), "Warning");
+    EXPECT_EQ(entries[0]["msg"].get<std::string>(), "LoggerJsonSink \"quoted\"\nsecond line");
+    EXPECT_EQ(entries[1]["level"].get<std::string>(), "Error");
+    EXPECT_EQ(entries[1]["msg"].get<std::string>(), "LoggerJsonSink error");
+    EXPECT_LT(entries[0]["seq"].get<uint64_t>(), entries[1]["seq"].get<uint64_t>());
+
+    std::filesystem::remove(path);
+}
+
+CPU_TEST(Logger_Async)
+{
+    const auto path = std::filesystem::temp_directory_path() / "FalcorLoggerAsync.jsonl";
+    const uint32_t kThreadCount = 4;
+    const uint32_t kMessageCount = 5000; // More than fits into a thread's queue.
+
+    {
+        ScopedJsonLog scopedLog(path, Logger::OutputFlags::JsonFile | Logger::OutputFlags::Async);
+        Logger::setOverflowPolicy(Logger::OverflowPolicy::Block);
+
+        const uint64_t droppedCount = Logger::getDroppedMessageCount();
+        std::vector<std::thread> threads;
+        for (uint32_t t = 0; t < kThreadCount; ++t)
+        {
+            threads.emplace_back(
+                [t]()
+                {
+                    for (uint32_t i = 0; i < kMessageCount; ++i)
+                        logWarning("LoggerAsync {} {}", t, i);
+                }
+            );
+        }
+        for (auto& thread : threads)
+            thread.join();
+
+        Logger::flush();
+        EXPECT_EQ(Logger::getDroppedMessageCount(), droppedCount);
+    }
+
+    // All messages are written, in order per thread.
+    auto entries = readEntries(path, "LoggerAsync");
+    ASSERT_EQ(entries.size(), size_t(kThreadCount * kMessageCount));
+    std::vector<uint32_t> nextIndex(kThreadCount, 0);
+    for (const auto& entry : entries)
+    {
+        uint32_t t = 0, i = 0;
+        ASSERT_EQ(std::sscanf(entry["msg"].get<std::string>().c_str(), "LoggerAsync %u %u", &t, &i), 2);
+        ASSERT_LT(t, kThreadCount);
+        EXPECT_EQ(i, nextIndex[t]);
+        nextIndex[t] = i + 1;
+    }
+
+    std::filesystem::remove(path);
+}
+} // namespace Falcor
@@ -282,6 +282,35 @@ CPU_TEST(Matrix_inverse)
     }
 }
 
+CPU_BENCHMARK(Matrix_mulInverse, TAGS("math"))
+{
+    std::vector<float4x4> matrices(4096);
+    for (size_t i = 0; i < matrices.size(); ++i)
+        matrices[i] = math::matrixFromTranslation(float3(float(i), 1.f, 2.f)) * math::matrixFromScaling(float3(1.f + i % 7));
+
+    ctx.measure(
+        "mul",
+        [&]()
+        {
+            float4x4 result;
+            for (const auto& m : matrices)
+                result = mul(result, m);
+            unittest::doNotOptimize(result);
+        },
+        matrices.size()
+    );
+
+    ctx.measure(
+        "inverse",
+        [&]()
+        {
+            for (const auto& m : matrices)
+                unittest::doNotOptimize(inverse(m));
+        },
+        matrices.size()
+    );
+}
+
 CPU_TEST(Matrix_extractEulerAngleXYZ)
 {
     {
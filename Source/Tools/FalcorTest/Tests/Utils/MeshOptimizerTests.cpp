@@ -0,0 +1,157 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Geometry/MeshOptimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+/// Create a planar grid of n x n quads in the xy-plane, with the triangles in random order.
+void createShuffledGrid(uint32_t n, std::vector<uint32_t>& indices, std::vector<float3>& positions)
+{
+    positions.clear();
+    for (uint32_t y = 0; y <= n; ++y)
+        for (uint32_t x = 0; x <= n; ++x)
+            positions.push_back(float3(float(x), float(y), 0.f));
+
+    std::vector<std::array<uint32_t, 3>> triangles;
+    for (uint32_t y = 0; y < n; ++y)
+    {
+        for (uint32_t x = 0; x < n; ++x)
+        {
+            uint32_t i = y * (n + 1) + x;
+            triangles.push_back({i, i + 1, i + n + 2});
+            triangles.push_back({i, i + n + 2, i + n + 1});
+        }
+    }
+    std::shuffle(triangles.begin(), triangles.end(), std::mt19937(1));
+
+    indices.clear();
+    for (const auto& triangle : triangles)
+        indices.insert(indices.end(), triangle.begin(), triangle.end());
+}
+
+std::vector<std::array<uint32_t, 3>> getSortedTriangles(fstd::span<const uint32_t> indices)
+{
+    std::vector<std::array<uint32_t, 3>> triangles;
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        // Rotate each triangle so the smallest index comes first, which preserves the winding.
+        std::array<uint32_t, 3> triangle = {indices[i], indices[i + 1], indices[i + 2]};
+        std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+        triangles.push_back(triangle);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+} // namespace
+
+CPU_TEST(MeshOptimizer_AnalyzeVertexCache)
+{
+    // Two triangles sharing an edge need 4 transforms with any cache size.
+    std::vector<uint32_t> indices = {0, 1, 2, 2, 1, 3};
+    VertexCacheStats stats = analyzeVertexCache(indices, 4);
+    EXPECT_EQ(stats.triangleCount, 2);
+    EXPECT_EQ(stats.vertexCount, 4);
+    EXPECT_EQ(stats.transformCount, 4);
+    EXPECT_EQ(stats.getACMR(), 2.f);
+    EXPECT_EQ(stats.getATVR(), 1.f);
+
+    // With a FIFO cache of 3 entries, vertex 3 evicts vertex 0, which in turn evicts vertex 1.
+    indices = {0, 1, 2, 1, 2, 3, 3, 0, 1};
+    stats = analyzeVertexCache(indices, 4, 3);
+    EXPECT_EQ(stats.transformCount, 6);
+}
+
+CPU_TEST(MeshOptimizer_OptimizeVertexCache)
+{
+    std::vector<uint32_t> indices;
+    std::vector<float3> positions;
+    createShuffledGrid(64, indices, positions);
+    const uint32_t vertexCount = (uint32_t)positions.size();
+
+    VertexCacheStats before = analyzeVertexCache(indices, vertexCount);
+    std::vector<uint32_t> optimized = optimizeVertexCache(indices, vertexCount);
+    VertexCacheStats after = analyzeVertexCache(optimized, vertexCount);
+
+    // The same triangles with the same winding are emitted, with a better cache hit rate.
+    EXPECT(getSortedTriangles(indices) == getSortedTriangles(optimized));
+    EXPECT_LT(after.getACMR(), before.getACMR());
+    EXPECT_LT(after.getACMR(), 1.f);
+    EXPECT_LT(after.getATVR(), 1.6f);
+}
+
+CPU_TEST(MeshOptimizer_OptimizeVertexFetch)
+{
+    // Vertex 3 is unreferenced.
+    std::vector<uint32_t> indices = {4, 2, 0, 0, 2, 1};
+    std::vector<uint32_t> remap = optimizeVertexFetch(indices, 5);
+
+    EXPECT(indices == std::vector<uint32_t>({0, 1, 2, 2, 1, 3}));
+    EXPECT(remap == std::vector<uint32_t>({2, 3, 1, 4, 0}));
+}
+
+CPU_TEST(MeshOptimizer_BuildMeshlets)
+{
+    std::vector<uint32_t> indices;
+    std::vector<float3> positions;
+    createShuffledGrid(32, indices, positions);
+    indices = optimizeVertexCache(indices, (uint32_t)positions.size());
+
+    const uint32_t maxVertices = 64;
+    const uint32_t maxTriangles = 124;
+    std::vector<Meshlet> meshlets = buildMeshlets(indices, positions, maxVertices, maxTriangles);
+
+    // Meshlets cover all triangles in order and respect the limits.
+    uint32_t triangleOffset = 0;
+    for (const auto& meshlet : meshlets)
+    {
+        EXPECT_EQ(meshlet.triangleOffset, triangleOffset);
+        EXPECT_GT(meshlet.triangleCount, 0);
+        EXPECT_LE(meshlet.triangleCount, maxTriangles);
+        EXPECT_LE(meshlet.vertexCount, maxVertices);
+        triangleOffset += meshlet.triangleCount;
+
+        // All triangles of the grid face +z.
+        EXPECT_GE(meshlet.coneAxis.z, 0.999f);
+        EXPECT_GE(meshlet.coneCutoff, 0.999f);
+        EXPECT_EQ(meshlet.bounds.minPoint.z, 0.f);
+        EXPECT_EQ(meshlet.bounds.maxPoint.z, 0.f);
+    }
+    EXPECT_EQ(triangleOffset, indices.size() / 3);
+
+    // Cache optimized triangles are packed into few meshlets.
+    EXPECT_LT(meshlets.size(), 2 * indices.size() / 3 / maxTriangles + 2);
+}
+} // namespace Falcor
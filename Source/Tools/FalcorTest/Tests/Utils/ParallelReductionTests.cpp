@@ -277,6 +277,7 @@ void testReduction(GPUUnitTestContext& ctx, ParallelReduction& reduction, Resour
 }
 } // namespace
 
+// Not run on the CPU device, the reduction kernels use wave operations and group barriers, which the host-callable target does not support.
 GPU_TEST(ParallelReduction)
 {
     // Quick test of the snorm/unorm data types we use.
@@ -88,6 +88,7 @@ void testPrefixSum(GPUUnitTestContext& ctx, PrefixSum& prefixSum, uint32_t numEl
 }
 } // namespace
 
+// Not run on the CPU device, the scan kernels synchronize thread groups with barriers, which the host-callable target does not support.
 GPU_TEST(PrefixSum)
 {
     // Quick test of our reference function.
@@ -0,0 +1,203 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Algorithm/RadixSort.h"
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+// Stable sort of the keys (and values) on the low 'keyBits' key bits.
+template<typename T>
+void radixSortRef(std::vector<T>& keys, std::vector<uint32_t>& values, uint32_t keyBits)
+{
+    const T mask = keyBits < sizeof(T) * 8 ? (T(1) << keyBits) - 1 : ~T(0);
+
+    std::vector<uint32_t> order(keys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return (keys[a] & mask) < (keys[b] & mask); });
+
+    std::vector<T> sortedKeys(keys.size());
+    for (size_t i = 0; i < order.size(); i++)
+        sortedKeys[i] = keys[order[i]];
+    keys = std::move(sortedKeys);
+
+    if (!values.empty())
+    {
+        std::vector<uint32_t> sortedValues(values.size());
+        for (size_t i = 0; i < order.size(); i++)
+            sortedValues[i] = values[order[i]];
+        values = std::move(sortedValues);
+    }
+}
+
+template<typename T>
+void testRadixSort(GPUUnitTestContext& ctx, RadixSort& radixSort, uint32_t n, bool sortValues, uint32_t keyBits, uint32_t keyRange = 0)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    const RadixSort::KeyType keyType = sizeof(T) == 8 ? RadixSort::KeyType::Uint64 : RadixSort::KeyType::Uint32;
+
+    // Create random keys. A small key range is used to test the stability of the sort with many equal keys.
+    std::vector<T> keys(n);
+    std::mt19937_64 r;
+    for (auto& it : keys)
+        it = keyRange > 0 ? T(r() % keyRange) : T(r());
+
+    std::vector<uint32_t> values;
+    if (sortValues)
+    {
+        values.resize(n);
+        std::iota(values.begin(), values.end(), 0);
+    }
+
+    ref<Buffer> pKeys = pDevice->createBuffer(n * sizeof(T), ResourceBindFlags::UnorderedAccess, MemoryType::DeviceLocal, keys.data());
+    ref<Buffer> pValues = sortValues ? pDevice->createBuffer(
+                                           n * sizeof(uint32_t), ResourceBindFlags::UnorderedAccess, MemoryType::DeviceLocal, values.data()
+                                       )
+                                     : nullptr;
+
+    // Execute sort on the GPU.
+    radixSort.execute(ctx.getRenderContext(), pKeys, pValues, n, keyType, keyBits);
+
+    // Sort on the CPU for comparison.
+    radixSortRef(keys, values, keyBits == 0 ? uint32_t(sizeof(T) * 8) : keyBits);
+
+    // Compare results.
+    std::vector<T> resultKeys = pKeys->getElements<T>(0, n);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        EXPECT_EQ(keys[i], resultKeys[i]) << "i = " << i << " n = " << n;
+    }
+
+    if (sortValues)
+    {
+        std::vector<uint32_t> resultValues = pValues->getElements<uint32_t>(0, n);
+        for (uint32_t i = 0; i < n; i++)
+        {
+            EXPECT_EQ(values[i], resultValues[i]) << "i = " << i << " n = " << n;
+        }
+    }
+}
+
+template<typename T>
+void benchmarkRadixSort(GPUBenchmarkContext& ctx, const char* name, uint32_t n, bool sortValues)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    const RadixSort::KeyType keyType = sizeof(T) == 8 ? RadixSort::KeyType::Uint64 : RadixSort::KeyType::Uint32;
+
+    std::vector<T> keys(n);
+    std::mt19937_64 r;
+    for (auto& it : keys)
+        it = T(r());
+
+    ref<Buffer> pKeys = pDevice->createBuffer(n * sizeof(T), ResourceBindFlags::UnorderedAccess, MemoryType::DeviceLocal, keys.data());
+    ref<Buffer> pValues =
+        sortValues ? pDevice->createBuffer(n * sizeof(uint32_t), ResourceBindFlags::UnorderedAccess, MemoryType::DeviceLocal) : nullptr;
+
+    RadixSort radixSort(pDevice);
+    ctx.measure(
+        fmt::format("{}/{}", name, n), [&]() { radixSort.execute(ctx.getRenderContext(), pKeys, pValues, n, keyType); }, n
+    );
+}
+} // namespace
+
+CPU_TEST(RadixSortRef)
+{
+    // Quick test of our reference function, including stability with respect to the sorted bits.
+    std::vector<uint32_t> keys({0x13, 0x02, 0x21, 0x03, 0x11});
+    std::vector<uint32_t> values({0, 1, 2, 3, 4});
+    radixSortRef(keys, values, 4);
+    EXPECT(keys == std::vector<uint32_t>({0x21, 0x11, 0x02, 0x13, 0x03}));
+    EXPECT(values == std::vector<uint32_t>({2, 4, 1, 0, 3}));
+
+    std::vector<uint64_t> keys64({3ull << 40, 1, 2ull << 40});
+    std::vector<uint32_t> noValues;
+    radixSortRef(keys64, noValues, 64);
+    EXPECT(keys64 == std::vector<uint64_t>({1, 2ull << 40, 3ull << 40}));
+}
+
+GPU_TEST(RadixSort32)
+{
+    RadixSort radixSort(ctx.getDevice());
+
+    for (uint32_t n : {1u, 27u, 2049u, 10201u, 231917u, 1088921u})
+    {
+        testRadixSort<uint32_t>(ctx, radixSort, n, false, 0);
+        testRadixSort<uint32_t>(ctx, radixSort, n, true, 0);
+    }
+}
+
+GPU_TEST(RadixSort32KeyBits)
+{
+    RadixSort radixSort(ctx.getDevice());
+
+    // Sorting on fewer bits than the key size, including an odd number of passes.
+    testRadixSort<uint32_t>(ctx, radixSort, 231917, true, 30);
+    testRadixSort<uint32_t>(ctx, radixSort, 231917, true, 20);
+    testRadixSort<uint32_t>(ctx, radixSort, 231917, true, 8);
+    testRadixSort<uint32_t>(ctx, radixSort, 231917, true, 1);
+
+    // Many equal keys.
+    testRadixSort<uint32_t>(ctx, radixSort, 231917, true, 0, 7);
+}
+
+GPU_TEST(RadixSort64)
+{
+    RadixSort radixSort(ctx.getDevice());
+
+    for (uint32_t n : {1u, 27u, 2049u, 231917u, 1088921u})
+    {
+        testRadixSort<uint64_t>(ctx, radixSort, n, false, 0);
+        testRadixSort<uint64_t>(ctx, radixSort, n, true, 0);
+    }
+
+    testRadixSort<uint64_t>(ctx, radixSort, 231917, true, 48);
+    testRadixSort<uint64_t>(ctx, radixSort, 231917, true, 0, 1000);
+}
+
+GPU_BENCHMARK(RadixSort32)
+{
+    for (uint32_t n : {1u << 20, 1u << 22, 1u << 24})
+    {
+        benchmarkRadixSort<uint32_t>(ctx, "keys", n, false);
+        benchmarkRadixSort<uint32_t>(ctx, "pairs", n, true);
+    }
+}
+
+GPU_BENCHMARK(RadixSort64)
+{
+    for (uint32_t n : {1u << 20, 1u << 22, 1u << 24})
+    {
+        benchmarkRadixSort<uint64_t>(ctx, "keys", n, false);
+        benchmarkRadixSort<uint64_t>(ctx, "pairs", n, true);
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,162 @@
+/***************************************************************************
+ # Copyright (c) 2015-24, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Algorithm/SegmentedScan.h"
+#include <random>
+#include <type_traits>
+
+namespace Falcor
+{
+namespace
+{
+// Segmented scan of 'elems' in place. A nonzero flag starts a new segment.
+template<typename T>
+void segmentedScanRef(std::vector<T>& elems, const std::vector<uint32_t>& flags, SegmentedScan::Mode mode)
+{
+    T sum = T(0);
+    for (size_t i = 0; i < elems.size(); i++)
+    {
+        if (flags[i] != 0)
+            sum = T(0);
+        T tmp = elems[i];
+        elems[i] = mode == SegmentedScan::Mode::Inclusive ? sum + tmp : sum;
+        sum += tmp;
+    }
+}
+
+template<typename T>
+void testSegmentedScan(
+    GPUUnitTestContext& ctx,
+    SegmentedScan& segmentedScan,
+    uint32_t n,
+    uint32_t meanSegmentLength,
+    SegmentedScan::Mode mode,
+    bool inPlace
+)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    const SegmentedScan::Type type = std::is_same_v<T, float> ? SegmentedScan::Type::Float32 : SegmentedScan::Type::Uint32;
+
+    // Create random data and segment flags. A mean segment length of zero creates a single segment.
+    // Floats are small integers, so the sums are exact regardless of the order of summation.
+    std::vector<T> testData(n);
+    std::vector<uint32_t> flags(n, 0);
+    std::mt19937 r;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        testData[i] = T(r() % 16);
+        flags[i] = meanSegmentLength > 0 && r() % meanSegmentLength == 0 ? 1 : 0;
+    }
+    flags[0] = 1;
+
+    ref<Buffer> pInput = pDevice->createBuffer(n * sizeof(T), ResourceBindFlags::UnorderedAccess, MemoryType::DeviceLocal, testData.data());
+    ref<Buffer> pFlags =
+        pDevice->createBuffer(n * sizeof(uint32_t), ResourceBindFlags::UnorderedAccess, MemoryType::DeviceLocal, flags.data());
+    ref<Buffer> pOutput = inPlace ? pInput : pDevice->createBuffer(n * sizeof(T), ResourceBindFlags::UnorderedAccess, MemoryType::DeviceLocal);
+
+    // Execute scan on the GPU.
+    segmentedScan.execute(ctx.getRenderContext(), pInput, pFlags, pOutput, n, type, mode);
+
+    // Compute scan on the CPU for comparison.
+    segmentedScanRef(testData, flags, mode);
+
+    // Compare results.
+    std::vector<T> result = pOutput->getElements<T>(0, n);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        EXPECT_EQ(testData[i], result[i]) << "i = " << i << " n = " << n;
+    }
+}
+
+void benchmarkSegmentedScan(GPUBenchmarkContext& ctx, uint32_t n, SegmentedScan::Type type)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    std::vector<uint32_t> flags(n, 0);
+    std::mt19937 r;
+    for (auto& it : flags)
+        it = r() % 64 == 0 ? 1 : 0;
+
+    ref<Buffer> pInput = pDevice->createBuffer(n * sizeof(uint32_t), ResourceBindFlags::UnorderedAccess, MemoryType::DeviceLocal);
+    ref<Buffer> pFlags =
+        pDevice->createBuffer(n * sizeof(uint32_t), ResourceBindFlags::UnorderedAccess, MemoryType::DeviceLocal, flags.data());
+    ref<Buffer> pOutput = pDevice->createBuffer(n * sizeof(uint32_t), ResourceBindFlags::UnorderedAccess, MemoryType::DeviceLocal);
+
+    SegmentedScan segmentedScan(pDevice);
+    ctx.measure(
+        fmt::format("{}/{}", type == SegmentedScan::Type::Float32 ? "float" : "uint", n),
+        [&]() { segmentedScan.execute(ctx.getRenderContext(), pInput, pFlags, pOutput, n, type); },
+        n
+    );
+}
+} // namespace
+
+CPU_TEST(SegmentedScanRef)
+{
+    // Quick test of our reference function.
+    const std::vector<uint32_t> flags({1, 0, 0, 1, 0});
+    std::vector<uint32_t> x({5, 17, 2, 9, 23});
+    segmentedScanRef(x, flags, SegmentedScan::Mode::Inclusive);
+    EXPECT(x == std::vector<uint32_t>({5, 22, 24, 9, 32}));
+
+    std::vector<uint32_t> y({5, 17, 2, 9, 23});
+    segmentedScanRef(y, flags, SegmentedScan::Mode::Exclusive);
+    EXPECT(y == std::vector<uint32_t>({0, 5, 22, 0, 9}));
+}
+
+GPU_TEST(SegmentedScan)
+{
+    SegmentedScan segmentedScan(ctx.getDevice());
+
+    for (auto mode : {SegmentedScan::Mode::Inclusive, SegmentedScan::Mode::Exclusive})
+    {
+        for (uint32_t n : {1u, 27u, 1024u, 2049u, 231917u, 1088921u})
+        {
+            testSegmentedScan<uint32_t>(ctx, segmentedScan, n, 100, mode, false);
+            testSegmentedScan<uint32_t>(ctx, segmentedScan, n, 0, mode, false);
+            testSegmentedScan<float>(ctx, segmentedScan, n, 100, mode, false);
+        }
+
+        // Long segments spanning several blocks and every element a segment.
+        testSegmentedScan<uint32_t>(ctx, segmentedScan, 231917, 5000, mode, false);
+        testSegmentedScan<uint32_t>(ctx, segmentedScan, 231917, 1, mode, false);
+
+        // In-place scan.
+        testSegmentedScan<uint32_t>(ctx, segmentedScan, 231917, 100, mode, true);
+    }
+}
+
+GPU_BENCHMARK(SegmentedScan)
+{
+    for (uint32_t n : {1u << 20, 1u << 22, 1u << 24})
+    {
+        benchmarkSegmentedScan(ctx, n, SegmentedScan::Type::Uint32);
+        benchmarkSegmentedScan(ctx, n, SegmentedScan::Type::Float32);
+    }
+}
+} // namespace Falcor
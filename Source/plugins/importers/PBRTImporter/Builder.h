@@ -54,7 +54,7 @@ std::string to_string(const MaterialRef& materialRef);
 struct SceneEntity
 {
     SceneEntity() = default;
-    SceneEntity(const std::string& name, ParameterDictionary params, FileLoc loc) : name(name), loc(loc), params(params) {}
+    SceneEntity(const std::string& name, ParameterDictionary params, FileLoc loc) : name(name), loc(loc), params(std::move(params)) {}
 
     std::string toString() const { return fmt::format("SceneEntity(name='{}', params={})", name, params.toString()); }
 
@@ -67,7 +67,7 @@ struct MaterialSceneEntity : public SceneEntity
 {
     MaterialSceneEntity() = default;
     MaterialSceneEntity(const std::string& name, const std::string& type, ParameterDictionary params, FileLoc loc)
-        : SceneEntity(name, params, loc), type(type)
+        : SceneEntity(name, std::move(params), loc), type(type)
     {}
 
     std::string toString() const
@@ -82,7 +82,7 @@ struct TransformedSceneEntity : public SceneEntity
 {
     TransformedSceneEntity() = default;
     TransformedSceneEntity(const std::string& name, ParameterDictionary params, FileLoc loc, const float4x4& transform)
-        : SceneEntity(name, params, loc), transform(transform)
+        : SceneEntity(name, std::move(params), loc), transform(transform)
     {}
 
     std::string toString() const
@@ -103,7 +103,7 @@ struct CameraSceneEntity : public TransformedSceneEntity
         const float4x4& transform,
         const std::string& medium
     )
-        : TransformedSceneEntity(name, params, loc, transform), medium(medium)
+        : TransformedSceneEntity(name, std::move(params), loc, transform), medium(medium)
     {}
 
     std::string toString() const
@@ -120,7 +120,7 @@ struct LightSceneEntity : public TransformedSceneEntity
 {
     LightSceneEntity() = default;
     LightSceneEntity(const std::string& name, ParameterDictionary params, FileLoc loc, const float4x4& transform, const std::string& medium)
-        : TransformedSceneEntity(name, params, loc, transform), medium(medium)
+        : TransformedSceneEntity(name, std::move(params), loc, transform), medium(medium)
     {}
 
     std::string toString() const
@@ -137,7 +137,7 @@ struct MediumSceneEntity : public TransformedSceneEntity
 {
     MediumSceneEntity() = default;
     MediumSceneEntity(const std::string& name, ParameterDictionary params, FileLoc loc, const float4x4& transform)
-        : TransformedSceneEntity(name, params, loc, transform)
+        : TransformedSceneEntity(name, std::move(params), loc, transform)
     {}
 
     std::string toString() const
@@ -150,7 +150,7 @@ struct TextureSceneEntity : public TransformedSceneEntity
 {
     TextureSceneEntity() = default;
     TextureSceneEntity(const std::string& name, ParameterDictionary params, FileLoc loc, const float4x4& transform)
-        : TransformedSceneEntity(name, params, loc, transform)
+        : TransformedSceneEntity(name, std::move(params), loc, transform)
     {}
 
     std::string toString() const
@@ -173,7 +173,7 @@ struct ShapeSceneEntity : public TransformedSceneEntity
         const std::string& insideMedium,
         const std::string& outsideMedium
     )
-        : TransformedSceneEntity(name, params, loc, transform)
+        : TransformedSceneEntity(name, std::move(params), loc, transform)
         , reverseOrientation(reverseOrientation)
         , materialRef(materialRef)
         , lightIndex(lightIndex)
@@ -1519,16 +1519,18 @@ Shape createShape(BuilderContext& ctx, const ShapeSceneEntity& entity)
         // Int[] indices, Point3[] P, Point2[] uv, Vector3[] S, Normal3[] N, Int[] faceIndices
         warnUnsupportedParameters(params, {"S", "faceIndices"});
 
-        auto indices = params.getIntArray("indices");
-        auto P = params.getPoint3Array("P");
-        auto N = params.getNormalArray("N");
-        auto uv = params.getPoint2Array("uv");
+        // Large meshes are read through views of the parsed parameter storage to avoid intermediate copies.
+        auto indices = params.getIntArrayView("indices");
+        auto P = params.getPoint3ArrayView("P");
+        auto N = params.getNormalArrayView("N");
+        auto uv = params.getPoint2ArrayView("uv");
 
+        static const int kSingleTriangleIndices[] = {0, 1, 2};
         if (indices.empty())
         {
             if (P.size() == 3)
             {
-                indices = {0, 1, 2};
+                indices = kSingleTriangleIndices;
             }
             else
             {
@@ -1541,8 +1543,7 @@ Shape createShape(BuilderContext& ctx, const ShapeSceneEntity& entity)
             logWarning(
                 entity.loc, "Number of vertex indices {} is not a multiple of 3. Discarding {} indices.", indices.size(), indices.size() % 3
             );
-            while (indices.size() % 3 != 0)
-                indices.pop_back();
+            indices = indices.first(indices.size() - indices.size() % 3);
         }
         if (P.empty())
         {
@@ -1577,9 +1578,7 @@ Shape createShape(BuilderContext& ctx, const ShapeSceneEntity& entity)
             vertex.texCoord = uv.empty() ? float2(0.f) : uv[i];
         }
 
-        Falcor::TriangleMesh::IndexList indexList(indices.size());
-        for (size_t i = 0; i < indices.size(); ++i)
-            indexList[i] = indices[i];
+        Falcor::TriangleMesh::IndexList indexList(indices.begin(), indices.end());
 
         shape.pTriangleMesh = Falcor::TriangleMesh::create(std::move(vertexList), std::move(indexList));
         shape.transform = entity.transform;
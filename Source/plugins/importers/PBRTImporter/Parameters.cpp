@@ -193,13 +193,13 @@ struct ParameterTypeTraits<ParameterType::Normal>
 // --------------------------------------------------------------------
 
 ParameterDictionary::ParameterDictionary(ParsedParameterVector params, const RGBColorSpace* pColorSpace)
-    : mParams(params), mpColorSpace(pColorSpace)
+    : mParams(std::move(params)), mpColorSpace(pColorSpace)
 {}
 
 ParameterDictionary::ParameterDictionary(ParsedParameterVector params1, ParsedParameterVector params2, const RGBColorSpace* pColorSpace)
-    : mParams(params1), mpColorSpace(pColorSpace)
+    : mParams(std::move(params1)), mpColorSpace(pColorSpace)
 {
-    mParams.insert(mParams.end(), params2.begin(), params2.end());
+    mParams.insert(mParams.end(), std::make_move_iterator(params2.begin()), std::make_move_iterator(params2.end()));
 }
 
 FileLoc ParameterDictionary::getParameterLoc(const std::string& name) const
@@ -422,6 +422,26 @@ std::vector<Spectrum> ParameterDictionary::getSpectrumArray(const std::string& n
     return {};
 }
 
+fstd::span<const int> ParameterDictionary::getIntArrayView(const std::string& name) const
+{
+    return lookupArrayView<ParameterType::Int>(name);
+}
+
+fstd::span<const float2> ParameterDictionary::getPoint2ArrayView(const std::string& name) const
+{
+    return lookupArrayView<ParameterType::Point2>(name);
+}
+
+fstd::span<const float3> ParameterDictionary::getPoint3ArrayView(const std::string& name) const
+{
+    return lookupArrayView<ParameterType::Point3>(name);
+}
+
+fstd::span<const float3> ParameterDictionary::getNormalArrayView(const std::string& name) const
+{
+    return lookupArrayView<ParameterType::Normal>(name);
+}
+
 std::string ParameterDictionary::toString() const
 {
     std::string str;
@@ -502,6 +522,32 @@ std::vector<typename ParameterTypeTraits<PT>::ReturnType> ParameterDictionary::l
     return {};
 }
 
+template<ParameterType PT>
+fstd::span<const typename ParameterTypeTraits<PT>::ReturnType> ParameterDictionary::lookupArrayView(const std::string& name) const
+{
+    using traits = ParameterTypeTraits<PT>;
+    using ReturnType = typename traits::ReturnType;
+    for (const auto& param : mParams)
+    {
+        if (param.name != name || param.type != traits::typeName)
+            continue;
+
+        // The values are reinterpreted as an array of items, which requires the item type to be tightly packed.
+        const auto& values = traits::getValues(param);
+        using ValueType = typename std::decay_t<decltype(values)>::value_type;
+        static_assert(sizeof(ReturnType) == traits::perItemCount * sizeof(ValueType));
+
+        if (values.empty())
+            throwError(param.loc, "No values provided for parameter '{}'.", param.name);
+        if (values.size() % traits::perItemCount)
+            throwError(param.loc, "Number of values provided for '{}' not a multiple of {}.", param.name, traits::perItemCount);
+
+        return fstd::span<const ReturnType>(reinterpret_cast<const ReturnType*>(values.data()), values.size() / traits::perItemCount);
+    }
+
+    return {};
+}
+
 std::vector<Spectrum> ParameterDictionary::extractSpectrumArray(const ParsedParameter& param, Resolver resolver) const
 {
     if (param.type == "rgb")
@@ -36,6 +36,7 @@
 #include "Types.h"
 #include "Utils/Math/Vector.h"
 #include "Utils/Color/Spectrum.h"
+#include <fstd/span.h>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -140,6 +141,15 @@ public:
     std::vector<float3> getNormalArray(const std::string& name) const;
     std::vector<Spectrum> getSpectrumArray(const std::string& name, Resolver resolver) const;
 
+    /**
+     * Get array parameters without copying their values.
+     * The returned views are valid as long as the dictionary is alive.
+     */
+    fstd::span<const int> getIntArrayView(const std::string& name) const;
+    fstd::span<const float2> getPoint2ArrayView(const std::string& name) const;
+    fstd::span<const float3> getPoint3ArrayView(const std::string& name) const;
+    fstd::span<const float3> getNormalArrayView(const std::string& name) const;
+
     std::string toString() const;
 
 private:
@@ -154,6 +164,9 @@ private:
     template<ParameterType PT>
     std::vector<typename ParameterTypeTraits<PT>::ReturnType> lookupArray(const std::string& name) const;
 
+    template<ParameterType PT>
+    fstd::span<const typename ParameterTypeTraits<PT>::ReturnType> lookupArrayView(const std::string& name) const;
+
     std::vector<Spectrum> extractSpectrumArray(const ParsedParameter& param, Resolver resolver) const;
 
     ParsedParameterVector mParams;
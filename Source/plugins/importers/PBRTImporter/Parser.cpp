@@ -36,15 +36,27 @@
 #include "Core/Error.h"
 #include "Core/Platform/OS.h"
 #include "Utils/Logger.h"
+#include "Utils/NumericRange.h"
 
 #include <fast_float/fast_float.h>
 
+#include <algorithm>
 #include <atomic>
+#include <exception>
+#include <execution>
+#include <numeric>
 #include <utility>
 #include <charconv>
 
 namespace Falcor::pbrt
 {
+namespace
+{
+/// Minimum size in bytes of numeric arrays that are parsed with the fast path. Smaller arrays are tokenized value by value.
+const size_t kNumericArrayMinSize = 1024;
+/// Size in bytes of the chunks that numeric arrays are split into for parallel parsing.
+const size_t kNumericArrayChunkSize = 1 << 20;
+} // namespace
 
 ParserTarget::~ParserTarget() {}
 
@@ -222,6 +234,44 @@ std::optional<Token> Tokenizer::next()
     }
 }
 
+std::optional<Token> Tokenizer::scanNumericArray(size_t minSize)
+{
+    auto isNumeric = [](char ch)
+    {
+        return (ch >= '0' && ch <= '9') || ch == '-' || ch == '+' || ch == '.' || ch == 'e' || ch == 'E' || ch == ' ' || ch == '\t' ||
+               ch == '\r';
+    };
+
+    const char* p = mPos;
+    const char* lineStart = nullptr;
+    uint32_t lineCount = 0;
+    for (; p < mEnd && *p != ']'; ++p)
+    {
+        if (*p == '\n')
+        {
+            ++lineCount;
+            lineStart = p + 1;
+        }
+        else if (!isNumeric(*p))
+        {
+            return {};
+        }
+    }
+
+    // Leave errors like a missing closing bracket to the regular tokenizer.
+    if (p == mEnd || size_t(p - mPos) < minSize)
+        return {};
+
+    Token token({mPos, size_t(p - mPos)}, mLoc);
+
+    // Skip past the closing bracket.
+    mLoc.line += lineCount;
+    mLoc.column = lineStart ? uint32_t(p - lineStart) + 1 : mLoc.column + uint32_t(p - mPos) + 1;
+    mPos = p + 1;
+
+    return token;
+}
+
 static int32_t parseInt(const Token& t)
 {
     auto begin = t.token.data();
@@ -261,6 +311,123 @@ static Float parseFloat(const Token& t)
     return value;
 }
 
+/**
+ * Parse a whitespace separated list of numbers.
+ * Large lists are split into chunks at whitespace boundaries, which are counted and parsed in parallel
+ * directly into the exactly sized result.
+ */
+template<typename T, typename ParseValue>
+static std::vector<T> parseNumericArray(const Token& t, ParseValue parseValue)
+{
+    const std::string_view str = t.token;
+    auto isSpace = [](char ch) { return ch == ' ' || ch == '\n' || ch == '\t' || ch == '\r'; };
+
+    // Split into chunks.
+    const size_t chunkCount = std::max<size_t>(1, str.size() / kNumericArrayChunkSize);
+    std::vector<std::string_view> chunks;
+    chunks.reserve(chunkCount);
+    size_t chunkBegin = 0;
+    for (size_t i = 0; i < chunkCount; ++i)
+    {
+        size_t chunkEnd = i + 1 == chunkCount ? str.size() : std::max(chunkBegin, str.size() * (i + 1) / chunkCount);
+        while (chunkEnd < str.size() && !isSpace(str[chunkEnd]))
+            ++chunkEnd;
+        chunks.push_back(str.substr(chunkBegin, chunkEnd - chunkBegin));
+        chunkBegin = chunkEnd;
+    }
+
+    // Calls func for each value in a chunk.
+    auto forEachValue = [&](std::string_view chunk, auto func)
+    {
+        size_t pos = 0;
+        while (true)
+        {
+            while (pos < chunk.size() && isSpace(chunk[pos]))
+                ++pos;
+            if (pos == chunk.size())
+                break;
+            size_t end = pos;
+            while (end < chunk.size() && !isSpace(chunk[end]))
+                ++end;
+            func(chunk.substr(pos, end - pos));
+            pos = end;
+        }
+    };
+
+    auto forEachChunk = [&](auto func)
+    {
+        NumericRange<size_t> chunkRange(0, chunks.size());
+        if (chunks.size() == 1)
+            func(0);
+        else
+            std::for_each(std::execution::par, chunkRange.begin(), chunkRange.end(), func);
+    };
+
+    // Count the values to compute the offset of each chunk.
+    std::vector<size_t> offsets(chunks.size() + 1, 0);
+    forEachChunk([&](size_t i) { forEachValue(chunks[i], [&](std::string_view) { offsets[i + 1]++; }); });
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+    // Compute the file location of a value the same way the tokenizer does. This is only needed for error reporting.
+    auto getValueLoc = [&](std::string_view value)
+    {
+        FileLoc loc = t.loc;
+        for (const char* p = str.data(); p < value.data(); ++p)
+        {
+            if (*p == '\n')
+            {
+                ++loc.line;
+                loc.column = 0;
+            }
+            else
+            {
+                ++loc.column;
+            }
+        }
+        return loc;
+    };
+
+    // Parse the values. Exceptions can't propagate out of parallel algorithms, so they are rethrown afterwards.
+    std::vector<T> values(offsets.back());
+    std::vector<std::exception_ptr> errors(chunks.size());
+    forEachChunk(
+        [&](size_t i)
+        {
+            try
+            {
+                T* pValue = values.data() + offsets[i];
+                forEachValue(
+                    chunks[i],
+                    [&](std::string_view value)
+                    {
+                        try
+                        {
+                            *pValue++ = parseValue(Token(value, t.loc));
+                        }
+                        catch (const RuntimeError&)
+                        {
+                            // Parse the value again with its own location, so that the error reports the offending value.
+                            parseValue(Token(value, getValueLoc(value)));
+                            throw;
+                        }
+                    }
+                );
+            }
+            catch (...)
+            {
+                errors[i] = std::current_exception();
+            }
+        }
+    );
+    for (const auto& error : errors)
+    {
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    return values;
+}
+
 inline bool isQuotedString(const std::string_view str)
 {
     return str.size() >= 2 && str[0] == '"' && str.back() == '"';
@@ -279,8 +446,8 @@ static std::string_view dequoteString(const Token& t)
 constexpr uint32_t TokenOptional = 0;
 constexpr uint32_t TokenRequired = 1;
 
-template<typename Next, typename Unget>
-static ParsedParameterVector parseParameters(Next nextToken, Unget ungetToken)
+template<typename Next, typename Unget, typename ScanNumericArray>
+static ParsedParameterVector parseParameters(Next nextToken, Unget ungetToken, ScanNumericArray scanNumericArray)
 {
     ParsedParameterVector parameterVector;
 
@@ -429,6 +596,21 @@ static ParsedParameterVector parseParameters(Next nextToken, Unget ungetToken)
 
         if (val.token == "[")
         {
+            // Fast path for large numeric arrays, such as vertex data. Type mismatches are reported by the regular path.
+            std::optional<Token> values;
+            if (valType != String && valType != Bool)
+                values = scanNumericArray();
+            if (values)
+            {
+                if (valType == Int)
+                    param.ints = parseNumericArray<int>(*values, parseInt);
+                else
+                    param.floats = parseNumericArray<pbrt::Float>(*values, parseFloat);
+
+                parameterVector.push_back(std::move(param));
+                continue;
+            }
+
             while (true)
             {
                 val = *nextToken(TokenRequired);
@@ -442,7 +624,7 @@ static ParsedParameterVector parseParameters(Next nextToken, Unget ungetToken)
             addVal(val);
         }
 
-        parameterVector.push_back(param);
+        parameterVector.push_back(std::move(param));
     }
 
     return parameterVector;
@@ -505,6 +687,16 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
         ungetToken = t;
     };
 
+    /**
+     * Helper function that scans the values of a numeric array in the current file.
+     */
+    auto scanNumericArray = [&]() -> std::optional<Token>
+    {
+        if (ungetToken.has_value() || fileStack.empty())
+            return {};
+        return fileStack.back()->scanNumericArray(kNumericArrayMinSize);
+    };
+
     /**
      * Helper function for pbrt API entrypoints that take a single string
      * parameter and a ParameterVector (e.g. onShape()).
@@ -514,7 +706,7 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
         Token t = *nextToken(TokenRequired);
         std::string_view dequoted = dequoteString(t);
         std::string n = toString(dequoted);
-        ParsedParameterVector parameterVector = parseParameters(nextToken, unget);
+        ParsedParameterVector parameterVector = parseParameters(nextToken, unget, scanNumericArray);
         (target.*apiFunc)(n, std::move(parameterVector), loc);
     };
 
@@ -850,7 +1042,7 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
                 Token t = *nextToken(TokenRequired);
                 std::string_view dequoted = dequoteString(t);
                 std::string texName = toString(dequoted);
-                ParsedParameterVector params = parseParameters(nextToken, unget);
+                ParsedParameterVector params = parseParameters(nextToken, unget, scanNumericArray);
                 target.onTexture(name, type, texName, std::move(params), tok->loc);
             }
             else
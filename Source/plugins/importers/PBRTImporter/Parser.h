@@ -127,6 +127,14 @@ public:
      */
     std::optional<Token> next();
 
+    /**
+     * Scan the values of an array following an opening bracket, if they are all numbers.
+     * On success, the closing bracket is consumed and the returned token covers the whitespace separated values.
+     * Otherwise nothing is consumed, so that the values can be read with next().
+     * @param[in] minSize Minimum size of the values in bytes. Smaller arrays are not scanned.
+     */
+    std::optional<Token> scanNumericArray(size_t minSize);
+
     const std::filesystem::path& getPath() const { return mPath; }
 
 private:
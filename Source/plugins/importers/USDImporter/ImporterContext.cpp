@@ -635,6 +635,17 @@ namespace Falcor
             return true;
         }
 
+        // Get views of the curve data for tessellation. The USD arrays must outlive the returned strand data.
+        CurveTessellation::StrandData getStrandData(const VtVec3fArray& usdPoints, const VtIntArray& usdCurveVertexCounts, const VtFloatArray& usdCurveWidths, const VtVec2fArray& usdUVs)
+        {
+            CurveTessellation::StrandData strands;
+            strands.vertexCountsPerStrand = fstd::span<const uint32_t>(reinterpret_cast<const uint32_t*>(usdCurveVertexCounts.data()), usdCurveVertexCounts.size());
+            strands.controlPoints = fstd::span<const float3>(reinterpret_cast<const float3*>(usdPoints.data()), usdPoints.size());
+            strands.widths = fstd::span<const float>(usdCurveWidths.data(), usdCurveWidths.size());
+            strands.UVs = fstd::span<const float2>(reinterpret_cast<const float2*>(usdUVs.data()), usdUVs.size());
+            return strands;
+        }
+
         // Convert a UsdGeomBasisCurves into a CurveGeomData (curve primitive).
         bool convertToCurveGeomData(const UsdGeomBasisCurves& usdCurve, const UsdTimeCode& timeCode, ImporterContext& ctx, CurveGeomData& geomOut)
         {
@@ -649,13 +660,12 @@ namespace Falcor
                 return false;
             }
 
-            size_t strandCount = usdCurveVertexCounts.size();
             size_t vertexCount = std::accumulate(usdCurveVertexCounts.begin(), usdCurveVertexCounts.end(), 0);
             FALCOR_ASSERT(vertexCount == usdPoints.size());
             FALCOR_ASSERT(vertexCount == usdCurveWidths.size());
             FALCOR_ASSERT(vertexCount == usdUVs.size() || usdUVs.size() == 0);
 
-            const float2* pUsdUVs = usdUVs.empty() ? nullptr : (float2*)usdUVs.data();
+            CurveTessellation::StrandData strands = getStrandData(usdPoints, usdCurveVertexCounts, usdCurveWidths, usdUVs);
 
             uint32_t subdivPerSegment                = ctx.builder.getSettings().getAttribute(curveName, "curves:subdivPerSegment", kCurveSubdivPerSegment);
             uint32_t keepOneEveryXStrands            = ctx.builder.getSettings().getAttribute(curveName, "curves:keepOneEveryXStrands", kCurveKeepOneEveryXStrands);
@@ -665,9 +675,7 @@ namespace Falcor
             float widthScale = std::sqrt((float)keepOneEveryXStrands);
 
             // Convert to linear swept sphere segments.
-            CurveTessellation::SweptSphereResult result = CurveTessellation::convertToLinearSweptSphere(strandCount, reinterpret_cast<const uint32_t*>(usdCurveVertexCounts.data()),
-                (float3*)usdPoints.data(), usdCurveWidths.data(), pUsdUVs, 1,
-                subdivPerSegment, keepOneEveryXStrands, keepOneEveryXVerticesPerStrand, widthScale, float4x4::identity());
+            CurveTessellation::SweptSphereResult result = CurveTessellation::convertToLinearSweptSphere(strands, 1, subdivPerSegment, keepOneEveryXStrands, keepOneEveryXVerticesPerStrand, widthScale, float4x4::identity());
 
             // Copy data.
             geomOut.id = curveName;
@@ -704,13 +712,12 @@ namespace Falcor
                 return false;
             }
 
-            size_t strandCount = usdCurveVertexCounts.size();
             size_t vertexCount = std::accumulate(usdCurveVertexCounts.begin(), usdCurveVertexCounts.end(), 0);
             FALCOR_ASSERT(vertexCount == usdPoints.size());
             FALCOR_ASSERT(vertexCount == usdCurveWidths.size());
             FALCOR_ASSERT(vertexCount == usdUVs.size() || usdUVs.size() == 0);
 
-            const float2* pUsdUVs = usdUVs.empty() ? nullptr : (float2*)usdUVs.data();
+            CurveTessellation::StrandData strands = getStrandData(usdPoints, usdCurveVertexCounts, usdCurveWidths, usdUVs);
 
             uint32_t subdivPerSegment                = ctx.builder.getSettings().getAttribute(curveName, "curves:subdivPerSegment", kCurveSubdivPerSegment);
             uint32_t keepOneEveryXStrands            = ctx.builder.getSettings().getAttribute(curveName, "curves:keepOneEveryXStrands", kCurveKeepOneEveryXStrands);
@@ -724,7 +731,7 @@ namespace Falcor
 
             if (tessellationMode == CurveTessellationMode::PolyTube)
             {
-                result = CurveTessellation::convertToPolytube(strandCount, reinterpret_cast<const uint32_t*>(usdCurveVertexCounts.data()), (float3*)usdPoints.data(), usdCurveWidths.data(), pUsdUVs, subdivPerSegment, keepOneEveryXStrands, keepOneEveryXVerticesPerStrand, widthScale, 4);
+                result = CurveTessellation::convertToPolytube(strands, subdivPerSegment, keepOneEveryXStrands, keepOneEveryXVerticesPerStrand, widthScale, 4);
             }
             else
             {
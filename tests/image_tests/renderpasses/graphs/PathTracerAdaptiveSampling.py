@@ -0,0 +1,34 @@
+from falcor import *
+
+def render_graph_PathTracerAdaptiveSampling():
+    g = RenderGraph("PathTracerAdaptiveSampling")
+    PathTracer = createPass("PathTracer", {'useSER': False})
+    g.addPass(PathTracer, "PathTracer")
+    VBufferRT = createPass("VBufferRT", {'samplePattern': 'Center', 'sampleCount': 16, 'useAlphaTest': True})
+    g.addPass(VBufferRT, "VBufferRT")
+    AdaptiveSampling = createPass("AdaptiveSampling", {'targetError': 0.05, 'maxSamples': 4, 'tileSize': 8})
+    g.addPass(AdaptiveSampling, "AdaptiveSampling")
+    AccumulatePass = createPass("AccumulatePass", {'enabled': True, 'precisionMode': 'Single'})
+    g.addPass(AccumulatePass, "AccumulatePass")
+    ToneMapper = createPass("ToneMapper", {'autoExposure': False, 'exposureCompensation': 0.0})
+    g.addPass(ToneMapper, "ToneMapper")
+
+    # The sample count for the next frame is passed from AdaptiveSampling to PathTracer via the render graph dictionary.
+    g.addEdge("VBufferRT.vbuffer", "PathTracer.vbuffer")
+    g.addEdge("PathTracer.color", "AdaptiveSampling.color")
+    g.addEdge("PathTracer.color", "AccumulatePass.input")
+    g.addEdge("AdaptiveSampling.convergenceMask", "AccumulatePass.mask")
+    g.addEdge("AccumulatePass.output", "ToneMapper.src")
+
+    # Final frame output
+    g.markOutput("ToneMapper.dst")
+    g.markOutput("ToneMapper.dst", TextureChannelFlags.Alpha)
+
+    # Adaptive sampling outputs
+    g.markOutput("AdaptiveSampling.sampleCount")
+
+    return g
+
+PathTracerAdaptiveSampling = render_graph_PathTracerAdaptiveSampling()
+try: m.addGraph(PathTracerAdaptiveSampling)
+except NameError: None
@@ -0,0 +1,26 @@
+from falcor import *
+
+def render_graph_PathTracerSchedulers():
+    g = RenderGraph("PathTracerSchedulers")
+    VBufferRT = createPass("VBufferRT", {'samplePattern': 'Stratified', 'sampleCount': 16})
+    g.addPass(VBufferRT, "VBufferRT")
+    PathTracer = createPass("PathTracer", {'samplesPerPixel': 1, 'maxSurfaceBounces': 3})
+    g.addPass(PathTracer, "PathTracer")
+    PathTracerWavefront = createPass("PathTracer", {'samplesPerPixel': 1, 'maxSurfaceBounces': 3, 'useWavefront': True})
+    g.addPass(PathTracerWavefront, "PathTracerWavefront")
+    ErrorMeasurePass = createPass("ErrorMeasurePass", {'IgnoreBackground': False, 'ComputeSquaredDifference': False, 'SelectedOutputId': 'Difference'})
+    g.addPass(ErrorMeasurePass, "ErrorMeasurePass")
+
+    g.addEdge("VBufferRT.vbuffer", "PathTracer.vbuffer")
+    g.addEdge("VBufferRT.vbuffer", "PathTracerWavefront.vbuffer")
+    g.addEdge("PathTracerWavefront.color", "ErrorMeasurePass.Source")
+    g.addEdge("PathTracer.color", "ErrorMeasurePass.Reference")
+
+    # Absolute difference between the schedulers, which is expected to be zero up to floating-point differences
+    g.markOutput("ErrorMeasurePass.Output")
+
+    return g
+
+PathTracerSchedulers = render_graph_PathTracerSchedulers()
+try: m.addGraph(PathTracerSchedulers)
+except NameError: None
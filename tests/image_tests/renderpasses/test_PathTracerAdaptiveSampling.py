@@ -0,0 +1,17 @@
+IMAGE_TEST = {
+    "device_types": ["d3d12", "vulkan"]
+}
+
+import sys
+sys.path.append('..')
+from helpers import render_frames
+from graphs.PathTracerAdaptiveSampling import PathTracerAdaptiveSampling as g
+from falcor import *
+
+m.addGraph(g)
+m.loadScene('Arcade/Arcade.pyscene')
+
+# default
+render_frames(m, 'default', frames=[1,16,64])
+
+exit()
@@ -0,0 +1,24 @@
+IMAGE_TEST = {
+    "device_types": ["d3d12", "vulkan"]
+}
+
+import sys
+
+sys.path.append("..")
+from helpers import render_frames
+from graphs.PathTracerSchedulers import PathTracerSchedulers as g
+from falcor import *
+
+m.addGraph(g)
+
+# Compare the wavefront scheduler against the trace pass, with the same seed in both path tracers
+m.loadScene("test_scenes/materials/materials.pyscene")
+render_frames(m, "types", frames=[1, 16])
+
+m.loadScene("test_scenes/nested_dielectrics.pyscene")
+render_frames(m, "dielectrics", frames=[1, 16])
+
+m.loadScene("test_scenes/alpha_test/alpha_test.pyscene")
+render_frames(m, "alpha", frames=[1, 16])
+
+exit()
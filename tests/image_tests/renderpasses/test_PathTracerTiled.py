@@ -0,0 +1,18 @@
+IMAGE_TEST = {
+    "device_types": ["d3d12", "vulkan"]
+}
+
+import sys
+sys.path.append('..')
+from helpers import render_frames
+from graphs.PathTracer import PathTracer as g
+from falcor import *
+
+m.addGraph(g)
+m.loadScene('Arcade/Arcade.pyscene')
+
+# tiled rendering with multiple sample batches
+g["PathTracer"].set_properties({"useSER": False, "tileSize": uint2(256, 128), "samplesPerPixel": 48})
+render_frames(m, 'tiled', frames=[16])
+
+exit()
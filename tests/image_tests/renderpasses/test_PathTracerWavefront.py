@@ -0,0 +1,27 @@
+IMAGE_TEST = {
+    "device_types": ["d3d12", "vulkan"]
+}
+
+import sys
+
+sys.path.append("..")
+from helpers import render_frames
+from graphs.PathTracerMaterials import PathTracerMaterials as g
+from falcor import *
+
+m.addGraph(g)
+g["PathTracer"].set_properties({"useWavefront": True})
+
+# Test different material types, which are sorted before shading
+m.loadScene("test_scenes/materials/materials.pyscene")
+render_frames(m, "types", frames=[1, 256])
+
+# Test nested dielectrics, which reject hits
+m.loadScene("test_scenes/nested_dielectrics.pyscene")
+render_frames(m, "dielectrics", frames=[1, 256])
+
+# Test alpha testing
+m.loadScene("test_scenes/alpha_test/alpha_test.pyscene")
+render_frames(m, "alpha", frames=[1, 64])
+
+exit()
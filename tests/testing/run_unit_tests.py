@@ -26,6 +26,18 @@ def run_unit_tests(env: Environment, args):
 
     return p.returncode == 0
 
+def add_tags(args, tags):
+    """Add tags to the tag filter in the argument list, merging them with a user supplied --tags argument."""
+    for i, arg in enumerate(args):
+        if arg in ['--tags', '-t'] and i + 1 < len(args):
+            args[i + 1] += ',' + tags
+            return
+        for prefix in ['--tags=', '-t']:
+            if arg.startswith(prefix) and arg != '-t':
+                args[i] = arg + ',' + tags
+                return
+    args += ['--tags', tags]
+
 def main():
     default_config = find_most_recent_build_config()
 
@@ -34,6 +46,7 @@ def main():
     parser.add_argument('--environment', type=str, action='store', help=f'Environment', default=None)
     parser.add_argument('--config', type=str, action='store', help=f'Build configuration (default: {default_config})', default=default_config)
     parser.add_argument('--list-configs', action='store_true', help='List available build configurations')
+    parser.add_argument('--benchmark', type=str, nargs='?', const='', default=None, metavar='TAGS', help='Run benchmarks instead of tests, optionally filtered by a comma separated list of tags')
     args, passthrough_args = parser.parse_known_args()
 
     # Try to load environment.
@@ -63,6 +76,12 @@ def main():
         print(f"\nFailed to load environment: {env_error}")
         sys.exit(1)
 
+    # Select benchmarks.
+    if args.benchmark != None:
+        passthrough_args += ['--benchmark']
+        if args.benchmark != '':
+            add_tags(passthrough_args, args.benchmark)
+
     # Run tests.
     success = run_unit_tests(env, passthrough_args)
 
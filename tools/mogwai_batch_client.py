@@ -0,0 +1,100 @@
+import os
+import sys
+import json
+import logging
+import argparse
+import subprocess
+
+logging.basicConfig(format="%(levelname)s: %(message)s")
+
+def find_mogwai():
+    """
+    Find the Mogwai executable in the default build output directories.
+    """
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    name = "Mogwai.exe" if os.name == "nt" else "Mogwai"
+    candidates = []
+    build_dir = os.path.join(root, "build")
+    if os.path.isdir(build_dir):
+        for preset in sorted(os.listdir(build_dir)):
+            for config in ["Release", "RelWithDebInfo", "Debug"]:
+                candidates.append(os.path.join(build_dir, preset, "bin", config, name))
+            candidates.append(os.path.join(build_dir, preset, "bin", name))
+    for path in candidates:
+        if os.path.isfile(path):
+            return path
+    return None
+
+def read_jobs(path):
+    """
+    Read jobs from a JSON-lines file. Lines that are empty or start with '#' are skipped.
+    """
+    jobs = []
+    with open(path, "r") as f:
+        for line in f.readlines():
+            line = line.strip()
+            if line and not line.startswith("#"):
+                jobs.append(json.loads(line))
+    return jobs
+
+class BatchClient:
+    """
+    Runs Mogwai in batch mode and submits jobs one at a time over stdin.
+    Each call to run() blocks until the result of the job is received, so the
+    scenes and graphs loaded by earlier jobs stay resident for later ones.
+    """
+
+    def __init__(self, mogwai, args=[]):
+        cmd = [mogwai, "--headless", "--batch", "-"] + args
+        logging.info(f"Starting {' '.join(cmd)}")
+        self.process = subprocess.Popen(cmd, stdin=subprocess.PIPE, stdout=subprocess.PIPE, text=True, bufsize=1)
+
+    def run(self, job):
+        self.process.stdin.write(json.dumps(job) + "\n")
+        self.process.stdin.flush()
+        line = self.process.stdout.readline()
+        if not line:
+            raise RuntimeError(f"Mogwai terminated with exit code {self.process.wait()}")
+        return json.loads(line)
+
+    def close(self):
+        self.process.stdin.write(json.dumps({"exit": True}) + "\n")
+        self.process.stdin.close()
+        return self.process.wait()
+
+def main():
+    parser = argparse.ArgumentParser(description="Submit render jobs to Mogwai running in batch mode.")
+    parser.add_argument("jobs", help="JSON-lines file with one job per line.")
+    parser.add_argument("--mogwai", help="Path to the Mogwai executable.")
+    parser.add_argument("--script", help="Script to run before the first job (for example, a render graph).")
+    parser.add_argument("--scene", help="Scene to load before the first job.")
+    args = parser.parse_args()
+
+    mogwai = args.mogwai or find_mogwai()
+    if not mogwai:
+        logging.error("Cannot find Mogwai executable, use --mogwai to specify it.")
+        return 1
+
+    mogwai_args = []
+    if args.script:
+        mogwai_args += ["--script", args.script]
+    if args.scene:
+        mogwai_args += ["--scene", args.scene]
+
+    client = BatchClient(mogwai, mogwai_args)
+    failed = 0
+    for job in read_jobs(args.jobs):
+        result = client.run(job)
+        timing = result.get("timing", {})
+        if result["success"]:
+            print(f"{result['id']}: ok, scene {timing.get('sceneLoadMs', 0):.1f} ms, render {timing.get('renderMs', 0):.1f} ms, "
+                  f"write {timing.get('writeMs', 0):.1f} ms, total {timing.get('totalMs', 0):.1f} ms")
+        else:
+            failed += 1
+            print(f"{result['id']}: FAILED: {result.get('error', '')}")
+    client.close()
+
+    return 1 if failed > 0 else 0
+
+if __name__ == "__main__":
+    sys.exit(main())